@@ -111,6 +111,14 @@ typedef struct TAOS_MULTI_BIND {
   int       num;
 } TAOS_MULTI_BIND;
 
+typedef struct TAOS_STMT_OPTIONS {
+  int64_t reqId;
+  // The fixed-length columns bound without null values refer to the TAOS_MULTI_BIND buffers instead of copying them.
+  // Such a buffer must not be changed or freed until taos_stmt_execute returns, it is still in use after
+  // taos_stmt_set_tbname, taos_stmt_add_batch or binding the next table.
+  bool    bindNoCopy;
+} TAOS_STMT_OPTIONS;
+
 typedef enum {
   SET_CONF_RET_SUCC = 0,
   SET_CONF_RET_ERR_PART = -1,
@@ -154,6 +162,7 @@ DLL_EXPORT const char *taos_data_type(int type);
 
 DLL_EXPORT TAOS_STMT *taos_stmt_init(TAOS *taos);
 DLL_EXPORT TAOS_STMT *taos_stmt_init_with_reqid(TAOS *taos, int64_t reqid);
+DLL_EXPORT TAOS_STMT *taos_stmt_init_with_options(TAOS *taos, TAOS_STMT_OPTIONS *options);
 DLL_EXPORT int        taos_stmt_prepare(TAOS_STMT *stmt, const char *sql, unsigned long length);
 DLL_EXPORT int        taos_stmt_set_tbname_tags(TAOS_STMT *stmt, const char *name, TAOS_MULTI_BIND *tags);
 DLL_EXPORT int        taos_stmt_set_tbname(TAOS_STMT *stmt, const char *name);
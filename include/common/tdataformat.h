@@ -146,6 +146,7 @@ extern void (*tColDataCalcSMA[])(SColData *pColData, int64_t *sum, int64_t *max,
 
 // for stmt bind
 int32_t tColDataAddValueByBind(SColData *pColData, TAOS_MULTI_BIND *pBind);
+int32_t tColDataBorrowByBind(SColData *pColData, TAOS_MULTI_BIND *pBind);
 void    tColDataSortMerge(SArray *colDataArr);
 
 // for raw block
@@ -207,6 +208,7 @@ struct SColData {
   int32_t  numOfValue;  // # of vale
   int32_t  nVal;
   int8_t   flag;
+  int8_t   borrowed;  // pData belongs to the bind caller, it is never freed or grown here
   uint8_t *pBitMap;
   int32_t *aOffset;
   int32_t  nData;
@@ -52,6 +52,7 @@ extern int32_t tsNumOfRpcThreads;
 extern int32_t tsNumOfRpcSessions;
 extern int32_t tsTimeToGetAvailableConn;
 extern int32_t tsNumOfCommitThreads;
+extern int32_t tsNumOfApplyThreads;
 extern int32_t tsNumOfTaskQueueThreads;
 extern int32_t tsNumOfMnodeQueryThreads;
 extern int32_t tsNumOfMnodeFetchThreads;
@@ -76,6 +77,7 @@ extern int64_t tsVndCommitMaxIntervalMs;
 
 // mnode
 extern int64_t tsMndSdbWriteDelta;
+extern int32_t tsMndSdbDeltaSegments;
 extern int64_t tsMndLogRetention;
 
 // monitor
@@ -103,11 +105,15 @@ extern int64_t tsQueryBufferSizeBytes;  // maximum allowed usage buffer size in
 // query client
 extern int32_t tsQueryPolicy;
 extern int32_t tsQueryRspPolicy;
+extern int32_t tsQueryTimeSlice;
+extern int32_t tsQueryAdmitMemory;
+extern int32_t tsQueryMemoryLimit;
 extern int32_t tsQuerySmaOptimize;
 extern int32_t tsQueryRsmaTolerance;
 extern bool    tsQueryPlannerTrace;
 extern int32_t tsQueryNodeChunkSize;
 extern bool    tsQueryUseNodeAllocator;
+extern int32_t tsQueryPlanCacheSize;
 extern bool    tsKeepColumnName;
 extern bool    tsEnableQueryHb;
 extern int32_t tsRedirectPeriod;
@@ -140,9 +146,10 @@ extern int32_t  tsDiskCfgNum;
 extern SDiskCfg tsDiskCfg[];
 
 // udf
-extern bool tsStartUdfd;
-extern char tsUdfdResFuncs[];
-extern char tsUdfdLdLibPath[];
+extern bool    tsStartUdfd;
+extern int32_t tsUdfShmSize;
+extern char    tsUdfdResFuncs[];
+extern char    tsUdfdLdLibPath[];
 
 // schemaless
 extern char    tsSmlChildTableName[];
@@ -165,7 +172,14 @@ extern int32_t tsUptimeInterval;
 extern int32_t tsRpcRetryLimit;
 extern int32_t tsRpcRetryInterval;
 
-extern bool tsDisableStream;
+extern bool    tsDisableStream;
+extern int32_t tsStreamDispatchWindow;
+extern int32_t tsStreamDispatchBatchSize;
+extern int32_t tsStreamQueueLimit;
+extern bool    tsTdbWalMode;
+extern int32_t tsExchangeFetchWindow;
+extern int32_t tsExchangeBufferSize;
+extern int32_t tsRetentionSpeedLimitMB;
 
 // #define NEEDTO_COMPRESSS_MSG(size) (tsCompressMsgSize != -1 && (size) > tsCompressMsgSize)
 
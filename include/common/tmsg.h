@@ -1105,6 +1105,8 @@ typedef struct {
   int64_t numOfInsertSuccessReqs;
   int64_t numOfBatchInsertReqs;
   int64_t numOfBatchInsertSuccessReqs;
+  int64_t numOfRSmaBufItems;
+  int64_t rsmaExecLag;  // ms
   int64_t errors;
 } SVnodesStat;
 
@@ -1124,6 +1126,8 @@ typedef struct {
   int64_t numOfInsertSuccessReqs;
   int64_t numOfBatchInsertReqs;
   int64_t numOfBatchInsertSuccessReqs;
+  int64_t numOfRSmaBufItems;  // SubmitReq waiting for the rollup
+  int64_t rsmaExecLag;        // ms, max delay from receipt to rollup of SubmitReq since the last reset
 } SVnodeLoad;
 
 typedef struct {
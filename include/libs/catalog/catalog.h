@@ -157,6 +157,8 @@ int32_t catalogGetHandle(uint64_t clusterId, SCatalog** catalogHandle);
 
 int32_t catalogGetDBVgVersion(SCatalog* pCtg, const char* dbFName, int32_t* version, int64_t* dbId, int32_t* tableNum, int64_t* stateTs);
 
+int32_t catalogGetCachedVgEpSet(SCatalog* pCtg, const char* dbFName, int32_t vgId, SEpSet* pEpSet, bool* exists);
+
 /**
  * Get a DB's all vgroup info.
  * @param pCatalog (input, got with catalogGetHandle)
@@ -213,6 +215,12 @@ int32_t catalogGetCachedSTableMeta(SCatalog* pCtg, const SName* pTableName, STab
 int32_t catalogGetTablesHashVgId(SCatalog* pCtg, SRequestConnInfo* pConn, int32_t acctId, const char* pDb, const char* pTableName[],
                                   int32_t tableNum, int32_t *vgId);
 
+/**
+ * Get a table's uid and schema/tag versions from the local cache only. For a child table the versions are those of
+ * its super table. sver and tver are -1 if the meta is not cached.
+ */
+int32_t catalogGetCachedTableVer(SCatalog* pCtg, const SName* pTableName, uint64_t* uid, int32_t* sver, int32_t* tver);
+
 int32_t catalogGetCachedTableHashVgroup(SCatalog* pCtg, const SName* pTableName, SVgroupInfo* pVgroup, bool* exists);
 
 int32_t catalogGetCachedTableVgMeta(SCatalog* pCtg, const SName* pTableName,          SVgroupInfo* pVgroup, STableMeta** pTableMeta);
@@ -53,6 +53,8 @@ typedef struct SLogicNode {
   EDataOrderLevel    requireDataOrder;  // requirements for input data
   EDataOrderLevel    resultDataOrder;   // properties of the output data
   EGroupAction       groupAction;
+  double             estRows;  // estimated number of output rows, 0 means unknown
+  double             estCost;  // estimated cumulative cost of this subtree
 } SLogicNode;
 
 typedef enum EScanType {
@@ -105,13 +107,17 @@ typedef struct SScanLogicNode {
   bool          igLastNull;
 } SScanLogicNode;
 
+typedef enum EJoinAlgorithm { JOIN_ALGO_MERGE = 1, JOIN_ALGO_HASH } EJoinAlgorithm;
+
 typedef struct SJoinLogicNode {
-  SLogicNode node;
-  EJoinType  joinType;
-  SNode*     pMergeCondition;
-  SNode*     pOnConditions;
-  bool       isSingleTableJoin;
-  EOrder     inputTsOrder;
+  SLogicNode     node;
+  EJoinType      joinType;
+  EJoinAlgorithm joinAlgo;
+  SNode*         pMergeCondition;  // primary key equal condition of merge join, or equi-join keys of hash join
+  SNode*         pOnConditions;
+  bool           isSingleTableJoin;
+  EOrder         inputTsOrder;
+  bool           buildLeft;  // hash join builds the hash table on the left child
 } SJoinLogicNode;
 
 typedef struct SAggLogicNode {
@@ -123,6 +129,7 @@ typedef struct SAggLogicNode {
   bool       hasTimeLineFunc;
   bool       onlyHasKeepOrderFunc;
   bool       hasGroupKeyOptimized;
+  bool       groupKeySorted;  // the input is sorted by the group keys
 } SAggLogicNode;
 
 typedef struct SProjectLogicNode {
@@ -314,6 +321,8 @@ typedef struct SPhysiNode {
   struct SPhysiNode*  pParent;
   SNode*              pLimit;
   SNode*              pSlimit;
+  double              estRows;
+  double              estCost;
 } SPhysiNode;
 
 typedef struct SScanPhysiNode {
@@ -407,6 +416,16 @@ typedef struct SSortMergeJoinPhysiNode {
   EOrder     inputTsOrder;
 } SSortMergeJoinPhysiNode;
 
+typedef struct SHashJoinPhysiNode {
+  SPhysiNode node;
+  EJoinType  joinType;
+  SNodeList* pLeftKeys;
+  SNodeList* pRightKeys;
+  SNode*     pOnConditions;  // non-equi conditions evaluated on each matched pair
+  SNodeList* pTargets;
+  bool       buildLeft;
+} SHashJoinPhysiNode;
+
 typedef struct SAggPhysiNode {
   SPhysiNode node;
   SNodeList* pExprs;  // these are expression list of group_by_clause and parameter expression of aggregate function
@@ -414,6 +433,7 @@ typedef struct SAggPhysiNode {
   SNodeList* pAggFuncs;
   bool       mergeDataBlock;
   bool       groupKeyOptimized;
+  bool       groupKeySorted;
 } SAggPhysiNode;
 
 typedef struct SDownstreamSourceNode {
@@ -68,6 +68,29 @@ typedef struct SParseContext {
 int32_t qParseSql(SParseContext* pCxt, SQuery** pQuery);
 bool    qIsInsertValuesSql(const char* pStr, size_t length);
 
+// A value that is left out of the normalized text of a cacheable statement: a literal token of the statement or a
+// value bound to one of its placeholders.
+typedef struct SCacheableParam {
+  bool    bound;
+  bool    isNull;
+  int32_t type;  // token type of a literal, buffer type of a bound value
+  int32_t len;
+  char*   pData;
+} SCacheableParam;
+
+// Normalize a single SELECT statement into the text used as plan cache key: tokens are separated by one space,
+// keywords and unquoted identifiers are lower-cased. If pParams is not NULL, every literal is replaced by '?' and
+// appended to it. Returns false if the statement must not be cached, for example because it depends on NOW() or
+// contains more than one statement.
+bool qNormalizeCacheableSql(const char* pStr, size_t length, bool withPlaceholder, char** pNormalized, int32_t* pLen,
+                            SArray* pParams);
+void qDestroyCacheableParams(SArray* pParams);
+// Extracts the primary key condition of a translated query whose time range can be set again from other params.
+// The params it is built from are marked in pRebindable, ppCond is NULL if there is none.
+int32_t qBuildCacheableTimeRange(const SQuery* pQuery, const SArray* pParams, bool* pRebindable, SNode** ppCond,
+                                 STimeWindow* pRange);
+int32_t qRebindCacheableTimeRange(const SNode* pCond, const SArray* pParams, STimeWindow* pRange);
+
 // for async mode
 int32_t qParseSqlSyntax(SParseContext* pCxt, SQuery** pQuery, struct SCatalogReq* pCatalogReq);
 int32_t qAnalyseSqlSemantic(SParseContext* pCxt, const struct SCatalogReq* pCatalogReq,
@@ -94,9 +117,9 @@ int32_t     qCloneCurrentTbData(STableDataCxt* pDataBlock, SSubmitTbData** pData
 
 int32_t qStmtBindParams(SQuery* pQuery, TAOS_MULTI_BIND* pParams, int32_t colIdx);
 int32_t qStmtParseQuerySql(SParseContext* pCxt, SQuery* pQuery);
-int32_t qBindStmtColsValue(void* pBlock, TAOS_MULTI_BIND* bind, char* msgBuf, int32_t msgBufLen);
+int32_t qBindStmtColsValue(void* pBlock, TAOS_MULTI_BIND* bind, char* msgBuf, int32_t msgBufLen, bool noCopy);
 int32_t qBindStmtSingleColValue(void* pBlock, TAOS_MULTI_BIND* bind, char* msgBuf, int32_t msgBufLen, int32_t colIdx,
-                                int32_t rowNum);
+                                int32_t rowNum, bool noCopy);
 int32_t qBuildStmtColFields(void* pDataBlock, int32_t* fieldNum, TAOS_FIELD_E** fields);
 int32_t qBuildStmtTagFields(void* pBlock, void* boundTags, int32_t* fieldNum, TAOS_FIELD_E** fields);
 int32_t qBindStmtTagsValue(void* pBlock, void* boundTags, int64_t suid, const char* sTableName, char* tName,
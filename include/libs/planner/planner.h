@@ -65,6 +65,13 @@ int32_t qMsgToSubplan(const char* pStr, int32_t len, SSubplan** pSubplan);
 
 SQueryPlan* qStringToQueryPlan(const char* pStr);
 
+// Deep copy of a query plan that has not been scheduled yet, with all subplans assigned to @queryId.
+int32_t qCloneQueryPlan(const SQueryPlan* pSrc, uint64_t queryId, SQueryPlan** pDst);
+
+// True if the time range of the plan is only the scan range of its table scans, all equal to @pRange.
+bool qIsScanRangeRebindable(const SQueryPlan* pPlan, const STimeWindow* pRange);
+void qSetScanRange(SQueryPlan* pPlan, const STimeWindow* pRange);
+
 void qDestroyQueryPlan(SQueryPlan* pPlan);
 
 #ifdef __cplusplus
@@ -239,6 +239,11 @@ static FORCE_INLINE void* streamQueueNextItem(SStreamQueue* queue) {
   }
 }
 
+static FORCE_INLINE bool streamQueueHasItem(SStreamQueue* queue) {
+  return atomic_load_8(&queue->status) == STREAM_QUEUE__FAILED || queue->qall->current != NULL ||
+         !taosQueueEmpty(queue->queue);
+}
+
 SStreamDataSubmit2* streamDataSubmitNew(SPackedData submit);
 
 void streamDataSubmitRefDec(SStreamDataSubmit2* pDataSubmit);
@@ -251,16 +256,33 @@ typedef struct {
   void* executor;
 } STaskExec;
 
+typedef struct {
+  int64_t seq;
+  int32_t contLen;
+  void*   pCont;  // the encoded msg with its SMsgHead, a copy of it is sent each time
+} SStreamDispatchMsg;
+
+// the dispatch msgs sent to one downstream task, which takes them in seq order only
+typedef struct {
+  int64_t seq;       // of the last msg sent, from 1
+  int64_t ackSeq;    // the downstream task took all msgs up to it
+  int8_t  retry;     // the msgs after ackSeq are sent again by the retry timer
+  SArray* pUnacked;  // SArray<SStreamDispatchMsg>, the msgs after ackSeq in seq order
+} SStreamDispatchWindow;
+
 typedef struct {
   int32_t taskId;
   int32_t nodeId;
   SEpSet  epSet;
+  // following are not applicable to encoder and decoder
+  SStreamDispatchWindow window;
 } STaskDispatcherFixedEp;
 
 typedef struct {
   char      stbFullName[TSDB_TABLE_FNAME_LEN];
-  int32_t   waitingRspCnt;
   SUseDbRsp dbInfo;
+  // following are not applicable to encoder and decoder
+  SStreamDispatchWindow* pWindows;  // one for each of dbInfo.pVgroupInfos
 } STaskDispatcherShuffle;
 
 typedef void FTbSink(SStreamTask* pTask, void* vnode, int64_t ver, void* data);
@@ -360,6 +382,14 @@ typedef struct SStreamTask {
   SArray* checkReqIds;  // shuffle
   int32_t refCnt;
 
+  // dispatch, each downstream task has up to tsStreamDispatchWindow msgs in flight
+  TdThreadMutex     dispatchLock;          // guards the dispatch windows and pUpstreamSeq
+  int64_t           dispatchSession;       // new for each run of the task, so its downstream tasks restart its seq
+  SStreamDataBlock* pDispatchData;         // a batch failed to be put into the windows, dispatched again first
+  int64_t           dispatchBlockedUntil;  // ms, set when a downstream task rsp with its input blocked
+  int8_t            execPaused;            // STREAM_EXEC_PAUSED__* flags, exec stops while the output queue is full
+  SHashObj*         pUpstreamSeq;          // upstream task id -> SStreamUpstreamSeq, the dispatch msgs taken from it
+
   int64_t checkpointingId;
   int32_t checkpointAlignCnt;
 
@@ -430,6 +460,8 @@ typedef struct {
   int32_t blockNum;
   SArray* dataLen;  // SArray<int32_t>
   SArray* data;     // SArray<SRetrieveTableRsp*>
+  int64_t session;  // SStreamTask.dispatchSession of the upstream task
+  int64_t seq;      // of the msg among those sent to the task, 0 for a msg without one
 } SStreamDispatchReq;
 
 typedef struct {
@@ -439,6 +471,7 @@ typedef struct {
   int32_t downstreamNodeId;
   int32_t downstreamTaskId;
   int8_t  inputStatus;
+  int64_t seq;
 } SStreamDispatchRsp;
 
 typedef struct {
@@ -593,7 +626,7 @@ int32_t streamTryExec(SStreamTask* pTask);
 int32_t streamSchedExec(SStreamTask* pTask);
 int32_t streamTaskOutput(SStreamTask* pTask, SStreamDataBlock* pBlock);
 
-int32_t streamScanExec(SStreamTask* pTask, int32_t batchSz);
+int32_t streamScanExec(SStreamTask* pTask, int32_t batchSz, bool* pPaused);
 
 // recover and fill history
 int32_t streamTaskCheckDownstream(SStreamTask* pTask, int64_t version);
@@ -607,7 +640,7 @@ int32_t streamSetStatusNormal(SStreamTask* pTask);
 // source level
 int32_t streamSourceRecoverPrepareStep1(SStreamTask* pTask, int64_t ver);
 int32_t streamBuildSourceRecover1Req(SStreamTask* pTask, SStreamRecoverStep1Req* pReq);
-int32_t streamSourceRecoverScanStep1(SStreamTask* pTask);
+int32_t streamSourceRecoverScanStep1(SStreamTask* pTask, bool* pPaused);
 int32_t streamBuildSourceRecover2Req(SStreamTask* pTask, SStreamRecoverStep2Req* pReq);
 int32_t streamSourceRecoverScanStep2(SStreamTask* pTask, int64_t ver);
 int32_t streamDispatchRecoverFinishReq(SStreamTask* pTask);
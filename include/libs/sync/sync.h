@@ -123,9 +123,15 @@ typedef struct SReConfigCbMeta {
 
 } SReConfigCbMeta;
 
+// data formats the snapshot receiver can apply, it sends them back in the rsp of the prep msg, so an older receiver
+// that sends 0 only gets the formats every version knows
+#define SYNC_SNAPSHOT_CAP_RAW_DATA_BLOCK 0x1
+#define SYNC_SNAPSHOT_CAPS               (SYNC_SNAPSHOT_CAP_RAW_DATA_BLOCK)
+
 typedef struct SSnapshotParam {
   SyncIndex start;
   SyncIndex end;
+  int16_t   caps;  // SYNC_SNAPSHOT_CAP_*, what both the sender and the receiver support
 } SSnapshotParam;
 
 typedef struct SSnapshot {
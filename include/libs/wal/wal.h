@@ -118,6 +118,9 @@ typedef struct SWal {
   TdThreadMutex mutex;
   // ref
   SHashObj *pRefHash;  // refId -> SWalRef
+  // sealed files mapped for the readers
+  SArray       *pSegments;  // SArray<SWalSegment*>
+  TdThreadMutex segMutex;
   // path
   char path[WAL_PATH_LEN];
   // reusable write head
@@ -139,17 +142,19 @@ typedef struct {
 } SWalFilterCond;
 
 typedef struct {
-  SWal          *pWal;
-  int64_t        readerId;
-  TdFilePtr      pLogFile;
-  TdFilePtr      pIdxFile;
-  int64_t        curFileFirstVer;
-  int64_t        curVersion;
-  int64_t        capacity;
-  int8_t         curInvalid;
-  int8_t         curStopped;
-  TdThreadMutex  mutex;
-  SWalFilterCond cond;
+  SWal               *pWal;
+  int64_t             readerId;
+  TdFilePtr           pLogFile;
+  TdFilePtr           pIdxFile;
+  struct SWalSegment *pSeg;       // set instead of the files if the current file is sealed
+  int64_t             segOffset;  // read position in pSeg
+  int64_t             curFileFirstVer;
+  int64_t             curVersion;
+  int64_t             capacity;
+  int8_t              curInvalid;
+  int8_t              curStopped;
+  TdThreadMutex       mutex;
+  SWalFilterCond      cond;
   // TODO remove it
   SWalCkHead *pHead;
 } SWalReader;
@@ -108,6 +108,10 @@ int64_t taosFSendFile(TdFilePtr pFileOut, TdFilePtr pFileIn, int64_t *offset, in
 
 bool taosValidFile(TdFilePtr pFile);
 
+// map the first length bytes of the file read only, NULL is returned if it is not supported
+void *taosMmapReadOnlyFile(TdFilePtr pFile, int64_t length);
+void  taosMunmapFile(void *ptr, int64_t length);
+
 int32_t taosGetErrorFile(TdFilePtr pFile);
 
 int32_t taosCompressFile(char *srcFileName, char *destFileName);
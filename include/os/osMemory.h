@@ -48,6 +48,14 @@ void    taosPrintBackTrace();
 void    taosMemoryTrim(int32_t size);
 void   *taosMemoryMallocAlign(uint32_t alignment, int64_t size);
 
+/**
+ * Map a named shared memory object of size bytes for read and write, it is created if create is true.
+ * Return NULL and set errno on failure, or on the platforms without posix shared memory.
+ */
+void   *taosMapShm(const char *name, int64_t size, bool create);
+void    taosUnmapShm(void *ptr, int64_t size);
+int32_t taosUnlinkShm(const char *name);
+
 #define taosMemoryFreeClear(ptr)   \
   do {                             \
     if (ptr) {                     \
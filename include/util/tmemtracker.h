@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_UTIL_MEM_TRACKER_H_
+#define _TD_UTIL_MEM_TRACKER_H_
+
+#include "os.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MEM_TRACKER_LABEL_LEN 64
+
+/**
+ * A node of the memory accounting tree, e.g. node -> query -> task -> operator. Bytes consumed by a tracker are
+ * charged to all of its ancestors, and a consumption fails if any tracker on the path would exceed its limit.
+ */
+typedef struct SMemTracker {
+  struct SMemTracker* parent;
+  int64_t             limit;  // 0 means no limit
+  int64_t             used;
+  int64_t             peak;
+  int32_t             ref;
+  char                label[MEM_TRACKER_LABEL_LEN];
+} SMemTracker;
+
+/**
+ * create a tracker with one reference, it holds a reference of its parent until destroyed
+ * @param label
+ * @param limit  bytes, 0 means no limit
+ * @param parent may be NULL
+ * @return
+ */
+SMemTracker* taosMemTrackerCreate(const char* label, int64_t limit, SMemTracker* parent);
+
+SMemTracker* taosMemTrackerRef(SMemTracker* pTracker);
+
+/**
+ * drop one reference, the tracker is freed and its remaining bytes are given back to the ancestors with the last one
+ * @param pTracker
+ */
+void taosMemTrackerUnref(SMemTracker* pTracker);
+
+/**
+ * charge size bytes to the tracker and its ancestors if none of them goes over its limit
+ * @param pTracker
+ * @param size
+ * @return false if the memory budget is used up, nothing is charged in that case
+ */
+bool taosMemTrackerTryConsume(SMemTracker* pTracker, int64_t size);
+
+/**
+ * charge size bytes regardless of the limits, used when the caller can not back off
+ */
+void taosMemTrackerConsume(SMemTracker* pTracker, int64_t size);
+
+void taosMemTrackerRelease(SMemTracker* pTracker, int64_t size);
+
+int64_t taosMemTrackerUsed(const SMemTracker* pTracker);
+int64_t taosMemTrackerPeak(const SMemTracker* pTracker);
+
+/**
+ * set the tracker of the calling thread, new buffers created by this thread are charged to it
+ * @param pTracker
+ * @return the previous tracker of this thread, which should be switched back to
+ */
+SMemTracker* taosMemTrackerSwitch(SMemTracker* pTracker);
+
+SMemTracker* taosMemTrackerCurrent();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*_TD_UTIL_MEM_TRACKER_H_*/
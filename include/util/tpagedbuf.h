@@ -33,12 +33,19 @@ typedef struct SFilePage {
 } SFilePage;
 
 typedef struct SDiskbasedBufStatis {
-  int64_t flushBytes;
+  int64_t flushBytes;     // bytes written to disk, after compression
+  int64_t rawFlushBytes;  // bytes of the flushed pages before compression
+  int64_t flushUs;        // time spent on writing pages
   int64_t loadBytes;
+  int64_t loadUs;         // time spent on reading pages, including the pages read ahead
   int32_t loadPages;
   int32_t getPages;
   int32_t releasePages;
   int32_t flushPages;
+  int32_t budgetEvictPages;  // pages flushed since the memory budget of the query was used up
+  int32_t prefetchPages;     // read ahead requests issued
+  int32_t prefetchHitPages;  // pages loaded from the read ahead requests
+  int32_t pendingHitPages;   // pages loaded before their write behind requests reach the disk
 } SDiskbasedBufStatis;
 
 /**
@@ -158,6 +165,23 @@ void setBufPageCompressOnDisk(SDiskbasedBuf* pBuf, bool comp);
  */
 void dBufSetBufPageRecycled(SDiskbasedBuf* pBuf, void* pPage);
 
+/**
+ * Move the page to the tail of the lru list, so it is flushed before the other unreferenced pages, e.g. a sorted run
+ * page that will not be touched until the merge phase.
+ * @param pBuf
+ * @param pPage
+ */
+void dBufSetBufPageEvictFirst(SDiskbasedBuf* pBuf, void* pPage);
+
+/**
+ * Read the page into memory by the spill thread, so that the following getBufPage does not wait for the disk.
+ * It does nothing if the page is in memory, or too many pages have been read ahead.
+ * @param pBuf
+ * @param pageId
+ * @return
+ */
+int32_t dBufPrefetchPage(SDiskbasedBuf* pBuf, int32_t pageId);
+
 /**
  * Print the statistics when closing this buffer
  * @param pBuf
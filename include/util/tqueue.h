@@ -93,12 +93,14 @@ typedef struct STaosQset {
   tsem_t        sem;
   int32_t       numOfQueues;
   int32_t       numOfItems;
+  int32_t       spin;  // tries on sem before a reader parks, 0 to park at once
 } STaosQset;
 
 typedef struct STaosQall {
   STaosQnode *current;
   STaosQnode *start;
   int32_t     numOfItems;
+  int32_t     unAccessedNumOfItems;  // items not fetched by taosGetQitem yet
 } STaosQall;
 
 STaosQueue *taosOpenQueue();
@@ -119,10 +121,12 @@ int32_t    taosReadAllQitems(STaosQueue *queue, STaosQall *qall);
 int32_t    taosGetQitem(STaosQall *qall, void **ppItem);
 void       taosResetQitems(STaosQall *qall);
 int32_t    taosQallItemSize(STaosQall *qall);
+int32_t    taosQallUnAccessedItemSize(STaosQall *qall);
 
 STaosQset *taosOpenQset();
 void       taosCloseQset(STaosQset *qset);
 void       taosQsetThreadResume(STaosQset *qset);
+void       taosSetQsetSpin(STaosQset *qset, int32_t spin);
 int32_t    taosAddIntoQset(STaosQset *qset, STaosQueue *queue, void *ahandle);
 void       taosRemoveFromQset(STaosQset *qset, STaosQueue *queue);
 int32_t    taosGetQueueNumber(STaosQset *qset);
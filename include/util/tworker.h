@@ -37,6 +37,7 @@ typedef struct SQWorkerPool {
   int32_t       max;  // max number of workers
   int32_t       min;  // min number of workers
   int32_t       num;  // current number of workers
+  int32_t       spin;  // tries before an idle worker parks, 0 to park at once
   STaosQset    *qset;
   const char   *name;
   SQueueWorker *workers;
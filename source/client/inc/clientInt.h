@@ -64,6 +64,7 @@ enum {
 #define TD_RES_TMQ_METADATA(res) (*(int8_t*)res == RES_TYPE__TMQ_METADATA)
 
 typedef struct SAppInstInfo SAppInstInfo;
+typedef struct SPlanCache   SPlanCache;
 
 typedef struct {
   char*   key;
@@ -121,6 +122,7 @@ struct SAppInstInfo {
   void*              pTransporter;
   SAppHbMgr*         pAppHbMgr;
   char*              instKey;
+  SPlanCache*        pPlanCache;
 };
 
 typedef struct SAppInfo {
@@ -253,6 +255,9 @@ typedef struct SRequestObj {
   uint32_t             retry;
   int64_t              allocatorRefId;
   SQuery*              pQuery;
+  char*                planCacheKey;
+  int32_t              planCacheKeyLen;
+  SArray*              planCacheParams;  // SArray<SCacheableParam>
 } SRequestObj;
 
 typedef struct SSyncQueryParam {
@@ -306,6 +311,17 @@ static FORCE_INLINE SReqResultInfo* tmqGetNextResInfo(TAOS_RES* res, bool conver
   return NULL;
 }
 
+// A vgroup with no rsp waiting for the application is always polled. Otherwise it is polled ahead of the application
+// while fewer than prefetchNum of its rsps and prefetchBytes of all rsps are waiting, unless it has been consumed up.
+static FORCE_INLINE bool tmqPrefetchAllowed(int32_t bufferedRsp, bool fetchEnd, int32_t prefetchNum,
+                                            int64_t bufferedBytes, int64_t prefetchBytes) {
+  if (bufferedRsp == 0) {
+    return true;
+  }
+
+  return !fetchEnd && bufferedRsp < prefetchNum && bufferedBytes < prefetchBytes;
+}
+
 static FORCE_INLINE SReqResultInfo* tscGetCurResInfo(TAOS_RES* res) {
   if (TD_RES_QUERY(res)) return &(((SRequestObj*)res)->body.resInfo);
   return tmqGetCurResInfo(res);
@@ -404,6 +420,19 @@ int32_t handleCreateTbExecRes(void* res, SCatalog* pCatalog);
 bool    qnodeRequired(SRequestObj* pRequest);
 void    continueInsertFromCsv(SSqlCallbackWrapper* pWrapper, SRequestObj* pRequest);
 void    destorySqlCallbackWrapper(SSqlCallbackWrapper* pWrapper);
+bool    launchAsyncCachedQuery(SRequestObj* pRequest, SSqlCallbackWrapper* pWrapper);
+SRequestObj* launchCachedQueryImpl(SRequestObj* pRequest, SQueryPlan* pDag, SArray* pNodeList);
+
+// --- plan cache
+int32_t planCacheOpen(int32_t capacity, SPlanCache** ppCache);
+void    planCacheClose(SPlanCache* pCache);
+bool    planCacheBuildQueryKey(SRequestObj* pRequest);
+void    planCacheClearKey(SRequestObj* pRequest);
+bool    planCacheBuildStmtKey(SRequestObj* pRequest, const char* pSql, int32_t sqlLen, TAOS_MULTI_BIND* pBinds,
+                              int32_t numOfBinds);
+int32_t planCacheGet(SRequestObj* pRequest, SQueryPlan** ppPlan, SArray** ppExecNodeList);
+void    planCachePut(SRequestObj* pRequest, const SQuery* pQuery, const SQueryPlan* pPlan, const SArray* pExecNodeList);
+void    planCacheRemove(SRequestObj* pRequest);
 
 #ifdef __cplusplus
 }
@@ -74,6 +74,8 @@ typedef struct SStmtExecInfo {
   SHashObj      *pBlockHash;
   STableDataCxt *pCurrBlock;
   SSubmitTbData *pCurrTbData;
+  SQueryPlan    *pCachedPlan;      // plan got from the plan cache for the bound values
+  SArray        *pCachedNodeList;  // exec node list of pCachedPlan
 } SStmtExecInfo;
 
 typedef struct SStmtSQLInfo {
@@ -102,6 +104,7 @@ typedef struct STscStmt {
   SStmtBindInfo bInfo;
 
   int64_t reqid;
+  bool    bindNoCopy;  // see TAOS_STMT_OPTIONS
 } STscStmt;
 
 extern char *gStmtStatusStr[];
@@ -147,7 +150,7 @@ extern char *gStmtStatusStr[];
 #define STMT_ELOG_E(param) qError("stmt:%p " param, pStmt)
 #define STMT_DLOG_E(param) qDebug("stmt:%p " param, pStmt)
 
-TAOS_STMT  *stmtInit(STscObj *taos, int64_t reqid);
+TAOS_STMT  *stmtInit(STscObj *taos, TAOS_STMT_OPTIONS *pOptions);
 int         stmtClose(TAOS_STMT *stmt);
 int         stmtExec(TAOS_STMT *stmt);
 const char *stmtErrstr(TAOS_STMT *stmt);
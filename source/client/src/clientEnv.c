@@ -221,6 +221,8 @@ void destroyAppInst(SAppInstInfo *pAppInfo) {
   taosArrayDestroy(pAppInfo->pQnodeList);
   taosThreadMutexUnlock(&pAppInfo->qnodeMutex);
 
+  planCacheClose(pAppInfo->pPlanCache);
+
   taosMemoryFree(pAppInfo);
 }
 
@@ -389,6 +391,7 @@ void doDestroyRequest(void *p) {
   nodesDestroyAllocator(pRequest->allocatorRefId);
 
   taosMemoryFreeClear(pRequest->sqlstr);
+  planCacheClearKey(pRequest);
   taosMemoryFree(pRequest);
   tscTrace("end to destroy request %" PRIx64 " p:%p", reqId, pRequest);
 }
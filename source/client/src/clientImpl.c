@@ -151,6 +151,9 @@ STscObj* taos_connect_internal(const char* ip, const char* user, const char* pas
       taosMemoryFreeClear(key);
       return NULL;
     }
+    if (tsQueryPlanCacheSize > 0 && TSDB_CODE_SUCCESS != planCacheOpen(tsQueryPlanCacheSize, &p->pPlanCache)) {
+      tscWarn("failed to open plan cache for app inst mgr %p", p);
+    }
     taosHashPut(appInfo.pInstMap, key, strlen(key), &p, POINTER_BYTES);
     p->instKey = key;
     key = NULL;
@@ -986,6 +989,7 @@ SRequestObj* launchQueryImpl(SRequestObj* pRequest, SQuery* pQuery, bool keepQue
           SArray* pNodeList = NULL;
           buildSyncExecNodeList(pRequest, &pNodeList, pMnodeList);
 
+          planCachePut(pRequest, pQuery, pDag, pNodeList);
           code = scheduleQuery(pRequest, pDag, pNodeList);
           taosArrayDestroy(pNodeList);
         }
@@ -1022,6 +1026,48 @@ SRequestObj* launchQueryImpl(SRequestObj* pRequest, SQuery* pQuery, bool keepQue
   return pRequest;
 }
 
+// Runs a plan got from the plan cache, the node list is consumed.
+SRequestObj* launchCachedQueryImpl(SRequestObj* pRequest, SQueryPlan* pDag, SArray* pNodeList) {
+  if (!pRequest->inRetry) {
+    atomic_add_fetch_64((int64_t*)&getAppInfo(pRequest)->summary.numOfQueryReq, 1);
+  }
+
+  pRequest->body.execMode = QUERY_EXEC_MODE_SCHEDULE;
+  pRequest->body.subplanNum = pDag->numOfSubplans;
+  int32_t code = scheduleQuery(pRequest, pDag, pNodeList);
+  taosArrayDestroy(pNodeList);
+
+  handleQueryExecRsp(pRequest);
+
+  if (TSDB_CODE_SUCCESS != code) {
+    pRequest->code = terrno;
+  }
+  return pRequest;
+}
+
+static int32_t asyncScheduleQuery(SRequestObj* pRequest, SQueryPlan* pDag, SArray* pNodeList,
+                                  SSqlCallbackWrapper* pWrapper) {
+  SRequestConnInfo conn = {.pTrans = getAppInfo(pRequest)->pTransporter,
+                           .requestId = pRequest->requestId,
+                           .requestObjRefId = pRequest->self};
+  SSchedulerReq    req = {
+         .syncReq = false,
+         .localReq = (tsQueryPolicy == QUERY_POLICY_CLIENT),
+         .pConn = &conn,
+         .pNodeList = pNodeList,
+         .pDag = pDag,
+         .allocatorRefId = pRequest->allocatorRefId,
+         .sql = pRequest->sqlstr,
+         .startTs = pRequest->metric.start,
+         .execFp = schedulerExecCb,
+         .cbParam = pWrapper,
+         .chkKillFp = chkRequestKilled,
+         .chkKillParam = (void*)pRequest->self,
+         .pExecRes = NULL,
+  };
+  return schedulerExecJob(&req, &pRequest->body.queryJob);
+}
+
 static int32_t asyncExecSchQuery(SRequestObj* pRequest, SQuery* pQuery, SMetaData* pResultMeta,
                                  SSqlCallbackWrapper* pWrapper) {
   pRequest->type = pQuery->msgType;
@@ -1061,25 +1107,8 @@ static int32_t asyncExecSchQuery(SRequestObj* pRequest, SQuery* pQuery, SMetaDat
       buildAsyncExecNodeList(pRequest, &pNodeList, pMnodeList, pResultMeta);
     }
 
-    SRequestConnInfo conn = {.pTrans = getAppInfo(pRequest)->pTransporter,
-                             .requestId = pRequest->requestId,
-                             .requestObjRefId = pRequest->self};
-    SSchedulerReq    req = {
-           .syncReq = false,
-           .localReq = (tsQueryPolicy == QUERY_POLICY_CLIENT),
-           .pConn = &conn,
-           .pNodeList = pNodeList,
-           .pDag = pDag,
-           .allocatorRefId = pRequest->allocatorRefId,
-           .sql = pRequest->sqlstr,
-           .startTs = pRequest->metric.start,
-           .execFp = schedulerExecCb,
-           .cbParam = pWrapper,
-           .chkKillFp = chkRequestKilled,
-           .chkKillParam = (void*)pRequest->self,
-           .pExecRes = NULL,
-    };
-    code = schedulerExecJob(&req, &pRequest->body.queryJob);
+    planCachePut(pRequest, pQuery, pDag, pNodeList);
+    code = asyncScheduleQuery(pRequest, pDag, pNodeList, pWrapper);
     taosArrayDestroy(pNodeList);
   } else {
     tscDebug("0x%" PRIx64 " plan not executed, code:%s 0x%" PRIx64, pRequest->self, tstrerror(code),
@@ -1094,6 +1123,33 @@ static int32_t asyncExecSchQuery(SRequestObj* pRequest, SQuery* pQuery, SMetaDat
   return code;
 }
 
+// Runs the request with a cached plan, skipping meta fetching, semantic analysis and planning. Returns false if
+// there is no usable plan for the request, which then goes through the normal path.
+bool launchAsyncCachedQuery(SRequestObj* pRequest, SSqlCallbackWrapper* pWrapper) {
+  SQueryPlan* pDag = NULL;
+  SArray*     pNodeList = NULL;
+  int64_t     st = taosGetTimestampUs();
+  if (TSDB_CODE_SUCCESS != planCacheGet(pRequest, &pDag, &pNodeList) || NULL == pDag) {
+    return false;
+  }
+
+  pRequest->body.execMode = QUERY_EXEC_MODE_SCHEDULE;
+  pRequest->body.subplanNum = pDag->numOfSubplans;
+  if (!pRequest->inRetry) {
+    atomic_add_fetch_64((int64_t*)&getAppInfo(pRequest)->summary.numOfQueryReq, 1);
+  }
+
+  pRequest->metric.execStart = taosGetTimestampUs();
+  pRequest->metric.planCostUs = pRequest->metric.execStart - st;
+
+  int32_t code = asyncScheduleQuery(pRequest, pDag, pNodeList, pWrapper);
+  taosArrayDestroy(pNodeList);
+  if (TSDB_CODE_SUCCESS != code) {
+    pRequest->code = terrno;
+  }
+  return true;
+}
+
 void launchAsyncQuery(SRequestObj* pRequest, SQuery* pQuery, SMetaData* pResultMeta, SSqlCallbackWrapper* pWrapper) {
   int32_t code = 0;
 
@@ -528,8 +528,9 @@ void taos_stop_query(TAOS_RES *res) {
   SRequestObj *pRequest = (SRequestObj *)res;
   pRequest->killed = true;
 
-  // It is not a query, no need to stop.
-  if (NULL == pRequest->pQuery || QUERY_EXEC_MODE_SCHEDULE != pRequest->pQuery->execMode) {
+  // It is not a query, no need to stop. A query running a cached plan has no pQuery.
+  int32_t execMode = (NULL != pRequest->pQuery) ? pRequest->pQuery->execMode : pRequest->body.execMode;
+  if ((NULL == pRequest->pQuery && NULL == pRequest->planCacheKey) || QUERY_EXEC_MODE_SCHEDULE != execMode) {
     tscDebug("request 0x%" PRIx64 " no need to be killed since not query", pRequest->requestId);
     return;
   }
@@ -952,6 +953,14 @@ void doAsyncQuery(SRequestObj *pRequest, bool updateMetaForce) {
     code = catalogGetHandle(pTscObj->pAppInfo->clusterId, &pWrapper->pParseCtx->pCatalog);
   }
 
+  if (TSDB_CODE_SUCCESS == code && planCacheBuildQueryKey(pRequest)) {
+    if (updateMetaForce) {
+      planCacheRemove(pRequest);
+    } else if (launchAsyncCachedQuery(pRequest, pWrapper)) {
+      return;
+    }
+  }
+
   if (TSDB_CODE_SUCCESS == code) {
     int64_t syntaxStart = taosGetTimestampUs();
 
@@ -1338,7 +1347,7 @@ TAOS_STMT *taos_stmt_init(TAOS *taos) {
     return NULL;
   }
 
-  TAOS_STMT *pStmt = stmtInit(pObj, 0);
+  TAOS_STMT *pStmt = stmtInit(pObj, NULL);
 
   releaseTscObj(*(int64_t *)taos);
 
@@ -1353,7 +1362,23 @@ TAOS_STMT *taos_stmt_init_with_reqid(TAOS *taos, int64_t reqid) {
     return NULL;
   }
 
-  TAOS_STMT *pStmt = stmtInit(pObj, reqid);
+  TAOS_STMT_OPTIONS options = {.reqId = reqid};
+  TAOS_STMT        *pStmt = stmtInit(pObj, &options);
+
+  releaseTscObj(*(int64_t *)taos);
+
+  return pStmt;
+}
+
+TAOS_STMT *taos_stmt_init_with_options(TAOS *taos, TAOS_STMT_OPTIONS *options) {
+  STscObj *pObj = acquireTscObj(*(int64_t *)taos);
+  if (NULL == pObj) {
+    tscError("invalid parameter for %s", __FUNCTION__);
+    terrno = TSDB_CODE_TSC_DISCONNECTED;
+    return NULL;
+  }
+
+  TAOS_STMT *pStmt = stmtInit(pObj, options);
 
   releaseTscObj(*(int64_t *)taos);
 
@@ -0,0 +1,648 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catalog.h"
+#include "clientInt.h"
+#include "clientLog.h"
+#include "tglobal.h"
+#include "tname.h"
+
+typedef struct SPlanCacheDbVer {
+  char    dbFName[TSDB_DB_FNAME_LEN];
+  bool    sysDb;
+  int64_t dbId;
+  int32_t vgVersion;
+} SPlanCacheDbVer;
+
+typedef struct SPlanCacheTbVer {
+  SName    name;
+  bool     sysTable;
+  uint64_t uid;
+  int32_t  sver;
+  int32_t  tver;
+} SPlanCacheTbVer;
+
+typedef struct SPlanCacheEntry {
+  SQueryPlan* pPlan;          // never scheduled, every hit gets its own copy
+  SArray*     pExecNodeList;  // SArray<SQueryNodeLoad>
+  SSchema*    pResSchema;
+  int32_t     numOfResCols;
+  int32_t     precision;
+  int32_t     msgType;
+  int32_t     stmtType;
+  bool        stableQuery;
+  SArray*     pDbVers;  // SArray<SPlanCacheDbVer>
+  SArray*     pTbVers;     // SArray<SPlanCacheTbVer>
+  SNode*      pRangeCond;  // primary key condition the scan range is rebound from, NULL if it is fixed
+  int64_t     lastUsed;
+} SPlanCacheEntry;
+
+// Which params of a normalized statement are rebound into its plan rather than being part of the entry key.
+typedef struct SPlanCacheShape {
+  int32_t numOfParams;
+  bool    rebindable[];
+} SPlanCacheShape;
+
+struct SPlanCache {
+  SHashObj* pEntries;  // key: [user, db, normalized sql, params], value: SPlanCacheEntry
+  SHashObj* pShapes;   // key: [user, db, normalized sql], value: SPlanCacheShape
+  int32_t   capacity;
+};
+
+#define PLAN_CACHE_SHAPES_PER_ENTRY 8
+
+static void planCacheDestroyEntry(SPlanCacheEntry* pEntry) {
+  qDestroyQueryPlan(pEntry->pPlan);
+  nodesDestroyNode(pEntry->pRangeCond);
+  taosArrayDestroy(pEntry->pExecNodeList);
+  taosMemoryFree(pEntry->pResSchema);
+  taosArrayDestroy(pEntry->pDbVers);
+  taosArrayDestroy(pEntry->pTbVers);
+}
+
+static void planCacheFreeEntry(void* p) { planCacheDestroyEntry((SPlanCacheEntry*)p); }
+
+int32_t planCacheOpen(int32_t capacity, SPlanCache** ppCache) {
+  SPlanCache* pCache = taosMemoryCalloc(1, sizeof(SPlanCache));
+  if (NULL == pCache) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  pCache->capacity = capacity;
+  pCache->pEntries = taosHashInit(capacity, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false, HASH_ENTRY_LOCK);
+  if (NULL == pCache->pEntries) {
+    taosMemoryFree(pCache);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  taosHashSetFreeFp(pCache->pEntries, planCacheFreeEntry);
+  pCache->pShapes = taosHashInit(capacity, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_ENTRY_LOCK);
+  if (NULL == pCache->pShapes) {
+    planCacheClose(pCache);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  *ppCache = pCache;
+  return TSDB_CODE_SUCCESS;
+}
+
+void planCacheClose(SPlanCache* pCache) {
+  if (NULL == pCache) {
+    return;
+  }
+  taosHashCleanup(pCache->pEntries);
+  taosHashCleanup(pCache->pShapes);
+  taosMemoryFree(pCache);
+}
+
+static SPlanCache* getPlanCache(SRequestObj* pRequest) { return pRequest->pTscObj->pAppInfo->pPlanCache; }
+
+static int32_t planCacheKeyPrefixLen(SRequestObj* pRequest) {
+  return strlen(pRequest->pTscObj->user) + 1 + (NULL != pRequest->pDb ? strlen(pRequest->pDb) : 0) + 1;
+}
+
+static char* planCacheSetKeyPrefix(SRequestObj* pRequest, char* pKey) {
+  int32_t len = strlen(pRequest->pTscObj->user) + 1;
+  memcpy(pKey, pRequest->pTscObj->user, len);
+  pKey += len;
+  if (NULL != pRequest->pDb) {
+    len = strlen(pRequest->pDb);
+    memcpy(pKey, pRequest->pDb, len);
+    pKey += len;
+  }
+  *pKey++ = '\0';
+  return pKey;
+}
+
+static bool planCacheEnabled(SRequestObj* pRequest) {
+  return NULL != getPlanCache(pRequest) && !pRequest->validateOnly;
+}
+
+void planCacheClearKey(SRequestObj* pRequest) {
+  taosMemoryFreeClear(pRequest->planCacheKey);
+  pRequest->planCacheKeyLen = 0;
+  qDestroyCacheableParams(pRequest->planCacheParams);
+  pRequest->planCacheParams = NULL;
+}
+
+static bool planCacheSetKey(SRequestObj* pRequest, const char* pSql, int32_t sqlLen, SArray* pParams) {
+  int32_t keyLen = planCacheKeyPrefixLen(pRequest) + sqlLen;
+  char*   pKey = taosMemoryMalloc(keyLen);
+  if (NULL == pKey) {
+    qDestroyCacheableParams(pParams);
+    return false;
+  }
+  memcpy(planCacheSetKeyPrefix(pRequest, pKey), pSql, sqlLen);
+  pRequest->planCacheKey = pKey;
+  pRequest->planCacheKeyLen = keyLen;
+  pRequest->planCacheParams = pParams;
+  return true;
+}
+
+// The key of a statement is its text with every literal replaced by '?', the literals become its params.
+bool planCacheBuildQueryKey(SRequestObj* pRequest) {
+  if (NULL != pRequest->planCacheKey) {
+    return true;
+  }
+  if (!planCacheEnabled(pRequest)) {
+    return false;
+  }
+
+  SArray* pParams = taosArrayInit(TARRAY_MIN_SIZE, sizeof(SCacheableParam));
+  if (NULL == pParams) {
+    return false;
+  }
+  char*   pSql = NULL;
+  int32_t sqlLen = 0;
+  if (!qNormalizeCacheableSql(pRequest->sqlstr, pRequest->sqlLen, false, &pSql, &sqlLen, pParams)) {
+    qDestroyCacheableParams(pParams);
+    return false;
+  }
+
+  bool res = planCacheSetKey(pRequest, pSql, sqlLen, pParams);
+  taosMemoryFree(pSql);
+  return res;
+}
+
+static int32_t bindValueLen(const TAOS_MULTI_BIND* pBind) {
+  return NULL != pBind->length ? *(pBind->length) : tDataTypes[pBind->buffer_type].bytes;
+}
+
+static bool bindValueIsNull(const TAOS_MULTI_BIND* pBind) { return NULL != pBind->is_null && 1 == *(pBind->is_null); }
+
+// The key of a prepared statement is its text, the bound values become its params.
+bool planCacheBuildStmtKey(SRequestObj* pRequest, const char* pSql, int32_t sqlLen, TAOS_MULTI_BIND* pBinds,
+                           int32_t numOfBinds) {
+  planCacheClearKey(pRequest);
+  if (!planCacheEnabled(pRequest)) {
+    return false;
+  }
+
+  SArray* pParams = taosArrayInit(TMAX(numOfBinds, 1), sizeof(SCacheableParam));
+  if (NULL == pParams) {
+    return false;
+  }
+  for (int32_t i = 0; i < numOfBinds; ++i) {
+    TAOS_MULTI_BIND* pBind = pBinds + i;
+    SCacheableParam  param = {.bound = true, .isNull = bindValueIsNull(pBind), .type = pBind->buffer_type};
+    param.len = param.isNull ? 0 : bindValueLen(pBind);
+    param.pData = taosMemoryCalloc(1, param.len + 1);
+    if (NULL != param.pData && param.len > 0) {
+      memcpy(param.pData, pBind->buffer, param.len);
+    }
+    if (NULL == param.pData || NULL == taosArrayPush(pParams, &param)) {
+      taosMemoryFree(param.pData);
+      qDestroyCacheableParams(pParams);
+      return false;
+    }
+  }
+
+  char*   pNormalized = NULL;
+  int32_t normalizedLen = 0;
+  if (!qNormalizeCacheableSql(pSql, sqlLen, true, &pNormalized, &normalizedLen, NULL)) {
+    qDestroyCacheableParams(pParams);
+    return false;
+  }
+
+  bool res = planCacheSetKey(pRequest, pNormalized, normalizedLen, pParams);
+  taosMemoryFree(pNormalized);
+  return res;
+}
+
+static SPlanCacheShape* planCacheGetShape(SPlanCache* pCache, SRequestObj* pRequest) {
+  SPlanCacheShape* pShape = NULL;
+  int32_t          size = 0;
+  taosHashGetDup_m(pCache->pShapes, pRequest->planCacheKey, pRequest->planCacheKeyLen, (void**)&pShape, &size);
+  if (NULL != pShape && pShape->numOfParams != taosArrayGetSize(pRequest->planCacheParams)) {
+    taosMemoryFreeClear(pShape);
+  }
+  return pShape;
+}
+
+// An entry is keyed by the statement key and the params that are not rebound, each one as
+// [type, bound, null flag, length, data]. A rebindable param keeps only its type and flags in the key, with a length
+// of -1, so it is always rebound from the same type it was planned with.
+static char* planCacheBuildEntryKey(SRequestObj* pRequest, const bool* pRebindable, int32_t* pKeyLen) {
+  SArray* pParams = pRequest->planCacheParams;
+  int32_t num = taosArrayGetSize(pParams);
+  int32_t keyLen = pRequest->planCacheKeyLen;
+  for (int32_t i = 0; i < num; ++i) {
+    SCacheableParam* pParam = taosArrayGet(pParams, i);
+    keyLen += sizeof(int32_t) * 2 + sizeof(int8_t) * 2 + (pRebindable[i] ? 0 : pParam->len);
+  }
+
+  char* pKey = taosMemoryMalloc(keyLen);
+  if (NULL == pKey) {
+    return NULL;
+  }
+  memcpy(pKey, pRequest->planCacheKey, pRequest->planCacheKeyLen);
+  char* p = pKey + pRequest->planCacheKeyLen;
+  for (int32_t i = 0; i < num; ++i) {
+    SCacheableParam* pParam = taosArrayGet(pParams, i);
+    int8_t           bound = pParam->bound ? 1 : 0;
+    int8_t           isNull = pParam->isNull ? 1 : 0;
+    int32_t          len = pRebindable[i] ? -1 : pParam->len;
+    memcpy(p, &pParam->type, sizeof(int32_t));
+    p += sizeof(int32_t);
+    memcpy(p, &bound, sizeof(int8_t));
+    p += sizeof(int8_t);
+    memcpy(p, &isNull, sizeof(int8_t));
+    p += sizeof(int8_t);
+    memcpy(p, &len, sizeof(int32_t));
+    p += sizeof(int32_t);
+    if (len > 0) {
+      memcpy(p, pParam->pData, len);
+      p += len;
+    }
+  }
+  *pKeyLen = keyLen;
+  return pKey;
+}
+
+static char* planCacheGetEntryKey(SPlanCache* pCache, SRequestObj* pRequest, int32_t* pKeyLen) {
+  SPlanCacheShape* pShape = planCacheGetShape(pCache, pRequest);
+  if (NULL == pShape) {
+    return NULL;
+  }
+  char* pKey = planCacheBuildEntryKey(pRequest, pShape->rebindable, pKeyLen);
+  taosMemoryFree(pShape);
+  return pKey;
+}
+
+void planCacheRemove(SRequestObj* pRequest) {
+  SPlanCache* pCache = getPlanCache(pRequest);
+  if (NULL == pCache || NULL == pRequest->planCacheKey) {
+    return;
+  }
+  int32_t keyLen = 0;
+  char*   pKey = planCacheGetEntryKey(pCache, pRequest, &keyLen);
+  if (NULL != pKey) {
+    taosHashRemove(pCache->pEntries, pKey, keyLen);
+    taosMemoryFree(pKey);
+  }
+  taosHashRemove(pCache->pShapes, pRequest->planCacheKey, pRequest->planCacheKeyLen);
+}
+
+static bool isSysDbFName(const char* pDbFName) {
+  SName name = {0};
+  if (TSDB_CODE_SUCCESS != tNameFromString(&name, pDbFName, T_NAME_ACCT | T_NAME_DB)) {
+    return false;
+  }
+  return IS_SYS_DBNAME(name.dbname);
+}
+
+static bool planCacheCheckAuth(SRequestObj* pRequest, SCatalog* pCtg, const char* pDbFName) {
+  const char* pUser = pRequest->pTscObj->user;
+  if (0 == strcmp(pUser, TSDB_DEFAULT_USER)) {
+    return true;
+  }
+  bool pass = false;
+  bool exists = false;
+  int32_t code = catalogChkAuthFromCache(pCtg, pUser, pDbFName, AUTH_TYPE_READ, &pass, &exists);
+  return TSDB_CODE_SUCCESS == code && exists && pass;
+}
+
+static int32_t planCacheGetDbVer(SCatalog* pCtg, const char* pDbFName, SPlanCacheDbVer* pVer) {
+  tstrncpy(pVer->dbFName, pDbFName, sizeof(pVer->dbFName));
+  pVer->sysDb = isSysDbFName(pDbFName);
+  if (pVer->sysDb) {
+    return TSDB_CODE_SUCCESS;
+  }
+  int32_t tableNum = 0;
+  int64_t stateTs = 0;
+  int32_t code = catalogGetDBVgVersion(pCtg, pDbFName, &pVer->vgVersion, &pVer->dbId, &tableNum, &stateTs);
+  if (TSDB_CODE_SUCCESS == code && pVer->vgVersion < 0) {
+    code = TSDB_CODE_NOT_FOUND;
+  }
+  return code;
+}
+
+static int32_t planCacheGetTbVer(SCatalog* pCtg, const SName* pName, SPlanCacheTbVer* pVer) {
+  pVer->name = *pName;
+  pVer->sysTable = IS_SYS_DBNAME(pName->dbname);
+  if (pVer->sysTable) {
+    return TSDB_CODE_SUCCESS;
+  }
+  int32_t code = catalogGetCachedTableVer(pCtg, pName, &pVer->uid, &pVer->sver, &pVer->tver);
+  if (TSDB_CODE_SUCCESS == code && (pVer->sver < 0 || pVer->tver < 0)) {
+    code = TSDB_CODE_NOT_FOUND;
+  }
+  return code;
+}
+
+// An entry stays valid while the catalog cache still holds the same vgroup layout of every database and the same
+// table instances with the same schema and tag versions that the plan was built from.
+static bool planCacheValidate(SRequestObj* pRequest, SCatalog* pCtg, const SPlanCacheEntry* pEntry) {
+  int32_t num = taosArrayGetSize(pEntry->pDbVers);
+  for (int32_t i = 0; i < num; ++i) {
+    SPlanCacheDbVer* pCached = taosArrayGet(pEntry->pDbVers, i);
+    SPlanCacheDbVer  curr = {0};
+    if (TSDB_CODE_SUCCESS != planCacheGetDbVer(pCtg, pCached->dbFName, &curr) ||
+        curr.vgVersion != pCached->vgVersion || curr.dbId != pCached->dbId ||
+        !planCacheCheckAuth(pRequest, pCtg, pCached->dbFName)) {
+      return false;
+    }
+  }
+
+  num = taosArrayGetSize(pEntry->pTbVers);
+  for (int32_t i = 0; i < num; ++i) {
+    SPlanCacheTbVer* pCached = taosArrayGet(pEntry->pTbVers, i);
+    SPlanCacheTbVer  curr = {0};
+    if (TSDB_CODE_SUCCESS != planCacheGetTbVer(pCtg, &pCached->name, &curr) || curr.uid != pCached->uid ||
+        curr.sver != pCached->sver || curr.tver != pCached->tver) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Vgroup leaders may have moved since the plan was built, start from the endpoints the catalog knows now.
+static void planCacheRefreshEpSet(SCatalog* pCtg, SQueryPlan* pPlan) {
+  SNode* pGroup = NULL;
+  FOREACH(pGroup, pPlan->pSubplans) {
+    SNode* pNode = NULL;
+    FOREACH(pNode, ((SNodeListNode*)pGroup)->pNodeList) {
+      SSubplan* pSubplan = (SSubplan*)pNode;
+      if (SUBPLAN_TYPE_SCAN != pSubplan->subplanType || '\0' == pSubplan->dbFName[0]) {
+        continue;
+      }
+      SEpSet epSet = {0};
+      bool   exists = false;
+      if (TSDB_CODE_SUCCESS ==
+              catalogGetCachedVgEpSet(pCtg, pSubplan->dbFName, pSubplan->execNode.nodeId, &epSet, &exists) &&
+          exists) {
+        pSubplan->execNode.epSet = epSet;
+      }
+    }
+  }
+}
+
+static void planCacheRestoreRequest(SRequestObj* pRequest, const SPlanCacheEntry* pEntry) {
+  pRequest->type = pEntry->msgType;
+  pRequest->stmtType = pEntry->stmtType;
+  pRequest->stableQuery = pEntry->stableQuery;
+  if (pEntry->numOfResCols > 0) {
+    setResSchemaInfo(&pRequest->body.resInfo, pEntry->pResSchema, pEntry->numOfResCols);
+    setResPrecision(&pRequest->body.resInfo, pEntry->precision);
+  }
+
+  taosArrayDestroy(pRequest->dbList);
+  pRequest->dbList = taosArrayInit(taosArrayGetSize(pEntry->pDbVers), TSDB_DB_FNAME_LEN);
+  for (int32_t i = 0; i < taosArrayGetSize(pEntry->pDbVers); ++i) {
+    taosArrayPush(pRequest->dbList, ((SPlanCacheDbVer*)taosArrayGet(pEntry->pDbVers, i))->dbFName);
+  }
+
+  taosArrayDestroy(pRequest->tableList);
+  pRequest->tableList = taosArrayInit(taosArrayGetSize(pEntry->pTbVers), sizeof(SName));
+  for (int32_t i = 0; i < taosArrayGetSize(pEntry->pTbVers); ++i) {
+    taosArrayPush(pRequest->tableList, &((SPlanCacheTbVer*)taosArrayGet(pEntry->pTbVers, i))->name);
+  }
+}
+
+// The time range of the request is rebound into the scan range of the copy. A range that cannot be computed, for
+// example because it is empty, is left to the normal path.
+static bool planCacheRebind(const SPlanCacheEntry* pEntry, SRequestObj* pRequest, SQueryPlan* pPlan) {
+  if (NULL == pEntry->pRangeCond) {
+    return true;
+  }
+  STimeWindow range = {0};
+  if (TSDB_CODE_SUCCESS != qRebindCacheableTimeRange(pEntry->pRangeCond, pRequest->planCacheParams, &range)) {
+    return false;
+  }
+  qSetScanRange(pPlan, &range);
+  return true;
+}
+
+int32_t planCacheGet(SRequestObj* pRequest, SQueryPlan** ppPlan, SArray** ppExecNodeList) {
+  *ppPlan = NULL;
+  *ppExecNodeList = NULL;
+
+  SPlanCache* pCache = getPlanCache(pRequest);
+  if (NULL == pCache || NULL == pRequest->planCacheKey) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t keyLen = 0;
+  char*   pKey = planCacheGetEntryKey(pCache, pRequest, &keyLen);
+  if (NULL == pKey) {
+    return TSDB_CODE_SUCCESS;
+  }
+  SPlanCacheEntry* pEntry = taosHashAcquire(pCache->pEntries, pKey, keyLen);
+  if (NULL == pEntry) {
+    taosMemoryFree(pKey);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SCatalog* pCtg = NULL;
+  int32_t   code = catalogGetHandle(pRequest->pTscObj->pAppInfo->clusterId, &pCtg);
+  bool      valid = (TSDB_CODE_SUCCESS == code && planCacheValidate(pRequest, pCtg, pEntry));
+  bool      usable = valid;
+  if (valid) {
+    code = qCloneQueryPlan(pEntry->pPlan, pRequest->requestId, ppPlan);
+  }
+  if (valid && TSDB_CODE_SUCCESS == code) {
+    usable = planCacheRebind(pEntry, pRequest, *ppPlan);
+  }
+  if (usable && TSDB_CODE_SUCCESS == code) {
+    *ppExecNodeList = taosArrayDup(pEntry->pExecNodeList, NULL);
+    if (NULL == *ppExecNodeList) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+    }
+  }
+  if (usable && TSDB_CODE_SUCCESS == code) {
+    planCacheRefreshEpSet(pCtg, *ppPlan);
+    planCacheRestoreRequest(pRequest, pEntry);
+    atomic_store_64(&pEntry->lastUsed, taosGetTimestampMs());
+  }
+  taosHashRelease(pCache->pEntries, pEntry);
+
+  if (!valid) {
+    tscDebug("0x%" PRIx64 " cached plan is stale, reqId:0x%" PRIx64, pRequest->self, pRequest->requestId);
+    taosHashRemove(pCache->pEntries, pKey, keyLen);
+  } else if (!usable || TSDB_CODE_SUCCESS != code) {
+    qDestroyQueryPlan(*ppPlan);
+    *ppPlan = NULL;
+    taosArrayDestroy(*ppExecNodeList);
+    *ppExecNodeList = NULL;
+  } else {
+    tscDebug("0x%" PRIx64 " use cached plan, reqId:0x%" PRIx64, pRequest->self, pRequest->requestId);
+  }
+  taosMemoryFree(pKey);
+  return valid ? code : TSDB_CODE_SUCCESS;
+}
+
+static int32_t planCacheCollectVers(SRequestObj* pRequest, SCatalog* pCtg, SPlanCacheEntry* pEntry) {
+  int32_t num = taosArrayGetSize(pRequest->dbList);
+  pEntry->pDbVers = taosArrayInit(num, sizeof(SPlanCacheDbVer));
+  if (NULL == pEntry->pDbVers) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  for (int32_t i = 0; i < num; ++i) {
+    SPlanCacheDbVer ver = {0};
+    int32_t         code = planCacheGetDbVer(pCtg, taosArrayGet(pRequest->dbList, i), &ver);
+    if (TSDB_CODE_SUCCESS != code) {
+      return code;
+    }
+    taosArrayPush(pEntry->pDbVers, &ver);
+  }
+
+  num = taosArrayGetSize(pRequest->tableList);
+  pEntry->pTbVers = taosArrayInit(num, sizeof(SPlanCacheTbVer));
+  if (NULL == pEntry->pTbVers) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  for (int32_t i = 0; i < num; ++i) {
+    SPlanCacheTbVer ver = {0};
+    int32_t         code = planCacheGetTbVer(pCtg, taosArrayGet(pRequest->tableList, i), &ver);
+    if (TSDB_CODE_SUCCESS != code) {
+      return code;
+    }
+    taosArrayPush(pEntry->pTbVers, &ver);
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t planCacheCopyResSchema(SRequestObj* pRequest, SPlanCacheEntry* pEntry) {
+  SReqResultInfo* pResInfo = &pRequest->body.resInfo;
+  pEntry->precision = pResInfo->precision;
+  if (0 == pResInfo->numOfCols || NULL == pResInfo->fields) {
+    return TSDB_CODE_SUCCESS;
+  }
+  pEntry->pResSchema = taosMemoryCalloc(pResInfo->numOfCols, sizeof(SSchema));
+  if (NULL == pEntry->pResSchema) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  pEntry->numOfResCols = pResInfo->numOfCols;
+  for (int32_t i = 0; i < pResInfo->numOfCols; ++i) {
+    pEntry->pResSchema[i].type = pResInfo->fields[i].type;
+    pEntry->pResSchema[i].bytes = pResInfo->fields[i].bytes;
+    tstrncpy(pEntry->pResSchema[i].name, pResInfo->fields[i].name, sizeof(pEntry->pResSchema[i].name));
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
+static void planCacheEvict(SPlanCache* pCache) {
+  char*   pOldestKey = NULL;
+  size_t  oldestKeyLen = 0;
+  int64_t oldest = INT64_MAX;
+
+  SPlanCacheEntry* pEntry = taosHashIterate(pCache->pEntries, NULL);
+  while (NULL != pEntry) {
+    int64_t lastUsed = atomic_load_64(&pEntry->lastUsed);
+    if (lastUsed < oldest) {
+      size_t keyLen = 0;
+      char*  pKey = taosHashGetKey(pEntry, &keyLen);
+      char*  pCopy = taosMemoryRealloc(pOldestKey, keyLen);
+      if (NULL != pCopy) {
+        memcpy(pCopy, pKey, keyLen);
+        pOldestKey = pCopy;
+        oldestKeyLen = keyLen;
+        oldest = lastUsed;
+      }
+    }
+    pEntry = taosHashIterate(pCache->pEntries, pEntry);
+  }
+
+  if (NULL != pOldestKey) {
+    taosHashRemove(pCache->pEntries, pOldestKey, oldestKeyLen);
+    taosMemoryFree(pOldestKey);
+  }
+}
+
+// Records which params of the statement are rebound. Returns true if the shape was already known, only then the plan
+// is put, so a statement that never repeats pays for neither a plan copy nor an eviction.
+static bool planCachePutShape(SPlanCache* pCache, SRequestObj* pRequest, const SPlanCacheShape* pShape) {
+  bool seen = (NULL != taosHashGet(pCache->pShapes, pRequest->planCacheKey, pRequest->planCacheKeyLen));
+  if (!seen && taosHashGetSize(pCache->pShapes) >= pCache->capacity * PLAN_CACHE_SHAPES_PER_ENTRY) {
+    taosHashClear(pCache->pShapes);
+  }
+  taosHashPut(pCache->pShapes, pRequest->planCacheKey, pRequest->planCacheKeyLen, pShape,
+              sizeof(SPlanCacheShape) + pShape->numOfParams * sizeof(bool));
+  return seen;
+}
+
+void planCachePut(SRequestObj* pRequest, const SQuery* pQuery, const SQueryPlan* pPlan, const SArray* pExecNodeList) {
+  SPlanCache* pCache = getPlanCache(pRequest);
+  if (NULL == pCache || NULL == pRequest->planCacheKey || NULL == pQuery ||
+      (QUERY_NODE_SELECT_STMT != pRequest->stmtType && QUERY_NODE_SET_OPERATOR != pRequest->stmtType) ||
+      EXPLAIN_MODE_DISABLE != pPlan->explainInfo.mode) {
+    return;
+  }
+
+  SPlanCacheEntry entry = {.msgType = pRequest->type,
+                           .stmtType = pRequest->stmtType,
+                           .stableQuery = pRequest->stableQuery,
+                           .lastUsed = taosGetTimestampMs()};
+  char*           pKey = NULL;
+  int32_t         keyLen = 0;
+  int32_t         numOfParams = taosArrayGetSize(pRequest->planCacheParams);
+  SPlanCacheShape* pShape = taosMemoryCalloc(1, sizeof(SPlanCacheShape) + numOfParams * sizeof(bool));
+  int32_t         code = (NULL == pShape) ? TSDB_CODE_OUT_OF_MEMORY : TSDB_CODE_SUCCESS;
+  if (TSDB_CODE_SUCCESS == code) {
+    pShape->numOfParams = numOfParams;
+    STimeWindow range = {0};
+    code = qBuildCacheableTimeRange(pQuery, pRequest->planCacheParams, pShape->rebindable, &entry.pRangeCond, &range);
+    if (TSDB_CODE_SUCCESS == code && NULL != entry.pRangeCond && !qIsScanRangeRebindable(pPlan, &range)) {
+      nodesDestroyNode(entry.pRangeCond);
+      entry.pRangeCond = NULL;
+      memset(pShape->rebindable, 0, numOfParams * sizeof(bool));
+    }
+  }
+  if (TSDB_CODE_SUCCESS == code && !planCachePutShape(pCache, pRequest, pShape)) {
+    planCacheDestroyEntry(&entry);
+    taosMemoryFree(pShape);
+    return;
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    pKey = planCacheBuildEntryKey(pRequest, pShape->rebindable, &keyLen);
+    if (NULL == pKey) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+    }
+  }
+
+  SCatalog* pCtg = NULL;
+  if (TSDB_CODE_SUCCESS == code) {
+    code = catalogGetHandle(pRequest->pTscObj->pAppInfo->clusterId, &pCtg);
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    code = planCacheCollectVers(pRequest, pCtg, &entry);
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    code = planCacheCopyResSchema(pRequest, &entry);
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    entry.pExecNodeList = taosArrayDup(pExecNodeList, NULL);
+    if (NULL == entry.pExecNodeList) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+    }
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    code = qCloneQueryPlan(pPlan, 0, &entry.pPlan);
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    taosHashRemove(pCache->pEntries, pKey, keyLen);
+    if (taosHashGetSize(pCache->pEntries) >= pCache->capacity) {
+      planCacheEvict(pCache);
+    }
+    if (0 != taosHashPut(pCache->pEntries, pKey, keyLen, &entry, sizeof(SPlanCacheEntry))) {
+      code = TSDB_CODE_DUP_KEY;
+    }
+  }
+
+  if (TSDB_CODE_SUCCESS != code) {
+    planCacheDestroyEntry(&entry);
+    tscDebug("0x%" PRIx64 " plan not cached, code:%s, reqId:0x%" PRIx64, pRequest->self, tstrerror(code),
+             pRequest->requestId);
+  }
+  taosMemoryFree(pKey);
+  taosMemoryFree(pShape);
+}
@@ -282,7 +282,16 @@ int32_t stmtCleanBindInfo(STscStmt* pStmt) {
   return TSDB_CODE_SUCCESS;
 }
 
+static void stmtCleanCachedPlan(STscStmt* pStmt) {
+  qDestroyQueryPlan(pStmt->exec.pCachedPlan);
+  pStmt->exec.pCachedPlan = NULL;
+  taosArrayDestroy(pStmt->exec.pCachedNodeList);
+  pStmt->exec.pCachedNodeList = NULL;
+}
+
 int32_t stmtCleanExecInfo(STscStmt* pStmt, bool keepTable, bool deepClean) {
+  stmtCleanCachedPlan(pStmt);
+
   if (STMT_TYPE_QUERY != pStmt->sql.type || deepClean) {
     taos_free_result(pStmt->exec.pRequest);
     pStmt->exec.pRequest = NULL;
@@ -530,7 +539,7 @@ int32_t stmtResetStmt(STscStmt* pStmt) {
   return TSDB_CODE_SUCCESS;
 }
 
-TAOS_STMT* stmtInit(STscObj* taos, int64_t reqid) {
+TAOS_STMT* stmtInit(STscObj* taos, TAOS_STMT_OPTIONS* pOptions) {
   STscObj*  pObj = (STscObj*)taos;
   STscStmt* pStmt = NULL;
 
@@ -550,7 +559,10 @@ TAOS_STMT* stmtInit(STscObj* taos, int64_t reqid) {
   pStmt->taos = pObj;
   pStmt->bInfo.needParse = true;
   pStmt->sql.status = STMT_INIT;
-  pStmt->reqid = reqid;
+  if (pOptions) {
+    pStmt->reqid = pOptions->reqId;
+    pStmt->bindNoCopy = pOptions->bindNoCopy;
+  }
 
   STMT_LOG_SEQ(STMT_INIT);
 
@@ -698,6 +710,17 @@ int stmtBindBatch(TAOS_STMT* stmt, TAOS_MULTI_BIND* bind, int32_t colIdx) {
   }
 
   if (STMT_TYPE_QUERY == pStmt->sql.type) {
+    stmtCleanCachedPlan(pStmt);
+    if (colIdx >= 0) {
+      planCacheClearKey(pStmt->exec.pRequest);
+    } else if (planCacheBuildStmtKey(pStmt->exec.pRequest, pStmt->sql.sqlStr, pStmt->sql.sqlLen, bind,
+                                     taosArrayGetSize(pStmt->sql.pQuery->pPlaceholderValues))) {
+      STMT_ERR_RET(planCacheGet(pStmt->exec.pRequest, &pStmt->exec.pCachedPlan, &pStmt->exec.pCachedNodeList));
+      if (NULL != pStmt->exec.pCachedPlan) {
+        return TSDB_CODE_SUCCESS;
+      }
+    }
+
     STMT_ERR_RET(qStmtBindParams(pStmt->sql.pQuery, bind, colIdx));
 
     SParseContext ctx = {.requestId = pStmt->exec.pRequest->requestId,
@@ -751,7 +774,8 @@ int stmtBindBatch(TAOS_STMT* stmt, TAOS_MULTI_BIND* bind, int32_t colIdx) {
   }
 
   if (colIdx < 0) {
-    int32_t code = qBindStmtColsValue(*pDataBlock, bind, pStmt->exec.pRequest->msgBuf, pStmt->exec.pRequest->msgBufLen);
+    int32_t code = qBindStmtColsValue(*pDataBlock, bind, pStmt->exec.pRequest->msgBuf, pStmt->exec.pRequest->msgBufLen,
+                                      pStmt->bindNoCopy);
     if (code) {
       tscError("qBindStmtColsValue failed, error:%s", tstrerror(code));
       STMT_ERR_RET(code);
@@ -768,8 +792,9 @@ int stmtBindBatch(TAOS_STMT* stmt, TAOS_MULTI_BIND* bind, int32_t colIdx) {
       pStmt->bInfo.sBindRowNum = bind->num;
     }
 
-    qBindStmtSingleColValue(*pDataBlock, bind, pStmt->exec.pRequest->msgBuf, pStmt->exec.pRequest->msgBufLen, colIdx,
-                            pStmt->bInfo.sBindRowNum);
+    STMT_ERR_RET(qBindStmtSingleColValue(*pDataBlock, bind, pStmt->exec.pRequest->msgBuf,
+                                         pStmt->exec.pRequest->msgBufLen, colIdx, pStmt->bInfo.sBindRowNum,
+                                         pStmt->bindNoCopy));
   }
 
   return TSDB_CODE_SUCCESS;
@@ -880,7 +905,11 @@ int stmtExec(TAOS_STMT* stmt) {
 
   STMT_ERR_RET(stmtSwitchStatus(pStmt, STMT_EXECUTE));
 
-  if (STMT_TYPE_QUERY == pStmt->sql.type) {
+  if (STMT_TYPE_QUERY == pStmt->sql.type && NULL != pStmt->exec.pCachedPlan) {
+    launchCachedQueryImpl(pStmt->exec.pRequest, pStmt->exec.pCachedPlan, pStmt->exec.pCachedNodeList);
+    pStmt->exec.pCachedPlan = NULL;
+    pStmt->exec.pCachedNodeList = NULL;
+  } else if (STMT_TYPE_QUERY == pStmt->sql.type) {
     launchQueryImpl(pStmt->exec.pRequest, pStmt->sql.pQuery, true, NULL);
   } else {
     tDestroySSubmitTbData(pStmt->exec.pCurrTbData, TSDB_MSG_FLG_ENCODE);
@@ -893,6 +922,7 @@ int stmtExec(TAOS_STMT* stmt) {
   }
 
   if (pStmt->exec.pRequest->code && NEED_CLIENT_HANDLE_ERROR(pStmt->exec.pRequest->code)) {
+    planCacheRemove(pStmt->exec.pRequest);
     code = refreshMeta(pStmt->exec.pRequest->pTscObj, pStmt->exec.pRequest);
     if (code) {
       pStmt->exec.pRequest->code = code;
@@ -66,6 +66,8 @@ struct tmq_conf_t {
   int8_t         snapEnable;
   int32_t        snapBatchSize;
   bool           hbBgEnable;
+  int32_t        prefetchNum;
+  int32_t        prefetchKBytes;
   uint16_t       port;
   int32_t        autoCommitInterval;
   char*          ip;
@@ -87,6 +89,8 @@ struct tmq_t {
   int32_t  resetOffsetCfg;
   uint64_t consumerId;
   bool     hbBgEnable;
+  int32_t  prefetchNum;    // poll rsps received ahead of the application for each vgroup
+  int64_t  prefetchBytes;  // limit of the poll rsps received ahead of the application
 
   tmq_commit_cb* commitCb;
   void*          commitCbUserParam;
@@ -99,6 +103,7 @@ struct tmq_t {
   int32_t epSkipCnt;
 #endif
   int64_t pollCnt;
+  int64_t bufferedBytes;  // poll rsps in mqueue and not handled yet
 
   // timer
   tmr_h hbLiveTimer;
@@ -116,7 +121,8 @@ struct tmq_t {
   STaosQueue* delayedTask;  // delayed task queue for heartbeat and auto commit
 
   // ctl
-  tsem_t rspSem;
+  tsem_t         rspSem;
+  TdThreadRwlock lock;  // the vgs of the topics are replaced with it write locked, poll rsps read lock it
 };
 
 enum {
@@ -142,11 +148,14 @@ typedef struct {
   int64_t pollCnt;
   // offset
   STqOffsetVal committedOffset;
-  STqOffsetVal currentOffset;
+  STqOffsetVal currentOffset;  // offset of the rsps handed to the application
+  STqOffsetVal fetchOffset;    // offset of the next poll req, ahead of currentOffset by the rsps buffered
   // connection info
   int32_t vgId;
-  int32_t vgStatus;
+  int32_t vgStatus;  // TMQ_VG_STATUS__WAIT when a poll req is in flight
   int32_t vgSkipCnt;
+  int32_t bufferedRsp;  // poll rsps of the vgroup in mqueue and not handled yet
+  bool    fetchEnd;     // the last rsp received is empty, the vgroup is not polled ahead then
   SEpSet  epSet;
 } SMqClientVg;
 
@@ -163,6 +172,8 @@ typedef struct {
   int32_t         epoch;
   SMqClientVg*    vgHandle;
   SMqClientTopic* topicHandle;
+  int32_t         msgLen;
+  bool            buffered;  // counted in bufferedRsp of vgHandle, only such rsps are handed to the application
   union {
     SMqDataRsp dataRsp;
     SMqMetaRsp metaRsp;
@@ -231,6 +242,8 @@ tmq_conf_t* tmq_conf_new() {
   conf->autoCommitInterval = 5000;
   conf->resetOffset = TMQ_CONF__RESET_OFFSET__EARLIEAST;
   conf->hbBgEnable = true;
+  conf->prefetchNum = 2;
+  conf->prefetchKBytes = 64 * 1024;
 
   return conf;
 }
@@ -329,6 +342,24 @@ tmq_conf_res_t tmq_conf_set(tmq_conf_t* conf, const char* key, const char* value
     return TMQ_CONF_OK;
   }
 
+  if (strcmp(key, "msg.prefetch.num") == 0) {
+    int32_t num = atoi(value);
+    if (num < 0) {
+      return TMQ_CONF_INVALID;
+    }
+    conf->prefetchNum = num;
+    return TMQ_CONF_OK;
+  }
+
+  if (strcmp(key, "msg.prefetch.max.kbytes") == 0) {
+    int32_t kbytes = atoi(value);
+    if (kbytes <= 0) {
+      return TMQ_CONF_INVALID;
+    }
+    conf->prefetchKBytes = kbytes;
+    return TMQ_CONF_OK;
+  }
+
   if (strcmp(key, "td.connect.ip") == 0) {
     conf->ip = taosStrdup(value);
     return TMQ_CONF_OK;
@@ -872,11 +903,19 @@ static void tmqFreeRspWrapper(SMqRspWrapper* rspWrapper) {
   }
 }
 
+static void tmqRemoveBufferedRsp(tmq_t* tmq, SMqRspWrapper* rspWrapper) {
+  if (rspWrapper->tmqRspType == TMQ_MSG_TYPE__POLL_RSP || rspWrapper->tmqRspType == TMQ_MSG_TYPE__POLL_META_RSP ||
+      rspWrapper->tmqRspType == TMQ_MSG_TYPE__TAOSX_RSP) {
+    atomic_sub_fetch_64(&tmq->bufferedBytes, ((SMqPollRspWrapper*)rspWrapper)->msgLen);
+  }
+}
+
 void tmqClearUnhandleMsg(tmq_t* tmq) {
   SMqRspWrapper* rspWrapper = NULL;
   while (1) {
     taosGetQitem(tmq->qall, (void**)&rspWrapper);
     if (rspWrapper) {
+      tmqRemoveBufferedRsp(tmq, rspWrapper);
       tmqFreeRspWrapper(rspWrapper);
       taosFreeQitem(rspWrapper);
     } else {
@@ -889,6 +928,7 @@ void tmqClearUnhandleMsg(tmq_t* tmq) {
   while (1) {
     taosGetQitem(tmq->qall, (void**)&rspWrapper);
     if (rspWrapper) {
+      tmqRemoveBufferedRsp(tmq, rspWrapper);
       tmqFreeRspWrapper(rspWrapper);
       taosFreeQitem(rspWrapper);
     } else {
@@ -947,6 +987,7 @@ void tmqFreeImpl(void* handle) {
   taosFreeQall(tmq->qall);
 
   tsem_destroy(&tmq->rspSem);
+  taosThreadRwlockDestroy(&tmq->lock);
 
   int32_t sz = taosArrayGetSize(tmq->clientTopics);
   for (int32_t i = 0; i < sz; i++) {
@@ -1022,6 +1063,8 @@ tmq_t* tmq_consumer_new(tmq_conf_t* conf, char* errstr, int32_t errstrLen) {
   pTmq->resetOffsetCfg = conf->resetOffset;
 
   pTmq->hbBgEnable = conf->hbBgEnable;
+  pTmq->prefetchNum = conf->prefetchNum;
+  pTmq->prefetchBytes = conf->prefetchKBytes * 1024L;
 
   // assign consumerId
   pTmq->consumerId = tGenIdPI64();
@@ -1042,6 +1085,7 @@ tmq_t* tmq_consumer_new(tmq_conf_t* conf, char* errstr, int32_t errstrLen) {
     goto FAIL;
   }
 
+  taosThreadRwlockInit(&pTmq->lock, NULL);
   pTmq->refId = taosAddRef(tmqMgmt.rsetId, pTmq);
   if (pTmq->refId < 0) {
     tmqFreeImpl(pTmq);
@@ -1197,6 +1241,26 @@ void tmq_conf_set_auto_commit_cb(tmq_conf_t* conf, tmq_commit_cb* cb, void* para
   conf->commitCbUserParam = param;
 }
 
+static STqOffsetVal* tmqGetRspOffset(SMqPollRspWrapper* pWrapper) {
+  if (pWrapper->tmqRspType == TMQ_MSG_TYPE__POLL_RSP) {
+    return &pWrapper->dataRsp.rspOffset;
+  } else if (pWrapper->tmqRspType == TMQ_MSG_TYPE__POLL_META_RSP) {
+    return &pWrapper->metaRsp.rspOffset;
+  } else {
+    return &pWrapper->taosxRsp.rspOffset;
+  }
+}
+
+// an empty rsp means the vgroup has been consumed up, so there is nothing to prefetch
+static bool tmqRspHasData(SMqPollRspWrapper* pWrapper) {
+  if (pWrapper->tmqRspType == TMQ_MSG_TYPE__POLL_RSP) {
+    return pWrapper->dataRsp.blockNum > 0;
+  } else if (pWrapper->tmqRspType == TMQ_MSG_TYPE__TAOSX_RSP) {
+    return pWrapper->taosxRsp.blockNum > 0;
+  }
+  return false;
+}
+
 int32_t tmqPollCb(void* param, SDataBuf* pMsg, int32_t code) {
   SMqPollCbParam* pParam = (SMqPollCbParam*)param;
   SMqClientVg*    pVg = pParam->pVg;
@@ -1269,6 +1333,7 @@ int32_t tmqPollCb(void* param, SDataBuf* pMsg, int32_t code) {
   pRspWrapper->tmqRspType = rspType;
   pRspWrapper->vgHandle = pVg;
   pRspWrapper->topicHandle = pTopic;
+  pRspWrapper->msgLen = pMsg->len;
 
   if (rspType == TMQ_MSG_TYPE__POLL_RSP) {
     SDecoder decoder;
@@ -1300,14 +1365,32 @@ int32_t tmqPollCb(void* param, SDataBuf* pMsg, int32_t code) {
 
   tscDebug("consumer:0x%" PRIx64 ", put poll res into mqueue %p", tmq->consumerId, pRspWrapper);
 
+  // The vgs are not replaced while the lock is held, so pVg is still the vgroup polled if the epoch is unchanged. Only
+  // the rsp of the current epoch is counted for the vgroup, the next poll req of it starts from where the rsp ends and
+  // is sent by tmqPollImpl, ahead of the application as long as the rsps received ahead are within the limits.
+  taosThreadRwlockRdlock(&tmq->lock);
+  if (epoch == tmq->epoch) {
+    if (msgEpoch == epoch) {
+      pRspWrapper->buffered = true;
+      atomic_add_fetch_32(&pVg->bufferedRsp, 1);
+      pVg->fetchOffset = *tmqGetRspOffset(pRspWrapper);
+      pVg->fetchEnd = !tmqRspHasData(pRspWrapper);
+    }
+    atomic_store_32(&pVg->vgStatus, TMQ_VG_STATUS__IDLE);
+  }
+  taosThreadRwlockUnlock(&tmq->lock);
+
+  atomic_add_fetch_64(&tmq->bufferedBytes, pRspWrapper->msgLen);
   taosWriteQitem(tmq->mqueue, pRspWrapper);
   tsem_post(&tmq->rspSem);
 
   return 0;
 CREATE_MSG_FAIL:
+  taosThreadRwlockRdlock(&tmq->lock);
   if (epoch == tmq->epoch) {
     atomic_store_32(&pVg->vgStatus, TMQ_VG_STATUS__IDLE);
   }
+  taosThreadRwlockUnlock(&tmq->lock);
   tsem_post(&tmq->rspSem);
   return -1;
 }
@@ -1376,6 +1459,7 @@ bool tmqUpdateEp(tmq_t* tmq, int32_t epoch, const SMqAskEpRsp* pRsp) {
       SMqClientVg clientVg = {
           .pollCnt = 0,
           .currentOffset = offsetNew,
+          .fetchOffset = offsetNew,
           .vgId = pVgEp->vgId,
           .epSet = pVgEp->epSet,
           .vgStatus = TMQ_VG_STATUS__IDLE,
@@ -1387,7 +1471,8 @@ bool tmqUpdateEp(tmq_t* tmq, int32_t epoch, const SMqAskEpRsp* pRsp) {
     taosArrayPush(newTopics, &topic);
   }
 
-  // destroy current buffered existed topics info
+  // destroy current buffered existed topics info, no poll rsp refers to them once the epoch is updated
+  taosThreadRwlockWrlock(&tmq->lock);
   if (tmq->clientTopics) {
     int32_t sz = taosArrayGetSize(tmq->clientTopics);
     for (int32_t i = 0; i < sz; i++) {
@@ -1409,6 +1494,7 @@ bool tmqUpdateEp(tmq_t* tmq, int32_t epoch, const SMqAskEpRsp* pRsp) {
   }
 
   atomic_store_32(&tmq->epoch, epoch);
+  taosThreadRwlockUnlock(&tmq->lock);
   tscDebug("consumer:0x%" PRIx64 " update topic info completed", tmq->consumerId);
   return set;
 }
@@ -1585,7 +1671,7 @@ void tmqBuildConsumeReqImpl(SMqPollReq* pReq, tmq_t* tmq, int64_t timeout, SMqCl
   pReq->timeout = timeout;
   pReq->epoch = tmq->epoch;
   /*pReq->currentOffset = reqOffset;*/
-  pReq->reqOffset = pVg->currentOffset;
+  pReq->reqOffset = pVg->fetchOffset;
   pReq->head.vgId = pVg->vgId;
   pReq->useSnapshot = tmq->useSnapshot;
   pReq->reqId = generateRequestId();
@@ -1696,7 +1782,7 @@ static int32_t doTmqPollImpl(tmq_t* pTmq, SMqClientTopic* pTopic, SMqClientVg* p
 
   int64_t transporterId = 0;
   char    offsetFormatBuf[80];
-  tFormatOffset(offsetFormatBuf, tListLen(offsetFormatBuf), &pVg->currentOffset);
+  tFormatOffset(offsetFormatBuf, tListLen(offsetFormatBuf), &pVg->fetchOffset);
 
   tscDebug("consumer:0x%" PRIx64 " send poll to %s vgId:%d, epoch %d, req offset:%s, reqId:0x%" PRIx64,
            pTmq->consumerId, pTopic->topicName, pVg->vgId, pTmq->epoch, offsetFormatBuf, req.reqId);
@@ -1708,6 +1794,11 @@ static int32_t doTmqPollImpl(tmq_t* pTmq, SMqClientTopic* pTopic, SMqClientVg* p
   return TSDB_CODE_SUCCESS;
 }
 
+static bool tmqNeedPollVg(tmq_t* tmq, SMqClientVg* pVg) {
+  return tmqPrefetchAllowed(atomic_load_32(&pVg->bufferedRsp), pVg->fetchEnd, tmq->prefetchNum,
+                            atomic_load_64(&tmq->bufferedBytes), tmq->prefetchBytes);
+}
+
 // broadcast the poll request to all related vnodes
 int32_t tmqPollImpl(tmq_t* tmq, int64_t timeout) {
   int32_t numOfTopics = taosArrayGetSize(tmq->clientTopics);
@@ -1735,6 +1826,11 @@ int32_t tmqPollImpl(tmq_t* tmq, int64_t timeout) {
 #endif
       }
 
+      if (!tmqNeedPollVg(tmq, pVg)) {
+        atomic_store_32(&pVg->vgStatus, TMQ_VG_STATUS__IDLE);
+        continue;
+      }
+
       atomic_store_32(&pVg->vgSkipCnt, 0);
       int32_t code = doTmqPollImpl(tmq, pTopic, pVg, timeout);
       if (code != TSDB_CODE_SUCCESS) {
@@ -1782,6 +1878,7 @@ void* tmqHandleAllRsp(tmq_t* tmq, int64_t timeout, bool pollIfReset) {
       }
     }
 
+    tmqRemoveBufferedRsp(tmq, rspWrapper);
     if (rspWrapper->tmqRspType == TMQ_MSG_TYPE__END_RSP) {
       taosFreeQitem(rspWrapper);
       terrno = TSDB_CODE_TQ_NO_COMMITTED_OFFSET;
@@ -1791,12 +1888,12 @@ void* tmqHandleAllRsp(tmq_t* tmq, int64_t timeout, bool pollIfReset) {
       tscDebug("consumer:0x%" PRIx64 " process poll rsp", tmq->consumerId);
       /*atomic_sub_fetch_32(&tmq->readyRequest, 1);*/
       int32_t consumerEpoch = atomic_load_32(&tmq->epoch);
-      if (pollRspWrapper->dataRsp.head.epoch == consumerEpoch) {
+      if (pollRspWrapper->buffered && pollRspWrapper->dataRsp.head.epoch == consumerEpoch) {
         SMqClientVg* pVg = pollRspWrapper->vgHandle;
         /*printf("vgId:%d, offset %" PRId64 " up to %" PRId64 "\n", pVg->vgId, pVg->currentOffset,
          * rspMsg->msg.rspOffset);*/
         pVg->currentOffset = pollRspWrapper->dataRsp.rspOffset;
-        atomic_store_32(&pVg->vgStatus, TMQ_VG_STATUS__IDLE);
+        atomic_sub_fetch_32(&pVg->bufferedRsp, 1);
         if (pollRspWrapper->dataRsp.blockNum == 0) {
           taosFreeQitem(pollRspWrapper);
           rspWrapper = NULL;
@@ -1818,12 +1915,12 @@ void* tmqHandleAllRsp(tmq_t* tmq, int64_t timeout, bool pollIfReset) {
 
       tscDebug("consumer:0x%" PRIx64 " process meta rsp", tmq->consumerId);
 
-      if (pollRspWrapper->metaRsp.head.epoch == consumerEpoch) {
+      if (pollRspWrapper->buffered && pollRspWrapper->metaRsp.head.epoch == consumerEpoch) {
         SMqClientVg* pVg = pollRspWrapper->vgHandle;
         /*printf("vgId:%d, offset %" PRId64 " up to %" PRId64 "\n", pVg->vgId, pVg->currentOffset,
          * rspMsg->msg.rspOffset);*/
         pVg->currentOffset = pollRspWrapper->metaRsp.rspOffset;
-        atomic_store_32(&pVg->vgStatus, TMQ_VG_STATUS__IDLE);
+        atomic_sub_fetch_32(&pVg->bufferedRsp, 1);
         // build rsp
         SMqMetaRspObj* pRsp = tmqBuildMetaRspFromWrapper(pollRspWrapper);
         taosFreeQitem(pollRspWrapper);
@@ -1838,12 +1935,12 @@ void* tmqHandleAllRsp(tmq_t* tmq, int64_t timeout, bool pollIfReset) {
       SMqPollRspWrapper* pollRspWrapper = (SMqPollRspWrapper*)rspWrapper;
       /*atomic_sub_fetch_32(&tmq->readyRequest, 1);*/
       int32_t consumerEpoch = atomic_load_32(&tmq->epoch);
-      if (pollRspWrapper->taosxRsp.head.epoch == consumerEpoch) {
+      if (pollRspWrapper->buffered && pollRspWrapper->taosxRsp.head.epoch == consumerEpoch) {
         SMqClientVg* pVg = pollRspWrapper->vgHandle;
         /*printf("vgId:%d, offset %" PRId64 " up to %" PRId64 "\n", pVg->vgId, pVg->currentOffset,
          * rspMsg->msg.rspOffset);*/
         pVg->currentOffset = pollRspWrapper->taosxRsp.rspOffset;
-        atomic_store_32(&pVg->vgStatus, TMQ_VG_STATUS__IDLE);
+        atomic_sub_fetch_32(&pVg->bufferedRsp, 1);
         if (pollRspWrapper->taosxRsp.blockNum == 0) {
           taosFreeQitem(pollRspWrapper);
           rspWrapper = NULL;
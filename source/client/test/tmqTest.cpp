@@ -38,6 +38,41 @@ TEST(testCase, driverInit_Test) {
   //  taos_init();
 }
 
+namespace {
+
+// rsps buffered for one vgroup when it is polled as long as it is allowed to, with nothing consumed meanwhile
+int32_t tmqTestBufferRsp(bool fetchEnd, int32_t prefetchNum, int64_t rspBytes, int64_t prefetchBytes) {
+  int32_t bufferedRsp = 0;
+  int64_t bufferedBytes = 0;
+  while (tmqPrefetchAllowed(bufferedRsp, fetchEnd, prefetchNum, bufferedBytes, prefetchBytes)) {
+    bufferedRsp++;
+    bufferedBytes += rspBytes;
+    if (bufferedRsp > prefetchNum + 1) break;
+  }
+  return bufferedRsp;
+}
+
+}  // namespace
+
+TEST(testCase, prefetch_num_Test) {
+  // the vgroup is polled once without prefetching
+  ASSERT_EQ(tmqTestBufferRsp(false, 0, 100, 1024), 1);
+
+  ASSERT_EQ(tmqTestBufferRsp(false, 1, 100, 1024), 1);
+  ASSERT_EQ(tmqTestBufferRsp(false, 2, 100, 1024), 2);
+  ASSERT_EQ(tmqTestBufferRsp(false, 8, 100, 1024 * 1024), 8);
+
+  // nothing is prefetched for a consumed up vgroup
+  ASSERT_EQ(tmqTestBufferRsp(true, 8, 100, 1024 * 1024), 1);
+
+  // the bytes limit stops the prefetch before prefetchNum
+  ASSERT_EQ(tmqTestBufferRsp(false, 8, 100, 250), 3);
+
+  // an empty vgroup is polled even if the bytes limit is exceeded by the others
+  ASSERT_TRUE(tmqPrefetchAllowed(0, true, 2, 2048, 1024));
+  ASSERT_FALSE(tmqPrefetchAllowed(1, false, 2, 2048, 1024));
+}
+
 TEST(testCase, create_topic_ctb_Test) {
   TAOS* pConn = taos_connect("localhost", "root", "taosdata", NULL, 0);
   assert(pConn != NULL);
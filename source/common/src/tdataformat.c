@@ -1557,7 +1557,12 @@ void tColDataDestroy(void *ph) {
 
   tFree(pColData->pBitMap);
   tFree(pColData->aOffset);
-  tFree(pColData->pData);
+  if (pColData->borrowed) {
+    pColData->pData = NULL;
+    pColData->borrowed = 0;
+  } else {
+    tFree(pColData->pData);
+  }
 }
 
 void tColDataInit(SColData *pColData, int16_t cid, int8_t type, int8_t smaOn) {
@@ -1574,6 +1579,12 @@ void tColDataClear(SColData *pColData) {
   pColData->nVal = 0;
   pColData->flag = 0;
   pColData->nData = 0;
+
+  // the borrowed buffer is given back to the caller, the next value is put into an own one
+  if (pColData->borrowed) {
+    pColData->pData = NULL;
+    pColData->borrowed = 0;
+  }
 }
 
 void tColDataDeepClear(SColData *pColData) {
@@ -1584,6 +1595,21 @@ void tColDataDeepClear(SColData *pColData) {
   tColDataClear(pColData);
 }
 
+// the borrowed values are copied into an own buffer before the column is changed in place
+static int32_t tColDataOwnData(SColData *pColData) {
+  uint8_t *pData = NULL;
+
+  if (pColData->nData > 0) {
+    int32_t code = tRealloc(&pData, pColData->nData);
+    if (code) return code;
+    memcpy(pData, pColData->pData, pColData->nData);
+  }
+
+  pColData->pData = pData;
+  pColData->borrowed = 0;
+  return 0;
+}
+
 static FORCE_INLINE int32_t tColDataPutValue(SColData *pColData, uint8_t *pData, uint32_t nData) {
   int32_t code = 0;
 
@@ -1949,6 +1975,10 @@ static int32_t (*tColDataAppendValueImpl[8][3])(SColData *pColData, uint8_t *pDa
 };
 int32_t tColDataAppendValue(SColData *pColData, SColVal *pColVal) {
   ASSERT(pColData->cid == pColVal->cid && pColData->type == pColVal->type);
+  if (pColData->borrowed) {
+    int32_t code = tColDataOwnData(pColData);
+    if (code) return code;
+  }
   return tColDataAppendValueImpl[pColData->flag][pColVal->flag](
       pColData, IS_VAR_DATA_TYPE(pColData->type) ? pColVal->value.pData : (uint8_t *)&pColVal->value.val,
       pColVal->value.nData);
@@ -2260,6 +2290,11 @@ int32_t tColDataUpdateValue(SColData *pColData, SColVal *pColVal, bool forward)
 
   if (tColDataUpdateValueImpl[pColData->flag][pColVal->flag] == NULL) return 0;
 
+  if (pColData->borrowed) {
+    int32_t code = tColDataOwnData(pColData);
+    if (code) return code;
+  }
+
   return tColDataUpdateValueImpl[pColData->flag][pColVal->flag](
       pColData, IS_VAR_DATA_TYPE(pColData->type) ? pColVal->value.pData : (uint8_t *)&pColVal->value.val,
       pColVal->value.nData, forward);
@@ -2381,6 +2416,7 @@ int32_t tColDataCopy(SColData *pColDataFrom, SColData *pColData, xMallocFn xMall
   int32_t code = 0;
 
   *pColData = *pColDataFrom;
+  pColData->borrowed = 0;
 
   // bitmap
   switch (pColData->flag) {
@@ -2489,62 +2525,152 @@ _exit:
   return code;
 }
 
-int32_t tColDataAddValueByBind(SColData *pColData, TAOS_MULTI_BIND *pBind) {
+// fixed-length values of the bind are appended in bulk as long as the column needs no NONE bits
+static int32_t tColDataAddFixedValueByBind(SColData *pColData, TAOS_MULTI_BIND *pBind) {
   int32_t code = 0;
+  int32_t nBytes = TYPE_BYTES[pColData->type];
+  int32_t nNull = 0;
 
-  ASSERT(pColData->type == pBind->buffer_type);
+  if (pBind->is_null) {
+    for (int32_t i = 0; i < pBind->num; ++i) {
+      nNull += (pBind->is_null[i] != 0);
+    }
+  }
 
-  if (IS_VAR_DATA_TYPE(pBind->buffer_type)) {  // var-length data type
+  if (nNull == pBind->num && (pColData->flag == 0 || pColData->flag == HAS_NULL)) {
+    pColData->flag = HAS_NULL;
+    pColData->numOfNull += nNull;
+    pColData->nVal += nNull;
+    goto _exit;
+  }
+
+  if (nNull == 0 && (pColData->flag == 0 || pColData->flag == HAS_VALUE)) {
+    code = tRealloc(&pColData->pData, pColData->nData + (int64_t)nBytes * pBind->num);
+    if (code) goto _exit;
+    memcpy(pColData->pData + pColData->nData, pBind->buffer, (int64_t)nBytes * pBind->num);
+
+    pColData->flag = HAS_VALUE;
+    pColData->numOfValue += pBind->num;
+    pColData->nVal += pBind->num;
+    pColData->nData += nBytes * pBind->num;
+    goto _exit;
+  }
+
+  if (pColData->flag == 0 || pColData->flag == HAS_VALUE || pColData->flag == (HAS_VALUE | HAS_NULL)) {
+    code = tRealloc(&pColData->pBitMap, BIT1_SIZE(pColData->nVal + pBind->num));
+    if (code) goto _exit;
+    code = tRealloc(&pColData->pData, pColData->nData + (int64_t)nBytes * pBind->num);
+    if (code) goto _exit;
+
+    if (pColData->flag == HAS_VALUE) {
+      memset(pColData->pBitMap, 255, BIT1_SIZE(pColData->nVal));
+    }
+
+    uint8_t *pData = pColData->pData + pColData->nData;
+    if (nNull < pBind->num) {
+      memcpy(pData, pBind->buffer, (int64_t)nBytes * pBind->num);
+    }
     for (int32_t i = 0; i < pBind->num; ++i) {
       if (pBind->is_null && pBind->is_null[i]) {
-        code = tColDataAppendValueImpl[pColData->flag][CV_FLAG_NULL](pColData, NULL, 0);
-        if (code) goto _exit;
+        SET_BIT1_EX(pColData->pBitMap, pColData->nVal + i, 0);
+        memset(pData + nBytes * i, 0, nBytes);
       } else {
-        code = tColDataAppendValueImpl[pColData->flag][CV_FLAG_VALUE](
-            pColData, (uint8_t *)pBind->buffer + pBind->buffer_length * i, pBind->length[i]);
+        SET_BIT1_EX(pColData->pBitMap, pColData->nVal + i, 1);
       }
     }
-  } else {  // fixed-length data type
-    bool allValue;
-    bool allNull;
-    if (pBind->is_null) {
-      bool same = (memcmp(pBind->is_null, pBind->is_null + 1, pBind->num - 1) == 0);
-      allNull = (same && pBind->is_null[0] != 0);
-      allValue = (same && pBind->is_null[0] == 0);
+
+    pColData->flag = (HAS_VALUE | HAS_NULL);
+    pColData->numOfValue += (pBind->num - nNull);
+    pColData->numOfNull += nNull;
+    pColData->nVal += pBind->num;
+    pColData->nData += nBytes * pBind->num;
+    goto _exit;
+  }
+
+  for (int32_t i = 0; i < pBind->num; ++i) {
+    if (pBind->is_null && pBind->is_null[i]) {
+      code = tColDataAppendValueImpl[pColData->flag][CV_FLAG_NULL](pColData, NULL, 0);
     } else {
-      allNull = false;
-      allValue = true;
+      code = tColDataAppendValueImpl[pColData->flag][CV_FLAG_VALUE](pColData, (uint8_t *)pBind->buffer + nBytes * i,
+                                                                    pBind->buffer_length);
     }
+    if (code) goto _exit;
+  }
 
-    if (allValue) {
-      // optimize (todo)
-      for (int32_t i = 0; i < pBind->num; ++i) {
-        code = tColDataAppendValueImpl[pColData->flag][CV_FLAG_VALUE](
-            pColData, (uint8_t *)pBind->buffer + TYPE_BYTES[pColData->type] * i, pBind->buffer_length);
+_exit:
+  return code;
+}
+
+int32_t tColDataAddValueByBind(SColData *pColData, TAOS_MULTI_BIND *pBind) {
+  int32_t code = 0;
+
+  ASSERT(pColData->type == pBind->buffer_type);
+
+  if (pColData->borrowed) {
+    code = tColDataOwnData(pColData);
+    if (code) goto _exit;
+  }
+
+  if (IS_VAR_DATA_TYPE(pBind->buffer_type)) {  // var-length data type
+    // reserve the space of the whole bind at once
+    int64_t nData = pColData->nData;
+    for (int32_t i = 0; i < pBind->num; ++i) {
+      if (pBind->is_null == NULL || pBind->is_null[i] == 0) {
+        nData += pBind->length[i];
       }
-    } else if (allNull) {
-      // optimize (todo)
-      for (int32_t i = 0; i < pBind->num; ++i) {
+    }
+    code = tRealloc((uint8_t **)(&pColData->aOffset), ((int64_t)(pColData->nVal + pBind->num)) << 2);
+    if (code) goto _exit;
+    if (nData > 0) {
+      code = tRealloc(&pColData->pData, nData);
+      if (code) goto _exit;
+    }
+
+    for (int32_t i = 0; i < pBind->num; ++i) {
+      if (pBind->is_null && pBind->is_null[i]) {
         code = tColDataAppendValueImpl[pColData->flag][CV_FLAG_NULL](pColData, NULL, 0);
-        if (code) goto _exit;
-      }
-    } else {
-      for (int32_t i = 0; i < pBind->num; ++i) {
-        if (pBind->is_null[i]) {
-          code = tColDataAppendValueImpl[pColData->flag][CV_FLAG_NULL](pColData, NULL, 0);
-          if (code) goto _exit;
-        } else {
-          code = tColDataAppendValueImpl[pColData->flag][CV_FLAG_VALUE](
-              pColData, (uint8_t *)pBind->buffer + TYPE_BYTES[pColData->type] * i, pBind->buffer_length);
-        }
+      } else {
+        code = tColDataAppendValueImpl[pColData->flag][CV_FLAG_VALUE](
+            pColData, (uint8_t *)pBind->buffer + pBind->buffer_length * i, pBind->length[i]);
       }
+      if (code) goto _exit;
     }
+  } else {  // fixed-length data type
+    code = tColDataAddFixedValueByBind(pColData, pBind);
   }
 
 _exit:
   return code;
 }
 
+// the column takes the values of a fixed-length bind without copying them, the caller should keep the buffer unchanged
+// until the data is sent. Binds with null values or to a column holding values already are copied as usual.
+int32_t tColDataBorrowByBind(SColData *pColData, TAOS_MULTI_BIND *pBind) {
+  ASSERT(pColData->type == pBind->buffer_type);
+
+  if (IS_VAR_DATA_TYPE(pBind->buffer_type) || pColData->nVal > 0 || pBind->num <= 0) {
+    return tColDataAddValueByBind(pColData, pBind);
+  }
+
+  if (pBind->is_null) {
+    for (int32_t i = 0; i < pBind->num; ++i) {
+      if (pBind->is_null[i]) return tColDataAddValueByBind(pColData, pBind);
+    }
+  }
+
+  if (!pColData->borrowed) {
+    tFree(pColData->pData);
+  }
+  pColData->pData = (uint8_t *)pBind->buffer;
+  pColData->borrowed = 1;
+  pColData->flag = HAS_VALUE;
+  pColData->numOfValue = pBind->num;
+  pColData->nVal = pBind->num;
+  pColData->nData = TYPE_BYTES[pColData->type] * pBind->num;
+
+  return 0;
+}
+
 static int32_t tColDataSwapValue(SColData *pColData, int32_t i, int32_t j) {
   int32_t code = 0;
 
@@ -3039,6 +3165,14 @@ void tColDataSortMerge(SArray *colDataArr) {
     }
   }
 
+  // the rows are moved in place, which should not happen to the buffers of the caller
+  if (doSort || doMerge) {
+    for (int32_t iColData = 0; iColData < nColData; ++iColData) {
+      if (aColData[iColData].borrowed && tColDataOwnData(&aColData[iColData]) != 0) goto _exit;
+    }
+    aKey = (TSKEY *)aColData[0].pData;
+  }
+
   // sort -------
   if (doSort) {
     tColDataSort(aColData, nColData);
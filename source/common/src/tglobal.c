@@ -44,6 +44,7 @@ int32_t tsNumOfRpcThreads = 1;
 int32_t tsNumOfRpcSessions = 6000;
 int32_t tsTimeToGetAvailableConn = 500000;
 int32_t tsNumOfCommitThreads = 2;
+int32_t tsNumOfApplyThreads = 0;
 int32_t tsNumOfTaskQueueThreads = 4;
 int32_t tsNumOfMnodeQueryThreads = 4;
 int32_t tsNumOfMnodeFetchThreads = 1;
@@ -67,6 +68,7 @@ int64_t tsVndCommitMaxIntervalMs = 600 * 1000;
 
 // mnode
 int64_t tsMndSdbWriteDelta = 200;
+int32_t tsMndSdbDeltaSegments = 16;
 int64_t tsMndLogRetention = 2000;
 
 // monitor
@@ -99,12 +101,16 @@ char tsSmlChildTableName[TSDB_TABLE_NAME_LEN] = "";  // user defined child table
 // query
 int32_t tsQueryPolicy = 1;
 int32_t tsQueryRspPolicy = 0;
+int32_t tsQueryTimeSlice = 100;    // ms a query task may run before it yields the query thread, 0 means never
+int32_t tsQueryAdmitMemory = 0;    // MB of estimated memory the running query tasks may take, 0 means no limit
+int32_t tsQueryMemoryLimit = 0;    // MB of spillable buffers one query may hold on a node, 0 means no limit
 bool    tsEnableQueryHb = false;
 int32_t tsQuerySmaOptimize = 0;
 int32_t tsQueryRsmaTolerance = 1000;  // the tolerance time (ms) to judge from which level to query rsma data.
 bool    tsQueryPlannerTrace = false;
 int32_t tsQueryNodeChunkSize = 32 * 1024;
 bool    tsQueryUseNodeAllocator = true;
+int32_t tsQueryPlanCacheSize = 128;  // 0 means the client plan cache is disabled
 bool    tsKeepColumnName = false;
 int32_t tsRedirectPeriod = 10;
 int32_t tsRedirectFactor = 2;
@@ -180,7 +186,8 @@ uint32_t tsCurRange = 100;                      // range
 char     tsCompressor[32] = "ZSTD_COMPRESSOR";  // ZSTD_COMPRESSOR or GZIP_COMPRESSOR
 
 // udf
-bool tsStartUdfd = true;
+bool    tsStartUdfd = true;
+int32_t tsUdfShmSize = 16;  // MB of shared memory for the data of each udf session, 0 to send the data by pipe
 
 // wal
 int64_t tsWalFsyncDataSizeLimit = (100 * 1024 * 1024L);
@@ -196,6 +203,13 @@ int32_t tsUptimeInterval = 300;    // seconds
 char    tsUdfdResFuncs[512] = "";  // udfd resident funcs that teardown when udfd exits
 char    tsUdfdLdLibPath[512] = "";
 bool    tsDisableStream = false;
+int32_t tsStreamDispatchWindow = 4;        // dispatch msgs sent to a downstream task before its rsp
+int32_t tsStreamDispatchBatchSize = 1024;  // KB of output blocks coalesced into one dispatch msg
+int32_t tsStreamQueueLimit = 256;          // queued items of a stream task before its upstream is held on
+bool    tsTdbWalMode = false;              // meta and stream state commit through a write-ahead log
+int32_t tsExchangeFetchWindow = 2;         // rsps of a remote source received ahead of the downstream
+int32_t tsExchangeBufferSize = 16;         // MB of remote rsps received ahead by an exchange operator
+int32_t tsRetentionSpeedLimitMB = 0;       // MB/s of file sets migrated between tiers on a node, 0 means no limit
 
 #ifndef _STORAGE
 int32_t taosSetTfsCfg(SConfig *pCfg) {
@@ -322,6 +336,7 @@ static int32_t taosAddClientCfg(SConfig *pCfg) {
   if (cfgAddBool(pCfg, "queryPlannerTrace", tsQueryPlannerTrace, true) != 0) return -1;
   if (cfgAddInt32(pCfg, "queryNodeChunkSize", tsQueryNodeChunkSize, 1024, 128 * 1024, true) != 0) return -1;
   if (cfgAddBool(pCfg, "queryUseNodeAllocator", tsQueryUseNodeAllocator, true) != 0) return -1;
+  if (cfgAddInt32(pCfg, "queryPlanCacheSize", tsQueryPlanCacheSize, 0, 65536, true) != 0) return -1;
   if (cfgAddBool(pCfg, "keepColumnName", tsKeepColumnName, true) != 0) return -1;
   if (cfgAddString(pCfg, "smlChildTableName", "", 1) != 0) return -1;
   if (cfgAddString(pCfg, "smlTagName", tsSmlTagName, 1) != 0) return -1;
@@ -401,6 +416,9 @@ static int32_t taosAddServerCfg(SConfig *pCfg) {
   if (cfgAddInt32(pCfg, "queryBufferSize", tsQueryBufferSize, -1, 500000000000, 0) != 0) return -1;
   if (cfgAddBool(pCfg, "printAuth", tsPrintAuth, 0) != 0) return -1;
   if (cfgAddInt32(pCfg, "queryRspPolicy", tsQueryRspPolicy, 0, 1, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "queryTimeSlice", tsQueryTimeSlice, 0, 3600 * 1000, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "queryAdmitMemory", tsQueryAdmitMemory, 0, INT32_MAX, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "queryMemoryLimit", tsQueryMemoryLimit, 0, INT32_MAX, 0) != 0) return -1;
 
   tsNumOfRpcThreads = tsNumOfCores / 2;
   tsNumOfRpcThreads = TRANGE(tsNumOfRpcThreads, 2, TSDB_MAX_RPC_THREADS);
@@ -416,6 +434,9 @@ static int32_t taosAddServerCfg(SConfig *pCfg) {
   tsNumOfCommitThreads = TRANGE(tsNumOfCommitThreads, 2, 4);
   if (cfgAddInt32(pCfg, "numOfCommitThreads", tsNumOfCommitThreads, 1, 1024, 0) != 0) return -1;
 
+  // parallel apply is off unless configured, each vnode starts this many threads
+  if (cfgAddInt32(pCfg, "numOfApplyThreads", tsNumOfApplyThreads, 0, 16, 0) != 0) return -1;
+
   tsNumOfMnodeReadThreads = tsNumOfCores / 8;
   tsNumOfMnodeReadThreads = TRANGE(tsNumOfMnodeReadThreads, 1, 4);
   if (cfgAddInt32(pCfg, "numOfMnodeReadThreads", tsNumOfMnodeReadThreads, 1, 1024, 0) != 0) return -1;
@@ -462,6 +483,7 @@ static int32_t taosAddServerCfg(SConfig *pCfg) {
   if (cfgAddInt64(pCfg, "vndCommitMaxInterval", tsVndCommitMaxIntervalMs, 1000, 1000 * 60 * 60, 0) != 0) return -1;
 
   if (cfgAddInt64(pCfg, "mndSdbWriteDelta", tsMndSdbWriteDelta, 20, 10000, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "mndSdbDeltaSegments", tsMndSdbDeltaSegments, 0, 1024, 0) != 0) return -1;
   if (cfgAddInt64(pCfg, "mndLogRetention", tsMndLogRetention, 500, 10000, 0) != 0) return -1;
 
   if (cfgAddBool(pCfg, "monitor", tsEnableMonitor, 0) != 0) return -1;
@@ -490,8 +512,16 @@ static int32_t taosAddServerCfg(SConfig *pCfg) {
   if (cfgAddBool(pCfg, "udf", tsStartUdfd, 0) != 0) return -1;
   if (cfgAddString(pCfg, "udfdResFuncs", tsUdfdResFuncs, 0) != 0) return -1;
   if (cfgAddString(pCfg, "udfdLdLibPath", tsUdfdLdLibPath, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "udfShmSize", tsUdfShmSize, 0, 1024, 0) != 0) return -1;
 
   if (cfgAddBool(pCfg, "disableStream", tsDisableStream, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "streamDispatchWindow", tsStreamDispatchWindow, 1, 64, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "streamDispatchBatchSize", tsStreamDispatchBatchSize, 1, 65536, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "streamQueueLimit", tsStreamQueueLimit, 16, 65536, 0) != 0) return -1;
+  if (cfgAddBool(pCfg, "tdbWalMode", tsTdbWalMode, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "exchangeFetchWindow", tsExchangeFetchWindow, 1, 64, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "exchangeBufferSize", tsExchangeBufferSize, 1, 1024, 0) != 0) return -1;
+  if (cfgAddInt32(pCfg, "retentionSpeedLimitMB", tsRetentionSpeedLimitMB, 0, 1024, 0) != 0) return -1;
 
   GRANT_CFG_ADD;
   return 0;
@@ -717,6 +747,7 @@ static int32_t taosSetClientCfg(SConfig *pCfg) {
   tsQueryPlannerTrace = cfgGetItem(pCfg, "queryPlannerTrace")->bval;
   tsQueryNodeChunkSize = cfgGetItem(pCfg, "queryNodeChunkSize")->i32;
   tsQueryUseNodeAllocator = cfgGetItem(pCfg, "queryUseNodeAllocator")->bval;
+  tsQueryPlanCacheSize = cfgGetItem(pCfg, "queryPlanCacheSize")->i32;
   tsKeepColumnName = cfgGetItem(pCfg, "keepColumnName")->bval;
   tsUseAdapter = cfgGetItem(pCfg, "useAdapter")->bval;
   tsEnableCrashReport = cfgGetItem(pCfg, "crashReporting")->bval;
@@ -766,6 +797,7 @@ static int32_t taosSetServerCfg(SConfig *pCfg) {
   tsTimeToGetAvailableConn = cfgGetItem(pCfg, "timeToGetAvailableConn")->i32;
 
   tsNumOfCommitThreads = cfgGetItem(pCfg, "numOfCommitThreads")->i32;
+  tsNumOfApplyThreads = cfgGetItem(pCfg, "numOfApplyThreads")->i32;
   tsNumOfMnodeReadThreads = cfgGetItem(pCfg, "numOfMnodeReadThreads")->i32;
   tsNumOfVnodeQueryThreads = cfgGetItem(pCfg, "numOfVnodeQueryThreads")->i32;
   tsRatioOfVnodeStreamThreads = cfgGetItem(pCfg, "ratioOfVnodeStreamThreads")->fval;
@@ -787,6 +819,9 @@ static int32_t taosSetServerCfg(SConfig *pCfg) {
   tsMonitorMaxLogs = cfgGetItem(pCfg, "monitorMaxLogs")->i32;
   tsMonitorComp = cfgGetItem(pCfg, "monitorComp")->bval;
   tsQueryRspPolicy = cfgGetItem(pCfg, "queryRspPolicy")->i32;
+  tsQueryTimeSlice = cfgGetItem(pCfg, "queryTimeSlice")->i32;
+  tsQueryAdmitMemory = cfgGetItem(pCfg, "queryAdmitMemory")->i32;
+  tsQueryMemoryLimit = cfgGetItem(pCfg, "queryMemoryLimit")->i32;
 
   tsEnableTelem = cfgGetItem(pCfg, "telemetryReporting")->bval;
   tsEnableCrashReport = cfgGetItem(pCfg, "crashReporting")->bval;
@@ -810,16 +845,25 @@ static int32_t taosSetServerCfg(SConfig *pCfg) {
   tsVndCommitMaxIntervalMs = cfgGetItem(pCfg, "vndCommitMaxInterval")->i64;
 
   tsMndSdbWriteDelta = cfgGetItem(pCfg, "mndSdbWriteDelta")->i64;
+  tsMndSdbDeltaSegments = cfgGetItem(pCfg, "mndSdbDeltaSegments")->i32;
   tsMndLogRetention = cfgGetItem(pCfg, "mndLogRetention")->i64;
 
   tsStartUdfd = cfgGetItem(pCfg, "udf")->bval;
   tstrncpy(tsUdfdResFuncs, cfgGetItem(pCfg, "udfdResFuncs")->str, sizeof(tsUdfdResFuncs));
   tstrncpy(tsUdfdLdLibPath, cfgGetItem(pCfg, "udfdLdLibPath")->str, sizeof(tsUdfdLdLibPath));
+  tsUdfShmSize = cfgGetItem(pCfg, "udfShmSize")->i32;
   if (tsQueryBufferSize >= 0) {
     tsQueryBufferSizeBytes = tsQueryBufferSize * 1048576UL;
   }
 
   tsDisableStream = cfgGetItem(pCfg, "disableStream")->bval;
+  tsStreamDispatchWindow = cfgGetItem(pCfg, "streamDispatchWindow")->i32;
+  tsStreamDispatchBatchSize = cfgGetItem(pCfg, "streamDispatchBatchSize")->i32;
+  tsStreamQueueLimit = cfgGetItem(pCfg, "streamQueueLimit")->i32;
+  tsTdbWalMode = cfgGetItem(pCfg, "tdbWalMode")->bval;
+  tsExchangeFetchWindow = cfgGetItem(pCfg, "exchangeFetchWindow")->i32;
+  tsExchangeBufferSize = cfgGetItem(pCfg, "exchangeBufferSize")->i32;
+  tsRetentionSpeedLimitMB = cfgGetItem(pCfg, "retentionSpeedLimitMB")->i32;
 
   GRANT_CFG_GET;
   return 0;
@@ -1080,6 +1124,8 @@ int32_t taosSetCfg(SConfig *pCfg, char *name) {
         tsQueryNodeChunkSize = cfgGetItem(pCfg, "queryNodeChunkSize")->i32;
       } else if (strcasecmp("queryUseNodeAllocator", name) == 0) {
         tsQueryUseNodeAllocator = cfgGetItem(pCfg, "queryUseNodeAllocator")->bval;
+      } else if (strcasecmp("queryPlanCacheSize", name) == 0) {
+        tsQueryPlanCacheSize = cfgGetItem(pCfg, "queryPlanCacheSize")->i32;
       } else if (strcasecmp("queryRsmaTolerance", name) == 0) {
         tsQueryRsmaTolerance = cfgGetItem(pCfg, "queryRsmaTolerance")->i32;
       }
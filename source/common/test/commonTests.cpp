@@ -11,6 +11,7 @@
 #include "taos.h"
 #include "tcommon.h"
 #include "tdatablock.h"
+#include "tdataformat.h"
 #include "tdef.h"
 #include "tvariant.h"
 
@@ -260,4 +261,90 @@ TEST(testCase, var_dataBlock_split_test) {
   }
 }
 
+TEST(testCase, colData_bind_test) {
+  const int32_t numOfRows = 100;
+  int32_t       ival[numOfRows];
+  char          isNull[numOfRows];
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    ival[i] = i;
+    isNull[i] = (i % 3 == 0);
+  }
+
+  TAOS_MULTI_BIND bind = {0};
+  bind.buffer_type = TSDB_DATA_TYPE_INT;
+  bind.buffer = ival;
+  bind.buffer_length = sizeof(int32_t);
+  bind.is_null = isNull;
+  bind.num = numOfRows;
+
+  // values and nulls, then values only
+  SColData colData = {0};
+  tColDataInit(&colData, 2, TSDB_DATA_TYPE_INT, 0);
+  ASSERT_EQ(tColDataAddValueByBind(&colData, &bind), 0);
+  bind.is_null = NULL;
+  ASSERT_EQ(tColDataAddValueByBind(&colData, &bind), 0);
+
+  ASSERT_EQ(colData.flag, HAS_VALUE | HAS_NULL);
+  ASSERT_EQ(colData.nVal, numOfRows * 2);
+  ASSERT_EQ(colData.numOfNull, (numOfRows + 2) / 3);
+  for (int32_t i = 0; i < colData.nVal; ++i) {
+    SColVal cv;
+    tColDataGetValue(&colData, i, &cv);
+    if (i < numOfRows && isNull[i]) {
+      ASSERT_TRUE(COL_VAL_IS_NULL(&cv));
+    } else {
+      ASSERT_TRUE(COL_VAL_IS_VALUE(&cv));
+      ASSERT_EQ(*(int32_t *)&cv.value.val, i % numOfRows);
+    }
+  }
+  tColDataDestroy(&colData);
+
+  // the column refers to the bind buffer until more values are appended
+  tColDataInit(&colData, 2, TSDB_DATA_TYPE_INT, 0);
+  ASSERT_EQ(tColDataBorrowByBind(&colData, &bind), 0);
+  ASSERT_EQ(colData.pData, (uint8_t *)ival);
+  ASSERT_EQ(colData.borrowed, 1);
+  ASSERT_EQ(colData.nVal, numOfRows);
+
+  ASSERT_EQ(tColDataBorrowByBind(&colData, &bind), 0);
+  ASSERT_NE(colData.pData, (uint8_t *)ival);
+  ASSERT_EQ(colData.borrowed, 0);
+  ASSERT_EQ(colData.nVal, numOfRows * 2);
+  for (int32_t i = 0; i < colData.nVal; ++i) {
+    ASSERT_EQ(((int32_t *)colData.pData)[i], i % numOfRows);
+  }
+  tColDataDestroy(&colData);
+
+  // rows are sorted in an own copy, the bind buffers stay unchanged
+  int64_t ts[numOfRows];
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    ts[i] = 1000 + numOfRows - i;
+  }
+  TAOS_MULTI_BIND tsBind = {0};
+  tsBind.buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+  tsBind.buffer = ts;
+  tsBind.buffer_length = sizeof(int64_t);
+  tsBind.num = numOfRows;
+
+  SArray *aColData = taosArrayInit(2, sizeof(SColData));
+  SColData *pTsCol = (SColData *)taosArrayReserve(aColData, 1);
+  SColData *pValCol = (SColData *)taosArrayReserve(aColData, 1);
+  tColDataInit(pTsCol, PRIMARYKEY_TIMESTAMP_COL_ID, TSDB_DATA_TYPE_TIMESTAMP, 0);
+  tColDataInit(pValCol, 2, TSDB_DATA_TYPE_INT, 0);
+  ASSERT_EQ(tColDataBorrowByBind(pTsCol, &tsBind), 0);
+  ASSERT_EQ(tColDataBorrowByBind(pValCol, &bind), 0);
+
+  tColDataSortMerge(aColData);
+  ASSERT_EQ(pTsCol->borrowed, 0);
+  ASSERT_EQ(pValCol->borrowed, 0);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    ASSERT_EQ(ts[i], 1000 + numOfRows - i);
+    ASSERT_EQ(ival[i], i);
+    ASSERT_EQ(((int64_t *)pTsCol->pData)[i], 1001 + i);
+    ASSERT_EQ(((int32_t *)pValCol->pData)[i], numOfRows - 1 - i);
+  }
+
+  taosArrayDestroyEx(aColData, tColDataDestroy);
+}
+
 #pragma GCC diagnostic pop
\ No newline at end of file
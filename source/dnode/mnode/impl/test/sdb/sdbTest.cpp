@@ -12,6 +12,7 @@
 #include <gtest/gtest.h>
 
 #include "sdb.h"
+#include "tglobal.h"
 
 class MndTestSdb : public ::testing::Test {
  protected:
@@ -1009,3 +1010,249 @@ TEST_F(MndTestSdb, 01_Read_Str) {
   ASSERT_EQ(mnode.insertTimes, 9);
   ASSERT_EQ(mnode.deleteTimes, 9);
 }
+
+static SSdb *deltaOpenSdb(SMnode *pMnode, const char *path) {
+  SSdbOpt opt = {0};
+  opt.pMnode = pMnode;
+  opt.path = path;
+
+  SSdbTable table;
+  memset(&table, 0, sizeof(SSdbTable));
+  table.sdbType = SDB_USER;
+  table.keyType = SDB_KEY_BINARY;
+  table.deployFp = (SdbDeployFp)strDefault;
+  table.encodeFp = (SdbEncodeFp)strEncode;
+  table.decodeFp = (SdbDecodeFp)strDecode;
+  table.insertFp = (SdbInsertFp)strInsert;
+  table.updateFp = (SdbUpdateFp)strUpdate;
+  table.deleteFp = (SdbDeleteFp)strDelete;
+
+  SSdb *pSdb = sdbInit(&opt);
+  if (pSdb == NULL) return NULL;
+  pMnode->pSdb = pSdb;
+  if (sdbSetTable(pSdb, table) != 0) {
+    sdbCleanup(pSdb);
+    return NULL;
+  }
+  return pSdb;
+}
+
+static int32_t deltaWriteStr(SSdb *pSdb, int32_t index, int8_t v8, ESdbStatus status) {
+  SStrObj strObj;
+  strSetDefault(&strObj, index);
+  strObj.v8 = v8;
+  SSdbRaw *pRaw = strEncode(&strObj);
+  sdbSetRawStatus(pRaw, status);
+  return sdbWrite(pSdb, pRaw);
+}
+
+// -1 if the row is missing
+static int32_t deltaGetV8(SSdb *pSdb, int32_t index) {
+  char key[24] = {0};
+  snprintf(key, sizeof(key), "k%d", index * 1000);
+  SStrObj *pObj = (SStrObj *)sdbAcquire(pSdb, SDB_USER, key);
+  if (pObj == NULL) return -1;
+  int32_t v8 = pObj->v8;
+  sdbRelease(pSdb, pObj);
+  return v8;
+}
+
+static bool deltaFileExist(const char *path, const char *name) {
+  char file[PATH_MAX] = {0};
+  snprintf(file, sizeof(file), "%s%sdata%s%s", path, TD_DIRSEP, TD_DIRSEP, name);
+  return taosCheckExistFile(file);
+}
+
+// the files a crash would leave behind are copied to the data dir of another path
+static void deltaCopyFile(const char *fromPath, const char *toPath, const char *name) {
+  char from[PATH_MAX] = {0};
+  char to[PATH_MAX] = {0};
+  snprintf(from, sizeof(from), "%s%sdata%s%s", fromPath, TD_DIRSEP, TD_DIRSEP, name);
+  snprintf(to, sizeof(to), "%s%sdata", toPath, TD_DIRSEP);
+  taosMulMkDir(to);
+  snprintf(to, sizeof(to), "%s%sdata%s%s", toPath, TD_DIRSEP, TD_DIRSEP, name);
+  ASSERT_GT(taosCopyFile(from, to), 0) << from;
+}
+
+TEST_F(MndTestSdb, 02_Delta_Replay) {
+  const char *path = TD_TMP_DIR_PATH "mnode_test_sdb_delta";
+  const char *crashPath = TD_TMP_DIR_PATH "mnode_test_sdb_delta_crash";
+  int32_t     segments = tsMndSdbDeltaSegments;
+  tsMndSdbDeltaSegments = 16;
+  taosRemoveDir(path);
+  taosRemoveDir(crashPath);
+
+  SMnode mnode = {0};
+  SSdb  *pSdb = deltaOpenSdb(&mnode, path);
+  ASSERT_NE(pSdb, nullptr);
+  ASSERT_EQ(sdbDeploy(pSdb), 0);
+  sdbSetApplyInfo(pSdb, 1, 1, 0);
+  ASSERT_EQ(sdbWriteFile(pSdb, 0), 0);
+
+  // a new row goes to the first segment, an update and a drop to the second
+  ASSERT_EQ(deltaWriteStr(pSdb, 3, 3, SDB_STATUS_READY), 0);
+  sdbSetApplyInfo(pSdb, 2, 1, 0);
+  ASSERT_EQ(sdbWriteFile(pSdb, 1), 0);
+  ASSERT_TRUE(deltaFileExist(path, "sdb.delta.1"));
+
+  ASSERT_EQ(deltaWriteStr(pSdb, 2, 9, SDB_STATUS_READY), 0);
+  ASSERT_EQ(deltaWriteStr(pSdb, 1, 1, SDB_STATUS_DROPPED), 0);
+  sdbSetApplyInfo(pSdb, 3, 1, 0);
+  ASSERT_EQ(sdbWriteFile(pSdb, 1), 0);
+  ASSERT_TRUE(deltaFileExist(path, "sdb.delta.2"));
+
+  deltaCopyFile(path, crashPath, "sdb.data");
+  deltaCopyFile(path, crashPath, "sdb.delta.1");
+  deltaCopyFile(path, crashPath, "sdb.delta.2");
+  sdbCleanup(pSdb);
+
+  // the closed sdb folds the segments into sdb.data
+  ASSERT_FALSE(deltaFileExist(path, "sdb.delta.1"));
+  ASSERT_FALSE(deltaFileExist(path, "sdb.delta.2"));
+
+  const char *paths[] = {crashPath, path};
+  for (int32_t i = 0; i < 2; ++i) {
+    SMnode replay = {0};
+    pSdb = deltaOpenSdb(&replay, paths[i]);
+    ASSERT_NE(pSdb, nullptr);
+    ASSERT_EQ(sdbReadFile(pSdb), 0);
+
+    int64_t index = 0, term = 0, config = 0;
+    sdbGetCommitInfo(pSdb, &index, &term, &config);
+    EXPECT_EQ(index, 3) << paths[i];
+    EXPECT_EQ(sdbGetSize(pSdb, SDB_USER), 2) << paths[i];
+    EXPECT_EQ(deltaGetV8(pSdb, 1), -1) << paths[i];
+    EXPECT_EQ(deltaGetV8(pSdb, 2), 9) << paths[i];
+    EXPECT_EQ(deltaGetV8(pSdb, 3), 3) << paths[i];
+    sdbCleanup(pSdb);
+  }
+
+  tsMndSdbDeltaSegments = segments;
+}
+
+TEST_F(MndTestSdb, 03_Delta_Crash_Before_Remove) {
+  const char *path = TD_TMP_DIR_PATH "mnode_test_sdb_delta";
+  const char *stalePath = TD_TMP_DIR_PATH "mnode_test_sdb_delta_stale";
+  const char *crashPath = TD_TMP_DIR_PATH "mnode_test_sdb_delta_crash";
+  int32_t     segments = tsMndSdbDeltaSegments;
+  tsMndSdbDeltaSegments = 16;
+  taosRemoveDir(path);
+  taosRemoveDir(stalePath);
+  taosRemoveDir(crashPath);
+
+  SMnode mnode = {0};
+  SSdb  *pSdb = deltaOpenSdb(&mnode, path);
+  ASSERT_NE(pSdb, nullptr);
+  ASSERT_EQ(sdbDeploy(pSdb), 0);
+  sdbSetApplyInfo(pSdb, 1, 1, 0);
+  ASSERT_EQ(sdbWriteFile(pSdb, 0), 0);
+
+  ASSERT_EQ(deltaWriteStr(pSdb, 1, 1, SDB_STATUS_DROPPED), 0);
+  sdbSetApplyInfo(pSdb, 2, 1, 0);
+  ASSERT_EQ(sdbWriteFile(pSdb, 1), 0);
+  deltaCopyFile(path, stalePath, "sdb.delta.1");
+
+  // the full write covers the segment, which must not be replayed if a crash leaves it behind
+  ASSERT_EQ(deltaWriteStr(pSdb, 1, 7, SDB_STATUS_READY), 0);
+  sdbSetApplyInfo(pSdb, 3, 1, 0);
+  ASSERT_EQ(sdbWriteFile(pSdb, 0), 0);
+  ASSERT_FALSE(deltaFileExist(path, "sdb.delta.1"));
+
+  deltaCopyFile(path, crashPath, "sdb.data");
+  deltaCopyFile(stalePath, crashPath, "sdb.delta.1");
+  sdbCleanup(pSdb);
+
+  SMnode replay = {0};
+  pSdb = deltaOpenSdb(&replay, crashPath);
+  ASSERT_NE(pSdb, nullptr);
+  ASSERT_EQ(sdbReadFile(pSdb), 0);
+  EXPECT_EQ(deltaGetV8(pSdb, 1), 7);
+  EXPECT_EQ(sdbGetSize(pSdb, SDB_USER), 2);
+  EXPECT_FALSE(deltaFileExist(crashPath, "sdb.delta.1"));
+
+  // a new segment continues after the covered one
+  ASSERT_EQ(deltaWriteStr(pSdb, 2, 5, SDB_STATUS_READY), 0);
+  sdbSetApplyInfo(pSdb, 4, 1, 0);
+  ASSERT_EQ(sdbWriteFile(pSdb, 1), 0);
+  EXPECT_TRUE(deltaFileExist(crashPath, "sdb.delta.2"));
+  sdbCleanup(pSdb);
+
+  tsMndSdbDeltaSegments = segments;
+}
+
+TEST_F(MndTestSdb, 04_Delta_Snapshot_Apply) {
+  const char *leaderPath = TD_TMP_DIR_PATH "mnode_test_sdb_leader";
+  const char *followerPath = TD_TMP_DIR_PATH "mnode_test_sdb_follower";
+  const char *stalePath = TD_TMP_DIR_PATH "mnode_test_sdb_delta_stale";
+  const char *crashPath = TD_TMP_DIR_PATH "mnode_test_sdb_delta_crash";
+  int32_t     segments = tsMndSdbDeltaSegments;
+  tsMndSdbDeltaSegments = 16;
+  taosRemoveDir(leaderPath);
+  taosRemoveDir(followerPath);
+  taosRemoveDir(stalePath);
+  taosRemoveDir(crashPath);
+
+  SMnode leader = {0};
+  SSdb  *pLeader = deltaOpenSdb(&leader, leaderPath);
+  ASSERT_NE(pLeader, nullptr);
+  ASSERT_EQ(sdbDeploy(pLeader), 0);
+  ASSERT_EQ(deltaWriteStr(pLeader, 4, 4, SDB_STATUS_READY), 0);
+  sdbSetApplyInfo(pLeader, 10, 2, 0);
+  ASSERT_EQ(sdbWriteFile(pLeader, 0), 0);
+
+  // the follower has segments of its own on top of a different sdb.data
+  SMnode follower = {0};
+  SSdb  *pFollower = deltaOpenSdb(&follower, followerPath);
+  ASSERT_NE(pFollower, nullptr);
+  ASSERT_EQ(sdbDeploy(pFollower), 0);
+  sdbSetApplyInfo(pFollower, 1, 1, 0);
+  ASSERT_EQ(sdbWriteFile(pFollower, 0), 0);
+  ASSERT_EQ(deltaWriteStr(pFollower, 1, 1, SDB_STATUS_DROPPED), 0);
+  sdbSetApplyInfo(pFollower, 2, 1, 0);
+  ASSERT_EQ(sdbWriteFile(pFollower, 1), 0);
+  ASSERT_EQ(deltaWriteStr(pFollower, 2, 8, SDB_STATUS_READY), 0);
+  sdbSetApplyInfo(pFollower, 3, 1, 0);
+  ASSERT_EQ(sdbWriteFile(pFollower, 1), 0);
+  deltaCopyFile(followerPath, stalePath, "sdb.delta.1");
+  deltaCopyFile(followerPath, stalePath, "sdb.delta.2");
+
+  SSdbIter *pReader = NULL;
+  SSdbIter *pWriter = NULL;
+  ASSERT_EQ(sdbStartRead(pLeader, &pReader, NULL, NULL, NULL), 0);
+  ASSERT_EQ(sdbStartWrite(pFollower, &pWriter), 0);
+  void   *pBuf = NULL;
+  int32_t len = 0;
+  while (sdbDoRead(pLeader, pReader, &pBuf, &len) == 0 && pBuf != NULL && len != 0) {
+    ASSERT_EQ(sdbDoWrite(pFollower, pWriter, pBuf, len), 0);
+    taosMemoryFree(pBuf);
+  }
+  sdbStopRead(pLeader, pReader);
+  ASSERT_EQ(sdbStopWrite(pFollower, pWriter, true, 10, 2, 0), 0);
+
+  EXPECT_FALSE(deltaFileExist(followerPath, "sdb.delta.1"));
+  EXPECT_FALSE(deltaFileExist(followerPath, "sdb.delta.2"));
+  EXPECT_EQ(sdbGetSize(pFollower, SDB_USER), 3);
+  EXPECT_EQ(deltaGetV8(pFollower, 1), 1);
+  EXPECT_EQ(deltaGetV8(pFollower, 2), 2);
+  EXPECT_EQ(deltaGetV8(pFollower, 4), 4);
+
+  // a crash between the rename and the removal leaves the old segments next to the received sdb.data
+  deltaCopyFile(followerPath, crashPath, "sdb.data");
+  deltaCopyFile(stalePath, crashPath, "sdb.delta.1");
+  deltaCopyFile(stalePath, crashPath, "sdb.delta.2");
+  sdbCleanup(pFollower);
+  sdbCleanup(pLeader);
+
+  SMnode replay = {0};
+  SSdb  *pSdb = deltaOpenSdb(&replay, crashPath);
+  ASSERT_NE(pSdb, nullptr);
+  ASSERT_EQ(sdbReadFile(pSdb), 0);
+  EXPECT_EQ(sdbGetSize(pSdb, SDB_USER), 3);
+  EXPECT_EQ(deltaGetV8(pSdb, 1), 1);
+  EXPECT_EQ(deltaGetV8(pSdb, 2), 2);
+  EXPECT_FALSE(deltaFileExist(crashPath, "sdb.delta.1"));
+  EXPECT_FALSE(deltaFileExist(crashPath, "sdb.delta.2"));
+  sdbCleanup(pSdb);
+
+  tsMndSdbDeltaSegments = segments;
+}
@@ -188,6 +188,13 @@ typedef struct SSdb {
   SdbDeployFp    deployFps[SDB_MAX];
   SdbEncodeFp    encodeFps[SDB_MAX];
   SdbDecodeFp    decodeFps[SDB_MAX];
+  SHashObj      *dirtyObjs[SDB_MAX];  // rows changed since the last checkpoint, value:tombstone raw or NULL
+  int64_t        baseSeq;             // last delta segment merged into sdb.data
+  int64_t        deltaSeq;            // last delta segment written
+  bool           dirtyLost;           // a change was not tracked, next checkpoint must be a full write
+  TdThread       compactThread;
+  bool           compactStarted;
+  int8_t         compactDone;
   TdThreadMutex  filelock;
 } SSdb;
 
@@ -256,9 +263,11 @@ int32_t sdbDeploy(SSdb *pSdb);
 int32_t sdbReadFile(SSdb *pSdb);
 
 /**
- * @brief Write sdb file.
+ * @brief Write sdb file. With delta > 0 only the rows changed since the last checkpoint are written as a delta
+ * segment, which is merged into sdb.data in the background. With delta 0 the whole sdb.data is rewritten.
  *
  * @param pSdb The sdb object.
+ * @param delta Minimum number of applied logs since the last checkpoint.
  * @return int32_t 0 for success, -1 for failure.
  */
 int32_t sdbWriteFile(SSdb *pSdb, int32_t delta);
@@ -404,6 +413,10 @@ const char *sdbStatusName(ESdbStatus status);
 void        sdbPrintOper(SSdb *pSdb, SSdbRow *pRow, const char *oper);
 int32_t     sdbGetIdFromRaw(SSdb *pSdb, SSdbRaw *pRaw);
 
+SHashObj *sdbNewDirtyHash(SSdb *pSdb, int32_t type);
+void      sdbSetRowDirty(SSdb *pSdb, int32_t type, const void *pKey, int32_t keySize, SSdbRaw *pTombstone);
+void      sdbClearDirty(SSdb *pSdb);
+
 void sdbWriteLock(SSdb *pSdb, int32_t type);
 void sdbReadLock(SSdb *pSdb, int32_t type);
 void sdbUnLock(SSdb *pSdb, int32_t type);
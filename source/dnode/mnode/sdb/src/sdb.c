@@ -99,8 +99,10 @@ void sdbCleanup(SSdb *pSdb) {
 
     taosHashClear(hash);
     taosHashCleanup(hash);
+    taosHashCleanup(pSdb->dirtyObjs[i]);
     taosThreadRwlockDestroy(&pSdb->locks[i]);
     pSdb->hashObjs[i] = NULL;
+    pSdb->dirtyObjs[i] = NULL;
     memset(&pSdb->locks[i], 0, sizeof(pSdb->locks[i]));
 
     mInfo("sdb table:%s is cleaned up", sdbTableName(i));
@@ -137,8 +139,15 @@ int32_t sdbSetTable(SSdb *pSdb, SSdbTable table) {
     return -1;
   }
 
+  SHashObj *pDirty = sdbNewDirtyHash(pSdb, sdbType);
+  if (pDirty == NULL) {
+    taosHashCleanup(hash);
+    return -1;
+  }
+
   pSdb->maxId[sdbType] = 0;
   pSdb->hashObjs[sdbType] = hash;
+  pSdb->dirtyObjs[sdbType] = pDirty;
   mInfo("sdb table:%s is initialized", sdbTableName(sdbType));
 
   return 0;
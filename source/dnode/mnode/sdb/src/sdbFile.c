@@ -17,11 +17,24 @@
 #include "sdb.h"
 #include "sync.h"
 #include "tchecksum.h"
+#include "tglobal.h"
 #include "wal.h"
 
 #define SDB_TABLE_SIZE   24
 #define SDB_RESERVE_SIZE 512
 #define SDB_FILE_VER     1
+#define SDB_DELTA_PREFIX "sdb.delta."
+
+typedef struct {
+  int64_t applyIndex;
+  int64_t applyTerm;
+  int64_t applyConfig;
+  int64_t maxId[SDB_MAX];
+  int64_t tableVer[SDB_MAX];
+  int64_t deltaSeq;
+} SSdbFileHead;
+
+typedef int32_t (*FSdbRawFp)(SSdb *pSdb, SSdbRaw *pRaw, void *param);
 
 static int32_t sdbDeployData(SSdb *pSdb) {
   mInfo("start to deploy sdb");
@@ -74,10 +87,13 @@ static void sdbResetData(SSdb *pSdb) {
   pSdb->commitIndex = -1;
   pSdb->commitTerm = -1;
   pSdb->commitConfig = -1;
+  pSdb->baseSeq = 0;
+  pSdb->deltaSeq = 0;
+  sdbClearDirty(pSdb);
   mInfo("sdb reset success");
 }
 
-static int32_t sdbReadFileHead(SSdb *pSdb, TdFilePtr pFile) {
+static int32_t sdbReadFileHead(SSdbFileHead *pHead, TdFilePtr pFile) {
   int64_t sver = 0;
   int32_t ret = taosReadFile(pFile, &sver, sizeof(int64_t));
   if (ret < 0) {
@@ -93,7 +109,7 @@ static int32_t sdbReadFileHead(SSdb *pSdb, TdFilePtr pFile) {
     return -1;
   }
 
-  ret = taosReadFile(pFile, &pSdb->applyIndex, sizeof(int64_t));
+  ret = taosReadFile(pFile, &pHead->applyIndex, sizeof(int64_t));
   if (ret < 0) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
@@ -103,7 +119,7 @@ static int32_t sdbReadFileHead(SSdb *pSdb, TdFilePtr pFile) {
     return -1;
   }
 
-  ret = taosReadFile(pFile, &pSdb->applyTerm, sizeof(int64_t));
+  ret = taosReadFile(pFile, &pHead->applyTerm, sizeof(int64_t));
   if (ret < 0) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
@@ -113,7 +129,7 @@ static int32_t sdbReadFileHead(SSdb *pSdb, TdFilePtr pFile) {
     return -1;
   }
 
-  ret = taosReadFile(pFile, &pSdb->applyConfig, sizeof(int64_t));
+  ret = taosReadFile(pFile, &pHead->applyConfig, sizeof(int64_t));
   if (ret < 0) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
@@ -135,7 +151,7 @@ static int32_t sdbReadFileHead(SSdb *pSdb, TdFilePtr pFile) {
       return -1;
     }
     if (i < SDB_MAX) {
-      pSdb->maxId[i] = maxId;
+      pHead->maxId[i] = maxId;
     }
   }
 
@@ -151,7 +167,7 @@ static int32_t sdbReadFileHead(SSdb *pSdb, TdFilePtr pFile) {
       return -1;
     }
     if (i < SDB_MAX) {
-      pSdb->tableVer[i] = ver;
+      pHead->tableVer[i] = ver;
     }
   }
 
@@ -166,27 +182,30 @@ static int32_t sdbReadFileHead(SSdb *pSdb, TdFilePtr pFile) {
     return -1;
   }
 
+  // files written before delta segments existed carry zeros here
+  memcpy(&pHead->deltaSeq, reserve, sizeof(int64_t));
+
   return 0;
 }
 
-static int32_t sdbWriteFileHead(SSdb *pSdb, TdFilePtr pFile) {
+static int32_t sdbWriteFileHead(const SSdbFileHead *pHead, TdFilePtr pFile) {
   int64_t sver = SDB_FILE_VER;
   if (taosWriteFile(pFile, &sver, sizeof(int64_t)) != sizeof(int64_t)) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
   }
 
-  if (taosWriteFile(pFile, &pSdb->applyIndex, sizeof(int64_t)) != sizeof(int64_t)) {
+  if (taosWriteFile(pFile, &pHead->applyIndex, sizeof(int64_t)) != sizeof(int64_t)) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
   }
 
-  if (taosWriteFile(pFile, &pSdb->applyTerm, sizeof(int64_t)) != sizeof(int64_t)) {
+  if (taosWriteFile(pFile, &pHead->applyTerm, sizeof(int64_t)) != sizeof(int64_t)) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
   }
 
-  if (taosWriteFile(pFile, &pSdb->applyConfig, sizeof(int64_t)) != sizeof(int64_t)) {
+  if (taosWriteFile(pFile, &pHead->applyConfig, sizeof(int64_t)) != sizeof(int64_t)) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
   }
@@ -194,7 +213,7 @@ static int32_t sdbWriteFileHead(SSdb *pSdb, TdFilePtr pFile) {
   for (int32_t i = 0; i < SDB_TABLE_SIZE; ++i) {
     int64_t maxId = 0;
     if (i < SDB_MAX) {
-      maxId = pSdb->maxId[i];
+      maxId = pHead->maxId[i];
     }
     if (taosWriteFile(pFile, &maxId, sizeof(int64_t)) != sizeof(int64_t)) {
       terrno = TAOS_SYSTEM_ERROR(errno);
@@ -205,7 +224,7 @@ static int32_t sdbWriteFileHead(SSdb *pSdb, TdFilePtr pFile) {
   for (int32_t i = 0; i < SDB_TABLE_SIZE; ++i) {
     int64_t ver = 0;
     if (i < SDB_MAX) {
-      ver = pSdb->tableVer[i];
+      ver = pHead->tableVer[i];
     }
     if (taosWriteFile(pFile, &ver, sizeof(int64_t)) != sizeof(int64_t)) {
       terrno = TAOS_SYSTEM_ERROR(errno);
@@ -214,6 +233,7 @@ static int32_t sdbWriteFileHead(SSdb *pSdb, TdFilePtr pFile) {
   }
 
   char reserve[SDB_RESERVE_SIZE] = {0};
+  memcpy(reserve, &pHead->deltaSeq, sizeof(int64_t));
   if (taosWriteFile(pFile, reserve, sizeof(reserve)) != sizeof(reserve)) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
@@ -222,15 +242,79 @@ static int32_t sdbWriteFileHead(SSdb *pSdb, TdFilePtr pFile) {
   return 0;
 }
 
-static int32_t sdbReadFileImp(SSdb *pSdb) {
-  int64_t offset = 0;
+static void sdbBuildFileHead(SSdb *pSdb, int64_t deltaSeq, SSdbFileHead *pHead) {
+  pHead->applyIndex = pSdb->applyIndex;
+  pHead->applyTerm = pSdb->applyTerm;
+  pHead->applyConfig = pSdb->applyConfig;
+  memcpy(pHead->maxId, pSdb->maxId, sizeof(pHead->maxId));
+  memcpy(pHead->tableVer, pSdb->tableVer, sizeof(pHead->tableVer));
+  pHead->deltaSeq = deltaSeq;
+}
+
+static void sdbDeltaFileName(char *file, int32_t size, const char *dir, int64_t seq) {
+  snprintf(file, size, "%s%s%s%" PRId64, dir, TD_DIRSEP, SDB_DELTA_PREFIX, seq);
+}
+
+static int32_t sdbCompareSeq(const void *lp, const void *rp) {
+  int64_t l = *(int64_t *)lp;
+  int64_t r = *(int64_t *)rp;
+  return l < r ? -1 : (l > r ? 1 : 0);
+}
+
+static SArray *sdbListDeltaSeqs(SSdb *pSdb) {
+  SArray *pSeqs = taosArrayInit(8, sizeof(int64_t));
+  if (pSeqs == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  TdDirPtr pDir = taosOpenDir(pSdb->currDir);
+  if (pDir == NULL) {
+    return pSeqs;
+  }
+
+  int32_t       prefixLen = strlen(SDB_DELTA_PREFIX);
+  TdDirEntryPtr pEntry = NULL;
+  while ((pEntry = taosReadDir(pDir)) != NULL) {
+    char *name = taosGetDirEntryName(pEntry);
+    if (strncmp(name, SDB_DELTA_PREFIX, prefixLen) != 0) continue;
+
+    int64_t seq = taosStr2Int64(name + prefixLen, NULL, 10);
+    if (seq <= 0) continue;
+
+    taosArrayPush(pSeqs, &seq);
+  }
+
+  taosCloseDir(&pDir);
+  taosArraySort(pSeqs, sdbCompareSeq);
+  return pSeqs;
+}
+
+static void sdbRemoveDeltaFiles(SSdb *pSdb, int64_t maxSeq) {
+  SArray *pSeqs = sdbListDeltaSeqs(pSdb);
+  if (pSeqs == NULL) return;
+
+  for (int32_t i = 0; i < taosArrayGetSize(pSeqs); ++i) {
+    int64_t seq = *(int64_t *)taosArrayGet(pSeqs, i);
+    if (seq > maxSeq) break;
+
+    char file[PATH_MAX] = {0};
+    sdbDeltaFileName(file, sizeof(file), pSdb->currDir, seq);
+    (void)taosRemoveFile(file);
+    mDebug("sdb delta file:%s is removed", file);
+  }
+
+  taosArrayDestroy(pSeqs);
+}
+
+// read a sdb.data or delta file, each checked raw is passed to fp
+static int32_t sdbReadRawFile(SSdb *pSdb, const char *file, SSdbFileHead *pHead, FSdbRawFp fp, void *param,
+                              bool *pExist) {
   int32_t code = 0;
   int32_t readLen = 0;
   int64_t ret = 0;
-  char    file[PATH_MAX] = {0};
   int32_t bufLen = TSDB_MAX_MSG_SIZE;
 
-  snprintf(file, sizeof(file), "%s%ssdb.data", pSdb->currDir, TD_DIRSEP);
   mInfo("start to read sdb file:%s", file);
 
   SSdbRaw *pRaw = taosMemoryMalloc(bufLen + 100);
@@ -245,19 +329,18 @@ static int32_t sdbReadFileImp(SSdb *pSdb) {
     taosMemoryFree(pRaw);
     terrno = TAOS_SYSTEM_ERROR(errno);
     mInfo("read sdb file:%s finished since %s", file, terrstr());
+    *pExist = false;
     return 0;
   }
+  *pExist = true;
 
-  if (sdbReadFileHead(pSdb, pFile) != 0) {
+  if (sdbReadFileHead(pHead, pFile) != 0) {
     mError("failed to read sdb file:%s head since %s", file, terrstr());
     taosMemoryFree(pRaw);
     taosCloseFile(&pFile);
     return -1;
   }
 
-  int64_t tableVer[SDB_MAX] = {0};
-  memcpy(tableVer, pSdb->tableVer, sizeof(tableVer));
-
   while (1) {
     readLen = sizeof(SSdbRaw);
     ret = taosReadFile(pFile, pRaw, readLen);
@@ -310,7 +393,7 @@ static int32_t sdbReadFileImp(SSdb *pSdb) {
       goto _OVER;
     }
 
-    code = sdbWriteWithoutFree(pSdb, pRaw);
+    code = (*fp)(pSdb, pRaw, param);
     if (code != 0) {
       mError("failed to read sdb file:%s since %s", file, terrstr());
       goto _OVER;
@@ -318,12 +401,6 @@ static int32_t sdbReadFileImp(SSdb *pSdb) {
   }
 
   code = 0;
-  pSdb->commitIndex = pSdb->applyIndex;
-  pSdb->commitTerm = pSdb->applyTerm;
-  pSdb->commitConfig = pSdb->applyConfig;
-  memcpy(pSdb->tableVer, tableVer, sizeof(tableVer));
-  mInfo("read sdb file:%s success, commit index:%" PRId64 " term:%" PRId64 " config:%" PRId64, file, pSdb->commitIndex,
-        pSdb->commitTerm, pSdb->commitConfig);
 
 _OVER:
   taosCloseFile(&pFile);
@@ -333,6 +410,90 @@ _OVER:
   return code;
 }
 
+static int32_t sdbApplyRaw(SSdb *pSdb, SSdbRaw *pRaw, void *param) {
+  int32_t code = sdbWriteWithoutFree(pSdb, pRaw);
+  if (code == TSDB_CODE_SDB_OBJ_NOT_THERE && pRaw->status == SDB_STATUS_DROPPED) {
+    // tombstone in a delta segment of a row the earlier files never had
+    code = 0;
+  }
+  return code;
+}
+
+static int32_t sdbReadFileImp(SSdb *pSdb) {
+  int32_t      code = 0;
+  bool         exist = false;
+  bool         found = false;
+  char         file[PATH_MAX] = {0};
+  SSdbFileHead head = {0};
+
+  snprintf(file, sizeof(file), "%s%ssdb.data", pSdb->currDir, TD_DIRSEP);
+  code = sdbReadRawFile(pSdb, file, &head, sdbApplyRaw, NULL, &exist);
+  if (code != 0) {
+    return code;
+  }
+
+  found = exist;
+  pSdb->baseSeq = exist ? head.deltaSeq : 0;
+  pSdb->deltaSeq = pSdb->baseSeq;
+
+  SArray *pSeqs = sdbListDeltaSeqs(pSdb);
+  if (pSeqs == NULL) {
+    return terrno;
+  }
+
+  for (int32_t i = 0; i < taosArrayGetSize(pSeqs); ++i) {
+    int64_t seq = *(int64_t *)taosArrayGet(pSeqs, i);
+    sdbDeltaFileName(file, sizeof(file), pSdb->currDir, seq);
+
+    if (seq <= pSdb->baseSeq) {
+      // already merged into sdb.data, the compaction stopped before removing it
+      (void)taosRemoveFile(file);
+      continue;
+    }
+
+    if (seq != pSdb->deltaSeq + 1) {
+      code = TSDB_CODE_FILE_CORRUPTED;
+      mError("failed to read sdb delta file:%s since %s, expect seq:%" PRId64, file, tstrerror(code),
+             pSdb->deltaSeq + 1);
+      break;
+    }
+
+    code = sdbReadRawFile(pSdb, file, &head, sdbApplyRaw, NULL, &exist);
+    if (code != 0) break;
+
+    found = true;
+    pSdb->deltaSeq = seq;
+  }
+
+  taosArrayDestroy(pSeqs);
+  if (code != 0) {
+    terrno = code;
+    return code;
+  }
+
+  if (!found) {
+    return 0;
+  }
+
+  pSdb->applyIndex = head.applyIndex;
+  pSdb->applyTerm = head.applyTerm;
+  pSdb->applyConfig = head.applyConfig;
+  for (int32_t i = 0; i < SDB_MAX; ++i) {
+    pSdb->maxId[i] = TMAX(pSdb->maxId[i], head.maxId[i]);
+  }
+  memcpy(pSdb->tableVer, head.tableVer, sizeof(head.tableVer));
+
+  pSdb->commitIndex = pSdb->applyIndex;
+  pSdb->commitTerm = pSdb->applyTerm;
+  pSdb->commitConfig = pSdb->applyConfig;
+  sdbClearDirty(pSdb);
+  mInfo("read sdb file success, commit index:%" PRId64 " term:%" PRId64 " config:%" PRId64 ", base seq:%" PRId64
+        " delta seq:%" PRId64,
+        pSdb->commitIndex, pSdb->commitTerm, pSdb->commitConfig, pSdb->baseSeq, pSdb->deltaSeq);
+
+  return 0;
+}
+
 int32_t sdbReadFile(SSdb *pSdb) {
   taosThreadMutexLock(&pSdb->filelock);
 
@@ -347,6 +508,63 @@ int32_t sdbReadFile(SSdb *pSdb) {
   return code;
 }
 
+static int32_t sdbWriteRawToFile(TdFilePtr pFile, SSdbRaw *pRaw) {
+  int32_t writeLen = sizeof(SSdbRaw) + pRaw->dataLen;
+  if (taosWriteFile(pFile, pRaw, writeLen) != writeLen) {
+    return TAOS_SYSTEM_ERROR(errno);
+  }
+
+  int32_t cksum = taosCalcChecksum(0, (const uint8_t *)pRaw, writeLen);
+  if (taosWriteFile(pFile, &cksum, sizeof(int32_t)) != sizeof(int32_t)) {
+    return TAOS_SYSTEM_ERROR(errno);
+  }
+
+  return 0;
+}
+
+static int32_t sdbSyncFile(TdFilePtr *ppFile, const char *tmpfile, const char *curfile) {
+  int32_t code = taosFsyncFile(*ppFile);
+  if (code != 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    mError("failed to sync sdb file:%s since %s", tmpfile, tstrerror(code));
+  }
+
+  taosCloseFile(ppFile);
+
+  if (code == 0 && curfile != NULL) {
+    code = taosRenameFile(tmpfile, curfile);
+    if (code != 0) {
+      code = TAOS_SYSTEM_ERROR(errno);
+      mError("failed to write sdb file:%s since %s", curfile, tstrerror(code));
+    }
+  }
+
+  return code;
+}
+
+// make the renames and removes done in dir durable, a file renamed into place is lost on crash until then
+static int32_t sdbSyncDir(const char *dir) {
+#ifdef WINDOWS
+  return 0;
+#else
+  TdFilePtr pDir = taosOpenFile(dir, TD_FILE_READ);
+  if (pDir == NULL) {
+    int32_t code = TAOS_SYSTEM_ERROR(errno);
+    mError("failed to open sdb dir:%s since %s", dir, tstrerror(code));
+    return code;
+  }
+
+  int32_t code = 0;
+  if (taosFsyncFile(pDir) != 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    mError("failed to sync sdb dir:%s since %s", dir, tstrerror(code));
+  }
+
+  taosCloseFile(&pDir);
+  return code;
+#endif
+}
+
 static int32_t sdbWriteFileImp(SSdb *pSdb) {
   int32_t code = 0;
 
@@ -367,7 +585,10 @@ static int32_t sdbWriteFileImp(SSdb *pSdb) {
     return -1;
   }
 
-  if (sdbWriteFileHead(pSdb, pFile) != 0) {
+  // every delta segment written so far is covered by this image
+  SSdbFileHead head = {0};
+  sdbBuildFileHead(pSdb, pSdb->deltaSeq, &head);
+  if (sdbWriteFileHead(&head, pFile) != 0) {
     mError("failed to write sdb file:%s head since %s", tmpfile, terrstr());
     taosCloseFile(&pFile);
     return -1;
@@ -379,8 +600,9 @@ static int32_t sdbWriteFileImp(SSdb *pSdb) {
 
     mInfo("write %s to sdb file, total %d rows", sdbTableName(i), sdbGetSize(pSdb, i));
 
+    // rows only change under the write lock, the read lock keeps the image consistent without blocking readers
     SHashObj *hash = pSdb->hashObjs[i];
-    sdbWriteLock(pSdb, i);
+    sdbReadLock(pSdb, i);
 
     SSdbRow **ppRow = taosHashIterate(hash, NULL);
     while (ppRow != NULL) {
@@ -401,17 +623,8 @@ static int32_t sdbWriteFileImp(SSdb *pSdb) {
       SSdbRaw *pRaw = (*encodeFp)(pRow->pObj);
       if (pRaw != NULL) {
         pRaw->status = pRow->status;
-        int32_t writeLen = sizeof(SSdbRaw) + pRaw->dataLen;
-        if (taosWriteFile(pFile, pRaw, writeLen) != writeLen) {
-          code = TAOS_SYSTEM_ERROR(errno);
-          taosHashCancelIterate(hash, ppRow);
-          sdbFreeRaw(pRaw);
-          break;
-        }
-
-        int32_t cksum = taosCalcChecksum(0, (const uint8_t *)pRaw, sizeof(SSdbRaw) + pRaw->dataLen);
-        if (taosWriteFile(pFile, &cksum, sizeof(int32_t)) != sizeof(int32_t)) {
-          code = TAOS_SYSTEM_ERROR(errno);
+        code = sdbWriteRawToFile(pFile, pRaw);
+        if (code != 0) {
           taosHashCancelIterate(hash, ppRow);
           sdbFreeRaw(pRaw);
           break;
@@ -425,43 +638,381 @@ static int32_t sdbWriteFileImp(SSdb *pSdb) {
       sdbFreeRaw(pRaw);
       ppRow = taosHashIterate(hash, ppRow);
     }
+
+    if (pSdb->dirtyObjs[i] != NULL) {
+      taosHashClear(pSdb->dirtyObjs[i]);
+    }
     sdbUnLock(pSdb, i);
+
+    if (code != 0) break;
   }
 
   if (code == 0) {
-    code = taosFsyncFile(pFile);
-    if (code != 0) {
-      code = TAOS_SYSTEM_ERROR(errno);
-      mError("failed to sync sdb file:%s since %s", tmpfile, tstrerror(code));
+    code = sdbSyncFile(&pFile, tmpfile, curfile);
+  } else {
+    taosCloseFile(&pFile);
+  }
+
+  // the delta segments may only go once the new sdb.data survives a crash
+  if (code == 0) {
+    code = sdbSyncDir(pSdb->currDir);
+  }
+
+  if (code != 0) {
+    // the changes dropped from the dirty sets above are only in memory now
+    pSdb->dirtyLost = true;
+    mError("failed to write sdb file:%s since %s", curfile, tstrerror(code));
+  } else {
+    pSdb->dirtyLost = false;
+    pSdb->baseSeq = pSdb->deltaSeq;
+    pSdb->commitIndex = pSdb->applyIndex;
+    pSdb->commitTerm = pSdb->applyTerm;
+    pSdb->commitConfig = pSdb->applyConfig;
+    sdbRemoveDeltaFiles(pSdb, pSdb->baseSeq);
+    mInfo("write sdb file success, commit index:%" PRId64 " term:%" PRId64 " config:%" PRId64 " file:%s",
+          pSdb->commitIndex, pSdb->commitTerm, pSdb->commitConfig, curfile);
+  }
+
+  terrno = code;
+  return code;
+}
+
+// put the keys of a delta segment that failed to be written back, newer marks win
+static void sdbRestoreDirty(SSdb *pSdb, int32_t type, SHashObj *pDirty) {
+  sdbWriteLock(pSdb, type);
+
+  void *pIter = taosHashIterate(pDirty, NULL);
+  while (pIter != NULL) {
+    size_t keyLen = 0;
+    void  *pKey = taosHashGetKey(pIter, &keyLen);
+    if (taosHashGet(pSdb->dirtyObjs[type], pKey, keyLen) == NULL) {
+      SSdbRaw *pTombstone = *(SSdbRaw **)pIter;
+      *(SSdbRaw **)pIter = NULL;
+      sdbSetRowDirty(pSdb, type, pKey, keyLen, pTombstone);
     }
+    pIter = taosHashIterate(pDirty, pIter);
   }
 
-  taosCloseFile(&pFile);
+  sdbUnLock(pSdb, type);
+}
+
+static int32_t sdbWriteDeltaImp(SSdb *pSdb) {
+  int32_t   code = 0;
+  int64_t   seq = pSdb->deltaSeq + 1;
+  int64_t   rows = 0;
+  SHashObj *pDirtyObjs[SDB_MAX] = {0};
+
+  char tmpfile[PATH_MAX] = {0};
+  sdbDeltaFileName(tmpfile, sizeof(tmpfile), pSdb->tmpDir, seq);
+  char curfile[PATH_MAX] = {0};
+  sdbDeltaFileName(curfile, sizeof(curfile), pSdb->currDir, seq);
+
+  TdFilePtr pFile = taosOpenFile(tmpfile, TD_FILE_CREATE | TD_FILE_WRITE | TD_FILE_TRUNC);
+  if (pFile == NULL) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    mError("failed to open sdb delta file:%s for write since %s", tmpfile, terrstr());
+    return -1;
+  }
+
+  SSdbFileHead head = {0};
+  sdbBuildFileHead(pSdb, seq, &head);
+  if (sdbWriteFileHead(&head, pFile) != 0) {
+    mError("failed to write sdb delta file:%s head since %s", tmpfile, terrstr());
+    taosCloseFile(&pFile);
+    return -1;
+  }
+
+  for (int32_t i = SDB_MAX - 1; i >= 0 && code == 0; --i) {
+    SdbEncodeFp encodeFp = pSdb->encodeFps[i];
+    if (encodeFp == NULL || pSdb->dirtyObjs[i] == NULL) continue;
+
+    // only swap the dirty set under the write lock, rows are encoded one by one under the read lock
+    SHashObj *pNew = sdbNewDirtyHash(pSdb, i);
+    if (pNew == NULL) {
+      code = terrno;
+      break;
+    }
+
+    sdbWriteLock(pSdb, i);
+    pDirtyObjs[i] = pSdb->dirtyObjs[i];
+    pSdb->dirtyObjs[i] = pNew;
+    sdbUnLock(pSdb, i);
+
+    SHashObj *hash = pSdb->hashObjs[i];
+    void     *pIter = taosHashIterate(pDirtyObjs[i], NULL);
+    while (pIter != NULL) {
+      size_t   keyLen = 0;
+      void    *pKey = taosHashGetKey(pIter, &keyLen);
+      SSdbRaw *pRaw = NULL;
+      bool     owned = true;
+
+      sdbReadLock(pSdb, i);
+      SSdbRow **ppRow = taosHashGet(hash, pKey, keyLen);
+      if (ppRow != NULL && *ppRow != NULL) {
+        SSdbRow *pRow = *ppRow;
+        pRaw = (*encodeFp)(pRow->pObj);
+        if (pRaw != NULL) {
+          // rows not yet created are not in sdb.data either, make sure an older version is dropped
+          bool persist = pRow->status == SDB_STATUS_READY || pRow->status == SDB_STATUS_DROPPING;
+          pRaw->status = persist ? pRow->status : SDB_STATUS_DROPPED;
+        } else {
+          code = TSDB_CODE_APP_ERROR;
+        }
+      } else {
+        pRaw = *(SSdbRaw **)pIter;
+        owned = false;
+      }
+      sdbUnLock(pSdb, i);
+
+      if (code == 0 && pRaw != NULL) {
+        code = sdbWriteRawToFile(pFile, pRaw);
+        rows++;
+      }
+
+      if (owned) {
+        sdbFreeRaw(pRaw);
+      }
+
+      if (code != 0) {
+        taosHashCancelIterate(pDirtyObjs[i], pIter);
+        break;
+      }
+
+      pIter = taosHashIterate(pDirtyObjs[i], pIter);
+    }
+  }
 
   if (code == 0) {
-    code = taosRenameFile(tmpfile, curfile);
+    code = sdbSyncFile(&pFile, tmpfile, curfile);
+  } else {
+    taosCloseFile(&pFile);
+  }
+
+  if (code == 0) {
+    code = sdbSyncDir(pSdb->currDir);
+  }
+
+  for (int32_t i = 0; i < SDB_MAX; ++i) {
+    if (pDirtyObjs[i] == NULL) continue;
     if (code != 0) {
-      code = TAOS_SYSTEM_ERROR(errno);
-      mError("failed to write sdb file:%s since %s", curfile, tstrerror(code));
+      sdbRestoreDirty(pSdb, i, pDirtyObjs[i]);
     }
+    taosHashCleanup(pDirtyObjs[i]);
   }
 
   if (code != 0) {
-    mError("failed to write sdb file:%s since %s", curfile, tstrerror(code));
+    mError("failed to write sdb delta file:%s since %s", curfile, tstrerror(code));
   } else {
+    pSdb->deltaSeq = seq;
     pSdb->commitIndex = pSdb->applyIndex;
     pSdb->commitTerm = pSdb->applyTerm;
     pSdb->commitConfig = pSdb->applyConfig;
-    mInfo("write sdb file success, commit index:%" PRId64 " term:%" PRId64 " config:%" PRId64 " file:%s",
-          pSdb->commitIndex, pSdb->commitTerm, pSdb->commitConfig, curfile);
+    mInfo("write sdb delta file success, %" PRId64 " rows, commit index:%" PRId64 " term:%" PRId64
+          " config:%" PRId64 " file:%s",
+          rows, pSdb->commitIndex, pSdb->commitTerm, pSdb->commitConfig, curfile);
   }
 
   terrno = code;
   return code;
 }
 
+static int32_t sdbMergeRaw(SSdb *pSdb, SSdbRaw *pRaw, void *param) {
+  SHashObj **pRawObjs = param;
+  if (pRaw->type < 0 || pRaw->type >= SDB_MAX || pRawObjs[pRaw->type] == NULL) {
+    terrno = TSDB_CODE_SDB_INVALID_TABLE_TYPE;
+    return terrno;
+  }
+
+  SSdbRow *pRow = (*pSdb->decodeFps[pRaw->type])(pRaw);
+  if (pRow == NULL) return terrno;
+  pRow->type = pRaw->type;
+
+  int32_t keySize = 0;
+  if (pSdb->keyTypes[pRaw->type] == SDB_KEY_INT32) {
+    keySize = sizeof(int32_t);
+  } else if (pSdb->keyTypes[pRaw->type] == SDB_KEY_BINARY) {
+    keySize = strlen(pRow->pObj) + 1;
+  } else {
+    keySize = sizeof(int64_t);
+  }
+
+  int32_t  size = sizeof(SSdbRaw) + pRaw->dataLen;
+  SSdbRaw *pCopy = taosMemoryMalloc(size);
+  if (pCopy == NULL) {
+    sdbFreeRow(pSdb, pRow, false);
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return terrno;
+  }
+  memcpy(pCopy, pRaw, size);
+
+  int32_t code = 0;
+  if (taosHashPut(pRawObjs[pRaw->type], pRow->pObj, keySize, &pCopy, sizeof(SSdbRaw *)) != 0) {
+    sdbFreeRaw(pCopy);
+    code = terrno = TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  sdbFreeRow(pSdb, pRow, false);
+  return code;
+}
+
+// merge sdb.data and the delta segments in (baseSeq, lastSeq] into one image, only the files are read
+static int32_t sdbMergeFiles(SSdb *pSdb, int64_t baseSeq, int64_t lastSeq, const char *outfile) {
+  int32_t      code = 0;
+  bool         exist = false;
+  char         file[PATH_MAX] = {0};
+  SSdbFileHead head = {0};
+  SHashObj    *pRawObjs[SDB_MAX] = {0};
+  TdFilePtr    pFile = NULL;
+
+  for (int32_t i = 0; i < SDB_MAX; ++i) {
+    if (pSdb->decodeFps[i] == NULL || pSdb->hashObjs[i] == NULL) continue;
+    pRawObjs[i] = sdbNewDirtyHash(pSdb, i);
+    if (pRawObjs[i] == NULL) {
+      code = terrno;
+      goto _OVER;
+    }
+  }
+
+  snprintf(file, sizeof(file), "%s%ssdb.data", pSdb->currDir, TD_DIRSEP);
+  code = sdbReadRawFile(pSdb, file, &head, sdbMergeRaw, pRawObjs, &exist);
+  if (code != 0) goto _OVER;
+
+  for (int64_t seq = baseSeq + 1; seq <= lastSeq; ++seq) {
+    sdbDeltaFileName(file, sizeof(file), pSdb->currDir, seq);
+    code = sdbReadRawFile(pSdb, file, &head, sdbMergeRaw, pRawObjs, &exist);
+    if (code == 0 && !exist) {
+      code = TSDB_CODE_FILE_CORRUPTED;
+    }
+    if (code != 0) goto _OVER;
+  }
+
+  pFile = taosOpenFile(outfile, TD_FILE_CREATE | TD_FILE_WRITE | TD_FILE_TRUNC);
+  if (pFile == NULL) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    goto _OVER;
+  }
+
+  head.deltaSeq = lastSeq;
+  if (sdbWriteFileHead(&head, pFile) != 0) {
+    code = terrno;
+    goto _OVER;
+  }
+
+  for (int32_t i = SDB_MAX - 1; i >= 0; --i) {
+    if (pRawObjs[i] == NULL) continue;
+
+    void *pIter = taosHashIterate(pRawObjs[i], NULL);
+    while (pIter != NULL) {
+      SSdbRaw *pRaw = *(SSdbRaw **)pIter;
+      if (pRaw->status != SDB_STATUS_DROPPED) {
+        code = sdbWriteRawToFile(pFile, pRaw);
+        if (code != 0) {
+          taosHashCancelIterate(pRawObjs[i], pIter);
+          goto _OVER;
+        }
+      }
+      pIter = taosHashIterate(pRawObjs[i], pIter);
+    }
+  }
+
+  code = sdbSyncFile(&pFile, outfile, NULL);
+
+_OVER:
+  if (pFile != NULL) {
+    taosCloseFile(&pFile);
+  }
+  for (int32_t i = 0; i < SDB_MAX; ++i) {
+    taosHashCleanup(pRawObjs[i]);
+  }
+
+  if (code != 0) {
+    mError("failed to merge sdb files to %s since %s, base seq:%" PRId64 " last seq:%" PRId64, outfile,
+           tstrerror(code), baseSeq, lastSeq);
+  }
+
+  terrno = code;
+  return code;
+}
+
+static void *sdbCompactThreadFp(void *param) {
+  SSdb *pSdb = param;
+  setThreadName("sdb-compact");
+
+  taosThreadMutexLock(&pSdb->filelock);
+  int64_t baseSeq = pSdb->baseSeq;
+  int64_t lastSeq = pSdb->deltaSeq;
+  taosThreadMutexUnlock(&pSdb->filelock);
+
+  char tmpfile[PATH_MAX] = {0};
+  snprintf(tmpfile, sizeof(tmpfile), "%s%ssdb.data.compact", pSdb->tmpDir, TD_DIRSEP);
+  char curfile[PATH_MAX] = {0};
+  snprintf(curfile, sizeof(curfile), "%s%ssdb.data", pSdb->currDir, TD_DIRSEP);
+
+  mInfo("start to compact sdb delta segments, base seq:%" PRId64 " last seq:%" PRId64, baseSeq, lastSeq);
+
+  int32_t code = sdbMergeFiles(pSdb, baseSeq, lastSeq, tmpfile);
+  if (code == 0) {
+    taosThreadMutexLock(&pSdb->filelock);
+    if (pSdb->baseSeq != baseSeq) {
+      code = TSDB_CODE_APP_ERROR;
+      mInfo("sdb compaction is outdated, base seq changed from %" PRId64 " to %" PRId64, baseSeq, pSdb->baseSeq);
+    } else if (taosRenameFile(tmpfile, curfile) != 0) {
+      code = TAOS_SYSTEM_ERROR(errno);
+      mError("failed to rename compacted sdb file to %s since %s", curfile, tstrerror(code));
+    } else {
+      // the new sdb.data covers the segments from here on, a crash before they are removed only leaves garbage
+      pSdb->baseSeq = lastSeq;
+      if (sdbSyncDir(pSdb->currDir) == 0) {
+        sdbRemoveDeltaFiles(pSdb, lastSeq);
+      }
+      mInfo("sdb delta segments compacted, base seq:%" PRId64, lastSeq);
+    }
+    taosThreadMutexUnlock(&pSdb->filelock);
+  }
+
+  if (code != 0) {
+    (void)taosRemoveFile(tmpfile);
+  }
+
+  atomic_store_8(&pSdb->compactDone, 1);
+  return NULL;
+}
+
+static void sdbStopCompact(SSdb *pSdb) {
+  if (!pSdb->compactStarted) return;
+
+  taosThreadJoin(pSdb->compactThread, NULL);
+  pSdb->compactStarted = false;
+}
+
+static void sdbStartCompact(SSdb *pSdb) {
+  if (pSdb->compactStarted) {
+    if (!atomic_load_8(&pSdb->compactDone)) return;
+    sdbStopCompact(pSdb);
+  }
+
+  TdThreadAttr thAttr;
+  taosThreadAttrInit(&thAttr);
+  taosThreadAttrSetDetachState(&thAttr, PTHREAD_CREATE_JOINABLE);
+
+  atomic_store_8(&pSdb->compactDone, 0);
+  if (taosThreadCreate(&pSdb->compactThread, &thAttr, sdbCompactThreadFp, pSdb) != 0) {
+    mError("failed to create sdb compact thread since %s", strerror(errno));
+  } else {
+    pSdb->compactStarted = true;
+  }
+
+  taosThreadAttrDestroy(&thAttr);
+}
+
 int32_t sdbWriteFile(SSdb *pSdb, int32_t delta) {
   int32_t code = 0;
+
+  // a full write replaces sdb.data and removes the delta segments, it is also the path taken on close
+  if (delta <= 0) {
+    sdbStopCompact(pSdb);
+  }
+
   if (pSdb->applyIndex == pSdb->commitIndex) {
     return 0;
   }
@@ -470,6 +1021,11 @@ int32_t sdbWriteFile(SSdb *pSdb, int32_t delta) {
     return 0;
   }
 
+  bool incremental = delta > 0 && tsMndSdbDeltaSegments > 0 && !pSdb->dirtyLost;
+  if (!incremental) {
+    sdbStopCompact(pSdb);
+  }
+
   taosThreadMutexLock(&pSdb->filelock);
   if (pSdb->pWal != NULL) {
     if (pSdb->sync > 0) {
@@ -477,7 +1033,7 @@ int32_t sdbWriteFile(SSdb *pSdb, int32_t delta) {
     }
   }
   if (code == 0) {
-    code = sdbWriteFileImp(pSdb);
+    code = incremental ? sdbWriteDeltaImp(pSdb) : sdbWriteFileImp(pSdb);
   }
   if (code == 0) {
     if (pSdb->pWal != NULL) {
@@ -489,7 +1045,13 @@ int32_t sdbWriteFile(SSdb *pSdb, int32_t delta) {
   if (code != 0) {
     mError("failed to write sdb file since %s", terrstr());
   }
+  int64_t segments = pSdb->deltaSeq - pSdb->baseSeq;
   taosThreadMutexUnlock(&pSdb->filelock);
+
+  if (code == 0 && incremental && segments >= tsMndSdbDeltaSegments) {
+    sdbStartCompact(pSdb);
+  }
+
   return code;
 }
 
@@ -553,7 +1115,15 @@ int32_t sdbStartRead(SSdb *pSdb, SSdbIter **ppIter, int64_t *index, int64_t *ter
   int64_t commitIndex = pSdb->commitIndex;
   int64_t commitTerm = pSdb->commitTerm;
   int64_t commitConfig = pSdb->commitConfig;
-  if (taosCopyFile(datafile, pIter->name) < 0) {
+  if (pSdb->deltaSeq > pSdb->baseSeq) {
+    // the peer receives a single file, fold the delta segments into it
+    if (sdbMergeFiles(pSdb, pSdb->baseSeq, pSdb->deltaSeq, pIter->name) != 0) {
+      taosThreadMutexUnlock(&pSdb->filelock);
+      mError("failed to merge sdb file %s to %s since %s", datafile, pIter->name, terrstr());
+      sdbCloseIter(pIter);
+      return -1;
+    }
+  } else if (taosCopyFile(datafile, pIter->name) < 0) {
     taosThreadMutexUnlock(&pSdb->filelock);
     terrno = TAOS_SYSTEM_ERROR(errno);
     mError("failed to copy sdb file %s to %s since %s", datafile, pIter->name, terrstr());
@@ -630,6 +1200,54 @@ int32_t sdbStartWrite(SSdb *pSdb, SSdbIter **ppIter) {
   return 0;
 }
 
+// move the delta seq in the head of a received sdb file past every local delta segment
+static int32_t sdbRebaseFile(SSdb *pSdb, const char *file) {
+  int64_t lastSeq = pSdb->deltaSeq;
+  SArray *pSeqs = sdbListDeltaSeqs(pSdb);
+  if (pSeqs == NULL) return -1;
+  if (taosArrayGetSize(pSeqs) > 0) {
+    lastSeq = TMAX(lastSeq, *(int64_t *)taosArrayGetLast(pSeqs));
+  }
+  taosArrayDestroy(pSeqs);
+
+  TdFilePtr pFile = taosOpenFile(file, TD_FILE_READ | TD_FILE_WRITE);
+  if (pFile == NULL) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  int32_t      code = 0;
+  SSdbFileHead head = {0};
+  if (sdbReadFileHead(&head, pFile) != 0) {
+    code = terrno;
+    goto _OVER;
+  }
+
+  if (head.deltaSeq >= lastSeq) {
+    goto _OVER;
+  }
+
+  head.deltaSeq = lastSeq;
+  if (taosLSeekFile(pFile, 0, SEEK_SET) != 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    goto _OVER;
+  }
+
+  if (sdbWriteFileHead(&head, pFile) != 0) {
+    code = terrno;
+    goto _OVER;
+  }
+
+  if (taosFsyncFile(pFile) != 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+  }
+
+_OVER:
+  taosCloseFile(&pFile);
+  terrno = code;
+  return code;
+}
+
 int32_t sdbStopWrite(SSdb *pSdb, SSdbIter *pIter, bool isApply, int64_t index, int64_t term, int64_t config) {
   int32_t code = -1;
 
@@ -648,14 +1266,32 @@ int32_t sdbStopWrite(SSdb *pSdb, SSdbIter *pIter, bool isApply, int64_t index, i
   taosCloseFile(&pIter->file);
   pIter->file = NULL;
 
+  // The local delta segments are based on the replaced sdb.data. They are removed only after the received file is in
+  // place, and the received file is rebased past them first, so that a crash in between never replays them on top of
+  // it nor leaves the old sdb.data without them.
+  sdbStopCompact(pSdb);
+  taosThreadMutexLock(&pSdb->filelock);
+
   char datafile[PATH_MAX] = {0};
   snprintf(datafile, sizeof(datafile), "%s%ssdb.data", pSdb->currDir, TD_DIRSEP);
+  if (sdbRebaseFile(pSdb, pIter->name) != 0) {
+    mError("sdbiter:%p, failed to rebase file %s since %s", pIter, pIter->name, terrstr());
+    taosThreadMutexUnlock(&pSdb->filelock);
+    goto _OVER;
+  }
+
   if (taosRenameFile(pIter->name, datafile) != 0) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     mError("sdbiter:%p, failed to rename file %s to %s since %s", pIter, pIter->name, datafile, terrstr());
+    taosThreadMutexUnlock(&pSdb->filelock);
     goto _OVER;
   }
 
+  if (sdbSyncDir(pSdb->currDir) == 0) {
+    sdbRemoveDeltaFiles(pSdb, INT64_MAX);
+  }
+  taosThreadMutexUnlock(&pSdb->filelock);
+
   if (sdbReadFile(pSdb) != 0) {
     mError("sdbiter:%p, failed to read from %s since %s", pIter, datafile, terrstr());
     goto _OVER;
@@ -132,6 +132,63 @@ static int32_t sdbGetkeySize(SSdb *pSdb, ESdbType type, const void *pKey) {
   return keySize;
 }
 
+static SSdbRaw *sdbDupRaw(SSdbRaw *pRaw) {
+  int32_t  size = sizeof(SSdbRaw) + pRaw->dataLen;
+  SSdbRaw *pNew = taosMemoryMalloc(size);
+  if (pNew != NULL) {
+    memcpy(pNew, pRaw, size);
+  }
+  return pNew;
+}
+
+static void sdbFreeDirtyRaw(void *p) { sdbFreeRaw(*(SSdbRaw **)p); }
+
+// key of the table -> SSdbRaw*, the raw is freed together with the entry
+SHashObj *sdbNewDirtyHash(SSdb *pSdb, int32_t type) {
+  int32_t hashType = 0;
+  if (pSdb->keyTypes[type] == SDB_KEY_INT32) {
+    hashType = TSDB_DATA_TYPE_INT;
+  } else if (pSdb->keyTypes[type] == SDB_KEY_INT64) {
+    hashType = TSDB_DATA_TYPE_BIGINT;
+  } else {
+    hashType = TSDB_DATA_TYPE_BINARY;
+  }
+
+  SHashObj *hash = taosHashInit(64, taosGetDefaultHashFunction(hashType), true, HASH_NO_LOCK);
+  if (hash == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  taosHashSetFreeFp(hash, sdbFreeDirtyRaw);
+  return hash;
+}
+
+// must be called with the write lock of the table held
+void sdbSetRowDirty(SSdb *pSdb, int32_t type, const void *pKey, int32_t keySize, SSdbRaw *pTombstone) {
+  SHashObj *pDirty = pSdb->dirtyObjs[type];
+  if (pDirty == NULL) {
+    sdbFreeRaw(pTombstone);
+    return;
+  }
+
+  if (taosHashPut(pDirty, pKey, keySize, &pTombstone, sizeof(SSdbRaw *)) != 0) {
+    // the row is lost for the next delta segment, fall back to a full write
+    mError("sdb:%s, failed to mark row dirty since %s", sdbTableName(type), terrstr());
+    sdbFreeRaw(pTombstone);
+    pSdb->dirtyLost = true;
+  }
+}
+
+void sdbClearDirty(SSdb *pSdb) {
+  for (ESdbType i = 0; i < SDB_MAX; ++i) {
+    if (pSdb->dirtyObjs[i] != NULL) {
+      taosHashClear(pSdb->dirtyObjs[i]);
+    }
+  }
+  pSdb->dirtyLost = false;
+}
+
 static int32_t sdbInsertRow(SSdb *pSdb, SHashObj *hash, SSdbRaw *pRaw, SSdbRow *pRow, int32_t keySize) {
   int32_t type = pRow->type;
   sdbWriteLock(pSdb, type);
@@ -170,6 +227,7 @@ static int32_t sdbInsertRow(SSdb *pSdb, SHashObj *hash, SSdbRaw *pRaw, SSdbRow *
     }
   }
 
+  sdbSetRowDirty(pSdb, type, pRow->pObj, keySize, NULL);
   sdbUnLock(pSdb, type);
 
   if (pSdb->keyTypes[pRow->type] == SDB_KEY_INT32) {
@@ -196,6 +254,7 @@ static int32_t sdbUpdateRow(SSdb *pSdb, SHashObj *hash, SSdbRaw *pRaw, SSdbRow *
   SSdbRow *pOldRow = *ppOldRow;
   pOldRow->status = pRaw->status;
   sdbPrintOper(pSdb, pOldRow, "update");
+  sdbSetRowDirty(pSdb, type, pOldRow->pObj, keySize, NULL);
   sdbUnLock(pSdb, type);
 
   int32_t     code = 0;
@@ -230,6 +289,7 @@ static int32_t sdbDeleteRow(SSdb *pSdb, SHashObj *hash, SSdbRaw *pRaw, SSdbRow *
 
   taosHashRemove(hash, pOldRow->pObj, keySize);
   pSdb->tableVer[pOldRow->type]++;
+  sdbSetRowDirty(pSdb, type, pOldRow->pObj, keySize, sdbDupRaw(pRaw));
   sdbUnLock(pSdb, type);
 
   sdbFreeRow(pSdb, pRow, false);
@@ -68,6 +68,7 @@ int32_t sndExpandTask(SSnode *pSnode, SStreamTask *pTask, int64_t ver) {
   pTask->schedStatus = TASK_SCHED_STATUS__INACTIVE;
   pTask->inputQueue = streamQueueOpen();
   pTask->outputQueue = streamQueueOpen();
+  taosThreadMutexInit(&pTask->dispatchLock, NULL);
 
   if (pTask->inputQueue == NULL || pTask->outputQueue == NULL) {
     return -1;
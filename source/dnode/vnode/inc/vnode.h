@@ -47,7 +47,7 @@ typedef struct SVSnapWriter SVSnapWriter;
 
 extern const SVnodeCfg vnodeCfgDefault;
 
-int32_t vnodeInit(int32_t nthreads);
+int32_t vnodeInit(int32_t nthreads, int32_t nApplyThreads);
 void    vnodeCleanup();
 int32_t vnodeCreate(const char *path, SVnodeCfg *pCfg, STfs *pTfs);
 int32_t vnodeAlterReplica(const char *path, SAlterVnodeReplicaReq *pReq, STfs *pTfs);
@@ -128,8 +128,16 @@ int64_t  metaGetNtbNum(SMeta *pMeta);
 typedef struct {
   int64_t uid;
   int64_t ctbNum;
+  // measured by the tag filters of queries, recent ones weigh more
+  int64_t idxProbeNum;  // tag index probes
+  int64_t idxProbeUs;   // time spent in them
+  int64_t idxCtbNum;    // child tables of the super table at the time of them
+  int64_t idxResNum;    // child tables returned by them
+  int64_t tagEvalNum;   // child tables the tag condition was evaluated on
+  int64_t tagEvalUs;    // time spent in evaluating it
 } SMetaStbStats;
 int32_t metaGetStbStats(SMeta *pMeta, int64_t uid, SMetaStbStats *pInfo);
+void    metaAddStbTagFilterStats(SMeta *pMeta, const SMetaStbStats *pStats);
 
 typedef struct SMetaFltParam {
   tb_uid_t suid;
@@ -282,7 +290,7 @@ int32_t vnodeEnqueueStreamMsg(SVnode *pVnode, SRpcMsg *pMsg);
 int32_t smaGetTSmaDays(SVnodeCfg *pCfg, void *pCont, uint32_t contLen, int32_t *days);
 
 // SVSnapReader
-int32_t vnodeSnapReaderOpen(SVnode *pVnode, int64_t sver, int64_t ever, SVSnapReader **ppReader);
+int32_t vnodeSnapReaderOpen(SVnode *pVnode, SSnapshotParam *pParam, SVSnapReader **ppReader);
 void    vnodeSnapReaderClose(SVSnapReader *pReader);
 int32_t vnodeSnapRead(SVSnapReader *pReader, uint8_t **ppData, uint32_t *nData);
 // SVSnapWriter
@@ -116,6 +116,7 @@ struct SRSmaStat {
   SRSmaFS          fs;                // for recovery/snapshot r/w
   SHashObj        *infoHash;          // key: suid, value: SRSmaInfo
   tsem_t           notEmpty;          // has items in queue buffer
+  volatile int64_t maxExecLag;        // ms, max delay from receipt to rollup of SubmitReq since the last report
 };
 
 struct SSmaStat {
@@ -140,6 +141,7 @@ struct SRSmaInfoItem {
   int8_t   level : 4;
   int8_t   fetchLevel : 4;
   int8_t   triggerStat;
+  int8_t   execPending;  // 1 the level task of the current batch waits for an executor
   uint16_t nScanned;
   int32_t  maxDelay;  // ms
   tmr_h    tmrId;
@@ -151,14 +153,18 @@ struct SRSmaInfo {
   STSchema *pTSchema;
   int64_t   suid;
   int64_t   lastRecv;  // ms
-  int8_t    assigned;  // 0 idle, 1 assgined for exec
+  int8_t    assigned;     // 0 idle, 1 assgined for exec
   int8_t    delFlag;
-  int16_t   padding;
+  int8_t    nExecLevels;  // level tasks of the current batch not finished yet
+  int8_t    padding;
+  int64_t   firstRecv;  // ms, when the first SubmitReq after the last read of queue is received
+  int64_t   batchRecv;  // ms, firstRecv of the items in qall
   T_REF_DECLARE()
   SRSmaInfoItem items[TSDB_RETENTION_L2];
   void         *taskInfo[TSDB_RETENTION_L2];   // qTaskInfo_t
   STaosQueue   *queue;                         // buffer queue of SubmitReq
   STaosQall    *qall;                          // buffer qall of SubmitReq
+  SArray       *aSubmit;                       // the current batch of SubmitReq(SPackedData) taken from qall
   void         *iTaskInfo[TSDB_RETENTION_L2];  // immutable qTaskInfo_t
   STaosQueue   *iQueue;                        // immutable buffer queue of SubmitReq
   STaosQall    *iQall;                         // immutable buffer qall of SubmitReq
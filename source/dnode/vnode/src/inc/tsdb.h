@@ -79,6 +79,8 @@ typedef struct STsdbFilterInfo  STsdbFilterInfo;
 #define TSDB_MAX_SUBBLOCKS 8
 #define TSDB_FHDR_SIZE     512
 
+#define TSDB_MIGRATE_CHUNK_SIZE (1024 * 1024)
+
 #define VERSION_MIN 0
 #define VERSION_MAX INT64_MAX
 
@@ -272,8 +274,11 @@ int32_t tsdbWriteSttBlk(SDataFWriter *pWriter, SArray *aSttBlk);
 int32_t tsdbWriteBlockData(SDataFWriter *pWriter, SBlockData *pBlockData, SBlockInfo *pBlkInfo, SSmaInfo *pSmaInfo,
                            int8_t cmprAlg, int8_t toLast);
 int32_t tsdbWriteDiskData(SDataFWriter *pWriter, const SDiskData *pDiskData, SBlockInfo *pBlkInfo, SSmaInfo *pSmaInfo);
+int32_t tsdbWriteDataBlockRaw(SDataFWriter *pWriter, const uint8_t *pRaw, SDataBlk *pDataBlk);
 
 int32_t tsdbDFileSetCopy(STsdb *pTsdb, SDFileSet *pSetFrom, SDFileSet *pSetTo);
+int32_t tsdbMigrateFile(STsdb *pTsdb, const char *fNameFrom, const char *fNameTo, int64_t size, uint8_t *pBuf,
+                        int64_t *nMoved);
 // SDataFReader
 int32_t tsdbDataFReaderOpen(SDataFReader **ppReader, STsdb *pTsdb, SDFileSet *pSet);
 int32_t tsdbDataFReaderClose(SDataFReader **ppReader);
@@ -283,6 +288,7 @@ int32_t tsdbReadSttBlk(SDataFReader *pReader, int32_t iStt, SArray *aSttBlk);
 int32_t tsdbReadBlockSma(SDataFReader *pReader, SDataBlk *pBlock, SArray *aColumnDataAgg);
 int32_t tsdbReadDataBlock(SDataFReader *pReader, SDataBlk *pBlock, SBlockData *pBlockData);
 int32_t tsdbReadDataBlockEx(SDataFReader *pReader, SDataBlk *pDataBlk, SBlockData *pBlockData);
+int32_t tsdbReadDataBlockRaw(SDataFReader *pReader, SDataBlk *pDataBlk, uint8_t *pRaw);
 int32_t tsdbReadSttBlock(SDataFReader *pReader, int32_t iStt, SSttBlk *pSttBlk, SBlockData *pBlockData);
 int32_t tsdbReadSttBlockEx(SDataFReader *pReader, int32_t iStt, SSttBlk *pSttBlk, SBlockData *pBlockData);
 // SDelFWriter
@@ -334,6 +340,9 @@ void tsdbCloseDataIter2(STsdbDataIter2 *pIter);
 int32_t tsdbDataIterCmprFn(const SRBTreeNode *pNode1, const SRBTreeNode *pNode2);
 /* next */
 int32_t tsdbDataIterNext2(STsdbDataIter2 *pIter, STsdbFilterInfo *pFilterInfo);
+/* block */
+int32_t tsdbDataIterPeekBlock(STsdbDataIter2 *pIter, STsdbFilterInfo *pFilterInfo, SDataBlk *pDataBlk);
+void    tsdbDataIterSkipBlock(STsdbDataIter2 *pIter);
 
 // structs =======================
 struct STsdbFS {
@@ -353,6 +362,11 @@ struct STsdb {
   TdThreadMutex  lruMutex;
   SLRUCache     *biCache;
   TdThreadMutex  biMutex;
+  TdThreadMutex  lastMutex;  // guards the in-place updates of the last/last_row entries in lruCache
+  TDB           *pCacheEnv;  // persisted last/last_row cache, NULL if it can not be opened
+  TTB           *pCacheDb;
+  TdThreadRwlock cacheLock;
+  int64_t        cacheGen;  // generation of the persisted entries, bumped when data files are replaced
 };
 
 struct TSDBKEY {
@@ -384,15 +398,33 @@ typedef struct SMemSkipList {
   SMemSkipListNode *pTail;
 } SMemSkipList;
 
+typedef struct SMemAppendRun SMemAppendRun;
+struct SMemAppendRun {
+  int8_t         flag;  // TSDBROW_ROW_FMT for rows of one submit, TSDBROW_COL_FMT for a block data
+  int32_t        nRow;
+  int64_t        version;
+  void          *pData;  // SRow *[nRow] for row format, SBlockData for col format
+  SMemAppendRun *pPrev;
+  SMemAppendRun *pNext;
+};
+
+// in-order batches are appended here without skiplist nodes, runs are sorted and do not overlap
+typedef struct SMemAppendList {
+  int64_t        size;
+  SMemAppendRun *pHead;
+  SMemAppendRun *pTail;
+} SMemAppendList;
+
 struct STbData {
-  tb_uid_t     suid;
-  tb_uid_t     uid;
-  TSKEY        minKey;
-  TSKEY        maxKey;
-  SDelData    *pHead;
-  SDelData    *pTail;
-  SMemSkipList sl;
-  STbData     *next;
+  tb_uid_t       suid;
+  tb_uid_t       uid;
+  TSKEY          minKey;
+  TSKEY          maxKey;
+  SDelData      *pHead;
+  SDelData      *pTail;
+  SMemSkipList   sl;
+  SMemAppendList al;
+  STbData       *next;
 };
 
 struct SMemTable {
@@ -523,6 +555,9 @@ struct STbDataIter {
   STbData          *pTbData;
   int8_t            backward;
   SMemSkipListNode *pNode;
+  SMemAppendRun    *pRun;  // NULL when the append list is exhausted
+  int32_t           iRun;
+  int8_t            fromRun;  // the current row comes from pRun
   TSDBROW          *pRow;
   TSDBROW           row;
 };
@@ -801,6 +836,8 @@ int32_t tsdbBICacheRelease(SLRUCache *pCache, LRUHandle *h);
 int32_t tsdbCacheDeleteLastrow(SLRUCache *pCache, tb_uid_t uid, TSKEY eKey);
 int32_t tsdbCacheDeleteLast(SLRUCache *pCache, tb_uid_t uid, TSKEY eKey);
 int32_t tsdbCacheDelete(SLRUCache *pCache, tb_uid_t uid, TSKEY eKey);
+int32_t tsdbCacheCommit(STsdb *pTsdb, SArray *aTbDataP);
+int32_t tsdbCacheInvalidateStore(STsdb *pTsdb);
 
 void   tsdbCacheSetCapacity(SVnode *pVnode, size_t capacity);
 size_t tsdbCacheGetCapacity(SVnode *pVnode);
@@ -830,6 +867,14 @@ static FORCE_INLINE int32_t tsdbKeyCmprFn(const void *p1, const void *p2) {
 // #define SL_NODE_FORWARD(n, l)  ((n)->forwards[l])
 // #define SL_NODE_BACKWARD(n, l) ((n)->forwards[(n)->level + (l)])
 
+static FORCE_INLINE TSDBROW tsdbMemAppendRunGetRow(SMemAppendRun *pRun, int32_t iRow) {
+  if (pRun->flag == TSDBROW_ROW_FMT) {
+    return tsdbRowFromTSRow(pRun->version, ((SRow **)pRun->pData)[iRow]);
+  } else {
+    return tsdbRowFromBlockData((SBlockData *)pRun->pData, iRow);
+  }
+}
+
 static FORCE_INLINE TSDBROW *tsdbTbDataIterGet(STbDataIter *pIter) {
   if (pIter == NULL) return NULL;
 
@@ -837,25 +882,44 @@ static FORCE_INLINE TSDBROW *tsdbTbDataIterGet(STbDataIter *pIter) {
     return pIter->pRow;
   }
 
+  bool hasNode = true;
   if (pIter->backward) {
-    if (pIter->pNode == pIter->pTbData->sl.pHead) {
-      return NULL;
-    }
+    hasNode = (pIter->pNode != pIter->pTbData->sl.pHead);
   } else {
-    if (pIter->pNode == pIter->pTbData->sl.pTail) {
-      return NULL;
+    hasNode = (pIter->pNode != pIter->pTbData->sl.pTail);
+  }
+
+  if (!hasNode && pIter->pRun == NULL) {
+    return NULL;
+  }
+
+  if (hasNode) {
+    if (pIter->pNode->flag == TSDBROW_ROW_FMT) {
+      pIter->row = tsdbRowFromTSRow(pIter->pNode->version, (SRow *)pIter->pNode->pData);
+    } else if (pIter->pNode->flag == TSDBROW_COL_FMT) {
+      pIter->row = tsdbRowFromBlockData((SBlockData *)pIter->pNode->pData, pIter->pNode->iRow);
+    } else {
+      ASSERT(0);
     }
   }
 
-  pIter->pRow = &pIter->row;
-  if (pIter->pNode->flag == TSDBROW_ROW_FMT) {
-    pIter->row = tsdbRowFromTSRow(pIter->pNode->version, pIter->pNode->pData);
-  } else if (pIter->pNode->flag == TSDBROW_COL_FMT) {
-    pIter->row = tsdbRowFromBlockData(pIter->pNode->pData, pIter->pNode->iRow);
-  } else {
-    ASSERT(0);
+  // merge the skiplist with the append list
+  pIter->fromRun = 0;
+  if (pIter->pRun) {
+    TSDBROW rRow = tsdbMemAppendRunGetRow(pIter->pRun, pIter->iRun);
+    if (hasNode) {
+      TSDBKEY rKey = {TSDBROW_VERSION(&rRow), TSDBROW_TS(&rRow)};
+      TSDBKEY nKey = {TSDBROW_VERSION(&pIter->row), TSDBROW_TS(&pIter->row)};
+      int32_t c = tsdbKeyCmprFn(&rKey, &nKey);
+      hasNode = pIter->backward ? (c < 0) : (c > 0);
+    }
+    if (!hasNode) {
+      pIter->row = rRow;
+      pIter->fromRun = 1;
+    }
   }
 
+  pIter->pRow = &pIter->row;
   return pIter->pRow;
 }
 
@@ -50,6 +50,11 @@ int32_t vnodeDecodeConfig(const SJson* pJson, void* pObj);
 
 // vnodeModule.c
 int32_t vnodeScheduleTask(int32_t (*execute)(void*), void* arg);
+int32_t vnodeApplyThreads();
+int32_t vnodeOpenApplyPool(SVnode* pVnode, int32_t nthreads);
+void    vnodeCloseApplyPool(SVnode* pVnode);
+int32_t vnodeApplyPoolThreads(SVnode* pVnode);
+int32_t vnodeScheduleApplyTask(SVnode* pVnode, int32_t (*execute)(void*), void* arg);
 
 // vnodeBufPool.c
 typedef struct SVBufPoolNode SVBufPoolNode;
@@ -117,6 +122,9 @@ bool    vnodeIsLeader(SVnode* pVnode);
 bool    vnodeIsRoleLeader(SVnode* pVnode);
 int     vnodeShouldCommit(SVnode* pVnode);
 
+// vnodeSvr.c
+int32_t vnodeApplySubmitData(SVnode* pVnode, int64_t version, SSubmitReq2* pSubmitReq, SSubmitRsp2* pSubmitRsp);
+
 #ifdef __cplusplus
 }
 #endif
@@ -14,8 +14,9 @@
  */
 #include "meta.h"
 
-#define META_CACHE_BASE_BUCKET  1024
-#define META_CACHE_STATS_BUCKET 16
+#define META_CACHE_BASE_BUCKET       1024
+#define META_CACHE_STATS_BUCKET      16
+#define META_STATS_TAG_FILTER_WINDOW 64
 
 // (uid , suid) : child table
 // (uid,     0) : normal table
@@ -429,6 +430,43 @@ int32_t metaStatsCacheGet(SMeta* pMeta, int64_t uid, SMetaStbStats* pInfo) {
   return code;
 }
 
+int32_t metaStatsCacheAddTagFilter(SMeta* pMeta, const SMetaStbStats* pInfo) {
+  // meta is wlocked for calling this func.
+
+  SMetaCache*         pCache = pMeta->pCache;
+  int32_t             iBucket = TABS(pInfo->uid) % pCache->sStbStatsCache.nBucket;
+  SMetaStbStatsEntry* pEntry = pCache->sStbStatsCache.aBucket[iBucket];
+  while (pEntry && pEntry->info.uid != pInfo->uid) {
+    pEntry = pEntry->next;
+  }
+
+  if (pEntry == NULL) {
+    return TSDB_CODE_NOT_FOUND;
+  }
+
+  SMetaStbStats* pStats = &pEntry->info;
+  pStats->idxProbeNum += pInfo->idxProbeNum;
+  pStats->idxProbeUs += pInfo->idxProbeUs;
+  pStats->idxCtbNum += pInfo->idxCtbNum;
+  pStats->idxResNum += pInfo->idxResNum;
+  pStats->tagEvalNum += pInfo->tagEvalNum;
+  pStats->tagEvalUs += pInfo->tagEvalUs;
+
+  // halve the history once it covers enough of the recent queries
+  if (pStats->idxProbeNum > META_STATS_TAG_FILTER_WINDOW) {
+    pStats->idxProbeNum /= 2;
+    pStats->idxProbeUs /= 2;
+    pStats->idxCtbNum /= 2;
+    pStats->idxResNum /= 2;
+  }
+  if (pStats->tagEvalNum > META_STATS_TAG_FILTER_WINDOW * TMAX(pStats->ctbNum, 1)) {
+    pStats->tagEvalNum /= 2;
+    pStats->tagEvalUs /= 2;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
 static int checkAllEntriesInCache(const STagFilterResEntry* pEntry, SArray* pInvalidRes, int32_t keyLen,
                                   SLRUCache* pCache, uint64_t suid) {
   SListIter iter = {0};
@@ -1543,6 +1543,12 @@ _exit:
   return code;
 }
 
+void metaAddStbTagFilterStats(SMeta *pMeta, const SMetaStbStats *pStats) {
+  metaWLock(pMeta);
+  metaStatsCacheAddTagFilter(pMeta, pStats);
+  metaULock(pMeta);
+}
+
 void metaUpdateStbStats(SMeta *pMeta, int64_t uid, int64_t delta) {
   SMetaStbStats stats = {0};
 
@@ -114,10 +114,15 @@ void *tdFreeRSmaInfo(SSma *pSma, SRSmaInfo *pInfo, bool isDeepFree) {
     if (isDeepFree) {
       if (pInfo->queue) taosCloseQueue(pInfo->queue);
       if (pInfo->qall) taosFreeQall(pInfo->qall);
+      if (pInfo->aSubmit) {
+        tdFreeRSmaSubmitItems(pInfo->aSubmit);
+        taosArrayDestroy(pInfo->aSubmit);
+      }
       if (pInfo->iQueue) taosCloseQueue(pInfo->iQueue);
       if (pInfo->iQall) taosFreeQall(pInfo->iQall);
       pInfo->queue = NULL;
       pInfo->qall = NULL;
+      pInfo->aSubmit = NULL;
       pInfo->iQueue = NULL;
       pInfo->iQall = NULL;
     }
@@ -376,6 +381,10 @@ int32_t tdRSmaProcessCreateImpl(SSma *pSma, SRSmaParam *param, int64_t suid, con
   if (!(pRSmaInfo->qall = taosAllocateQall())) {
     goto _err;
   }
+  if (!(pRSmaInfo->aSubmit = taosArrayInit(8, sizeof(SPackedData)))) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    goto _err;
+  }
   if (!(pRSmaInfo->iQueue = taosOpenQueue())) {
     goto _err;
   }
@@ -740,9 +749,11 @@ static int32_t tdExecuteRSmaImplAsync(SSma *pSma, int64_t version, const void *p
   *(int64_t *)pItem = version;
   memcpy(POINTER_SHIFT(pItem, sizeof(int64_t)), pMsg, len);
 
-  taosWriteQitem(pInfo->queue, qItem);
-
+  // set before the item is visible in the queue, the executor takes it along with the item
   pInfo->lastRecv = taosGetTimestampMs();
+  atomic_val_compare_exchange_64(&pInfo->firstRecv, 0, pInfo->lastRecv);
+
+  taosWriteQitem(pInfo->queue, qItem);
 
   SRSmaStat *pRSmaStat = SMA_RSMA_STAT(pSma);
 
@@ -1504,49 +1515,193 @@ _err:
   return TSDB_CODE_FAILED;
 }
 
-static int32_t tdRSmaBatchExec(SSma *pSma, SRSmaInfo *pInfo, STaosQall *qall, SArray *pSubmitArr, ERsmaExecType type) {
-  taosArrayClear(pSubmitArr);
-  while (1) {
+static void tdRSmaFinishBatch(SSma *pSma, SRSmaInfo *pInfo) {
+  SRSmaStat *pRSmaStat = SMA_RSMA_STAT(pSma);
+  int32_t    size = taosArrayGetSize(pInfo->aSubmit);
+  int64_t    lag = taosGetTimestampMs() - pInfo->batchRecv;
+
+  int64_t maxLag = atomic_load_64(&pRSmaStat->maxExecLag);
+  while (lag > maxLag) {
+    int64_t oldLag = atomic_val_compare_exchange_64(&pRSmaStat->maxExecLag, maxLag, lag);
+    if (oldLag == maxLag) break;
+    maxLag = oldLag;
+  }
+
+  smaDebug("vgId:%d, suid:%" PRIi64 " batch of %d items rolled up, lag:%" PRIi64 " ms", SMA_VID(pSma), pInfo->suid,
+           size, lag);
+
+  tdFreeRSmaSubmitItems(pInfo->aSubmit);
+  atomic_fetch_sub_64(&pRSmaStat->nBufItems, size);
+}
+
+/**
+ * @brief run the level tasks of the current batch not started yet, the levels are independent as they consume the
+ * same SubmitReq and write to different tsdb, so any executor could pick one up
+ *
+ * @param pSma
+ * @param pInfo
+ * @return true if the batch is finished by the caller, which owns the rsma info then
+ */
+static bool tdRSmaExecLevels(SSma *pSma, SRSmaInfo *pInfo) {
+  for (int8_t i = 1; i <= TSDB_RETENTION_L2; ++i) {
+    SRSmaInfoItem *pItem = RSMA_INFO_ITEM(pInfo, i - 1);
+    if (atomic_val_compare_exchange_8(&pItem->execPending, 1, 0) != 1) {
+      continue;
+    }
+
+    int32_t size = taosArrayGetSize(pInfo->aSubmit);
+    if (tdExecuteRSmaImpl(pSma, pInfo->aSubmit->pData, size, STREAM_INPUT__MERGED_SUBMIT, pInfo, RSMA_EXEC_OVERFLOW,
+                          i) < 0) {
+      smaError("vgId:%d, batch exec for suid:%" PRIi64 " level:%" PRIi8 " size:%d failed since %s", SMA_VID(pSma),
+               pInfo->suid, i, size, terrstr());
+    }
+
+    if (atomic_sub_fetch_8(&pInfo->nExecLevels, 1) == 0) {
+      tdRSmaFinishBatch(pSma, pInfo);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief take a batch of at most RSMA_SUBMIT_BATCH_SIZE items from qall and run the level tasks on it
+ *
+ * @param pSma
+ * @param pInfo
+ * @return true if the batch is finished by the caller, otherwise the executor finishing the last level owns the rsma
+ * info then
+ */
+static bool tdRSmaBatchExec(SSma *pSma, SRSmaInfo *pInfo) {
+  SArray *pSubmitArr = pInfo->aSubmit;
+  while (taosArrayGetSize(pSubmitArr) < RSMA_SUBMIT_BATCH_SIZE) {
     void *msg = NULL;
-    taosGetQitem(qall, (void **)&msg);
-    if (msg) {
-      SPackedData packData = {.msgLen = *(int32_t *)msg,
-                              .ver = *(int64_t *)POINTER_SHIFT(msg, sizeof(int32_t)),
-                              .msgStr = POINTER_SHIFT(msg, sizeof(int32_t) + sizeof(int64_t))};
-
-      if (!taosArrayPush(pSubmitArr, &packData)) {
-        tdFreeRSmaSubmitItems(pSubmitArr);
-        goto _err;
-      }
-    } else {
+    taosGetQitem(pInfo->qall, (void **)&msg);
+    if (!msg) {
       break;
     }
+
+    SPackedData packData = {.msgLen = *(int32_t *)msg,
+                            .ver = *(int64_t *)POINTER_SHIFT(msg, sizeof(int32_t)),
+                            .msgStr = POINTER_SHIFT(msg, sizeof(int32_t) + sizeof(int64_t))};
+
+    if (!taosArrayPush(pSubmitArr, &packData)) {
+      smaError("vgId:%d, batch exec for suid:%" PRIi64 " size:%d failed since %s", SMA_VID(pSma), pInfo->suid,
+               (int32_t)taosArrayGetSize(pSubmitArr) + 1, tstrerror(TSDB_CODE_OUT_OF_MEMORY));
+      taosFreeQitem(msg);
+      atomic_fetch_sub_64(&SMA_RSMA_STAT(pSma)->nBufItems, 1);
+      tdRSmaFinishBatch(pSma, pInfo);
+      return true;
+    }
   }
 
-  int32_t size = taosArrayGetSize(pSubmitArr);
-  if (size > 0) {
-    for (int32_t i = 1; i <= TSDB_RETENTION_L2; ++i) {
-      if (tdExecuteRSmaImpl(pSma, pSubmitArr->pData, size, STREAM_INPUT__MERGED_SUBMIT, pInfo, type, i) < 0) {
-        goto _err;
-      }
+  int8_t nLevels = 0;
+  for (int8_t i = 0; i < TSDB_RETENTION_L2; ++i) {
+    if (RSMA_INFO_QTASK(pInfo, i)) ++nLevels;
+  }
+  if (nLevels == 0 || taosArrayGetSize(pSubmitArr) == 0) {
+    tdRSmaFinishBatch(pSma, pInfo);
+    return true;
+  }
+
+  atomic_store_8(&pInfo->nExecLevels, nLevels);
+  for (int8_t i = 0; i < TSDB_RETENTION_L2; ++i) {
+    if (RSMA_INFO_QTASK(pInfo, i)) {
+      atomic_store_8(&RSMA_INFO_ITEM(pInfo, i)->execPending, 1);
     }
-    tdFreeRSmaSubmitItems(pSubmitArr);
   }
-  return TSDB_CODE_SUCCESS;
-_err:
-  smaError("vgId:%d, batch exec for suid:%" PRIi64 " execType:%d size:%d failed since %s", SMA_VID(pSma), pInfo->suid,
-           type, (int32_t)taosArrayGetSize(pSubmitArr), terrstr());
-  tdFreeRSmaSubmitItems(pSubmitArr);
-  while (1) {
-    void *msg = NULL;
-    taosGetQitem(qall, (void **)&msg);
-    if (msg) {
-      taosFreeQitem(msg);
-    } else {
-      break;
+
+  // wake up an idle executor to run the other level
+  if (nLevels > 1 && tsNumOfVnodeRsmaThreads > 1) {
+    tsem_post(&SMA_RSMA_STAT(pSma)->notEmpty);
+  }
+
+  return tdRSmaExecLevels(pSma, pInfo);
+}
+
+static FORCE_INLINE bool tdRSmaHasBufItems(SRSmaInfo *pInfo) {
+  return (taosQallUnAccessedItemSize(pInfo->qall) > 0) || (taosQueueItemSize(pInfo->queue) > 0);
+}
+
+/**
+ * @brief consume the buffered items and fetch the results of the rsma info owned by the caller in greedy mode, and
+ * release it at last unless the last batch is left to another executor
+ *
+ * @param pSma
+ * @param pRSmaStat
+ * @param pInfo
+ * @return int32_t
+ */
+static int32_t tdRSmaExecInfo(SSma *pSma, SRSmaStat *pRSmaStat, SRSmaInfo *pInfo) {
+  int32_t code = 0;
+  int32_t lino = 0;
+  int32_t batchCnt = -1;
+  int32_t batchMax = taosHashGetSize(RSMA_INFO_HASH(pRSmaStat)) / tsNumOfVnodeRsmaThreads;
+  bool    occupied = (batchMax <= 1);
+  if (batchMax > 1) {
+    batchMax = 100 / batchMax;
+    batchMax = TMAX(batchMax, 4);
+  }
+
+  while (occupied || (++batchCnt < batchMax)) {  // greedy mode
+    // the items left in qall by the last batch go first
+    if (taosQallUnAccessedItemSize(pInfo->qall) <= 0 &&
+        taosReadAllQitems(pInfo->queue, pInfo->qall) > 0) {  // queue has mutex lock
+      pInfo->batchRecv = atomic_exchange_64(&pInfo->firstRecv, 0);
+      if (pInfo->batchRecv == 0) pInfo->batchRecv = taosGetTimestampMs();
+    }
+
+    int32_t qallItemSize = taosQallUnAccessedItemSize(pInfo->qall);
+    if (qallItemSize > 0) {
+      smaDebug("vgId:%d, suid:%" PRIi64 " batchSize:%d, remain:%d, execType:%" PRIi32, SMA_VID(pSma), pInfo->suid,
+               TMIN(qallItemSize, RSMA_SUBMIT_BATCH_SIZE), qallItemSize, RSMA_EXEC_OVERFLOW);
+      if (!tdRSmaBatchExec(pSma, pInfo)) {
+        return TSDB_CODE_SUCCESS;
+      }
+    }
+
+    if (RSMA_NEED_FETCH(pInfo)) {
+      int8_t oldStat = atomic_val_compare_exchange_8(RSMA_COMMIT_STAT(pRSmaStat), 0, 2);
+      if (oldStat == 0 ||
+          ((oldStat == 2) && atomic_load_8(RSMA_TRIGGER_STAT(pRSmaStat)) < TASK_TRIGGER_STAT_PAUSED)) {
+        int32_t oldVal = atomic_fetch_add_32(&pRSmaStat->nFetchAll, 1);
+
+        if (ASSERTS(oldVal >= 0, "oldVal of nFetchAll: %d < 0", oldVal)) {
+          code = TSDB_CODE_APP_ERROR;
+          TSDB_CHECK_CODE(code, lino, _exit);
+        }
+
+        int8_t curStat = atomic_load_8(RSMA_COMMIT_STAT(pRSmaStat));
+        if (curStat == 1) {
+          smaDebug("vgId:%d, fetch all not exec as commit stat is %" PRIi8, SMA_VID(pSma), curStat);
+        } else {
+          tdRSmaFetchAllResult(pSma, pInfo);
+        }
+
+        if (0 == atomic_sub_fetch_32(&pRSmaStat->nFetchAll, 1)) {
+          atomic_store_8(RSMA_COMMIT_STAT(pRSmaStat), 0);
+        }
+      }
+    }
+
+    if (qallItemSize > 0) {
+      continue;
+    }
+    if (RSMA_NEED_FETCH(pInfo)) {
+      continue;
     }
+
+    break;
   }
-  return TSDB_CODE_FAILED;
+
+_exit:
+  atomic_val_compare_exchange_8(&pInfo->assigned, 1, 0);
+  if (code) {
+    smaError("vgId:%d, %s failed at line %d since %s, suid:%" PRIi64, SMA_VID(pSma), __func__, lino, tstrerror(code),
+             pInfo->suid);
+  }
+  return code;
 }
 
 /**
@@ -1564,79 +1719,32 @@ int32_t tdRSmaProcessExecImpl(SSma *pSma, ERsmaExecType type) {
   SSmaEnv   *pEnv = SMA_RSMA_ENV(pSma);
   SRSmaStat *pRSmaStat = (SRSmaStat *)SMA_ENV_STAT(pEnv);
   SHashObj  *infoHash = NULL;
-  SArray    *pSubmitArr = NULL;
-  bool       isFetchAll = false;
 
   if (!pRSmaStat || !(infoHash = RSMA_INFO_HASH(pRSmaStat))) {
     code = TSDB_CODE_RSMA_INVALID_STAT;
     TSDB_CHECK_CODE(code, lino, _exit);
   }
 
-  if (!(pSubmitArr =
-            taosArrayInit(TMIN(RSMA_SUBMIT_BATCH_SIZE, atomic_load_64(&pRSmaStat->nBufItems)), sizeof(SPackedData)))) {
-    code = TSDB_CODE_OUT_OF_MEMORY;
-    TSDB_CHECK_CODE(code, lino, _exit);
-  }
-
   while (true) {
     // step 1: rsma exec - consume data in buffer queue for all suids
     if (type == RSMA_EXEC_OVERFLOW) {
       void *pIter = NULL;
       while ((pIter = taosHashIterate(infoHash, pIter))) {
         SRSmaInfo *pInfo = *(SRSmaInfo **)pIter;
-        if (atomic_val_compare_exchange_8(&pInfo->assigned, 0, 1) == 0) {
-          if ((taosQueueItemSize(pInfo->queue) > 0) || RSMA_NEED_FETCH(pInfo)) {
-            int32_t batchCnt = -1;
-            int32_t batchMax = taosHashGetSize(infoHash) / tsNumOfVnodeRsmaThreads;
-            bool    occupied = (batchMax <= 1);
-            if (batchMax > 1) {
-              batchMax = 100 / batchMax;
-              batchMax = TMAX(batchMax, 4);
-            }
-            while (occupied || (++batchCnt < batchMax)) {    // greedy mode
-              taosReadAllQitems(pInfo->queue, pInfo->qall);  // queue has mutex lock
-              int32_t qallItemSize = taosQallItemSize(pInfo->qall);
-              if (qallItemSize > 0) {
-                tdRSmaBatchExec(pSma, pInfo, pInfo->qall, pSubmitArr, type);
-                smaDebug("vgId:%d, batchSize:%d, execType:%" PRIi32, SMA_VID(pSma), qallItemSize, type);
-              }
-
-              if (RSMA_NEED_FETCH(pInfo)) {
-                int8_t oldStat = atomic_val_compare_exchange_8(RSMA_COMMIT_STAT(pRSmaStat), 0, 2);
-                if (oldStat == 0 ||
-                    ((oldStat == 2) && atomic_load_8(RSMA_TRIGGER_STAT(pRSmaStat)) < TASK_TRIGGER_STAT_PAUSED)) {
-                  int32_t oldVal = atomic_fetch_add_32(&pRSmaStat->nFetchAll, 1);
-
-                  if (ASSERTS(oldVal >= 0, "oldVal of nFetchAll: %d < 0", oldVal)) {
-                    code = TSDB_CODE_APP_ERROR;
-                    TSDB_CHECK_CODE(code, lino, _exit);
-                  }
-
-                  int8_t curStat = atomic_load_8(RSMA_COMMIT_STAT(pRSmaStat));
-                  if (curStat == 1) {
-                    smaDebug("vgId:%d, fetch all not exec as commit stat is %" PRIi8, SMA_VID(pSma), curStat);
-                  } else {
-                    tdRSmaFetchAllResult(pSma, pInfo);
-                  }
-
-                  if (0 == atomic_sub_fetch_32(&pRSmaStat->nFetchAll, 1)) {
-                    atomic_store_8(RSMA_COMMIT_STAT(pRSmaStat), 0);
-                  }
-                }
-              }
-
-              if (qallItemSize > 0) {
-                atomic_fetch_sub_64(&pRSmaStat->nBufItems, qallItemSize);
-                continue;
-              }
-              if (RSMA_NEED_FETCH(pInfo)) {
-                continue;
-              }
-
-              break;
-            }
+        if (atomic_load_8(&pInfo->nExecLevels) > 0 && tdRSmaExecLevels(pSma, pInfo)) {
+          // finished the batch another executor started, go on with the rsma info
+          code = tdRSmaExecInfo(pSma, pRSmaStat, pInfo);
+        } else if (atomic_val_compare_exchange_8(&pInfo->assigned, 0, 1) == 0) {
+          if (tdRSmaHasBufItems(pInfo) || RSMA_NEED_FETCH(pInfo)) {
+            code = tdRSmaExecInfo(pSma, pRSmaStat, pInfo);
+          } else {
+            atomic_val_compare_exchange_8(&pInfo->assigned, 1, 0);
           }
-          atomic_val_compare_exchange_8(&pInfo->assigned, 1, 0);
+        }
+
+        if (code) {
+          taosHashCancelIterate(infoHash, pIter);
+          TSDB_CHECK_CODE(code, lino, _exit);
         }
       }
     } else {
@@ -1662,9 +1770,32 @@ int32_t tdRSmaProcessExecImpl(SSma *pSma, ERsmaExecType type) {
   }  // end of while(true)
 
 _exit:
-  taosArrayDestroy(pSubmitArr);
   if (code) {
     smaError("vgId:%d, %s failed at line %d since %s", TD_VID(pVnode), __func__, lino, tstrerror(code));
   }
   return code;
 }
+
+void smaGetRSmaLoad(SSma *pSma, int64_t *nBufItems, int64_t *maxExecLag) {
+  SSmaEnv *pEnv = SMA_RSMA_ENV(pSma);
+  if (!pEnv || !SMA_ENV_STAT(pEnv)) {
+    *nBufItems = 0;
+    *maxExecLag = 0;
+    return;
+  }
+
+  SRSmaStat *pRSmaStat = (SRSmaStat *)SMA_ENV_STAT(pEnv);
+  *nBufItems = atomic_load_64(&pRSmaStat->nBufItems);
+  *maxExecLag = atomic_load_64(&pRSmaStat->maxExecLag);
+}
+
+void smaResetRSmaLoad(SSma *pSma, int64_t maxExecLag) {
+  SSmaEnv *pEnv = SMA_RSMA_ENV(pSma);
+  if (!pEnv || !SMA_ENV_STAT(pEnv)) {
+    return;
+  }
+
+  // a larger lag since the report is kept for the next one
+  SRSmaStat *pRSmaStat = (SRSmaStat *)SMA_ENV_STAT(pEnv);
+  atomic_val_compare_exchange_64(&pRSmaStat->maxExecLag, maxExecLag, 0);
+}
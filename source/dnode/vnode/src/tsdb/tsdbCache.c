@@ -15,6 +15,22 @@
 
 #include "tsdb.h"
 
+/*
+ * The last/last_row cache is persisted in a TDB store per tsdb, keyed by the cache key of the LRU. At each commit,
+ * the entries of the committed tables are refreshed from the LRU, or removed if the LRU does not hold them. So a
+ * persisted entry always covers the data files, and it is merged with the rows in mem/imem when loaded.
+ * Each entry records the generation of the store, which is bumped when data files are replaced or expired, and the
+ * columns it was built with, so entries of an old schema are ignored.
+ */
+#define TSDB_CACHE_STORE_DIR   "cache.rdb"
+#define TSDB_CACHE_STORE_VER   1
+#define TSDB_CACHE_GEN_KEY     0  // uid 0 is never used by a table
+#define TSDB_CACHE_COMMIT_TBS  4096
+
+static int32_t tsdbOpenCacheStore(STsdb *pTsdb);
+static void    tsdbCloseCacheStore(STsdb *pTsdb);
+static bool    tsdbCacheColsMatch(SArray *pLast, STSchema *pTSchema);
+
 static int32_t tsdbOpenBICache(STsdb *pTsdb) {
   int32_t    code = 0;
   SLRUCache *pCache = taosLRUCacheInit(10 * 1024 * 1024, 0, .5);
@@ -63,6 +79,14 @@ int32_t tsdbOpenCache(STsdb *pTsdb) {
   taosLRUCacheSetStrictCapacity(pCache, false);
 
   taosThreadMutexInit(&pTsdb->lruMutex, NULL);
+  taosThreadMutexInit(&pTsdb->lastMutex, NULL);
+  taosThreadRwlockInit(&pTsdb->cacheLock, NULL);
+
+  // the cache still works in memory without the store
+  if (tsdbOpenCacheStore(pTsdb) != TSDB_CODE_SUCCESS) {
+    tsdbWarn("vgId:%d, failed to open last cache store since %s", TD_VID(pTsdb->pVnode), tstrerror(terrno));
+    tsdbCloseCacheStore(pTsdb);
+  }
 
 _err:
   pTsdb->lruCache = pCache;
@@ -77,6 +101,10 @@ void tsdbCloseCache(STsdb *pTsdb) {
     taosLRUCacheCleanup(pCache);
 
     taosThreadMutexDestroy(&pTsdb->lruMutex);
+    taosThreadMutexDestroy(&pTsdb->lastMutex);
+
+    tsdbCloseCacheStore(pTsdb);
+    taosThreadRwlockDestroy(&pTsdb->cacheLock);
   }
 
   tsdbCloseBICache(pTsdb);
@@ -105,6 +133,516 @@ static void deleteTableCacheLast(const void *key, size_t keyLen, void *value) {
   taosArrayDestroy(value);
 }
 
+static int32_t tsdbOpenCacheStore(STsdb *pTsdb) {
+  int32_t code = 0;
+  int32_t lino = 0;
+  SVnode *pVnode = pTsdb->pVnode;
+  char    path[TSDB_FILENAME_LEN] = {0};
+
+  if (pVnode->pTfs) {
+    snprintf(path, TSDB_FILENAME_LEN, "%s%s%s%s%s", tfsGetPrimaryPath(pVnode->pTfs), TD_DIRSEP, pTsdb->path, TD_DIRSEP,
+             TSDB_CACHE_STORE_DIR);
+  } else {
+    snprintf(path, TSDB_FILENAME_LEN, "%s%s%s", pTsdb->path, TD_DIRSEP, TSDB_CACHE_STORE_DIR);
+  }
+
+  if (taosMkDir(path) != 0) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  if (tdbOpen(path, 4096, 256, &pTsdb->pCacheEnv, 0) < 0) {
+    code = terrno ? terrno : TSDB_CODE_FAILED;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  if (tdbTbOpen("last.db", sizeof(uint64_t), -1, NULL, pTsdb->pCacheEnv, &pTsdb->pCacheDb, 0) < 0) {
+    code = terrno ? terrno : TSDB_CODE_FAILED;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  uint64_t genKey = TSDB_CACHE_GEN_KEY;
+  void    *pVal = NULL;
+  int      vLen = 0;
+  if (tdbTbGet(pTsdb->pCacheDb, &genKey, sizeof(genKey), &pVal, &vLen) == 0) {
+    if (vLen == sizeof(int64_t)) {
+      pTsdb->cacheGen = *(int64_t *)pVal;
+    }
+    tdbFree(pVal);
+  }
+
+_exit:
+  if (code) {
+    terrno = code;
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pVnode), __func__, lino, tstrerror(code));
+  } else {
+    tsdbDebug("vgId:%d, last cache store opened, generation:%" PRId64, TD_VID(pVnode), pTsdb->cacheGen);
+  }
+  return code;
+}
+
+static void tsdbCloseCacheStore(STsdb *pTsdb) {
+  if (pTsdb->pCacheDb) {
+    tdbTbClose(pTsdb->pCacheDb);
+    pTsdb->pCacheDb = NULL;
+  }
+
+  if (pTsdb->pCacheEnv) {
+    tdbClose(pTsdb->pCacheEnv);
+    pTsdb->pCacheEnv = NULL;
+  }
+}
+
+static int32_t tEncodeLastCols(SEncoder *pEncoder, int64_t gen, SArray *pLast) {
+  int32_t nCol = taosArrayGetSize(pLast);
+
+  if (tStartEncode(pEncoder) < 0) return -1;
+  if (tEncodeI8(pEncoder, TSDB_CACHE_STORE_VER) < 0) return -1;
+  if (tEncodeI64(pEncoder, gen) < 0) return -1;
+  if (tEncodeI32v(pEncoder, nCol) < 0) return -1;
+  for (int32_t iCol = 0; iCol < nCol; ++iCol) {
+    SLastCol *pCol = taosArrayGet(pLast, iCol);
+    if (tEncodeI64(pEncoder, pCol->ts) < 0) return -1;
+    if (tEncodeI16v(pEncoder, pCol->colVal.cid) < 0) return -1;
+    if (tEncodeI8(pEncoder, pCol->colVal.type) < 0) return -1;
+    if (tEncodeI8(pEncoder, pCol->colVal.flag) < 0) return -1;
+    if (IS_VAR_DATA_TYPE(pCol->colVal.type)) {
+      if (tEncodeBinary(pEncoder, pCol->colVal.value.pData, pCol->colVal.value.nData) < 0) return -1;
+    } else {
+      if (tEncodeI64(pEncoder, pCol->colVal.value.val) < 0) return -1;
+    }
+  }
+  tEndEncode(pEncoder);
+
+  return 0;
+}
+
+// the array is not returned if the entry is of another generation or format
+static int32_t tDecodeLastCols(SDecoder *pDecoder, int64_t gen, SArray **ppLast) {
+  int8_t  ver = 0;
+  int64_t entryGen = 0;
+  int32_t nCol = 0;
+
+  *ppLast = NULL;
+  if (tStartDecode(pDecoder) < 0) return -1;
+  if (tDecodeI8(pDecoder, &ver) < 0) return -1;
+  if (ver != TSDB_CACHE_STORE_VER) return 0;
+  if (tDecodeI64(pDecoder, &entryGen) < 0) return -1;
+  if (entryGen != gen) return 0;
+  if (tDecodeI32v(pDecoder, &nCol) < 0) return -1;
+
+  SArray *pLast = taosArrayInit(nCol > 0 ? nCol : 1, sizeof(SLastCol));
+  if (pLast == NULL) return -1;
+
+  for (int32_t iCol = 0; iCol < nCol; ++iCol) {
+    SLastCol col = {0};
+    if (tDecodeI64(pDecoder, &col.ts) < 0) goto _err;
+    if (tDecodeI16v(pDecoder, &col.colVal.cid) < 0) goto _err;
+    if (tDecodeI8(pDecoder, &col.colVal.type) < 0) goto _err;
+    if (tDecodeI8(pDecoder, &col.colVal.flag) < 0) goto _err;
+    if (IS_VAR_DATA_TYPE(col.colVal.type)) {
+      uint8_t *pData = NULL;
+      uint32_t nData = 0;
+      if (tDecodeBinary(pDecoder, &pData, &nData) < 0) goto _err;
+      if (nData > 0) {
+        col.colVal.value.pData = taosMemoryMalloc(nData);
+        if (col.colVal.value.pData == NULL) goto _err;
+        memcpy(col.colVal.value.pData, pData, nData);
+      }
+      col.colVal.value.nData = nData;
+    } else {
+      if (tDecodeI64(pDecoder, &col.colVal.value.val) < 0) goto _err;
+    }
+    taosArrayPush(pLast, &col);
+  }
+  tEndDecode(pDecoder);
+
+  *ppLast = pLast;
+  return 0;
+
+_err:
+  deleteTableCacheLast(NULL, 0, pLast);
+  return -1;
+}
+
+static int32_t tsdbCacheEncodeLast(STsdb *pTsdb, SArray *pLast, void **ppBuf, int32_t *pSize) {
+  int32_t  code = 0;
+  SEncoder encoder = {0};
+
+  tEncoderInit(&encoder, NULL, 0);
+  code = tEncodeLastCols(&encoder, pTsdb->cacheGen, pLast);
+  *pSize = encoder.pos;
+  tEncoderClear(&encoder);
+  if (code < 0) {
+    return TSDB_CODE_INVALID_PARA;
+  }
+
+  *ppBuf = taosMemoryMalloc(*pSize);
+  if (*ppBuf == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  tEncoderInit(&encoder, *ppBuf, *pSize);
+  code = tEncodeLastCols(&encoder, pTsdb->cacheGen, pLast);
+  tEncoderClear(&encoder);
+  if (code < 0) {
+    taosMemoryFreeClear(*ppBuf);
+    return TSDB_CODE_INVALID_PARA;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+// the persisted entry of the current generation, NULL if there is none
+static SArray *tsdbCacheGetStored(STsdb *pTsdb, const char *key, int keyLen) {
+  void   *pVal = NULL;
+  int     vLen = 0;
+  SArray *pLast = NULL;
+
+  if (tdbTbGet(pTsdb->pCacheDb, key, keyLen, &pVal, &vLen) < 0) {
+    return NULL;
+  }
+
+  SDecoder decoder = {0};
+  tDecoderInit(&decoder, pVal, vLen);
+  if (tDecodeLastCols(&decoder, pTsdb->cacheGen, &pLast) < 0) {
+    pLast = NULL;
+  }
+  tDecoderClear(&decoder);
+  tdbFree(pVal);
+
+  return pLast;
+}
+
+static int32_t tsdbCacheSetCol(SLastCol *pCol, TSKEY ts, const SColVal *pColVal) {
+  if (IS_VAR_DATA_TYPE(pCol->colVal.type) && pCol->colVal.value.nData > 0) {
+    taosMemoryFreeClear(pCol->colVal.value.pData);
+  }
+
+  pCol->ts = ts;
+  pCol->colVal = *pColVal;
+  if (IS_VAR_DATA_TYPE(pColVal->type)) {
+    pCol->colVal.value.pData = NULL;
+    if (pColVal->value.nData > 0) {
+      pCol->colVal.value.pData = taosMemoryMalloc(pColVal->value.nData);
+      if (pCol->colVal.value.pData == NULL) {
+        pCol->colVal.value.nData = 0;
+        return TSDB_CODE_OUT_OF_MEMORY;
+      }
+      memcpy(pCol->colVal.value.pData, pColVal->value.pData, pColVal->value.nData);
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * Bring a persisted entry up to date with the rows of a table being committed, when the lru does not hold the table,
+ * e.g. it was evicted. The rows being committed are newer than the ones in the data files the entry covers. False is
+ * returned if the result can not be told from the entry and these rows alone, e.g. deletes or partial rows are being
+ * committed, and the entry has to go.
+ */
+static bool tsdbCacheFoldCommitRows(STsdb *pTsdb, STbData *pTbData, int cacheType, SArray *pLast) {
+  STSchema    *pTSchema = NULL;
+  STbDataIter *pIter = NULL;
+  bool        *aDone = NULL;
+  TSKEY       *aNullTs = NULL;  // the key of the newest null of each column
+  bool         folded = false;
+
+  if (pTbData->pHead != NULL) {
+    return false;
+  }
+
+  pTSchema = metaGetTbTSchema(pTsdb->pVnode->pMeta, pTbData->uid, -1, 1);
+  if (pTSchema == NULL || !tsdbCacheColsMatch(pLast, pTSchema)) {
+    goto _exit;
+  }
+
+  // the table has no rows in the data files
+  if (taosArrayGetSize(pLast) == 0) {
+    for (int32_t iCol = 0; iCol < pTSchema->numOfCols; ++iCol) {
+      SLastCol col = {.ts = 0, .colVal = COL_VAL_NULL(pTSchema->columns[iCol].colId, pTSchema->columns[iCol].type)};
+      taosArrayPush(pLast, &col);
+    }
+  }
+
+  if (tsdbTbDataIterCreate(pTbData, NULL, 1, &pIter) != 0) {
+    goto _exit;
+  }
+
+  TSDBROW *pRow = tsdbTbDataIterGet(pIter);
+  if (pRow == NULL) {
+    folded = true;
+    goto _exit;
+  }
+
+  TSKEY     maxTs = TSDBROW_TS(pRow);
+  SLastCol *pTs = (SLastCol *)taosArrayGet(pLast, 0);
+  SColVal   tsVal = COL_VAL_VALUE(pTSchema->columns[0].colId, pTSchema->columns[0].type, (SValue){.val = maxTs});
+
+  if (cacheType == 0) {
+    if (maxTs < pTs->ts) {
+      folded = true;
+      goto _exit;
+    }
+
+    // the newest row replaces the whole entry, unless it is merged with another version of the same key
+    if (tsdbCacheSetCol(pTs, maxTs, &tsVal) != 0) goto _exit;
+    for (int32_t iCol = 1; iCol < pTSchema->numOfCols; ++iCol) {
+      SColVal colVal = {0};
+      tsdbRowGetColVal(pRow, pTSchema, iCol, &colVal);
+      if (COL_VAL_IS_NONE(&colVal)) goto _exit;
+      if (tsdbCacheSetCol((SLastCol *)taosArrayGet(pLast, iCol), maxTs, &colVal) != 0) goto _exit;
+    }
+
+    folded = !(tsdbTbDataIterNext(pIter) && TSDBROW_TS(tsdbTbDataIterGet(pIter)) == maxTs);
+    goto _exit;
+  }
+
+  // last: the newest value of each column, scanning the rows from the newest
+  if (maxTs > pTs->ts && tsdbCacheSetCol(pTs, maxTs, &tsVal) != 0) {
+    goto _exit;
+  }
+
+  aDone = taosMemoryCalloc(pTSchema->numOfCols, sizeof(bool));
+  aNullTs = taosMemoryCalloc(pTSchema->numOfCols, sizeof(TSKEY));
+  if (aDone == NULL || aNullTs == NULL) {
+    goto _exit;
+  }
+  for (int32_t iCol = 0; iCol < pTSchema->numOfCols; ++iCol) {
+    aNullTs[iCol] = TSKEY_MIN;
+  }
+
+  int32_t nDone = 1;
+  while (pRow != NULL && nDone < pTSchema->numOfCols) {
+    TSKEY ts = TSDBROW_TS(pRow);
+    for (int32_t iCol = 1; iCol < pTSchema->numOfCols; ++iCol) {
+      if (aDone[iCol]) continue;
+
+      SLastCol *pCol = (SLastCol *)taosArrayGet(pLast, iCol);
+      if (COL_VAL_IS_VALUE(&pCol->colVal) && ts < pCol->ts) {
+        // the persisted value is newer than any row left
+        aDone[iCol] = true;
+        nDone++;
+        continue;
+      }
+
+      SColVal colVal = {0};
+      tsdbRowGetColVal(pRow, pTSchema, iCol, &colVal);
+      if (COL_VAL_IS_NONE(&colVal) || ts == aNullTs[iCol]) continue;
+
+      // a null of the newest version hides the older versions of the same key, which may be in the data files
+      if (COL_VAL_IS_NULL(&colVal)) {
+        if (COL_VAL_IS_VALUE(&pCol->colVal) && ts == pCol->ts) goto _exit;
+        aNullTs[iCol] = ts;
+        continue;
+      }
+
+      if (tsdbCacheSetCol(pCol, ts, &colVal) != 0) goto _exit;
+      aDone[iCol] = true;
+      nDone++;
+    }
+
+    pRow = tsdbTbDataIterNext(pIter) ? tsdbTbDataIterGet(pIter) : NULL;
+  }
+
+  folded = true;
+
+_exit:
+  taosMemoryFree(aDone);
+  taosMemoryFree(aNullTs);
+  tsdbTbDataIterDestroy(pIter);
+  taosMemoryFree(pTSchema);
+  return folded;
+}
+
+static int32_t tsdbCacheStoreLast(STsdb *pTsdb, TXN *pTxn, STbData *pTbData, int cacheType) {
+  char    key[32] = {0};
+  int     keyLen = 0;
+  int32_t code = 0;
+  int32_t size = 0;
+  void   *pBuf = NULL;
+
+  getTableCacheKey(pTbData->uid, cacheType, key, &keyLen);
+  LRUHandle *h = taosLRUCacheLookup(pTsdb->lruCache, key, keyLen);
+  if (h != NULL) {
+    // the entry is updated in place by the writes going on
+    SArray *pLast = (SArray *)taosLRUCacheValue(pTsdb->lruCache, h);
+    taosThreadMutexLock(&pTsdb->lastMutex);
+    code = tsdbCacheEncodeLast(pTsdb, pLast, &pBuf, &size);
+    taosThreadMutexUnlock(&pTsdb->lastMutex);
+    taosLRUCacheRelease(pTsdb->lruCache, h, false);
+  } else {
+    SArray *pLast = tsdbCacheGetStored(pTsdb, key, keyLen);
+    if (pLast == NULL) {
+      return TSDB_CODE_SUCCESS;
+    }
+
+    if (tsdbCacheFoldCommitRows(pTsdb, pTbData, cacheType, pLast)) {
+      code = tsdbCacheEncodeLast(pTsdb, pLast, &pBuf, &size);
+    } else {
+      // the rows the entry is built from are deleted or merged with the rows being committed
+      tsdbDebug("vgId:%d, uid:%" PRId64 " drop persisted last cache type:%d", TD_VID(pTsdb->pVnode), pTbData->uid,
+                cacheType);
+      tdbTbDelete(pTsdb->pCacheDb, key, keyLen, pTxn);
+    }
+    deleteTableCacheLast(NULL, 0, pLast);
+  }
+
+  if (code == 0 && pBuf != NULL && tdbTbUpsert(pTsdb->pCacheDb, key, keyLen, pBuf, size, pTxn) < 0) {
+    code = terrno ? terrno : TSDB_CODE_FAILED;
+  }
+
+  taosMemoryFree(pBuf);
+  return code;
+}
+
+/**
+ * Refresh the persisted entries of the tables being committed. It must be done before the data files are
+ * committed, so a crash in between leaves entries that are covered by the wal.
+ */
+int32_t tsdbCacheCommit(STsdb *pTsdb, SArray *aTbDataP) {
+  int32_t code = 0;
+  int32_t lino = 0;
+  int32_t nTbData = taosArrayGetSize(aTbDataP);
+
+  if (pTsdb->pCacheEnv == NULL || nTbData == 0) {
+    return code;
+  }
+
+  for (int32_t iStart = 0; iStart < nTbData; iStart += TSDB_CACHE_COMMIT_TBS) {
+    int32_t iEnd = TMIN(iStart + TSDB_CACHE_COMMIT_TBS, nTbData);
+    TXN    *pTxn = NULL;
+
+    taosThreadRwlockWrlock(&pTsdb->cacheLock);
+    if (tdbBegin(pTsdb->pCacheEnv, &pTxn, tdbDefaultMalloc, tdbDefaultFree, NULL,
+                 TDB_TXN_WRITE | TDB_TXN_READ_UNCOMMITTED) < 0) {
+      taosThreadRwlockUnlock(&pTsdb->cacheLock);
+      code = terrno ? terrno : TSDB_CODE_FAILED;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    for (int32_t iTbData = iStart; iTbData < iEnd && code == 0; ++iTbData) {
+      STbData *pTbData = (STbData *)taosArrayGetP(aTbDataP, iTbData);
+
+      code = tsdbCacheStoreLast(pTsdb, pTxn, pTbData, 0);
+      if (code == 0) {
+        code = tsdbCacheStoreLast(pTsdb, pTxn, pTbData, 1);
+      }
+    }
+
+    if (code) {
+      tdbAbort(pTsdb->pCacheEnv, pTxn);
+    } else if (tdbCommit(pTsdb->pCacheEnv, pTxn) < 0 || tdbPostCommit(pTsdb->pCacheEnv, pTxn) < 0) {
+      code = terrno ? terrno : TSDB_CODE_FAILED;
+    }
+    taosThreadRwlockUnlock(&pTsdb->cacheLock);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  return code;
+}
+
+/**
+ * Invalidate all persisted entries, when data files are replaced by a snapshot or expired. It must be done before the
+ * file set change is committed.
+ */
+int32_t tsdbCacheInvalidateStore(STsdb *pTsdb) {
+  int32_t  code = 0;
+  TXN     *pTxn = NULL;
+  uint64_t genKey = TSDB_CACHE_GEN_KEY;
+
+  if (pTsdb->pCacheEnv == NULL) {
+    return code;
+  }
+
+  taosThreadRwlockWrlock(&pTsdb->cacheLock);
+  int64_t gen = pTsdb->cacheGen + 1;
+  if (tdbBegin(pTsdb->pCacheEnv, &pTxn, tdbDefaultMalloc, tdbDefaultFree, NULL,
+               TDB_TXN_WRITE | TDB_TXN_READ_UNCOMMITTED) < 0) {
+    code = terrno ? terrno : TSDB_CODE_FAILED;
+  } else if (tdbTbUpsert(pTsdb->pCacheDb, &genKey, sizeof(genKey), &gen, sizeof(gen), pTxn) < 0) {
+    code = terrno ? terrno : TSDB_CODE_FAILED;
+    tdbAbort(pTsdb->pCacheEnv, pTxn);
+  } else if (tdbCommit(pTsdb->pCacheEnv, pTxn) < 0 || tdbPostCommit(pTsdb->pCacheEnv, pTxn) < 0) {
+    code = terrno ? terrno : TSDB_CODE_FAILED;
+  } else {
+    pTsdb->cacheGen = gen;
+  }
+  taosThreadRwlockUnlock(&pTsdb->cacheLock);
+
+  if (code) {
+    tsdbError("vgId:%d, failed to invalidate last cache store since %s", TD_VID(pTsdb->pVnode), tstrerror(code));
+  } else {
+    tsdbInfo("vgId:%d, last cache store invalidated, generation:%" PRId64, TD_VID(pTsdb->pVnode), gen);
+  }
+
+  // the in-memory entries may hold the rows of the replaced files too
+  taosLRUCacheEraseUnrefEntries(pTsdb->lruCache);
+  return code;
+}
+
+/**
+ * Drop the in-memory and persisted entries of the tables dropped. The commit only upserts the entries of the tables
+ * it carries, so this is where the entry of a table goes for good.
+ */
+int32_t tsdbCacheDropTables(STsdb *pTsdb, SArray *tbUids) {
+  int32_t code = 0;
+  int32_t nUid = taosArrayGetSize(tbUids);
+  TXN    *pTxn = NULL;
+
+  if (pTsdb == NULL || pTsdb->lruCache == NULL || nUid == 0) {
+    return code;
+  }
+
+  for (int32_t iUid = 0; iUid < nUid; ++iUid) {
+    tb_uid_t uid = *(tb_uid_t *)taosArrayGet(tbUids, iUid);
+    char     key[32] = {0};
+    int      keyLen = 0;
+
+    for (int cacheType = 0; cacheType < 2; ++cacheType) {
+      getTableCacheKey(uid, cacheType, key, &keyLen);
+      taosLRUCacheErase(pTsdb->lruCache, key, keyLen);
+    }
+  }
+
+  if (pTsdb->pCacheEnv == NULL) {
+    return code;
+  }
+
+  taosThreadRwlockWrlock(&pTsdb->cacheLock);
+  if (tdbBegin(pTsdb->pCacheEnv, &pTxn, tdbDefaultMalloc, tdbDefaultFree, NULL,
+               TDB_TXN_WRITE | TDB_TXN_READ_UNCOMMITTED) < 0) {
+    code = terrno ? terrno : TSDB_CODE_FAILED;
+  } else {
+    for (int32_t iUid = 0; iUid < nUid; ++iUid) {
+      tb_uid_t uid = *(tb_uid_t *)taosArrayGet(tbUids, iUid);
+      char     key[32] = {0};
+      int      keyLen = 0;
+
+      for (int cacheType = 0; cacheType < 2; ++cacheType) {
+        getTableCacheKey(uid, cacheType, key, &keyLen);
+        tdbTbDelete(pTsdb->pCacheDb, key, keyLen, pTxn);
+      }
+    }
+
+    if (tdbCommit(pTsdb->pCacheEnv, pTxn) < 0 || tdbPostCommit(pTsdb->pCacheEnv, pTxn) < 0) {
+      code = terrno ? terrno : TSDB_CODE_FAILED;
+    }
+  }
+  taosThreadRwlockUnlock(&pTsdb->cacheLock);
+
+  if (code) {
+    tsdbError("vgId:%d, failed to drop %d tables from last cache store since %s", TD_VID(pTsdb->pVnode), nUid,
+              tstrerror(code));
+  }
+  return code;
+}
+
 int32_t tsdbCacheDeleteLastrow(SLRUCache *pCache, tb_uid_t uid, TSKEY eKey) {
   int32_t code = 0;
 
@@ -236,6 +774,9 @@ int32_t tsdbCacheInsertLastrow(SLRUCache *pCache, STsdb *pTsdb, tb_uid_t uid, TS
     TSKEY     keyTs = TSDBROW_TS(row);
     bool      invalidate = false;
 
+    // the commit persists the entry while it is updated here
+    taosThreadMutexLock(&pTsdb->lastMutex);
+
     SArray *pLast = (SArray *)taosLRUCacheValue(pCache, h);
     int16_t nCol = taosArrayGetSize(pLast);
     int16_t iCol = 0;
@@ -332,6 +873,7 @@ int32_t tsdbCacheInsertLastrow(SLRUCache *pCache, STsdb *pTsdb, tb_uid_t uid, TS
     }
 
   _invalidate:
+    taosThreadMutexUnlock(&pTsdb->lastMutex);
     taosMemoryFreeClear(pTSchema);
 
     taosLRUCacheRelease(pCache, h, invalidate);
@@ -357,6 +899,9 @@ int32_t tsdbCacheInsertLast(SLRUCache *pCache, tb_uid_t uid, TSDBROW *row, STsdb
     TSKEY     keyTs = TSDBROW_TS(row);
     bool      invalidate = false;
 
+    // the commit persists the entry while it is updated here
+    taosThreadMutexLock(&pTsdb->lastMutex);
+
     SArray *pLast = (SArray *)taosLRUCacheValue(pCache, h);
     int16_t nCol = taosArrayGetSize(pLast);
     int16_t iCol = 0;
@@ -453,6 +998,7 @@ int32_t tsdbCacheInsertLast(SLRUCache *pCache, tb_uid_t uid, TSDBROW *row, STsdb
     }
 
   _invalidate:
+    taosThreadMutexUnlock(&pTsdb->lastMutex);
     taosMemoryFreeClear(pTSchema);
 
     taosLRUCacheRelease(pCache, h, invalidate);
@@ -1074,9 +1620,10 @@ typedef struct {
   STsdb           *pTsdb;
 } CacheNextRowIter;
 
+// memOnly: only iterate the rows in mem and imem, the data files are covered by the persisted cache
 static int32_t nextRowIterOpen(CacheNextRowIter *pIter, tb_uid_t uid, STsdb *pTsdb, STSchema *pTSchema, tb_uid_t suid,
                                SSttBlockLoadInfo *pLoadInfo, STsdbReadSnap *pReadSnap, SDataFReader **pDataFReader,
-                               SDataFReader **pDataFReaderLast) {
+                               SDataFReader **pDataFReaderLast, bool memOnly) {
   int code = 0;
 
   STbData *pMem = NULL;
@@ -1093,7 +1640,7 @@ static int32_t nextRowIterOpen(CacheNextRowIter *pIter, tb_uid_t uid, STsdb *pTs
 
   pIter->pSkyline = taosArrayInit(32, sizeof(TSDBKEY));
 
-  SDelFile *pDelFile = pReadSnap->fs.pDelFile;
+  SDelFile *pDelFile = memOnly ? NULL : pReadSnap->fs.pDelFile;
   if (pDelFile) {
     SDelFReader *pDelFReader;
 
@@ -1155,6 +1702,13 @@ static int32_t nextRowIterOpen(CacheNextRowIter *pIter, tb_uid_t uid, STsdb *pTs
   pIter->input[3] =
       (TsdbNextRowState){&pIter->fsRow, false, true, &pIter->fsState, getNextRowFromFS, clearNextRowFromFS};
 
+  if (memOnly) {
+    pIter->input[2].stop = true;
+    pIter->input[2].next = false;
+    pIter->input[3].stop = true;
+    pIter->input[3].next = false;
+  }
+
   if (pMem) {
     pIter->memState.pMem = pMem;
     pIter->memState.state = SMEMNEXTROW_ENTER;
@@ -1265,7 +1819,8 @@ _err:
   return code;
 }
 
-static int32_t mergeLastRow(tb_uid_t uid, STsdb *pTsdb, bool *dup, SArray **ppColArray, SCacheRowsReader *pr) {
+static int32_t mergeLastRow(tb_uid_t uid, STsdb *pTsdb, bool *dup, SArray **ppColArray, SCacheRowsReader *pr,
+                            bool memOnly) {
   int32_t code = 0;
 
   STSchema *pTSchema = pr->pSchema;  // metaGetTbTSchema(pTsdb->pVnode->pMeta, uid, -1, 1);
@@ -1280,7 +1835,7 @@ static int32_t mergeLastRow(tb_uid_t uid, STsdb *pTsdb, bool *dup, SArray **ppCo
 
   CacheNextRowIter iter = {0};
   nextRowIterOpen(&iter, uid, pTsdb, pTSchema, pr->suid, pr->pLoadInfo, pr->pReadSnap, &pr->pDataFReader,
-                  &pr->pDataFReaderLast);
+                  &pr->pDataFReaderLast, memOnly);
 
   do {
     TSDBROW *pRow = NULL;
@@ -1427,7 +1982,7 @@ static int32_t initLastColArray(STSchema *pTSchema, SArray **ppColArray) {
   return TSDB_CODE_SUCCESS;
 }
 
-static int32_t mergeLast(tb_uid_t uid, STsdb *pTsdb, SArray **ppLastArray, SCacheRowsReader *pr) {
+static int32_t mergeLast(tb_uid_t uid, STsdb *pTsdb, SArray **ppLastArray, SCacheRowsReader *pr, bool memOnly) {
   STSchema *pTSchema = pr->pSchema;  // metaGetTbTSchema(pTsdb->pVnode->pMeta, uid, -1, 1);
   int16_t   nLastCol = pTSchema->numOfCols;
   int16_t   noneCol = 0;
@@ -1445,7 +2000,7 @@ static int32_t mergeLast(tb_uid_t uid, STsdb *pTsdb, SArray **ppLastArray, SCach
 
   CacheNextRowIter iter = {0};
   nextRowIterOpen(&iter, uid, pTsdb, pTSchema, pr->suid, pr->pLoadInfo, pr->pReadSnap, &pr->pDataFReader,
-                  &pr->pDataFReaderLast);
+                  &pr->pDataFReaderLast, memOnly);
 
   do {
     TSDBROW *pRow = NULL;
@@ -1566,6 +2121,162 @@ _err:
   return code;
 }
 
+static bool tsdbCacheColsMatch(SArray *pLast, STSchema *pTSchema) {
+  int32_t nCol = taosArrayGetSize(pLast);
+  if (nCol == 0) {  // no data in the files
+    return true;
+  }
+
+  if (nCol != pTSchema->numOfCols) {
+    return false;
+  }
+
+  for (int32_t iCol = 0; iCol < nCol; ++iCol) {
+    SLastCol *pCol = (SLastCol *)taosArrayGet(pLast, iCol);
+    if (pCol->colVal.cid != pTSchema->columns[iCol].colId || pCol->colVal.type != pTSchema->columns[iCol].type) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void tsdbCacheMoveCol(SLastCol *pDst, SLastCol *pSrc) {
+  if (IS_VAR_DATA_TYPE(pDst->colVal.type) && pDst->colVal.value.nData > 0) {
+    taosMemoryFree(pDst->colVal.value.pData);
+  }
+
+  *pDst = *pSrc;
+  if (IS_VAR_DATA_TYPE(pSrc->colVal.type)) {
+    pSrc->colVal.value.nData = 0;
+    pSrc->colVal.value.pData = NULL;
+  }
+}
+
+// merge the last values of the rows in mem/imem into the persisted ones. Both arrays are consumed, NULL is returned if
+// a row in mem has the same key as a persisted value, since the versions have to be merged from the files then.
+static SArray *tsdbCacheMergeMemLast(SArray *pLast, SArray *pMemLast, int cacheType) {
+  int32_t nCol = taosArrayGetSize(pLast);
+  int32_t nMemCol = taosArrayGetSize(pMemLast);
+  SArray *pRes = pLast;
+  SArray *pDrop = pMemLast;
+
+  if (nMemCol == 0) {
+    // no rows in mem
+  } else if (nCol == 0) {
+    pRes = pMemLast;
+    pDrop = pLast;
+  } else if (nCol != nMemCol) {
+    pRes = NULL;
+  } else if (cacheType == 0) {
+    SLastCol *pTs = (SLastCol *)taosArrayGet(pLast, 0);
+    SLastCol *pMemTs = (SLastCol *)taosArrayGet(pMemLast, 0);
+    if (pMemTs->ts > pTs->ts) {
+      pRes = pMemLast;
+      pDrop = pLast;
+    } else if (pMemTs->ts == pTs->ts) {
+      pRes = NULL;
+    }
+  } else {
+    for (int32_t iCol = 1; iCol < nCol; ++iCol) {
+      SLastCol *pCol = (SLastCol *)taosArrayGet(pLast, iCol);
+      SLastCol *pMemCol = (SLastCol *)taosArrayGet(pMemLast, iCol);
+      if (!COL_VAL_IS_VALUE(&pMemCol->colVal)) {
+        continue;
+      }
+
+      if (COL_VAL_IS_VALUE(&pCol->colVal) && pMemCol->ts == pCol->ts) {
+        pRes = NULL;
+        break;
+      }
+
+      if (!COL_VAL_IS_VALUE(&pCol->colVal) || pMemCol->ts > pCol->ts) {
+        tsdbCacheMoveCol(pCol, pMemCol);
+      }
+    }
+
+    SLastCol *pTs = (SLastCol *)taosArrayGet(pLast, 0);
+    SLastCol *pMemTs = (SLastCol *)taosArrayGet(pMemLast, 0);
+    if (pRes != NULL && pMemTs->ts > pTs->ts) {
+      *pTs = *pMemTs;
+    }
+  }
+
+  if (pRes == NULL) {
+    deleteTableCacheLast(NULL, 0, pLast);
+    deleteTableCacheLast(NULL, 0, pMemLast);
+  } else {
+    deleteTableCacheLast(NULL, 0, pDrop);
+  }
+
+  return pRes;
+}
+
+// load the table from the persisted store, NULL if the entry is missing or can not be used
+static SArray *tsdbCacheLoadFromStore(STsdb *pTsdb, tb_uid_t uid, int cacheType, SCacheRowsReader *pr) {
+  char    key[32] = {0};
+  int     keyLen = 0;
+  void   *pVal = NULL;
+  int     vLen = 0;
+  SArray *pLast = NULL;
+  SArray *pMemLast = NULL;
+
+  if (pTsdb->pCacheEnv == NULL) {
+    return NULL;
+  }
+
+  // deletes not committed yet may remove the rows the entry is built from
+  STbData *pMem = pr->pReadSnap->pMem ? tsdbGetTbDataFromMemTable(pr->pReadSnap->pMem, pr->suid, uid) : NULL;
+  STbData *pIMem = pr->pReadSnap->pIMem ? tsdbGetTbDataFromMemTable(pr->pReadSnap->pIMem, pr->suid, uid) : NULL;
+  if ((pMem && pMem->pHead) || (pIMem && pIMem->pHead)) {
+    return NULL;
+  }
+
+  getTableCacheKey(uid, cacheType, key, &keyLen);
+
+  taosThreadRwlockRdlock(&pTsdb->cacheLock);
+  int64_t gen = pTsdb->cacheGen;
+  int32_t ret = tdbTbGet(pTsdb->pCacheDb, key, keyLen, &pVal, &vLen);
+  taosThreadRwlockUnlock(&pTsdb->cacheLock);
+  if (ret < 0) {
+    return NULL;
+  }
+
+  SDecoder decoder = {0};
+  tDecoderInit(&decoder, pVal, vLen);
+  ret = tDecodeLastCols(&decoder, gen, &pLast);
+  tDecoderClear(&decoder);
+  tdbFree(pVal);
+
+  if (ret < 0 || pLast == NULL) {
+    return NULL;
+  }
+
+  if (!tsdbCacheColsMatch(pLast, pr->pSchema)) {
+    deleteTableCacheLast(NULL, 0, pLast);
+    return NULL;
+  }
+
+  if (pMem == NULL && pIMem == NULL) {
+    return pLast;
+  }
+
+  int32_t code = 0;
+  if (cacheType == 0) {
+    bool dup = false;
+    code = mergeLastRow(uid, pTsdb, &dup, &pMemLast, pr, true);
+  } else {
+    code = mergeLast(uid, pTsdb, &pMemLast, pr, true);
+  }
+
+  if (code != TSDB_CODE_SUCCESS || pMemLast == NULL) {
+    deleteTableCacheLast(NULL, 0, pLast);
+    return NULL;
+  }
+
+  return tsdbCacheMergeMemLast(pLast, pMemLast, cacheType);
+}
+
 int32_t tsdbCacheGetLastrowH(SLRUCache *pCache, tb_uid_t uid, SCacheRowsReader *pr, LRUHandle **handle) {
   int32_t code = 0;
   char    key[32] = {0};
@@ -1582,7 +2293,10 @@ int32_t tsdbCacheGetLastrowH(SLRUCache *pCache, tb_uid_t uid, SCacheRowsReader *
     if (!h) {
       SArray *pArray = NULL;
       bool    dup = false;  // which is always false for now
-      code = mergeLastRow(uid, pTsdb, &dup, &pArray, pr);
+      pArray = tsdbCacheLoadFromStore(pTsdb, uid, 0, pr);
+      if (pArray == NULL) {
+        code = mergeLastRow(uid, pTsdb, &dup, &pArray, pr, false);
+      }
       // if table's empty or error, set handle NULL and return
       if (code < 0 /* || pArray == NULL*/) {
         if (!dup && pArray) {
@@ -1625,8 +2339,10 @@ int32_t tsdbCacheGetLastH(SLRUCache *pCache, tb_uid_t uid, SCacheRowsReader *pr,
 
     h = taosLRUCacheLookup(pCache, key, keyLen);
     if (!h) {
-      SArray *pLastArray = NULL;
-      code = mergeLast(uid, pTsdb, &pLastArray, pr);
+      SArray *pLastArray = tsdbCacheLoadFromStore(pTsdb, uid, 1, pr);
+      if (pLastArray == NULL) {
+        code = mergeLast(uid, pTsdb, &pLastArray, pr, false);
+      }
       // if table's empty or error, set handle NULL and return
       if (code < 0 /* || pLastArray == NULL*/) {
         taosThreadMutexUnlock(&pTsdb->lruMutex);
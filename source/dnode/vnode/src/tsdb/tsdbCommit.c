@@ -190,6 +190,9 @@ int32_t tsdbCommit(STsdb *pTsdb, SCommitInfo *pInfo) {
   code = tsdbCommitDel(&commith);
   TSDB_CHECK_CODE(code, lino, _exit);
 
+  code = tsdbCommitCache(&commith);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
   // end commit
   code = tsdbEndCommit(&commith, 0);
   TSDB_CHECK_CODE(code, lino, _exit);
@@ -1055,6 +1058,10 @@ _exit:
   return code;
 }
 
+static int32_t tsdbCommitCache(SCommitter *pCommitter) {
+  return tsdbCacheCommit(pCommitter->pTsdb, pCommitter->aTbDataP);
+}
+
 static int32_t tsdbEndCommit(SCommitter *pCommitter, int32_t eno) {
   int32_t code = 0;
   int32_t lino = 0;
@@ -435,6 +435,62 @@ int32_t tsdbDataIterNext2(STsdbDataIter2* pIter, STsdbFilterInfo* pFilterInfo) {
   }
 }
 
+/* block */
+// Move a data file iter, whose loaded block is consumed, to the next block passing the filter without loading it.
+// The block is then loaded by tsdbDataIterNext2 or skipped by tsdbDataIterSkipBlock. pDataBlk->nRow is 0 if no
+// block is left.
+int32_t tsdbDataIterPeekBlock(STsdbDataIter2* pIter, STsdbFilterInfo* pFilterInfo, SDataBlk* pDataBlk) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  ASSERT(pIter->type == TSDB_DATA_FILE_DATA_ITER);
+  ASSERT(pIter->dIter.iRow >= pIter->dIter.bData.nRow);
+  ASSERT(pFilterInfo == NULL || (pFilterInfo->flag & TSDB_FILTER_FLAG_BY_TABLEID) == 0);
+
+  pDataBlk->nRow = 0;
+
+  for (;;) {
+    while (pIter->dIter.iDataBlk < pIter->dIter.mDataBlk.nItem) {
+      tMapDataGetItemByIdx(&pIter->dIter.mDataBlk, pIter->dIter.iDataBlk, pDataBlk, tGetDataBlk);
+
+      if (pFilterInfo && (pFilterInfo->flag & TSDB_FILTER_FLAG_BY_VERSION)) {
+        if (pFilterInfo->sver > pDataBlk->maxVer || pFilterInfo->ever < pDataBlk->minVer) {
+          pDataBlk->nRow = 0;
+          pIter->dIter.iDataBlk++;
+          continue;
+        }
+      }
+
+      goto _exit;
+    }
+
+    if (pIter->dIter.iBlockIdx >= taosArrayGetSize(pIter->dIter.aBlockIdx)) goto _exit;
+
+    SBlockIdx* pBlockIdx = taosArrayGet(pIter->dIter.aBlockIdx, pIter->dIter.iBlockIdx);
+
+    code = tsdbReadDataBlk(pIter->dIter.pReader, pBlockIdx, &pIter->dIter.mDataBlk);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    pIter->rowInfo.suid = pBlockIdx->suid;
+    pIter->rowInfo.uid = pBlockIdx->uid;
+
+    pIter->dIter.iBlockIdx++;
+    pIter->dIter.iDataBlk = 0;
+  }
+
+_exit:
+  if (code) {
+    tsdbError("%s failed at line %d since %s", __func__, lino, tstrerror(code));
+  }
+  return code;
+}
+
+void tsdbDataIterSkipBlock(STsdbDataIter2* pIter) {
+  ASSERT(pIter->type == TSDB_DATA_FILE_DATA_ITER);
+  ASSERT(pIter->dIter.iDataBlk < pIter->dIter.mDataBlk.nItem);
+  pIter->dIter.iDataBlk++;
+}
+
 /* get */
 
 // STsdbFSetIter
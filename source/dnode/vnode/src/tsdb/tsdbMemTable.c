@@ -36,6 +36,8 @@ static int32_t tsdbInsertRowDataToTable(SMemTable *pMemTable, STbData *pTbData,
                                         SSubmitTbData *pSubmitTbData, int32_t *affectedRows);
 static int32_t tsdbInsertColDataToTable(SMemTable *pMemTable, STbData *pTbData, int64_t version,
                                         SSubmitTbData *pSubmitTbData, int32_t *affectedRows);
+static void    tbDataMoveRunTo(STbData *pTbData, TSDBKEY *pKey, int8_t backward, SMemAppendRun **ppRun,
+                               int32_t *piRow);
 
 int32_t tsdbMemTableCreate(STsdb *pTsdb, SMemTable **ppMemTable) {
   int32_t    code = 0;
@@ -93,6 +95,25 @@ static FORCE_INLINE STbData *tsdbGetTbDataFromMemTableImpl(SMemTable *pMemTable,
   return pTbData;
 }
 
+// memtable stats may be updated by several apply threads at the same time
+static FORCE_INLINE void tsdbMemTableSetMin(int64_t volatile *ptr, int64_t val) {
+  int64_t old = atomic_load_64(ptr);
+  while (val < old) {
+    int64_t cur = atomic_val_compare_exchange_64(ptr, old, val);
+    if (cur == old) break;
+    old = cur;
+  }
+}
+
+static FORCE_INLINE void tsdbMemTableSetMax(int64_t volatile *ptr, int64_t val) {
+  int64_t old = atomic_load_64(ptr);
+  while (val > old) {
+    int64_t cur = atomic_val_compare_exchange_64(ptr, old, val);
+    if (cur == old) break;
+    old = cur;
+  }
+}
+
 STbData *tsdbGetTbDataFromMemTable(SMemTable *pMemTable, tb_uid_t suid, tb_uid_t uid) {
   STbData *pTbData;
 
@@ -125,8 +146,8 @@ int32_t tsdbInsertTableData(STsdb *pTsdb, int64_t version, SSubmitTbData *pSubmi
   if (code) goto _err;
 
   // update
-  pMemTable->minVer = TMIN(pMemTable->minVer, version);
-  pMemTable->maxVer = TMAX(pMemTable->maxVer, version);
+  tsdbMemTableSetMin(&pMemTable->minVer, version);
+  tsdbMemTableSetMax(&pMemTable->maxVer, version);
 
   return code;
 
@@ -234,12 +255,17 @@ void tsdbTbDataIterOpen(STbData *pTbData, TSDBKEY *pFrom, int8_t backward, STbDa
   pIter->pTbData = pTbData;
   pIter->backward = backward;
   pIter->pRow = NULL;
+  pIter->fromRun = 0;
   if (pFrom == NULL) {
     // create from head or tail
     if (backward) {
       pIter->pNode = SL_GET_NODE_BACKWARD(pTbData->sl.pTail, 0);
+      pIter->pRun = (SMemAppendRun *)atomic_load_ptr(&pTbData->al.pTail);
+      pIter->iRun = pIter->pRun ? pIter->pRun->nRow - 1 : 0;
     } else {
       pIter->pNode = SL_GET_NODE_FORWARD(pTbData->sl.pHead, 0);
+      pIter->pRun = (SMemAppendRun *)atomic_load_ptr(&pTbData->al.pHead);
+      pIter->iRun = 0;
     }
   } else {
     // create from a key
@@ -250,36 +276,37 @@ void tsdbTbDataIterOpen(STbData *pTbData, TSDBKEY *pFrom, int8_t backward, STbDa
       tbDataMovePosTo(pTbData, pos, pFrom, 0);
       pIter->pNode = SL_GET_NODE_FORWARD(pos[0], 0);
     }
+    tbDataMoveRunTo(pTbData, pFrom, backward, &pIter->pRun, &pIter->iRun);
   }
 }
 
 bool tsdbTbDataIterNext(STbDataIter *pIter) {
-  pIter->pRow = NULL;
-  if (pIter->backward) {
-    ASSERT(pIter->pNode != pIter->pTbData->sl.pTail);
+  // make sure the source of the current row is known
+  if (tsdbTbDataIterGet(pIter) == NULL) {
+    return false;
+  }
 
-    if (pIter->pNode == pIter->pTbData->sl.pHead) {
-      return false;
+  pIter->pRow = NULL;
+  if (pIter->fromRun) {
+    SMemAppendRun *pRun = pIter->pRun;
+    if (pIter->backward) {
+      if (--pIter->iRun < 0) {
+        pIter->pRun = pRun->pPrev;
+        pIter->iRun = pIter->pRun ? pIter->pRun->nRow - 1 : 0;
+      }
+    } else {
+      if (++pIter->iRun >= pRun->nRow) {
+        pIter->pRun = (SMemAppendRun *)atomic_load_ptr(&pRun->pNext);
+        pIter->iRun = 0;
+      }
     }
-
+  } else if (pIter->backward) {
     pIter->pNode = SL_GET_NODE_BACKWARD(pIter->pNode, 0);
-    if (pIter->pNode == pIter->pTbData->sl.pHead) {
-      return false;
-    }
   } else {
-    ASSERT(pIter->pNode != pIter->pTbData->sl.pHead);
-
-    if (pIter->pNode == pIter->pTbData->sl.pTail) {
-      return false;
-    }
-
     pIter->pNode = SL_GET_NODE_FORWARD(pIter->pNode, 0);
-    if (pIter->pNode == pIter->pTbData->sl.pTail) {
-      return false;
-    }
   }
 
-  return true;
+  return tsdbTbDataIterGet(pIter) != NULL;
 }
 
 static int32_t tsdbMemTableRehash(SMemTable *pMemTable) {
@@ -317,8 +344,8 @@ _exit:
 static int32_t tsdbGetOrCreateTbData(SMemTable *pMemTable, tb_uid_t suid, tb_uid_t uid, STbData **ppTbData) {
   int32_t code = 0;
 
-  // get
-  STbData *pTbData = tsdbGetTbDataFromMemTableImpl(pMemTable, suid, uid);
+  // get, latched since another apply thread may be rehashing the buckets
+  STbData *pTbData = tsdbGetTbDataFromMemTable(pMemTable, suid, uid);
   if (pTbData) goto _exit;
 
   // create
@@ -343,6 +370,9 @@ static int32_t tsdbGetOrCreateTbData(SMemTable *pMemTable, tb_uid_t suid, tb_uid
   pTbData->sl.level = 0;
   pTbData->sl.pHead = (SMemSkipListNode *)&pTbData[1];
   pTbData->sl.pTail = (SMemSkipListNode *)POINTER_SHIFT(pTbData->sl.pHead, SL_NODE_SIZE(maxLevel));
+  pTbData->al.size = 0;
+  pTbData->al.pHead = NULL;
+  pTbData->al.pTail = NULL;
   pTbData->sl.pHead->level = maxLevel;
   pTbData->sl.pTail->level = maxLevel;
   for (int8_t iLevel = 0; iLevel < maxLevel; iLevel++) {
@@ -459,6 +489,145 @@ static void tbDataMovePosTo(STbData *pTbData, SMemSkipListNode **pos, TSDBKEY *p
   }
 }
 
+static FORCE_INLINE TSDBKEY tbDataRunKey(SMemAppendRun *pRun, int32_t iRow) {
+  TSDBROW row = tsdbMemAppendRunGetRow(pRun, iRow);
+  return TSDBROW_KEY(&row);
+}
+
+static void tbDataMoveRunTo(STbData *pTbData, TSDBKEY *pKey, int8_t backward, SMemAppendRun **ppRun,
+                            int32_t *piRow) {
+  SMemAppendRun *pRun;
+  TSDBKEY        tKey;
+
+  if (backward) {
+    // the last row not greater than pKey
+    for (pRun = (SMemAppendRun *)atomic_load_ptr(&pTbData->al.pTail); pRun; pRun = pRun->pPrev) {
+      tKey = tbDataRunKey(pRun, 0);
+      if (tsdbKeyCmprFn(&tKey, pKey) > 0) continue;
+
+      int32_t lidx = 0, ridx = pRun->nRow - 1;
+      while (lidx < ridx) {
+        int32_t midx = (lidx + ridx + 1) >> 1;
+        tKey = tbDataRunKey(pRun, midx);
+        if (tsdbKeyCmprFn(&tKey, pKey) <= 0) {
+          lidx = midx;
+        } else {
+          ridx = midx - 1;
+        }
+      }
+
+      *ppRun = pRun;
+      *piRow = lidx;
+      return;
+    }
+  } else {
+    // the first row not less than pKey
+    for (pRun = (SMemAppendRun *)atomic_load_ptr(&pTbData->al.pHead); pRun;
+         pRun = (SMemAppendRun *)atomic_load_ptr(&pRun->pNext)) {
+      tKey = tbDataRunKey(pRun, pRun->nRow - 1);
+      if (tsdbKeyCmprFn(&tKey, pKey) < 0) continue;
+
+      int32_t lidx = 0, ridx = pRun->nRow - 1;
+      while (lidx < ridx) {
+        int32_t midx = (lidx + ridx) >> 1;
+        tKey = tbDataRunKey(pRun, midx);
+        if (tsdbKeyCmprFn(&tKey, pKey) >= 0) {
+          ridx = midx;
+        } else {
+          lidx = midx + 1;
+        }
+      }
+
+      *ppRun = pRun;
+      *piRow = lidx;
+      return;
+    }
+  }
+
+  *ppRun = NULL;
+  *piRow = 0;
+}
+
+// the largest timestamp in the skiplist and the append list, TSKEY_MIN if the table is empty
+static TSKEY tbDataGetLastTs(STbData *pTbData) {
+  TSKEY             ts = TSKEY_MIN;
+  SMemSkipListNode *pNode = SL_GET_NODE_BACKWARD(pTbData->sl.pTail, 0);
+
+  if (pNode != pTbData->sl.pHead) {
+    if (pNode->flag == TSDBROW_ROW_FMT) {
+      ts = ((SRow *)pNode->pData)->ts;
+    } else {
+      ts = ((SBlockData *)pNode->pData)->aTSKEY[pNode->iRow];
+    }
+  }
+
+  if (pTbData->al.pTail) {
+    TSDBKEY key = tbDataRunKey(pTbData->al.pTail, pTbData->al.pTail->nRow - 1);
+    ts = TMAX(ts, key.ts);
+  }
+
+  return ts;
+}
+
+static void tbDataPutRun(STbData *pTbData, SMemAppendRun *pRun) {
+  pRun->pPrev = pTbData->al.pTail;
+  pRun->pNext = NULL;
+
+  // the run is complete before readers can reach it
+  if (pTbData->al.pTail) {
+    atomic_store_ptr(&pTbData->al.pTail->pNext, pRun);
+  } else {
+    atomic_store_ptr(&pTbData->al.pHead, pRun);
+  }
+  atomic_store_ptr(&pTbData->al.pTail, pRun);
+  pTbData->al.size += pRun->nRow;
+}
+
+static int32_t tbDataAppendBlock(SMemTable *pMemTable, STbData *pTbData, int64_t version, SBlockData *pBlockData) {
+  SVBufPool     *pPool = pMemTable->pTsdb->pVnode->inUse;
+  SMemAppendRun *pRun = (SMemAppendRun *)vnodeBufPoolMallocAligned(pPool, sizeof(*pRun));
+  if (pRun == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pRun->flag = TSDBROW_COL_FMT;
+  pRun->nRow = pBlockData->nRow;
+  pRun->version = version;
+  pRun->pData = pBlockData;
+  tbDataPutRun(pTbData, pRun);
+  return 0;
+}
+
+static int32_t tbDataAppendRows(SMemTable *pMemTable, STbData *pTbData, int64_t version, SRow **aRow, int32_t nRow) {
+  SVBufPool *pPool = pMemTable->pTsdb->pVnode->inUse;
+  int64_t    nSize = sizeof(SMemAppendRun) + sizeof(SRow *) * nRow;
+
+  for (int32_t iRow = 0; iRow < nRow; iRow++) {
+    nSize += ALIGN8(aRow[iRow]->len);
+  }
+
+  // run header, row pointers and row bodies share one allocation
+  SMemAppendRun *pRun = (SMemAppendRun *)vnodeBufPoolMallocAligned(pPool, nSize);
+  if (pRun == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  SRow  **aRunRow = (SRow **)&pRun[1];
+  uint8_t *p = (uint8_t *)&aRunRow[nRow];
+  for (int32_t iRow = 0; iRow < nRow; iRow++) {
+    aRunRow[iRow] = (SRow *)p;
+    memcpy(p, aRow[iRow], aRow[iRow]->len);
+    p += ALIGN8(aRow[iRow]->len);
+  }
+
+  pRun->flag = TSDBROW_ROW_FMT;
+  pRun->nRow = nRow;
+  pRun->version = version;
+  pRun->pData = aRunRow;
+  tbDataPutRun(pTbData, pRun);
+  return 0;
+}
+
 static FORCE_INLINE int8_t tsdbMemSkipListRandLevel(SMemSkipList *pSl) {
   int8_t level = 1;
   int8_t tlevel = TMIN(pSl->maxLevel, pSl->level + 1);
@@ -599,36 +768,49 @@ static int32_t tsdbInsertColDataToTable(SMemTable *pMemTable, STbData *pTbData,
     if (code) goto _exit;
   }
 
-  // loop to add each row to the skiplist
   SMemSkipListNode *pos[SL_MAX_LEVEL];
   TSDBROW           tRow = tsdbRowFromBlockData(pBlockData, 0);
   TSDBKEY           key = {.version = version, .ts = pBlockData->aTSKEY[0]};
   TSDBROW           lRow;  // last row
 
-  // first row
-  tbDataMovePosTo(pTbData, pos, &key, SL_MOVE_BACKWARD);
-  if ((code = tbDataDoPut(pMemTable, pTbData, pos, &tRow, 0))) goto _exit;
-  pTbData->minKey = TMIN(pTbData->minKey, key.ts);
-  lRow = tRow;
-
-  // remain row
-  ++tRow.iRow;
-  if (tRow.iRow < pBlockData->nRow) {
-    for (int8_t iLevel = pos[0]->level; iLevel < pTbData->sl.maxLevel; iLevel++) {
-      pos[iLevel] = SL_NODE_BACKWARD(pos[iLevel], iLevel);
-    }
-
-    while (tRow.iRow < pBlockData->nRow) {
-      key.ts = pBlockData->aTSKEY[tRow.iRow];
+  // a strictly increasing block after all existing keys is appended as a whole
+  bool append = (key.ts > tbDataGetLastTs(pTbData));
+  for (int32_t iRow = 1; append && iRow < pBlockData->nRow; iRow++) {
+    append = (pBlockData->aTSKEY[iRow] > pBlockData->aTSKEY[iRow - 1]);
+  }
 
-      if (SL_NODE_FORWARD(pos[0], 0) != pTbData->sl.pTail) {
-        tbDataMovePosTo(pTbData, pos, &key, SL_MOVE_FROM_POS);
+  if (append) {
+    if ((code = tbDataAppendBlock(pMemTable, pTbData, version, pBlockData))) goto _exit;
+    pTbData->minKey = TMIN(pTbData->minKey, key.ts);
+    key.ts = pBlockData->aTSKEY[pBlockData->nRow - 1];
+    lRow = tsdbRowFromBlockData(pBlockData, pBlockData->nRow - 1);
+  } else {
+    // loop to add each row to the skiplist
+    // first row
+    tbDataMovePosTo(pTbData, pos, &key, SL_MOVE_BACKWARD);
+    if ((code = tbDataDoPut(pMemTable, pTbData, pos, &tRow, 0))) goto _exit;
+    pTbData->minKey = TMIN(pTbData->minKey, key.ts);
+    lRow = tRow;
+
+    // remain row
+    ++tRow.iRow;
+    if (tRow.iRow < pBlockData->nRow) {
+      for (int8_t iLevel = pos[0]->level; iLevel < pTbData->sl.maxLevel; iLevel++) {
+        pos[iLevel] = SL_NODE_BACKWARD(pos[iLevel], iLevel);
       }
 
-      if ((code = tbDataDoPut(pMemTable, pTbData, pos, &tRow, 1))) goto _exit;
-      lRow = tRow;
+      while (tRow.iRow < pBlockData->nRow) {
+        key.ts = pBlockData->aTSKEY[tRow.iRow];
+
+        if (SL_NODE_FORWARD(pos[0], 0) != pTbData->sl.pTail) {
+          tbDataMovePosTo(pTbData, pos, &key, SL_MOVE_FROM_POS);
+        }
+
+        if ((code = tbDataDoPut(pMemTable, pTbData, pos, &tRow, 1))) goto _exit;
+        lRow = tRow;
 
-      ++tRow.iRow;
+        ++tRow.iRow;
+      }
     }
   }
 
@@ -645,9 +827,9 @@ static int32_t tsdbInsertColDataToTable(SMemTable *pMemTable, STbData *pTbData,
   }
 
   // SMemTable
-  pMemTable->minKey = TMIN(pMemTable->minKey, pTbData->minKey);
-  pMemTable->maxKey = TMAX(pMemTable->maxKey, pTbData->maxKey);
-  pMemTable->nRow += pBlockData->nRow;
+  tsdbMemTableSetMin(&pMemTable->minKey, pTbData->minKey);
+  tsdbMemTableSetMax(&pMemTable->maxKey, pTbData->maxKey);
+  atomic_add_fetch_64(&pMemTable->nRow, pBlockData->nRow);
 
   if (affectedRows) *affectedRows = pBlockData->nRow;
 
@@ -667,36 +849,51 @@ static int32_t tsdbInsertRowDataToTable(SMemTable *pMemTable, STbData *pTbData,
   int32_t           iRow = 0;
   TSDBROW           lRow;
 
-  // backward put first data
-  tRow.pTSRow = aRow[iRow++];
-  key.ts = tRow.pTSRow->ts;
-  tbDataMovePosTo(pTbData, pos, &key, SL_MOVE_BACKWARD);
-  code = tbDataDoPut(pMemTable, pTbData, pos, &tRow, 0);
-  if (code) goto _exit;
-  lRow = tRow;
+  // strictly increasing rows after all existing keys are appended as one run
+  bool append = (aRow[0]->ts > tbDataGetLastTs(pTbData));
+  for (int32_t i = 1; append && i < nRow; i++) {
+    append = (aRow[i]->ts > aRow[i - 1]->ts);
+  }
 
-  pTbData->minKey = TMIN(pTbData->minKey, key.ts);
+  if (append) {
+    code = tbDataAppendRows(pMemTable, pTbData, version, aRow, nRow);
+    if (code) goto _exit;
 
-  // forward put rest data
-  if (iRow < nRow) {
-    for (int8_t iLevel = pos[0]->level; iLevel < pTbData->sl.maxLevel; iLevel++) {
-      pos[iLevel] = SL_NODE_BACKWARD(pos[iLevel], iLevel);
-    }
+    pTbData->minKey = TMIN(pTbData->minKey, aRow[0]->ts);
+    key.ts = aRow[nRow - 1]->ts;
+    lRow = tsdbMemAppendRunGetRow(pTbData->al.pTail, nRow - 1);
+  } else {
+    // backward put first data
+    tRow.pTSRow = aRow[iRow++];
+    key.ts = tRow.pTSRow->ts;
+    tbDataMovePosTo(pTbData, pos, &key, SL_MOVE_BACKWARD);
+    code = tbDataDoPut(pMemTable, pTbData, pos, &tRow, 0);
+    if (code) goto _exit;
+    lRow = tRow;
 
-    while (iRow < nRow) {
-      tRow.pTSRow = aRow[iRow];
-      key.ts = tRow.pTSRow->ts;
+    pTbData->minKey = TMIN(pTbData->minKey, key.ts);
 
-      if (SL_NODE_FORWARD(pos[0], 0) != pTbData->sl.pTail) {
-        tbDataMovePosTo(pTbData, pos, &key, SL_MOVE_FROM_POS);
+    // forward put rest data
+    if (iRow < nRow) {
+      for (int8_t iLevel = pos[0]->level; iLevel < pTbData->sl.maxLevel; iLevel++) {
+        pos[iLevel] = SL_NODE_BACKWARD(pos[iLevel], iLevel);
       }
 
-      code = tbDataDoPut(pMemTable, pTbData, pos, &tRow, 1);
-      if (code) goto _exit;
+      while (iRow < nRow) {
+        tRow.pTSRow = aRow[iRow];
+        key.ts = tRow.pTSRow->ts;
+
+        if (SL_NODE_FORWARD(pos[0], 0) != pTbData->sl.pTail) {
+          tbDataMovePosTo(pTbData, pos, &key, SL_MOVE_FROM_POS);
+        }
 
-      lRow = tRow;
+        code = tbDataDoPut(pMemTable, pTbData, pos, &tRow, 1);
+        if (code) goto _exit;
 
-      iRow++;
+        lRow = tRow;
+
+        iRow++;
+      }
     }
   }
 
@@ -713,9 +910,9 @@ static int32_t tsdbInsertRowDataToTable(SMemTable *pMemTable, STbData *pTbData,
   }
 
   // SMemTable
-  pMemTable->minKey = TMIN(pMemTable->minKey, pTbData->minKey);
-  pMemTable->maxKey = TMAX(pMemTable->maxKey, pTbData->maxKey);
-  pMemTable->nRow += nRow;
+  tsdbMemTableSetMin(&pMemTable->minKey, pTbData->minKey);
+  tsdbMemTableSetMax(&pMemTable->maxKey, pTbData->maxKey);
+  atomic_add_fetch_64(&pMemTable->nRow, nRow);
 
   if (affectedRows) *affectedRows = nRow;
 
@@ -723,7 +920,7 @@ _exit:
   return code;
 }
 
-int32_t tsdbGetNRowsInTbData(STbData *pTbData) { return pTbData->sl.size; }
+int32_t tsdbGetNRowsInTbData(STbData *pTbData) { return pTbData->sl.size + pTbData->al.size; }
 
 int32_t tsdbRefMemTable(SMemTable *pMemTable, SQueryNode *pQNode) {
   int32_t code = 0;
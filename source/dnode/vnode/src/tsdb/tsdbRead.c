@@ -3877,11 +3877,203 @@ int32_t doAppendRowFromFileBlock(SSDataBlock* pResBlock, STsdbReader* pReader, S
   return TSDB_CODE_SUCCESS;
 }
 
+#define MEM_BATCH_ROWS 256
+
+// consecutive in-memory rows that share the same layout: one schema version, or one block data
+typedef struct SMemRowBatch {
+  int8_t      type;
+  int32_t     sver;
+  SBlockData* pBlockData;
+  int32_t     nRow;
+  SRow*       aRow[MEM_BATCH_ROWS];
+  int32_t     aIdx[MEM_BATCH_ROWS];
+} SMemRowBatch;
+
+static int32_t doAppendRowsFromMemBatch(SSDataBlock* pBlock, STsdbReader* pReader, SMemRowBatch* pBatch,
+                                        STableBlockScanInfo* pScanInfo) {
+  SBlockLoadSuppInfo* pSupInfo = &pReader->suppInfo;
+  int32_t             outputRowIndex = pBlock->info.rows;
+  int32_t             nRow = pBatch->nRow;
+  SColVal             cv = {0};
+  int32_t             i = 0, j = 0;
+
+  if (nRow == 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  if (pBatch->type == TSDBROW_ROW_FMT) {
+    STSchema* pSchema = doGetSchemaForTSRow(pBatch->sver, pReader, pScanInfo->uid);
+    if (pSchema == NULL) {
+      return terrno;
+    }
+
+    if (pSupInfo->colId[i] == PRIMARYKEY_TIMESTAMP_COL_ID) {
+      SColumnInfoData* pColData = taosArrayGet(pBlock->pDataBlock, pSupInfo->slotId[i]);
+      for (int32_t k = 0; k < nRow; ++k) {
+        ((int64_t*)pColData->pData)[outputRowIndex + k] = pBatch->aRow[k]->ts;
+      }
+      i += 1;
+    }
+
+    // decode column by column, the column matching is done once for the whole batch
+    while (i < pSupInfo->numOfCols && j < pSchema->numOfCols) {
+      col_id_t         colId = pSupInfo->colId[i];
+      SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, pSupInfo->slotId[i]);
+
+      if (colId == pSchema->columns[j].colId) {
+        for (int32_t k = 0; k < nRow; ++k) {
+          tRowGet(pBatch->aRow[k], pSchema, j, &cv);
+          doCopyColVal(pColInfoData, outputRowIndex + k, i, &cv, pSupInfo);
+        }
+        i += 1;
+        j += 1;
+      } else if (colId < pSchema->columns[j].colId) {
+        colDataSetNNULL(pColInfoData, outputRowIndex, nRow);
+        i += 1;
+      } else {
+        j += 1;
+      }
+    }
+
+    pScanInfo->lastKey = pBatch->aRow[nRow - 1]->ts;
+  } else {
+    SBlockData* pBlockData = pBatch->pBlockData;
+    bool        contiguous = (pBatch->aIdx[nRow - 1] - pBatch->aIdx[0] == nRow - 1);
+
+    if (pSupInfo->colId[i] == PRIMARYKEY_TIMESTAMP_COL_ID) {
+      SColumnInfoData* pColData = taosArrayGet(pBlock->pDataBlock, pSupInfo->slotId[i]);
+      for (int32_t k = 0; k < nRow; ++k) {
+        ((int64_t*)pColData->pData)[outputRowIndex + k] = pBlockData->aTSKEY[pBatch->aIdx[k]];
+      }
+      i += 1;
+    }
+
+    int32_t numOfInputCols = pBlockData->nColData;
+    while (i < pSupInfo->numOfCols && j < numOfInputCols) {
+      SColData* pData = tBlockDataGetColDataByIdx(pBlockData, j);
+      if (pData->cid < pSupInfo->colId[i]) {
+        j += 1;
+        continue;
+      }
+
+      SColumnInfoData* pCol = TARRAY_GET_ELEM(pBlock->pDataBlock, pSupInfo->slotId[i]);
+      if (pData->cid == pSupInfo->colId[i]) {
+        int32_t bytes = tDataTypes[pData->type].bytes;
+        if (contiguous && pData->flag == HAS_VALUE && !IS_VAR_DATA_TYPE(pData->type) && pCol->info.bytes == bytes) {
+          // ascending rows without null of a fixed-length column are copied as a whole
+          memcpy(pCol->pData + (int64_t)outputRowIndex * bytes, pData->pData + (int64_t)pBatch->aIdx[0] * bytes,
+                 (int64_t)nRow * bytes);
+        } else {
+          for (int32_t k = 0; k < nRow; ++k) {
+            tColDataGetValue(pData, pBatch->aIdx[k], &cv);
+            doCopyColVal(pCol, outputRowIndex + k, i, &cv, pSupInfo);
+          }
+        }
+        j += 1;
+      } else {
+        colDataSetNNULL(pCol, outputRowIndex, nRow);
+      }
+
+      i += 1;
+    }
+
+    pScanInfo->lastKey = pBlockData->aTSKEY[pBatch->aIdx[nRow - 1]];
+  }
+
+  // set null value since current column does not exist in the data
+  while (i < pSupInfo->numOfCols) {
+    SColumnInfoData* pColInfoData = taosArrayGet(pBlock->pDataBlock, pSupInfo->slotId[i]);
+    colDataSetNNULL(pColInfoData, outputRowIndex, nRow);
+    i += 1;
+  }
+
+  pBlock->info.dataLoad = 1;
+  pBlock->info.rows += nRow;
+  pBatch->nRow = 0;
+  return TSDB_CODE_SUCCESS;
+}
+
+// dump rows of one in-memory source in batches, stop at the first timestamp that needs to be merged
+static int32_t doBuildBlockFromMemBatch(STableBlockScanInfo* pScanInfo, SIterInfo* pIter, int64_t endKey,
+                                        int32_t capacity, STsdbReader* pReader) {
+  SSDataBlock* pBlock = pReader->pResBlock;
+  bool         asc = ASCENDING_TRAVERSE(pReader->order);
+  int32_t      code = TSDB_CODE_SUCCESS;
+  SMemRowBatch batch;
+
+  batch.type = -1;
+  batch.nRow = 0;
+
+  while (pBlock->info.rows + batch.nRow < capacity) {
+    TSDBROW* pRow = getValidMemRow(pIter, pScanInfo->delSkyline, pReader);
+    if (pRow == NULL) {
+      break;
+    }
+
+    TSKEY ts = TSDBROW_TS(pRow);
+    if ((asc && ts >= endKey) || (!asc && ts <= endKey)) {
+      break;
+    }
+
+    // a duplicated timestamp is left to the merge path
+    STbDataIter next = *pIter->iter;
+    if (tsdbTbDataIterNext(&next) && TSDBROW_TS(tsdbTbDataIterGet(&next)) == ts) {
+      break;
+    }
+
+    bool sameLayout = false;
+    if (batch.nRow > 0 && batch.type == pRow->type) {
+      sameLayout = (pRow->type == TSDBROW_ROW_FMT) ? (pRow->pTSRow->sver == batch.sver)
+                                                   : (pRow->pBlockData == batch.pBlockData);
+    }
+
+    if (!sameLayout || batch.nRow == MEM_BATCH_ROWS) {
+      code = doAppendRowsFromMemBatch(pBlock, pReader, &batch, pScanInfo);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+
+      batch.type = pRow->type;
+      if (pRow->type == TSDBROW_ROW_FMT) {
+        batch.sver = pRow->pTSRow->sver;
+      } else {
+        batch.pBlockData = pRow->pBlockData;
+      }
+    }
+
+    if (pRow->type == TSDBROW_ROW_FMT) {
+      batch.aRow[batch.nRow] = pRow->pTSRow;
+    } else {
+      batch.aIdx[batch.nRow] = pRow->iRow;
+    }
+    batch.nRow += 1;
+
+    pIter->hasVal = tsdbTbDataIterNext(pIter->iter);
+  }
+
+  return doAppendRowsFromMemBatch(pBlock, pReader, &batch, pScanInfo);
+}
+
 int32_t buildDataBlockFromBufImpl(STableBlockScanInfo* pBlockScanInfo, int64_t endKey, int32_t capacity,
                                   STsdbReader* pReader) {
   SSDataBlock* pBlock = pReader->pResBlock;
 
+  // without deletes, rows of a single in-memory source can be decoded in batches
+  bool batchScan = (taosArrayGetSize(pBlockScanInfo->delSkyline) == 0);
+
   do {
+    if (batchScan && (pBlockScanInfo->iter.hasVal != pBlockScanInfo->iiter.hasVal)) {
+      SIterInfo* pIter = pBlockScanInfo->iter.hasVal ? &pBlockScanInfo->iter : &pBlockScanInfo->iiter;
+      int32_t    code = doBuildBlockFromMemBatch(pBlockScanInfo, pIter, endKey, capacity, pReader);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+
+      if (!(pBlockScanInfo->iter.hasVal || pBlockScanInfo->iiter.hasVal) || pBlock->info.rows >= capacity) {
+        break;
+      }
+    }
+
     //    SRow* pTSRow = NULL;
     TSDBROW row = {.type = -1};
     bool    freeTSRow = false;
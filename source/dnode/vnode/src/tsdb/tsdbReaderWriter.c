@@ -743,106 +743,242 @@ _exit:
   return code;
 }
 
-int32_t tsdbDFileSetCopy(STsdb *pTsdb, SDFileSet *pSetFrom, SDFileSet *pSetTo) {
+// write a data block as read by tsdbReadDataBlockRaw, the offsets in pDataBlk are updated to the new position
+int32_t tsdbWriteDataBlockRaw(SDataFWriter *pWriter, const uint8_t *pRaw, SDataBlk *pDataBlk) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  ASSERT(pDataBlk->nSubBlock == 1);
+
+  SBlockInfo *pBlkInfo = &pDataBlk->aSubBlock[0];
+  SSmaInfo   *pSmaInfo = &pDataBlk->smaInfo;
+
+  code = tsdbWriteFile(pWriter->pDataFD, pWriter->fData.size, pRaw, pBlkInfo->szBlock);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  pBlkInfo->offset = pWriter->fData.size;
+  pWriter->fData.size += pBlkInfo->szBlock;
+
+  if (pSmaInfo->size > 0) {
+    code = tsdbWriteFile(pWriter->pSmaFD, pWriter->fSma.size, pRaw + pBlkInfo->szBlock, pSmaInfo->size);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    pSmaInfo->offset = pWriter->fSma.size;
+    pWriter->fSma.size += pSmaInfo->size;
+  } else {
+    pSmaInfo->offset = 0;
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at %d since %s", TD_VID(pWriter->pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  return code;
+}
+
+// migration of file sets between tiers ====================================================
+typedef struct {
+  TdThreadMutex mutex;
+  int64_t       tokens;  // bytes allowed to be moved, negative if the bucket is in debt
+  int64_t       lastUs;
+} STsdbIOBucket;
+
+static STsdbIOBucket tsdbIOBucket = {0};
+static TdThreadOnce  tsdbIOBucketInit = PTHREAD_ONCE_INIT;
+
+static void tsdbIOBucketInitImpl(void) {
+  taosThreadMutexInit(&tsdbIOBucket.mutex, NULL);
+  tsdbIOBucket.lastUs = taosGetTimestampUs();
+}
+
+// a token bucket shared by the migrations of all the vnodes on the node, refilled at retentionSpeedLimitMB and
+// holding one second of budget at most
+static void tsdbIOBucketAcquire(int64_t bytes) {
+  int64_t rate = (int64_t)tsRetentionSpeedLimitMB * 1024 * 1024;
+  if (rate <= 0) return;
+
+  taosThreadOnce(&tsdbIOBucketInit, tsdbIOBucketInitImpl);
+
+  taosThreadMutexLock(&tsdbIOBucket.mutex);
+  int64_t now = taosGetTimestampUs();
+  int64_t elapsed = TMIN(TMAX(now - tsdbIOBucket.lastUs, 0), 1000000);
+  tsdbIOBucket.tokens = TMIN(tsdbIOBucket.tokens + elapsed * rate / 1000000, rate) - bytes;
+  tsdbIOBucket.lastUs = now;
+  int64_t waitUs = (tsdbIOBucket.tokens < 0) ? (-tsdbIOBucket.tokens * 1000000 / rate) : 0;
+  taosThreadMutexUnlock(&tsdbIOBucket.mutex);
+
+  // the debt is paid out of the lock, later callers see it and wait behind
+  if (waitUs > 0) {
+    taosMsleep((int32_t)TMAX(waitUs / 1000, 1));
+  }
+}
+
+// Copy the first size bytes of a file to the new disk. The part a previous interrupted migration left there is
+// reused, and the copy is verified against the checksum of the source before it is taken.
+int32_t tsdbMigrateFile(STsdb *pTsdb, const char *fNameFrom, const char *fNameTo, int64_t size, uint8_t *pBuf,
+                        int64_t *nMoved) {
   int32_t   code = 0;
-  int64_t   n;
-  int64_t   size;
+  int32_t   lino = 0;
+  TdFilePtr pInFD = NULL;
   TdFilePtr pOutFD = NULL;
-  TdFilePtr PInFD = NULL;
-  int32_t   szPage = pTsdb->pVnode->config.szPage;
-  char      fNameFrom[TSDB_FILENAME_LEN];
-  char      fNameTo[TSDB_FILENAME_LEN];
+  int64_t   start = 0;
+  uint32_t  cksumFrom = 0;
+  uint32_t  cksumTo = 0;
 
-  // head
-  tsdbHeadFileName(pTsdb, pSetFrom->diskId, pSetFrom->fid, pSetFrom->pHeadF, fNameFrom);
-  tsdbHeadFileName(pTsdb, pSetTo->diskId, pSetTo->fid, pSetTo->pHeadF, fNameTo);
-  pOutFD = taosCreateFile(fNameTo, TD_FILE_WRITE | TD_FILE_CREATE | TD_FILE_TRUNC);
-  if (pOutFD == NULL) {
+  pInFD = taosOpenFile(fNameFrom, TD_FILE_READ);
+  if (pInFD == NULL) {
     code = TAOS_SYSTEM_ERROR(errno);
-    goto _err;
+    TSDB_CHECK_CODE(code, lino, _exit);
   }
-  PInFD = taosOpenFile(fNameFrom, TD_FILE_READ);
-  if (PInFD == NULL) {
+
+  pOutFD = taosCreateFile(fNameTo, TD_FILE_READ | TD_FILE_WRITE | TD_FILE_CREATE);
+  if (pOutFD == NULL) {
     code = TAOS_SYSTEM_ERROR(errno);
-    goto _err;
+    TSDB_CHECK_CODE(code, lino, _exit);
   }
-  n = taosFSendFile(pOutFD, PInFD, 0, tsdbLogicToFileSize(pSetFrom->pHeadF->size, szPage));
-  if (n < 0) {
+
+  if (taosFStatFile(pOutFD, &start, NULL) < 0) {
     code = TAOS_SYSTEM_ERROR(errno);
-    goto _err;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+  start = TMIN(start, size) / TSDB_MIGRATE_CHUNK_SIZE * TSDB_MIGRATE_CHUNK_SIZE;
+  if (start > 0) {
+    tsdbInfo("vgId:%d, resume migrating %s from %" PRId64 " of %" PRId64 " bytes", TD_VID(pTsdb->pVnode), fNameTo,
+             start, size);
   }
-  taosCloseFile(&pOutFD);
-  taosCloseFile(&PInFD);
 
-  // data
-  tsdbDataFileName(pTsdb, pSetFrom->diskId, pSetFrom->fid, pSetFrom->pDataF, fNameFrom);
-  tsdbDataFileName(pTsdb, pSetTo->diskId, pSetTo->fid, pSetTo->pDataF, fNameTo);
-  pOutFD = taosCreateFile(fNameTo, TD_FILE_WRITE | TD_FILE_CREATE | TD_FILE_TRUNC);
-  if (pOutFD == NULL) {
-    code = TAOS_SYSTEM_ERROR(errno);
-    goto _err;
+  for (int64_t offset = 0; offset < size;) {
+    int64_t n = TMIN(size - offset, TSDB_MIGRATE_CHUNK_SIZE);
+
+    tsdbIOBucketAcquire(n);
+    int64_t ret = taosPReadFile(pInFD, pBuf, n, offset);
+    if (ret != n) {
+      code = (ret < 0) ? TAOS_SYSTEM_ERROR(errno) : TSDB_CODE_FILE_CORRUPTED;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+    cksumFrom = taosCalcChecksum(cksumFrom, pBuf, n);
+
+    // the resumed part is only read to checksum the source
+    if (offset >= start) {
+      if (taosPWriteFile(pOutFD, pBuf, n, offset) != n) {
+        code = TAOS_SYSTEM_ERROR(errno);
+        TSDB_CHECK_CODE(code, lino, _exit);
+      }
+      *nMoved += n;
+    }
+    offset += n;
   }
-  PInFD = taosOpenFile(fNameFrom, TD_FILE_READ);
-  if (PInFD == NULL) {
+
+  if (taosFtruncateFile(pOutFD, size) < 0 || taosFsyncFile(pOutFD) < 0) {
     code = TAOS_SYSTEM_ERROR(errno);
-    goto _err;
+    TSDB_CHECK_CODE(code, lino, _exit);
   }
-  n = taosFSendFile(pOutFD, PInFD, 0, tsdbLogicToFileSize(pSetFrom->pDataF->size, szPage));
-  if (n < 0) {
-    code = TAOS_SYSTEM_ERROR(errno);
-    goto _err;
+
+  for (int64_t offset = 0; offset < size;) {
+    int64_t n = TMIN(size - offset, TSDB_MIGRATE_CHUNK_SIZE);
+
+    tsdbIOBucketAcquire(n);
+    int64_t ret = taosPReadFile(pOutFD, pBuf, n, offset);
+    if (ret != n) {
+      code = (ret < 0) ? TAOS_SYSTEM_ERROR(errno) : TSDB_CODE_FILE_CORRUPTED;
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+    cksumTo = taosCalcChecksum(cksumTo, pBuf, n);
+    offset += n;
+  }
+
+  if (cksumTo != cksumFrom) {
+    // start over next time
+    tsdbError("vgId:%d, migrated file %s checksum %u not match source %u", TD_VID(pTsdb->pVnode), fNameTo, cksumTo,
+              cksumFrom);
+    (void)taosFtruncateFile(pOutFD, 0);
+    code = TSDB_CODE_FILE_CORRUPTED;
+    TSDB_CHECK_CODE(code, lino, _exit);
   }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s, file:%s", TD_VID(pTsdb->pVnode), __func__, lino,
+              tstrerror(code), fNameTo);
+  } else {
+    tsdbDebug("vgId:%d, file %s migrated, %" PRId64 " bytes", TD_VID(pTsdb->pVnode), fNameTo, size);
+  }
+  taosCloseFile(&pInFD);
   taosCloseFile(&pOutFD);
-  taosCloseFile(&PInFD);
+  return code;
+}
+
+int32_t tsdbDFileSetCopy(STsdb *pTsdb, SDFileSet *pSetFrom, SDFileSet *pSetTo) {
+  int32_t  code = 0;
+  int32_t  lino = 0;
+  int32_t  szPage = pTsdb->pVnode->config.tsdbPageSize;
+  int64_t  stime = taosGetTimestampMs();
+  int64_t  nMoved = 0;
+  int64_t  nTotal = 0;
+  int64_t  nDone = 0;
+  uint8_t *pBuf = NULL;
+  char     fNameFrom[TSDB_FILENAME_LEN];
+  char     fNameTo[TSDB_FILENAME_LEN];
+
+  pBuf = taosMemoryMalloc(TSDB_MIGRATE_CHUNK_SIZE);
+  if (pBuf == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  nTotal = tsdbLogicToFileSize(pSetFrom->pHeadF->size, szPage) + tsdbLogicToFileSize(pSetFrom->pDataF->size, szPage) +
+           tsdbLogicToFileSize(pSetFrom->pSmaF->size, szPage);
+  for (int8_t iStt = 0; iStt < pSetFrom->nSttF; iStt++) {
+    nTotal += tsdbLogicToFileSize(pSetFrom->aSttF[iStt]->size, szPage);
+  }
+
+  tsdbInfo("vgId:%d, fid:%d start to migrate %" PRId64 " bytes from disk %d:%d to %d:%d", TD_VID(pTsdb->pVnode),
+           pSetFrom->fid, nTotal, pSetFrom->diskId.level, pSetFrom->diskId.id, pSetTo->diskId.level,
+           pSetTo->diskId.id);
+
+  // head
+  tsdbHeadFileName(pTsdb, pSetFrom->diskId, pSetFrom->fid, pSetFrom->pHeadF, fNameFrom);
+  tsdbHeadFileName(pTsdb, pSetTo->diskId, pSetTo->fid, pSetTo->pHeadF, fNameTo);
+  code = tsdbMigrateFile(pTsdb, fNameFrom, fNameTo, tsdbLogicToFileSize(pSetFrom->pHeadF->size, szPage), pBuf,
+                         &nMoved);
+  TSDB_CHECK_CODE(code, lino, _exit);
+  nDone += tsdbLogicToFileSize(pSetFrom->pHeadF->size, szPage);
+
+  // data
+  tsdbDataFileName(pTsdb, pSetFrom->diskId, pSetFrom->fid, pSetFrom->pDataF, fNameFrom);
+  tsdbDataFileName(pTsdb, pSetTo->diskId, pSetTo->fid, pSetTo->pDataF, fNameTo);
+  code = tsdbMigrateFile(pTsdb, fNameFrom, fNameTo, tsdbLogicToFileSize(pSetFrom->pDataF->size, szPage), pBuf,
+                         &nMoved);
+  TSDB_CHECK_CODE(code, lino, _exit);
+  nDone += tsdbLogicToFileSize(pSetFrom->pDataF->size, szPage);
 
   // sma
   tsdbSmaFileName(pTsdb, pSetFrom->diskId, pSetFrom->fid, pSetFrom->pSmaF, fNameFrom);
   tsdbSmaFileName(pTsdb, pSetTo->diskId, pSetTo->fid, pSetTo->pSmaF, fNameTo);
-  pOutFD = taosCreateFile(fNameTo, TD_FILE_WRITE | TD_FILE_CREATE | TD_FILE_TRUNC);
-  if (pOutFD == NULL) {
-    code = TAOS_SYSTEM_ERROR(errno);
-    goto _err;
-  }
-  PInFD = taosOpenFile(fNameFrom, TD_FILE_READ);
-  if (PInFD == NULL) {
-    code = TAOS_SYSTEM_ERROR(errno);
-    goto _err;
-  }
-  n = taosFSendFile(pOutFD, PInFD, 0, tsdbLogicToFileSize(pSetFrom->pSmaF->size, szPage));
-  if (n < 0) {
-    code = TAOS_SYSTEM_ERROR(errno);
-    goto _err;
-  }
-  taosCloseFile(&pOutFD);
-  taosCloseFile(&PInFD);
+  code = tsdbMigrateFile(pTsdb, fNameFrom, fNameTo, tsdbLogicToFileSize(pSetFrom->pSmaF->size, szPage), pBuf,
+                         &nMoved);
+  TSDB_CHECK_CODE(code, lino, _exit);
+  nDone += tsdbLogicToFileSize(pSetFrom->pSmaF->size, szPage);
 
   // stt
   for (int8_t iStt = 0; iStt < pSetFrom->nSttF; iStt++) {
     tsdbSttFileName(pTsdb, pSetFrom->diskId, pSetFrom->fid, pSetFrom->aSttF[iStt], fNameFrom);
     tsdbSttFileName(pTsdb, pSetTo->diskId, pSetTo->fid, pSetTo->aSttF[iStt], fNameTo);
-    pOutFD = taosCreateFile(fNameTo, TD_FILE_WRITE | TD_FILE_CREATE | TD_FILE_TRUNC);
-    if (pOutFD == NULL) {
-      code = TAOS_SYSTEM_ERROR(errno);
-      goto _err;
-    }
-    PInFD = taosOpenFile(fNameFrom, TD_FILE_READ);
-    if (PInFD == NULL) {
-      code = TAOS_SYSTEM_ERROR(errno);
-      goto _err;
-    }
-    n = taosFSendFile(pOutFD, PInFD, 0, tsdbLogicToFileSize(pSetFrom->aSttF[iStt]->size, szPage));
-    if (n < 0) {
-      code = TAOS_SYSTEM_ERROR(errno);
-      goto _err;
-    }
-    taosCloseFile(&pOutFD);
-    taosCloseFile(&PInFD);
+    code = tsdbMigrateFile(pTsdb, fNameFrom, fNameTo, tsdbLogicToFileSize(pSetFrom->aSttF[iStt]->size, szPage), pBuf,
+                           &nMoved);
+    TSDB_CHECK_CODE(code, lino, _exit);
+    nDone += tsdbLogicToFileSize(pSetFrom->aSttF[iStt]->size, szPage);
   }
 
-  return code;
-
-_err:
-  tsdbError("vgId:%d, tsdb DFileSet copy failed since %s", TD_VID(pTsdb->pVnode), tstrerror(code));
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at line %d since %s, fid:%d migrated %" PRId64 "/%" PRId64 " bytes",
+              TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code), pSetFrom->fid, nDone, nTotal);
+  } else {
+    tsdbInfo("vgId:%d, fid:%d migrated %" PRId64 " bytes, %" PRId64 " bytes copied, elapsed %" PRId64 " ms",
+             TD_VID(pTsdb->pVnode), pSetFrom->fid, nTotal, nMoved, taosGetTimestampMs() - stime);
+  }
+  taosMemoryFree(pBuf);
   return code;
 }
 
@@ -1210,6 +1346,30 @@ _err:
   return code;
 }
 
+// read the compressed block followed by its sma as they are on disk, pRaw should hold szBlock + smaInfo.size bytes
+int32_t tsdbReadDataBlockRaw(SDataFReader *pReader, SDataBlk *pDataBlk, uint8_t *pRaw) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  ASSERT(pDataBlk->nSubBlock == 1);
+
+  SBlockInfo *pBlkInfo = &pDataBlk->aSubBlock[0];
+
+  code = tsdbReadFile(pReader->pDataFD, pBlkInfo->offset, pRaw, pBlkInfo->szBlock);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  if (pDataBlk->smaInfo.size > 0) {
+    code = tsdbReadFile(pReader->pSmaFD, pDataBlk->smaInfo.offset, pRaw + pBlkInfo->szBlock, pDataBlk->smaInfo.size);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d, %s failed at %d since %s", TD_VID(pReader->pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  return code;
+}
+
 int32_t tsdbReadDataBlock(SDataFReader *pReader, SDataBlk *pDataBlk, SBlockData *pBlockData) {
   int32_t code = 0;
 
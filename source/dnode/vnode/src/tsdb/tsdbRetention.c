@@ -50,6 +50,7 @@ int32_t tsdbDoRetention(STsdb *pTsdb, int64_t now) {
   int32_t code = 0;
   int32_t lino = 0;
   STsdbFS fs = {0};
+  bool    expired = false;
 
   code = tsdbFSCopy(pTsdb, &fs);
   TSDB_CHECK_CODE(code, lino, _exit);
@@ -68,6 +69,7 @@ int32_t tsdbDoRetention(STsdb *pTsdb, int64_t now) {
       }
       taosArrayRemove(fs.aDFileSet, iSet);
       iSet--;
+      expired = true;
     } else {
       if (expLevel == 0) continue;
       if (tfsAllocDisk(pTsdb->pVnode->pTfs, expLevel, &did) < 0) {
@@ -77,7 +79,7 @@ int32_t tsdbDoRetention(STsdb *pTsdb, int64_t now) {
 
       if (did.level == pSet->diskId.level) continue;
 
-      // copy file to new disk (todo)
+      // copy the files to the new disk, the readers keep on the old ones until the new fs is committed
       SDFileSet fSet = *pSet;
       fSet.diskId = did;
 
@@ -89,6 +91,12 @@ int32_t tsdbDoRetention(STsdb *pTsdb, int64_t now) {
     }
   }
 
+  // the persisted last values may come from the expired files
+  if (expired) {
+    code = tsdbCacheInvalidateStore(pTsdb);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
   // do change fs
   code = tsdbFSPrepareCommit(pTsdb, &fs);
   TSDB_CHECK_CODE(code, lino, _exit);
@@ -19,12 +19,18 @@ extern int32_t tsdbUpdateTableSchema(SMeta* pMeta, int64_t suid, int64_t uid, SS
 extern int32_t tsdbWriteDataBlock(SDataFWriter* pWriter, SBlockData* pBlockData, SMapData* mDataBlk, int8_t cmprAlg);
 extern int32_t tsdbWriteSttBlock(SDataFWriter* pWriter, SBlockData* pBlockData, SArray* aSttBlk, int8_t cmprAlg);
 
+// SSnapDataHdr.flag of SNAP_DATA_TSDB: the data is a data file block as it is on disk, in the format of
+// TABLEID + SDataBlk + compressed block + block sma, instead of rows compressed by tCmprBlockData. It is only sent to
+// a receiver that announced SYNC_SNAPSHOT_CAP_RAW_DATA_BLOCK.
+#define TSDB_SNAP_DATA_FLAG_RAW_BLOCK 0x1
+
 // STsdbSnapReader ========================================
 struct STsdbSnapReader {
   STsdb*   pTsdb;
   int64_t  sver;
   int64_t  ever;
   int8_t   type;
+  int8_t   rawBlock;  // the receiver can apply TSDB_SNAP_DATA_FLAG_RAW_BLOCK data
   uint8_t* aBuf[5];
 
   STsdbFS  fs;
@@ -40,6 +46,9 @@ struct STsdbSnapReader {
   STsdbDataIter2* pIter;
   SRBTree         rbt;
   SBlockData      bData;
+  SDataBlk        rawBlk;  // next block of the data file iter to send as it is, if nRow > 0
+  int64_t         nRawBlk;
+  int64_t         nRowBlk;
 
   // tombstone data
   int8_t          delDone;
@@ -48,6 +57,8 @@ struct STsdbSnapReader {
   SArray*         aDelData;
 };
 
+static int32_t tsdbSnapReadNextRow(STsdbSnapReader* pReader, SRowInfo** ppRowInfo);
+
 static int32_t tsdbSnapReadFileDataStart(STsdbSnapReader* pReader) {
   int32_t code = 0;
   int32_t lino = 0;
@@ -65,29 +76,6 @@ static int32_t tsdbSnapReadFileDataStart(STsdbSnapReader* pReader) {
   code = tsdbDataFReaderOpen(&pReader->pDataFReader, pReader->pTsdb, pSet);
   TSDB_CHECK_CODE(code, lino, _exit);
 
-  code = tsdbOpenDataFileDataIter(pReader->pDataFReader, &pReader->pIter);
-  TSDB_CHECK_CODE(code, lino, _exit);
-
-  if (pReader->pIter) {
-    // iter to next with filter info (sver, ever)
-    code = tsdbDataIterNext2(pReader->pIter,
-                             &(STsdbFilterInfo){.flag = TSDB_FILTER_FLAG_BY_VERSION,  // flag
-                                                .sver = pReader->sver,
-                                                .ever = pReader->ever});
-    TSDB_CHECK_CODE(code, lino, _exit);
-
-    if (pReader->pIter->rowInfo.suid || pReader->pIter->rowInfo.uid) {
-      // add to rbtree
-      tRBTreePut(&pReader->rbt, &pReader->pIter->rbtn);
-
-      // add to iterList
-      pReader->pIter->next = pReader->iterList;
-      pReader->iterList = pReader->pIter;
-    } else {
-      tsdbCloseDataIter2(pReader->pIter);
-    }
-  }
-
   for (int32_t iStt = 0; iStt < pSet->nSttF; ++iStt) {
     code = tsdbOpenSttFileDataIter(pReader->pDataFReader, iStt, &pReader->pIter);
     TSDB_CHECK_CODE(code, lino, _exit);
@@ -113,7 +101,18 @@ static int32_t tsdbSnapReadFileDataStart(STsdbSnapReader* pReader) {
     }
   }
 
-  pReader->pIter = NULL;
+  // the data file iter goes last, so its first block can be checked against the stt rows before being loaded
+  code = tsdbOpenDataFileDataIter(pReader->pDataFReader, &pReader->pIter);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  if (pReader->pIter) {
+    // add to iterList
+    pReader->pIter->next = pReader->iterList;
+    pReader->iterList = pReader->pIter;
+  }
+
+  code = tsdbSnapReadNextRow(pReader, NULL);
+  TSDB_CHECK_CODE(code, lino, _exit);
 
 _exit:
   if (code) {
@@ -134,11 +133,63 @@ static void tsdbSnapReadFileDataEnd(STsdbSnapReader* pReader) {
   tsdbDataFReaderClose(&pReader->pDataFReader);
 }
 
+// A data file block can be sent as it is if all its rows are in [sver, ever], and no row from the stt files falls
+// into its key range, i.e. the smallest row of the other iters is after the block.
+static int32_t tsdbSnapReadCheckRawBlock(STsdbSnapReader* pReader) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  STsdbDataIter2* pIter = pReader->pIter;
+  SDataBlk*       pDataBlk = &pReader->rawBlk;
+
+  code = tsdbDataIterPeekBlock(pIter,
+                               &(STsdbFilterInfo){.flag = TSDB_FILTER_FLAG_BY_VERSION,  // flag
+                                                  .sver = pReader->sver,
+                                                  .ever = pReader->ever},
+                               pDataBlk);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  if (pDataBlk->nRow == 0) goto _exit;
+
+  if (pDataBlk->nSubBlock != 1 || pDataBlk->minVer < pReader->sver || pDataBlk->maxVer > pReader->ever) {
+    pDataBlk->nRow = 0;
+    goto _exit;
+  }
+
+  SRBTreeNode* pNode = tRBTreeMin(&pReader->rbt);
+  if (pNode) {
+    SRowInfo* pRowInfo = &TSDB_RBTN_TO_DATA_ITER(pNode)->rowInfo;
+
+    int32_t c = tTABLEIDCmprFn(pRowInfo, &pIter->rowInfo);
+    if (c < 0 || (c == 0 && TSDBROW_TS(&pRowInfo->row) <= pDataBlk->maxKey.ts)) {
+      pDataBlk->nRow = 0;
+    }
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d %s failed at line %d since %s", TD_VID(pReader->pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  return code;
+}
+
 static int32_t tsdbSnapReadNextRow(STsdbSnapReader* pReader, SRowInfo** ppRowInfo) {
   int32_t code = 0;
   int32_t lino = 0;
 
   if (pReader->pIter) {
+    // check the next block before it is loaded, when the data file iter is done with the current one
+    if (pReader->rawBlock && pReader->pIter->type == TSDB_DATA_FILE_DATA_ITER &&
+        pReader->pIter->dIter.iRow >= pReader->pIter->dIter.bData.nRow) {
+      code = tsdbSnapReadCheckRawBlock(pReader);
+      TSDB_CHECK_CODE(code, lino, _exit);
+
+      if (pReader->rawBlk.nRow > 0) {
+        if (ppRowInfo) *ppRowInfo = NULL;
+        goto _exit;
+      }
+    }
+
     code = tsdbDataIterNext2(pReader->pIter, &(STsdbFilterInfo){.flag = TSDB_FILTER_FLAG_BY_VERSION,  // flag
                                                                 .sver = pReader->sver,
                                                                 .ever = pReader->ever});
@@ -210,6 +261,7 @@ static int32_t tsdbSnapCmprData(STsdbSnapReader* pReader, uint8_t** ppData) {
 
   SSnapDataHdr* pHdr = (SSnapDataHdr*)*ppData;
   pHdr->type = pReader->type;
+  pHdr->flag = 0;
   pHdr->size = size;
 
   memcpy(pHdr->data, pReader->aBuf[3], aBufN[3]);
@@ -225,6 +277,55 @@ _exit:
   return code;
 }
 
+static int32_t tsdbSnapReadRawBlock(STsdbSnapReader* pReader, uint8_t** ppData) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  STsdbDataIter2* pIter = pReader->pIter;
+  SDataBlk*       pDataBlk = &pReader->rawBlk;
+  TABLEID         id = {.suid = pIter->rowInfo.suid, .uid = pIter->rowInfo.uid};
+
+  int64_t size = sizeof(TABLEID) + tPutDataBlk(NULL, pDataBlk) + pDataBlk->aSubBlock[0].szBlock + pDataBlk->smaInfo.size;
+  uint8_t* pData = taosMemoryMalloc(sizeof(SSnapDataHdr) + size);
+  if (pData == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  SSnapDataHdr* pHdr = (SSnapDataHdr*)pData;
+  pHdr->type = pReader->type;
+  pHdr->flag = TSDB_SNAP_DATA_FLAG_RAW_BLOCK;
+  pHdr->size = size;
+
+  uint8_t* p = pHdr->data;
+  memcpy(p, &id, sizeof(TABLEID));
+  p += sizeof(TABLEID);
+  p += tPutDataBlk(p, pDataBlk);
+
+  code = tsdbReadDataBlockRaw(pReader->pDataFReader, pDataBlk, p);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  pReader->nRawBlk++;
+  tsdbTrace("vgId:%d %s done, suid:%" PRId64 " uid:%" PRId64 " nRow:%d size:%" PRId64, TD_VID(pReader->pTsdb->pVnode),
+            __func__, id.suid, id.uid, pDataBlk->nRow, size);
+
+  // move on to the next row or block
+  tsdbDataIterSkipBlock(pIter);
+  pDataBlk->nRow = 0;
+
+  code = tsdbSnapReadNextRow(pReader, NULL);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d %s failed at line %d since %s", TD_VID(pReader->pTsdb->pVnode), __func__, lino, tstrerror(code));
+    taosMemoryFree(pData);
+    pData = NULL;
+  }
+  *ppData = pData;
+  return code;
+}
+
 static int32_t tsdbSnapReadTimeSeriesData(STsdbSnapReader* pReader, uint8_t** ppData) {
   int32_t code = 0;
   int32_t lino = 0;
@@ -242,6 +343,12 @@ static int32_t tsdbSnapReadTimeSeriesData(STsdbSnapReader* pReader, uint8_t** pp
 
     if (pReader->pDataFReader == NULL) break;
 
+    if (pReader->rawBlk.nRow > 0) {
+      code = tsdbSnapReadRawBlock(pReader, ppData);
+      TSDB_CHECK_CODE(code, lino, _exit);
+      break;
+    }
+
     SRowInfo* pRowInfo;
     code = tsdbSnapReadGetRow(pReader, &pRowInfo);
     TSDB_CHECK_CODE(code, lino, _exit);
@@ -289,6 +396,8 @@ static int32_t tsdbSnapReadTimeSeriesData(STsdbSnapReader* pReader, uint8_t** pp
 
     code = tsdbSnapCmprData(pReader, ppData);
     TSDB_CHECK_CODE(code, lino, _exit);
+
+    pReader->nRowBlk++;
   }
 
 _exit:
@@ -424,7 +533,8 @@ _exit:
   return code;
 }
 
-int32_t tsdbSnapReaderOpen(STsdb* pTsdb, int64_t sver, int64_t ever, int8_t type, STsdbSnapReader** ppReader) {
+int32_t tsdbSnapReaderOpen(STsdb* pTsdb, int64_t sver, int64_t ever, int8_t type, int8_t rawBlock,
+                           STsdbSnapReader** ppReader) {
   int32_t code = 0;
   int32_t lino = 0;
 
@@ -438,6 +548,7 @@ int32_t tsdbSnapReaderOpen(STsdb* pTsdb, int64_t sver, int64_t ever, int8_t type
   pReader->sver = sver;
   pReader->ever = ever;
   pReader->type = type;
+  pReader->rawBlock = rawBlock;
 
   taosThreadRwlockRdlock(&pTsdb->rwLock);
   code = tsdbFSRef(pTsdb, &pReader->fs);
@@ -477,6 +588,8 @@ int32_t tsdbSnapReaderClose(STsdbSnapReader** ppReader) {
 
   STsdbSnapReader* pReader = *ppReader;
   STsdb*           pTsdb = pReader->pTsdb;
+  int64_t          nRawBlk = pReader->nRawBlk;
+  int64_t          nRowBlk = pReader->nRowBlk;
 
   // tombstone
   if (pReader->pTIter) {
@@ -511,7 +624,8 @@ _exit:
   if (code) {
     tsdbError("vgId:%d %s failed at line %d since %s", TD_VID(pTsdb->pVnode), __func__, lino, tstrerror(code));
   } else {
-    tsdbDebug("vgId:%d %s done", TD_VID(pTsdb->pVnode), __func__);
+    tsdbInfo("vgId:%d %s done, raw blocks:%" PRId64 " row blocks:%" PRId64, TD_VID(pTsdb->pVnode), __func__, nRawBlk,
+             nRowBlk);
   }
   *ppReader = NULL;
   return code;
@@ -1079,17 +1193,11 @@ _exit:
   return code;
 }
 
-static int32_t tsdbSnapWriteTimeSeriesData(STsdbSnapWriter* pWriter, SSnapDataHdr* pHdr) {
+static int32_t tsdbSnapWriteSwitchFile(STsdbSnapWriter* pWriter, TSKEY key) {
   int32_t code = 0;
   int32_t lino = 0;
 
-  code = tDecmprBlockData(pHdr->data, pHdr->size, &pWriter->inData, pWriter->aBuf);
-  TSDB_CHECK_CODE(code, lino, _exit);
-
-  ASSERT(pWriter->inData.nRow > 0);
-
-  // switch to new data file if need
-  int32_t fid = tsdbKeyFid(pWriter->inData.aTSKEY[0], pWriter->minutes, pWriter->precision);
+  int32_t fid = tsdbKeyFid(key, pWriter->minutes, pWriter->precision);
   if (pWriter->fid != fid) {
     if (pWriter->pDataFWriter) {
       code = tsdbSnapWriteFileDataEnd(pWriter);
@@ -1100,6 +1208,23 @@ static int32_t tsdbSnapWriteTimeSeriesData(STsdbSnapWriter* pWriter, SSnapDataHd
     TSDB_CHECK_CODE(code, lino, _exit);
   }
 
+_exit:
+  if (code) {
+    tsdbError("vgId:%d %s failed at line %d since %s", TD_VID(pWriter->pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  return code;
+}
+
+static int32_t tsdbSnapWriteBlockData(STsdbSnapWriter* pWriter) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  ASSERT(pWriter->inData.nRow > 0);
+
+  // switch to new data file if need
+  code = tsdbSnapWriteSwitchFile(pWriter, pWriter->inData.aTSKEY[0]);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
   // loop write each row
   SRowInfo* pRowInfo;
   code = tsdbSnapWriteGetRow(pWriter, &pRowInfo);
@@ -1143,6 +1268,87 @@ _exit:
   return code;
 }
 
+// A data block sent as it is goes to the new data file unchanged if there is no local file set to merge with,
+// otherwise it is decoded and merged row by row.
+static int32_t tsdbSnapWriteRawBlock(STsdbSnapWriter* pWriter, SSnapDataHdr* pHdr) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  TABLEID  id;
+  SDataBlk dataBlk;
+  uint8_t* p = pHdr->data;
+
+  memcpy(&id, p, sizeof(TABLEID));
+  p += sizeof(TABLEID);
+  p += tGetDataBlk(p, &dataBlk);
+  ASSERT(dataBlk.nSubBlock == 1);
+  ASSERT(p + dataBlk.aSubBlock[0].szBlock + dataBlk.smaInfo.size == pHdr->data + pHdr->size);
+
+  code = tsdbSnapWriteSwitchFile(pWriter, dataBlk.minKey.ts);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  if (pWriter->pDataFReader) {
+    code = tDecmprBlockData(p, dataBlk.aSubBlock[0].szBlock, &pWriter->inData, pWriter->aBuf);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    code = tsdbSnapWriteBlockData(pWriter);
+    TSDB_CHECK_CODE(code, lino, _exit);
+    goto _exit;
+  }
+
+  // switch to new table if need
+  if (id.uid != pWriter->tbid.uid) {
+    if (pWriter->tbid.uid) {
+      code = tsdbSnapWriteTableDataEnd(pWriter);
+      TSDB_CHECK_CODE(code, lino, _exit);
+    }
+
+    code = tsdbSnapWriteTableDataStart(pWriter, &id);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+  // rows of the table before this block
+  code = tsdbWriteDataBlock(pWriter->pDataFWriter, &pWriter->bData, &pWriter->mDataBlk, pWriter->cmprAlg);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tsdbWriteDataBlockRaw(pWriter->pDataFWriter, p, &dataBlk);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+  code = tMapDataPutItem(&pWriter->mDataBlk, &dataBlk, tPutDataBlk);
+  TSDB_CHECK_CODE(code, lino, _exit);
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d %s failed at line %d since %s", TD_VID(pWriter->pTsdb->pVnode), __func__, lino, tstrerror(code));
+  } else {
+    tsdbDebug("vgId:%d %s done, suid:%" PRId64 " uid:%" PRId64 " nRow:%d", TD_VID(pWriter->pTsdb->pVnode), __func__,
+              id.suid, id.uid, dataBlk.nRow);
+  }
+  return code;
+}
+
+static int32_t tsdbSnapWriteTimeSeriesData(STsdbSnapWriter* pWriter, SSnapDataHdr* pHdr) {
+  int32_t code = 0;
+  int32_t lino = 0;
+
+  if (pHdr->flag & TSDB_SNAP_DATA_FLAG_RAW_BLOCK) {
+    code = tsdbSnapWriteRawBlock(pWriter, pHdr);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  } else {
+    code = tDecmprBlockData(pHdr->data, pHdr->size, &pWriter->inData, pWriter->aBuf);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
+    code = tsdbSnapWriteBlockData(pWriter);
+    TSDB_CHECK_CODE(code, lino, _exit);
+  }
+
+_exit:
+  if (code) {
+    tsdbError("vgId:%d %s failed at line %d since %s", TD_VID(pWriter->pTsdb->pVnode), __func__, lino, tstrerror(code));
+  }
+  return code;
+}
+
 // SNAP_DATA_DEL
 static int32_t tsdbSnapWriteDelTableDataStart(STsdbSnapWriter* pWriter, TABLEID* pId) {
   int32_t code = 0;
@@ -1462,6 +1668,10 @@ int32_t tsdbSnapWriterClose(STsdbSnapWriter** ppWriter, int8_t rollback) {
   if (rollback) {
     tsdbRollbackCommit(pWriter->pTsdb);
   } else {
+    // the persisted last values belong to the replaced files
+    code = tsdbCacheInvalidateStore(pTsdb);
+    TSDB_CHECK_CODE(code, lino, _exit);
+
     // lock
     taosThreadRwlockWrlock(&pTsdb->rwLock);
 
@@ -23,19 +23,28 @@ struct SVnodeTask {
   void* arg;
 };
 
-struct SVnodeGlobal {
-  int8_t        init;
+struct SVnodeTaskPool {
   int8_t        stop;
   int           nthreads;
+  const char*   name;
   TdThread*     threads;
   TdThreadMutex mutex;
   TdThreadCond  hasTask;
   SVnodeTask    queue;
 };
 
+struct SVnodeGlobal {
+  int8_t         init;
+  int            nApplyThreads;
+  SVnodeTaskPool commitPool;
+};
+
 struct SVnodeGlobal vnodeGlobal;
 
 static void* loop(void* arg);
+static int   vnodeTaskPoolInit(SVnodeTaskPool* pPool, int nthreads, const char* name);
+static void  vnodeTaskPoolDestroy(SVnodeTaskPool* pPool);
+static int   vnodeTaskPoolSchedule(SVnodeTaskPool* pPool, int (*execute)(void*), void* arg);
 
 static tsem_t canCommit = {0};
 
@@ -43,7 +52,7 @@ static void vnodeInitCommit() { tsem_init(&canCommit, 0, 4); };
 void        vnode_wait_commit() { tsem_wait(&canCommit); }
 void        vnode_done_commit() { tsem_wait(&canCommit); }
 
-int vnodeInit(int nthreads) {
+int vnodeInit(int nthreads, int nApplyThreads) {
   int8_t init;
   int    ret;
 
@@ -52,28 +61,13 @@ int vnodeInit(int nthreads) {
     return 0;
   }
 
-  taosThreadMutexInit(&vnodeGlobal.mutex, NULL);
-  taosThreadCondInit(&vnodeGlobal.hasTask, NULL);
-
-  taosThreadMutexLock(&vnodeGlobal.mutex);
-
-  vnodeGlobal.stop = 0;
-  vnodeGlobal.queue.next = &vnodeGlobal.queue;
-  vnodeGlobal.queue.prev = &vnodeGlobal.queue;
-
-  taosThreadMutexUnlock(&(vnodeGlobal.mutex));
-
-  vnodeGlobal.nthreads = nthreads;
-  vnodeGlobal.threads = taosMemoryCalloc(nthreads, sizeof(TdThread));
-  if (vnodeGlobal.threads == NULL) {
-    terrno = TSDB_CODE_OUT_OF_MEMORY;
+  if (vnodeTaskPoolInit(&vnodeGlobal.commitPool, nthreads, "vnode-commit") < 0) {
     vError("failed to init vnode module since:%s", tstrerror(terrno));
     return -1;
   }
 
-  for (int i = 0; i < nthreads; i++) {
-    taosThreadCreate(&(vnodeGlobal.threads[i]), NULL, loop, NULL);
-  }
+  // each vnode opens its own apply pool of this size, 0 applies submit data in the write thread
+  vnodeGlobal.nApplyThreads = nApplyThreads;
 
   if (walInit() < 0) {
     return -1;
@@ -91,31 +85,103 @@ void vnodeCleanup() {
   init = atomic_val_compare_exchange_8(&(vnodeGlobal.init), 1, 0);
   if (init == 0) return;
 
+  vnodeTaskPoolDestroy(&vnodeGlobal.commitPool);
+
+  walCleanUp();
+  tqCleanUp();
+  smaCleanUp();
+}
+
+int vnodeScheduleTask(int (*execute)(void*), void* arg) {
+  return vnodeTaskPoolSchedule(&vnodeGlobal.commitPool, execute, arg);
+}
+
+int vnodeApplyThreads() { return vnodeGlobal.nApplyThreads; }
+
+int vnodeOpenApplyPool(SVnode* pVnode, int nthreads) {
+  SVnodeTaskPool* pPool = taosMemoryCalloc(1, sizeof(*pPool));
+  if (pPool == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  if (vnodeTaskPoolInit(pPool, nthreads, "vnode-papply") < 0) {
+    taosMemoryFree(pPool);
+    return -1;
+  }
+
+  pVnode->pApplyPool = pPool;
+  return 0;
+}
+
+void vnodeCloseApplyPool(SVnode* pVnode) {
+  if (pVnode->pApplyPool == NULL) return;
+
+  vnodeTaskPoolDestroy(pVnode->pApplyPool);
+  taosMemoryFreeClear(pVnode->pApplyPool);
+}
+
+int vnodeApplyPoolThreads(SVnode* pVnode) { return pVnode->pApplyPool ? pVnode->pApplyPool->nthreads : 0; }
+
+int vnodeScheduleApplyTask(SVnode* pVnode, int (*execute)(void*), void* arg) {
+  return vnodeTaskPoolSchedule(pVnode->pApplyPool, execute, arg);
+}
+
+/* ------------------------ STATIC METHODS ------------------------ */
+static int vnodeTaskPoolInit(SVnodeTaskPool* pPool, int nthreads, const char* name) {
+  taosThreadMutexInit(&pPool->mutex, NULL);
+  taosThreadCondInit(&pPool->hasTask, NULL);
+
+  taosThreadMutexLock(&pPool->mutex);
+
+  pPool->stop = 0;
+  pPool->name = name;
+  pPool->queue.next = &pPool->queue;
+  pPool->queue.prev = &pPool->queue;
+
+  taosThreadMutexUnlock(&(pPool->mutex));
+
+  pPool->threads = taosMemoryCalloc(nthreads, sizeof(TdThread));
+  if (pPool->threads == NULL) {
+    taosThreadCondDestroy(&(pPool->hasTask));
+    taosThreadMutexDestroy(&(pPool->mutex));
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  for (int i = 0; i < nthreads; i++) {
+    taosThreadCreate(&(pPool->threads[i]), NULL, loop, pPool);
+  }
+  pPool->nthreads = nthreads;
+
+  return 0;
+}
+
+static void vnodeTaskPoolDestroy(SVnodeTaskPool* pPool) {
+  if (pPool->threads == NULL) return;
+
   // set stop
-  taosThreadMutexLock(&(vnodeGlobal.mutex));
-  vnodeGlobal.stop = 1;
-  taosThreadCondBroadcast(&(vnodeGlobal.hasTask));
-  taosThreadMutexUnlock(&(vnodeGlobal.mutex));
+  taosThreadMutexLock(&(pPool->mutex));
+  pPool->stop = 1;
+  taosThreadCondBroadcast(&(pPool->hasTask));
+  taosThreadMutexUnlock(&(pPool->mutex));
 
   // wait for threads
-  for (int i = 0; i < vnodeGlobal.nthreads; i++) {
-    taosThreadJoin(vnodeGlobal.threads[i], NULL);
+  for (int i = 0; i < pPool->nthreads; i++) {
+    taosThreadJoin(pPool->threads[i], NULL);
   }
 
   // clear source
-  taosMemoryFreeClear(vnodeGlobal.threads);
-  taosThreadCondDestroy(&(vnodeGlobal.hasTask));
-  taosThreadMutexDestroy(&(vnodeGlobal.mutex));
-
-  walCleanUp();
-  tqCleanUp();
-  smaCleanUp();
+  pPool->nthreads = 0;
+  taosMemoryFreeClear(pPool->threads);
+  taosThreadCondDestroy(&(pPool->hasTask));
+  taosThreadMutexDestroy(&(pPool->mutex));
 }
 
-int vnodeScheduleTask(int (*execute)(void*), void* arg) {
+static int vnodeTaskPoolSchedule(SVnodeTaskPool* pPool, int (*execute)(void*), void* arg) {
   SVnodeTask* pTask;
 
-  ASSERT(!vnodeGlobal.stop);
+  ASSERT(!pPool->stop);
 
   pTask = taosMemoryMalloc(sizeof(*pTask));
   if (pTask == NULL) {
@@ -126,35 +192,35 @@ int vnodeScheduleTask(int (*execute)(void*), void* arg) {
   pTask->execute = execute;
   pTask->arg = arg;
 
-  taosThreadMutexLock(&(vnodeGlobal.mutex));
-  pTask->next = &vnodeGlobal.queue;
-  pTask->prev = vnodeGlobal.queue.prev;
-  vnodeGlobal.queue.prev->next = pTask;
-  vnodeGlobal.queue.prev = pTask;
-  taosThreadCondSignal(&(vnodeGlobal.hasTask));
-  taosThreadMutexUnlock(&(vnodeGlobal.mutex));
+  taosThreadMutexLock(&(pPool->mutex));
+  pTask->next = &pPool->queue;
+  pTask->prev = pPool->queue.prev;
+  pPool->queue.prev->next = pTask;
+  pPool->queue.prev = pTask;
+  taosThreadCondSignal(&(pPool->hasTask));
+  taosThreadMutexUnlock(&(pPool->mutex));
 
   return 0;
 }
 
-/* ------------------------ STATIC METHODS ------------------------ */
 static void* loop(void* arg) {
-  SVnodeTask* pTask;
-  int         ret;
+  SVnodeTaskPool* pPool = (SVnodeTaskPool*)arg;
+  SVnodeTask*     pTask;
+  int             ret;
 
-  setThreadName("vnode-commit");
+  setThreadName(pPool->name);
 
   for (;;) {
-    taosThreadMutexLock(&(vnodeGlobal.mutex));
+    taosThreadMutexLock(&(pPool->mutex));
     for (;;) {
-      pTask = vnodeGlobal.queue.next;
-      if (pTask == &vnodeGlobal.queue) {
+      pTask = pPool->queue.next;
+      if (pTask == &pPool->queue) {
         // no task
-        if (vnodeGlobal.stop) {
-          taosThreadMutexUnlock(&(vnodeGlobal.mutex));
+        if (pPool->stop) {
+          taosThreadMutexUnlock(&(pPool->mutex));
           return NULL;
         } else {
-          taosThreadCondWait(&(vnodeGlobal.hasTask), &(vnodeGlobal.mutex));
+          taosThreadCondWait(&(pPool->hasTask), &(pPool->mutex));
         }
       } else {
         // has task
@@ -164,7 +230,7 @@ static void* loop(void* arg) {
       }
     }
 
-    taosThreadMutexUnlock(&(vnodeGlobal.mutex));
+    taosThreadMutexUnlock(&(pPool->mutex));
 
     pTask->execute(pTask->arg);
     taosMemoryFree(pTask);
@@ -290,6 +290,12 @@ SVnode *vnodeOpen(const char *path, STfs *pTfs, SMsgCb msgCb) {
 
   int8_t rollback = vnodeShouldRollback(pVnode);
 
+  // open apply pool, the buffer pool takes a lock if it is there
+  if (vnodeApplyThreads() > 0 && vnodeOpenApplyPool(pVnode, vnodeApplyThreads()) < 0) {
+    vError("vgId:%d, failed to open vnode apply pool since %s", TD_VID(pVnode), tstrerror(terrno));
+    goto _err;
+  }
+
   // open buffer pool
   if (vnodeOpenBufPool(pVnode) < 0) {
     vError("vgId:%d, failed to open vnode buffer pool since %s", TD_VID(pVnode), tstrerror(terrno));
@@ -367,6 +373,7 @@ _err:
   if (pVnode->pSma) smaClose(pVnode->pSma);
   if (pVnode->pMeta) metaClose(&pVnode->pMeta);
   if (pVnode->freeList) vnodeCloseBufPool(pVnode);
+  vnodeCloseApplyPool(pVnode);
 
   tsem_destroy(&(pVnode->canCommit));
   taosMemoryFree(pVnode);
@@ -391,6 +398,7 @@ void vnodeClose(SVnode *pVnode) {
     smaClose(pVnode->pSma);
     if (pVnode->pMeta) metaClose(&pVnode->pMeta);
     vnodeCloseBufPool(pVnode);
+    vnodeCloseApplyPool(pVnode);
     tsem_post(&pVnode->canCommit);
 
     // destroy handle
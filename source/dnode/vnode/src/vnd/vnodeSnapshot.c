@@ -20,6 +20,7 @@ struct SVSnapReader {
   SVnode *pVnode;
   int64_t sver;
   int64_t ever;
+  int8_t  rawBlock;  // tsdb data blocks may be sent as they are on disk
   int64_t index;
   // config
   int8_t cfgDone;
@@ -44,7 +45,7 @@ struct SVSnapReader {
   SRSmaSnapReader *pRsmaReader;
 };
 
-int32_t vnodeSnapReaderOpen(SVnode *pVnode, int64_t sver, int64_t ever, SVSnapReader **ppReader) {
+int32_t vnodeSnapReaderOpen(SVnode *pVnode, SSnapshotParam *pParam, SVSnapReader **ppReader) {
   int32_t       code = 0;
   SVSnapReader *pReader = NULL;
 
@@ -54,10 +55,12 @@ int32_t vnodeSnapReaderOpen(SVnode *pVnode, int64_t sver, int64_t ever, SVSnapRe
     goto _err;
   }
   pReader->pVnode = pVnode;
-  pReader->sver = sver;
-  pReader->ever = ever;
+  pReader->sver = pParam->start;
+  pReader->ever = pParam->end;
+  pReader->rawBlock = (pParam->caps & SYNC_SNAPSHOT_CAP_RAW_DATA_BLOCK) ? 1 : 0;
 
-  vInfo("vgId:%d, vnode snapshot reader opened, sver:%" PRId64 " ever:%" PRId64, TD_VID(pVnode), sver, ever);
+  vInfo("vgId:%d, vnode snapshot reader opened, sver:%" PRId64 " ever:%" PRId64 " raw block:%d", TD_VID(pVnode),
+        pReader->sver, pReader->ever, pReader->rawBlock);
   *ppReader = pReader;
   return code;
 
@@ -161,7 +164,7 @@ int32_t vnodeSnapRead(SVSnapReader *pReader, uint8_t **ppData, uint32_t *nData)
     // open if not
     if (pReader->pTsdbReader == NULL) {
       code = tsdbSnapReaderOpen(pReader->pVnode->pTsdb, pReader->sver, pReader->ever, SNAP_DATA_TSDB,
-                                &pReader->pTsdbReader);
+                                pReader->rawBlock, &pReader->pTsdbReader);
       if (code) goto _err;
     }
 
@@ -229,7 +232,8 @@ int32_t vnodeSnapRead(SVSnapReader *pReader, uint8_t **ppData, uint32_t *nData)
   if (VND_IS_RSMA(pReader->pVnode) && !pReader->rsmaDone) {
     // open if not
     if (pReader->pRsmaReader == NULL) {
-      code = rsmaSnapReaderOpen(pReader->pVnode->pSma, pReader->sver, pReader->ever, &pReader->pRsmaReader);
+      code = rsmaSnapReaderOpen(pReader->pVnode->pSma, pReader->sver, pReader->ever, pReader->rawBlock,
+                                &pReader->pRsmaReader);
       if (code) goto _err;
     }
 
@@ -625,6 +625,7 @@ static int32_t vnodeProcessDropTtlTbReq(SVnode *pVnode, int64_t version, void *p
   }
   if (taosArrayGetSize(tbUids) > 0) {
     tqUpdateTbUidList(pVnode->pTq, tbUids, false);
+    tsdbCacheDropTables(pVnode->pTsdb, tbUids);
   }
 
   vnodeAsyncRentention(pVnode, ttlReq.timestamp);
@@ -833,6 +834,8 @@ static int32_t vnodeProcessDropStbReq(SVnode *pVnode, int64_t version, void *pRe
     goto _exit;
   }
 
+  tsdbCacheDropTables(pVnode->pTsdb, tbUidList);
+
   if (tdProcessRSmaDrop(pVnode->pSma, &req) < 0) {
     rcode = terrno;
     goto _exit;
@@ -947,6 +950,7 @@ static int32_t vnodeProcessDropTbReq(SVnode *pVnode, int64_t version, void *pReq
 
   tqUpdateTbUidList(pVnode->pTq, tbUids, false);
   tdUpdateTbUidList(pVnode->pSma, pStore, false);
+  tsdbCacheDropTables(pVnode->pTsdb, tbUids);
 
 _exit:
   taosArrayDestroy(tbUids);
@@ -1173,6 +1177,110 @@ static int32_t vnodeRebuildSubmitReqMsg(SSubmitReq2 *pSubmitReq, void **ppMsg) {
   return code;
 }
 
+// parallel apply of submit data: tables of one submit request are partitioned by uid hash, rows of a table always
+// go to the same partition in request order. The partitions run in the apply pool of this vnode only, so the write
+// thread never waits behind the submits of other vnodes. It waits for all partitions before moving on, so the
+// version order of the WAL and the memtable seen by commit are the same as a serial apply.
+#define VNODE_PAPPLY_MIN_TABLES 8
+
+typedef struct {
+  SVnode      *pVnode;
+  int64_t      version;
+  SSubmitReq2 *pSubmitReq;
+  int32_t      iPart;
+  int32_t      nPart;
+  int32_t      code;
+  int64_t      affectedRows;
+  tsem_t      *pDone;
+} SVnodeApplyPart;
+
+static FORCE_INLINE int32_t vnodeApplyPartOf(tb_uid_t uid, int32_t nPart) {
+  return taosIntHash_64((const char *)&uid, sizeof(uid)) % nPart;
+}
+
+static int32_t vnodeApplySubmitPart(SVnodeApplyPart *pPart) {
+  SArray *aSubmitTbData = pPart->pSubmitReq->aSubmitTbData;
+
+  for (int32_t i = 0; i < TARRAY_SIZE(aSubmitTbData); ++i) {
+    SSubmitTbData *pSubmitTbData = taosArrayGet(aSubmitTbData, i);
+    if (vnodeApplyPartOf(pSubmitTbData->uid, pPart->nPart) != pPart->iPart) continue;
+
+    int32_t affectedRows;
+    pPart->code = tsdbInsertTableData(pPart->pVnode->pTsdb, pPart->version, pSubmitTbData, &affectedRows);
+    if (pPart->code) break;
+
+    pPart->affectedRows += affectedRows;
+  }
+
+  return pPart->code;
+}
+
+static int32_t vnodeApplySubmitPartTask(void *arg) {
+  SVnodeApplyPart *pPart = (SVnodeApplyPart *)arg;
+
+  vnodeApplySubmitPart(pPart);
+  tsem_post(pPart->pDone);
+  return 0;
+}
+
+int32_t vnodeApplySubmitData(SVnode *pVnode, int64_t version, SSubmitReq2 *pSubmitReq, SSubmitRsp2 *pSubmitRsp) {
+  int32_t code = 0;
+  int32_t nTbData = TARRAY_SIZE(pSubmitReq->aSubmitTbData);
+  int32_t nPart = TMIN(vnodeApplyPoolThreads(pVnode) + 1, nTbData / VNODE_PAPPLY_MIN_TABLES);
+
+  if (nPart <= 1) {
+    SVnodeApplyPart part = {.pVnode = pVnode, .version = version, .pSubmitReq = pSubmitReq, .iPart = 0, .nPart = 1};
+
+    code = vnodeApplySubmitPart(&part);
+    pSubmitRsp->affectedRows += part.affectedRows;
+    return code;
+  }
+
+  SVnodeApplyPart *aPart = taosMemoryCalloc(nPart, sizeof(SVnodeApplyPart));
+  if (aPart == NULL) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  tsem_t  done;
+  int32_t nScheduled = 0;
+  tsem_init(&done, 0, 0);
+
+  for (int32_t iPart = 0; iPart < nPart; ++iPart) {
+    aPart[iPart] = (SVnodeApplyPart){.pVnode = pVnode,
+                                     .version = version,
+                                     .pSubmitReq = pSubmitReq,
+                                     .iPart = iPart,
+                                     .nPart = nPart,
+                                     .pDone = &done};
+  }
+
+  // the write thread applies partition 0 itself, run a partition inline if it can not be scheduled
+  for (int32_t iPart = 1; iPart < nPart; ++iPart) {
+    if (vnodeScheduleApplyTask(pVnode, vnodeApplySubmitPartTask, &aPart[iPart]) == 0) {
+      nScheduled++;
+    } else {
+      vnodeApplySubmitPart(&aPart[iPart]);
+    }
+  }
+  vnodeApplySubmitPart(&aPart[0]);
+
+  for (int32_t i = 0; i < nScheduled; ++i) {
+    tsem_wait(&done);
+  }
+  tsem_destroy(&done);
+
+  for (int32_t iPart = 0; iPart < nPart; ++iPart) {
+    pSubmitRsp->affectedRows += aPart[iPart].affectedRows;
+    if (code == 0) code = aPart[iPart].code;
+  }
+
+  vTrace("vgId:%d, submit data of %d tables applied in %d partitions, version:%" PRId64, TD_VID(pVnode), nTbData,
+         nPart, version);
+
+  taosMemoryFree(aPart);
+  return code;
+}
+
 static int32_t vnodeProcessSubmitReq(SVnode *pVnode, int64_t version, void *pReq, int32_t len, SRpcMsg *pRsp) {
   int32_t code = 0;
   terrno = 0;
@@ -1305,7 +1413,7 @@ static int32_t vnodeProcessSubmitReq(SVnode *pVnode, int64_t version, void *pReq
 
   vDebug("vgId:%d, submit block size %d", TD_VID(pVnode), (int32_t)taosArrayGetSize(pSubmitReq->aSubmitTbData));
 
-  // loop to handle
+  // create tables
   for (int32_t i = 0; i < TARRAY_SIZE(pSubmitReq->aSubmitTbData); ++i) {
     SSubmitTbData *pSubmitTbData = taosArrayGet(pSubmitReq->aSubmitTbData, i);
 
@@ -1351,15 +1459,12 @@ static int32_t vnodeProcessSubmitReq(SVnode *pVnode, int64_t version, void *pReq
         pSubmitTbData->uid = pSubmitTbData->pCreateTbReq->uid;  // update uid if table exist for using below
       }
     }
-
-    // insert data
-    int32_t affectedRows;
-    code = tsdbInsertTableData(pVnode->pTsdb, version, pSubmitTbData, &affectedRows);
-    if (code) goto _exit;
-
-    pSubmitRsp->affectedRows += affectedRows;
   }
 
+  // insert data, meta changes are all done above so the tsdb part can be applied in parallel
+  code = vnodeApplySubmitData(pVnode, version, pSubmitReq, pSubmitRsp);
+  if (code) goto _exit;
+
   // update the affected table uid list
   if (taosArrayGetSize(newTbUids) > 0) {
     vDebug("vgId:%d, add %d table into query table list in handling submit", TD_VID(pVnode),
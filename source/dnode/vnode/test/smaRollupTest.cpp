@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "sma.h"
+#include "tsdbTestUtil.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include "stub.h"
+
+namespace {
+
+const int32_t rsmaTestBatchSize = 1024;  // RSMA_SUBMIT_BATCH_SIZE
+const int64_t rsmaTestSuid = 200;
+
+// stands for the qTaskInfo of one level, the executor calls are stubbed to record what the level is given
+typedef struct {
+  int8_t               level;
+  std::vector<int64_t> aVer;
+  std::vector<int32_t> aBatch;
+} SRSmaTestTask;
+
+std::atomic<int32_t> rsmaTestRunning(0);
+std::atomic<int32_t> rsmaTestMaxRunning(0);
+
+int32_t rsmaTestSetSMAInput(qTaskInfo_t tinfo, const void *pBlocks, size_t numOfBlocks, int32_t type) {
+  SRSmaTestTask *pTask = (SRSmaTestTask *)tinfo;
+  for (size_t i = 0; i < numOfBlocks; i++) {
+    pTask->aVer.push_back(((const SPackedData *)pBlocks)[i].ver);
+  }
+  pTask->aBatch.push_back((int32_t)numOfBlocks);
+  return 0;
+}
+
+// the levels are kept busy for a while, so they overlap if they run on different executors
+int32_t rsmaTestExecTaskOpt(qTaskInfo_t tinfo, SArray *pResList, uint64_t *useconds, bool *hasMore,
+                            SLocalFetch *pLocal) {
+  int32_t running = ++rsmaTestRunning;
+  int32_t maxRunning = rsmaTestMaxRunning.load();
+  while (running > maxRunning && !rsmaTestMaxRunning.compare_exchange_weak(maxRunning, running)) {
+  }
+  taosMsleep(50);
+  --rsmaTestRunning;
+
+  *hasMore = false;
+  terrno = 0;
+  return 0;
+}
+
+void rsmaTestCleanExecTaskBlockBuf(qTaskInfo_t tinfo) {}
+
+void rsmaTestEnqueue(SRSmaInfo *pInfo, int64_t version) {
+  int32_t len = sizeof(int64_t);
+  void   *qItem = taosAllocateQitem(sizeof(int32_t) + sizeof(int64_t) + len, DEF_QITEM, 0);
+  ASSERT_NE(qItem, nullptr);
+  *(int32_t *)qItem = len;
+  *(int64_t *)POINTER_SHIFT(qItem, sizeof(int32_t)) = version;
+  *(int64_t *)POINTER_SHIFT(qItem, sizeof(int32_t) + sizeof(int64_t)) = version;
+  taosWriteQitem(pInfo->queue, qItem);
+}
+
+}  // namespace
+
+// Both levels of a super table run on the batches at the same time, each level still sees the SubmitReq in order and
+// exactly once, and the buffered items and the lag are reported.
+TEST(smaRollupTest, execLevelsConcurrently) {
+  static Stub stub;
+  stub.set(qSetSMAInput, rsmaTestSetSMAInput);
+  stub.set(qExecTaskOpt, rsmaTestExecTaskOpt);
+  stub.set(qCleanExecTaskBlockBuf, rsmaTestCleanExecTaskBlockBuf);
+
+  SMemTestEnv env = {0};
+  memTestEnvInit(&env);
+
+  int32_t numOfThreads = tsNumOfVnodeRsmaThreads;
+  tsNumOfVnodeRsmaThreads = 2;
+
+  SSma     sma = {0};
+  SSmaEnv  smaEnv = {0};
+  SSmaStat smaStat;
+  memset(&smaStat, 0, sizeof(smaStat));
+  sma.pVnode = env.pVnode;
+  sma.pRSmaEnv = &smaEnv;
+  smaEnv.pStat = &smaStat;
+  SRSmaStat *pRSmaStat = SMA_STAT_RSMA(&smaStat);
+  pRSmaStat->pSma = &sma;
+  tsem_init(&pRSmaStat->notEmpty, 0, 0);
+  RSMA_INFO_HASH(pRSmaStat) =
+      taosHashInit(4, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), true, HASH_ENTRY_LOCK);
+  ASSERT_NE(RSMA_INFO_HASH(pRSmaStat), nullptr);
+
+  SRSmaTestTask tasks[TSDB_RETENTION_L2];
+  SRSmaInfo    *pInfo = (SRSmaInfo *)taosMemoryCalloc(1, sizeof(SRSmaInfo));
+  ASSERT_NE(pInfo, nullptr);
+  pInfo->pSma = &sma;
+  pInfo->pTSchema = env.pTSchema;
+  pInfo->suid = rsmaTestSuid;
+  pInfo->queue = taosOpenQueue();
+  pInfo->qall = taosAllocateQall();
+  pInfo->aSubmit = taosArrayInit(rsmaTestBatchSize, sizeof(SPackedData));
+  for (int8_t i = 0; i < TSDB_RETENTION_L2; i++) {
+    tasks[i].level = i + 1;
+    RSMA_INFO_ITEM(pInfo, i)->level = i + 1;
+    RSMA_INFO_QTASK(pInfo, i) = &tasks[i];
+  }
+  ASSERT_EQ(taosHashPut(RSMA_INFO_HASH(pRSmaStat), &pInfo->suid, sizeof(pInfo->suid), &pInfo, POINTER_BYTES), 0);
+
+  // more than two batches buffered since 100 ms ago
+  const int64_t nItems = 2 * rsmaTestBatchSize + 100;
+  for (int64_t ver = 0; ver < nItems; ver++) {
+    rsmaTestEnqueue(pInfo, ver);
+  }
+  pInfo->firstRecv = taosGetTimestampMs() - 100;
+  pInfo->lastRecv = pInfo->firstRecv;
+  atomic_store_64(&pRSmaStat->nBufItems, nItems);
+
+  int64_t nBufItems = 0;
+  int64_t maxExecLag = 0;
+  smaGetRSmaLoad(&sma, &nBufItems, &maxExecLag);
+  EXPECT_EQ(nBufItems, nItems);
+  EXPECT_EQ(maxExecLag, 0);
+
+  // the executors leave once nothing is buffered
+  smaEnv.flag |= SMA_ENV_FLG_CLOSE;
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i < tsNumOfVnodeRsmaThreads; i++) {
+    threads.push_back(std::thread(tdRSmaProcessExecImpl, &sma, RSMA_EXEC_OVERFLOW));
+  }
+  for (int32_t i = 0; i < 200 && atomic_load_64(&pRSmaStat->nBufItems) > 0; i++) {
+    taosMsleep(50);
+  }
+  for (int32_t i = 0; i < tsNumOfVnodeRsmaThreads; i++) {
+    tsem_post(&pRSmaStat->notEmpty);
+  }
+  for (auto &th : threads) {
+    th.join();
+  }
+
+  EXPECT_EQ(rsmaTestMaxRunning.load(), 2);
+  for (int8_t i = 0; i < TSDB_RETENTION_L2; i++) {
+    ASSERT_EQ(tasks[i].aVer.size(), nItems) << "level " << (int32_t)tasks[i].level;
+    for (int64_t ver = 0; ver < nItems; ver++) {
+      ASSERT_EQ(tasks[i].aVer[ver], ver) << "level " << (int32_t)tasks[i].level;
+    }
+    for (int32_t batch : tasks[i].aBatch) {
+      EXPECT_LE(batch, rsmaTestBatchSize);
+    }
+  }
+  EXPECT_EQ(taosArrayGetSize(pInfo->aSubmit), 0);
+  EXPECT_EQ(pInfo->nExecLevels, 0);
+
+  smaGetRSmaLoad(&sma, &nBufItems, &maxExecLag);
+  EXPECT_EQ(nBufItems, 0);
+  EXPECT_GE(maxExecLag, 100);
+
+  // the lag is reported once
+  smaResetRSmaLoad(&sma, maxExecLag);
+  smaGetRSmaLoad(&sma, &nBufItems, &maxExecLag);
+  EXPECT_EQ(maxExecLag, 0);
+
+  taosHashCleanup(RSMA_INFO_HASH(pRSmaStat));
+  taosArrayDestroy(pInfo->aSubmit);
+  taosFreeQall(pInfo->qall);
+  taosCloseQueue(pInfo->queue);
+  taosMemoryFree(pInfo);
+  tsem_destroy(&pRSmaStat->notEmpty);
+  tsNumOfVnodeRsmaThreads = numOfThreads;
+  memTestEnvCleanup(&env);
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+void cacheTestDeleteLast(const void *key, size_t keyLen, void *value) { taosArrayDestroy((SArray *)value); }
+
+// a last_row entry in the lru, as the inserts of the table leave it
+void cacheTestPutLastRow(STsdb *pTsdb, TSKEY ts, int32_t val) {
+  SArray  *pLast = taosArrayInit(2, sizeof(SLastCol));
+  SLastCol tsCol = {.ts = ts, .colVal = COL_VAL_VALUE(PRIMARYKEY_TIMESTAMP_COL_ID, TSDB_DATA_TYPE_TIMESTAMP,
+                                                      (SValue){.val = ts})};
+  SLastCol valCol = {.ts = ts, .colVal = COL_VAL_VALUE(PRIMARYKEY_TIMESTAMP_COL_ID + 1, TSDB_DATA_TYPE_INT,
+                                                       (SValue){.val = val})};
+  taosArrayPush(pLast, &tsCol);
+  taosArrayPush(pLast, &valCol);
+
+  uint64_t   key = (uint64_t)memUid;
+  LRUHandle *h = NULL;
+  ASSERT_EQ(taosLRUCacheInsert(pTsdb->lruCache, &key, sizeof(key), pLast, sizeof(SLastCol) * 2, cacheTestDeleteLast,
+                               &h, TAOS_LRU_PRIORITY_LOW),
+            TAOS_LRU_STATUS_OK);
+  taosLRUCacheRelease(pTsdb->lruCache, h, false);
+}
+
+bool cacheTestStored(STsdb *pTsdb) {
+  uint64_t key = (uint64_t)memUid;
+  void    *pVal = NULL;
+  int      vLen = 0;
+  if (tdbTbGet(pTsdb->pCacheDb, &key, sizeof(key), &pVal, &vLen) < 0) {
+    return false;
+  }
+  tdbFree(pVal);
+  return true;
+}
+
+void cacheTestReopen(STsdb *pTsdb) {
+  tsdbCloseCache(pTsdb);
+  ASSERT_EQ(tsdbOpenCache(pTsdb), 0);
+  ASSERT_NE(pTsdb->pCacheEnv, nullptr);
+}
+
+}  // namespace
+
+TEST(tsdbCacheTest, lastRowServedFromStoreAfterReopen) {
+  SMemTestEnv env = {0};
+  memTestEnvInit(&env);
+
+  char path[PATH_MAX] = {0};
+  snprintf(path, sizeof(path), "%s%stsdbCacheTest", TD_TMP_DIR_PATH, TD_DIRSEP);
+  taosRemoveDir(path);
+  ASSERT_EQ(taosMkDir(path), 0);
+  env.pTsdb->path = path;
+  env.pVnode->config.cacheLastSize = 1;
+  ASSERT_EQ(tsdbOpenCache(env.pTsdb), 0);
+  ASSERT_NE(env.pTsdb->pCacheEnv, nullptr);
+
+  TSKEY aTs[3] = {10, 20, 30};
+  ASSERT_EQ(memTestInsertRows(&env, 1, aTs, 3), 0);
+  SArray *aTbDataP = taosArrayInit(1, POINTER_BYTES);
+  STbData *pTbData = tsdbGetTbDataFromMemTable(env.pTsdb->mem, memSuid, memUid);
+  ASSERT_NE(pTbData, nullptr);
+  taosArrayPush(aTbDataP, &pTbData);
+
+  // commit: the entry in the lru is persisted
+  cacheTestPutLastRow(env.pTsdb, 30, 1);
+  ASSERT_EQ(tsdbCacheCommit(env.pTsdb, aTbDataP), 0);
+  ASSERT_TRUE(cacheTestStored(env.pTsdb));
+
+  // reopen: the lru is empty, the miss is served from the store without touching the data files
+  cacheTestReopen(env.pTsdb);
+
+  STsdbReadSnap    snap = {0};
+  SCacheRowsReader reader = {0};
+  reader.pVnode = env.pVnode;
+  reader.pSchema = env.pTSchema;
+  reader.suid = memSuid;
+  reader.pReadSnap = &snap;
+
+  LRUHandle *h = NULL;
+  ASSERT_EQ(tsdbCacheGetLastrowH(env.pTsdb->lruCache, memUid, &reader, &h), 0);
+  ASSERT_NE(h, nullptr);
+  SArray *pLast = (SArray *)taosLRUCacheValue(env.pTsdb->lruCache, h);
+  ASSERT_EQ(taosArrayGetSize(pLast), 2);
+  EXPECT_EQ(((SLastCol *)taosArrayGet(pLast, 0))->ts, 30);
+  EXPECT_EQ(((SLastCol *)taosArrayGet(pLast, 1))->colVal.value.val, 1);
+  tsdbCacheRelease(env.pTsdb->lruCache, h);
+
+  // a commit of a table the lru does not hold drops its entry if the rows it is built from may be deleted
+  cacheTestReopen(env.pTsdb);
+  memTestDelete(&env, env.pTsdb->mem, 2, 25, 40);
+  ASSERT_EQ(tsdbCacheCommit(env.pTsdb, aTbDataP), 0);
+  ASSERT_FALSE(cacheTestStored(env.pTsdb));
+
+  // drop table: the entry goes from the lru and the store
+  cacheTestPutLastRow(env.pTsdb, 20, 1);
+  ASSERT_EQ(tsdbCacheCommit(env.pTsdb, aTbDataP), 0);
+  ASSERT_TRUE(cacheTestStored(env.pTsdb));
+
+  SArray *tbUids = taosArrayInit(1, sizeof(tb_uid_t));
+  taosArrayPush(tbUids, &memUid);
+  ASSERT_EQ(tsdbCacheDropTables(env.pTsdb, tbUids), 0);
+  ASSERT_FALSE(cacheTestStored(env.pTsdb));
+  uint64_t key = (uint64_t)memUid;
+  EXPECT_EQ(taosLRUCacheLookup(env.pTsdb->lruCache, &key, sizeof(key)), nullptr);
+
+  taosArrayDestroy(tbUids);
+  taosArrayDestroy(aTbDataP);
+  tsdbCloseCache(env.pTsdb);
+  env.pTsdb->path = NULL;
+  taosRemoveDir(path);
+  memTestEnvCleanup(&env);
+}
@@ -0,0 +1,537 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "tdatablock.h"
+#include "tsdbTestUtil.h"
+
+namespace {
+
+int32_t memTestInsertCols(SMemTestEnv *pEnv, int64_t version, const TSKEY *aTs, int32_t nRow) {
+  SSubmitTbData tbData = {0};
+  tbData.flags = SUBMIT_REQ_COLUMN_DATA_FORMAT;
+  tbData.suid = memSuid;
+  tbData.uid = memUid;
+  tbData.sver = 1;
+  tbData.aCol = taosArrayInit(2, sizeof(SColData));
+
+  SColData aColData[2];
+  tColDataInit(&aColData[0], PRIMARYKEY_TIMESTAMP_COL_ID, TSDB_DATA_TYPE_TIMESTAMP, 0);
+  tColDataInit(&aColData[1], PRIMARYKEY_TIMESTAMP_COL_ID + 1, TSDB_DATA_TYPE_INT, 0);
+  for (int32_t i = 0; i < nRow; i++) {
+    SColVal cv = {0};
+    cv.cid = PRIMARYKEY_TIMESTAMP_COL_ID;
+    cv.type = TSDB_DATA_TYPE_TIMESTAMP;
+    cv.flag = CV_FLAG_VALUE;
+    cv.value.val = aTs[i];
+    tColDataAppendValue(&aColData[0], &cv);
+
+    cv.cid = PRIMARYKEY_TIMESTAMP_COL_ID + 1;
+    cv.type = TSDB_DATA_TYPE_INT;
+    cv.value.val = version;
+    tColDataAppendValue(&aColData[1], &cv);
+  }
+  taosArrayPush(tbData.aCol, &aColData[0]);
+  taosArrayPush(tbData.aCol, &aColData[1]);
+
+  int32_t affectedRows = 0;
+  int32_t code = tsdbInsertTableData(pEnv->pTsdb, version, &tbData, &affectedRows);
+
+  taosArrayDestroyEx(tbData.aCol, tColDataDestroy);
+  return code;
+}
+
+// iterate the table and check that keys come out in (ts, version) order, returns the number of rows
+int64_t memTestScan(STbData *pTbData, TSDBKEY *pFrom, int8_t backward, TSDBKEY *pFirst) {
+  STbDataIter iter = {0};
+  TSDBKEY     lastKey = {0};
+  int64_t     nRow = 0;
+
+  tsdbTbDataIterOpen(pTbData, pFrom, backward, &iter);
+  for (TSDBROW *pRow = tsdbTbDataIterGet(&iter); pRow != NULL; pRow = tsdbTbDataIterGet(&iter)) {
+    TSDBKEY key = {TSDBROW_VERSION(pRow), TSDBROW_TS(pRow)};
+    if (nRow == 0) {
+      if (pFirst) *pFirst = key;
+    } else {
+      int32_t c = tsdbKeyCmprFn(&lastKey, &key);
+      EXPECT_TRUE(backward ? (c > 0) : (c < 0));
+    }
+    lastKey = key;
+    nRow++;
+
+    if (!tsdbTbDataIterNext(&iter)) break;
+  }
+
+  return nRow;
+}
+
+// collect the keys of a scan from pFrom
+void memTestCollect(STbData *pTbData, TSDBKEY *pFrom, int8_t backward, std::vector<TSDBKEY> *pKeys) {
+  STbDataIter iter = {0};
+
+  pKeys->clear();
+  tsdbTbDataIterOpen(pTbData, pFrom, backward, &iter);
+  for (TSDBROW *pRow = tsdbTbDataIterGet(&iter); pRow != NULL; pRow = tsdbTbDataIterGet(&iter)) {
+    pKeys->push_back({TSDBROW_VERSION(pRow), TSDBROW_TS(pRow)});
+    if (!tsdbTbDataIterNext(&iter)) break;
+  }
+}
+
+// the rows inserted through memTestInsertRows/memTestInsertCols carry their version as the value
+typedef struct {
+  std::vector<TSDBKEY>  rows;
+  std::vector<SDelData> dels;
+} SMemTestModel;
+
+// the newest version of each timestamp that is not deleted, in scan order and before endKey
+std::vector<std::pair<TSKEY, int32_t>> memTestExpect(const SMemTestModel &model, int32_t order, TSKEY endKey) {
+  std::map<TSKEY, int64_t> newest;
+  for (const TSDBKEY &key : model.rows) {
+    bool dropped = false;
+    for (const SDelData &del : model.dels) {
+      if (key.ts >= del.sKey && key.ts <= del.eKey && key.version <= del.version) dropped = true;
+    }
+    if (dropped) continue;
+    if (newest.count(key.ts) == 0 || newest[key.ts] < key.version) newest[key.ts] = key.version;
+  }
+
+  std::vector<std::pair<TSKEY, int32_t>> expect;
+  for (auto &kv : newest) {
+    if ((order == TSDB_ORDER_ASC && kv.first < endKey) || (order == TSDB_ORDER_DESC && kv.first > endKey)) {
+      expect.push_back({kv.first, (int32_t)kv.second});
+    }
+  }
+  if (order == TSDB_ORDER_DESC) {
+    std::reverse(expect.begin(), expect.end());
+  }
+  return expect;
+}
+
+// what a reader needs around the memtables: the super table in meta, keep and version ranges that cover the test rows
+// and an empty file system
+void memTestReaderEnvInit(SMemTestEnv *pEnv, char *path, int32_t size) {
+  SVnode *pVnode = pEnv->pVnode;
+  STsdb  *pTsdb = pEnv->pTsdb;
+
+  snprintf(path, size, "%s%stsdbMemReadTest", TD_TMP_DIR_PATH, TD_DIRSEP);
+  taosRemoveDir(path);
+  ASSERT_EQ(taosMkDir(path), 0);
+
+  pVnode->path = path;
+  pVnode->config.szPage = 4096;
+  pVnode->config.szCache = 256;
+  pVnode->state.applied = INT64_MAX;
+  ASSERT_EQ(metaOpen(pVnode, &pVnode->pMeta, 0), 0);
+  ASSERT_EQ(metaBegin(pVnode->pMeta, META_BEGIN_HEAP_NIL), 0);
+
+  SSchema aSchema[2] = {0};
+  for (int32_t i = 0; i < 2; i++) {
+    aSchema[i].type = pEnv->pTSchema->columns[i].type;
+    aSchema[i].colId = pEnv->pTSchema->columns[i].colId;
+    aSchema[i].bytes = pEnv->pTSchema->columns[i].bytes;
+    snprintf(aSchema[i].name, sizeof(aSchema[i].name), "c%d", i);
+  }
+  SSchema aTag[1] = {0};
+  aTag[0].type = TSDB_DATA_TYPE_INT;
+  aTag[0].colId = PRIMARYKEY_TIMESTAMP_COL_ID + 2;
+  aTag[0].bytes = sizeof(int32_t);
+  strcpy(aTag[0].name, "t0");
+
+  char           name[] = "stb";
+  SVCreateStbReq req = {0};
+  req.name = name;
+  req.suid = memSuid;
+  req.schemaRow.nCols = 2;
+  req.schemaRow.version = 1;
+  req.schemaRow.pSchema = aSchema;
+  req.schemaTag.nCols = 1;
+  req.schemaTag.version = 1;
+  req.schemaTag.pSchema = aTag;
+  ASSERT_EQ(metaCreateSTable(pVnode->pMeta, 0, &req), 0);
+
+  TXN *txn = metaGetTxn(pVnode->pMeta);
+  ASSERT_EQ(metaCommit(pVnode->pMeta, txn), 0);
+  ASSERT_EQ(metaFinishCommit(pVnode->pMeta, txn), 0);
+  ASSERT_EQ(metaBegin(pVnode->pMeta, META_BEGIN_HEAP_NIL), 0);
+
+  pTsdb->keepCfg.precision = TSDB_TIME_PRECISION_MILLI;
+  pTsdb->keepCfg.keep2 = TSDB_MAX_KEEP;
+  taosThreadRwlockInit(&pTsdb->rwLock, NULL);
+  pTsdb->fs.aDFileSet = taosArrayInit(0, sizeof(SDFileSet));
+}
+
+void memTestReaderEnvCleanup(SMemTestEnv *pEnv, const char *path) {
+  taosArrayDestroy(pEnv->pTsdb->fs.aDFileSet);
+  pEnv->pTsdb->fs.aDFileSet = NULL;
+  taosThreadRwlockDestroy(&pEnv->pTsdb->rwLock);
+  metaClose(&pEnv->pVnode->pMeta);
+  pEnv->pVnode->path = NULL;
+  taosRemoveDir(path);
+}
+
+// read the table through a tsdb reader with blocks of capacity rows, endKey is excluded from the window
+void memTestCheckRead(SMemTestEnv *pEnv, const SMemTestModel &model, int32_t order, TSKEY endKey, int32_t capacity) {
+  SColumnInfo aCol[2] = {0};
+  int32_t     aSlot[2] = {0, 1};
+  for (int32_t i = 0; i < 2; i++) {
+    aCol[i].colId = pEnv->pTSchema->columns[i].colId;
+    aCol[i].type = pEnv->pTSchema->columns[i].type;
+    aCol[i].bytes = pEnv->pTSchema->columns[i].bytes;
+  }
+
+  SQueryTableDataCond cond = {0};
+  cond.suid = memSuid;
+  cond.order = order;
+  cond.numOfCols = 2;
+  cond.colList = aCol;
+  cond.pSlotList = aSlot;
+  cond.type = TIMEWINDOW_RANGE_CONTAINED;
+  if (order == TSDB_ORDER_ASC) {
+    cond.twindows.skey = INT64_MIN;
+    cond.twindows.ekey = endKey - 1;
+  } else {
+    cond.twindows.skey = endKey + 1;
+    cond.twindows.ekey = INT64_MAX;
+  }
+  cond.startVersion = -1;
+  cond.endVersion = -1;
+
+  STableKeyInfo tbInfo = {0};
+  tbInfo.uid = memUid;
+  pEnv->pVnode->config.tsdbCfg.maxRows = capacity;
+
+  SSDataBlock *pBlock = createDataBlock();
+  SColumnInfoData tsCol = createColumnInfoData(TSDB_DATA_TYPE_TIMESTAMP, sizeof(TSKEY), PRIMARYKEY_TIMESTAMP_COL_ID);
+  SColumnInfoData valCol = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), PRIMARYKEY_TIMESTAMP_COL_ID + 1);
+  blockDataAppendColInfo(pBlock, &tsCol);
+  blockDataAppendColInfo(pBlock, &valCol);
+
+  STsdbReader *pReader = NULL;
+  ASSERT_EQ(tsdbReaderOpen(pEnv->pVnode, &cond, &tbInfo, 1, pBlock, &pReader, "mem-read"), 0);
+
+  std::vector<std::pair<TSKEY, int32_t>> rows;
+  while (tsdbNextDataBlock(pReader)) {
+    SSDataBlock     *pRes = tsdbRetrieveDataBlock(pReader, NULL);
+    SColumnInfoData *pTsCol = (SColumnInfoData *)taosArrayGet(pRes->pDataBlock, 0);
+    SColumnInfoData *pValCol = (SColumnInfoData *)taosArrayGet(pRes->pDataBlock, 1);
+    EXPECT_LE(pRes->info.rows, capacity) << "order:" << order << " endKey:" << endKey;
+    for (int32_t i = 0; i < pRes->info.rows; i++) {
+      EXPECT_FALSE(colDataIsNull_s(pValCol, i)) << "order:" << order << " row:" << rows.size();
+      rows.push_back({((TSKEY *)pTsCol->pData)[i], ((int32_t *)pValCol->pData)[i]});
+    }
+  }
+
+  tsdbReaderClose(pReader);
+  blockDataDestroy(pBlock);
+
+  std::vector<std::pair<TSKEY, int32_t>> expect = memTestExpect(model, order, endKey);
+  ASSERT_EQ(rows.size(), expect.size()) << "order:" << order << " endKey:" << endKey;
+  for (size_t i = 0; i < rows.size(); i++) {
+    EXPECT_EQ(rows[i].first, expect[i].first) << "order:" << order << " row:" << i;
+    EXPECT_EQ(rows[i].second, expect[i].second) << "order:" << order << " row:" << i;
+  }
+}
+
+// a submit request of nTable tables, each of them in two blocks of 5 in-order rows
+SSubmitReq2 *memTestBuildSubmitReq(SMemTestEnv *pEnv, int32_t nTable) {
+  SSubmitReq2 *pReq = (SSubmitReq2 *)taosMemoryCalloc(1, sizeof(SSubmitReq2));
+  pReq->aSubmitTbData = taosArrayInit(nTable * 2, sizeof(SSubmitTbData));
+
+  for (int32_t iBlock = 0; iBlock < 2; iBlock++) {
+    for (int32_t iTable = 0; iTable < nTable; iTable++) {
+      SSubmitTbData tbData = {0};
+      tbData.suid = memSuid;
+      tbData.uid = memUid + 1 + iTable;
+      tbData.sver = 1;
+      tbData.aRowP = taosArrayInit(5, sizeof(SRow *));
+      for (int32_t i = 0; i < 5; i++) {
+        SRow *pRow = memTestBuildRow(pEnv, (iBlock * 5 + i + 1) * 10, iBlock * 1000 + iTable);
+        taosArrayPush(tbData.aRowP, &pRow);
+      }
+      taosArrayPush(pReq->aSubmitTbData, &tbData);
+    }
+  }
+
+  return pReq;
+}
+
+void memTestDestroySubmitReq(SSubmitReq2 *pReq) {
+  tDestroySSubmitReq2(pReq, TSDB_MSG_FLG_ENCODE);
+  taosMemoryFree(pReq);
+}
+
+}  // namespace
+
+TEST(tsdbMemTableTest, appendAndSkiplistMerge) {
+  SMemTestEnv env = {0};
+  memTestEnvInit(&env);
+
+  // in-order batches go to the append list
+  TSKEY  aTs[16];
+  int64_t version = 1;
+  for (int32_t iBatch = 0; iBatch < 10; iBatch++) {
+    for (int32_t i = 0; i < 10; i++) aTs[i] = (iBatch * 10 + i + 1) * 10;
+    ASSERT_EQ(memTestInsertRows(&env, version++, aTs, 10), 0);
+  }
+  for (int32_t i = 0; i < 10; i++) aTs[i] = (100 + i + 1) * 10;
+  ASSERT_EQ(memTestInsertCols(&env, version++, aTs, 10), 0);
+
+  STbData *pTbData = tsdbGetTbDataFromMemTable(env.pTsdb->mem, memSuid, memUid);
+  ASSERT_NE(pTbData, nullptr);
+  EXPECT_EQ(pTbData->al.size, 110);
+  EXPECT_EQ(pTbData->sl.size, 0);
+  EXPECT_EQ(pTbData->al.pTail->flag, TSDBROW_COL_FMT);
+
+  // updates and gaps fall back to the skiplist
+  aTs[0] = 55;
+  aTs[1] = 500;
+  aTs[2] = 2000;
+  ASSERT_EQ(memTestInsertRows(&env, version++, aTs, 3), 0);
+  EXPECT_EQ(pTbData->sl.size, 3);
+  EXPECT_EQ(tsdbGetNRowsInTbData(pTbData), 113);
+
+  // a later in-order batch is appended again
+  aTs[0] = 3000;
+  aTs[1] = 3010;
+  ASSERT_EQ(memTestInsertCols(&env, version++, aTs, 2), 0);
+  EXPECT_EQ(pTbData->al.size, 112);
+
+  TSDBKEY first = {0};
+  EXPECT_EQ(memTestScan(pTbData, NULL, 0, &first), 115);
+  EXPECT_EQ(first.ts, 10);
+  EXPECT_EQ(memTestScan(pTbData, NULL, 1, &first), 115);
+  EXPECT_EQ(first.ts, 3010);
+
+  // positioned scans see the duplicate of ts 500 from both sources
+  TSDBKEY from = {0, 500};
+  EXPECT_EQ(memTestScan(pTbData, &from, 0, &first), 65);
+  EXPECT_EQ(first.ts, 500);
+  EXPECT_EQ(first.version, 5);
+
+  from.version = VERSION_MAX;
+  EXPECT_EQ(memTestScan(pTbData, &from, 1, &first), 52);
+  EXPECT_EQ(first.ts, 500);
+  EXPECT_EQ(first.version, version - 2);
+
+  memTestEnvCleanup(&env);
+}
+
+TEST(tsdbMemTableTest, appendRunThenSkiplistFallback) {
+  SMemTestEnv env = {0};
+  memTestEnvInit(&env);
+
+  TSKEY aTs[16];
+  for (int32_t i = 0; i < 10; i++) aTs[i] = (i + 1) * 10;
+  ASSERT_EQ(memTestInsertRows(&env, 1, aTs, 10), 0);
+
+  STbData *pTbData = tsdbGetTbDataFromMemTable(env.pTsdb->mem, memSuid, memUid);
+  ASSERT_NE(pTbData, nullptr);
+  EXPECT_EQ(pTbData->al.size, 10);
+  EXPECT_EQ(pTbData->sl.size, 0);
+
+  // a batch that starts at the last key updates it, so it goes to the skiplist
+  aTs[0] = 100;
+  aTs[1] = 110;
+  ASSERT_EQ(memTestInsertCols(&env, 2, aTs, 2), 0);
+  EXPECT_EQ(pTbData->al.size, 10);
+  EXPECT_EQ(pTbData->sl.size, 2);
+
+  // so does a batch that starts before the last key
+  aTs[0] = 105;
+  aTs[1] = 130;
+  ASSERT_EQ(memTestInsertRows(&env, 3, aTs, 2), 0);
+  EXPECT_EQ(pTbData->al.size, 10);
+  EXPECT_EQ(pTbData->sl.size, 4);
+
+  // past every key of both sources it is appended again
+  aTs[0] = 200;
+  aTs[1] = 210;
+  ASSERT_EQ(memTestInsertCols(&env, 4, aTs, 2), 0);
+  EXPECT_EQ(pTbData->al.size, 12);
+  EXPECT_EQ(pTbData->sl.size, 4);
+  EXPECT_EQ(tsdbGetNRowsInTbData(pTbData), 16);
+
+  // both versions of ts 100 are kept, ordered by version
+  std::vector<TSDBKEY> expect;
+  for (int32_t i = 0; i < 10; i++) expect.push_back({1, (i + 1) * 10});
+  expect.push_back({2, 100});
+  expect.push_back({3, 105});
+  expect.push_back({2, 110});
+  expect.push_back({3, 130});
+  expect.push_back({4, 200});
+  expect.push_back({4, 210});
+
+  std::vector<TSDBKEY> keys;
+  memTestCollect(pTbData, NULL, 0, &keys);
+  ASSERT_EQ(keys.size(), expect.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    EXPECT_EQ(keys[i].ts, expect[i].ts) << i;
+    EXPECT_EQ(keys[i].version, expect[i].version) << i;
+  }
+
+  memTestCollect(pTbData, NULL, 1, &keys);
+  ASSERT_EQ(keys.size(), expect.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    EXPECT_EQ(keys[i].ts, expect[expect.size() - 1 - i].ts) << i;
+    EXPECT_EQ(keys[i].version, expect[expect.size() - 1 - i].version) << i;
+  }
+
+  // seeks land on the right source whichever one holds the key
+  TSDBKEY from = {0, 100};
+  memTestCollect(pTbData, &from, 0, &keys);
+  ASSERT_EQ(keys.size(), 7);
+  EXPECT_EQ(keys[0].version, 1);
+  EXPECT_EQ(keys[1].version, 2);
+  EXPECT_EQ(keys[1].ts, 100);
+
+  from = {VERSION_MAX, 100};
+  memTestCollect(pTbData, &from, 1, &keys);
+  ASSERT_EQ(keys.size(), 11);
+  EXPECT_EQ(keys[0].version, 2);
+  EXPECT_EQ(keys[1].version, 1);
+  EXPECT_EQ(keys[2].ts, 90);
+
+  from = {0, 125};
+  memTestCollect(pTbData, &from, 0, &keys);
+  ASSERT_EQ(keys.size(), 3);
+  EXPECT_EQ(keys[0].ts, 130);
+
+  from = {VERSION_MAX, 199};
+  memTestCollect(pTbData, &from, 1, &keys);
+  ASSERT_EQ(keys.size(), 14);
+  EXPECT_EQ(keys[0].ts, 130);
+
+  memTestEnvCleanup(&env);
+}
+
+TEST(tsdbMemTableTest, readMemAndIMem) {
+  SMemTestEnv   env = {0};
+  SMemTestModel model;
+  TSKEY         aTs[32];
+  char          path[PATH_MAX] = {0};
+  memTestEnvInit(&env);
+  memTestReaderEnvInit(&env, path, sizeof(path));
+
+  // imem: an append run of rows and one of columns, then updates that go to the skiplist
+  for (int32_t i = 0; i < 20; i++) aTs[i] = (i + 1) * 10;
+  ASSERT_EQ(memTestInsertRows(&env, 1, aTs, 20), 0);
+  for (int32_t i = 0; i < 20; i++) model.rows.push_back({1, aTs[i]});
+  for (int32_t i = 0; i < 10; i++) aTs[i] = 210 + i * 10;
+  ASSERT_EQ(memTestInsertCols(&env, 2, aTs, 10), 0);
+  for (int32_t i = 0; i < 10; i++) model.rows.push_back({2, aTs[i]});
+  aTs[0] = 50;
+  aTs[1] = 60;
+  ASSERT_EQ(memTestInsertRows(&env, 3, aTs, 2), 0);
+  model.rows.push_back({3, 50});
+  model.rows.push_back({3, 60});
+
+  env.pTsdb->imem = env.pTsdb->mem;
+  ASSERT_EQ(tsdbMemTableCreate(env.pTsdb, &env.pTsdb->mem), 0);
+
+  // mem: rows that overlap imem, then columns past it with one updated row
+  for (int32_t i = 0; i < 11; i++) aTs[i] = 150 + i * 10;
+  ASSERT_EQ(memTestInsertRows(&env, 4, aTs, 11), 0);
+  for (int32_t i = 0; i < 11; i++) model.rows.push_back({4, aTs[i]});
+  for (int32_t i = 0; i < 11; i++) aTs[i] = 400 + i * 10;
+  ASSERT_EQ(memTestInsertCols(&env, 5, aTs, 11), 0);
+  for (int32_t i = 0; i < 11; i++) model.rows.push_back({5, aTs[i]});
+  aTs[0] = 450;
+  ASSERT_EQ(memTestInsertRows(&env, 6, aTs, 1), 0);
+  model.rows.push_back({6, 450});
+
+  // the whole buffer, a window that ends inside it, and the buffer split into blocks of 7 rows
+  for (int32_t order : {TSDB_ORDER_ASC, TSDB_ORDER_DESC}) {
+    memTestCheckRead(&env, model, order, order == TSDB_ORDER_ASC ? INT64_MAX : INT64_MIN, 4096);
+    memTestCheckRead(&env, model, order, order == TSDB_ORDER_ASC ? 420 : 145, 4096);
+    memTestCheckRead(&env, model, order, order == TSDB_ORDER_ASC ? INT64_MAX : INT64_MIN, 7);
+  }
+
+  // deletes in both tables, including one older than an update of the same key
+  memTestDelete(&env, env.pTsdb->imem, 3, 40, 60);
+  model.dels.push_back({3, 40, 60, NULL});
+  memTestDelete(&env, env.pTsdb->imem, 2, 280, 290);
+  model.dels.push_back({2, 280, 290, NULL});
+  memTestDelete(&env, env.pTsdb->mem, 4, 100, 160);
+  model.dels.push_back({4, 100, 160, NULL});
+  memTestDelete(&env, env.pTsdb->mem, 5, 440, 450);
+  model.dels.push_back({5, 440, 450, NULL});
+
+  for (int32_t order : {TSDB_ORDER_ASC, TSDB_ORDER_DESC}) {
+    memTestCheckRead(&env, model, order, order == TSDB_ORDER_ASC ? INT64_MAX : INT64_MIN, 4096);
+    memTestCheckRead(&env, model, order, order == TSDB_ORDER_ASC ? 420 : 145, 4096);
+    memTestCheckRead(&env, model, order, order == TSDB_ORDER_ASC ? INT64_MAX : INT64_MIN, 7);
+  }
+
+  taosMemoryFree(env.pTsdb->imem->aBucket);
+  taosMemoryFree(env.pTsdb->imem);
+  env.pTsdb->imem = NULL;
+  memTestReaderEnvCleanup(&env, path);
+  memTestEnvCleanup(&env);
+}
+
+TEST(tsdbMemTableTest, parallelApplyMatchesSerial) {
+  const int32_t nTable = 64;
+  SMemTestEnv   serial = {0};
+  SMemTestEnv   parallel = {0};
+  memTestEnvInit(&serial);
+  memTestEnvInit(&parallel, 3);
+  ASSERT_EQ(vnodeApplyPoolThreads(serial.pVnode), 0);
+  ASSERT_EQ(vnodeApplyPoolThreads(parallel.pVnode), 3);
+  ASSERT_NE(parallel.pPool->lock, nullptr);
+
+  for (int64_t version = 1; version <= 4; version++) {
+    SSubmitReq2 *pReq = memTestBuildSubmitReq(&serial, nTable);
+    SSubmitRsp2  serialRsp = {0};
+    SSubmitRsp2  parallelRsp = {0};
+    ASSERT_EQ(vnodeApplySubmitData(serial.pVnode, version, pReq, &serialRsp), 0);
+    ASSERT_EQ(vnodeApplySubmitData(parallel.pVnode, version, pReq, &parallelRsp), 0);
+    EXPECT_EQ(serialRsp.affectedRows, nTable * 10);
+    EXPECT_EQ(parallelRsp.affectedRows, serialRsp.affectedRows);
+    memTestDestroySubmitReq(pReq);
+  }
+
+  for (int32_t iTable = 0; iTable < nTable; iTable++) {
+    STbData *pSerial = tsdbGetTbDataFromMemTable(serial.pTsdb->mem, memSuid, memUid + 1 + iTable);
+    STbData *pParallel = tsdbGetTbDataFromMemTable(parallel.pTsdb->mem, memSuid, memUid + 1 + iTable);
+    ASSERT_NE(pSerial, nullptr);
+    ASSERT_NE(pParallel, nullptr);
+
+    // the blocks of a table are applied in request order: the first request is appended as a whole, the later ones
+    // rewrite the same keys through the skiplist
+    EXPECT_EQ(pParallel->al.size, 10) << iTable;
+    EXPECT_EQ(pParallel->sl.size, pSerial->sl.size) << iTable;
+    EXPECT_EQ(tsdbGetNRowsInTbData(pParallel), tsdbGetNRowsInTbData(pSerial)) << iTable;
+    EXPECT_EQ(pParallel->minKey, pSerial->minKey) << iTable;
+    EXPECT_EQ(pParallel->maxKey, pSerial->maxKey) << iTable;
+
+    std::vector<TSDBKEY> serialKeys, parallelKeys;
+    memTestCollect(pSerial, NULL, 0, &serialKeys);
+    memTestCollect(pParallel, NULL, 0, &parallelKeys);
+    ASSERT_EQ(parallelKeys.size(), serialKeys.size()) << iTable;
+    for (size_t i = 0; i < serialKeys.size(); i++) {
+      EXPECT_EQ(parallelKeys[i].ts, serialKeys[i].ts) << iTable;
+      EXPECT_EQ(parallelKeys[i].version, serialKeys[i].version) << iTable;
+    }
+  }
+  EXPECT_EQ(parallel.pTsdb->mem->nRow, serial.pTsdb->mem->nRow);
+  EXPECT_EQ(parallel.pTsdb->mem->maxVer, 4);
+
+  memTestEnvCleanup(&parallel);
+  memTestEnvCleanup(&serial);
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tglobal.h"
+#include "tsdbTestUtil.h"
+
+namespace {
+
+class TsdbMigrateTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    memTestEnvInit(&env);
+    snprintf(root, sizeof(root), "%s%stsdbMigrateTest", TD_TMP_DIR_PATH, TD_DIRSEP);
+    snprintf(fNameFrom, sizeof(fNameFrom), "%s%sfrom.data", root, TD_DIRSEP);
+    snprintf(fNameTo, sizeof(fNameTo), "%s%sto.data", root, TD_DIRSEP);
+    taosRemoveDir(root);
+    ASSERT_EQ(taosMulMkDir(root), 0);
+    pBuf = (uint8_t *)taosMemoryMalloc(TSDB_MIGRATE_CHUNK_SIZE);
+    ASSERT_NE(pBuf, nullptr);
+    tsRetentionSpeedLimitMB = 0;
+  }
+
+  void TearDown() override {
+    tsRetentionSpeedLimitMB = 0;
+    taosMemoryFree(pBuf);
+    taosRemoveDir(root);
+    memTestEnvCleanup(&env);
+  }
+
+  // the bytes of the source, so a copy can be checked byte by byte
+  void writeFile(const char *fname, int64_t size, uint8_t seed) {
+    TdFilePtr pFD = taosOpenFile(fname, TD_FILE_CREATE | TD_FILE_WRITE | TD_FILE_TRUNC);
+    ASSERT_NE(pFD, nullptr);
+    for (int64_t offset = 0; offset < size;) {
+      int64_t n = TMIN(size - offset, TSDB_MIGRATE_CHUNK_SIZE);
+      for (int64_t i = 0; i < n; i++) {
+        pBuf[i] = (uint8_t)((offset + i) * 31 + seed);
+      }
+      ASSERT_EQ(taosWriteFile(pFD, pBuf, n), n);
+      offset += n;
+    }
+    taosCloseFile(&pFD);
+  }
+
+  void expectSameFile(const char *fname1, const char *fname2) {
+    int64_t size1 = 0;
+    int64_t size2 = 0;
+    ASSERT_EQ(taosStatFile(fname1, &size1, NULL), 0);
+    ASSERT_EQ(taosStatFile(fname2, &size2, NULL), 0);
+    ASSERT_EQ(size1, size2);
+
+    TdFilePtr pFD1 = taosOpenFile(fname1, TD_FILE_READ);
+    TdFilePtr pFD2 = taosOpenFile(fname2, TD_FILE_READ);
+    ASSERT_NE(pFD1, nullptr);
+    ASSERT_NE(pFD2, nullptr);
+    uint8_t *pBuf2 = (uint8_t *)taosMemoryMalloc(TSDB_MIGRATE_CHUNK_SIZE);
+    for (int64_t offset = 0; offset < size1;) {
+      int64_t n = TMIN(size1 - offset, TSDB_MIGRATE_CHUNK_SIZE);
+      ASSERT_EQ(taosPReadFile(pFD1, pBuf, n, offset), n);
+      ASSERT_EQ(taosPReadFile(pFD2, pBuf2, n, offset), n);
+      ASSERT_EQ(memcmp(pBuf, pBuf2, n), 0) << "differ in the chunk at " << offset;
+      offset += n;
+    }
+    taosMemoryFree(pBuf2);
+    taosCloseFile(&pFD1);
+    taosCloseFile(&pFD2);
+  }
+
+  SMemTestEnv env = {0};
+  char        root[PATH_MAX] = {0};
+  char        fNameFrom[PATH_MAX] = {0};
+  char        fNameTo[PATH_MAX] = {0};
+  uint8_t    *pBuf = NULL;
+};
+
+}  // namespace
+
+TEST_F(TsdbMigrateTest, copyWhole) {
+  const int64_t size = 2 * TSDB_MIGRATE_CHUNK_SIZE + 1000;
+  int64_t       nMoved = 0;
+
+  writeFile(fNameFrom, size, 1);
+  ASSERT_EQ(tsdbMigrateFile(env.pTsdb, fNameFrom, fNameTo, size, pBuf, &nMoved), 0);
+  EXPECT_EQ(nMoved, size);
+  expectSameFile(fNameFrom, fNameTo);
+}
+
+// The whole chunks an interrupted migration left on the target are kept, the rest is copied again.
+TEST_F(TsdbMigrateTest, resumePartialTarget) {
+  const int64_t size = 3 * TSDB_MIGRATE_CHUNK_SIZE + 1000;
+  int64_t       nMoved = 0;
+
+  writeFile(fNameFrom, size, 1);
+  writeFile(fNameTo, TSDB_MIGRATE_CHUNK_SIZE + TSDB_MIGRATE_CHUNK_SIZE / 2, 1);
+  ASSERT_EQ(tsdbMigrateFile(env.pTsdb, fNameFrom, fNameTo, size, pBuf, &nMoved), 0);
+  EXPECT_EQ(nMoved, size - TSDB_MIGRATE_CHUNK_SIZE);
+  expectSameFile(fNameFrom, fNameTo);
+
+  // of a complete target only the partial last chunk is copied again
+  nMoved = 0;
+  ASSERT_EQ(tsdbMigrateFile(env.pTsdb, fNameFrom, fNameTo, size, pBuf, &nMoved), 0);
+  EXPECT_EQ(nMoved, size % TSDB_MIGRATE_CHUNK_SIZE);
+  expectSameFile(fNameFrom, fNameTo);
+}
+
+// A reused part not matching the source fails the copy and is dropped, so the next migration starts over.
+TEST_F(TsdbMigrateTest, checksumMismatchRestart) {
+  const int64_t size = 2 * TSDB_MIGRATE_CHUNK_SIZE + 1000;
+  int64_t       nMoved = 0;
+  int64_t       szTo = -1;
+
+  writeFile(fNameFrom, size, 1);
+  writeFile(fNameTo, TSDB_MIGRATE_CHUNK_SIZE, 2);
+  ASSERT_EQ(tsdbMigrateFile(env.pTsdb, fNameFrom, fNameTo, size, pBuf, &nMoved), TSDB_CODE_FILE_CORRUPTED);
+  ASSERT_EQ(taosStatFile(fNameTo, &szTo, NULL), 0);
+  EXPECT_EQ(szTo, 0);
+
+  nMoved = 0;
+  ASSERT_EQ(tsdbMigrateFile(env.pTsdb, fNameFrom, fNameTo, size, pBuf, &nMoved), 0);
+  EXPECT_EQ(nMoved, size);
+  expectSameFile(fNameFrom, fNameTo);
+}
+
+// Both the copy and the verification take tokens from the bucket, which holds one second of budget at most.
+TEST_F(TsdbMigrateTest, speedLimit) {
+  const int64_t size = 3 * TSDB_MIGRATE_CHUNK_SIZE;
+  const int32_t limitMB = 2;
+  int64_t       nMoved = 0;
+
+  writeFile(fNameFrom, size, 1);
+
+  tsRetentionSpeedLimitMB = limitMB;
+  int64_t stime = taosGetTimestampMs();
+  ASSERT_EQ(tsdbMigrateFile(env.pTsdb, fNameFrom, fNameTo, size, pBuf, &nMoved), 0);
+  int64_t elapsed = taosGetTimestampMs() - stime;
+  EXPECT_EQ(nMoved, size);
+  expectSameFile(fNameFrom, fNameTo);
+
+  // 2 * size bytes at limitMB MB/s, less the budget saved up before, and some slack for the ms rounding of the sleeps
+  int64_t minMs = (2 * size - (int64_t)limitMB * 1024 * 1024) * 1000 / ((int64_t)limitMB * 1024 * 1024);
+  EXPECT_GE(elapsed, minMs - 50);
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tsdbTestUtil.h"
+
+extern "C" int32_t tsdbWriteDataBlock(SDataFWriter *pWriter, SBlockData *pBlockData, SMapData *mDataBlk,
+                                      int8_t cmprAlg);
+
+namespace {
+
+typedef struct {
+  SHeadFile fHead;
+  SDataFile fData;
+  SSmaFile  fSma;
+  SSttFile  fStt;
+  SDFileSet set;
+} SSnapTestFileSet;
+
+void snapTestInitFileSet(SSnapTestFileSet *pFSet, int64_t commitID) {
+  memset(pFSet, 0, sizeof(*pFSet));
+  pFSet->fHead.commitID = commitID;
+  pFSet->fData.commitID = commitID;
+  pFSet->fSma.commitID = commitID;
+  pFSet->fStt.commitID = commitID;
+  pFSet->set.fid = 1;
+  pFSet->set.pHeadF = &pFSet->fHead;
+  pFSet->set.pDataF = &pFSet->fData;
+  pFSet->set.pSmaF = &pFSet->fSma;
+  pFSet->set.nSttF = 1;
+  pFSet->set.aSttF[0] = &pFSet->fStt;
+}
+
+// the writer keeps the file sizes, they are taken before it is closed so the files can be read back
+void snapTestCloseWriter(SDataFWriter **ppWriter, SSnapTestFileSet *pFSet) {
+  pFSet->fHead = (*ppWriter)->fHead;
+  pFSet->fData = (*ppWriter)->fData;
+  pFSet->fSma = (*ppWriter)->fSma;
+  pFSet->fStt = (*ppWriter)->fStt[0];
+  ASSERT_EQ(tsdbDataFWriterClose(ppWriter, 1), 0);
+}
+
+void snapTestFillBlock(SMemTestEnv *pEnv, SBlockData *pBlockData, TSKEY sKey, int32_t nRow) {
+  TABLEID id = {.suid = memSuid, .uid = memUid};
+  ASSERT_EQ(tBlockDataInit(pBlockData, &id, pEnv->pTSchema, NULL, 0), 0);
+  for (int32_t i = 0; i < nRow; i++) {
+    SRow   *pRow = memTestBuildRow(pEnv, sKey + i, i);
+    TSDBROW row = {0};
+    row.type = TSDBROW_ROW_FMT;
+    row.version = i + 1;
+    row.pTSRow = pRow;
+    ASSERT_EQ(tBlockDataAppendRow(pBlockData, &row, pEnv->pTSchema, memUid), 0);
+    taosMemoryFree(pRow);
+  }
+}
+
+}  // namespace
+
+// A block read as it is from one data file and appended to another decodes to the same rows and sma there.
+TEST(tsdbSnapshotTest, rawDataBlockRoundTrip) {
+  SMemTestEnv env = {0};
+  memTestEnvInit(&env);
+
+  char root[PATH_MAX] = {0};
+  char path[PATH_MAX] = {0};
+  char tsdbDir[] = "tsdb";
+  snprintf(root, sizeof(root), "%s%stsdbSnapshotTest", TD_TMP_DIR_PATH, TD_DIRSEP);
+  snprintf(path, sizeof(path), "%s%s%s", root, TD_DIRSEP, tsdbDir);
+  taosRemoveDir(root);
+  ASSERT_EQ(taosMulMkDir(path), 0);
+
+  SDiskCfg dCfg = {0};
+  tstrncpy(dCfg.dir, root, TSDB_FILENAME_LEN);
+  dCfg.level = 0;
+  dCfg.primary = 1;
+  env.pVnode->pTfs = tfsOpen(&dCfg, 1);
+  ASSERT_NE(env.pVnode->pTfs, nullptr);
+  env.pVnode->config.vgId = 2;
+  env.pVnode->config.tsdbPageSize = TSDB_DEFAULT_TSDB_PAGESIZE * 1024;
+  env.pTsdb->path = tsdbDir;
+
+  const int32_t nRow = 1000;
+  SBlockData    bData = {0};
+  SMapData      mDataBlk = {0};
+  SDataBlk      dataBlk;
+  ASSERT_EQ(tBlockDataCreate(&bData), 0);
+
+  // the source file holds one block written by a commit
+  SSnapTestFileSet src;
+  SDataFWriter    *pWriter = NULL;
+  snapTestInitFileSet(&src, 1);
+  ASSERT_EQ(tsdbDataFWriterOpen(&pWriter, env.pTsdb, &src.set), 0);
+  snapTestFillBlock(&env, &bData, 1000, nRow);
+  ASSERT_EQ(tsdbWriteDataBlock(pWriter, &bData, &mDataBlk, ONE_STAGE_COMP), 0);
+  snapTestCloseWriter(&pWriter, &src);
+  ASSERT_EQ(mDataBlk.nItem, 1);
+  tMapDataGetItemByIdx(&mDataBlk, 0, &dataBlk, tGetDataBlk);
+  ASSERT_EQ(dataBlk.nSubBlock, 1);
+  ASSERT_GT(dataBlk.smaInfo.size, 0);
+
+  SDataFReader *pReader = NULL;
+  uint8_t      *pRaw = (uint8_t *)taosMemoryMalloc(dataBlk.aSubBlock[0].szBlock + dataBlk.smaInfo.size);
+  SArray       *aSrcSma = taosArrayInit(2, sizeof(SColumnDataAgg));
+  ASSERT_EQ(tsdbDataFReaderOpen(&pReader, env.pTsdb, &src.set), 0);
+  ASSERT_EQ(tsdbReadDataBlockRaw(pReader, &dataBlk, pRaw), 0);
+  ASSERT_EQ(tsdbReadBlockSma(pReader, &dataBlk, aSrcSma), 0);
+  tsdbDataFReaderClose(&pReader);
+
+  // the destination file has a block of its own before the raw one, so the raw block moves
+  SSnapTestFileSet dst;
+  SDataBlk         rawBlk = dataBlk;
+  snapTestInitFileSet(&dst, 2);
+  tMapDataReset(&mDataBlk);
+  ASSERT_EQ(tsdbDataFWriterOpen(&pWriter, env.pTsdb, &dst.set), 0);
+  snapTestFillBlock(&env, &bData, 0, 10);
+  ASSERT_EQ(tsdbWriteDataBlock(pWriter, &bData, &mDataBlk, ONE_STAGE_COMP), 0);
+  ASSERT_EQ(tsdbWriteDataBlockRaw(pWriter, pRaw, &rawBlk), 0);
+  snapTestCloseWriter(&pWriter, &dst);
+  EXPECT_NE(rawBlk.aSubBlock[0].offset, dataBlk.aSubBlock[0].offset);
+  EXPECT_EQ(rawBlk.aSubBlock[0].szBlock, dataBlk.aSubBlock[0].szBlock);
+
+  SArray *aDstSma = taosArrayInit(2, sizeof(SColumnDataAgg));
+  ASSERT_EQ(tsdbDataFReaderOpen(&pReader, env.pTsdb, &dst.set), 0);
+  ASSERT_EQ(tsdbReadDataBlock(pReader, &rawBlk, &bData), 0);
+  ASSERT_EQ(tsdbReadBlockSma(pReader, &rawBlk, aDstSma), 0);
+  tsdbDataFReaderClose(&pReader);
+
+  ASSERT_EQ(bData.nRow, nRow);
+  SColData *pColData = NULL;
+  tBlockDataGetColData(&bData, PRIMARYKEY_TIMESTAMP_COL_ID + 1, &pColData);
+  ASSERT_NE(pColData, nullptr);
+  for (int32_t i = 0; i < nRow; i++) {
+    SColVal cv;
+    tColDataGetValue(pColData, i, &cv);
+    ASSERT_EQ(bData.aTSKEY[i], 1000 + i);
+    ASSERT_EQ(bData.aVersion[i], i + 1);
+    ASSERT_EQ(cv.value.val, i);
+  }
+
+  ASSERT_EQ(taosArrayGetSize(aDstSma), taosArrayGetSize(aSrcSma));
+  for (int32_t i = 0; i < taosArrayGetSize(aSrcSma); i++) {
+    SColumnDataAgg *pSrc = (SColumnDataAgg *)taosArrayGet(aSrcSma, i);
+    SColumnDataAgg *pDst = (SColumnDataAgg *)taosArrayGet(aDstSma, i);
+    EXPECT_EQ(pDst->colId, pSrc->colId);
+    EXPECT_EQ(pDst->sum, pSrc->sum);
+    EXPECT_EQ(pDst->max, pSrc->max);
+    EXPECT_EQ(pDst->min, pSrc->min);
+  }
+
+  taosArrayDestroy(aDstSma);
+  taosArrayDestroy(aSrcSma);
+  taosMemoryFree(pRaw);
+  tMapDataClear(&mDataBlk);
+  tBlockDataDestroy(&bData);
+  tfsClose(env.pVnode->pTfs);
+  env.pVnode->pTfs = NULL;
+  env.pTsdb->path = NULL;
+  taosRemoveDir(root);
+  memTestEnvCleanup(&env);
+}
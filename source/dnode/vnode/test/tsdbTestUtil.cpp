@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tsdbTestUtil.h"
+
+void memTestEnvInit(SMemTestEnv *pEnv, int32_t nApplyThreads) {
+  pEnv->pVnode = (SVnode *)taosMemoryCalloc(1, sizeof(SVnode));
+  pEnv->pTsdb = (STsdb *)taosMemoryCalloc(1, sizeof(STsdb));
+  ASSERT_NE(pEnv->pVnode, nullptr);
+  ASSERT_NE(pEnv->pTsdb, nullptr);
+
+  pEnv->pVnode->config.szBuf = 64 * 1024 * 1024;
+  pEnv->pVnode->config.tsdbCfg.slLevel = 5;
+  pEnv->pVnode->config.cacheLast = 0;
+  taosThreadMutexInit(&pEnv->pVnode->mutex, NULL);
+  if (nApplyThreads > 0) {
+    ASSERT_EQ(vnodeOpenApplyPool(pEnv->pVnode, nApplyThreads), 0);
+  }
+  ASSERT_EQ(vnodeOpenBufPool(pEnv->pVnode), 0);
+
+  pEnv->pPool = pEnv->pVnode->freeList;
+  pEnv->pPool->nRef = 1;
+  pEnv->pVnode->inUse = pEnv->pPool;
+  pEnv->pVnode->pTsdb = pEnv->pTsdb;
+  pEnv->pTsdb->pVnode = pEnv->pVnode;
+
+  SSchema aSchema[2] = {0};
+  aSchema[0].type = TSDB_DATA_TYPE_TIMESTAMP;
+  aSchema[0].colId = PRIMARYKEY_TIMESTAMP_COL_ID;
+  aSchema[0].bytes = sizeof(TSKEY);
+  aSchema[1].type = TSDB_DATA_TYPE_INT;
+  aSchema[1].colId = PRIMARYKEY_TIMESTAMP_COL_ID + 1;
+  aSchema[1].bytes = sizeof(int32_t);
+  pEnv->pTSchema = tBuildTSchema(aSchema, 2, 1);
+  ASSERT_NE(pEnv->pTSchema, nullptr);
+
+  ASSERT_EQ(tsdbMemTableCreate(pEnv->pTsdb, &pEnv->pTsdb->mem), 0);
+}
+
+void memTestEnvCleanup(SMemTestEnv *pEnv) {
+  // the pool is reset as a whole, the memtable is freed without going through the recycle queue
+  taosMemoryFree(pEnv->pTsdb->mem->aBucket);
+  taosMemoryFree(pEnv->pTsdb->mem);
+  pEnv->pPool->nRef = 0;
+  vnodeCloseBufPool(pEnv->pVnode);
+  vnodeCloseApplyPool(pEnv->pVnode);
+  taosThreadMutexDestroy(&pEnv->pVnode->mutex);
+  tDestroyTSchema(pEnv->pTSchema);
+  taosMemoryFree(pEnv->pTsdb);
+  taosMemoryFree(pEnv->pVnode);
+}
+
+SRow *memTestBuildRow(SMemTestEnv *pEnv, TSKEY ts, int32_t val) {
+  SArray *aColVal = taosArrayInit(2, sizeof(SColVal));
+  SColVal cv = {0};
+
+  cv.cid = PRIMARYKEY_TIMESTAMP_COL_ID;
+  cv.type = TSDB_DATA_TYPE_TIMESTAMP;
+  cv.flag = CV_FLAG_VALUE;
+  cv.value.val = ts;
+  taosArrayPush(aColVal, &cv);
+
+  cv.cid = PRIMARYKEY_TIMESTAMP_COL_ID + 1;
+  cv.type = TSDB_DATA_TYPE_INT;
+  cv.value.val = val;
+  taosArrayPush(aColVal, &cv);
+
+  SRow *pRow = NULL;
+  tRowBuild(aColVal, pEnv->pTSchema, &pRow);
+  taosArrayDestroy(aColVal);
+  return pRow;
+}
+
+int32_t memTestInsertRows(SMemTestEnv *pEnv, int64_t version, const TSKEY *aTs, int32_t nRow) {
+  SSubmitTbData tbData = {0};
+  tbData.suid = memSuid;
+  tbData.uid = memUid;
+  tbData.sver = 1;
+  tbData.aRowP = taosArrayInit(nRow, sizeof(SRow *));
+  for (int32_t i = 0; i < nRow; i++) {
+    SRow *pRow = memTestBuildRow(pEnv, aTs[i], (int32_t)version);
+    taosArrayPush(tbData.aRowP, &pRow);
+  }
+
+  int32_t affectedRows = 0;
+  int32_t code = tsdbInsertTableData(pEnv->pTsdb, version, &tbData, &affectedRows);
+
+  for (int32_t i = 0; i < nRow; i++) {
+    taosMemoryFree(*(SRow **)taosArrayGet(tbData.aRowP, i));
+  }
+  taosArrayDestroy(tbData.aRowP);
+  return code;
+}
+
+void memTestDelete(SMemTestEnv *pEnv, SMemTable *pMem, int64_t version, TSKEY sKey, TSKEY eKey) {
+  // tsdbDeleteTableData goes to meta, the delete is linked to the table data directly
+  STbData  *pTbData = tsdbGetTbDataFromMemTable(pMem, memSuid, memUid);
+  SDelData *pDelData = (SDelData *)vnodeBufPoolMalloc(pMem->pPool, sizeof(SDelData));
+  ASSERT_NE(pTbData, nullptr);
+  ASSERT_NE(pDelData, nullptr);
+
+  pDelData->version = version;
+  pDelData->sKey = sKey;
+  pDelData->eKey = eKey;
+  pDelData->pNext = NULL;
+  if (pTbData->pHead == NULL) {
+    pTbData->pHead = pTbData->pTail = pDelData;
+  } else {
+    pTbData->pTail->pNext = pDelData;
+    pTbData->pTail = pDelData;
+  }
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TSDB_TEST_UTIL_H
+#define TSDB_TEST_UTIL_H
+
+#include <gtest/gtest.h>
+
+#include "tsdb.h"
+#include "vnd.h"
+
+const tb_uid_t memSuid = 100;
+const tb_uid_t memUid = 101;
+
+typedef struct {
+  SVnode    *pVnode;
+  STsdb     *pTsdb;
+  STSchema  *pTSchema;
+  SVBufPool *pPool;
+} SMemTestEnv;
+
+// a vnode with one buffer pool and a tsdb with an empty memtable, the table schema is ts + int
+void    memTestEnvInit(SMemTestEnv *pEnv, int32_t nApplyThreads = 0);
+void    memTestEnvCleanup(SMemTestEnv *pEnv);
+SRow   *memTestBuildRow(SMemTestEnv *pEnv, TSKEY ts, int32_t val);
+int32_t memTestInsertRows(SMemTestEnv *pEnv, int64_t version, const TSKEY *aTs, int32_t nRow);
+void    memTestDelete(SMemTestEnv *pEnv, SMemTable *pMem, int64_t version, TSKEY sKey, TSKEY eKey);
+
+#endif  // TSDB_TEST_UTIL_H
@@ -43,6 +43,11 @@ extern "C" {
 
 #define CTG_BATCH_FETCH 1
 
+#define CTG_RCU_MAX_READERS   1024
+#define CTG_RCU_READER_SIZE   128  // keep hot fields of two readers out of one cache line
+#define CTG_RCU_INIT_BUCKETS  256
+#define CTG_RCU_RECLAIM_BATCH 64
+
 enum {
   CTG_READ = 1,
   CTG_WRITE,
@@ -222,6 +227,64 @@ typedef struct SCtgUserAuth {
   SHashObj* writeDbs;
 } SCtgUserAuth;
 
+typedef void (*FCtgRcuFree)(void*);
+
+typedef struct SCtgRcuNode {
+  struct SCtgRcuNode* next;
+  FCtgRcuFree         freeFp;
+  void*               pData;
+  uint32_t            hashVal;
+  int32_t             keyLen;
+  char                key[];
+} SCtgRcuNode;
+
+typedef struct SCtgRcuTable {
+  int32_t       bucketNum;
+  SCtgRcuNode** buckets;
+} SCtgRcuTable;
+
+// Single writer hash read without locks inside ctgRcuReadLock/ctgRcuReadUnlock, values are immutable once published
+typedef struct SCtgRcuHash {
+  SCtgRcuTable* pTable;
+  int32_t       size;
+  FCtgRcuFree   freeFp;
+} SCtgRcuHash;
+
+typedef struct SCtgRcuReader {
+  int64_t  epoch;  // epoch the reader entered with, 0 if not reading
+  int32_t  nest;
+  int8_t   inUse;
+  int64_t  metaHit;  // snapshot hits not yet added to the cache stat
+  int64_t  vgHit;
+} SCtgRcuReader;
+
+typedef struct SCtgRcuRetired {
+  int64_t     epoch;
+  void*       p;
+  FCtgRcuFree freeFp;
+} SCtgRcuRetired;
+
+typedef struct SCtgRcuMgmt {
+  int64_t       epoch;
+  TdThreadMutex lock;     // serializes snapshot writers, retire and reclaim
+  SArray*       retired;  // element is SCtgRcuRetired
+} SCtgRcuMgmt;
+
+typedef struct SCtgTbSnap {
+  uint64_t dbId;
+  int64_t  metaSize;
+  char     meta[];  // STableMeta, or SCTableMeta for child table
+} SCtgTbSnap;
+
+typedef struct SCtgVgSnap {
+  uint64_t dbId;
+  int32_t  vgVersion;
+  int16_t  hashPrefix;
+  int16_t  hashSuffix;
+  int8_t   hashMethod;
+  SArray*  vgArray;  // SVgroupInfo sorted by hashBegin
+} SCtgVgSnap;
+
 typedef struct SCatalog {
   uint64_t     clusterId;
   bool         stopUpdate;
@@ -229,6 +292,9 @@ typedef struct SCatalog {
   SHashObj*    dbCache;    // key:dbname, value:SCtgDBCache
   SCtgRentMgmt dbRent;
   SCtgRentMgmt stbRent;
+  SCtgRcuHash  tbSnap;   // key:dbFName.tbName, value:SCtgTbSnap
+  SCtgRcuHash  stbSnap;  // key:dbFName + suid, value:stbName
+  SCtgRcuHash  vgSnap;   // key:dbFName, value:SCtgVgSnap
 } SCatalog;
 
 typedef struct SCtgBatch {
@@ -364,6 +430,8 @@ typedef struct SCtgCacheStat {
   uint64_t numOfUserHit;
   uint64_t numOfUserMiss;
   uint64_t numOfClear;
+  uint64_t numOfMetaSnapHit;  // part of numOfMetaHit served by the lock free snapshot
+  uint64_t numOfVgSnapHit;    // part of numOfVgHit served by the lock free snapshot
 } SCtgCacheStat;
 
 typedef struct SCatalogStat {
@@ -474,6 +542,7 @@ typedef struct SCatalogMgmt {
   SHashObj*    pCluster;  // key: clusterId, value: SCatalog*
   SCatalogStat stat;
   SCatalogCfg  cfg;
+  SCtgRcuMgmt  rcu;
 } SCatalogMgmt;
 
 typedef uint32_t (*tableNameHashFp)(const char*, uint32_t);
@@ -702,7 +771,7 @@ void    ctgRUnlockVgInfo(SCtgDBCache* dbCache);
 int32_t ctgTbMetaExistInCache(SCatalog* pCtg, char* dbFName, char* tbName, int32_t* exist);
 int32_t ctgReadTbMetaFromCache(SCatalog* pCtg, SCtgTbMetaCtx* ctx, STableMeta** pTableMeta);
 int32_t ctgReadTbVerFromCache(SCatalog* pCtg, SName* pTableName, int32_t* sver, int32_t* tver, int32_t* tbType,
-                              uint64_t* suid, char* stbName);
+                              uint64_t* uid, uint64_t* suid, char* stbName);
 int32_t ctgChkAuthFromCache(SCatalog* pCtg, char* user, char* dbFName, AUTH_TYPE type, bool* inCache, bool* pass);
 int32_t ctgDropDbCacheEnqueue(SCatalog* pCtg, const char* dbFName, int64_t dbId);
 int32_t ctgDropDbVgroupEnqueue(SCatalog* pCtg, const char* dbFName, bool syncReq);
@@ -801,12 +870,36 @@ int32_t ctgGetTbHashVgroup(SCatalog* pCtg, SRequestConnInfo* pConn, const SName*
 SName*  ctgGetFetchName(SArray* pNames, SCtgFetch* pFetch);
 int32_t ctgdGetOneHandle(SCatalog **pHandle);
 int     ctgVgInfoComp(const void* lp, const void* rp);
+int32_t ctgHashValueComp(void const* lp, void const* rp);
 int32_t ctgMakeVgArray(SDBVgInfo* dbInfo);
 int32_t ctgAcquireVgMetaFromCache(SCatalog *pCtg, const char *dbFName, const char *tbName, SCtgDBCache **pDb, SCtgTbCache **pTb);
 int32_t ctgCopyTbMeta(SCatalog *pCtg, SCtgTbMetaCtx *ctx, SCtgDBCache **pDb, SCtgTbCache **pTb, STableMeta **pTableMeta, char* dbFName);
 void    ctgReleaseVgMetaToCache(SCatalog *pCtg, SCtgDBCache *dbCache, SCtgTbCache *pCache);
 void    ctgReleaseTbMetaToCache(SCatalog *pCtg, SCtgDBCache *dbCache, SCtgTbCache *pCache);
 
+int32_t ctgRcuInit(void);
+void    ctgRcuCleanup(void);
+bool    ctgRcuReadLock(void);
+void    ctgRcuReadUnlock(void);
+void    ctgRcuReclaim(void);
+void    ctgRcuCollectStat(void);
+void*   ctgRcuHashGet(SCtgRcuHash* pHash, const void* key, int32_t keyLen);
+void    ctgRcuInitSnapshot(SCatalog* pCtg);
+void    ctgRcuDestroySnapshot(SCatalog* pCtg);
+void    ctgRcuClearSnapshot(SCatalog* pCtg);
+void    ctgRcuPublishTbMeta(SCatalog* pCtg, const char* dbFName, uint64_t dbId, const char* tbName,
+                            const STableMeta* pMeta);
+void    ctgRcuRemoveTbMeta(SCatalog* pCtg, const char* dbFName, const char* tbName);
+void    ctgRcuRemoveStb(SCatalog* pCtg, const char* dbFName, uint64_t suid);
+void    ctgRcuPublishVgInfo(SCatalog* pCtg, const char* dbFName, uint64_t dbId, SDBVgInfo* pVgInfo);
+void    ctgRcuRemoveVgInfo(SCatalog* pCtg, const char* dbFName);
+void    ctgRcuRemoveDb(SCatalog* pCtg, const char* dbFName);
+bool    ctgRcuReadTbMeta(SCatalog* pCtg, SCtgTbMetaCtx* ctx, const char* dbFName, STableMeta** pTableMeta);
+bool    ctgRcuReadTbVer(SCatalog* pCtg, const char* dbFName, const char* tbName, int32_t* sver, int32_t* tver,
+                        int32_t* tbType, uint64_t* uid, uint64_t* suid, char* stbName);
+bool    ctgRcuGetTbHashVgroup(SCatalog* pCtg, const char* dbFName, const SName* pTableName, SVgroupInfo* pVgroup);
+bool    ctgRcuGetVgEpSet(SCatalog* pCtg, const char* dbFName, int32_t vgId, SEpSet* pEpSet);
+
 extern SCatalogMgmt gCtgMgmt;
 extern SCtgDebug    gCTGDebug;
 extern SCtgAsyncFps gCtgAsyncFps[];
@@ -693,6 +693,8 @@ int32_t catalogInit(SCatalogCfg* cfg) {
     CTG_ERR_RET(terrno);
   }
 
+  CTG_ERR_RET(ctgRcuInit());
+
   CTG_ERR_RET(ctgStartUpdateThread());
 
   qDebug("catalog initialized, maxDb:%u, maxTbl:%u, dbRentSec:%u, stbRentSec:%u", gCtgMgmt.cfg.maxDBCacheNum,
@@ -732,6 +734,7 @@ int32_t catalogGetHandle(uint64_t clusterId, SCatalog** catalogHandle) {
     }
 
     clusterCtg->clusterId = clusterId;
+    ctgRcuInitSnapshot(clusterCtg);
 
     CTG_ERR_JRET(ctgMetaRentInit(&clusterCtg->dbRent, gCtgMgmt.cfg.dbRentSec, CTG_RENT_DB));
     CTG_ERR_JRET(ctgMetaRentInit(&clusterCtg->stbRent, gCtgMgmt.cfg.stbRentSec, CTG_RENT_STABLE));
@@ -810,6 +813,43 @@ _return:
   CTG_API_LEAVE(code);
 }
 
+int32_t catalogGetCachedVgEpSet(SCatalog* pCtg, const char* dbFName, int32_t vgId, SEpSet* pEpSet, bool* exists) {
+  CTG_API_ENTER();
+
+  if (NULL == pCtg || NULL == dbFName || NULL == pEpSet || NULL == exists) {
+    CTG_API_LEAVE(TSDB_CODE_CTG_INVALID_INPUT);
+  }
+
+  SCtgDBCache* dbCache = NULL;
+  int32_t      code = 0;
+
+  *exists = false;
+
+  if (ctgRcuGetVgEpSet(pCtg, dbFName, vgId, pEpSet)) {
+    *exists = true;
+    CTG_API_LEAVE(TSDB_CODE_SUCCESS);
+  }
+
+  CTG_ERR_JRET(ctgAcquireVgInfoFromCache(pCtg, dbFName, &dbCache));
+  if (NULL == dbCache) {
+    CTG_API_LEAVE(TSDB_CODE_SUCCESS);
+  }
+
+  SVgroupInfo* pVgroup = taosHashGet(dbCache->vgCache.vgInfo->vgHash, &vgId, sizeof(vgId));
+  if (pVgroup) {
+    *pEpSet = pVgroup->epSet;
+    *exists = true;
+  }
+
+  ctgReleaseVgInfoToCache(pCtg, dbCache);
+
+  CTG_API_LEAVE(TSDB_CODE_SUCCESS);
+
+_return:
+
+  CTG_API_LEAVE(code);
+}
+
 int32_t catalogGetDBVgList(SCatalog* pCtg, SRequestConnInfo* pConn, const char* dbFName, SArray** vgroupList) {
   CTG_API_ENTER();
 
@@ -1093,9 +1133,10 @@ int32_t catalogChkTbMetaVersion(SCatalog* pCtg, SRequestConnInfo* pConn, SArray*
     }
 
     int32_t  tbType = 0;
+    uint64_t uid = 0;
     uint64_t suid = 0;
     char     stbName[TSDB_TABLE_FNAME_LEN];
-    ctgReadTbVerFromCache(pCtg, &name, &sver, &tver, &tbType, &suid, stbName);
+    ctgReadTbVerFromCache(pCtg, &name, &sver, &tver, &tbType, &uid, &suid, stbName);
     if ((sver >= 0 && sver < pTb->sver) || (tver >= 0 && tver < pTb->tver)) {
       switch (tbType) {
         case TSDB_CHILD_TABLE: {
@@ -1185,6 +1226,20 @@ int32_t catalogGetTablesHashVgId(SCatalog* pCtg, SRequestConnInfo* pConn, int32_
   CTG_API_LEAVE(ctgGetTbsHashVgId(pCtg, pConn, acctId, pDb, pTableName, tableNum, vgId));
 }
 
+int32_t catalogGetCachedTableVer(SCatalog* pCtg, const SName* pTableName, uint64_t* uid, int32_t* sver, int32_t* tver) {
+  CTG_API_ENTER();
+
+  if (NULL == pCtg || NULL == pTableName || NULL == uid || NULL == sver || NULL == tver) {
+    CTG_API_LEAVE(TSDB_CODE_CTG_INVALID_INPUT);
+  }
+
+  int32_t  tbType = 0;
+  uint64_t suid = 0;
+  char     stbName[TSDB_TABLE_FNAME_LEN];
+
+  CTG_API_LEAVE(ctgReadTbVerFromCache(pCtg, (SName*)pTableName, sver, tver, &tbType, uid, &suid, stbName));
+}
+
 int32_t catalogGetCachedTableHashVgroup(SCatalog* pCtg, const SName* pTableName,           SVgroupInfo* pVgroup, bool* exists) {
   CTG_API_ENTER();
 
@@ -1534,6 +1589,7 @@ void catalogDestroy(void) {
   if (!taosCheckCurrentInDll()) {
     ctgClearCacheEnqueue(NULL, true, true, true);
     taosThreadJoin(gCtgMgmt.updateThread, NULL);
+    ctgRcuCleanup();
   }
 
   taosHashCleanup(gCtgMgmt.pCluster);
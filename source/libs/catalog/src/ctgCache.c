@@ -542,6 +542,10 @@ int32_t ctgReadTbMetaFromCache(SCatalog *pCtg, SCtgTbMetaCtx *ctx, STableMeta **
     tNameGetFullDbName(ctx->pName, dbFName);
   }
 
+  if (ctgRcuReadTbMeta(pCtg, ctx, dbFName, pTableMeta)) {
+    return TSDB_CODE_SUCCESS;
+  }
+
   ctgAcquireTbMetaFromCache(pCtg, dbFName, ctx->pName->tname, &dbCache, &tbCache);
   if (NULL == tbCache) {
     ctgReleaseTbMetaToCache(pCtg, dbCache, tbCache);
@@ -566,15 +570,20 @@ _return:
 }
 
 int32_t ctgReadTbVerFromCache(SCatalog *pCtg, SName *pTableName, int32_t *sver, int32_t *tver, int32_t *tbType,
-                              uint64_t *suid, char *stbName) {
+                              uint64_t *uid, uint64_t *suid, char *stbName) {
   *sver = -1;
   *tver = -1;
+  *uid = 0;
 
   SCtgDBCache *dbCache = NULL;
   SCtgTbCache *tbCache = NULL;
   char         dbFName[TSDB_DB_FNAME_LEN] = {0};
   tNameGetFullDbName(pTableName, dbFName);
 
+  if (ctgRcuReadTbVer(pCtg, dbFName, pTableName->tname, sver, tver, tbType, uid, suid, stbName)) {
+    return TSDB_CODE_SUCCESS;
+  }
+
   ctgAcquireTbMetaFromCache(pCtg, dbFName, pTableName->tname, &dbCache, &tbCache);
   if (NULL == tbCache) {
     ctgReleaseTbMetaToCache(pCtg, dbCache, tbCache);
@@ -583,6 +592,7 @@ int32_t ctgReadTbVerFromCache(SCatalog *pCtg, SName *pTableName, int32_t *sver,
 
   STableMeta *tbMeta = tbCache->pMeta;
   *tbType = tbMeta->tableType;
+  *uid = tbMeta->uid;
   *suid = tbMeta->suid;
 
   if (*tbType != TSDB_CHILD_TABLE) {
@@ -1431,6 +1441,7 @@ int32_t ctgRemoveDBFromCache(SCatalog *pCtg, SCtgDBCache *dbCache, const char *d
   CTG_LOCK(CTG_WRITE, &dbCache->dbLock);
 
   atomic_store_8(&dbCache->deleted, 1);
+  ctgRcuRemoveDb(pCtg, dbFName);
   ctgRemoveStbRent(pCtg, dbCache);
   ctgFreeDbCache(dbCache);
 
@@ -1469,6 +1480,7 @@ int32_t ctgGetAddDBCache(SCatalog *pCtg, const char *dbFName, uint64_t dbId, SCt
     }
 
     if (dbId && (dbCache->dbId == 0)) {
+      ctgRcuRemoveDb(pCtg, dbFName);
       dbCache->dbId = dbId;
       *pCache = dbCache;
       return TSDB_CODE_SUCCESS;
@@ -1545,6 +1557,8 @@ int32_t ctgWriteTbMetaToCache(SCatalog *pCtg, SCtgDBCache *dbCache, char *dbFNam
         CTG_CACHE_STAT_DEC(numOfStb, 1);
         ctgDebug("stb removed from stbCache, dbFName:%s, stb:%s, suid:0x%" PRIx64, dbFName, tbName, orig->suid);
       }
+
+      ctgRcuRemoveStb(pCtg, dbFName, orig->suid);
     }
   }
 
@@ -1572,6 +1586,8 @@ int32_t ctgWriteTbMetaToCache(SCatalog *pCtg, SCtgDBCache *dbCache, char *dbFNam
   ctgDebug("tbmeta updated to cache, dbFName:%s, tbName:%s, tbType:%d", dbFName, tbName, meta->tableType);
   ctgdShowTableMeta(pCtg, tbName, meta);
 
+  ctgRcuPublishTbMeta(pCtg, dbFName, dbCache->dbId, tbName, meta);
+
   if (!isStb) {
     return TSDB_CODE_SUCCESS;
   }
@@ -1771,6 +1787,8 @@ int32_t ctgOpUpdateVgroup(SCtgCacheOperation *operation) {
   vgCache->vgInfo = dbInfo;
   msg->dbInfo = NULL;
 
+  ctgRcuPublishVgInfo(pCtg, dbFName, dbCache->dbId, dbInfo);
+
   ctgDebug("db vgInfo updated, dbFName:%s, vgVer:%d, stateTs:%" PRId64 ", dbId:0x%" PRIx64, dbFName,
            vgVersion.vgVersion, vgVersion.stateTs, vgVersion.dbId);
 
@@ -1839,6 +1857,7 @@ int32_t ctgOpDropDbVgroup(SCtgCacheOperation *operation) {
 
   CTG_ERR_JRET(ctgWLockVgInfo(pCtg, dbCache));
 
+  ctgRcuRemoveVgInfo(pCtg, msg->dbFName);
   freeVgInfo(dbCache->vgCache.vgInfo);
   dbCache->vgCache.vgInfo = NULL;
 
@@ -1928,6 +1947,9 @@ int32_t ctgOpDropStbMeta(SCtgCacheOperation *operation) {
     goto _return;
   }
 
+  ctgRcuRemoveStb(pCtg, msg->dbFName, msg->suid);
+  ctgRcuRemoveTbMeta(pCtg, msg->dbFName, msg->stbName);
+
   if (taosHashRemove(dbCache->stbCache, &msg->suid, sizeof(msg->suid))) {
     ctgDebug("stb not exist in stbCache, may be removed, dbFName:%s, stb:%s, suid:0x%" PRIx64, msg->dbFName,
              msg->stbName, msg->suid);
@@ -1985,6 +2007,8 @@ int32_t ctgOpDropTbMeta(SCtgCacheOperation *operation) {
     goto _return;
   }
 
+  ctgRcuRemoveTbMeta(pCtg, msg->dbFName, msg->tbName);
+
   SCtgTbCache *pTbCache = taosHashGet(dbCache->tbCache, msg->tbName, strlen(msg->tbName));
   if (NULL == pTbCache) {
     ctgDebug("tb %s already not in cache", msg->tbName);
@@ -2114,6 +2138,8 @@ int32_t ctgOpUpdateEpset(SCtgCacheOperation *operation) {
   pInfo->epSet = msg->epSet;
   pInfo2->epSet = msg->epSet;
 
+  ctgRcuPublishVgInfo(pCtg, msg->dbFName, dbCache->dbId, vgInfo);
+
 _return:
 
   if (code == TSDB_CODE_SUCCESS && dbCache) {
@@ -2343,6 +2369,9 @@ void *ctgUpdateThreadFunc(void *param) {
 
     (*gCtgCacheOperation[operation->opId].func)(operation);
 
+    ctgRcuReclaim();
+    ctgRcuCollectStat();
+
     if (operation->syncOp) {
       tsem_post(&operation->rspSem);
     } else {
@@ -2689,6 +2718,17 @@ int32_t ctgGetTbHashVgroupFromCache(SCatalog *pCtg, const SName *pTableName, SVg
   char         dbFName[TSDB_DB_FNAME_LEN] = {0};
   tNameGetFullDbName(pTableName, dbFName);
 
+  SVgroupInfo vgInfo = {0};
+  if (ctgRcuGetTbHashVgroup(pCtg, dbFName, pTableName, &vgInfo)) {
+    *pVgroup = taosMemoryMalloc(sizeof(SVgroupInfo));
+    if (NULL == *pVgroup) {
+      CTG_ERR_RET(TSDB_CODE_OUT_OF_MEMORY);
+    }
+
+    **pVgroup = vgInfo;
+    return TSDB_CODE_SUCCESS;
+  }
+
   CTG_ERR_RET(ctgAcquireVgInfoFromCache(pCtg, dbFName, &dbCache));
 
   if (NULL == dbCache) {
@@ -349,6 +349,18 @@ int32_t ctgdGetStatNum(char *option, void *res) {
     return TSDB_CODE_SUCCESS;
   }
 
+  if (0 == strcasecmp(option, "cache.numOfMetaSnapHit")) {
+    ctgRcuCollectStat();
+    *(uint64_t *)res = atomic_load_64(&gCtgMgmt.stat.cache.numOfMetaSnapHit);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  if (0 == strcasecmp(option, "cache.numOfVgSnapHit")) {
+    ctgRcuCollectStat();
+    *(uint64_t *)res = atomic_load_64(&gCtgMgmt.stat.cache.numOfVgSnapHit);
+    return TSDB_CODE_SUCCESS;
+  }
+
   qError("invalid stat option:%s", option);
 
   return TSDB_CODE_CTG_INTERNAL_ERROR;
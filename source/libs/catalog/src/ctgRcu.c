@@ -0,0 +1,739 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "catalogInt.h"
+#include "query.h"
+#include "tname.h"
+
+/*
+ * Lock free snapshot of the hot catalog entries.
+ *
+ * The catalog update thread is the only writer. It publishes an immutable copy of every table meta and db vgroup
+ * info it writes to the latched cache, and unlinks the copy when the latched entry goes away. Readers look the copy
+ * up without taking any lock, announcing the global epoch they entered with in a per thread slot. Unlinked entries
+ * are retired with the epoch they were unlinked in and only freed once no reader slot holds an epoch that old.
+ * Any miss falls back to the latched cache, so the snapshot only needs to be correct, never complete.
+ *
+ * Hits are counted in the reader slot the thread owns and only added to the shared cache stat by the collector, so the
+ * read path never writes a cache line another thread writes.
+ */
+
+typedef union {
+  SCtgRcuReader reader;
+  char          pad[CTG_RCU_READER_SIZE];
+} SCtgRcuReaderSlot;
+
+static SCtgRcuReaderSlot    ctgRcuReaders[CTG_RCU_MAX_READERS];
+static TdThreadOnce         ctgRcuKeyInit = PTHREAD_ONCE_INIT;
+static TdThreadKey          ctgRcuKey;
+static threadlocal int32_t  ctgRcuSlot = -1;
+static threadlocal bool     ctgRcuNoSlot = false;
+
+static void ctgRcuReleaseSlot(void *param) {
+  int32_t slot = (int32_t)(int64_t)param - 1;
+  if (slot < 0 || slot >= CTG_RCU_MAX_READERS) {
+    return;
+  }
+
+  SCtgRcuReader *pReader = &ctgRcuReaders[slot].reader;
+  atomic_store_64(&pReader->epoch, 0);
+  pReader->nest = 0;
+  atomic_store_8(&pReader->inUse, 0);
+}
+
+static void ctgRcuCreateKey(void) { taosThreadKeyCreate(&ctgRcuKey, ctgRcuReleaseSlot); }
+
+static SCtgRcuReader *ctgRcuGetReader(void) {
+  if (ctgRcuSlot >= 0) {
+    return &ctgRcuReaders[ctgRcuSlot].reader;
+  }
+
+  if (ctgRcuNoSlot) {
+    return NULL;
+  }
+
+  taosThreadOnce(&ctgRcuKeyInit, ctgRcuCreateKey);
+
+  for (int32_t i = 0; i < CTG_RCU_MAX_READERS; ++i) {
+    if (0 == atomic_val_compare_exchange_8(&ctgRcuReaders[i].reader.inUse, 0, 1)) {
+      ctgRcuSlot = i;
+      taosThreadSetSpecific(ctgRcuKey, (void *)(int64_t)(i + 1));
+      return &ctgRcuReaders[i].reader;
+    }
+  }
+
+  qDebug("no free catalog rcu reader slot, thread will read the latched cache only");
+  ctgRcuNoSlot = true;
+
+  return NULL;
+}
+
+bool ctgRcuReadLock(void) {
+  SCtgRcuReader *pReader = ctgRcuGetReader();
+  if (NULL == pReader) {
+    return false;
+  }
+
+  if (pReader->nest++ > 0) {
+    return true;
+  }
+
+  int64_t epoch = atomic_load_64(&gCtgMgmt.rcu.epoch);
+  while (true) {
+    atomic_store_64(&pReader->epoch, epoch);
+    int64_t curEpoch = atomic_load_64(&gCtgMgmt.rcu.epoch);
+    if (curEpoch == epoch) {
+      break;
+    }
+
+    epoch = curEpoch;
+  }
+
+  return true;
+}
+
+void ctgRcuReadUnlock(void) {
+  SCtgRcuReader *pReader = &ctgRcuReaders[ctgRcuSlot].reader;
+  if (--pReader->nest == 0) {
+    atomic_store_64(&pReader->epoch, 0);
+  }
+}
+
+static void ctgRcuRetire(void *p, FCtgRcuFree freeFp) {
+  if (NULL == p) {
+    return;
+  }
+
+  // the update thread is gone and no reader is left once the retired list is cleaned up
+  if (NULL == gCtgMgmt.rcu.retired) {
+    (*freeFp)(p);
+    return;
+  }
+
+  taosThreadMutexLock(&gCtgMgmt.rcu.lock);
+
+  SCtgRcuRetired retired = {.epoch = atomic_load_64(&gCtgMgmt.rcu.epoch), .p = p, .freeFp = freeFp};
+  if (NULL == taosArrayPush(gCtgMgmt.rcu.retired, &retired)) {
+    // nothing safe to do but leak it, a reader may still be walking it
+    qError("catalog rcu retire failed, %p leaked", p);
+  } else {
+    atomic_add_fetch_64(&gCtgMgmt.rcu.epoch, 1);
+  }
+
+  taosThreadMutexUnlock(&gCtgMgmt.rcu.lock);
+}
+
+void ctgRcuReclaim(void) {
+  if (NULL == gCtgMgmt.rcu.retired || taosArrayGetSize(gCtgMgmt.rcu.retired) <= 0) {
+    return;
+  }
+
+  // scan under the lock so that nothing can be retired between the scan and the free
+  taosThreadMutexLock(&gCtgMgmt.rcu.lock);
+
+  int64_t minEpoch = INT64_MAX;
+  for (int32_t i = 0; i < CTG_RCU_MAX_READERS; ++i) {
+    int64_t epoch = atomic_load_64(&ctgRcuReaders[i].reader.epoch);
+    if (epoch > 0 && epoch < minEpoch) {
+      minEpoch = epoch;
+    }
+  }
+
+  int32_t num = taosArrayGetSize(gCtgMgmt.rcu.retired);
+  int32_t freed = 0;
+  for (; freed < num; ++freed) {
+    SCtgRcuRetired *pRetired = taosArrayGet(gCtgMgmt.rcu.retired, freed);
+    if (pRetired->epoch >= minEpoch) {
+      break;
+    }
+
+    (*pRetired->freeFp)(pRetired->p);
+  }
+
+  if (freed > 0) {
+    taosArrayPopFrontBatch(gCtgMgmt.rcu.retired, freed);
+  }
+
+  taosThreadMutexUnlock(&gCtgMgmt.rcu.lock);
+}
+
+static void ctgRcuCountHit(bool meta) {
+  SCtgRcuReader *pReader = &ctgRcuReaders[ctgRcuSlot].reader;
+  if (meta) {
+    atomic_add_fetch_64(&pReader->metaHit, 1);
+  } else {
+    atomic_add_fetch_64(&pReader->vgHit, 1);
+  }
+}
+
+void ctgRcuCollectStat(void) {
+  int64_t metaHit = 0, vgHit = 0;
+  for (int32_t i = 0; i < CTG_RCU_MAX_READERS; ++i) {
+    SCtgRcuReader *pReader = &ctgRcuReaders[i].reader;
+    if (atomic_load_64(&pReader->metaHit) > 0) {
+      metaHit += atomic_exchange_64(&pReader->metaHit, 0);
+    }
+    if (atomic_load_64(&pReader->vgHit) > 0) {
+      vgHit += atomic_exchange_64(&pReader->vgHit, 0);
+    }
+  }
+
+  if (metaHit > 0) {
+    CTG_CACHE_STAT_INC(numOfMetaHit, metaHit);
+    CTG_CACHE_STAT_INC(numOfMetaSnapHit, metaHit);
+  }
+  if (vgHit > 0) {
+    CTG_CACHE_STAT_INC(numOfVgHit, vgHit);
+    CTG_CACHE_STAT_INC(numOfVgSnapHit, vgHit);
+  }
+}
+
+int32_t ctgRcuInit(void) {
+  gCtgMgmt.rcu.epoch = 1;
+  gCtgMgmt.rcu.retired = taosArrayInit(CTG_RCU_RECLAIM_BATCH, sizeof(SCtgRcuRetired));
+  if (NULL == gCtgMgmt.rcu.retired) {
+    qError("taosArrayInit %d rcu retired list failed", CTG_RCU_RECLAIM_BATCH);
+    CTG_ERR_RET(TSDB_CODE_OUT_OF_MEMORY);
+  }
+
+  if (taosThreadMutexInit(&gCtgMgmt.rcu.lock, NULL)) {
+    taosArrayDestroy(gCtgMgmt.rcu.retired);
+    gCtgMgmt.rcu.retired = NULL;
+    CTG_ERR_RET(TAOS_SYSTEM_ERROR(errno));
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+void ctgRcuCleanup(void) {
+  if (NULL == gCtgMgmt.rcu.retired) {
+    return;
+  }
+
+  ctgRcuCollectStat();
+
+  int32_t num = taosArrayGetSize(gCtgMgmt.rcu.retired);
+  for (int32_t i = 0; i < num; ++i) {
+    SCtgRcuRetired *pRetired = taosArrayGet(gCtgMgmt.rcu.retired, i);
+    (*pRetired->freeFp)(pRetired->p);
+  }
+
+  taosArrayDestroy(gCtgMgmt.rcu.retired);
+  gCtgMgmt.rcu.retired = NULL;
+  taosThreadMutexDestroy(&gCtgMgmt.rcu.lock);
+}
+
+static void ctgRcuFreeNode(void *p) {
+  SCtgRcuNode *pNode = p;
+  if (pNode->freeFp) {
+    (*pNode->freeFp)(pNode->pData);
+  }
+
+  taosMemoryFree(pNode);
+}
+
+static void ctgRcuFreeTable(void *p) {
+  SCtgRcuTable *pTable = p;
+  taosMemoryFree(pTable->buckets);
+  taosMemoryFree(pTable);
+}
+
+// free the nodes of an unpublished table, the data is still owned by the published nodes
+static void ctgRcuDropTable(SCtgRcuTable *pTable) {
+  for (int32_t i = 0; i < pTable->bucketNum; ++i) {
+    SCtgRcuNode *pNode = pTable->buckets[i];
+    while (pNode) {
+      SCtgRcuNode *pNext = pNode->next;
+      taosMemoryFree(pNode);
+      pNode = pNext;
+    }
+  }
+
+  ctgRcuFreeTable(pTable);
+}
+
+static uint32_t ctgRcuHashVal(const void *key, int32_t keyLen) {
+  return (*taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY))(key, keyLen);
+}
+
+static SCtgRcuTable *ctgRcuNewTable(int32_t bucketNum) {
+  SCtgRcuTable *pTable = taosMemoryCalloc(1, sizeof(SCtgRcuTable));
+  if (NULL == pTable) {
+    return NULL;
+  }
+
+  pTable->buckets = taosMemoryCalloc(bucketNum, POINTER_BYTES);
+  if (NULL == pTable->buckets) {
+    taosMemoryFree(pTable);
+    return NULL;
+  }
+
+  pTable->bucketNum = bucketNum;
+
+  return pTable;
+}
+
+void *ctgRcuHashGet(SCtgRcuHash *pHash, const void *key, int32_t keyLen) {
+  SCtgRcuTable *pTable = atomic_load_ptr(&pHash->pTable);
+  if (NULL == pTable) {
+    return NULL;
+  }
+
+  uint32_t     hashVal = ctgRcuHashVal(key, keyLen);
+  SCtgRcuNode *pNode = atomic_load_ptr(&pTable->buckets[hashVal % pTable->bucketNum]);
+  while (pNode) {
+    if (pNode->hashVal == hashVal && pNode->keyLen == keyLen && 0 == memcmp(pNode->key, key, keyLen)) {
+      return pNode->pData;
+    }
+
+    pNode = atomic_load_ptr(&pNode->next);
+  }
+
+  return NULL;
+}
+
+// Readers may be walking the old table, so the nodes are copied instead of relinked. The copies take over the data.
+static void ctgRcuHashResize(SCtgRcuHash *pHash) {
+  SCtgRcuTable *pOld = pHash->pTable;
+  SCtgRcuTable *pNew = ctgRcuNewTable(pOld->bucketNum * 2);
+  if (NULL == pNew) {
+    return;
+  }
+
+  for (int32_t i = 0; i < pOld->bucketNum; ++i) {
+    for (SCtgRcuNode *pNode = pOld->buckets[i]; pNode; pNode = pNode->next) {
+      SCtgRcuNode *pCopy = taosMemoryMalloc(sizeof(SCtgRcuNode) + pNode->keyLen);
+      if (NULL == pCopy) {
+        ctgRcuDropTable(pNew);
+        return;
+      }
+
+      memcpy(pCopy, pNode, sizeof(SCtgRcuNode) + pNode->keyLen);
+      int32_t idx = pCopy->hashVal % pNew->bucketNum;
+      pCopy->next = pNew->buckets[idx];
+      pNew->buckets[idx] = pCopy;
+    }
+  }
+
+  atomic_store_ptr(&pHash->pTable, pNew);
+
+  for (int32_t i = 0; i < pOld->bucketNum; ++i) {
+    SCtgRcuNode *pNode = pOld->buckets[i];
+    while (pNode) {
+      SCtgRcuNode *pNext = pNode->next;
+      pNode->freeFp = NULL;
+      ctgRcuRetire(pNode, ctgRcuFreeNode);
+      pNode = pNext;
+    }
+  }
+
+  ctgRcuRetire(pOld, ctgRcuFreeTable);
+}
+
+static int32_t ctgRcuHashPut(SCtgRcuHash *pHash, const void *key, int32_t keyLen, void *pData) {
+  if (NULL == pHash->pTable) {
+    SCtgRcuTable *pTable = ctgRcuNewTable(CTG_RCU_INIT_BUCKETS);
+    if (NULL == pTable) {
+      (*pHash->freeFp)(pData);
+      CTG_ERR_RET(TSDB_CODE_OUT_OF_MEMORY);
+    }
+
+    atomic_store_ptr(&pHash->pTable, pTable);
+  }
+
+  SCtgRcuNode *pNew = taosMemoryMalloc(sizeof(SCtgRcuNode) + keyLen);
+  if (NULL == pNew) {
+    (*pHash->freeFp)(pData);
+    CTG_ERR_RET(TSDB_CODE_OUT_OF_MEMORY);
+  }
+
+  pNew->freeFp = pHash->freeFp;
+  pNew->pData = pData;
+  pNew->hashVal = ctgRcuHashVal(key, keyLen);
+  pNew->keyLen = keyLen;
+  memcpy(pNew->key, key, keyLen);
+
+  SCtgRcuTable *pTable = pHash->pTable;
+  SCtgRcuNode **ppLink = &pTable->buckets[pNew->hashVal % pTable->bucketNum];
+  while (*ppLink) {
+    SCtgRcuNode *pNode = *ppLink;
+    if (pNode->hashVal == pNew->hashVal && pNode->keyLen == keyLen && 0 == memcmp(pNode->key, key, keyLen)) {
+      pNew->next = pNode->next;
+      atomic_store_ptr(ppLink, pNew);
+      ctgRcuRetire(pNode, ctgRcuFreeNode);
+      return TSDB_CODE_SUCCESS;
+    }
+
+    ppLink = &pNode->next;
+  }
+
+  pNew->next = pTable->buckets[pNew->hashVal % pTable->bucketNum];
+  atomic_store_ptr(&pTable->buckets[pNew->hashVal % pTable->bucketNum], pNew);
+
+  if (++pHash->size > pTable->bucketNum * 2) {
+    ctgRcuHashResize(pHash);
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+// remove the nodes whose key starts with the given prefix, or equals it when exact is set
+static void ctgRcuHashRemoveImpl(SCtgRcuHash *pHash, const void *key, int32_t keyLen, bool exact) {
+  SCtgRcuTable *pTable = pHash->pTable;
+  if (NULL == pTable) {
+    return;
+  }
+
+  int32_t begin = 0, end = pTable->bucketNum;
+  if (exact) {
+    begin = ctgRcuHashVal(key, keyLen) % pTable->bucketNum;
+    end = begin + 1;
+  }
+
+  for (int32_t i = begin; i < end; ++i) {
+    SCtgRcuNode **ppLink = &pTable->buckets[i];
+    while (*ppLink) {
+      SCtgRcuNode *pNode = *ppLink;
+      if ((exact ? pNode->keyLen == keyLen : pNode->keyLen >= keyLen) && 0 == memcmp(pNode->key, key, keyLen)) {
+        atomic_store_ptr(ppLink, pNode->next);
+        --pHash->size;
+        ctgRcuRetire(pNode, ctgRcuFreeNode);
+        continue;
+      }
+
+      ppLink = &pNode->next;
+    }
+  }
+}
+
+static void ctgRcuHashClear(SCtgRcuHash *pHash) {
+  SCtgRcuTable *pTable = pHash->pTable;
+  if (NULL == pTable) {
+    return;
+  }
+
+  atomic_store_ptr(&pHash->pTable, NULL);
+  pHash->size = 0;
+
+  for (int32_t i = 0; i < pTable->bucketNum; ++i) {
+    SCtgRcuNode *pNode = pTable->buckets[i];
+    while (pNode) {
+      SCtgRcuNode *pNext = pNode->next;
+      ctgRcuRetire(pNode, ctgRcuFreeNode);
+      pNode = pNext;
+    }
+  }
+
+  ctgRcuRetire(pTable, ctgRcuFreeTable);
+}
+
+static void ctgRcuFreeVgSnap(void *p) {
+  SCtgVgSnap *pSnap = p;
+  if (NULL == pSnap) {
+    return;
+  }
+
+  taosArrayDestroy(pSnap->vgArray);
+  taosMemoryFree(pSnap);
+}
+
+void ctgRcuInitSnapshot(SCatalog *pCtg) {
+  pCtg->tbSnap.freeFp = taosMemoryFree;
+  pCtg->stbSnap.freeFp = taosMemoryFree;
+  pCtg->vgSnap.freeFp = ctgRcuFreeVgSnap;
+}
+
+// A reader that looked the handle up before it was dropped may still be walking the snapshot, so the nodes are retired
+// like any other unlinked node instead of being freed here. They own their data and do not refer to the handle.
+void ctgRcuDestroySnapshot(SCatalog *pCtg) {
+  ctgRcuHashClear(&pCtg->tbSnap);
+  ctgRcuHashClear(&pCtg->stbSnap);
+  ctgRcuHashClear(&pCtg->vgSnap);
+}
+
+void ctgRcuClearSnapshot(SCatalog *pCtg) {
+  ctgRcuHashClear(&pCtg->tbSnap);
+  ctgRcuHashClear(&pCtg->stbSnap);
+  ctgRcuHashClear(&pCtg->vgSnap);
+}
+
+static int32_t ctgRcuTbKey(char *key, const char *dbFName, const char *tbName) {
+  return snprintf(key, TSDB_TABLE_FNAME_LEN, "%s.%s", dbFName, tbName);
+}
+
+static int32_t ctgRcuStbKey(char *key, const char *dbFName, uint64_t suid) {
+  int32_t len = strlen(dbFName) + 1;
+  memcpy(key, dbFName, len);
+  memcpy(key + len, &suid, sizeof(suid));
+  return len + sizeof(suid);
+}
+
+void ctgRcuPublishTbMeta(SCatalog *pCtg, const char *dbFName, uint64_t dbId, const char *tbName,
+                         const STableMeta *pMeta) {
+  if (IS_SYS_DBNAME(dbFName)) {
+    return;
+  }
+
+  char    key[TSDB_TABLE_FNAME_LEN];
+  int32_t keyLen = ctgRcuTbKey(key, dbFName, tbName);
+  int64_t metaSize = (TSDB_CHILD_TABLE == pMeta->tableType) ? sizeof(SCTableMeta) : CTG_META_SIZE(pMeta);
+
+  SCtgTbSnap *pSnap = taosMemoryMalloc(sizeof(SCtgTbSnap) + metaSize);
+  if (NULL == pSnap) {
+    ctgRcuHashRemoveImpl(&pCtg->tbSnap, key, keyLen, true);
+    return;
+  }
+
+  pSnap->dbId = dbId;
+  pSnap->metaSize = metaSize;
+  memcpy(pSnap->meta, pMeta, metaSize);
+
+  if (ctgRcuHashPut(&pCtg->tbSnap, key, keyLen, pSnap)) {
+    ctgRcuHashRemoveImpl(&pCtg->tbSnap, key, keyLen, true);
+    return;
+  }
+
+  if (TSDB_SUPER_TABLE != pMeta->tableType) {
+    return;
+  }
+
+  char   *stbName = taosStrdup(tbName);
+  char    stbKey[TSDB_DB_FNAME_LEN + sizeof(uint64_t)];
+  int32_t stbKeyLen = ctgRcuStbKey(stbKey, dbFName, pMeta->suid);
+  if (NULL == stbName || ctgRcuHashPut(&pCtg->stbSnap, stbKey, stbKeyLen, stbName)) {
+    ctgRcuHashRemoveImpl(&pCtg->stbSnap, stbKey, stbKeyLen, true);
+  }
+}
+
+void ctgRcuRemoveTbMeta(SCatalog *pCtg, const char *dbFName, const char *tbName) {
+  char    key[TSDB_TABLE_FNAME_LEN];
+  int32_t keyLen = ctgRcuTbKey(key, dbFName, tbName);
+  ctgRcuHashRemoveImpl(&pCtg->tbSnap, key, keyLen, true);
+}
+
+void ctgRcuRemoveStb(SCatalog *pCtg, const char *dbFName, uint64_t suid) {
+  char    key[TSDB_DB_FNAME_LEN + sizeof(uint64_t)];
+  int32_t keyLen = ctgRcuStbKey(key, dbFName, suid);
+  ctgRcuHashRemoveImpl(&pCtg->stbSnap, key, keyLen, true);
+}
+
+void ctgRcuPublishVgInfo(SCatalog *pCtg, const char *dbFName, uint64_t dbId, SDBVgInfo *pVgInfo) {
+  if (IS_SYS_DBNAME(dbFName)) {
+    return;
+  }
+
+  int32_t keyLen = strlen(dbFName);
+
+  SCtgVgSnap *pSnap = taosMemoryCalloc(1, sizeof(SCtgVgSnap));
+  if (NULL == pSnap || ctgMakeVgArray(pVgInfo) || NULL == pVgInfo->vgArray) {
+    taosMemoryFree(pSnap);
+    ctgRcuHashRemoveImpl(&pCtg->vgSnap, dbFName, keyLen, true);
+    return;
+  }
+
+  pSnap->dbId = dbId;
+  pSnap->vgVersion = pVgInfo->vgVersion;
+  pSnap->hashMethod = pVgInfo->hashMethod;
+  pSnap->hashPrefix = pVgInfo->hashPrefix;
+  pSnap->hashSuffix = pVgInfo->hashSuffix;
+  pSnap->vgArray = taosArrayDup(pVgInfo->vgArray, NULL);
+  if (NULL == pSnap->vgArray || ctgRcuHashPut(&pCtg->vgSnap, dbFName, keyLen, pSnap)) {
+    if (NULL == pSnap->vgArray) {
+      taosMemoryFree(pSnap);
+    }
+    ctgRcuHashRemoveImpl(&pCtg->vgSnap, dbFName, keyLen, true);
+  }
+}
+
+void ctgRcuRemoveVgInfo(SCatalog *pCtg, const char *dbFName) {
+  ctgRcuHashRemoveImpl(&pCtg->vgSnap, dbFName, strlen(dbFName), true);
+}
+
+void ctgRcuRemoveDb(SCatalog *pCtg, const char *dbFName) {
+  char    prefix[TSDB_DB_FNAME_LEN + 1];
+  int32_t len = snprintf(prefix, sizeof(prefix), "%s.", dbFName);
+
+  ctgRcuHashRemoveImpl(&pCtg->tbSnap, prefix, len, false);
+  prefix[len - 1] = 0;
+  ctgRcuHashRemoveImpl(&pCtg->stbSnap, prefix, len, false);
+  ctgRcuHashRemoveImpl(&pCtg->vgSnap, prefix, len - 1, true);
+}
+
+static STableMeta *ctgRcuCopyTbMeta(SCatalog *pCtg, const char *dbFName, SCtgTbSnap *pSnap) {
+  STableMeta *tbMeta = (STableMeta *)pSnap->meta;
+  if (TSDB_CHILD_TABLE != tbMeta->tableType) {
+    STableMeta *pMeta = taosMemoryMalloc(pSnap->metaSize);
+    if (pMeta) {
+      memcpy(pMeta, tbMeta, pSnap->metaSize);
+    }
+    return pMeta;
+  }
+
+  char  stbKey[TSDB_DB_FNAME_LEN + sizeof(uint64_t)];
+  char *stbName = ctgRcuHashGet(&pCtg->stbSnap, stbKey, ctgRcuStbKey(stbKey, dbFName, tbMeta->suid));
+  if (NULL == stbName) {
+    return NULL;
+  }
+
+  char        key[TSDB_TABLE_FNAME_LEN];
+  SCtgTbSnap *pStbSnap = ctgRcuHashGet(&pCtg->tbSnap, key, ctgRcuTbKey(key, dbFName, stbName));
+  if (NULL == pStbSnap || pStbSnap->dbId != pSnap->dbId) {
+    return NULL;
+  }
+
+  STableMeta *stbMeta = (STableMeta *)pStbSnap->meta;
+  if (stbMeta->suid != tbMeta->suid) {
+    return NULL;
+  }
+
+  STableMeta *pMeta = taosMemoryMalloc(pStbSnap->metaSize);
+  if (pMeta) {
+    memcpy(pMeta, tbMeta, sizeof(SCTableMeta));
+    memcpy(&pMeta->sversion, &stbMeta->sversion, pStbSnap->metaSize - sizeof(SCTableMeta));
+  }
+
+  return pMeta;
+}
+
+bool ctgRcuReadTbMeta(SCatalog *pCtg, SCtgTbMetaCtx *ctx, const char *dbFName, STableMeta **pTableMeta) {
+  if (CTG_FLAG_IS_SYS_DB(ctx->flag) || !ctgRcuReadLock()) {
+    return false;
+  }
+
+  char        key[TSDB_TABLE_FNAME_LEN];
+  SCtgTbSnap *pSnap = ctgRcuHashGet(&pCtg->tbSnap, key, ctgRcuTbKey(key, dbFName, ctx->pName->tname));
+  STableMeta *pMeta = pSnap ? ctgRcuCopyTbMeta(pCtg, dbFName, pSnap) : NULL;
+  if (pMeta) {
+    STableMeta *tbMeta = (STableMeta *)pSnap->meta;
+    ctx->tbInfo.inCache = true;
+    ctx->tbInfo.dbId = pSnap->dbId;
+    ctx->tbInfo.suid = tbMeta->suid;
+    ctx->tbInfo.tbType = tbMeta->tableType;
+  }
+
+  if (pMeta) {
+    ctgRcuCountHit(true);
+  }
+
+  ctgRcuReadUnlock();
+
+  if (NULL == pMeta) {
+    return false;
+  }
+
+  *pTableMeta = pMeta;
+  ctgDebug("Got tb %s meta from snapshot, type:%d, dbFName:%s", ctx->pName->tname, pMeta->tableType, dbFName);
+
+  return true;
+}
+
+bool ctgRcuReadTbVer(SCatalog *pCtg, const char *dbFName, const char *tbName, int32_t *sver, int32_t *tver,
+                     int32_t *tbType, uint64_t *uid, uint64_t *suid, char *stbName) {
+  if (!ctgRcuReadLock()) {
+    return false;
+  }
+
+  bool        found = false;
+  char        key[TSDB_TABLE_FNAME_LEN];
+  SCtgTbSnap *pSnap = ctgRcuHashGet(&pCtg->tbSnap, key, ctgRcuTbKey(key, dbFName, tbName));
+  if (NULL == pSnap) {
+    goto _return;
+  }
+
+  STableMeta *tbMeta = (STableMeta *)pSnap->meta;
+  if (TSDB_CHILD_TABLE != tbMeta->tableType) {
+    *sver = tbMeta->sversion;
+    *tver = tbMeta->tversion;
+  } else {
+    char  stbKey[TSDB_DB_FNAME_LEN + sizeof(uint64_t)];
+    char *name = ctgRcuHashGet(&pCtg->stbSnap, stbKey, ctgRcuStbKey(stbKey, dbFName, tbMeta->suid));
+    if (NULL == name) {
+      goto _return;
+    }
+
+    SCtgTbSnap *pStbSnap = ctgRcuHashGet(&pCtg->tbSnap, key, ctgRcuTbKey(key, dbFName, name));
+    if (NULL == pStbSnap || pStbSnap->dbId != pSnap->dbId || ((STableMeta *)pStbSnap->meta)->suid != tbMeta->suid) {
+      goto _return;
+    }
+
+    tstrncpy(stbName, name, TSDB_TABLE_NAME_LEN);
+    *sver = ((STableMeta *)pStbSnap->meta)->sversion;
+    *tver = ((STableMeta *)pStbSnap->meta)->tversion;
+  }
+
+  *tbType = tbMeta->tableType;
+  *uid = tbMeta->uid;
+  *suid = tbMeta->suid;
+  found = true;
+  ctgRcuCountHit(true);
+
+_return:
+
+  ctgRcuReadUnlock();
+
+  return found;
+}
+
+bool ctgRcuGetTbHashVgroup(SCatalog *pCtg, const char *dbFName, const SName *pTableName, SVgroupInfo *pVgroup) {
+  if (!ctgRcuReadLock()) {
+    return false;
+  }
+
+  bool        found = false;
+  SCtgVgSnap *pSnap = ctgRcuHashGet(&pCtg->vgSnap, dbFName, strlen(dbFName));
+  if (pSnap && taosArrayGetSize(pSnap->vgArray) > 0) {
+    char tbFullName[TSDB_TABLE_FNAME_LEN];
+    tNameExtractFullName(pTableName, tbFullName);
+
+    uint32_t hashValue = taosGetTbHashVal(tbFullName, (uint32_t)strlen(tbFullName), pSnap->hashMethod,
+                                          pSnap->hashPrefix, pSnap->hashSuffix);
+
+    SVgroupInfo *vgInfo = taosArraySearch(pSnap->vgArray, &hashValue, ctgHashValueComp, TD_EQ);
+    if (vgInfo) {
+      *pVgroup = *vgInfo;
+      found = true;
+      ctgRcuCountHit(false);
+    }
+  }
+
+  ctgRcuReadUnlock();
+
+  return found;
+}
+
+bool ctgRcuGetVgEpSet(SCatalog *pCtg, const char *dbFName, int32_t vgId, SEpSet *pEpSet) {
+  if (!ctgRcuReadLock()) {
+    return false;
+  }
+
+  bool        found = false;
+  SCtgVgSnap *pSnap = ctgRcuHashGet(&pCtg->vgSnap, dbFName, strlen(dbFName));
+  if (pSnap) {
+    int32_t vgNum = taosArrayGetSize(pSnap->vgArray);
+    for (int32_t i = 0; i < vgNum; ++i) {
+      SVgroupInfo *vgInfo = taosArrayGet(pSnap->vgArray, i);
+      if (vgInfo->vgId == vgId) {
+        *pEpSet = vgInfo->epSet;
+        found = true;
+        ctgRcuCountHit(false);
+        break;
+      }
+    }
+  }
+
+  ctgRcuReadUnlock();
+
+  return found;
+}
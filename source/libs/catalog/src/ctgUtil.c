@@ -285,6 +285,7 @@ void ctgFreeInstUserCache(SHashObj* pUserCache) {
 }
 
 void ctgFreeHandleImpl(SCatalog* pCtg) {
+  ctgRcuDestroySnapshot(pCtg);
   ctgFreeMetaRent(&pCtg->dbRent);
   ctgFreeMetaRent(&pCtg->stbRent);
 
@@ -301,6 +302,7 @@ void ctgFreeHandle(SCatalog* pCtg) {
 
   uint64_t clusterId = pCtg->clusterId;
 
+  ctgRcuDestroySnapshot(pCtg);
   ctgFreeMetaRent(&pCtg->dbRent);
   ctgFreeMetaRent(&pCtg->stbRent);
 
@@ -321,6 +323,7 @@ void ctgClearHandle(SCatalog* pCtg) {
 
   uint64_t clusterId = pCtg->clusterId;
 
+  ctgRcuClearSnapshot(pCtg);
   ctgFreeMetaRent(&pCtg->dbRent);
   ctgFreeMetaRent(&pCtg->stbRent);
 
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Child table meta reads per second of the lock free snapshot path against the latched cache path, while a writer
+// keeps replacing the super table meta. Built with -DBUILD_TEST=ON -DBUILD_BENCHMARK=ON, run as
+//   catalogBench [seconds per run]
+
+#include "catalog.h"
+#include "catalogInt.h"
+#include "os.h"
+#include "tglobal.h"
+#include "tname.h"
+
+extern "C" int32_t ctgAcquireTbMetaFromCache(SCatalog *pCtg, char *dbFName, char *tbName, SCtgDBCache **pDb,
+                                             SCtgTbCache **pTb);
+
+namespace {
+
+const char    *benchDb = "db1";
+const char    *benchSTable = "stb1";
+const char    *benchCTable = "ctb1";
+const uint64_t benchClusterId = 0x1;
+const int32_t  benchColNum = 2;
+const int32_t  benchTagNum = 1;
+
+SCatalog *pBenchCtg = NULL;
+bool      benchStop = false;
+bool      benchLatched = false;
+int64_t   benchReadNum = 0;
+
+STableMetaOutput *benchBuildMetaOutput(int32_t sversion) {
+  STableMetaOutput *output = (STableMetaOutput *)taosMemoryCalloc(1, sizeof(STableMetaOutput));
+  snprintf(output->dbFName, sizeof(output->dbFName), "1.%s", benchDb);
+  SET_META_TYPE_BOTH_TABLE(output->metaType);
+  strcpy(output->ctbName, benchCTable);
+  strcpy(output->tbName, benchSTable);
+
+  output->ctbMeta.vgId = 9;
+  output->ctbMeta.tableType = TSDB_CHILD_TABLE;
+  output->ctbMeta.uid = 3;
+  output->ctbMeta.suid = 2;
+
+  int32_t numOfSchema = benchColNum + benchTagNum;
+  output->tbMeta = (STableMeta *)taosMemoryCalloc(1, sizeof(STableMeta) + sizeof(SSchema) * numOfSchema);
+  output->tbMeta->vgId = 9;
+  output->tbMeta->tableType = TSDB_SUPER_TABLE;
+  output->tbMeta->uid = 2;
+  output->tbMeta->suid = 2;
+  output->tbMeta->tableInfo.numOfColumns = benchColNum;
+  output->tbMeta->tableInfo.numOfTags = benchTagNum;
+  output->tbMeta->tableInfo.precision = 1;
+  output->tbMeta->tableInfo.rowSize = 12;
+  output->tbMeta->sversion = sversion;
+  output->tbMeta->tversion = 1;
+
+  SSchema *s = &output->tbMeta->schema[0];
+  s->type = TSDB_DATA_TYPE_TIMESTAMP;
+  s->colId = 1;
+  s->bytes = 8;
+  strcpy(s->name, "ts");
+
+  s = &output->tbMeta->schema[1];
+  s->type = TSDB_DATA_TYPE_INT;
+  s->colId = 2;
+  s->bytes = 4;
+  strcpy(s->name, "col1");
+
+  s = &output->tbMeta->schema[2];
+  s->type = TSDB_DATA_TYPE_BINARY;
+  s->colId = 3;
+  s->bytes = 12;
+  strcpy(s->name, "tag1");
+  return output;
+}
+
+void benchUpdateMeta(int32_t sversion) {
+  SCtgUpdateTbMetaMsg *msg = (SCtgUpdateTbMetaMsg *)taosMemoryMalloc(sizeof(SCtgUpdateTbMetaMsg));
+  msg->pCtg = pBenchCtg;
+  msg->pMeta = benchBuildMetaOutput(sversion);
+
+  SCtgCacheOperation operation = {0};
+  operation.opId = CTG_OP_UPDATE_TB_META;
+  operation.data = msg;
+  if (ctgOpUpdateTbMeta(&operation)) {
+    printf("failed to update table meta\n");
+    exit(1);
+  }
+}
+
+// the latched path of ctgReadTbMetaFromCache, without trying the snapshot first
+int32_t benchReadLatched(SCtgTbMetaCtx *ctx, char *dbFName, STableMeta **pTableMeta) {
+  SCtgDBCache *dbCache = NULL;
+  SCtgTbCache *tbCache = NULL;
+  *pTableMeta = NULL;
+
+  ctgAcquireTbMetaFromCache(pBenchCtg, dbFName, ctx->pName->tname, &dbCache, &tbCache);
+  int32_t code = (NULL != tbCache) ? ctgCopyTbMeta(pBenchCtg, ctx, &dbCache, &tbCache, pTableMeta, dbFName) : 0;
+  ctgReleaseTbMetaToCache(pBenchCtg, dbCache, tbCache);
+  return code;
+}
+
+void *benchReadThread(void *param) {
+  SName cn = {TSDB_TABLE_NAME_T, 1, {0}, {0}};
+  strcpy(cn.dbname, benchDb);
+  strcpy(cn.tname, benchCTable);
+
+  char dbFName[TSDB_DB_FNAME_LEN] = {0};
+  tNameGetFullDbName(&cn, dbFName);
+
+  SCtgTbMetaCtx ctx = {0};
+  ctx.pName = &cn;
+  ctx.flag = CTG_FLAG_UNKNOWN_STB;
+
+  int64_t n = 0;
+  while (!atomic_load_8((int8_t *)&benchStop)) {
+    STableMeta *tbMeta = NULL;
+    int32_t     code = benchLatched ? benchReadLatched(&ctx, dbFName, &tbMeta)
+                                    : ctgReadTbMetaFromCache(pBenchCtg, &ctx, &tbMeta);
+    if (code) {
+      printf("failed to read table meta, code:%s\n", tstrerror(code));
+      exit(1);
+    }
+    taosMemoryFreeClear(tbMeta);
+    ++n;
+  }
+
+  atomic_add_fetch_64(&benchReadNum, n);
+  return NULL;
+}
+
+void *benchWriteThread(void *param) {
+  int32_t sversion = 1;
+  while (!atomic_load_8((int8_t *)&benchStop)) {
+    benchUpdateMeta(++sversion);
+    ctgRcuReclaim();
+    taosUsleep(100);
+  }
+  return NULL;
+}
+
+double benchRun(int32_t readerNum, bool latched, int32_t runSec) {
+  benchStop = false;
+  benchLatched = latched;
+  benchReadNum = 0;
+
+  TdThreadAttr thattr;
+  taosThreadAttrInit(&thattr);
+  taosThreadAttrSetDetachState(&thattr, PTHREAD_CREATE_JOINABLE);
+
+  TdThread *readers = (TdThread *)taosMemoryCalloc(readerNum, sizeof(TdThread));
+  TdThread  writer;
+  int64_t   startTs = taosGetTimestampMs();
+  for (int32_t i = 0; i < readerNum; ++i) {
+    taosThreadCreate(&readers[i], &thattr, benchReadThread, NULL);
+  }
+  taosThreadCreate(&writer, &thattr, benchWriteThread, NULL);
+
+  taosSsleep(runSec);
+  atomic_store_8((int8_t *)&benchStop, 1);
+
+  for (int32_t i = 0; i < readerNum; ++i) {
+    taosThreadJoin(readers[i], NULL);
+  }
+  taosThreadJoin(writer, NULL);
+  int64_t costMs = taosGetTimestampMs() - startTs;
+
+  taosMemoryFree(readers);
+  taosThreadAttrDestroy(&thattr);
+  return (double)benchReadNum * 1000 / costMs;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int32_t runSec = (argc > 1) ? atoi(argv[1]) : 5;
+
+  if (catalogInit(NULL) || catalogGetHandle(benchClusterId, &pBenchCtg)) {
+    printf("failed to init catalog\n");
+    return 1;
+  }
+  benchUpdateMeta(1);
+
+  printf("%8s %16s %16s %8s\n", "readers", "latched reads/s", "snap reads/s", "speedup");
+  const int32_t readerNums[] = {1, 4, 16};
+  for (int32_t i = 0; i < tListLen(readerNums); ++i) {
+    double latched = benchRun(readerNums[i], true, runSec);
+    double snap = benchRun(readerNums[i], false, runSec);
+    printf("%8d %16.0f %16.0f %7.2fx\n", readerNums[i], latched, snap, snap / latched);
+  }
+
+  catalogDestroy();
+  return 0;
+}
@@ -1204,6 +1204,95 @@ void *ctgTestSetCtableMetaThread(void *param) {
   return NULL;
 }
 
+int64_t ctgTestReadNum = 0;
+int32_t ctgTestMaxSVersion = 0;
+int64_t ctgTestReclaimNum = 0;
+
+int32_t ctgTestGetRetiredNum() {
+  taosThreadMutexLock(&gCtgMgmt.rcu.lock);
+  int32_t num = taosArrayGetSize(gCtgMgmt.rcu.retired);
+  taosThreadMutexUnlock(&gCtgMgmt.rcu.lock);
+  return num;
+}
+
+void *ctgTestReadCtableMetaThread(void *param) {
+  struct SCatalog *pCtg = (struct SCatalog *)param;
+  STableMeta      *tbMeta = NULL;
+  int64_t          n = 0;
+
+  SName cn = {TSDB_TABLE_NAME_T, 1, {0}, {0}};
+  strcpy(cn.dbname, "db1");
+  strcpy(cn.tname, ctgTestCTablename);
+
+  SCtgTbMetaCtx ctx = {0};
+  ctx.pName = &cn;
+  ctx.flag = CTG_FLAG_UNKNOWN_STB;
+
+  while (!ctgTestStop) {
+    int32_t code = ctgReadTbMetaFromCache(pCtg, &ctx, &tbMeta);
+    if (code) {
+      assert(0);
+    }
+
+    // stb may be missing for a moment while the writer replaces it, a meta that is found must be one the writer
+    // published and must not have been freed while it was copied
+    if (tbMeta) {
+      if (tbMeta->tableType != TSDB_CHILD_TABLE || tbMeta->suid != ctgTestSuid || tbMeta->uid != 3 ||
+          tbMeta->tableInfo.numOfColumns != ctgTestColNum || tbMeta->tableInfo.numOfTags != ctgTestTagNum) {
+        assert(0);
+      }
+      if (tbMeta->sversion < ctgTestSVersion || tbMeta->sversion > atomic_load_32(&ctgTestMaxSVersion)) {
+        assert(0);
+      }
+      if (strcmp(tbMeta->schema[0].name, "ts") || strcmp(tbMeta->schema[1].name, "col1s") ||
+          strcmp(tbMeta->schema[2].name, "tag1s")) {
+        assert(0);
+      }
+    }
+
+    taosMemoryFreeClear(tbMeta);
+    ++n;
+  }
+
+  atomic_add_fetch_64(&ctgTestReadNum, n);
+
+  return NULL;
+}
+
+void *ctgTestUpdateStableVersionThread(void *param) {
+  struct SCatalog *pCtg = (struct SCatalog *)param;
+  int32_t          sversion = ctgTestSVersion;
+
+  SCtgCacheOperation operation = {0};
+  operation.opId = CTG_OP_UPDATE_TB_META;
+
+  while (!ctgTestStop) {
+    STableMetaOutput *output = (STableMetaOutput *)taosMemoryMalloc(sizeof(STableMetaOutput));
+    ctgTestBuildCTableMetaOutput(output);
+    output->tbMeta->sversion = ++sversion;
+    atomic_store_32(&ctgTestMaxSVersion, sversion);
+
+    SCtgUpdateTbMetaMsg *msg = (SCtgUpdateTbMetaMsg *)taosMemoryMalloc(sizeof(SCtgUpdateTbMetaMsg));
+    msg->pCtg = pCtg;
+    msg->pMeta = output;
+    operation.data = msg;
+
+    if (ctgOpUpdateTbMeta(&operation)) {
+      assert(0);
+    }
+
+    // count the reclaims that freed retired entries while the readers are running
+    int32_t retiredNum = ctgTestGetRetiredNum();
+    ctgRcuReclaim();
+    if (ctgTestGetRetiredNum() < retiredNum) {
+      atomic_add_fetch_64(&ctgTestReclaimNum, 1);
+    }
+    taosUsleep(100);
+  }
+
+  return NULL;
+}
+
 
 void ctgTestFetchRows(TAOS_RES *result, int32_t *rows) {
   TAOS_ROW    row;
@@ -2673,6 +2762,77 @@ TEST(multiThread, ctableMeta) {
   catalogDestroy();
 }
 
+// readers copy the child table meta out of the snapshot while the writer keeps replacing it, retiring the old copies
+// and reclaiming them
+TEST(multiThread, ctableMetaReadDuringReclaim) {
+  struct SCatalog *pCtg = NULL;
+  const int32_t    readerNum = 4;
+  ctgTestStop = false;
+  ctgTestReadNum = 0;
+  ctgTestMaxSVersion = ctgTestSVersion;
+  ctgTestReclaimNum = 0;
+
+  ctgTestInitLogFile();
+
+  ctgTestSetRspDbVgroupsAndChildMeta();
+
+  initQueryModuleMsgHandle();
+
+  int32_t code = catalogInit(NULL);
+  ASSERT_EQ(code, 0);
+
+  code = catalogGetHandle(ctgTestClusterId, &pCtg);
+  ASSERT_EQ(code, 0);
+
+  STableMetaOutput *output = (STableMetaOutput *)taosMemoryMalloc(sizeof(STableMetaOutput));
+  ctgTestBuildCTableMetaOutput(output);
+
+  SCtgUpdateTbMetaMsg *msg = (SCtgUpdateTbMetaMsg *)taosMemoryMalloc(sizeof(SCtgUpdateTbMetaMsg));
+  msg->pCtg = pCtg;
+  msg->pMeta = output;
+
+  SCtgCacheOperation operation = {0};
+  operation.opId = CTG_OP_UPDATE_TB_META;
+  operation.data = msg;
+  code = ctgOpUpdateTbMeta(&operation);
+  ASSERT_EQ(code, 0);
+
+  TdThreadAttr thattr;
+  taosThreadAttrInit(&thattr);
+  taosThreadAttrSetDetachState(&thattr, PTHREAD_CREATE_JOINABLE);
+
+  TdThread readers[readerNum];
+  TdThread writer;
+  for (int32_t i = 0; i < readerNum; ++i) {
+    taosThreadCreate(&readers[i], &thattr, ctgTestReadCtableMetaThread, pCtg);
+  }
+  taosThreadCreate(&writer, &thattr, ctgTestUpdateStableVersionThread, pCtg);
+
+  taosSsleep(ctgTestMTRunSec);
+  ctgTestStop = true;
+
+  for (int32_t i = 0; i < readerNum; ++i) {
+    taosThreadJoin(readers[i], NULL);
+  }
+  taosThreadJoin(writer, NULL);
+
+  ASSERT_GT(ctgTestReadNum, 0);
+  ASSERT_GT(ctgTestReclaimNum, 0);
+
+  // no reader is left, everything retired can be freed now
+  ctgRcuReclaim();
+  ASSERT_EQ(ctgTestGetRetiredNum(), 0);
+
+  uint64_t snapHit = 0;
+  ASSERT_EQ(ctgdGetStatNum("cache.numOfMetaSnapHit", (void *)&snapHit), 0);
+  ASSERT_GT(snapHit, 0);
+  ASSERT_LE(snapHit, (uint64_t)ctgTestReadNum);
+
+  taosThreadAttrDestroy(&thattr);
+
+  catalogDestroy();
+}
+
 TEST(rentTest, allRent) {
   struct SCatalog  *pCtg = NULL;
   SRequestConnInfo connInfo = {0};  
@@ -36,6 +36,7 @@ extern "C" {
 #include "tfill.h"
 #include "thash.h"
 #include "tlockfree.h"
+#include "tmemtracker.h"
 #include "tmsg.h"
 #include "tpagedbuf.h"
 #include "tstream.h"
@@ -186,6 +187,7 @@ struct SExecTaskInfo {
   SLocalFetch           localFetch;
   SArray*               pResultBlockList;  // result block list
   STaskStopInfo         stopInfo;
+  SMemTracker*          pMemTracker;  // memory of this task, child of the tracker of the query on this node
 };
 
 enum {
@@ -237,6 +239,19 @@ typedef enum {
   EX_SOURCE_DATA_EXHAUSTED = 0x3,
 } EX_SOURCE_STATUS;
 
+typedef struct SSourceDataInfo {
+  int32_t            index;
+  SRetrieveTableRsp* pRsp;
+  uint64_t           totalRows;
+  int64_t            startTime;
+  int32_t            code;
+  EX_SOURCE_STATUS   status;
+  const char*        taskId;
+  SArray*            pRspList;  // SRetrieveTableRsp*, received but not taken by the downstream yet
+  bool               inflight;  // a fetch msg is sent and not responded yet
+  bool               rspEnd;    // the last rsp received is the end of the source
+} SSourceDataInfo;
+
 #define COL_MATCH_FROM_COL_ID  0x1
 #define COL_MATCH_FROM_SLOT_ID 0x2
 
@@ -273,6 +288,12 @@ typedef struct SExchangeInfo {
   uint64_t            self;
   SLimitInfo          limitInfo;
   int64_t             openedTs;  // start exec time stamp, todo: move to SLoadRemoteDataInfo
+  uint64_t            queryId;
+  int32_t             fetchWindow;    // max rsps of a source received ahead of the downstream
+  int64_t             bufferSize;     // max bytes of the rsps received ahead of the downstream
+  int64_t             bufferedBytes;  // bytes of the rsps received and not taken by the downstream yet
+  bool                fetchStopped;   // the downstream needs no more rsps, nothing is fetched ahead then
+  TdThreadMutex       lock;           // protects the received rsps of the sources
 } SExchangeInfo;
 
 typedef struct SScanInfo {
@@ -290,8 +311,15 @@ enum {
   TABLE_SCAN__BLOCK_ORDER = 2,
 };
 
+// memory of an operator hash table that can not be spilled, charged to the tracker of the task creating it
+typedef struct SHashMemCharge {
+  SMemTracker* pTracker;
+  int64_t      charged;
+} SHashMemCharge;
+
 typedef struct SAggSupporter {
   SSHashObj*     pResultRowHashTable;  // quick locate the window object for each result
+  SHashMemCharge hashMem;              // charge of pResultRowHashTable
   char*          keyBuf;               // window key buffer
   SDiskbasedBuf* pResultBuf;           // query result buffer based on blocked-wised disk file
   int32_t        resultRowSize;  // the result buffer size for each result row, with the meta data size for each row
@@ -710,6 +738,10 @@ int32_t initAggSup(SExprSupp* pSup, SAggSupporter* pAggSup, SExprInfo* pExprInfo
                    const char* pkey, void* pState);
 void    cleanupAggSup(SAggSupporter* pAggSup);
 
+void initHashMemCharge(SHashMemCharge* pCharge);
+void updateHashMemCharge(SHashMemCharge* pCharge, int64_t memSize);
+void cleanupHashMemCharge(SHashMemCharge* pCharge);
+
 void initResultSizeInfo(SResultInfo* pResultInfo, int32_t numOfRows);
 
 void doBuildStreamResBlock(SOperatorInfo* pOperator, SOptrBasicInfo* pbInfo, SGroupResInfo* pGroupResInfo,
@@ -737,7 +769,13 @@ int32_t getBufferPgSize(int32_t rowSize, uint32_t* defaultPgsz, uint32_t* defaul
 
 extern void doDestroyExchangeOperatorInfo(void* param);
 
+int32_t initDataSource(int32_t numOfSources, SExchangeInfo* pInfo, const char* id);
+bool    addSourceRsp(SExchangeInfo* pExchangeInfo, int32_t sourceIndex, SRetrieveTableRsp* pRsp, int32_t code);
+bool    takeSourceRsp(SExchangeInfo* pExchangeInfo, SSourceDataInfo* pDataInfo);
+bool    needFetchSource(SExchangeInfo* pExchangeInfo, int32_t sourceIndex);
+
 void    doFilter(SSDataBlock* pBlock, SFilterInfo* pFilterInfo, SColMatchInfo* pColMatchInfo);
+void    extractQualifiedTupleByFilterResult(SSDataBlock* pBlock, const SColumnInfoData* p, bool keep, int32_t status);
 int32_t addTagPseudoColumnData(SReadHandle* pHandle, const SExprInfo* pExpr, int32_t numOfExpr, SSDataBlock* pBlock,
                                int32_t rows, const char* idStr, STableMetaCacheInfo* pCache);
 
@@ -806,6 +844,8 @@ SOperatorInfo* createTimeSliceOperatorInfo(SOperatorInfo* downstream, SPhysiNode
 
 SOperatorInfo* createMergeJoinOperatorInfo(SOperatorInfo** pDownstream, int32_t numOfDownstream, SSortMergeJoinPhysiNode* pJoinNode, SExecTaskInfo* pTaskInfo);
 
+SOperatorInfo* createHashJoinOperatorInfo(SOperatorInfo** pDownstream, int32_t numOfDownstream, SHashJoinPhysiNode* pJoinNode, SExecTaskInfo* pTaskInfo);
+
 SOperatorInfo* createStreamSessionAggOperatorInfo(SOperatorInfo* downstream, SPhysiNode* pPhyNode, SExecTaskInfo* pTaskInfo);
 
 SOperatorInfo* createStreamFinalSessionAggOperatorInfo(SOperatorInfo* downstream, SPhysiNode* pPhyNode, SExecTaskInfo* pTaskInfo, int32_t numOfChild);
@@ -75,6 +75,7 @@ typedef struct SFillInfo {
 
   SFillColInfo*    pFillCol;  // column info for fill operations
   SFillTagColInfo* pTags;     // tags value for filling gap
+  int64_t*         pKeyBuf;   // keys of the rows being filled
   const char*      id;
 } SFillInfo;
 
@@ -23,6 +23,7 @@
 #include "executorimpl.h"
 #include "index.h"
 #include "query.h"
+#include "tglobal.h"
 #include "thash.h"
 
 typedef struct SFetchRspHandleWrapper {
@@ -30,23 +31,16 @@ typedef struct SFetchRspHandleWrapper {
   int32_t  sourceIndex;
 } SFetchRspHandleWrapper;
 
-typedef struct SSourceDataInfo {
-  int32_t            index;
-  SRetrieveTableRsp* pRsp;
-  uint64_t           totalRows;
-  int64_t            startTime;
-  int32_t            code;
-  EX_SOURCE_STATUS   status;
-  const char*        taskId;
-} SSourceDataInfo;
-
 static void  destroyExchangeOperatorInfo(void* param);
 static void  freeBlock(void* pParam);
 static void  freeSourceDataInfo(void* param);
 static void* setAllSourcesCompleted(SOperatorInfo* pOperator);
+static void  stopFetchSources(SExchangeInfo* pExchangeInfo);
 
 static int32_t loadRemoteDataCallback(void* param, SDataBuf* pMsg, int32_t code);
 static int32_t doSendFetchDataRequest(SExchangeInfo* pExchangeInfo, SExecTaskInfo* pTaskInfo, int32_t sourceIndex);
+static int32_t sendRemoteFetchMsg(SExchangeInfo* pExchangeInfo, int32_t sourceIndex);
+static int32_t fetchSourceOnDemand(SExchangeInfo* pExchangeInfo, SExecTaskInfo* pTaskInfo, int32_t sourceIndex);
 static int32_t getCompletedSources(const SArray* pArray);
 static int32_t prepareConcurrentlyLoad(SOperatorInfo* pOperator);
 static int32_t seqLoadRemoteData(SOperatorInfo* pOperator);
@@ -88,6 +82,10 @@ static void concurrentlyLoadRemoteDataImpl(SOperatorInfo* pOperator, SExchangeIn
         goto _error;
       }
 
+      if (!takeSourceRsp(pExchangeInfo, pDataInfo)) {
+        continue;
+      }
+
       SRetrieveTableRsp*     pRsp = pDataInfo->pRsp;
       SDownstreamSourceNode* pSource = taosArrayGet(pExchangeInfo->pSources, i);
 
@@ -130,8 +128,7 @@ static void concurrentlyLoadRemoteDataImpl(SOperatorInfo* pOperator, SExchangeIn
       taosMemoryFreeClear(pDataInfo->pRsp);
 
       if (pDataInfo->status != EX_SOURCE_DATA_EXHAUSTED) {
-        pDataInfo->status = EX_SOURCE_DATA_NOT_READY;
-        code = doSendFetchDataRequest(pExchangeInfo, pTaskInfo, i);
+        code = fetchSourceOnDemand(pExchangeInfo, pTaskInfo, i);
         if (code != TSDB_CODE_SUCCESS) {
           taosMemoryFreeClear(pDataInfo->pRsp);
           goto _error;
@@ -218,6 +215,7 @@ static SSDataBlock* loadRemoteData(SOperatorInfo* pOperator) {
       if (status == PROJECT_RETRIEVE_CONTINUE) {
         continue;
       } else if (status == PROJECT_RETRIEVE_DONE) {
+        stopFetchSources(pExchangeInfo);
         if (pBlock->info.rows == 0) {
           setOperatorCompleted(pOperator);
           return NULL;
@@ -231,7 +229,7 @@ static SSDataBlock* loadRemoteData(SOperatorInfo* pOperator) {
   }
 }
 
-static int32_t initDataSource(int32_t numOfSources, SExchangeInfo* pInfo, const char* id) {
+int32_t initDataSource(int32_t numOfSources, SExchangeInfo* pInfo, const char* id) {
   pInfo->pSourceDataInfo = taosArrayInit(numOfSources, sizeof(SSourceDataInfo));
   if (pInfo->pSourceDataInfo == NULL) {
     return TSDB_CODE_OUT_OF_MEMORY;
@@ -242,9 +240,14 @@ static int32_t initDataSource(int32_t numOfSources, SExchangeInfo* pInfo, const
     dataInfo.status = EX_SOURCE_DATA_NOT_READY;
     dataInfo.taskId = id;
     dataInfo.index = i;
+    dataInfo.pRspList = taosArrayInit(4, POINTER_BYTES);
+    if (dataInfo.pRspList == NULL) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+
     SSourceDataInfo* pDs = taosArrayPush(pInfo->pSourceDataInfo, &dataInfo);
     if (pDs == NULL) {
-      taosArrayDestroy(pInfo->pSourceDataInfo);
+      taosArrayDestroy(dataInfo.pRspList);
       return TSDB_CODE_OUT_OF_MEMORY;
     }
   }
@@ -289,6 +292,7 @@ SOperatorInfo* createExchangeOperatorInfo(void* pTransporter, SExchangePhysiNode
   }
 
   tsem_init(&pInfo->ready, 0, 0);
+  taosThreadMutexInit(&pInfo->lock, NULL);
   pInfo->pDummyBlock = createDataBlockFromDescNode(pExNode->node.pOutputDataBlockDesc);
   pInfo->pResultBlockList = taosArrayInit(64, POINTER_BYTES);
   pInfo->pRecycledBlocks = taosArrayInit(64, POINTER_BYTES);
@@ -298,6 +302,9 @@ SOperatorInfo* createExchangeOperatorInfo(void* pTransporter, SExchangePhysiNode
 
   pInfo->seqLoadData = pExNode->seqRecvData;
   pInfo->pTransporter = pTransporter;
+  pInfo->queryId = pTaskInfo->id.queryId;
+  pInfo->fetchWindow = tsExchangeFetchWindow;
+  pInfo->bufferSize = tsExchangeBufferSize * 1048576L;
 
   setOperatorInfo(pOperator, "ExchangeOperator", QUERY_NODE_PHYSICAL_PLAN_EXCHANGE, false, OP_NOT_OPENED, pInfo,
                   pTaskInfo);
@@ -327,9 +334,19 @@ void freeBlock(void* pParam) {
   blockDataDestroy(pBlock);
 }
 
+static FORCE_INLINE int64_t getRspBufSize(const SRetrieveTableRsp* pRsp) {
+  return sizeof(SRetrieveTableRsp) + pRsp->compLen;
+}
+
 void freeSourceDataInfo(void* p) {
   SSourceDataInfo* pInfo = (SSourceDataInfo*)p;
   taosMemoryFreeClear(pInfo->pRsp);
+
+  for (int32_t i = 0; i < taosArrayGetSize(pInfo->pRspList); ++i) {
+    SRetrieveTableRsp* pRsp = taosArrayGetP(pInfo->pRspList, i);
+    taosMemoryFree(pRsp);
+  }
+  taosArrayDestroy(pInfo->pRspList);
 }
 
 void doDestroyExchangeOperatorInfo(void* param) {
@@ -344,6 +361,7 @@ void doDestroyExchangeOperatorInfo(void* param) {
   blockDataDestroy(pExInfo->pDummyBlock);
 
   tsem_destroy(&pExInfo->ready);
+  taosThreadMutexDestroy(&pExInfo->lock);
   taosMemoryFreeClear(param);
 }
 
@@ -357,13 +375,12 @@ int32_t loadRemoteDataCallback(void* param, SDataBuf* pMsg, int32_t code) {
     return TSDB_CODE_SUCCESS;
   }
 
-  int32_t          index = pWrapper->sourceIndex;
-  SSourceDataInfo* pSourceDataInfo = taosArrayGet(pExchangeInfo->pSourceDataInfo, index);
+  int32_t            index = pWrapper->sourceIndex;
+  SSourceDataInfo*   pSourceDataInfo = taosArrayGet(pExchangeInfo->pSourceDataInfo, index);
+  SRetrieveTableRsp* pRsp = NULL;
 
   if (code == TSDB_CODE_SUCCESS) {
-    pSourceDataInfo->pRsp = pMsg->pData;
-
-    SRetrieveTableRsp* pRsp = pSourceDataInfo->pRsp;
+    pRsp = pMsg->pData;
     pRsp->numOfRows = htobe64(pRsp->numOfRows);
     pRsp->compLen = htonl(pRsp->compLen);
     pRsp->numOfCols = htonl(pRsp->numOfCols);
@@ -374,100 +391,229 @@ int32_t loadRemoteDataCallback(void* param, SDataBuf* pMsg, int32_t code) {
            pRsp->numOfRows, pExchangeInfo);
   } else {
     taosMemoryFree(pMsg->pData);
-    pSourceDataInfo->code = code;
     qDebug("%s fetch rsp received, index:%d, error:%s, %p", pSourceDataInfo->taskId, index, tstrerror(code),
            pExchangeInfo);
   }
 
-  pSourceDataInfo->status = EX_SOURCE_DATA_READY;
+  bool prefetch = addSourceRsp(pExchangeInfo, index, pRsp, code);
+
   code = tsem_post(&pExchangeInfo->ready);
   if (code != TSDB_CODE_SUCCESS) {
     code = TAOS_SYSTEM_ERROR(code);
     qError("failed to invoke post when fetch rsp is ready, code:%s, %p", tstrerror(code), pExchangeInfo);
   }
 
+  if (prefetch) {
+    int32_t ret = sendRemoteFetchMsg(pExchangeInfo, index);
+    if (ret != TSDB_CODE_SUCCESS) {
+      // report the failure to the downstream as an error rsp of the source
+      addSourceRsp(pExchangeInfo, index, NULL, ret);
+      tsem_post(&pExchangeInfo->ready);
+    }
+  }
+
   taosReleaseRef(exchangeObjRefPool, pWrapper->exchangeId);
   return code;
 }
 
-int32_t doSendFetchDataRequest(SExchangeInfo* pExchangeInfo, SExecTaskInfo* pTaskInfo, int32_t sourceIndex) {
+// The rsps of a remote source are fetched ahead of the downstream only while it needs them: one fetch msg at most is in
+// flight for a source, since the qworker of the source serves one fetch of a task at a time, and at most fetchWindow
+// rsps of it and bufferSize bytes of all sources are held for the downstream. A source is not fetched ahead once the
+// downstream has stopped, nor in the sequential mode before the downstream reaches it.
+static bool canFetchSourceAhead(SExchangeInfo* pExchangeInfo, int32_t sourceIndex, SSourceDataInfo* pDataInfo) {
+  SDownstreamSourceNode* pSource = taosArrayGet(pExchangeInfo->pSources, sourceIndex);
+  if (pSource->localExec || pExchangeInfo->fetchStopped || pDataInfo->inflight || pDataInfo->rspEnd ||
+      pDataInfo->code != TSDB_CODE_SUCCESS) {
+    return false;
+  }
+
+  if (pExchangeInfo->seqLoadData && sourceIndex != pExchangeInfo->current) {
+    return false;
+  }
+
+  return taosArrayGetSize(pDataInfo->pRspList) < pExchangeInfo->fetchWindow &&
+         pExchangeInfo->bufferedBytes < pExchangeInfo->bufferSize;
+}
+
+// keep the rsp or the error of the fetch of the source, return true if the next fetch msg should be sent at once
+bool addSourceRsp(SExchangeInfo* pExchangeInfo, int32_t sourceIndex, SRetrieveTableRsp* pRsp, int32_t code) {
+  SSourceDataInfo* pDataInfo = taosArrayGet(pExchangeInfo->pSourceDataInfo, sourceIndex);
+  bool             prefetch = false;
+
+  taosThreadMutexLock(&pExchangeInfo->lock);
+  pDataInfo->inflight = false;
+  pDataInfo->status = EX_SOURCE_DATA_READY;
+  if (code != TSDB_CODE_SUCCESS) {
+    pDataInfo->code = code;
+  } else {
+    taosArrayPush(pDataInfo->pRspList, &pRsp);
+    pExchangeInfo->bufferedBytes += getRspBufSize(pRsp);
+    pDataInfo->rspEnd = (pRsp->completed == 1 || pRsp->numOfRows == 0);
+
+    prefetch = canFetchSourceAhead(pExchangeInfo, sourceIndex, pDataInfo);
+    if (prefetch) {
+      pDataInfo->inflight = true;
+    }
+  }
+  taosThreadMutexUnlock(&pExchangeInfo->lock);
+
+  return prefetch;
+}
+
+// take the earliest rsp received from the source, return false if there is none
+bool takeSourceRsp(SExchangeInfo* pExchangeInfo, SSourceDataInfo* pDataInfo) {
+  bool taken = false;
+
+  taosThreadMutexLock(&pExchangeInfo->lock);
+  if (taosArrayGetSize(pDataInfo->pRspList) > 0) {
+    pDataInfo->pRsp = taosArrayGetP(pDataInfo->pRspList, 0);
+    taosArrayRemove(pDataInfo->pRspList, 0);
+    pExchangeInfo->bufferedBytes -= getRspBufSize(pDataInfo->pRsp);
+    taken = true;
+  }
+
+  if (taosArrayGetSize(pDataInfo->pRspList) == 0 && pDataInfo->code == TSDB_CODE_SUCCESS) {
+    pDataInfo->status = EX_SOURCE_DATA_NOT_READY;
+  }
+  taosThreadMutexUnlock(&pExchangeInfo->lock);
+
+  return taken;
+}
+
+// Return true if the fetch msg of the source should be sent now, either because the downstream waits for a rsp of it,
+// or to refill the rsps fetched ahead after the downstream has taken one.
+bool needFetchSource(SExchangeInfo* pExchangeInfo, int32_t sourceIndex) {
+  SSourceDataInfo* pDataInfo = taosArrayGet(pExchangeInfo->pSourceDataInfo, sourceIndex);
+  bool             fetch = false;
+
+  taosThreadMutexLock(&pExchangeInfo->lock);
+  if (taosArrayGetSize(pDataInfo->pRspList) == 0) {
+    fetch = !pDataInfo->inflight && !pDataInfo->rspEnd && pDataInfo->code == TSDB_CODE_SUCCESS;
+  } else {
+    fetch = canFetchSourceAhead(pExchangeInfo, sourceIndex, pDataInfo);
+  }
+
+  if (fetch) {
+    pDataInfo->inflight = true;
+  }
+  taosThreadMutexUnlock(&pExchangeInfo->lock);
+
+  return fetch;
+}
+
+// the rsps still in flight are kept until the operator is destroyed, but no more are fetched ahead
+static void stopFetchSources(SExchangeInfo* pExchangeInfo) {
+  taosThreadMutexLock(&pExchangeInfo->lock);
+  pExchangeInfo->fetchStopped = true;
+  taosThreadMutexUnlock(&pExchangeInfo->lock);
+}
+
+// the downstream needs the next rsp of the source, send the fetch msg unless one is in flight or enough rsps are held
+static int32_t fetchSourceOnDemand(SExchangeInfo* pExchangeInfo, SExecTaskInfo* pTaskInfo, int32_t sourceIndex) {
+  if (!needFetchSource(pExchangeInfo, sourceIndex)) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t code = doSendFetchDataRequest(pExchangeInfo, pTaskInfo, sourceIndex);
+  if (code != TSDB_CODE_SUCCESS) {
+    SSourceDataInfo* pDataInfo = taosArrayGet(pExchangeInfo->pSourceDataInfo, sourceIndex);
+    taosThreadMutexLock(&pExchangeInfo->lock);
+    pDataInfo->inflight = false;
+    taosThreadMutexUnlock(&pExchangeInfo->lock);
+  }
+
+  return code;
+}
+
+// it is called by the rsp callback as well, so it should not rely on the task info
+static int32_t sendRemoteFetchMsg(SExchangeInfo* pExchangeInfo, int32_t sourceIndex) {
   size_t totalSources = taosArrayGetSize(pExchangeInfo->pSources);
 
   SDownstreamSourceNode* pSource = taosArrayGet(pExchangeInfo->pSources, sourceIndex);
   SSourceDataInfo*       pDataInfo = taosArrayGet(pExchangeInfo->pSourceDataInfo, sourceIndex);
   pDataInfo->startTime = taosGetTimestampUs();
 
-  ASSERT(pDataInfo->status == EX_SOURCE_DATA_NOT_READY);
+  SResFetchReq req = {0};
+  req.header.vgId = pSource->addr.nodeId;
+  req.sId = pSource->schedId;
+  req.taskId = pSource->taskId;
+  req.queryId = pExchangeInfo->queryId;
+  req.execId = pSource->execId;
+
+  int32_t msgSize = tSerializeSResFetchReq(NULL, 0, &req);
+  if (msgSize < 0) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  void* msg = taosMemoryCalloc(1, msgSize);
+  if (NULL == msg) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  if (tSerializeSResFetchReq(msg, msgSize, &req) < 0) {
+    taosMemoryFree(msg);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
 
   SFetchRspHandleWrapper* pWrapper = taosMemoryCalloc(1, sizeof(SFetchRspHandleWrapper));
+  if (NULL == pWrapper) {
+    taosMemoryFree(msg);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
   pWrapper->exchangeId = pExchangeInfo->self;
   pWrapper->sourceIndex = sourceIndex;
 
-  if (pSource->localExec) {
-    SDataBuf pBuf = {0};
-    int32_t  code =
-        (*pTaskInfo->localFetch.fp)(pTaskInfo->localFetch.handle, pSource->schedId, pTaskInfo->id.queryId,
-                                    pSource->taskId, 0, pSource->execId, &pBuf.pData, pTaskInfo->localFetch.explainRes);
-    loadRemoteDataCallback(pWrapper, &pBuf, code);
+  qDebug("%s build fetch msg and send to vgId:%d, ep:%s, taskId:0x%" PRIx64 ", execId:%d, %p, %d/%" PRIzu,
+         pDataInfo->taskId, pSource->addr.nodeId, pSource->addr.epSet.eps[0].fqdn, pSource->taskId, pSource->execId,
+         pExchangeInfo, sourceIndex, totalSources);
+
+  // send the fetch remote task result reques
+  SMsgSendInfo* pMsgSendInfo = taosMemoryCalloc(1, sizeof(SMsgSendInfo));
+  if (NULL == pMsgSendInfo) {
+    taosMemoryFreeClear(msg);
     taosMemoryFree(pWrapper);
-  } else {
-    SResFetchReq req = {0};
-    req.header.vgId = pSource->addr.nodeId;
-    req.sId = pSource->schedId;
-    req.taskId = pSource->taskId;
-    req.queryId = pTaskInfo->id.queryId;
-    req.execId = pSource->execId;
-
-    int32_t msgSize = tSerializeSResFetchReq(NULL, 0, &req);
-    if (msgSize < 0) {
-      pTaskInfo->code = TSDB_CODE_OUT_OF_MEMORY;
-      taosMemoryFree(pWrapper);
-      return pTaskInfo->code;
-    }
+    qError("%s prepare message %d failed", pDataInfo->taskId, (int32_t)sizeof(SMsgSendInfo));
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
 
-    void* msg = taosMemoryCalloc(1, msgSize);
-    if (NULL == msg) {
-      pTaskInfo->code = TSDB_CODE_OUT_OF_MEMORY;
-      taosMemoryFree(pWrapper);
-      return pTaskInfo->code;
-    }
+  pMsgSendInfo->param = pWrapper;
+  pMsgSendInfo->paramFreeFp = taosMemoryFree;
+  pMsgSendInfo->msgInfo.pData = msg;
+  pMsgSendInfo->msgInfo.len = msgSize;
+  pMsgSendInfo->msgType = pSource->fetchMsgType;
+  pMsgSendInfo->fp = loadRemoteDataCallback;
 
-    if (tSerializeSResFetchReq(msg, msgSize, &req) < 0) {
-      pTaskInfo->code = TSDB_CODE_OUT_OF_MEMORY;
-      taosMemoryFree(pWrapper);
-      taosMemoryFree(msg);
-      return pTaskInfo->code;
-    }
+  int64_t transporterId = 0;
+  asyncSendMsgToServer(pExchangeInfo->pTransporter, &pSource->addr.epSet, &transporterId, pMsgSendInfo);
+  return TSDB_CODE_SUCCESS;
+}
 
-    qDebug("%s build fetch msg and send to vgId:%d, ep:%s, taskId:0x%" PRIx64 ", execId:%d, %p, %d/%" PRIzu,
-           GET_TASKID(pTaskInfo), pSource->addr.nodeId, pSource->addr.epSet.eps[0].fqdn, pSource->taskId,
-           pSource->execId, pExchangeInfo, sourceIndex, totalSources);
-
-    // send the fetch remote task result reques
-    SMsgSendInfo* pMsgSendInfo = taosMemoryCalloc(1, sizeof(SMsgSendInfo));
-    if (NULL == pMsgSendInfo) {
-      taosMemoryFreeClear(msg);
-      taosMemoryFree(pWrapper);
-      qError("%s prepare message %d failed", GET_TASKID(pTaskInfo), (int32_t)sizeof(SMsgSendInfo));
-      pTaskInfo->code = TSDB_CODE_OUT_OF_MEMORY;
-      return pTaskInfo->code;
-    }
+int32_t doSendFetchDataRequest(SExchangeInfo* pExchangeInfo, SExecTaskInfo* pTaskInfo, int32_t sourceIndex) {
+  SDownstreamSourceNode* pSource = taosArrayGet(pExchangeInfo->pSources, sourceIndex);
+  SSourceDataInfo*       pDataInfo = taosArrayGet(pExchangeInfo->pSourceDataInfo, sourceIndex);
 
-    pMsgSendInfo->param = pWrapper;
-    pMsgSendInfo->paramFreeFp = taosMemoryFree;
-    pMsgSendInfo->msgInfo.pData = msg;
-    pMsgSendInfo->msgInfo.len = msgSize;
-    pMsgSendInfo->msgType = pSource->fetchMsgType;
-    pMsgSendInfo->fp = loadRemoteDataCallback;
+  if (pSource->localExec) {
+    pDataInfo->startTime = taosGetTimestampUs();
 
-    int64_t transporterId = 0;
-    int32_t code =
-        asyncSendMsgToServer(pExchangeInfo->pTransporter, &pSource->addr.epSet, &transporterId, pMsgSendInfo);
+    SFetchRspHandleWrapper wrapper = {.exchangeId = pExchangeInfo->self, .sourceIndex = sourceIndex};
+    SDataBuf               pBuf = {0};
+    int32_t                code =
+        (*pTaskInfo->localFetch.fp)(pTaskInfo->localFetch.handle, pSource->schedId, pTaskInfo->id.queryId,
+                                    pSource->taskId, 0, pSource->execId, &pBuf.pData, pTaskInfo->localFetch.explainRes);
+    loadRemoteDataCallback(&wrapper, &pBuf, code);
+  } else {
+    int32_t code = sendRemoteFetchMsg(pExchangeInfo, sourceIndex);
+    if (code != TSDB_CODE_SUCCESS) {
+      pTaskInfo->code = code;
+      return code;
+    }
   }
 
   return TSDB_CODE_SUCCESS;
 }
 
+
 void updateLoadRemoteInfo(SLoadRemoteDataInfo* pInfo, int64_t numOfRows, int32_t dataLen, int64_t startTs,
                           SOperatorInfo* pOperator) {
   pInfo->totalRows += numOfRows;
@@ -527,6 +673,7 @@ void* setAllSourcesCompleted(SOperatorInfo* pOperator) {
          GET_TASKID(pTaskInfo), totalSources, pLoadInfo->totalRows, pLoadInfo->totalSize / 1024.0,
          pLoadInfo->totalElapsed / 1000.0);
 
+  stopFetchSources(pExchangeInfo);
   setOperatorCompleted(pOperator);
   return NULL;
 }
@@ -554,7 +701,7 @@ int32_t prepareConcurrentlyLoad(SOperatorInfo* pOperator) {
 
   // Asynchronously send all fetch requests to all sources.
   for (int32_t i = 0; i < totalSources; ++i) {
-    int32_t code = doSendFetchDataRequest(pExchangeInfo, pTaskInfo, i);
+    int32_t code = fetchSourceOnDemand(pExchangeInfo, pTaskInfo, i);
     if (code != TSDB_CODE_SUCCESS) {
       pTaskInfo->code = code;
       return code;
@@ -616,9 +763,12 @@ int32_t seqLoadRemoteData(SOperatorInfo* pOperator) {
     }
 
     SSourceDataInfo* pDataInfo = taosArrayGet(pExchangeInfo->pSourceDataInfo, pExchangeInfo->current);
-    pDataInfo->status = EX_SOURCE_DATA_NOT_READY;
 
-    doSendFetchDataRequest(pExchangeInfo, pTaskInfo, pExchangeInfo->current);
+    // no msg is sent if the rsp has been received ahead, the wait returns at once then
+    code = fetchSourceOnDemand(pExchangeInfo, pTaskInfo, pExchangeInfo->current);
+    if (code != TSDB_CODE_SUCCESS) {
+      goto _error;
+    }
     tsem_wait(&pExchangeInfo->ready);
     if (isTaskKilled(pTaskInfo)) {
       longjmp(pTaskInfo->env, pTaskInfo->code);
@@ -633,6 +783,10 @@ int32_t seqLoadRemoteData(SOperatorInfo* pOperator) {
       return pOperator->pTaskInfo->code;
     }
 
+    if (!takeSourceRsp(pExchangeInfo, pDataInfo)) {
+      continue;
+    }
+
     SRetrieveTableRsp*   pRsp = pDataInfo->pRsp;
     SLoadRemoteDataInfo* pLoadInfo = &pExchangeInfo->loadInfo;
 
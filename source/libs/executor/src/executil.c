@@ -912,7 +912,7 @@ static void copyExistedUids(SArray* pUidTagList, const SArray* pUidList) {
 }
 
 static int32_t doFilterByTagCond(STableListInfo* pListInfo, SArray* pUidList, SNode* pTagCond, void* metaHandle,
-                                 SIdxFltStatus status) {
+                                 SIdxFltStatus status, SMetaStbStats* pStats) {
   if (pTagCond == NULL) {
     return TSDB_CODE_SUCCESS;
   }
@@ -978,6 +978,7 @@ static int32_t doFilterByTagCond(STableListInfo* pListInfo, SArray* pUidList, SN
     goto end;
   }
 
+  int64_t st = taosGetTimestampUs();
   pResBlock = createTagValBlockForFilter(ctx.cInfoList, numOfTables, pUidTagList, metaHandle);
   if (pResBlock == NULL) {
     code = terrno;
@@ -1003,6 +1004,10 @@ static int32_t doFilterByTagCond(STableListInfo* pListInfo, SArray* pUidList, SN
   }
 
   doSetQualifiedUid(pUidList, pUidTagList, (bool*)output.columnData->pData);
+  if (pStats != NULL) {
+    pStats->tagEvalNum += numOfTables;
+    pStats->tagEvalUs += taosGetTimestampUs() - st;
+  }
 
 end:
   taosHashCleanup(ctx.colHash);
@@ -1016,6 +1021,25 @@ end:
   return code;
 }
 
+// The tags of all child tables are read either way, the index saves evaluating the tag condition on the child tables it
+// rules out. The probe time, the share of child tables the index returns and the evaluation time per child table are
+// measured by earlier queries on the super table. Without them the index is used.
+static bool isTagIndexPreferred(void* metaHandle, uint64_t suid, const char* idstr) {
+  SMetaStbStats stats = {0};
+  if (metaGetStbStats(metaHandle, suid, &stats) != TSDB_CODE_SUCCESS || stats.idxProbeNum == 0 ||
+      stats.idxCtbNum == 0 || stats.tagEvalNum == 0) {
+    return true;
+  }
+
+  double selectivity = TMIN((double)stats.idxResNum / stats.idxCtbNum, 1.0);
+  double probeCost = (double)stats.idxProbeUs / stats.idxProbeNum;
+  double savedCost = (1.0 - selectivity) * stats.ctbNum * ((double)stats.tagEvalUs / stats.tagEvalNum);
+
+  qDebug("tag index choice, suid:%" PRIu64 " ctbNum:%" PRId64 " selectivity:%.3f probe:%.0fus saved:%.0fus, %s", suid,
+         stats.ctbNum, selectivity, probeCost, savedCost, idstr);
+  return probeCost < savedCost;
+}
+
 int32_t getTableList(void* metaHandle, void* pVnode, SScanPhysiNode* pScanNode, SNode* pTagCond, SNode* pTagIndexCond,
                      STableListInfo* pListInfo, const char* idstr) {
   int32_t code = TSDB_CODE_SUCCESS;
@@ -1030,12 +1054,13 @@ int32_t getTableList(void* metaHandle, void* pVnode, SScanPhysiNode* pScanNode,
       taosArrayPush(pUidList, &pScanNode->uid);
     }
 
-    code = doFilterByTagCond(pListInfo, pUidList, pTagCond, metaHandle, status);
+    code = doFilterByTagCond(pListInfo, pUidList, pTagCond, metaHandle, status, NULL);
     if (code != TSDB_CODE_SUCCESS) {
       goto _end;
     }
   } else {
-    T_MD5_CTX context = {0};
+    T_MD5_CTX     context = {0};
+    SMetaStbStats stats = {0};
 
     if (tsTagFilterCache) {
       // try to retrieve the result from meta cache
@@ -1054,27 +1079,42 @@ int32_t getTableList(void* metaHandle, void* pVnode, SScanPhysiNode* pScanNode,
       vnodeGetCtbIdList(pVnode, pScanNode->suid, pUidList);
     } else {
       // failed to find the result in the cache, let try to calculate the results
-      if (pTagIndexCond) {
+      if (pTagIndexCond && isTagIndexPreferred(metaHandle, pScanNode->suid, idstr)) {
         void*         pIndex = tsdbGetIvtIdx(metaHandle);
         SIndexMetaArg metaArg = {
             .metaEx = metaHandle, .idx = tsdbGetIdx(metaHandle), .ivtIdx = pIndex, .suid = pScanNode->uid};
 
         SIdxFltStatus status = SFLT_NOT_INDEX;
+        int64_t       st = taosGetTimestampUs();
         code = doFilterTag(pTagIndexCond, &metaArg, pUidList, &status);
         if (code != 0 || status == SFLT_NOT_INDEX) {  // temporarily disable it for performance sake
           //          qError("failed to get tableIds from index, reason:%s, suid:%" PRIu64, tstrerror(code), tableUid);
           code = TDB_CODE_SUCCESS;
         } else {
           qInfo("succ to get filter result, table num: %d", (int)taosArrayGetSize(pUidList));
+
+          // no child table returned means all of them are evaluated, the same as if the index had not been probed
+          SMetaStbStats ctbStats = {0};
+          metaGetStbStats(metaHandle, pScanNode->suid, &ctbStats);
+          size_t numOfRes = taosArrayGetSize(pUidList);
+          stats.idxProbeNum = 1;
+          stats.idxProbeUs = taosGetTimestampUs() - st;
+          stats.idxCtbNum = ctbStats.ctbNum;
+          stats.idxResNum = (numOfRes == 0) ? ctbStats.ctbNum : numOfRes;
         }
       }
     }
 
-    code = doFilterByTagCond(pListInfo, pUidList, pTagCond, metaHandle, status);
+    code = doFilterByTagCond(pListInfo, pUidList, pTagCond, metaHandle, status, pTagCond ? &stats : NULL);
     if (code != TSDB_CODE_SUCCESS) {
       goto _end;
     }
 
+    if (pTagCond) {
+      stats.uid = pScanNode->suid;
+      metaAddStbTagFilterStats(metaHandle, &stats);
+    }
+
     // let's add the filter results into meta-cache
     numOfTables = taosArrayGetSize(pUidList);
 
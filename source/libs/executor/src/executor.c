@@ -519,11 +519,15 @@ int32_t qExecTaskOpt(qTaskInfo_t tinfo, SArray* pResList, uint64_t* useconds, bo
     return TSDB_CODE_SUCCESS;
   }
 
+  // buffers and sort handles created by the operators are charged to this task
+  SMemTracker* prevTracker = taosMemTrackerSwitch(pTaskInfo->pMemTracker);
+
   // error occurs, record the error code and return to client
   int32_t ret = setjmp(pTaskInfo->env);
   if (ret != TSDB_CODE_SUCCESS) {
     pTaskInfo->code = ret;
     cleanUpUdfs();
+    taosMemTrackerSwitch(prevTracker);
 
     qDebug("%s task abort due to error/cancel occurs, code:%s", GET_TASKID(pTaskInfo), tstrerror(pTaskInfo->code));
     atomic_store_64(&pTaskInfo->owner, 0);
@@ -570,6 +574,7 @@ int32_t qExecTaskOpt(qTaskInfo_t tinfo, SArray* pResList, uint64_t* useconds, bo
   }
 
   cleanUpUdfs();
+  taosMemTrackerSwitch(prevTracker);
 
   uint64_t total = pTaskInfo->pRoot->resultInfo.totalRows;
   qDebug("%s task suspended, %d rows in %d blocks returned, total:%" PRId64 " rows, in sinkNode:%d, elapsed:%.2f ms",
@@ -613,11 +618,15 @@ int32_t qExecTask(qTaskInfo_t tinfo, SSDataBlock** pRes, uint64_t* useconds) {
     return TSDB_CODE_SUCCESS;
   }
 
+  // buffers and sort handles created by the operators are charged to this task
+  SMemTracker* prevTracker = taosMemTrackerSwitch(pTaskInfo->pMemTracker);
+
   // error occurs, record the error code and return to client
   int32_t ret = setjmp(pTaskInfo->env);
   if (ret != TSDB_CODE_SUCCESS) {
     pTaskInfo->code = ret;
     cleanUpUdfs();
+    taosMemTrackerSwitch(prevTracker);
     qDebug("%s task abort due to error/cancel occurs, code:%s", GET_TASKID(pTaskInfo), tstrerror(pTaskInfo->code));
     atomic_store_64(&pTaskInfo->owner, 0);
     return pTaskInfo->code;
@@ -636,6 +645,7 @@ int32_t qExecTask(qTaskInfo_t tinfo, SSDataBlock** pRes, uint64_t* useconds) {
   }
 
   cleanUpUdfs();
+  taosMemTrackerSwitch(prevTracker);
 
   int32_t  current = (*pRes != NULL) ? (*pRes)->info.rows : 0;
   uint64_t total = pTaskInfo->pRoot->resultInfo.totalRows;
@@ -96,8 +96,6 @@ static void    doSetTableGroupOutputBuf(SOperatorInfo* pOperator, int32_t numOfO
 static void    doApplyScalarCalculation(SOperatorInfo* pOperator, SSDataBlock* pBlock, int32_t order, int32_t scanFlag);
 static int32_t doInitAggInfoSup(SAggSupporter* pAggSup, SqlFunctionCtx* pCtx, int32_t numOfOutput, size_t keyBufSize,
                                 const char* pKey);
-static void    extractQualifiedTupleByFilterResult(SSDataBlock* pBlock, const SColumnInfoData* p, bool keep,
-                                                   int32_t status);
 static int32_t doSetInputDataBlock(SExprSupp* pExprSup, SSDataBlock* pBlock, int32_t order, int32_t scanFlag,
                                    bool createDummyCol);
 static int32_t doCopyToSDataBlock(SExecTaskInfo* pTaskInfo, SSDataBlock* pBlock, SExprSupp* pSup, SDiskbasedBuf* pBuf,
@@ -249,6 +247,10 @@ SResultRow* doSetResultOutBufByKey(SDiskbasedBuf* pResultBuf, SResultRowInfo* pR
     SResultRowPosition pos = {.pageId = pResult->pageId, .offset = pResult->offset};
     tSimpleHashPut(pSup->pResultRowHashTable, pSup->keyBuf, GET_RES_WINDOW_KEY_LEN(bytes), &pos,
                    sizeof(SResultRowPosition));
+
+    int32_t entryLen = GET_RES_WINDOW_KEY_LEN(bytes) + sizeof(SResultRowPosition);
+    updateHashMemCharge(&pSup->hashMem, tSimpleHashGetMemSize(pSup->pResultRowHashTable) +
+                                            (int64_t)tSimpleHashGetSize(pSup->pResultRowHashTable) * entryLen);
   }
 
   // 2. set the new time window to be the new active time window
@@ -1743,6 +1745,8 @@ int32_t doInitAggInfoSup(SAggSupporter* pAggSup, SqlFunctionCtx* pCtx, int32_t n
     return TSDB_CODE_OUT_OF_MEMORY;
   }
 
+  initHashMemCharge(&pAggSup->hashMem);
+
   uint32_t defaultPgsz = 0;
   uint32_t defaultBufsz = 0;
   getBufferPgSize(pAggSup->resultRowSize, &defaultPgsz, &defaultBufsz);
@@ -1765,9 +1769,42 @@ int32_t doInitAggInfoSup(SAggSupporter* pAggSup, SqlFunctionCtx* pCtx, int32_t n
 void cleanupAggSup(SAggSupporter* pAggSup) {
   taosMemoryFreeClear(pAggSup->keyBuf);
   tSimpleHashCleanup(pAggSup->pResultRowHashTable);
+  cleanupHashMemCharge(&pAggSup->hashMem);
   destroyDiskbasedBuf(pAggSup->pResultBuf);
 }
 
+// the hash table is created while its task tracker is the current one of the thread, see createExecTaskInfoImpl
+void initHashMemCharge(SHashMemCharge* pCharge) {
+  SMemTracker* pTracker = taosMemTrackerCurrent();
+  pCharge->pTracker = (pTracker != NULL) ? taosMemTrackerRef(pTracker) : NULL;
+  pCharge->charged = 0;
+}
+
+// hash tables can not be spilled, they are always charged so that the paged buffers of the task spill earlier
+void updateHashMemCharge(SHashMemCharge* pCharge, int64_t memSize) {
+  if (pCharge->pTracker == NULL || memSize == pCharge->charged) {
+    return;
+  }
+
+  if (memSize > pCharge->charged) {
+    taosMemTrackerConsume(pCharge->pTracker, memSize - pCharge->charged);
+  } else {
+    taosMemTrackerRelease(pCharge->pTracker, pCharge->charged - memSize);
+  }
+  pCharge->charged = memSize;
+}
+
+void cleanupHashMemCharge(SHashMemCharge* pCharge) {
+  if (pCharge->pTracker == NULL) {
+    return;
+  }
+
+  taosMemTrackerRelease(pCharge->pTracker, pCharge->charged);
+  taosMemTrackerUnref(pCharge->pTracker);
+  pCharge->pTracker = NULL;
+  pCharge->charged = 0;
+}
+
 int32_t initAggSup(SExprSupp* pSup, SAggSupporter* pAggSup, SExprInfo* pExprInfo, int32_t numOfCols, size_t keyBufSize,
                    const char* pkey, void* pState) {
   int32_t code = initExprSupp(pSup, pExprInfo, numOfCols);
@@ -1972,6 +2009,87 @@ static char* buildTaskId(uint64_t taskId, uint64_t queryId) {
   return p;
 }
 
+typedef struct SQueryMemTracker {
+  SMemTracker* pTracker;
+  int32_t      taskNum;  // tasks of this query on this node, the entry is removed with the last one
+} SQueryMemTracker;
+
+typedef struct SQueryMemTrackerMgmt {
+  TdThreadMutex lock;
+  SMemTracker*  pNode;     // all queries of this node, limited by queryBufferSize
+  SHashObj*     pQueries;  // key: queryId, value: SQueryMemTracker, limited by queryMemoryLimit
+} SQueryMemTrackerMgmt;
+
+static SQueryMemTrackerMgmt gQueryMemMgmt = {0};
+static TdThreadOnce         queryMemMgmtOnce = PTHREAD_ONCE_INIT;
+
+static void initQueryMemMgmt() {
+  taosThreadMutexInit(&gQueryMemMgmt.lock, NULL);
+  gQueryMemMgmt.pNode = taosMemTrackerCreate("node", (tsQueryBufferSize > 0) ? tsQueryBufferSize * 1048576L : 0, NULL);
+  gQueryMemMgmt.pQueries = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_UBIGINT), true, HASH_NO_LOCK);
+}
+
+static SMemTracker* createTaskMemTracker(uint64_t queryId, const char* id) {
+  taosThreadOnce(&queryMemMgmtOnce, initQueryMemMgmt);
+  if (gQueryMemMgmt.pNode == NULL || gQueryMemMgmt.pQueries == NULL) {
+    return NULL;
+  }
+
+  SMemTracker* pTask = NULL;
+  taosThreadMutexLock(&gQueryMemMgmt.lock);
+
+  SQueryMemTracker* pQuery = taosHashGet(gQueryMemMgmt.pQueries, &queryId, sizeof(queryId));
+  if (pQuery == NULL) {
+    char label[MEM_TRACKER_LABEL_LEN] = {0};
+    snprintf(label, sizeof(label), "QID:0x%" PRIx64, queryId);
+
+    SQueryMemTracker query = {0};
+    query.pTracker = taosMemTrackerCreate(label, tsQueryMemoryLimit * 1048576L, gQueryMemMgmt.pNode);
+    if (query.pTracker == NULL) {
+      goto _end;
+    }
+
+    if (taosHashPut(gQueryMemMgmt.pQueries, &queryId, sizeof(queryId), &query, sizeof(query)) != 0) {
+      taosMemTrackerUnref(query.pTracker);
+      goto _end;
+    }
+    pQuery = taosHashGet(gQueryMemMgmt.pQueries, &queryId, sizeof(queryId));
+  }
+
+  pTask = taosMemTrackerCreate(id, 0, pQuery->pTracker);
+  if (pTask != NULL) {
+    pQuery->taskNum += 1;
+  } else if (pQuery->taskNum == 0) {
+    taosMemTrackerUnref(pQuery->pTracker);
+    taosHashRemove(gQueryMemMgmt.pQueries, &queryId, sizeof(queryId));
+  }
+
+_end:
+  taosThreadMutexUnlock(&gQueryMemMgmt.lock);
+  return pTask;
+}
+
+static void destroyTaskMemTracker(uint64_t queryId, SMemTracker* pTask) {
+  if (pTask == NULL) {
+    return;
+  }
+
+  qDebug("%s memory peak:%" PRId64 " bytes", pTask->label, taosMemTrackerPeak(pTask));
+
+  taosThreadMutexLock(&gQueryMemMgmt.lock);
+
+  // buffers still referring to the task or query tracker keep them alive, the registry entry goes with the last task
+  // of the query, whatever state that task ends in
+  SQueryMemTracker* pQuery = taosHashGet(gQueryMemMgmt.pQueries, &queryId, sizeof(queryId));
+  if (pQuery != NULL && --pQuery->taskNum <= 0) {
+    taosMemTrackerUnref(pQuery->pTracker);
+    taosHashRemove(gQueryMemMgmt.pQueries, &queryId, sizeof(queryId));
+  }
+
+  taosMemTrackerUnref(pTask);
+  taosThreadMutexUnlock(&gQueryMemMgmt.lock);
+}
+
 static SExecTaskInfo* createExecTaskInfo(uint64_t queryId, uint64_t taskId, EOPTR_EXEC_MODEL model, char* dbFName) {
   SExecTaskInfo* pTaskInfo = taosMemoryCalloc(1, sizeof(SExecTaskInfo));
   if (pTaskInfo == NULL) {
@@ -1989,6 +2107,11 @@ static SExecTaskInfo* createExecTaskInfo(uint64_t queryId, uint64_t taskId, EOPT
 
   pTaskInfo->id.queryId = queryId;
   pTaskInfo->id.str = buildTaskId(taskId, queryId);
+
+  // stream tasks live as long as the stream, only the queries are accounted
+  if (model == OPTR_EXEC_MODEL_BATCH) {
+    pTaskInfo->pMemTracker = createTaskMemTracker(queryId, pTaskInfo->id.str);
+  }
   return pTaskInfo;
 }
 
@@ -2329,6 +2452,8 @@ SOperatorInfo* createOperatorTree(SPhysiNode* pPhyNode, SExecTaskInfo* pTaskInfo
     pOptr = createStreamStateAggOperatorInfo(ops[0], pPhyNode, pTaskInfo);
   } else if (QUERY_NODE_PHYSICAL_PLAN_MERGE_JOIN == type) {
     pOptr = createMergeJoinOperatorInfo(ops, size, (SSortMergeJoinPhysiNode*)pPhyNode, pTaskInfo);
+  } else if (QUERY_NODE_PHYSICAL_PLAN_HASH_JOIN == type) {
+    pOptr = createHashJoinOperatorInfo(ops, size, (SHashJoinPhysiNode*)pPhyNode, pTaskInfo);
   } else if (QUERY_NODE_PHYSICAL_PLAN_FILL == type) {
     pOptr = createFillOperatorInfo(ops[0], (SFillPhysiNode*)pPhyNode, pTaskInfo);
   } else if (QUERY_NODE_PHYSICAL_PLAN_STREAM_FILL == type) {
@@ -2455,8 +2580,11 @@ int32_t createExecTaskInfoImpl(SSubplan* pPlan, SExecTaskInfo** pTaskInfo, SRead
   sql = NULL;
 
   (*pTaskInfo)->pSubplan = pPlan;
+
+  SMemTracker* prevTracker = taosMemTrackerSwitch((*pTaskInfo)->pMemTracker);
   (*pTaskInfo)->pRoot =
       createOperatorTree(pPlan->pNode, *pTaskInfo, pHandle, pPlan->pTagCond, pPlan->pTagIndexCond, pPlan->user);
+  taosMemTrackerSwitch(prevTracker);
 
   if (NULL == (*pTaskInfo)->pRoot) {
     terrno = (*pTaskInfo)->code;
@@ -2482,6 +2610,7 @@ void doDestroyTask(SExecTaskInfo* pTaskInfo) {
 
   pTaskInfo->pTableInfoList = tableListDestroy(pTaskInfo->pTableInfoList);
   destroyOperatorInfo(pTaskInfo->pRoot);
+  destroyTaskMemTracker(pTaskInfo->id.queryId, pTaskInfo->pMemTracker);
   cleanupTableSchemaInfo(&pTaskInfo->schemaInfo);
   cleanupStreamInfo(&pTaskInfo->streamInfo);
 
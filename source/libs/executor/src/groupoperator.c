@@ -37,6 +37,7 @@ typedef struct SGroupbyOperatorInfo {
   int32_t        groupKeyLen;    // total group by column width
   SGroupResInfo  groupResInfo;
   SExprSupp      scalarSup;
+  SResultRow*    pResultRow;  // result of the current group if the input is sorted by the group keys
 } SGroupbyOperatorInfo;
 
 // The sort in partition may be needed later.
@@ -47,6 +48,7 @@ typedef struct SPartitionOperatorInfo {
   char*          keyBuf;         // group by keys for hash
   int32_t        groupKeyLen;    // total group by column width
   SHashObj*      pGroupSet;      // quick locate the window object for each result
+  SHashMemCharge groupSetMem;    // charge of pGroupSet
 
   SDiskbasedBuf* pBuf;              // query result buffer based on blocked-wised disk file
   int32_t        rowCapacity;       // maximum number of rows for each buffer page
@@ -425,6 +427,121 @@ static SSDataBlock* hashGroupbyAggregate(SOperatorInfo* pOperator) {
   return buildGroupResultDataBlock(pOperator);
 }
 
+static void setSortedGroupOutputBuf(SOperatorInfo* pOperator) {
+  SGroupbyOperatorInfo* pInfo = pOperator->info;
+  SExprSupp*            pSup = &pOperator->exprSupp;
+
+  if (pInfo->pResultRow == NULL) {
+    pInfo->pResultRow =
+        getNewResultRow(pInfo->aggSup.pResultBuf, &pInfo->aggSup.currentPageId, pInfo->aggSup.resultRowSize);
+    if (pInfo->pResultRow == NULL) {
+      T_LONG_JMP(pOperator->pTaskInfo->env, terrno);
+    }
+    pInfo->binfo.resultRowInfo.cur =
+        (SResultRowPosition){.pageId = pInfo->pResultRow->pageId, .offset = pInfo->pResultRow->offset};
+  }
+
+  setResultRowInitCtx(pInfo->pResultRow, pSup->pCtx, pSup->numOfExprs, pSup->rowEntryInfoOffset);
+}
+
+static void finalizeSortedGroup(SOperatorInfo* pOperator) {
+  SGroupbyOperatorInfo* pInfo = pOperator->info;
+
+  finalizeResultRows(pInfo->aggSup.pResultBuf, &pInfo->binfo.resultRowInfo.cur, &pOperator->exprSupp,
+                     pInfo->binfo.pRes, pOperator->pTaskInfo);
+  resetResultRow(pInfo->pResultRow, pInfo->aggSup.resultRowSize - sizeof(SResultRow));
+}
+
+// The input is sorted by the group keys, so a group is complete once the key changes and only its result row is kept.
+static void doSortedGroupbyAgg(SOperatorInfo* pOperator, SSDataBlock* pBlock) {
+  SExecTaskInfo*        pTaskInfo = pOperator->pTaskInfo;
+  SGroupbyOperatorInfo* pInfo = pOperator->info;
+  SqlFunctionCtx*       pCtx = pOperator->exprSupp.pCtx;
+  int32_t               numOfExprs = pOperator->exprSupp.numOfExprs;
+  int32_t               numOfGroupCols = taosArrayGetSize(pInfo->pGroupCols);
+  int32_t               start = 0;
+
+  terrno = TSDB_CODE_SUCCESS;
+
+  for (int32_t j = 0; j < pBlock->info.rows; ++j) {
+    if (pInfo->isInit && groupKeyCompare(pInfo->pGroupCols, pInfo->pGroupColVals, pBlock, j, numOfGroupCols)) {
+      continue;
+    }
+
+    // the rows before j in this block belong to the group that ends here, which may have started in a previous block
+    if (j > start) {
+      applyAggFunctionOnPartialTuples(pTaskInfo, pCtx, NULL, start, j - start, pBlock->info.rows, numOfExprs);
+      doAssignGroupKeys(pCtx, numOfExprs, pBlock->info.rows, start);
+    }
+    if (pInfo->isInit) {
+      finalizeSortedGroup(pOperator);
+    }
+
+    recordNewGroupKeys(pInfo->pGroupCols, pInfo->pGroupColVals, pBlock, j);
+    if (terrno != TSDB_CODE_SUCCESS) {  // group by json error
+      T_LONG_JMP(pTaskInfo->env, terrno);
+    }
+    setSortedGroupOutputBuf(pOperator);
+    pInfo->isInit = true;
+    start = j;
+  }
+
+  if (pBlock->info.rows > start) {
+    applyAggFunctionOnPartialTuples(pTaskInfo, pCtx, NULL, start, pBlock->info.rows - start, pBlock->info.rows,
+                                    numOfExprs);
+    doAssignGroupKeys(pCtx, numOfExprs, pBlock->info.rows, start);
+  }
+}
+
+static SSDataBlock* sortedGroupbyAggregate(SOperatorInfo* pOperator) {
+  if (pOperator->status == OP_EXEC_DONE) {
+    return NULL;
+  }
+
+  SExecTaskInfo*        pTaskInfo = pOperator->pTaskInfo;
+  SGroupbyOperatorInfo* pInfo = pOperator->info;
+  SSDataBlock*          pRes = pInfo->binfo.pRes;
+  SOperatorInfo*        downstream = pOperator->pDownstream[0];
+  int32_t               order = TSDB_ORDER_ASC;
+  int32_t               scanFlag = MAIN_SCAN;
+  int64_t               st = taosGetTimestampUs();
+
+  blockDataCleanup(pRes);
+  while (pRes->info.rows < pOperator->resultInfo.threshold) {
+    SSDataBlock* pBlock = downstream->fpSet.getNextFn(downstream);
+    if (pBlock == NULL) {
+      if (pInfo->isInit) {
+        finalizeSortedGroup(pOperator);
+        pInfo->isInit = false;
+      }
+      doFilter(pRes, pOperator->exprSupp.pFilterInfo, NULL);
+      setOperatorCompleted(pOperator);
+      break;
+    }
+
+    int32_t code = getTableScanInfo(pOperator, &order, &scanFlag, false);
+    if (code != TSDB_CODE_SUCCESS) {
+      T_LONG_JMP(pTaskInfo->env, code);
+    }
+
+    setInputDataBlock(&pOperator->exprSupp, pBlock, order, scanFlag, true);
+    if (pInfo->scalarSup.pExprInfo != NULL) {
+      pTaskInfo->code = projectApplyFunctions(pInfo->scalarSup.pExprInfo, pBlock, pBlock, pInfo->scalarSup.pCtx,
+                                              pInfo->scalarSup.numOfExprs, NULL);
+      if (pTaskInfo->code != TSDB_CODE_SUCCESS) {
+        T_LONG_JMP(pTaskInfo->env, pTaskInfo->code);
+      }
+    }
+
+    doSortedGroupbyAgg(pOperator, pBlock);
+    doFilter(pRes, pOperator->exprSupp.pFilterInfo, NULL);
+  }
+
+  pOperator->cost.openCost += (taosGetTimestampUs() - st) / 1000.0;
+  pOperator->resultInfo.totalRows += pRes->info.rows;
+  return (pRes->info.rows == 0) ? NULL : pRes;
+}
+
 SOperatorInfo* createGroupOperatorInfo(SOperatorInfo* downstream, SAggPhysiNode* pAggNode, SExecTaskInfo* pTaskInfo) {
   int32_t               code = TSDB_CODE_SUCCESS;
   SGroupbyOperatorInfo* pInfo = taosMemoryCalloc(1, sizeof(SGroupbyOperatorInfo));
@@ -473,8 +590,9 @@ SOperatorInfo* createGroupOperatorInfo(SOperatorInfo* downstream, SAggPhysiNode*
   initResultRowInfo(&pInfo->binfo.resultRowInfo);
   setOperatorInfo(pOperator, "GroupbyAggOperator", 0, true, OP_NOT_OPENED, pInfo, pTaskInfo);
 
-  pOperator->fpSet = createOperatorFpSet(optrDummyOpenFn, hashGroupbyAggregate, NULL, destroyGroupOperatorInfo,
-                                         optrDefaultBufFn, NULL);
+  pOperator->fpSet = createOperatorFpSet(optrDummyOpenFn,
+                                         pAggNode->groupKeySorted ? sortedGroupbyAggregate : hashGroupbyAggregate, NULL,
+                                         destroyGroupOperatorInfo, optrDefaultBufFn, NULL);
   code = appendDownstream(pOperator, &downstream, 1);
   if (code != TSDB_CODE_SUCCESS) {
     goto _error;
@@ -588,6 +706,9 @@ void* getCurrentDataGroupInfo(const SPartitionOperatorInfo* pInfo, SDataGroupInf
     SDataGroupInfo gi = {0};
     gi.pPageList = taosArrayInit(100, sizeof(int32_t));
     taosHashPut(pInfo->pGroupSet, pInfo->keyBuf, len, &gi, sizeof(SDataGroupInfo));
+    updateHashMemCharge((SHashMemCharge*)&pInfo->groupSetMem,
+                        taosHashGetMemSize(pInfo->pGroupSet) +
+                            (int64_t)taosHashGetSize(pInfo->pGroupSet) * (pInfo->groupKeyLen + sizeof(SDataGroupInfo)));
 
     p = taosHashGet(pInfo->pGroupSet, pInfo->keyBuf, len);
 
@@ -816,6 +937,7 @@ static void destroyPartitionOperatorInfo(void* param) {
   }
 
   taosHashCleanup(pInfo->pGroupSet);
+  cleanupHashMemCharge(&pInfo->groupSetMem);
   taosMemoryFree(pInfo->columnOffset);
 
   cleanupExprSupp(&pInfo->scalarSup);
@@ -855,6 +977,7 @@ SOperatorInfo* createPartitionOperatorInfo(SOperatorInfo* downstream, SPartition
     pTaskInfo->code = terrno;
     goto _error;
   }
+  initHashMemCharge(&pInfo->groupSetMem);
 
   uint32_t defaultPgsz = 0;
   uint32_t defaultBufsz = 0;
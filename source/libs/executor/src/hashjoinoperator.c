@@ -0,0 +1,918 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "executorimpl.h"
+#include "filter.h"
+#include "os.h"
+#include "querynodes.h"
+#include "tdatablock.h"
+#include "tglobal.h"
+#include "tpagedbuf.h"
+#include "tsimplehash.h"
+#include "tsort.h"
+
+#define HJOIN_PARTITION_NUM            16
+#define HJOIN_PARTITION_BITS           4
+#define HJOIN_MAX_LEVEL                4
+#define HJOIN_DEFAULT_BUF_SIZE         (256 * 1048576L)
+#define HJOIN_SPILL_IN_MEM_PAGES       64
+#define HJOIN_PARTITION(_hash, _level) (((_hash) >> (8 + HJOIN_PARTITION_BITS * (_level))) % HJOIN_PARTITION_NUM)
+
+typedef struct SHJoinKeyCol {
+  int32_t slotId;
+  int16_t type;
+  int32_t bytes;
+} SHJoinKeyCol;
+
+typedef struct SHJoinColMap {
+  bool    fromBuild;
+  int32_t srcSlotId;
+} SHJoinColMap;
+
+typedef struct SHJoinRowRef {
+  int32_t blkIdx;
+  int32_t rowIdx;
+  int32_t next;  // next build row with the same key, -1 for the end of the chain
+} SHJoinRowRef;
+
+typedef struct SHJoinPartition {
+  int32_t level;        // times the rows have been partitioned, each level uses the next bits of the key hash
+  SArray* pBuildPages;  // SArray<int32_t>, spilled build rows of this partition
+  SArray* pProbePages;  // SArray<int32_t>, spilled probe rows of this partition
+} SHJoinPartition;
+
+typedef struct SHJoinOperatorInfo {
+  SSDataBlock*    pRes;
+  SSDataBlock*    pChunk;  // rows produced by one probe step, before they are filtered and appended to pRes
+  int32_t         buildIdx;
+  int32_t         probeIdx;
+  SArray*         pBuildKeys;  // SArray<SHJoinKeyCol>
+  SArray*         pProbeKeys;  // SArray<SHJoinKeyCol>
+  SHJoinColMap*   pColMap;
+  char*           keyBuf;
+  int32_t         keyBufSize;
+  // in-memory hash table of the build side
+  SSHashObj*      pKeyHash;  // key -> index of the first SHJoinRowRef in pRowRefs
+  SArray*         pRowRefs;
+  SArray*         pBuildBlocks;
+  int64_t         buildMemSize;
+  SMemTracker*    pMemTracker;  // charged with the in-memory hash table, the join spills once it can not be charged
+  int64_t         memCharged;
+  bool            buildDone;
+  // probe state
+  SSDataBlock*    pProbe;
+  int32_t*        pHeads;  // first matched row ref of each probe row, -1 if none
+  int32_t         probeCap;
+  int32_t         probeRow;
+  int32_t         matchRef;
+  SArray*         pProbeRows;
+  SArray*         pBuildRefs;
+  // grace hash join, used when the build side does not fit into the memory budget
+  bool            spilled;
+  SDiskbasedBuf*  pBuf;
+  int32_t         pageSize;
+  SHJoinPartition partitions[HJOIN_PARTITION_NUM];  // the partitions rows are being spilled into
+  SSDataBlock*    pStage[HJOIN_PARTITION_NUM];
+  SSDataBlock*    pBuildTemplate;
+  SSDataBlock*    pProbeTemplate;
+  SArray*         pPendingParts;  // SArray<SHJoinPartition>, the spilled partitions waiting to be joined
+  SHJoinPartition curPart;        // the partition being joined, valid if pBuildPages is not NULL
+  int32_t         curBuildPage;   // the first build page of curPart not loaded into the hash table yet
+  int32_t         curPage;        // the next probe page of curPart
+  SSDataBlock*    pPageBlock;
+} SHJoinOperatorInfo;
+
+static SSDataBlock* doHashJoin(SOperatorInfo* pOperator);
+static void         destroyHashJoinOperator(void* param);
+
+static int32_t hJoinInitKeys(SNodeList* pKeys, SArray** ppKeyCols, int32_t* pKeySize) {
+  *ppKeyCols = taosArrayInit(LIST_LENGTH(pKeys), sizeof(SHJoinKeyCol));
+  if (NULL == *ppKeyCols) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  int32_t size = 0;
+  SNode*  pNode = NULL;
+  FOREACH(pNode, pKeys) {
+    SColumnNode* pCol = (SColumnNode*)pNode;
+    SHJoinKeyCol key = {.slotId = pCol->slotId, .type = pCol->node.resType.type, .bytes = pCol->node.resType.bytes};
+    taosArrayPush(*ppKeyCols, &key);
+    size += key.bytes;
+  }
+  *pKeySize = size;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t hJoinInitColMap(SHJoinOperatorInfo* pInfo, SExprSupp* pExprSupp, int32_t buildBlockId) {
+  pInfo->pColMap = taosMemoryCalloc(pExprSupp->numOfExprs, sizeof(SHJoinColMap));
+  if (NULL == pInfo->pColMap) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < pExprSupp->numOfExprs; ++i) {
+    SColumn* pCol = pExprSupp->pExprInfo[i].base.pParam[0].pCol;
+    pInfo->pColMap[i].fromBuild = (pCol->dataBlockId == buildBlockId);
+    pInfo->pColMap[i].srcSlotId = pCol->slotId;
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
+// Only inner joins are planned as hash joins, their on conditions are just another filter of the matched rows.
+static int32_t hJoinInitFilters(SHashJoinPhysiNode* pJoinNode, SFilterInfo** ppFilter) {
+  if (NULL == pJoinNode->pOnConditions) {
+    return filterInitFromNode(pJoinNode->node.pConditions, ppFilter, 0);
+  }
+
+  if (NULL == pJoinNode->node.pConditions) {
+    return filterInitFromNode(pJoinNode->pOnConditions, ppFilter, 0);
+  }
+
+  SLogicConditionNode* pLogicCond = (SLogicConditionNode*)nodesMakeNode(QUERY_NODE_LOGIC_CONDITION);
+  if (NULL == pLogicCond) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  pLogicCond->condType = LOGIC_COND_TYPE_AND;
+  int32_t code = nodesListMakeStrictAppend(&pLogicCond->pParameterList, nodesCloneNode(pJoinNode->pOnConditions));
+  if (TSDB_CODE_SUCCESS == code) {
+    code = nodesListMakeStrictAppend(&pLogicCond->pParameterList, nodesCloneNode(pJoinNode->node.pConditions));
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    code = filterInitFromNode((SNode*)pLogicCond, ppFilter, 0);
+  }
+  nodesDestroyNode((SNode*)pLogicCond);
+  return code;
+}
+
+SOperatorInfo* createHashJoinOperatorInfo(SOperatorInfo** pDownstream, int32_t numOfDownstream,
+                                          SHashJoinPhysiNode* pJoinNode, SExecTaskInfo* pTaskInfo) {
+  SHJoinOperatorInfo* pInfo = taosMemoryCalloc(1, sizeof(SHJoinOperatorInfo));
+  SOperatorInfo*      pOperator = taosMemoryCalloc(1, sizeof(SOperatorInfo));
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  if (pOperator == NULL || pInfo == NULL) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _error;
+  }
+
+  if (JOIN_TYPE_INNER != pJoinNode->joinType) {
+    code = TSDB_CODE_OPS_NOT_SUPPORT;
+    goto _error;
+  }
+
+  pInfo->buildIdx = pJoinNode->buildLeft ? 0 : 1;
+  pInfo->probeIdx = 1 - pInfo->buildIdx;
+  pInfo->matchRef = -1;
+
+  // the operator is created while the tracker of its task is the current one of the thread, see createExecTaskInfoImpl
+  SMemTracker* pParent = taosMemTrackerCurrent();
+  if (pParent != NULL) {
+    pInfo->pMemTracker = taosMemTrackerCreate("hashJoin", 0, pParent);
+  }
+
+  int32_t leftKeySize = 0;
+  int32_t rightKeySize = 0;
+  code = hJoinInitKeys(pJoinNode->buildLeft ? pJoinNode->pLeftKeys : pJoinNode->pRightKeys, &pInfo->pBuildKeys,
+                       pJoinNode->buildLeft ? &leftKeySize : &rightKeySize);
+  if (code == TSDB_CODE_SUCCESS) {
+    code = hJoinInitKeys(pJoinNode->buildLeft ? pJoinNode->pRightKeys : pJoinNode->pLeftKeys, &pInfo->pProbeKeys,
+                         pJoinNode->buildLeft ? &rightKeySize : &leftKeySize);
+  }
+  if (code != TSDB_CODE_SUCCESS) {
+    goto _error;
+  }
+  pInfo->keyBufSize = TMAX(leftKeySize, rightKeySize);
+  pInfo->keyBuf = taosMemoryMalloc(pInfo->keyBufSize);
+
+  int32_t numOfCols = 0;
+  pInfo->pRes = createDataBlockFromDescNode(pJoinNode->node.pOutputDataBlockDesc);
+  pInfo->pChunk = createOneDataBlock(pInfo->pRes, false);
+  pInfo->pKeyHash = tSimpleHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY));
+  pInfo->pRowRefs = taosArrayInit(4096, sizeof(SHJoinRowRef));
+  pInfo->pBuildBlocks = taosArrayInit(8, POINTER_BYTES);
+  pInfo->pProbeRows = taosArrayInit(4096, sizeof(int32_t));
+  pInfo->pBuildRefs = taosArrayInit(4096, sizeof(int32_t));
+  pInfo->pPendingParts = taosArrayInit(HJOIN_PARTITION_NUM, sizeof(SHJoinPartition));
+  if (NULL == pInfo->keyBuf || NULL == pInfo->pChunk || NULL == pInfo->pKeyHash || NULL == pInfo->pRowRefs ||
+      NULL == pInfo->pBuildBlocks || NULL == pInfo->pProbeRows || NULL == pInfo->pBuildRefs ||
+      NULL == pInfo->pPendingParts) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+    goto _error;
+  }
+
+  SExprInfo* pExprInfo = createExprInfo(pJoinNode->pTargets, NULL, &numOfCols);
+  initResultSizeInfo(&pOperator->resultInfo, 4096);
+  blockDataEnsureCapacity(pInfo->pRes, pOperator->resultInfo.capacity);
+
+  setOperatorInfo(pOperator, "HashJoinOperator", QUERY_NODE_PHYSICAL_PLAN_HASH_JOIN, false, OP_NOT_OPENED, pInfo,
+                  pTaskInfo);
+  pOperator->exprSupp.pExprInfo = pExprInfo;
+  pOperator->exprSupp.numOfExprs = numOfCols;
+
+  code = hJoinInitColMap(pInfo, &pOperator->exprSupp, pDownstream[pInfo->buildIdx]->resultDataBlockId);
+  if (code == TSDB_CODE_SUCCESS) {
+    code = hJoinInitFilters(pJoinNode, &pOperator->exprSupp.pFilterInfo);
+  }
+  if (code != TSDB_CODE_SUCCESS) {
+    goto _error;
+  }
+
+  SDataBlockDescNode* pLeftDesc = ((SPhysiNode*)nodesListGetNode(pJoinNode->node.pChildren, 0))->pOutputDataBlockDesc;
+  SDataBlockDescNode* pRightDesc = ((SPhysiNode*)nodesListGetNode(pJoinNode->node.pChildren, 1))->pOutputDataBlockDesc;
+  pInfo->pageSize = getProperSortPageSize(TMAX(pLeftDesc->totalRowSize, pRightDesc->totalRowSize),
+                                          TMAX(LIST_LENGTH(pLeftDesc->pSlots), LIST_LENGTH(pRightDesc->pSlots)));
+
+  pOperator->fpSet =
+      createOperatorFpSet(optrDummyOpenFn, doHashJoin, NULL, destroyHashJoinOperator, optrDefaultBufFn, NULL);
+  code = appendDownstream(pOperator, pDownstream, numOfDownstream);
+  if (code != TSDB_CODE_SUCCESS) {
+    goto _error;
+  }
+
+  return pOperator;
+
+_error:
+  if (pInfo != NULL) {
+    destroyHashJoinOperator(pInfo);
+  }
+
+  taosMemoryFree(pOperator);
+  pTaskInfo->code = code;
+  return NULL;
+}
+
+// Charge the in-memory hash table of size bytes, false means the memory budget of the query is used up. Without a
+// task tracker the hash table is limited to HJOIN_DEFAULT_BUF_SIZE. A forced charge always succeeds, it is used when
+// the join can not go on without the memory.
+static bool hJoinTryCharge(SHJoinOperatorInfo* pInfo, int64_t size, bool force) {
+  int64_t delta = size - pInfo->memCharged;
+  if (delta <= 0) {
+    return true;
+  }
+
+  if (force) {
+    taosMemTrackerConsume(pInfo->pMemTracker, delta);
+  } else if ((pInfo->pMemTracker != NULL) ? !taosMemTrackerTryConsume(pInfo->pMemTracker, delta)
+                                          : size > HJOIN_DEFAULT_BUF_SIZE) {
+    return false;
+  }
+
+  pInfo->memCharged = size;
+  return true;
+}
+
+static void hJoinClearBuildTable(SHJoinOperatorInfo* pInfo) {
+  for (int32_t i = 0; i < taosArrayGetSize(pInfo->pBuildBlocks); ++i) {
+    blockDataDestroy(taosArrayGetP(pInfo->pBuildBlocks, i));
+  }
+  taosArrayClear(pInfo->pBuildBlocks);
+  taosArrayClear(pInfo->pRowRefs);
+  tSimpleHashClear(pInfo->pKeyHash);
+  pInfo->buildMemSize = 0;
+
+  taosMemTrackerRelease(pInfo->pMemTracker, pInfo->memCharged);
+  pInfo->memCharged = 0;
+}
+
+static void hJoinDestroyPartition(SHJoinPartition* pPart) {
+  pPart->pBuildPages = taosArrayDestroy(pPart->pBuildPages);
+  pPart->pProbePages = taosArrayDestroy(pPart->pProbePages);
+}
+
+static void destroyHashJoinOperator(void* param) {
+  SHJoinOperatorInfo* pInfo = (SHJoinOperatorInfo*)param;
+
+  if (pInfo->pBuildBlocks != NULL) {
+    hJoinClearBuildTable(pInfo);
+  }
+  taosMemTrackerUnref(pInfo->pMemTracker);
+  taosArrayDestroy(pInfo->pBuildBlocks);
+  taosArrayDestroy(pInfo->pRowRefs);
+  tSimpleHashCleanup(pInfo->pKeyHash);
+  taosArrayDestroy(pInfo->pBuildKeys);
+  taosArrayDestroy(pInfo->pProbeKeys);
+  taosArrayDestroy(pInfo->pProbeRows);
+  taosArrayDestroy(pInfo->pBuildRefs);
+  taosMemoryFree(pInfo->pColMap);
+  taosMemoryFree(pInfo->keyBuf);
+  taosMemoryFree(pInfo->pHeads);
+
+  for (int32_t i = 0; i < HJOIN_PARTITION_NUM; ++i) {
+    hJoinDestroyPartition(&pInfo->partitions[i]);
+    blockDataDestroy(pInfo->pStage[i]);
+  }
+  for (int32_t i = 0; i < taosArrayGetSize(pInfo->pPendingParts); ++i) {
+    hJoinDestroyPartition(taosArrayGet(pInfo->pPendingParts, i));
+  }
+  taosArrayDestroy(pInfo->pPendingParts);
+  hJoinDestroyPartition(&pInfo->curPart);
+  blockDataDestroy(pInfo->pBuildTemplate);
+  blockDataDestroy(pInfo->pProbeTemplate);
+  blockDataDestroy(pInfo->pPageBlock);
+  destroyDiskbasedBuf(pInfo->pBuf);
+
+  pInfo->pChunk = blockDataDestroy(pInfo->pChunk);
+  pInfo->pRes = blockDataDestroy(pInfo->pRes);
+  taosMemoryFreeClear(param);
+}
+
+// Serialize the join key of one row into pInfo->keyBuf. Rows with a NULL key never match anything.
+static bool hJoinGetKey(SHJoinOperatorInfo* pInfo, SArray* pKeyCols, SSDataBlock* pBlock, int32_t row,
+                        int32_t* pKeyLen) {
+  char*   p = pInfo->keyBuf;
+  int32_t numOfKeys = taosArrayGetSize(pKeyCols);
+  for (int32_t i = 0; i < numOfKeys; ++i) {
+    SHJoinKeyCol*    pKey = taosArrayGet(pKeyCols, i);
+    SColumnInfoData* pCol = taosArrayGet(pBlock->pDataBlock, pKey->slotId);
+    if (colDataIsNull_s(pCol, row)) {
+      return false;
+    }
+    char* pData = colDataGetData(pCol, row);
+    if (IS_VAR_DATA_TYPE(pKey->type)) {
+      memcpy(p, pData, varDataTLen(pData));
+      p += varDataTLen(pData);
+    } else {
+      memcpy(p, pData, pKey->bytes);
+      p += pKey->bytes;
+    }
+  }
+  *pKeyLen = p - pInfo->keyBuf;
+  return true;
+}
+
+static int64_t hJoinBuildBlockMemSize(SHJoinOperatorInfo* pInfo, SSDataBlock* pBlock) {
+  return blockDataGetSize(pBlock) + pBlock->info.rows * (sizeof(SHJoinRowRef) + pInfo->keyBufSize);
+}
+
+static int32_t hJoinAddBuildBlock(SHJoinOperatorInfo* pInfo, SSDataBlock* pBlock) {
+  int32_t blkIdx = taosArrayGetSize(pInfo->pBuildBlocks);
+  taosArrayPush(pInfo->pBuildBlocks, &pBlock);
+
+  for (int32_t i = 0; i < pBlock->info.rows; ++i) {
+    int32_t keyLen = 0;
+    if (!hJoinGetKey(pInfo, pInfo->pBuildKeys, pBlock, i, &keyLen)) {
+      continue;
+    }
+
+    SHJoinRowRef ref = {.blkIdx = blkIdx, .rowIdx = i, .next = -1};
+    int32_t      refIdx = taosArrayGetSize(pInfo->pRowRefs);
+    int32_t*     pHead = tSimpleHashGet(pInfo->pKeyHash, pInfo->keyBuf, keyLen);
+    if (NULL != pHead) {
+      ref.next = *pHead;
+      *pHead = refIdx;
+    } else if (tSimpleHashPut(pInfo->pKeyHash, pInfo->keyBuf, keyLen, &refIdx, sizeof(int32_t)) != 0) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+    if (NULL == taosArrayPush(pInfo->pRowRefs, &ref)) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+  }
+
+  pInfo->buildMemSize += hJoinBuildBlockMemSize(pInfo, pBlock);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t hJoinFlushStage(SHJoinOperatorInfo* pInfo, int32_t part, SArray* pPageIdList) {
+  SSDataBlock* pStage = pInfo->pStage[part];
+  int32_t      start = 0;
+  while (start < pStage->info.rows) {
+    int32_t stop = 0;
+    blockDataSplitRows(pStage, pStage->info.hasVarCol, start, &stop, pInfo->pageSize);
+    SSDataBlock* p = blockDataExtractBlock(pStage, start, stop - start + 1);
+    if (p == NULL) {
+      return terrno;
+    }
+
+    int32_t pageId = -1;
+    void*   pPage = getNewBufPage(pInfo->pBuf, &pageId);
+    if (pPage == NULL) {
+      blockDataDestroy(p);
+      return terrno;
+    }
+    taosArrayPush(pPageIdList, &pageId);
+
+    blockDataToBuf(pPage, p);
+    setBufPageDirty(pPage, true);
+    releaseBufPage(pInfo->pBuf, pPage);
+    blockDataDestroy(p);
+    start = stop + 1;
+  }
+
+  blockDataCleanup(pStage);
+  return TSDB_CODE_SUCCESS;
+}
+
+// Start spilling rows into HJOIN_PARTITION_NUM new partitions of the given level.
+static int32_t hJoinBeginSpill(SHJoinOperatorInfo* pInfo, int32_t level) {
+  for (int32_t i = 0; i < HJOIN_PARTITION_NUM; ++i) {
+    SHJoinPartition* pPart = &pInfo->partitions[i];
+    pPart->level = level;
+    pPart->pBuildPages = taosArrayInit(4, sizeof(int32_t));
+    pPart->pProbePages = taosArrayInit(4, sizeof(int32_t));
+    if (NULL == pPart->pBuildPages || NULL == pPart->pProbePages) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
+// Append the rows of pBlock to the partitions on disk. Rows with a NULL key never match, they are dropped.
+static int32_t hJoinSpillBlock(SHJoinOperatorInfo* pInfo, SSDataBlock* pBlock, bool isBuild) {
+  SArray*    pKeyCols = isBuild ? pInfo->pBuildKeys : pInfo->pProbeKeys;
+  _hash_fn_t hashFp = taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY);
+  int32_t    stageRows = TMAX(1, (pInfo->pageSize - blockDataGetSerialMetaSize(taosArrayGetSize(pBlock->pDataBlock))) /
+                                  blockDataGetRowSize(pBlock));
+  int32_t    numOfCols = taosArrayGetSize(pBlock->pDataBlock);
+
+  SSDataBlock** ppTemplate = isBuild ? &pInfo->pBuildTemplate : &pInfo->pProbeTemplate;
+  if (NULL == *ppTemplate) {
+    *ppTemplate = createOneDataBlock(pBlock, false);
+    if (NULL == *ppTemplate) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+  }
+
+  for (int32_t i = 0; i < pBlock->info.rows; ++i) {
+    int32_t keyLen = 0;
+    if (!hJoinGetKey(pInfo, pKeyCols, pBlock, i, &keyLen)) {
+      continue;
+    }
+    int32_t part = HJOIN_PARTITION(hashFp(pInfo->keyBuf, keyLen), pInfo->partitions[0].level);
+
+    if (NULL == pInfo->pStage[part]) {
+      pInfo->pStage[part] = createOneDataBlock(pBlock, false);
+      if (NULL == pInfo->pStage[part] || blockDataEnsureCapacity(pInfo->pStage[part], stageRows) != 0) {
+        return TSDB_CODE_OUT_OF_MEMORY;
+      }
+    }
+
+    SSDataBlock* pStage = pInfo->pStage[part];
+    for (int32_t j = 0; j < numOfCols; ++j) {
+      SColumnInfoData* pSrc = taosArrayGet(pBlock->pDataBlock, j);
+      SColumnInfoData* pDst = taosArrayGet(pStage->pDataBlock, j);
+      if (colDataIsNull_s(pSrc, i)) {
+        colDataSetNULL(pDst, pStage->info.rows);
+      } else {
+        colDataSetVal(pDst, pStage->info.rows, colDataGetData(pSrc, i), false);
+      }
+    }
+    ++pStage->info.rows;
+
+    if (pStage->info.rows >= stageRows) {
+      SHJoinPartition* pPart = &pInfo->partitions[part];
+      int32_t code = hJoinFlushStage(pInfo, part, isBuild ? pPart->pBuildPages : pPart->pProbePages);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+    }
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t hJoinFinishSpill(SHJoinOperatorInfo* pInfo, bool isBuild) {
+  for (int32_t i = 0; i < HJOIN_PARTITION_NUM; ++i) {
+    if (NULL == pInfo->pStage[i]) {
+      continue;
+    }
+    SHJoinPartition* pPart = &pInfo->partitions[i];
+    int32_t          code = hJoinFlushStage(pInfo, i, isBuild ? pPart->pBuildPages : pPart->pProbePages);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+    pInfo->pStage[i] = blockDataDestroy(pInfo->pStage[i]);
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
+// Both sides of the partitions are spilled, queue the ones that may produce results. If all the rows fell into one
+// partition again, they most likely share a single key that no further partitioning can split, so that partition is
+// marked to be joined in chunks right away.
+static int32_t hJoinEndSpill(SHJoinOperatorInfo* pInfo) {
+  int32_t start = taosArrayGetSize(pInfo->pPendingParts);
+  for (int32_t i = 0; i < HJOIN_PARTITION_NUM; ++i) {
+    SHJoinPartition* pPart = &pInfo->partitions[i];
+    if (taosArrayGetSize(pPart->pBuildPages) > 0 && taosArrayGetSize(pPart->pProbePages) > 0) {
+      if (NULL == taosArrayPush(pInfo->pPendingParts, pPart)) {
+        return TSDB_CODE_OUT_OF_MEMORY;
+      }
+      pPart->pBuildPages = NULL;
+      pPart->pProbePages = NULL;
+    } else {
+      hJoinDestroyPartition(pPart);
+    }
+  }
+
+  if (taosArrayGetSize(pInfo->pPendingParts) == start + 1) {
+    ((SHJoinPartition*)taosArrayGetLast(pInfo->pPendingParts))->level = HJOIN_MAX_LEVEL;
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
+// The build side does not fit into the memory budget: switch to a grace hash join. Both inputs are partitioned by the
+// hash of the join key into SDiskbasedBuf pages, and each partition is joined separately afterwards.
+static int32_t hJoinStartSpill(SOperatorInfo* pOperator) {
+  SHJoinOperatorInfo* pInfo = pOperator->info;
+  const char*         idStr = GET_TASKID(pOperator->pTaskInfo);
+
+  if (!osTempSpaceAvailable()) {
+    qError("hash join spill failed since %s, %s", tstrerror(TSDB_CODE_NO_AVAIL_DISK), idStr);
+    return TSDB_CODE_NO_AVAIL_DISK;
+  }
+
+  int32_t code = createDiskbasedBuf(&pInfo->pBuf, pInfo->pageSize, pInfo->pageSize * HJOIN_SPILL_IN_MEM_PAGES,
+                                    "hashJoinBuf", tsTempDir);
+  if (code == TSDB_CODE_SUCCESS) {
+    dBufSetPrintInfo(pInfo->pBuf);
+    code = hJoinBeginSpill(pInfo, 0);
+  }
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  qDebug("hash join build side of %" PRId64 " bytes out of memory budget, spill into %d partitions, %s",
+         pInfo->buildMemSize, HJOIN_PARTITION_NUM, idStr);
+  pInfo->spilled = true;
+  for (int32_t i = 0; i < taosArrayGetSize(pInfo->pBuildBlocks); ++i) {
+    code = hJoinSpillBlock(pInfo, taosArrayGetP(pInfo->pBuildBlocks, i), true);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+  hJoinClearBuildTable(pInfo);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t hJoinBuild(SOperatorInfo* pOperator) {
+  SHJoinOperatorInfo* pInfo = pOperator->info;
+  SOperatorInfo*      pBuildDs = pOperator->pDownstream[pInfo->buildIdx];
+  SOperatorInfo*      pProbeDs = pOperator->pDownstream[pInfo->probeIdx];
+  int32_t             code = TSDB_CODE_SUCCESS;
+
+  while (TSDB_CODE_SUCCESS == code) {
+    SSDataBlock* pBlock = pBuildDs->fpSet.getNextFn(pBuildDs);
+    if (NULL == pBlock) {
+      break;
+    }
+    if (pInfo->spilled) {
+      code = hJoinSpillBlock(pInfo, pBlock, true);
+      continue;
+    }
+
+    SSDataBlock* pCopy = createOneDataBlock(pBlock, true);
+    if (NULL == pCopy) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      break;
+    }
+    code = hJoinAddBuildBlock(pInfo, pCopy);
+    if (TSDB_CODE_SUCCESS == code && !hJoinTryCharge(pInfo, pInfo->buildMemSize, false)) {
+      code = hJoinStartSpill(pOperator);
+    }
+  }
+
+  if (TSDB_CODE_SUCCESS == code && pInfo->spilled) {
+    code = hJoinFinishSpill(pInfo, true);
+    while (TSDB_CODE_SUCCESS == code) {
+      SSDataBlock* pBlock = pProbeDs->fpSet.getNextFn(pProbeDs);
+      if (NULL == pBlock) {
+        break;
+      }
+      code = hJoinSpillBlock(pInfo, pBlock, false);
+    }
+    if (TSDB_CODE_SUCCESS == code) {
+      code = hJoinFinishSpill(pInfo, false);
+    }
+    if (TSDB_CODE_SUCCESS == code) {
+      code = hJoinEndSpill(pInfo);
+    }
+  }
+
+  pInfo->buildDone = true;
+  return code;
+}
+
+static SSDataBlock* hJoinLoadPage(SHJoinOperatorInfo* pInfo, int32_t pageId, SSDataBlock* pBlock) {
+  void* pPage = getBufPage(pInfo->pBuf, pageId);
+  if (NULL == pPage) {
+    return NULL;
+  }
+  int32_t code = blockDataFromBuf(pBlock, pPage);
+  releaseBufPage(pInfo->pBuf, pPage);
+  if (code != TSDB_CODE_SUCCESS) {
+    terrno = code;
+    return NULL;
+  }
+  return pBlock;
+}
+
+// Spill the pages of one side of the current partition again, into the partitions of the next level.
+static int32_t hJoinRespillPages(SHJoinOperatorInfo* pInfo, bool isBuild) {
+  SArray*      pPages = isBuild ? pInfo->curPart.pBuildPages : pInfo->curPart.pProbePages;
+  SSDataBlock* pBlock = createOneDataBlock(isBuild ? pInfo->pBuildTemplate : pInfo->pProbeTemplate, false);
+  if (NULL == pBlock) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  for (int32_t i = 0; i < taosArrayGetSize(pPages) && TSDB_CODE_SUCCESS == code; ++i) {
+    if (NULL == hJoinLoadPage(pInfo, *(int32_t*)taosArrayGet(pPages, i), pBlock)) {
+      code = terrno;
+      break;
+    }
+    code = hJoinSpillBlock(pInfo, pBlock, isBuild);
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    code = hJoinFinishSpill(pInfo, isBuild);
+  }
+
+  blockDataDestroy(pBlock);
+  return code;
+}
+
+// The build rows of the current partition still do not fit into the memory budget, partition it again with the next
+// bits of the key hash.
+static int32_t hJoinRepartition(SHJoinOperatorInfo* pInfo) {
+  qDebug("hash join partition of level %d with %d build pages out of memory budget, partition it again",
+         pInfo->curPart.level, (int32_t)taosArrayGetSize(pInfo->curPart.pBuildPages));
+
+  int32_t code = hJoinBeginSpill(pInfo, pInfo->curPart.level + 1);
+  if (TSDB_CODE_SUCCESS == code) {
+    code = hJoinRespillPages(pInfo, true);
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    code = hJoinRespillPages(pInfo, false);
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    code = hJoinEndSpill(pInfo);
+  }
+  return code;
+}
+
+// Load the build pages of the current partition into the hash table from curBuildPage on, until all of them are loaded
+// or the memory budget is used up. The first page is always loaded.
+static int32_t hJoinLoadBuildChunk(SHJoinOperatorInfo* pInfo) {
+  SArray* pPages = pInfo->curPart.pBuildPages;
+  int32_t start = pInfo->curBuildPage;
+
+  while (pInfo->curBuildPage < taosArrayGetSize(pPages)) {
+    SSDataBlock* pBlock = createOneDataBlock(pInfo->pBuildTemplate, false);
+    if (NULL == pBlock) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+    if (NULL == hJoinLoadPage(pInfo, *(int32_t*)taosArrayGet(pPages, pInfo->curBuildPage), pBlock)) {
+      blockDataDestroy(pBlock);
+      return terrno;
+    }
+
+    int64_t memSize = pInfo->buildMemSize + hJoinBuildBlockMemSize(pInfo, pBlock);
+    if (!hJoinTryCharge(pInfo, memSize, pInfo->curBuildPage == start)) {
+      blockDataDestroy(pBlock);
+      break;
+    }
+
+    int32_t code = hJoinAddBuildBlock(pInfo, pBlock);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+    ++pInfo->curBuildPage;
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
+// Move to the next chunk of build rows that may produce results, and load it into the hash table. A partition whose
+// build rows fit into the memory budget is one chunk. One that does not is partitioned again, up to HJOIN_MAX_LEVEL
+// levels, after that its build rows are loaded chunk by chunk and all of its probe pages are scanned for each chunk.
+static int32_t hJoinNextPartition(SHJoinOperatorInfo* pInfo, bool* pHasNext) {
+  *pHasNext = false;
+  hJoinClearBuildTable(pInfo);
+
+  while (true) {
+    SHJoinPartition* pPart = &pInfo->curPart;
+    if (NULL != pPart->pBuildPages && pInfo->curBuildPage < taosArrayGetSize(pPart->pBuildPages)) {
+      int32_t start = pInfo->curBuildPage;
+      int32_t code = hJoinLoadBuildChunk(pInfo);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+
+      bool wholePart = (0 == start && pInfo->curBuildPage == taosArrayGetSize(pPart->pBuildPages));
+      if (wholePart || pPart->level >= HJOIN_MAX_LEVEL) {
+        pInfo->curPage = 0;
+        *pHasNext = true;
+        return TSDB_CODE_SUCCESS;
+      }
+
+      hJoinClearBuildTable(pInfo);
+      code = hJoinRepartition(pInfo);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+    }
+
+    hJoinDestroyPartition(pPart);
+    if (0 == taosArrayGetSize(pInfo->pPendingParts)) {
+      return TSDB_CODE_SUCCESS;
+    }
+    *pPart = *(SHJoinPartition*)taosArrayPop(pInfo->pPendingParts);
+    pInfo->curBuildPage = 0;
+  }
+}
+
+static int32_t hJoinNextProbeBlock(SOperatorInfo* pOperator, SSDataBlock** ppBlock) {
+  SHJoinOperatorInfo* pInfo = pOperator->info;
+  *ppBlock = NULL;
+
+  if (!pInfo->spilled) {
+    SOperatorInfo* pProbeDs = pOperator->pDownstream[pInfo->probeIdx];
+    *ppBlock = pProbeDs->fpSet.getNextFn(pProbeDs);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  while (NULL == pInfo->curPart.pProbePages || pInfo->curPage >= taosArrayGetSize(pInfo->curPart.pProbePages)) {
+    bool    hasNext = false;
+    int32_t code = hJoinNextPartition(pInfo, &hasNext);
+    if (code != TSDB_CODE_SUCCESS || !hasNext) {
+      return code;
+    }
+  }
+
+  if (NULL == pInfo->pPageBlock) {
+    pInfo->pPageBlock = createOneDataBlock(pInfo->pProbeTemplate, false);
+    if (NULL == pInfo->pPageBlock) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+  }
+  int32_t pageId = *(int32_t*)taosArrayGet(pInfo->curPart.pProbePages, pInfo->curPage++);
+  *ppBlock = hJoinLoadPage(pInfo, pageId, pInfo->pPageBlock);
+  return (NULL == *ppBlock) ? terrno : TSDB_CODE_SUCCESS;
+}
+
+// Look up the keys of the whole probe block at once, so that the output loop only has to walk the match chains.
+static int32_t hJoinPrepareProbe(SHJoinOperatorInfo* pInfo, SSDataBlock* pBlock) {
+  int32_t rows = pBlock->info.rows;
+  if (rows > pInfo->probeCap) {
+    int32_t* pHeads = taosMemoryRealloc(pInfo->pHeads, rows * sizeof(int32_t));
+    if (NULL == pHeads) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+    pInfo->pHeads = pHeads;
+    pInfo->probeCap = rows;
+  }
+
+  for (int32_t i = 0; i < rows; ++i) {
+    int32_t keyLen = 0;
+    pInfo->pHeads[i] = -1;
+    if (hJoinGetKey(pInfo, pInfo->pProbeKeys, pBlock, i, &keyLen)) {
+      int32_t* pHead = tSimpleHashGet(pInfo->pKeyHash, pInfo->keyBuf, keyLen);
+      if (NULL != pHead) {
+        pInfo->pHeads[i] = *pHead;
+      }
+    }
+  }
+
+  pInfo->pProbe = pBlock;
+  pInfo->probeRow = 0;
+  pInfo->matchRef = (rows > 0) ? pInfo->pHeads[0] : -1;
+  return TSDB_CODE_SUCCESS;
+}
+
+static bool hJoinProbeDone(SHJoinOperatorInfo* pInfo) {
+  return NULL == pInfo->pProbe || pInfo->probeRow >= pInfo->pProbe->info.rows;
+}
+
+static int32_t hJoinCollectMatches(SHJoinOperatorInfo* pInfo, int32_t capacity) {
+  int32_t rows = pInfo->pProbe->info.rows;
+  int32_t num = 0;
+  while (pInfo->probeRow < rows && num < capacity) {
+    if (pInfo->matchRef < 0) {
+      if (++pInfo->probeRow < rows) {
+        pInfo->matchRef = pInfo->pHeads[pInfo->probeRow];
+      }
+      continue;
+    }
+    taosArrayPush(pInfo->pProbeRows, &pInfo->probeRow);
+    taosArrayPush(pInfo->pBuildRefs, &pInfo->matchRef);
+    pInfo->matchRef = ((SHJoinRowRef*)taosArrayGet(pInfo->pRowRefs, pInfo->matchRef))->next;
+    ++num;
+  }
+  return num;
+}
+
+// Copy the collected (probe row, build row) pairs into pChunk one output column at a time.
+static void hJoinMaterialize(SOperatorInfo* pOperator, SSDataBlock* pChunk) {
+  SHJoinOperatorInfo* pInfo = pOperator->info;
+  int32_t             num = taosArrayGetSize(pInfo->pProbeRows);
+  pChunk->info.rows = num;
+  if (0 == num) {
+    return;
+  }
+
+  int32_t* pProbeRows = taosArrayGet(pInfo->pProbeRows, 0);
+  int32_t* pBuildRefs = taosArrayGet(pInfo->pBuildRefs, 0);
+
+  SExprInfo* pExprInfo = pOperator->exprSupp.pExprInfo;
+  for (int32_t i = 0; i < pOperator->exprSupp.numOfExprs; ++i) {
+    SColumnInfoData* pDst = taosArrayGet(pChunk->pDataBlock, pExprInfo[i].base.resSchema.slotId);
+    SHJoinColMap*    pMap = &pInfo->pColMap[i];
+    if (pMap->fromBuild) {
+      for (int32_t j = 0; j < num; ++j) {
+        SHJoinRowRef*    pRef = taosArrayGet(pInfo->pRowRefs, pBuildRefs[j]);
+        SSDataBlock*     pBuild = taosArrayGetP(pInfo->pBuildBlocks, pRef->blkIdx);
+        SColumnInfoData* pSrc = taosArrayGet(pBuild->pDataBlock, pMap->srcSlotId);
+        if (colDataIsNull_s(pSrc, pRef->rowIdx)) {
+          colDataSetNULL(pDst, j);
+        } else {
+          colDataSetVal(pDst, j, colDataGetData(pSrc, pRef->rowIdx), false);
+        }
+      }
+    } else {
+      SColumnInfoData* pSrc = taosArrayGet(pInfo->pProbe->pDataBlock, pMap->srcSlotId);
+      for (int32_t j = 0; j < num; ++j) {
+        if (colDataIsNull_s(pSrc, pProbeRows[j])) {
+          colDataSetNULL(pDst, j);
+        } else {
+          colDataSetVal(pDst, j, colDataGetData(pSrc, pProbeRows[j]), false);
+        }
+      }
+    }
+  }
+}
+
+static int32_t hJoinProbe(SOperatorInfo* pOperator, SSDataBlock* pRes) {
+  SHJoinOperatorInfo* pInfo = pOperator->info;
+  SSDataBlock*        pChunk = pInfo->pChunk;
+  int32_t             capacity = pOperator->resultInfo.threshold - pRes->info.rows;
+
+  blockDataCleanup(pChunk);
+  int32_t code = blockDataEnsureCapacity(pChunk, capacity);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  taosArrayClear(pInfo->pProbeRows);
+  taosArrayClear(pInfo->pBuildRefs);
+  hJoinCollectMatches(pInfo, capacity);
+  hJoinMaterialize(pOperator, pChunk);
+
+  doFilter(pChunk, pOperator->exprSupp.pFilterInfo, NULL);
+  return blockDataMerge(pRes, pChunk);
+}
+
+static SSDataBlock* doHashJoin(SOperatorInfo* pOperator) {
+  if (pOperator->status == OP_EXEC_DONE) {
+    return NULL;
+  }
+
+  SHJoinOperatorInfo* pInfo = pOperator->info;
+  SExecTaskInfo*      pTaskInfo = pOperator->pTaskInfo;
+  int32_t             code = TSDB_CODE_SUCCESS;
+
+  if (!pInfo->buildDone) {
+    int64_t st = taosGetTimestampUs();
+    code = hJoinBuild(pOperator);
+    if (code != TSDB_CODE_SUCCESS) {
+      T_LONG_JMP(pTaskInfo->env, code);
+    }
+    pOperator->cost.openCost = (taosGetTimestampUs() - st) / 1000.0;
+  }
+
+  SSDataBlock* pRes = pInfo->pRes;
+  blockDataCleanup(pRes);
+
+  while (pRes->info.rows < pOperator->resultInfo.threshold) {
+    if (hJoinProbeDone(pInfo)) {
+      SSDataBlock* pBlock = NULL;
+      code = hJoinNextProbeBlock(pOperator, &pBlock);
+      if (code == TSDB_CODE_SUCCESS && NULL != pBlock) {
+        code = hJoinPrepareProbe(pInfo, pBlock);
+      }
+      if (code != TSDB_CODE_SUCCESS) {
+        T_LONG_JMP(pTaskInfo->env, code);
+      }
+      if (NULL == pBlock) {
+        pInfo->pProbe = NULL;
+        setOperatorCompleted(pOperator);
+        break;
+      }
+      continue;
+    }
+
+    code = hJoinProbe(pOperator, pRes);
+    if (code != TSDB_CODE_SUCCESS) {
+      T_LONG_JMP(pTaskInfo->env, code);
+    }
+  }
+
+  pOperator->resultInfo.totalRows += pRes->info.rows;
+  return (pRes->info.rows > 0) ? pRes : NULL;
+}
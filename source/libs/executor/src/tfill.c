@@ -32,187 +32,266 @@
 #include "tfill.h"
 
 #define FILL_IS_ASC_FILL(_f) ((_f)->order == TSDB_ORDER_ASC)
+#define FILL_KEY_BUF_ROWS    4096
 #define DO_INTERPOLATION(_v1, _v2, _k1, _k2, _k) \
   ((_v1) + ((_v2) - (_v1)) * (((double)(_k)) - ((double)(_k1))) / (((double)(_k2)) - ((double)(_k1))))
 
 static void doSetVal(SColumnInfoData* pDstColInfoData, int32_t rowIndex, const SGroupKeys* pKey);
 
-static void setNotFillColumn(SFillInfo* pFillInfo, SColumnInfoData* pDstColInfo, int32_t rowIndex, int32_t colIdx) {
+// set the same value to the rows [start, start + numOfRows) of the column
+static void doSetNVal(SColumnInfoData* pDst, int32_t start, int32_t numOfRows, const char* pData) {
+  if (IS_VAR_DATA_TYPE(pDst->info.type)) {
+    for (int32_t i = start; i < start + numOfRows; ++i) {
+      colDataSetVal(pDst, i, pData, false);
+    }
+    return;
+  }
+
+  // copy the first value, then double the copied part till all rows are set
+  int32_t bytes = pDst->info.bytes;
+  char*   p = pDst->pData + (int64_t)start * bytes;
+  memcpy(p, pData, bytes);
+  for (int32_t n = 1; n < numOfRows;) {
+    int32_t len = TMIN(n, numOfRows - n);
+    memcpy(p + (int64_t)n * bytes, p, (int64_t)len * bytes);
+    n += len;
+  }
+}
+
+static void doSetNKeyVal(SColumnInfoData* pDst, SGroupKeys* pKey, int32_t start, int32_t numOfRows) {
+  if (pKey->isNull) {
+    colDataSetNNULL(pDst, start, numOfRows);
+  } else {
+    doSetNVal(pDst, start, numOfRows, pKey->pData);
+  }
+}
+
+static void setNotFillColumn(SFillInfo* pFillInfo, SColumnInfoData* pDstColInfo, int32_t start, int32_t numOfRows,
+                             int32_t colIdx) {
   SRowVal* p = NULL;
   if (pFillInfo->type == TSDB_FILL_NEXT) {
     p = FILL_IS_ASC_FILL(pFillInfo) ? &pFillInfo->next : &pFillInfo->prev;
   } else {
     p = FILL_IS_ASC_FILL(pFillInfo) ? &pFillInfo->prev : &pFillInfo->next;
   }
-  
-  SGroupKeys* pKey = taosArrayGet(p->pRowVal, colIdx);
-  doSetVal(pDstColInfo, rowIndex, pKey);
-}
 
-static void setNullRow(SSDataBlock* pBlock, SFillInfo* pFillInfo, int32_t rowIndex) {
-  for (int32_t i = 0; i < pFillInfo->numOfCols; ++i) {
-    SFillColInfo*    pCol = &pFillInfo->pFillCol[i];
-    int32_t          dstSlotId = GET_DEST_SLOT_ID(pCol);
-    SColumnInfoData* pDstColInfo = taosArrayGet(pBlock->pDataBlock, dstSlotId);
-    if (pCol->notFillCol) {
-      bool filled = fillIfWindowPseudoColumn(pFillInfo, pCol, pDstColInfo, rowIndex);
-      if (!filled) {
-        setNotFillColumn(pFillInfo, pDstColInfo, rowIndex, i);
-      }
-    } else {
-      colDataSetNULL(pDstColInfo, rowIndex);
-    }
-  }
+  SGroupKeys* pKey = taosArrayGet(p->pRowVal, colIdx);
+  doSetNKeyVal(pDstColInfo, pKey, start, numOfRows);
 }
 
-static void doSetUserSpecifiedValue(SColumnInfoData* pDst, SVariant* pVar, int32_t rowIndex, int64_t currentKey) {
+static void doSetUserSpecifiedValue(SColumnInfoData* pDst, SVariant* pVar, int32_t start, int32_t numOfRows,
+                                    const int64_t* pKeys) {
   if (pDst->info.type == TSDB_DATA_TYPE_FLOAT) {
     float v = 0;
     GET_TYPED_DATA(v, float, pVar->nType, &pVar->i);
-    colDataSetVal(pDst, rowIndex, (char*)&v, false);
+    doSetNVal(pDst, start, numOfRows, (char*)&v);
   } else if (pDst->info.type == TSDB_DATA_TYPE_DOUBLE) {
     double v = 0;
     GET_TYPED_DATA(v, double, pVar->nType, &pVar->i);
-    colDataSetVal(pDst, rowIndex, (char*)&v, false);
+    doSetNVal(pDst, start, numOfRows, (char*)&v);
   } else if (IS_SIGNED_NUMERIC_TYPE(pDst->info.type)) {
     int64_t v = 0;
     GET_TYPED_DATA(v, int64_t, pVar->nType, &pVar->i);
-    colDataSetVal(pDst, rowIndex, (char*)&v, false);
+    doSetNVal(pDst, start, numOfRows, (char*)&v);
   } else if (pDst->info.type == TSDB_DATA_TYPE_TIMESTAMP) {
-    colDataSetVal(pDst, rowIndex, (const char*)&currentKey, false);
+    memcpy(pDst->pData + (int64_t)start * sizeof(int64_t), pKeys, (int64_t)numOfRows * sizeof(int64_t));
   } else {  // varchar/nchar data
-    colDataSetNULL(pDst, rowIndex);
+    colDataSetNNULL(pDst, start, numOfRows);
   }
 }
 
-// fill windows pseudo column, _wstart, _wend, _wduration and return true, otherwise return false
-bool fillIfWindowPseudoColumn(SFillInfo* pFillInfo, SFillColInfo* pCol, SColumnInfoData* pDstColInfoData,
-                              int32_t rowIndex) {
+// return the type of the window pseudo column, _wstart, _wend or _wduration, otherwise return 0
+static int32_t getWindowPseudoColumnType(SFillColInfo* pCol) {
   if (!pCol->notFillCol) {
-    return false;
+    return 0;
   }
   if (pCol->pExpr->pExpr->nodeType == QUERY_NODE_COLUMN) {
     if (pCol->pExpr->base.numOfParams != 1) {
-      return false;
+      return 0;
     }
-    if (pCol->pExpr->base.pParam[0].pCol->colType == COLUMN_TYPE_WINDOW_START) {
-      colDataSetVal(pDstColInfoData, rowIndex, (const char*)&pFillInfo->currentKey, false);
-      return true;
-    } else if (pCol->pExpr->base.pParam[0].pCol->colType == COLUMN_TYPE_WINDOW_END) {
-      // TODO: include endpoint
-      SInterval* pInterval = &pFillInfo->interval;
-      int64_t    windowEnd =
-          taosTimeAdd(pFillInfo->currentKey, pInterval->interval, pInterval->intervalUnit, pInterval->precision);
-      colDataSetVal(pDstColInfoData, rowIndex, (const char*)&windowEnd, false);
-      return true;
-    } else if (pCol->pExpr->base.pParam[0].pCol->colType == COLUMN_TYPE_WINDOW_DURATION) {
-      // TODO: include endpoint
-      colDataSetVal(pDstColInfoData, rowIndex, (const char*)&pFillInfo->interval.sliding, false);
-      return true;
+    int32_t colType = pCol->pExpr->base.pParam[0].pCol->colType;
+    if (colType == COLUMN_TYPE_WINDOW_START || colType == COLUMN_TYPE_WINDOW_END ||
+        colType == COLUMN_TYPE_WINDOW_DURATION) {
+      return colType;
     }
   }
-  return false;
+  return 0;
 }
 
-static void doFillOneRow(SFillInfo* pFillInfo, SSDataBlock* pBlock, SSDataBlock* pSrcBlock, int64_t ts,
-                         bool outOfBound) {
-  SPoint  point1, point2, point;
-  int32_t step = GET_FORWARD_DIRECTION_FACTOR(pFillInfo->order);
-
-  // set the primary timestamp column value
-  int32_t index = pBlock->info.rows;
-
-  // set the other values
-  if (pFillInfo->type == TSDB_FILL_PREV) {
-    for (int32_t i = 0; i < pFillInfo->numOfCols; ++i) {
-      SFillColInfo* pCol = &pFillInfo->pFillCol[i];
+// fill windows pseudo column, _wstart, _wend, _wduration and return true, otherwise return false
+bool fillIfWindowPseudoColumn(SFillInfo* pFillInfo, SFillColInfo* pCol, SColumnInfoData* pDstColInfoData,
+                              int32_t rowIndex) {
+  int32_t colType = getWindowPseudoColumnType(pCol);
+  if (colType == COLUMN_TYPE_WINDOW_START) {
+    colDataSetVal(pDstColInfoData, rowIndex, (const char*)&pFillInfo->currentKey, false);
+    return true;
+  } else if (colType == COLUMN_TYPE_WINDOW_END) {
+    // TODO: include endpoint
+    SInterval* pInterval = &pFillInfo->interval;
+    int64_t    windowEnd =
+        taosTimeAdd(pFillInfo->currentKey, pInterval->interval, pInterval->intervalUnit, pInterval->precision);
+    colDataSetVal(pDstColInfoData, rowIndex, (const char*)&windowEnd, false);
+    return true;
+  } else if (colType == COLUMN_TYPE_WINDOW_DURATION) {
+    // TODO: include endpoint
+    colDataSetVal(pDstColInfoData, rowIndex, (const char*)&pFillInfo->interval.sliding, false);
+    return true;
+  }
+  return false;
+}
 
-      SColumnInfoData* pDstColInfoData = taosArrayGet(pBlock->pDataBlock, GET_DEST_SLOT_ID(pCol));
-      bool             filled = fillIfWindowPseudoColumn(pFillInfo, pCol, pDstColInfoData, index);
-      if (!filled) {
-        setNotFillColumn(pFillInfo, pDstColInfoData, index, i);
-      }
-    }
-  } else if (pFillInfo->type == TSDB_FILL_NEXT) {
-    // todo  refactor: start from 0 not 1
-    for (int32_t i = 0; i < pFillInfo->numOfCols; ++i) {
-      SFillColInfo*    pCol = &pFillInfo->pFillCol[i];
-      SColumnInfoData* pDstColInfoData = taosArrayGet(pBlock->pDataBlock, GET_DEST_SLOT_ID(pCol));
-      bool             filled = fillIfWindowPseudoColumn(pFillInfo, pCol, pDstColInfoData, index);
-      if (!filled) {
-        setNotFillColumn(pFillInfo, pDstColInfoData, index, i);
-      }
+static bool fillWindowPseudoColumnRows(SFillInfo* pFillInfo, SFillColInfo* pCol, SColumnInfoData* pDst, int32_t start,
+                                       int32_t numOfRows, const int64_t* pKeys) {
+  int32_t colType = getWindowPseudoColumnType(pCol);
+  if (colType == COLUMN_TYPE_WINDOW_START) {
+    memcpy(pDst->pData + (int64_t)start * sizeof(int64_t), pKeys, (int64_t)numOfRows * sizeof(int64_t));
+    return true;
+  } else if (colType == COLUMN_TYPE_WINDOW_END) {
+    SInterval* pInterval = &pFillInfo->interval;
+    int64_t*   p = (int64_t*)pDst->pData + start;
+    for (int32_t i = 0; i < numOfRows; ++i) {
+      p[i] = taosTimeAdd(pKeys[i], pInterval->interval, pInterval->intervalUnit, pInterval->precision);
     }
-  } else if (pFillInfo->type == TSDB_FILL_LINEAR) {
-    // TODO : linear interpolation supports NULL value
-    if (outOfBound) {
-      setNullRow(pBlock, pFillInfo, index);
-    } else {
-      for (int32_t i = 0; i < pFillInfo->numOfCols; ++i) {
-        SFillColInfo* pCol = &pFillInfo->pFillCol[i];
-
-        int32_t          dstSlotId = GET_DEST_SLOT_ID(pCol);
-        SColumnInfoData* pDstCol = taosArrayGet(pBlock->pDataBlock, dstSlotId);
-        int16_t          type = pDstCol->info.type;
+    return true;
+  } else if (colType == COLUMN_TYPE_WINDOW_DURATION) {
+    doSetNVal(pDst, start, numOfRows, (const char*)&pFillInfo->interval.sliding);
+    return true;
+  }
+  return false;
+}
 
-        if (pCol->notFillCol) {
-          bool filled = fillIfWindowPseudoColumn(pFillInfo, pCol, pDstCol, index);
-          if (!filled) {
-            setNotFillColumn(pFillInfo, pDstCol, index, i);
-          }
-        } else {
-          SGroupKeys* pKey = taosArrayGet(pFillInfo->prev.pRowVal, i);
-          if (IS_VAR_DATA_TYPE(type) || type == TSDB_DATA_TYPE_BOOL || pKey->isNull) {
-            colDataSetNULL(pDstCol, index);
-            continue;
-          }
+#define DO_INTERPOLATION_ROWS(_t, _p, _v1, _v2, _k1, _k2, _keys, _n)          \
+  do {                                                                       \
+    _t* _d = (_t*)(_p);                                                      \
+    for (int32_t _i = 0; _i < (_n); ++_i) {                                  \
+      _d[_i] = (_t)DO_INTERPOLATION(_v1, _v2, _k1, _k2, (_keys)[_i]);        \
+    }                                                                        \
+  } while (0)
+
+// linear interpolation of the rows between the point (k1, v1) and (k2, v2), at the keys given
+static void doInterpolateRows(SColumnInfoData* pDst, int32_t start, int32_t numOfRows, double v1, double v2, int64_t k1,
+                              int64_t k2, const int64_t* pKeys) {
+  char* p = pDst->pData + (int64_t)start * pDst->info.bytes;
+  switch (pDst->info.type) {
+    case TSDB_DATA_TYPE_TINYINT:
+      DO_INTERPOLATION_ROWS(int8_t, p, v1, v2, k1, k2, pKeys, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_UTINYINT:
+      DO_INTERPOLATION_ROWS(uint8_t, p, v1, v2, k1, k2, pKeys, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      DO_INTERPOLATION_ROWS(int16_t, p, v1, v2, k1, k2, pKeys, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_USMALLINT:
+      DO_INTERPOLATION_ROWS(uint16_t, p, v1, v2, k1, k2, pKeys, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_INT:
+      DO_INTERPOLATION_ROWS(int32_t, p, v1, v2, k1, k2, pKeys, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_UINT:
+      DO_INTERPOLATION_ROWS(uint32_t, p, v1, v2, k1, k2, pKeys, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      DO_INTERPOLATION_ROWS(int64_t, p, v1, v2, k1, k2, pKeys, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_UBIGINT:
+      DO_INTERPOLATION_ROWS(uint64_t, p, v1, v2, k1, k2, pKeys, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      DO_INTERPOLATION_ROWS(float, p, v1, v2, k1, k2, pKeys, numOfRows);
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      DO_INTERPOLATION_ROWS(double, p, v1, v2, k1, k2, pKeys, numOfRows);
+      break;
+    default:
+      break;
+  }
+}
 
-          SGroupKeys* pKey1 = taosArrayGet(pFillInfo->prev.pRowVal, pFillInfo->tsSlotId);
+// generate the keys of the rows to fill, till the key reaches ts or the number of rows reaches maxRows
+static int32_t genFillKeys(SFillInfo* pFillInfo, int64_t ts, bool outOfBound, int32_t maxRows) {
+  SInterval* pInterval = &pFillInfo->interval;
+  int32_t    step = GET_FORWARD_DIRECTION_FACTOR(pFillInfo->order);
+  bool       ascFill = FILL_IS_ASC_FILL(pFillInfo);
+  int64_t    key = pFillInfo->currentKey;
+  int32_t    numOfRows = 0;
+
+  while (numOfRows < maxRows && (outOfBound || (key < ts && ascFill) || (key > ts && !ascFill))) {
+    pFillInfo->pKeyBuf[numOfRows++] = key;
+    key = taosTimeAdd(key, pInterval->sliding * step, pInterval->slidingUnit, pInterval->precision);
+  }
 
-          int64_t prevTs = *(int64_t*)pKey1->pData;
-          int32_t srcSlotId = GET_DEST_SLOT_ID(pCol);
+  return numOfRows;
+}
 
-          SColumnInfoData* pSrcCol = taosArrayGet(pSrcBlock->pDataBlock, srcSlotId);
-          char*            data = colDataGetData(pSrcCol, pFillInfo->index);
+// fill the gap rows column by column, at most FILL_KEY_BUF_ROWS rows in one round
+static int32_t doFillNRows(SFillInfo* pFillInfo, SSDataBlock* pBlock, SSDataBlock* pSrcBlock, int64_t ts,
+                           bool outOfBound, int32_t maxRows) {
+  int32_t numOfRows = genFillKeys(pFillInfo, ts, outOfBound, TMIN(maxRows, FILL_KEY_BUF_ROWS));
+  if (numOfRows == 0) {
+    return 0;
+  }
 
-          point1 = (SPoint){.key = prevTs, .val = pKey->pData};
-          point2 = (SPoint){.key = ts, .val = data};
+  const int64_t* pKeys = pFillInfo->pKeyBuf;
+  int32_t        start = pBlock->info.rows;
 
-          int64_t out = 0;
-          point = (SPoint){.key = pFillInfo->currentKey, .val = &out};
-          taosGetLinearInterpolationVal(&point, type, &point1, &point2, type);
+  for (int32_t i = 0; i < pFillInfo->numOfCols; ++i) {
+    SFillColInfo*    pCol = &pFillInfo->pFillCol[i];
+    SColumnInfoData* pDst = taosArrayGet(pBlock->pDataBlock, GET_DEST_SLOT_ID(pCol));
 
-          colDataSetVal(pDstCol, index, (const char*)&out, false);
-        }
+    if (pCol->notFillCol || pFillInfo->type == TSDB_FILL_PREV || pFillInfo->type == TSDB_FILL_NEXT) {
+      bool filled = fillWindowPseudoColumnRows(pFillInfo, pCol, pDst, start, numOfRows, pKeys);
+      if (!filled) {
+        setNotFillColumn(pFillInfo, pDst, start, numOfRows, i);
+      }
+    } else if (pFillInfo->type == TSDB_FILL_LINEAR) {
+      // TODO : linear interpolation supports NULL value
+      int16_t     type = pDst->info.type;
+      SGroupKeys* pKey = taosArrayGet(pFillInfo->prev.pRowVal, i);
+      if (outOfBound || IS_VAR_DATA_TYPE(type) || type == TSDB_DATA_TYPE_BOOL || pKey->isNull) {
+        colDataSetNNULL(pDst, start, numOfRows);
+        continue;
       }
-    }
-  } else if (pFillInfo->type == TSDB_FILL_NULL || pFillInfo->type == TSDB_FILL_NULL_F) {  // fill with NULL
-    setNullRow(pBlock, pFillInfo, index);
-  } else {  // fill with user specified value for each column
-    for (int32_t i = 0; i < pFillInfo->numOfCols; ++i) {
-      SFillColInfo* pCol = &pFillInfo->pFillCol[i];
 
-      int32_t          slotId = GET_DEST_SLOT_ID(pCol);
-      SColumnInfoData* pDst = taosArrayGet(pBlock->pDataBlock, slotId);
+      SGroupKeys* pKey1 = taosArrayGet(pFillInfo->prev.pRowVal, pFillInfo->tsSlotId);
+      int64_t     prevTs = *(int64_t*)pKey1->pData;
 
-      if (pCol->notFillCol) {
-        bool filled = fillIfWindowPseudoColumn(pFillInfo, pCol, pDst, index);
-        if (!filled) {
-          setNotFillColumn(pFillInfo, pDst, index, i);
-        }
-      } else {
-        SVariant* pVar = &pFillInfo->pFillCol[i].fillVal;
-        doSetUserSpecifiedValue(pDst, pVar, index, pFillInfo->currentKey);
-      }
+      SColumnInfoData* pSrcCol = taosArrayGet(pSrcBlock->pDataBlock, GET_DEST_SLOT_ID(pCol));
+      char*            data = colDataGetData(pSrcCol, pFillInfo->index);
+
+      double v1 = -1, v2 = -1;
+      GET_TYPED_DATA(v1, double, type, pKey->pData);
+      GET_TYPED_DATA(v2, double, type, data);
+      doInterpolateRows(pDst, start, numOfRows, v1, v2, prevTs, ts, pKeys);
+    } else if (pFillInfo->type == TSDB_FILL_NULL || pFillInfo->type == TSDB_FILL_NULL_F) {  // fill with NULL
+      colDataSetNNULL(pDst, start, numOfRows);
+    } else {  // fill with user specified value for each column
+      doSetUserSpecifiedValue(pDst, &pCol->fillVal, start, numOfRows, pKeys);
     }
   }
 
   //  setTagsValue(pFillInfo, data, index);
   SInterval* pInterval = &pFillInfo->interval;
-  pFillInfo->currentKey =
-      taosTimeAdd(pFillInfo->currentKey, pInterval->sliding * step, pInterval->slidingUnit, pInterval->precision);
-  pBlock->info.rows += 1;
-  pFillInfo->numOfCurrent++;
+  int32_t    step = GET_FORWARD_DIRECTION_FACTOR(pFillInfo->order);
+  pFillInfo->currentKey = taosTimeAdd(pKeys[numOfRows - 1], pInterval->sliding * step, pInterval->slidingUnit,
+                                      pInterval->precision);
+  pBlock->info.rows += numOfRows;
+  pFillInfo->numOfCurrent += numOfRows;
+  return numOfRows;
+}
+
+// fill the gap rows, till the current key reaches ts or maxRows rows are filled
+static void doFillRows(SFillInfo* pFillInfo, SSDataBlock* pBlock, SSDataBlock* pSrcBlock, int64_t ts, bool outOfBound,
+                       int32_t maxRows) {
+  int32_t numOfRows = 0;
+  while (numOfRows < maxRows) {
+    int32_t n = doFillNRows(pFillInfo, pBlock, pSrcBlock, ts, outOfBound, maxRows - numOfRows);
+    if (n == 0) {
+      break;
+    }
+    numOfRows += n;
+  }
 }
 
 void doSetVal(SColumnInfoData* pDstCol, int32_t rowIndex, const SGroupKeys* pKey) {
@@ -302,10 +381,7 @@ static int32_t fillResultImpl(SFillInfo* pFillInfo, SSDataBlock* pBlock, int32_t
     if (((pFillInfo->currentKey < ts && ascFill) || (pFillInfo->currentKey > ts && !ascFill)) &&
         pFillInfo->numOfCurrent < outputRows) {
       // fill the gap between two input rows
-      while (((pFillInfo->currentKey < ts && ascFill) || (pFillInfo->currentKey > ts && !ascFill)) &&
-             pFillInfo->numOfCurrent < outputRows) {
-        doFillOneRow(pFillInfo, pBlock, pFillInfo->pSrcBlock, ts, false);
-      }
+      doFillRows(pFillInfo, pBlock, pFillInfo->pSrcBlock, ts, false, outputRows - pFillInfo->numOfCurrent);
 
       // output buffer is full, abort
       if (pFillInfo->numOfCurrent == outputRows) {
@@ -357,7 +433,7 @@ static int32_t fillResultImpl(SFillInfo* pFillInfo, SSDataBlock* pBlock, int32_t
               doSetVal(pDst, index, pKey);
             } else {
               SVariant* pVar = &pFillInfo->pFillCol[i].fillVal;
-              doSetUserSpecifiedValue(pDst, pVar, index, pFillInfo->currentKey);
+              doSetUserSpecifiedValue(pDst, pVar, index, 1, &pFillInfo->currentKey);
             }
           }
         }
@@ -402,9 +478,7 @@ static int64_t appendFilledResult(SFillInfo* pFillInfo, SSDataBlock* pBlock, int
    * real result set. Note that we need to keep the direct previous result rows, to generated the filled data.
    */
   pFillInfo->numOfCurrent = 0;
-  while (pFillInfo->numOfCurrent < resultCapacity) {
-    doFillOneRow(pFillInfo, pBlock, pFillInfo->pSrcBlock, pFillInfo->start, true);
-  }
+  doFillRows(pFillInfo, pBlock, pFillInfo->pSrcBlock, pFillInfo->start, true, resultCapacity);
 
   pFillInfo->numOfTotal += pFillInfo->numOfCurrent;
 
@@ -457,6 +531,14 @@ struct SFillInfo* taosCreateFillInfo(TSKEY skey, int32_t numOfFillCols, int32_t
   pFillInfo->next.pRowVal = taosArrayInit(pFillInfo->numOfCols, sizeof(SGroupKeys));
   pFillInfo->prev.pRowVal = taosArrayInit(pFillInfo->numOfCols, sizeof(SGroupKeys));
 
+  pFillInfo->pKeyBuf = taosMemoryMalloc(FILL_KEY_BUF_ROWS * sizeof(int64_t));
+  if (pFillInfo->pKeyBuf == NULL) {
+    pFillInfo->pFillCol = NULL;
+    taosDestroyFillInfo(pFillInfo);
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return NULL;
+  }
+
   initBeforeAfterDataBuf(pFillInfo);
   return pFillInfo;
 }
@@ -506,6 +588,7 @@ void* taosDestroyFillInfo(SFillInfo* pFillInfo) {
     }
   }
 
+  taosMemoryFreeClear(pFillInfo->pKeyBuf);
   taosMemoryFreeClear(pFillInfo->pTags);
   taosMemoryFreeClear(pFillInfo->pFillCol);
   taosMemoryFreeClear(pFillInfo);
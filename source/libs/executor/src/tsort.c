@@ -20,6 +20,7 @@
 #include "tdatablock.h"
 #include "tdef.h"
 #include "tlosertree.h"
+#include "tmemtracker.h"
 #include "tpagedbuf.h"
 #include "tsort.h"
 #include "tutil.h"
@@ -56,6 +57,9 @@ struct SSortHandle {
   _sort_fetch_block_fn_t  fetchfp;
   _sort_merge_compar_fn_t comparFn;
   SMultiwayMergeTreeInfo* pMergeTree;
+
+  SMemTracker* pMemTracker;  // charged with the rows buffered for the in-memory sort
+  int64_t      memUsed;
 };
 
 static int32_t msortComparFn(const void* pLeft, const void* pRight, void* param);
@@ -93,6 +97,11 @@ SSortHandle* tsortCreateSortHandle(SArray* pSortInfo, int32_t type, int32_t page
     pSortHandle->idStr = taosStrdup(idstr);
   }
 
+  SMemTracker* pParent = taosMemTrackerCurrent();
+  if (pParent != NULL) {
+    pSortHandle->pMemTracker = taosMemTrackerCreate("sort", 0, pParent);
+  }
+
   return pSortHandle;
 }
 
@@ -147,6 +156,9 @@ void tsortDestroySortHandle(SSortHandle* pSortHandle) {
   taosMemoryFreeClear(pSortHandle->idStr);
   blockDataDestroy(pSortHandle->pDataBlock);
 
+  taosMemTrackerRelease(pSortHandle->pMemTracker, pSortHandle->memUsed);
+  taosMemTrackerUnref(pSortHandle->pMemTracker);
+
   tsortClearOrderdSource(pSortHandle->pOrderedSource);
   taosArrayDestroy(pSortHandle->pOrderedSource);
   taosMemoryFreeClear(pSortHandle);
@@ -227,6 +239,7 @@ static int32_t doAddToBuf(SSDataBlock* pDataBlock, SSortHandle* pHandle) {
 
     setBufPageDirty(pPage, true);
     releaseBufPage(pHandle->pBuf, pPage);
+    dBufSetBufPageEvictFirst(pHandle->pBuf, pPage);
 
     blockDataDestroy(p);
     start = stop + 1;
@@ -243,6 +256,35 @@ static void setCurrentSourceDone(SSortSource* pSource, SSortHandle* pHandle) {
   ++pHandle->numOfCompletedSources;
 }
 
+// load the current page of a sorted run into the block of the source. The page is read only once, so it is recycled
+// right away and its file area is reused by the pages of the next round, and the next page is read ahead.
+static int32_t loadSourcePage(SSortHandle* pHandle, SSortSource* pSource) {
+  int32_t* pPgId = taosArrayGet(pSource->pageIdList, pSource->pageIndex);
+
+  void* pPage = getBufPage(pHandle->pBuf, *pPgId);
+  if (pPage == NULL) {
+    return terrno;
+  }
+
+  int32_t code = blockDataFromBuf(pSource->src.pBlock, pPage);
+  if (code != TSDB_CODE_SUCCESS) {
+    releaseBufPage(pHandle->pBuf, pPage);
+    return code;
+  }
+
+  dBufSetBufPageRecycled(pHandle->pBuf, pPage);
+
+  if (pSource->pageIndex + 1 < taosArrayGetSize(pSource->pageIdList)) {
+    int32_t* pNextPgId = taosArrayGet(pSource->pageIdList, pSource->pageIndex + 1);
+    code = dBufPrefetchPage(pHandle->pBuf, *pNextPgId);
+    if (code != TSDB_CODE_SUCCESS) {
+      qWarn("failed to read ahead page:%d, code:%s, %s", *pNextPgId, tstrerror(code), pHandle->idStr);
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
 static int32_t sortComparInit(SMsortComparParam* pParam, SArray* pSources, int32_t startIndex, int32_t endIndex,
                               SSortHandle* pHandle) {
   pParam->pSources = taosArrayGet(pSources, startIndex);
@@ -278,20 +320,11 @@ static int32_t sortComparInit(SMsortComparParam* pParam, SArray* pSources, int32
         continue;
       }
 
-      int32_t* pPgId = taosArrayGet(pSource->pageIdList, pSource->pageIndex);
-
-      void* pPage = getBufPage(pHandle->pBuf, *pPgId);
-      if (NULL == pPage) {
-        return terrno;
-      }
-      
-      code = blockDataFromBuf(pSource->src.pBlock, pPage);
+      code = loadSourcePage(pHandle, pSource);
       if (code != TSDB_CODE_SUCCESS) {
         terrno = code;
         return code;
       }
-
-      releaseBufPage(pHandle->pBuf, pPage);
     }
   } else {
     qDebug("start init for the multiway merge sort, %s", pHandle->idStr);
@@ -350,20 +383,11 @@ static int32_t adjustMergeTreeForNextTuple(SSortSource* pSource, SMultiwayMergeT
         pSource->pageIndex = -1;
         pSource->src.pBlock = blockDataDestroy(pSource->src.pBlock);
       } else {
-        int32_t* pPgId = taosArrayGet(pSource->pageIdList, pSource->pageIndex);
-
-        void*   pPage = getBufPage(pHandle->pBuf, *pPgId);
-        if (pPage == NULL) {
-          qError("failed to get buffer, code:%s", tstrerror(terrno));
-          return terrno;
-        }
-
-        int32_t code = blockDataFromBuf(pSource->src.pBlock, pPage);
+        int32_t code = loadSourcePage(pHandle, pSource);
         if (code != TSDB_CODE_SUCCESS) {
+          qError("failed to get buffer, code:%s", tstrerror(code));
           return code;
         }
-
-        releaseBufPage(pHandle->pBuf, pPage);
       }
     } else {
       pSource->src.pBlock = pHandle->fetchfp(((SSortSource*)pSource)->param);
@@ -587,6 +611,7 @@ static int32_t doInternalMergeSort(SSortHandle* pHandle) {
 
         setBufPageDirty(pPage, true);
         releaseBufPage(pHandle->pBuf, pPage);
+        dBufSetBufPageEvictFirst(pHandle->pBuf, pPage);
 
         blockDataCleanup(pDataBlock);
       }
@@ -613,8 +638,12 @@ static int32_t doInternalMergeSort(SSortHandle* pHandle) {
     pHandle->totalElapsed += el;
 
     SDiskbasedBufStatis statis = getDBufStatis(pHandle->pBuf);
-    qDebug("%s %d round mergesort, elapsed:%" PRId64 " readDisk:%.2f Kb, flushDisk:%.2f Kb", pHandle->idStr, t + 1, el,
-           statis.loadBytes / 1024.0, statis.flushBytes / 1024.0);
+    qDebug("%s %d round mergesort, elapsed:%" PRId64 " readDisk:%.2f Kb, flushDisk:%.2f Kb (raw:%.2f Kb), "
+           "write:%.2f Mb/s, read:%.2f Mb/s, prefetch hit:%d/%d",
+           pHandle->idStr, t + 1, el, statis.loadBytes / 1024.0, statis.flushBytes / 1024.0,
+           statis.rawFlushBytes / 1024.0, statis.flushUs > 0 ? statis.flushBytes / (1.048576 * statis.flushUs) : 0.0,
+           statis.loadUs > 0 ? statis.loadBytes / (1.048576 * statis.loadUs) : 0.0, statis.prefetchHitPages,
+           statis.prefetchPages);
 
     if (pHandle->type == SORT_MULTISOURCE_MERGE) {
       pHandle->type = SORT_SINGLESOURCE_SORT;
@@ -636,6 +665,29 @@ int32_t getProperSortPageSize(size_t rowSize, uint32_t numOfCols) {
   return pgSize;
 }
 
+// charge the rows buffered for the in-memory sort, false means the query is out of memory budget and they should be
+// flushed into disk now
+static bool tryConsumeSortBuf(SSortHandle* pHandle, size_t size) {
+  int64_t delta = (int64_t)size - pHandle->memUsed;
+  if (pHandle->pMemTracker == NULL || delta <= 0) {
+    return true;
+  }
+
+  if (!taosMemTrackerTryConsume(pHandle->pMemTracker, delta)) {
+    qDebug("sort buffer of %" PRId64 " bytes out of memory budget, flush to disk, %s", pHandle->memUsed + delta,
+           pHandle->idStr);
+    return false;
+  }
+
+  pHandle->memUsed = size;
+  return true;
+}
+
+static void releaseSortBuf(SSortHandle* pHandle) {
+  taosMemTrackerRelease(pHandle->pMemTracker, pHandle->memUsed);
+  pHandle->memUsed = 0;
+}
+
 static int32_t createInitialSources(SSortHandle* pHandle) {
   size_t sortBufSize = pHandle->numOfPages * pHandle->pageSize;
   int32_t code = 0;
@@ -681,7 +733,7 @@ static int32_t createInitialSources(SSortHandle* pHandle) {
       }
 
       size_t size = blockDataGetSize(pHandle->pDataBlock);
-      if (size > sortBufSize) {
+      if (size > sortBufSize || !tryConsumeSortBuf(pHandle, size)) {
         // Perform the in-memory sort and then flush data in the buffer into disk.
         int64_t p = taosGetTimestampUs();
         code = blockDataSort(pHandle->pDataBlock, pHandle->pSortInfo);
@@ -705,6 +757,8 @@ static int32_t createInitialSources(SSortHandle* pHandle) {
         if (code != TSDB_CODE_SUCCESS) {
           return code;
         }
+
+        releaseSortBuf(pHandle);
       }
     }
 
@@ -739,6 +793,7 @@ static int32_t createInitialSources(SSortHandle* pHandle) {
         return 0;
       } else {
         code = doAddToBuf(pHandle->pDataBlock, pHandle);
+        releaseSortBuf(pHandle);
       }
     }
   }
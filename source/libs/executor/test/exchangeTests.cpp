@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "os.h"
+
+#include "executorimpl.h"
+#include "plannodes.h"
+#include "tglobal.h"
+
+namespace {
+
+const int32_t exchangeTestSourceNum = 2;
+
+// The fetch msgs are not sent, the test plays the rsp callback and the downstream against the state of the sources.
+class ExchangeTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    pInfo_ = (SExchangeInfo *)taosMemoryCalloc(1, sizeof(SExchangeInfo));
+    pInfo_->pSources = taosArrayInit(exchangeTestSourceNum, sizeof(SDownstreamSourceNode));
+    for (int32_t i = 0; i < exchangeTestSourceNum; ++i) {
+      SDownstreamSourceNode source = {QUERY_NODE_DOWNSTREAM_SOURCE};
+      source.taskId = i + 1;
+      taosArrayPush(pInfo_->pSources, &source);
+    }
+    ASSERT_EQ(initDataSource(exchangeTestSourceNum, pInfo_, "exchangeTest"), TSDB_CODE_SUCCESS);
+
+    tsem_init(&pInfo_->ready, 0, 0);
+    taosThreadMutexInit(&pInfo_->lock, NULL);
+    pInfo_->fetchWindow = 2;
+    pInfo_->bufferSize = 1048576L;
+  }
+
+  void TearDown() override { doDestroyExchangeOperatorInfo(pInfo_); }
+
+  SSourceDataInfo *source(int32_t index) { return (SSourceDataInfo *)taosArrayGet(pInfo_->pSourceDataInfo, index); }
+
+  // a rsp of the given rows and compressed size as converted by the rsp callback
+  bool addRsp(int32_t index, int64_t numOfRows, bool completed = false, int32_t compLen = 64) {
+    SRetrieveTableRsp *pRsp = (SRetrieveTableRsp *)taosMemoryCalloc(1, sizeof(SRetrieveTableRsp));
+    pRsp->numOfRows = numOfRows;
+    pRsp->completed = completed;
+    pRsp->compLen = compLen;
+    return addSourceRsp(pInfo_, index, pRsp, TSDB_CODE_SUCCESS);
+  }
+
+  // the rows of the rsp taken by the downstream, -1 if there is none
+  int64_t takeRsp(int32_t index) {
+    SSourceDataInfo *pDataInfo = source(index);
+    if (!takeSourceRsp(pInfo_, pDataInfo)) {
+      return -1;
+    }
+
+    int64_t numOfRows = pDataInfo->pRsp->numOfRows;
+    taosMemoryFreeClear(pDataInfo->pRsp);
+    return numOfRows;
+  }
+
+  SExchangeInfo *pInfo_ = nullptr;
+};
+
+}  // namespace
+
+TEST_F(ExchangeTest, prefetchWithinWindow) {
+  // the first fetch is asked for by the downstream, only once while it is in flight
+  ASSERT_TRUE(needFetchSource(pInfo_, 0));
+  ASSERT_FALSE(needFetchSource(pInfo_, 0));
+
+  // the next one is sent by the callback ahead of the downstream, until the window is full
+  ASSERT_TRUE(addRsp(0, 10));
+  ASSERT_FALSE(addRsp(0, 20));
+  EXPECT_FALSE(needFetchSource(pInfo_, 0));
+
+  // taking a rsp makes room for one more, which is fetched at once and not when the window runs dry
+  EXPECT_EQ(takeRsp(0), 10);
+  ASSERT_TRUE(needFetchSource(pInfo_, 0));
+  ASSERT_FALSE(needFetchSource(pInfo_, 0));
+  ASSERT_FALSE(addRsp(0, 30));
+
+  EXPECT_EQ(takeRsp(0), 20);
+  EXPECT_EQ(takeRsp(0), 30);
+  EXPECT_EQ(takeRsp(0), -1);
+  EXPECT_EQ(source(0)->status, EX_SOURCE_DATA_NOT_READY);
+  EXPECT_EQ(pInfo_->bufferedBytes, 0);
+}
+
+TEST_F(ExchangeTest, prefetchOnlyNeededSources) {
+  // the rsps held for the downstream are capped in bytes, the downstream is never kept waiting by it
+  pInfo_->bufferSize = 1;
+  ASSERT_TRUE(needFetchSource(pInfo_, 0));
+  ASSERT_FALSE(addRsp(0, 10));
+  EXPECT_FALSE(needFetchSource(pInfo_, 0));
+  EXPECT_EQ(takeRsp(0), 10);
+  EXPECT_TRUE(needFetchSource(pInfo_, 0));
+  ASSERT_FALSE(addRsp(0, 10));
+  EXPECT_EQ(takeRsp(0), 10);
+  pInfo_->bufferSize = 1048576L;
+
+  // in the sequential mode only the source read by the downstream is fetched ahead
+  pInfo_->seqLoadData = true;
+  pInfo_->current = 0;
+  ASSERT_TRUE(needFetchSource(pInfo_, 1));
+  ASSERT_FALSE(addRsp(1, 10));
+  EXPECT_EQ(takeRsp(1), 10);
+  pInfo_->current = 1;
+  ASSERT_TRUE(needFetchSource(pInfo_, 1));
+  ASSERT_TRUE(addRsp(1, 10));
+  EXPECT_EQ(takeRsp(1), 10);
+
+  // nor is any source once the downstream has stopped
+  pInfo_->fetchStopped = true;
+  ASSERT_FALSE(addRsp(1, 10));
+  EXPECT_FALSE(needFetchSource(pInfo_, 1));
+}
+
+TEST_F(ExchangeTest, endOfSource) {
+  ASSERT_TRUE(needFetchSource(pInfo_, 0));
+  ASSERT_TRUE(addRsp(0, 10));
+  ASSERT_FALSE(addRsp(0, 10, true));
+  EXPECT_TRUE(source(0)->rspEnd);
+
+  // the rsps received ahead are still taken, nothing more is fetched for the source
+  EXPECT_EQ(takeRsp(0), 10);
+  EXPECT_FALSE(needFetchSource(pInfo_, 0));
+  EXPECT_EQ(takeRsp(0), 10);
+  EXPECT_FALSE(needFetchSource(pInfo_, 0));
+
+  // an empty rsp ends the source as well
+  ASSERT_TRUE(needFetchSource(pInfo_, 1));
+  ASSERT_FALSE(addRsp(1, 0));
+  EXPECT_FALSE(needFetchSource(pInfo_, 1));
+  EXPECT_EQ(takeRsp(1), 0);
+  EXPECT_FALSE(needFetchSource(pInfo_, 1));
+}
+
+TEST_F(ExchangeTest, errorPropagated) {
+  ASSERT_TRUE(needFetchSource(pInfo_, 0));
+  ASSERT_TRUE(addRsp(0, 10));
+  ASSERT_FALSE(addSourceRsp(pInfo_, 0, NULL, TSDB_CODE_RPC_BROKEN_LINK));
+
+  // the error stays visible to the downstream after the rsps before it are taken, and ends the fetches of the source
+  SSourceDataInfo *pDataInfo = source(0);
+  EXPECT_EQ(pDataInfo->code, TSDB_CODE_RPC_BROKEN_LINK);
+  EXPECT_EQ(pDataInfo->status, EX_SOURCE_DATA_READY);
+  EXPECT_EQ(takeRsp(0), 10);
+  EXPECT_EQ(pDataInfo->status, EX_SOURCE_DATA_READY);
+  EXPECT_FALSE(needFetchSource(pInfo_, 0));
+  EXPECT_EQ(takeRsp(0), -1);
+
+  // the other source is not affected
+  EXPECT_TRUE(needFetchSource(pInfo_, 1));
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Filled rows per second of each fill type, for a week of hourly rows filled at one second. Built with
+// -DBUILD_TEST=ON -DBUILD_BENCHMARK=ON, run as
+//   fillBench [rounds]
+// It only goes through the public fill API, so the same file builds against the row by row fill before the column
+// by column one, and the two runs compare the implementations.
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#include "os.h"
+
+#include "executorimpl.h"
+#include "function.h"
+#include "querynodes.h"
+#include "tdatablock.h"
+#include "tfill.h"
+
+namespace {
+
+const int32_t benchSrcRows = 24 * 7 + 1;
+const int64_t benchSrcStep = 3600 * 1000L;
+const int64_t benchFillStep = 1000L;
+const int32_t benchCapacity = 4096;
+
+SSDataBlock* benchCreateBlock(int32_t numOfRows) {
+  SSDataBlock* pBlock = createDataBlock();
+
+  SColumnInfoData ts = createColumnInfoData(TSDB_DATA_TYPE_TIMESTAMP, sizeof(int64_t), 1);
+  SColumnInfoData dval = createColumnInfoData(TSDB_DATA_TYPE_DOUBLE, sizeof(double), 2);
+  SColumnInfoData ival = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 3);
+  blockDataAppendColInfo(pBlock, &ts);
+  blockDataAppendColInfo(pBlock, &dval);
+  blockDataAppendColInfo(pBlock, &ival);
+
+  blockDataEnsureCapacity(pBlock, numOfRows);
+  return pBlock;
+}
+
+void benchFillSrcBlock(SSDataBlock* pBlock) {
+  for (int32_t i = 0; i < benchSrcRows; ++i) {
+    int64_t ts = i * benchSrcStep;
+    double  dval = ts / 1000;
+    int32_t ival = ts / 1000;
+    colDataSetVal((SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0), i, (const char*)&ts, false);
+    colDataSetVal((SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1), i, (const char*)&dval, false);
+    colDataSetVal((SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 2), i, (const char*)&ival, false);
+  }
+  pBlock->info.rows = benchSrcRows;
+}
+
+// the filled rows of one round, and the us spent in taosFillResultDataBlock
+int64_t benchFill(int32_t fillType, SSDataBlock* pSrc, SSDataBlock* pRes, int64_t* elapsed) {
+  // _wstart and the two columns to fill
+  SColumn     wstartCol = {0};
+  SFunctParam wstartParam = {0};
+  tExprNode   colNode = {0};
+  SExprInfo   fillExprs[2] = {0};
+  SExprInfo   notFillExpr = {0};
+
+  wstartCol.colType = COLUMN_TYPE_WINDOW_START;
+  wstartParam.type = FUNC_PARAM_TYPE_COLUMN;
+  wstartParam.pCol = &wstartCol;
+  colNode.nodeType = QUERY_NODE_COLUMN;
+
+  notFillExpr.pExpr = &colNode;
+  notFillExpr.base.resSchema.slotId = 0;
+  notFillExpr.base.resSchema.type = TSDB_DATA_TYPE_TIMESTAMP;
+  notFillExpr.base.resSchema.bytes = sizeof(int64_t);
+  notFillExpr.base.numOfParams = 1;
+  notFillExpr.base.pParam = &wstartParam;
+
+  for (int32_t i = 0; i < 2; ++i) {
+    fillExprs[i].pExpr = &colNode;
+    fillExprs[i].base.resSchema.slotId = i + 1;
+    fillExprs[i].base.resSchema.type = (i == 0) ? TSDB_DATA_TYPE_DOUBLE : TSDB_DATA_TYPE_INT;
+    fillExprs[i].base.resSchema.bytes = (i == 0) ? sizeof(double) : sizeof(int32_t);
+  }
+
+  SFillColInfo* pCol = createFillColInfo(fillExprs, 2, &notFillExpr, 1, NULL);
+  for (int32_t i = 0; i < 2; ++i) {
+    pCol[i].fillVal.nType = TSDB_DATA_TYPE_BIGINT;
+    pCol[i].fillVal.i = 7;
+  }
+
+  SInterval interval = {0};
+  interval.intervalUnit = 's';
+  interval.slidingUnit = 's';
+  interval.precision = TSDB_TIME_PRECISION_MILLI;
+  interval.interval = benchFillStep;
+  interval.sliding = benchFillStep;
+
+  int64_t    endTs = (benchSrcRows - 1) * benchSrcStep;
+  SFillInfo* pFillInfo =
+      taosCreateFillInfo(0, 2, 1, benchCapacity, &interval, fillType, pCol, 0, TSDB_ORDER_ASC, "fill_bench");
+  if (pFillInfo == NULL) {
+    return -1;
+  }
+
+  taosFillSetStartInfo(pFillInfo, benchSrcRows, endTs);
+  taosFillSetInputDataBlock(pFillInfo, pSrc);
+
+  int64_t total = 0;
+  while (taosFillHasMoreResults(pFillInfo)) {
+    blockDataCleanup(pRes);
+    blockDataEnsureCapacity(pRes, benchCapacity);
+
+    int64_t st = taosGetTimestampUs();
+    total += taosFillResultDataBlock(pFillInfo, pRes, benchCapacity);
+    *elapsed += taosGetTimestampUs() - st;
+  }
+
+  taosDestroyFillInfo(pFillInfo);
+  return total;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int32_t rounds = (argc > 1) ? atoi(argv[1]) : 20;
+
+  int32_t     fillTypes[] = {TSDB_FILL_NULL, TSDB_FILL_SET_VALUE, TSDB_FILL_PREV, TSDB_FILL_LINEAR};
+  const char* names[] = {"null", "value", "prev", "linear"};
+
+  SSDataBlock* pSrc = benchCreateBlock(benchSrcRows);
+  benchFillSrcBlock(pSrc);
+  SSDataBlock* pRes = benchCreateBlock(benchCapacity);
+
+  printf("%8s %12s %16s\n", "fill", "rows", "rows/s");
+  for (int32_t t = 0; t < sizeof(fillTypes) / sizeof(fillTypes[0]); ++t) {
+    int64_t total = 0;
+    int64_t elapsed = 0;
+    for (int32_t r = 0; r < rounds; ++r) {
+      int64_t numOfRows = benchFill(fillTypes[t], pSrc, pRes, &elapsed);
+      if (numOfRows < 0) {
+        printf("failed to create fill info\n");
+        return -1;
+      }
+      total += numOfRows;
+    }
+    printf("%8s %12" PRId64 " %16.0f\n", names[t], total, (double)total * 1000000 / TMAX(elapsed, 1));
+  }
+
+  blockDataDestroy(pSrc);
+  blockDataDestroy(pRes);
+  return 0;
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include "os.h"
+
+#include "executorimpl.h"
+#include "plannodes.h"
+#include "querynodes.h"
+#include "tdatablock.h"
+#include "tglobal.h"
+#include "tmemtracker.h"
+
+namespace {
+
+// the left input is (key int, val bigint) of block 1, the right input (key int, val double) of block 2
+const int16_t leftBlockId = 1;
+const int16_t rightBlockId = 2;
+const int16_t outputBlockId = 3;
+
+// the output slots are not in the order of the targets: (right val, left val, left key)
+const int16_t outRightValSlot = 0;
+const int16_t outLeftValSlot = 1;
+const int16_t outLeftKeySlot = 2;
+
+typedef struct SMockInputInfo {
+  std::vector<SSDataBlock*>* pBlocks;
+  size_t                     current;
+} SMockInputInfo;
+
+SSDataBlock* getMockInputBlock(SOperatorInfo* pOperator) {
+  SMockInputInfo* pInfo = static_cast<SMockInputInfo*>(pOperator->info);
+  if (pInfo->current >= pInfo->pBlocks->size()) {
+    return NULL;
+  }
+  return (*pInfo->pBlocks)[pInfo->current++];
+}
+
+void destroyMockInput(void* param) {
+  SMockInputInfo* pInfo = static_cast<SMockInputInfo*>(param);
+  for (auto pBlock : *pInfo->pBlocks) {
+    blockDataDestroy(pBlock);
+  }
+  delete pInfo->pBlocks;
+  taosMemoryFree(pInfo);
+}
+
+SOperatorInfo* createMockInput(int16_t blockId, std::vector<SSDataBlock*>* pBlocks) {
+  SMockInputInfo* pInfo = static_cast<SMockInputInfo*>(taosMemoryCalloc(1, sizeof(SMockInputInfo)));
+  pInfo->pBlocks = pBlocks;
+
+  SOperatorInfo* pOperator = static_cast<SOperatorInfo*>(taosMemoryCalloc(1, sizeof(SOperatorInfo)));
+  pOperator->info = pInfo;
+  pOperator->resultDataBlockId = blockId;
+  pOperator->fpSet.getNextFn = getMockInputBlock;
+  pOperator->fpSet.closeFn = destroyMockInput;
+  return pOperator;
+}
+
+// rows with a negative key get a NULL key
+SSDataBlock* createInputBlock(int16_t blockId, const std::vector<int32_t>& keys, bool isLeft) {
+  SSDataBlock*    pBlock = createDataBlock();
+  SColumnInfoData key = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 0);
+  SColumnInfoData val = isLeft ? createColumnInfoData(TSDB_DATA_TYPE_BIGINT, sizeof(int64_t), 1)
+                               : createColumnInfoData(TSDB_DATA_TYPE_DOUBLE, sizeof(double), 1);
+  blockDataAppendColInfo(pBlock, &key);
+  blockDataAppendColInfo(pBlock, &val);
+  blockDataEnsureCapacity(pBlock, keys.size());
+  pBlock->info.id.blockId = blockId;
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    SColumnInfoData* pKey = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+    SColumnInfoData* pVal = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+    if (keys[i] < 0) {
+      colDataSetNULL(pKey, i);
+    } else {
+      colDataSetVal(pKey, i, (const char*)&keys[i], false);
+    }
+    if (isLeft) {
+      int64_t v = (int64_t)keys[i] * 10;
+      colDataSetVal(pVal, i, (const char*)&v, false);
+    } else {
+      double v = keys[i] * 1.5;
+      colDataSetVal(pVal, i, (const char*)&v, false);
+    }
+  }
+  pBlock->info.rows = keys.size();
+  return pBlock;
+}
+
+SNode* makeColumnNode(int16_t blockId, int16_t slotId, int8_t type, int32_t bytes) {
+  SColumnNode* pCol = (SColumnNode*)nodesMakeNode(QUERY_NODE_COLUMN);
+  pCol->dataBlockId = blockId;
+  pCol->slotId = slotId;
+  pCol->node.resType.type = type;
+  pCol->node.resType.bytes = bytes;
+  snprintf(pCol->colName, sizeof(pCol->colName), "c%d_%d", blockId, slotId);
+  return (SNode*)pCol;
+}
+
+SNode* createTarget(int16_t slotId, SNode* pExpr) {
+  STargetNode* pTarget = (STargetNode*)nodesMakeNode(QUERY_NODE_TARGET);
+  pTarget->dataBlockId = outputBlockId;
+  pTarget->slotId = slotId;
+  pTarget->pExpr = pExpr;
+  return (SNode*)pTarget;
+}
+
+SDataBlockDescNode* createBlockDesc(int16_t blockId, const std::vector<std::pair<int8_t, int32_t>>& slots) {
+  SDataBlockDescNode* pDesc = (SDataBlockDescNode*)nodesMakeNode(QUERY_NODE_DATABLOCK_DESC);
+  pDesc->dataBlockId = blockId;
+  for (size_t i = 0; i < slots.size(); ++i) {
+    SSlotDescNode* pSlot = (SSlotDescNode*)nodesMakeNode(QUERY_NODE_SLOT_DESC);
+    pSlot->slotId = i;
+    pSlot->dataType.type = slots[i].first;
+    pSlot->dataType.bytes = slots[i].second;
+    pSlot->output = true;
+    nodesListMakeStrictAppend(&pDesc->pSlots, (SNode*)pSlot);
+    pDesc->totalRowSize += slots[i].second;
+    pDesc->outputRowSize += slots[i].second;
+  }
+  return pDesc;
+}
+
+SPhysiNode* createChildNode(int16_t blockId, int8_t valType) {
+  SPhysiNode* pNode = (SPhysiNode*)nodesMakeNode(QUERY_NODE_PHYSICAL_PLAN_PROJECT);
+  pNode->pOutputDataBlockDesc =
+      createBlockDesc(blockId, {{TSDB_DATA_TYPE_INT, sizeof(int32_t)}, {valType, (int32_t)sizeof(int64_t)}});
+  return pNode;
+}
+
+SHashJoinPhysiNode* createJoinNode(bool buildLeft) {
+  SHashJoinPhysiNode* pJoin = (SHashJoinPhysiNode*)nodesMakeNode(QUERY_NODE_PHYSICAL_PLAN_HASH_JOIN);
+  pJoin->joinType = JOIN_TYPE_INNER;
+  pJoin->buildLeft = buildLeft;
+  nodesListMakeStrictAppend(&pJoin->pLeftKeys, makeColumnNode(leftBlockId, 0, TSDB_DATA_TYPE_INT, sizeof(int32_t)));
+  nodesListMakeStrictAppend(&pJoin->pRightKeys, makeColumnNode(rightBlockId, 0, TSDB_DATA_TYPE_INT, sizeof(int32_t)));
+
+  nodesListMakeStrictAppend(
+      &pJoin->pTargets,
+      createTarget(outLeftKeySlot, makeColumnNode(leftBlockId, 0, TSDB_DATA_TYPE_INT, sizeof(int32_t))));
+  nodesListMakeStrictAppend(
+      &pJoin->pTargets,
+      createTarget(outRightValSlot, makeColumnNode(rightBlockId, 1, TSDB_DATA_TYPE_DOUBLE, sizeof(double))));
+  nodesListMakeStrictAppend(
+      &pJoin->pTargets,
+      createTarget(outLeftValSlot, makeColumnNode(leftBlockId, 1, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t))));
+
+  pJoin->node.pOutputDataBlockDesc = createBlockDesc(outputBlockId, {{TSDB_DATA_TYPE_DOUBLE, sizeof(double)},
+                                                                     {TSDB_DATA_TYPE_BIGINT, sizeof(int64_t)},
+                                                                     {TSDB_DATA_TYPE_INT, sizeof(int32_t)}});
+  nodesListMakeStrictAppend(&pJoin->node.pChildren, (SNode*)createChildNode(leftBlockId, TSDB_DATA_TYPE_BIGINT));
+  nodesListMakeStrictAppend(&pJoin->node.pChildren, (SNode*)createChildNode(rightBlockId, TSDB_DATA_TYPE_DOUBLE));
+  return pJoin;
+}
+
+// the joined rows, as (left key, number of rows with a matched right val, number of rows with a NULL right val)
+typedef std::map<int32_t, std::pair<int32_t, int32_t>> SJoinResult;
+
+// the join is charged to a tracker of memLimit bytes if it is not 0, as if it were the tracker of the task
+void runHashJoin(bool buildLeft, std::vector<SSDataBlock*>* pLeft, std::vector<SSDataBlock*>* pRight,
+                 SJoinResult* pResult, int32_t* pNullKeyRows, int64_t memLimit = 0) {
+  SExecTaskInfo*      pTaskInfo = (SExecTaskInfo*)taosMemoryCalloc(1, sizeof(SExecTaskInfo));
+  SHashJoinPhysiNode* pJoinNode = createJoinNode(buildLeft);
+  SOperatorInfo*      pDownstream[2] = {createMockInput(leftBlockId, pLeft), createMockInput(rightBlockId, pRight)};
+
+  SMemTracker* pTracker = (memLimit > 0) ? taosMemTrackerCreate("test", memLimit, NULL) : NULL;
+  SMemTracker* prevTracker = taosMemTrackerSwitch(pTracker);
+  SOperatorInfo* pOperator = createHashJoinOperatorInfo(pDownstream, 2, pJoinNode, pTaskInfo);
+  taosMemTrackerSwitch(prevTracker);
+  ASSERT_NE(pOperator, nullptr);
+
+  *pNullKeyRows = 0;
+  while (true) {
+    SSDataBlock* pRes = pOperator->fpSet.getNextFn(pOperator);
+    if (NULL == pRes) {
+      break;
+    }
+
+    SColumnInfoData* pRightVal = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, outRightValSlot);
+    SColumnInfoData* pLeftVal = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, outLeftValSlot);
+    SColumnInfoData* pLeftKey = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, outLeftKeySlot);
+    for (int32_t i = 0; i < pRes->info.rows; ++i) {
+      if (colDataIsNull_s(pLeftKey, i)) {
+        ASSERT_TRUE(colDataIsNull_s(pRightVal, i));
+        ++(*pNullKeyRows);
+        continue;
+      }
+
+      int32_t key = *(int32_t*)colDataGetData(pLeftKey, i);
+      ASSERT_EQ(*(int64_t*)colDataGetData(pLeftVal, i), (int64_t)key * 10);
+      if (colDataIsNull_s(pRightVal, i)) {
+        (*pResult)[key].second++;
+      } else {
+        ASSERT_DOUBLE_EQ(*(double*)colDataGetData(pRightVal, i), key * 1.5);
+        (*pResult)[key].first++;
+      }
+    }
+  }
+
+  destroyOperatorInfo(pOperator);
+  nodesDestroyNode((SNode*)pJoinNode);
+  taosMemoryFree(pTaskInfo);
+
+  if (pTracker != NULL) {
+    ASSERT_EQ(taosMemTrackerUsed(pTracker), 0);
+    ASSERT_LE(taosMemTrackerPeak(pTracker), memLimit);
+    taosMemTrackerUnref(pTracker);
+  }
+}
+
+// left keys 0..9 and a NULL key, right keys 0, 2, ..., 18 with key 4 twice
+void createJoinInputs(std::vector<SSDataBlock*>* pLeft, std::vector<SSDataBlock*>* pRight) {
+  pLeft->push_back(createInputBlock(leftBlockId, {0, 1, 2, 3, 4}, true));
+  pLeft->push_back(createInputBlock(leftBlockId, {5, 6, -1, 7, 8, 9}, true));
+  pRight->push_back(createInputBlock(rightBlockId, {0, 2, 4, 6, 8}, false));
+  pRight->push_back(createInputBlock(rightBlockId, {4, 10, 12, 14, 16, 18, -1}, false));
+}
+
+}  // namespace
+
+TEST(hashJoinTest, innerJoin) {
+  for (int32_t buildLeft = 0; buildLeft <= 1; ++buildLeft) {
+    std::vector<SSDataBlock*>* pLeft = new std::vector<SSDataBlock*>();
+    std::vector<SSDataBlock*>* pRight = new std::vector<SSDataBlock*>();
+    createJoinInputs(pLeft, pRight);
+
+    SJoinResult result;
+    int32_t     nullKeyRows = 0;
+    runHashJoin(buildLeft, pLeft, pRight, &result, &nullKeyRows);
+
+    ASSERT_EQ(nullKeyRows, 0);
+    ASSERT_EQ(result.size(), 5);
+    for (int32_t key = 0; key < 10; key += 2) {
+      ASSERT_EQ(result[key].first, (key == 4) ? 2 : 1);
+      ASSERT_EQ(result[key].second, 0);
+    }
+  }
+}
+
+// the build side exceeds the memory budget of the query, both sides are partitioned on disk
+TEST(hashJoinTest, spilledJoin) {
+  const int32_t numOfBuildRows = 200000;
+  const int32_t numOfProbeRows = 1000;
+
+  std::vector<SSDataBlock*>* pLeft = new std::vector<SSDataBlock*>();
+  std::vector<SSDataBlock*>* pRight = new std::vector<SSDataBlock*>();
+  for (int32_t start = 0; start < numOfBuildRows; start += 4096) {
+    std::vector<int32_t> keys;
+    for (int32_t i = start; i < numOfBuildRows && i < start + 4096; ++i) {
+      keys.push_back(i);
+    }
+    pRight->push_back(createInputBlock(rightBlockId, keys, false));
+  }
+  std::vector<int32_t> probeKeys;
+  for (int32_t i = 0; i < numOfProbeRows; ++i) {
+    probeKeys.push_back(i * 400);
+  }
+  pLeft->push_back(createInputBlock(leftBlockId, probeKeys, true));
+
+  SJoinResult result;
+  int32_t     nullKeyRows = 0;
+  runHashJoin(false, pLeft, pRight, &result, &nullKeyRows, 1048576);
+
+  ASSERT_EQ(nullKeyRows, 0);
+  ASSERT_EQ(result.size(), numOfBuildRows / 400);
+  for (int32_t key = 0; key < numOfBuildRows; key += 400) {
+    ASSERT_EQ(result[key].first, 1);
+    ASSERT_EQ(result[key].second, 0);
+  }
+}
+
+// Most build rows share one key, so their partition stays over the memory budget however often it is partitioned,
+// and is joined chunk by chunk against all of its probe rows.
+TEST(hashJoinTest, skewedJoin) {
+  const int32_t numOfHotRows = 100000;
+  const int32_t hotKey = 7;
+
+  std::vector<SSDataBlock*>* pLeft = new std::vector<SSDataBlock*>();
+  std::vector<SSDataBlock*>* pRight = new std::vector<SSDataBlock*>();
+  for (int32_t start = 0; start < numOfHotRows; start += 4096) {
+    std::vector<int32_t> keys;
+    for (int32_t i = start; i < numOfHotRows && i < start + 4096; ++i) {
+      keys.push_back((i % 50 == 0) ? i : hotKey);
+    }
+    pRight->push_back(createInputBlock(rightBlockId, keys, false));
+  }
+  pLeft->push_back(createInputBlock(leftBlockId, {hotKey, 0, 50, 51, hotKey, -1}, true));
+
+  SJoinResult result;
+  int32_t     nullKeyRows = 0;
+  runHashJoin(false, pLeft, pRight, &result, &nullKeyRows, 1048576);
+
+  ASSERT_EQ(nullKeyRows, 0);
+  ASSERT_EQ(result.size(), 3);
+  ASSERT_EQ(result[hotKey].first, 2 * (numOfHotRows - numOfHotRows / 50));
+  ASSERT_EQ(result[0].first, 1);
+  ASSERT_EQ(result[50].first, 1);
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wwrite-strings"
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#include "os.h"
+
+#include "executorimpl.h"
+#include "function.h"
+#include "querynodes.h"
+#include "tdatablock.h"
+#include "tfill.h"
+
+namespace {
+
+// one week of hourly rows, filled at one second: the value of the columns equals the seconds since the start
+const int32_t numOfSrcRows = 24 * 7 + 1;
+const int64_t srcStep = 3600 * 1000L;
+const int64_t fillStep = 1000L;
+const int32_t capacity = 4096;
+
+SSDataBlock* createTestBlock(int32_t numOfRows) {
+  SSDataBlock* pBlock = createDataBlock();
+
+  SColumnInfoData ts = createColumnInfoData(TSDB_DATA_TYPE_TIMESTAMP, sizeof(int64_t), 1);
+  SColumnInfoData dval = createColumnInfoData(TSDB_DATA_TYPE_DOUBLE, sizeof(double), 2);
+  SColumnInfoData ival = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 3);
+  blockDataAppendColInfo(pBlock, &ts);
+  blockDataAppendColInfo(pBlock, &dval);
+  blockDataAppendColInfo(pBlock, &ival);
+
+  blockDataEnsureCapacity(pBlock, numOfRows);
+  return pBlock;
+}
+
+void fillSrcBlock(SSDataBlock* pBlock) {
+  for (int32_t i = 0; i < numOfSrcRows; ++i) {
+    int64_t ts = i * srcStep;
+    double  dval = ts / 1000;
+    int32_t ival = ts / 1000;
+    colDataSetVal((SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0), i, (const char*)&ts, false);
+    colDataSetVal((SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1), i, (const char*)&dval, false);
+    colDataSetVal((SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 2), i, (const char*)&ival, false);
+  }
+  pBlock->info.rows = numOfSrcRows;
+}
+
+// check one row of the result, the row at ts is either a source row or a filled one
+void checkRow(SSDataBlock* pRes, int32_t row, int64_t ts, int32_t fillType) {
+  SColumnInfoData* pTs = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 0);
+  SColumnInfoData* pDval = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 1);
+  SColumnInfoData* pIval = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 2);
+
+  ASSERT_EQ(((int64_t*)pTs->pData)[row], ts);
+
+  int64_t expect = ts / 1000;
+  if (ts % srcStep != 0) {
+    if (fillType == TSDB_FILL_NULL) {
+      ASSERT_TRUE(colDataIsNull_f(pDval->nullbitmap, row));
+      ASSERT_TRUE(colDataIsNull_f(pIval->nullbitmap, row));
+      return;
+    } else if (fillType == TSDB_FILL_SET_VALUE) {
+      expect = 7;
+    } else if (fillType == TSDB_FILL_PREV) {
+      expect = ts / srcStep * srcStep / 1000;
+    }
+  }
+
+  ASSERT_FALSE(colDataIsNull_f(pDval->nullbitmap, row));
+  ASSERT_FALSE(colDataIsNull_f(pIval->nullbitmap, row));
+  ASSERT_DOUBLE_EQ(((double*)pDval->pData)[row], (double)expect);
+  ASSERT_EQ(((int32_t*)pIval->pData)[row], (int32_t)expect);
+}
+
+}  // namespace
+
+// dense fill of a week at one second, every row of each fill type is checked
+TEST(testCase, dense_fill_Test) {
+  int32_t fillTypes[] = {TSDB_FILL_NULL, TSDB_FILL_SET_VALUE, TSDB_FILL_PREV, TSDB_FILL_LINEAR};
+  const char* names[] = {"null", "value", "prev", "linear"};
+
+  SSDataBlock* pSrc = createTestBlock(numOfSrcRows);
+  fillSrcBlock(pSrc);
+  SSDataBlock* pRes = createTestBlock(capacity);
+
+  for (int32_t t = 0; t < sizeof(fillTypes) / sizeof(fillTypes[0]); ++t) {
+    // _wstart and the two columns to fill
+    SColumn     wstartCol = {0};
+    SFunctParam wstartParam = {0};
+    tExprNode   colNode = {0};
+    SExprInfo   fillExprs[2] = {0};
+    SExprInfo   notFillExpr = {0};
+
+    wstartCol.colType = COLUMN_TYPE_WINDOW_START;
+    wstartParam.type = FUNC_PARAM_TYPE_COLUMN;
+    wstartParam.pCol = &wstartCol;
+    colNode.nodeType = QUERY_NODE_COLUMN;
+
+    notFillExpr.pExpr = &colNode;
+    notFillExpr.base.resSchema.slotId = 0;
+    notFillExpr.base.resSchema.type = TSDB_DATA_TYPE_TIMESTAMP;
+    notFillExpr.base.resSchema.bytes = sizeof(int64_t);
+    notFillExpr.base.numOfParams = 1;
+    notFillExpr.base.pParam = &wstartParam;
+
+    for (int32_t i = 0; i < 2; ++i) {
+      fillExprs[i].pExpr = &colNode;
+      fillExprs[i].base.resSchema.slotId = i + 1;
+      fillExprs[i].base.resSchema.type = (i == 0) ? TSDB_DATA_TYPE_DOUBLE : TSDB_DATA_TYPE_INT;
+      fillExprs[i].base.resSchema.bytes = (i == 0) ? sizeof(double) : sizeof(int32_t);
+    }
+
+    SFillColInfo* pCol = createFillColInfo(fillExprs, 2, &notFillExpr, 1, NULL);
+    for (int32_t i = 0; i < 2; ++i) {
+      pCol[i].fillVal.nType = TSDB_DATA_TYPE_BIGINT;
+      pCol[i].fillVal.i = 7;
+    }
+
+    SInterval interval = {0};
+    interval.intervalUnit = 's';
+    interval.slidingUnit = 's';
+    interval.precision = TSDB_TIME_PRECISION_MILLI;
+    interval.interval = fillStep;
+    interval.sliding = fillStep;
+
+    int64_t    endTs = (numOfSrcRows - 1) * srcStep;
+    SFillInfo* pFillInfo =
+        taosCreateFillInfo(0, 2, 1, capacity, &interval, fillTypes[t], pCol, 0, TSDB_ORDER_ASC, "fill_test");
+    ASSERT_NE(pFillInfo, nullptr);
+
+    taosFillSetStartInfo(pFillInfo, numOfSrcRows, endTs);
+    taosFillSetInputDataBlock(pFillInfo, pSrc);
+
+    int64_t total = 0;
+    while (taosFillHasMoreResults(pFillInfo)) {
+      blockDataCleanup(pRes);
+      blockDataEnsureCapacity(pRes, capacity);
+
+      int64_t numOfRows = taosFillResultDataBlock(pFillInfo, pRes, capacity);
+
+      ASSERT_EQ(numOfRows, pRes->info.rows);
+      for (int32_t i = 0; i < numOfRows; ++i) {
+        checkRow(pRes, i, (total + i) * fillStep, fillTypes[t]);
+      }
+      total += numOfRows;
+    }
+
+    ASSERT_EQ(total, endTs / fillStep + 1);
+    qDebug("fill(%s): %" PRId64 " rows checked", names[t], total);
+
+    taosDestroyFillInfo(pFillInfo);
+  }
+
+  blockDataDestroy(pSrc);
+  blockDataDestroy(pRes);
+}
+
+#pragma GCC diagnostic pop
@@ -34,8 +34,13 @@ enum {
   TSDB_UDF_CALL_SCALA_PROC,
 };
 
+#define UDF_SHM_NAME_LEN  64
+#define UDF_SHM_MAX_SLOTS 8
+
 typedef struct SUdfSetupRequest {
-  char udfName[TSDB_FUNC_NAME_LEN + 1];
+  char    udfName[TSDB_FUNC_NAME_LEN + 1];
+  char    shmName[UDF_SHM_NAME_LEN];  // empty if the session does not use shared memory
+  int64_t shmSize;
 } SUdfSetupRequest;
 
 typedef struct SUdfSetupResponse {
@@ -43,11 +48,13 @@ typedef struct SUdfSetupResponse {
   int8_t  outputType;
   int32_t outputLen;
   int32_t bufSize;
+  int8_t  shmAttached;
 } SUdfSetupResponse;
 
 typedef struct SUdfCallRequest {
   int64_t udfHandle;
   int8_t  callType;
+  int32_t shmSlot;  // block and inter buf of proc calls are in this slot if it is not -1
 
   SSDataBlock  block;
   SUdfInterBuf interBuf;
@@ -57,6 +64,7 @@ typedef struct SUdfCallRequest {
 
 typedef struct SUdfCallResponse {
   int8_t       callType;
+  int8_t       shmResult;  // the result is in the slot of the request
   SSDataBlock  resultData;
   SUdfInterBuf resultBuf;
 } SUdfCallResponse;
@@ -110,6 +118,47 @@ int32_t convertDataBlockToUdfDataBlock(SSDataBlock *block, SUdfDataBlock *udfBlo
 int32_t convertUdfColumnToDataBlock(SUdfColumn *udfCol, SSDataBlock *block);
 
 int32_t getUdfdPipeName(char *pipeName, int32_t size);
+
+/*
+ * Shared memory of a udf session. It is created by udfc and attached by udfd at setup, and divided into slots. The
+ * caller of a proc call takes a free slot and writes the input columns into it, udfd runs the udf on the columns in
+ * place and writes the result back into the same slot, so only the control message goes through the pipe.
+ */
+typedef struct SUdfShm {
+  char    name[UDF_SHM_NAME_LEN];
+  char   *base;
+  int64_t size;
+  int64_t slotSize;
+  int32_t numOfSlots;
+  int32_t freeSlots;  // bit i is set if slot i is free, only used by udfc
+  int32_t lostSlots;  // bit i is set if slot i is never freed since udfd may still use it, only used by udfc
+} SUdfShm;
+
+typedef struct SUdfShmCursor {
+  char   *buf;
+  int64_t cap;
+  int64_t pos;
+} SUdfShmCursor;
+
+int32_t udfShmCreate(SUdfShm *pShm, int64_t size);
+int32_t udfShmAttach(SUdfShm *pShm, const char *name, int64_t size);
+void    udfShmDetach(SUdfShm *pShm);
+void    udfShmUnlink(SUdfShm *pShm);
+int32_t udfShmAcquireSlot(SUdfShm *pShm);
+void    udfShmReleaseSlot(SUdfShm *pShm, int32_t slot);
+void    udfShmQuarantineSlot(SUdfShm *pShm, int32_t slot);
+void    udfShmInitCursor(SUdfShm *pShm, int32_t slot, SUdfShmCursor *pCursor);
+
+// udfc writes the input and reads the result, the put functions return -1 if the slot is not large enough
+int32_t udfShmPutDataBlock(SUdfShmCursor *pCursor, const SSDataBlock *pBlock);
+int32_t udfShmPutInterBuf(SUdfShmCursor *pCursor, const SUdfInterBuf *pBuf);
+int32_t udfShmGetDataBlock(SUdfShmCursor *pCursor, SSDataBlock *pBlock);
+int32_t udfShmGetInterBuf(SUdfShmCursor *pCursor, SUdfInterBuf *pBuf, bool copy);
+
+// udfd reads the input in place and writes the result
+int32_t udfShmGetUdfDataBlock(SUdfShmCursor *pCursor, SUdfDataBlock *pBlock);
+void    udfShmFreeUdfDataBlock(SUdfDataBlock *pBlock);
+int32_t udfShmPutUdfColumn(SUdfShmCursor *pCursor, const SUdfColumn *pCol);
 #ifdef __cplusplus
 }
 #endif
@@ -380,6 +380,8 @@ typedef struct SUdfcUvSession {
   int32_t bufSize;
 
   char udfName[TSDB_FUNC_NAME_LEN + 1];
+
+  SUdfShm shm;  // base is NULL if the data is sent by pipe
 } SUdfcUvSession;
 
 typedef struct SClientUvTaskNode {
@@ -406,6 +408,7 @@ typedef struct SClientUdfTask {
   SUdfcUvSession *session;
 
   int32_t errCode;
+  int8_t  rspReceived;  // the response of udfd is decoded, otherwise the pipe failed before it arrived
 
   union {
     struct {
@@ -494,11 +497,15 @@ int32_t getUdfdPipeName(char *pipeName, int32_t size) {
 int32_t encodeUdfSetupRequest(void **buf, const SUdfSetupRequest *setup) {
   int32_t len = 0;
   len += taosEncodeBinary(buf, setup->udfName, TSDB_FUNC_NAME_LEN);
+  len += taosEncodeString(buf, setup->shmName);
+  len += taosEncodeFixedI64(buf, setup->shmSize);
   return len;
 }
 
 void *decodeUdfSetupRequest(const void *buf, SUdfSetupRequest *request) {
   buf = taosDecodeBinaryTo(buf, request->udfName, TSDB_FUNC_NAME_LEN);
+  buf = taosDecodeStringTo(buf, request->shmName);
+  buf = taosDecodeFixedI64(buf, &request->shmSize);
   return (void *)buf;
 }
 
@@ -522,12 +529,18 @@ int32_t encodeUdfCallRequest(void **buf, const SUdfCallRequest *call) {
   len += taosEncodeFixedI64(buf, call->udfHandle);
   len += taosEncodeFixedI8(buf, call->callType);
   if (call->callType == TSDB_UDF_CALL_SCALA_PROC) {
-    len += tEncodeDataBlock(buf, &call->block);
+    len += taosEncodeFixedI32(buf, call->shmSlot);
+    if (call->shmSlot < 0) {
+      len += tEncodeDataBlock(buf, &call->block);
+    }
   } else if (call->callType == TSDB_UDF_CALL_AGG_INIT) {
     len += taosEncodeFixedI8(buf, call->initFirst);
   } else if (call->callType == TSDB_UDF_CALL_AGG_PROC) {
-    len += tEncodeDataBlock(buf, &call->block);
-    len += encodeUdfInterBuf(buf, &call->interBuf);
+    len += taosEncodeFixedI32(buf, call->shmSlot);
+    if (call->shmSlot < 0) {
+      len += tEncodeDataBlock(buf, &call->block);
+      len += encodeUdfInterBuf(buf, &call->interBuf);
+    }
   } else if (call->callType == TSDB_UDF_CALL_AGG_MERGE) {
     len += encodeUdfInterBuf(buf, &call->interBuf);
     len += encodeUdfInterBuf(buf, &call->interBuf2);
@@ -542,14 +555,20 @@ void *decodeUdfCallRequest(const void *buf, SUdfCallRequest *call) {
   buf = taosDecodeFixedI8(buf, &call->callType);
   switch (call->callType) {
     case TSDB_UDF_CALL_SCALA_PROC:
-      buf = tDecodeDataBlock(buf, &call->block);
+      buf = taosDecodeFixedI32(buf, &call->shmSlot);
+      if (call->shmSlot < 0) {
+        buf = tDecodeDataBlock(buf, &call->block);
+      }
       break;
     case TSDB_UDF_CALL_AGG_INIT:
       buf = taosDecodeFixedI8(buf, &call->initFirst);
       break;
     case TSDB_UDF_CALL_AGG_PROC:
-      buf = tDecodeDataBlock(buf, &call->block);
-      buf = decodeUdfInterBuf(buf, &call->interBuf);
+      buf = taosDecodeFixedI32(buf, &call->shmSlot);
+      if (call->shmSlot < 0) {
+        buf = tDecodeDataBlock(buf, &call->block);
+        buf = decodeUdfInterBuf(buf, &call->interBuf);
+      }
       break;
     case TSDB_UDF_CALL_AGG_MERGE:
       buf = decodeUdfInterBuf(buf, &call->interBuf);
@@ -616,6 +635,7 @@ int32_t encodeUdfSetupResponse(void **buf, const SUdfSetupResponse *setupRsp) {
   len += taosEncodeFixedI8(buf, setupRsp->outputType);
   len += taosEncodeFixedI32(buf, setupRsp->outputLen);
   len += taosEncodeFixedI32(buf, setupRsp->bufSize);
+  len += taosEncodeFixedI8(buf, setupRsp->shmAttached);
   return len;
 }
 
@@ -624,6 +644,7 @@ void *decodeUdfSetupResponse(const void *buf, SUdfSetupResponse *setupRsp) {
   buf = taosDecodeFixedI8(buf, &setupRsp->outputType);
   buf = taosDecodeFixedI32(buf, &setupRsp->outputLen);
   buf = taosDecodeFixedI32(buf, &setupRsp->bufSize);
+  buf = taosDecodeFixedI8(buf, &setupRsp->shmAttached);
   return (void *)buf;
 }
 
@@ -632,13 +653,19 @@ int32_t encodeUdfCallResponse(void **buf, const SUdfCallResponse *callRsp) {
   len += taosEncodeFixedI8(buf, callRsp->callType);
   switch (callRsp->callType) {
     case TSDB_UDF_CALL_SCALA_PROC:
-      len += tEncodeDataBlock(buf, &callRsp->resultData);
+      len += taosEncodeFixedI8(buf, callRsp->shmResult);
+      if (!callRsp->shmResult) {
+        len += tEncodeDataBlock(buf, &callRsp->resultData);
+      }
       break;
     case TSDB_UDF_CALL_AGG_INIT:
       len += encodeUdfInterBuf(buf, &callRsp->resultBuf);
       break;
     case TSDB_UDF_CALL_AGG_PROC:
-      len += encodeUdfInterBuf(buf, &callRsp->resultBuf);
+      len += taosEncodeFixedI8(buf, callRsp->shmResult);
+      if (!callRsp->shmResult) {
+        len += encodeUdfInterBuf(buf, &callRsp->resultBuf);
+      }
       break;
     case TSDB_UDF_CALL_AGG_MERGE:
       len += encodeUdfInterBuf(buf, &callRsp->resultBuf);
@@ -654,13 +681,19 @@ void *decodeUdfCallResponse(const void *buf, SUdfCallResponse *callRsp) {
   buf = taosDecodeFixedI8(buf, &callRsp->callType);
   switch (callRsp->callType) {
     case TSDB_UDF_CALL_SCALA_PROC:
-      buf = tDecodeDataBlock(buf, &callRsp->resultData);
+      buf = taosDecodeFixedI8(buf, &callRsp->shmResult);
+      if (!callRsp->shmResult) {
+        buf = tDecodeDataBlock(buf, &callRsp->resultData);
+      }
       break;
     case TSDB_UDF_CALL_AGG_INIT:
       buf = decodeUdfInterBuf(buf, &callRsp->resultBuf);
       break;
     case TSDB_UDF_CALL_AGG_PROC:
-      buf = decodeUdfInterBuf(buf, &callRsp->resultBuf);
+      buf = taosDecodeFixedI8(buf, &callRsp->shmResult);
+      if (!callRsp->shmResult) {
+        buf = decodeUdfInterBuf(buf, &callRsp->resultBuf);
+      }
       break;
     case TSDB_UDF_CALL_AGG_MERGE:
       buf = decodeUdfInterBuf(buf, &callRsp->resultBuf);
@@ -1231,6 +1264,7 @@ int32_t udfcGetUdfTaskResultFromUvTask(SClientUdfTask *task, SClientUvTaskNode *
       SUdfResponse rsp = {0};
       void        *buf = decodeUdfResponse(uvTask->rspBuf.base, &rsp);
       task->errCode = rsp.code;
+      task->rspReceived = 1;
 
       switch (task->type) {
         case UDF_TASK_SETUP: {
@@ -1683,9 +1717,17 @@ int32_t doSetupUdf(char udfName[], UdfcFuncHandle *funcHandle) {
   SUdfSetupRequest *req = &task->_setup.req;
   strncpy(req->udfName, udfName, TSDB_FUNC_NAME_LEN);
 
+  SUdfShm *pShm = &task->session->shm;
+  if (tsUdfShmSize > 0 && udfShmCreate(pShm, (int64_t)tsUdfShmSize * 1024 * 1024) == 0) {
+    tstrncpy(req->shmName, pShm->name, sizeof(req->shmName));
+    req->shmSize = pShm->size;
+  }
+
   int32_t errCode = udfcRunUdfUvTask(task, UV_TASK_CONNECT);
   if (errCode != 0) {
     fnError("failed to connect to pipe. udfName: %s, pipe: %s", udfName, (&gUdfcProxy)->udfdPipeName);
+    udfShmUnlink(pShm);
+    udfShmDetach(pShm);
     taosMemoryFree(task->session);
     taosMemoryFree(task);
     return TSDB_CODE_UDF_PIPE_CONNECT_ERR;
@@ -1699,10 +1741,18 @@ int32_t doSetupUdf(char udfName[], UdfcFuncHandle *funcHandle) {
   task->session->outputLen = rsp->outputLen;
   task->session->bufSize = rsp->bufSize;
   strncpy(task->session->udfName, udfName, TSDB_FUNC_NAME_LEN);
+
+  // udfd has mapped the shared memory or given it up, the name is no longer needed
+  udfShmUnlink(pShm);
+  if (task->errCode != 0 || !rsp->shmAttached) {
+    udfShmDetach(pShm);
+  }
+
   if (task->errCode != 0) {
     fnError("failed to setup udf. udfname: %s, err: %d", udfName, task->errCode)
   } else {
-    fnInfo("sucessfully setup udf func handle. udfName: %s, handle: %p", udfName, task->session);
+    fnInfo("sucessfully setup udf func handle. udfName: %s, handle: %p, shm:%d", udfName, task->session,
+           pShm->base != NULL);
     *funcHandle = task->session;
   }
   int32_t err = task->errCode;
@@ -1726,6 +1776,23 @@ int32_t callUdf(UdfcFuncHandle handle, int8_t callType, SSDataBlock *input, SUdf
   SUdfCallRequest *req = &task->_call.req;
   req->udfHandle = task->session->severHandle;
   req->callType = callType;
+  req->shmSlot = -1;
+
+  SUdfShm      *pShm = &session->shm;
+  SUdfShmCursor cursor = {0};
+  if (pShm->base != NULL && (callType == TSDB_UDF_CALL_SCALA_PROC || callType == TSDB_UDF_CALL_AGG_PROC)) {
+    req->shmSlot = udfShmAcquireSlot(pShm);
+  }
+
+  // the input goes by pipe if all slots are in use or it does not fit in one
+  if (req->shmSlot >= 0) {
+    udfShmInitCursor(pShm, req->shmSlot, &cursor);
+    if (udfShmPutDataBlock(&cursor, input) != 0 ||
+        (callType == TSDB_UDF_CALL_AGG_PROC && udfShmPutInterBuf(&cursor, state) != 0)) {
+      udfShmReleaseSlot(pShm, req->shmSlot);
+      req->shmSlot = -1;
+    }
+  }
 
   switch (callType) {
     case TSDB_UDF_CALL_AGG_INIT: {
@@ -1753,6 +1820,9 @@ int32_t callUdf(UdfcFuncHandle handle, int8_t callType, SSDataBlock *input, SUdf
   }
 
   udfcRunUdfUvTask(task, UV_TASK_REQ_RSP);
+  if (!task->rspReceived && task->errCode == 0) {
+    task->errCode = TSDB_CODE_UDF_PIPE_READ_ERR;
+  }
 
   if (task->errCode != 0) {
     fnError("call udf failure. err: %d", task->errCode);
@@ -1764,7 +1834,12 @@ int32_t callUdf(UdfcFuncHandle handle, int8_t callType, SSDataBlock *input, SUdf
         break;
       }
       case TSDB_UDF_CALL_AGG_PROC: {
-        *newState = rsp->resultBuf;
+        if (rsp->shmResult) {
+          udfShmInitCursor(pShm, req->shmSlot, &cursor);
+          task->errCode = udfShmGetInterBuf(&cursor, newState, true);
+        } else {
+          *newState = rsp->resultBuf;
+        }
         break;
       }
       case TSDB_UDF_CALL_AGG_MERGE: {
@@ -1776,11 +1851,27 @@ int32_t callUdf(UdfcFuncHandle handle, int8_t callType, SSDataBlock *input, SUdf
         break;
       }
       case TSDB_UDF_CALL_SCALA_PROC: {
-        *output = rsp->resultData;
+        if (rsp->shmResult) {
+          udfShmInitCursor(pShm, req->shmSlot, &cursor);
+          task->errCode = udfShmGetDataBlock(&cursor, output);
+          if (task->errCode != 0) {
+            blockDataFreeRes(output);
+          }
+        } else {
+          *output = rsp->resultData;
+        }
         break;
       }
     }
   };
+  if (req->shmSlot >= 0) {
+    // without a response udfd may still be reading or writing the slot, so it is not handed out again
+    if (task->rspReceived) {
+      udfShmReleaseSlot(pShm, req->shmSlot);
+    } else {
+      udfShmQuarantineSlot(pShm, req->shmSlot);
+    }
+  }
   int err = task->errCode;
   taosMemoryFree(task);
   return err;
@@ -1822,15 +1913,36 @@ int32_t doCallUdfAggFinalize(UdfcFuncHandle handle, SUdfInterBuf *interBuf, SUdf
 int32_t doCallUdfScalarFunc(UdfcFuncHandle handle, SScalarParam *input, int32_t numOfCols, SScalarParam *output) {
   int8_t      callType = TSDB_UDF_CALL_SCALA_PROC;
   SSDataBlock inputBlock = {0};
-  convertScalarParamToDataBlock(input, numOfCols, &inputBlock);
+
+  // the input columns are only read when sent, so they are used as they are unless some of them need expanding
+  bool borrowed = numOfCols > 0;
+  for (int32_t i = 1; i < numOfCols; ++i) {
+    if (input[i].numOfRows != input[0].numOfRows) {
+      borrowed = false;
+      break;
+    }
+  }
+  if (borrowed) {
+    for (int32_t i = 0; i < numOfCols; ++i) {
+      blockDataAppendColInfo(&inputBlock, input[i].columnData);
+    }
+    inputBlock.info.rows = input[0].numOfRows;
+  } else {
+    convertScalarParamToDataBlock(input, numOfCols, &inputBlock);
+  }
+
   SSDataBlock resultBlock = {0};
   int32_t     err = callUdf(handle, callType, &inputBlock, NULL, NULL, &resultBlock, NULL);
   if (err == 0) {
     convertDataBlockToScalarParm(&resultBlock, output);
     taosArrayDestroy(resultBlock.pDataBlock);
   }
-  
-  blockDataFreeRes(&inputBlock);
+
+  if (borrowed) {
+    taosArrayDestroy(inputBlock.pDataBlock);
+  } else {
+    blockDataFreeRes(&inputBlock);
+  }
   return err;
 }
 
@@ -1839,6 +1951,7 @@ int32_t doTeardownUdf(UdfcFuncHandle handle) {
 
   if (session->udfUvPipe == NULL) {
     fnError("tear down udf. pipe to udfd does not exist. udf name: %s", session->udfName);
+    udfShmDetach(&session->shm);
     taosMemoryFree(session);
     return TSDB_CODE_UDF_PIPE_NO_PIPE;
   }
@@ -1865,6 +1978,7 @@ int32_t doTeardownUdf(UdfcFuncHandle handle) {
     conn->session = NULL;
   }
   uv_mutex_unlock(&gUdfcProxy.udfcUvMutex);
+  udfShmDetach(&session->shm);
   taosMemoryFree(session);
   taosMemoryFree(task);
 
@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+#include "fnLog.h"
+#include "tdatablock.h"
+#include "tudf.h"
+#include "tudfInt.h"
+
+#define UDF_SHM_MAGIC     0x55444653  // "UDFS"
+#define UDF_SHM_HEAD_SIZE 4096
+#define UDF_SHM_ALIGN(x)  (((x) + 7) & ~((int64_t)7))
+
+typedef struct SUdfShmHead {
+  int32_t magic;
+  int32_t numOfSlots;
+  int64_t slotSize;
+} SUdfShmHead;
+
+// layout of a block in a slot: |SUdfShmBlock|SUdfShmCol * numOfCols|meta and data of each column|
+typedef struct SUdfShmBlock {
+  int32_t numOfRows;
+  int32_t numOfCols;
+} SUdfShmBlock;
+
+typedef struct SUdfShmCol {
+  int16_t type;
+  int8_t  hasNull;
+  uint8_t precision;
+  uint8_t scale;
+  int32_t bytes;
+  int32_t metaLen;  // null bitmap of a fixed length column, or offsets of a var length column
+  int32_t dataLen;
+  int64_t metaOffset;  // from the beginning of the slot
+  int64_t dataOffset;
+} SUdfShmCol;
+
+static int64_t udfShmSeq = 0;
+
+int32_t udfShmCreate(SUdfShm *pShm, int64_t size) {
+  memset(pShm, 0, sizeof(SUdfShm));
+  snprintf(pShm->name, sizeof(pShm->name), "/tdudf.%d.%" PRId64, taosGetPId(), atomic_add_fetch_64(&udfShmSeq, 1));
+
+  int64_t slotSize = (size - UDF_SHM_HEAD_SIZE) / UDF_SHM_MAX_SLOTS;
+  slotSize = slotSize & ~((int64_t)7);
+  if (slotSize <= 0) {
+    return TSDB_CODE_INVALID_PARA;
+  }
+
+  pShm->base = taosMapShm(pShm->name, size, true);
+  if (pShm->base == NULL) {
+    int32_t code = TAOS_SYSTEM_ERROR(errno);
+    fnError("failed to create udf shared memory %s since %s", pShm->name, tstrerror(code));
+    return code;
+  }
+
+  pShm->size = size;
+  pShm->slotSize = slotSize;
+  pShm->numOfSlots = UDF_SHM_MAX_SLOTS;
+  pShm->freeSlots = (1 << UDF_SHM_MAX_SLOTS) - 1;
+
+  SUdfShmHead *pHead = (SUdfShmHead *)pShm->base;
+  pHead->numOfSlots = pShm->numOfSlots;
+  pHead->slotSize = pShm->slotSize;
+  pHead->magic = UDF_SHM_MAGIC;
+
+  fnDebug("udf shared memory %s created, size:%" PRId64 ", slot size:%" PRId64, pShm->name, size, slotSize);
+  return 0;
+}
+
+int32_t udfShmAttach(SUdfShm *pShm, const char *name, int64_t size) {
+  memset(pShm, 0, sizeof(SUdfShm));
+  tstrncpy(pShm->name, name, sizeof(pShm->name));
+
+  pShm->base = taosMapShm(name, size, false);
+  if (pShm->base == NULL) {
+    int32_t code = TAOS_SYSTEM_ERROR(errno);
+    fnError("failed to attach udf shared memory %s since %s", name, tstrerror(code));
+    return code;
+  }
+  pShm->size = size;
+
+  SUdfShmHead *pHead = (SUdfShmHead *)pShm->base;
+  if (pHead->magic != UDF_SHM_MAGIC || pHead->numOfSlots <= 0 || pHead->numOfSlots > UDF_SHM_MAX_SLOTS ||
+      UDF_SHM_HEAD_SIZE + pHead->slotSize * pHead->numOfSlots > size) {
+    fnError("invalid udf shared memory %s, size:%" PRId64, name, size);
+    udfShmDetach(pShm);
+    return TSDB_CODE_INVALID_PARA;
+  }
+
+  pShm->numOfSlots = pHead->numOfSlots;
+  pShm->slotSize = pHead->slotSize;
+  return 0;
+}
+
+void udfShmDetach(SUdfShm *pShm) {
+  if (pShm->base != NULL) {
+    taosUnmapShm(pShm->base, pShm->size);
+    pShm->base = NULL;
+  }
+}
+
+// the name is removed once both processes have mapped it, so it does not outlive a crashed taosd
+void udfShmUnlink(SUdfShm *pShm) {
+  if (pShm->name[0] != 0) {
+    taosUnlinkShm(pShm->name);
+    pShm->name[0] = 0;
+  }
+}
+
+int32_t udfShmAcquireSlot(SUdfShm *pShm) {
+  int32_t freeSlots = atomic_load_32(&pShm->freeSlots);
+  while (freeSlots != 0) {
+    int32_t slot = 0;
+    while ((freeSlots & (1 << slot)) == 0) {
+      ++slot;
+    }
+
+    int32_t old = atomic_val_compare_exchange_32(&pShm->freeSlots, freeSlots, freeSlots & ~(1 << slot));
+    if (old == freeSlots) {
+      return slot;
+    }
+    freeSlots = old;
+  }
+  return -1;
+}
+
+void udfShmReleaseSlot(SUdfShm *pShm, int32_t slot) { atomic_fetch_or_32(&pShm->freeSlots, 1 << slot); }
+
+void udfShmQuarantineSlot(SUdfShm *pShm, int32_t slot) {
+  int32_t lostSlots = atomic_or_fetch_32(&pShm->lostSlots, 1 << slot);
+  fnWarn("udf shared memory %s slot %d is no longer used, lost slots:0x%x", pShm->name, slot, lostSlots);
+}
+
+void udfShmInitCursor(SUdfShm *pShm, int32_t slot, SUdfShmCursor *pCursor) {
+  pCursor->buf = pShm->base + UDF_SHM_HEAD_SIZE + pShm->slotSize * slot;
+  pCursor->cap = pShm->slotSize;
+  pCursor->pos = 0;
+}
+
+static void *udfShmAlloc(SUdfShmCursor *pCursor, int64_t len) {
+  int64_t pos = UDF_SHM_ALIGN(pCursor->pos);
+  if (pos + len > pCursor->cap) {
+    return NULL;
+  }
+
+  pCursor->pos = pos + len;
+  return pCursor->buf + pos;
+}
+
+static void *udfShmRead(SUdfShmCursor *pCursor, int64_t len) {
+  int64_t pos = UDF_SHM_ALIGN(pCursor->pos);
+  if (len < 0 || pos + len > pCursor->cap) {
+    return NULL;
+  }
+
+  pCursor->pos = pos + len;
+  return pCursor->buf + pos;
+}
+
+static int32_t udfShmPutColData(SUdfShmCursor *pCursor, SUdfShmCol *pCol, const void *meta, const void *data) {
+  void *pMeta = udfShmAlloc(pCursor, pCol->metaLen);
+  if (pMeta == NULL) return -1;
+  pCol->metaOffset = (char *)pMeta - pCursor->buf;
+  if (pCol->metaLen > 0) memcpy(pMeta, meta, pCol->metaLen);
+
+  void *pData = udfShmAlloc(pCursor, pCol->dataLen);
+  if (pData == NULL) return -1;
+  pCol->dataOffset = (char *)pData - pCursor->buf;
+  if (pCol->dataLen > 0) memcpy(pData, data, pCol->dataLen);
+
+  return 0;
+}
+
+int32_t udfShmPutDataBlock(SUdfShmCursor *pCursor, const SSDataBlock *pBlock) {
+  int32_t numOfCols = taosArrayGetSize(pBlock->pDataBlock);
+  int32_t numOfRows = pBlock->info.rows;
+
+  SUdfShmBlock *pHead = udfShmAlloc(pCursor, sizeof(SUdfShmBlock));
+  SUdfShmCol   *pCols = udfShmAlloc(pCursor, sizeof(SUdfShmCol) * numOfCols);
+  if (pHead == NULL || pCols == NULL) return -1;
+
+  pHead->numOfRows = numOfRows;
+  pHead->numOfCols = numOfCols;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData *pColData = taosArrayGet(pBlock->pDataBlock, i);
+    SUdfShmCol      *pCol = &pCols[i];
+    pCol->type = pColData->info.type;
+    pCol->bytes = pColData->info.bytes;
+    pCol->precision = pColData->info.precision;
+    pCol->scale = pColData->info.scale;
+    pCol->hasNull = pColData->hasNull;
+    pCol->dataLen = colDataGetLength(pColData, numOfRows);
+    if (IS_VAR_DATA_TYPE(pCol->type)) {
+      pCol->metaLen = sizeof(int32_t) * numOfRows;
+      if (udfShmPutColData(pCursor, pCol, pColData->varmeta.offset, pColData->pData) != 0) return -1;
+    } else {
+      pCol->metaLen = BitmapLen(numOfRows);
+      if (udfShmPutColData(pCursor, pCol, pColData->nullbitmap, pColData->pData) != 0) return -1;
+    }
+  }
+
+  return 0;
+}
+
+int32_t udfShmPutUdfColumn(SUdfShmCursor *pCursor, const SUdfColumn *pUdfCol) {
+  SUdfShmBlock *pHead = udfShmAlloc(pCursor, sizeof(SUdfShmBlock));
+  SUdfShmCol   *pCol = udfShmAlloc(pCursor, sizeof(SUdfShmCol));
+  if (pHead == NULL || pCol == NULL) return -1;
+
+  const SUdfColumnData *pData = &pUdfCol->colData;
+  pHead->numOfRows = pData->numOfRows;
+  pHead->numOfCols = 1;
+
+  pCol->type = pUdfCol->colMeta.type;
+  pCol->bytes = pUdfCol->colMeta.bytes;
+  pCol->precision = pUdfCol->colMeta.precision;
+  pCol->scale = pUdfCol->colMeta.scale;
+  pCol->hasNull = pUdfCol->hasNull;
+  if (IS_VAR_DATA_TYPE(pCol->type)) {
+    pCol->metaLen = pData->varLenCol.varOffsetsLen;
+    pCol->dataLen = pData->varLenCol.payloadLen;
+    return udfShmPutColData(pCursor, pCol, pData->varLenCol.varOffsets, pData->varLenCol.payload);
+  } else {
+    pCol->metaLen = pData->fixLenCol.nullBitmapLen;
+    pCol->dataLen = pData->fixLenCol.dataLen;
+    return udfShmPutColData(pCursor, pCol, pData->fixLenCol.nullBitmap, pData->fixLenCol.data);
+  }
+}
+
+int32_t udfShmPutInterBuf(SUdfShmCursor *pCursor, const SUdfInterBuf *pBuf) {
+  int32_t *pHead = udfShmAlloc(pCursor, sizeof(int32_t) * 2);
+  void    *pData = udfShmAlloc(pCursor, pBuf->bufLen);
+  if (pHead == NULL || pData == NULL) return -1;
+
+  pHead[0] = pBuf->bufLen;
+  pHead[1] = pBuf->numOfResult;
+  if (pBuf->bufLen > 0) memcpy(pData, pBuf->buf, pBuf->bufLen);
+  return 0;
+}
+
+int32_t udfShmGetInterBuf(SUdfShmCursor *pCursor, SUdfInterBuf *pBuf, bool copy) {
+  int32_t *pHead = udfShmRead(pCursor, sizeof(int32_t) * 2);
+  if (pHead == NULL) return TSDB_CODE_UDF_INVALID_INPUT;
+
+  char *pData = udfShmRead(pCursor, pHead[0]);
+  if (pData == NULL) return TSDB_CODE_UDF_INVALID_INPUT;
+
+  pBuf->bufLen = pHead[0];
+  pBuf->numOfResult = pHead[1];
+  if (copy) {
+    pBuf->buf = taosMemoryMalloc(pBuf->bufLen);
+    if (pBuf->buf == NULL) return TSDB_CODE_OUT_OF_MEMORY;
+    memcpy(pBuf->buf, pData, pBuf->bufLen);
+  } else {
+    pBuf->buf = pData;
+  }
+  return 0;
+}
+
+static SUdfShmCol *udfShmReadBlockHead(SUdfShmCursor *pCursor, SUdfShmBlock **ppHead) {
+  SUdfShmBlock *pHead = udfShmRead(pCursor, sizeof(SUdfShmBlock));
+  if (pHead == NULL || pHead->numOfCols < 0 || pHead->numOfRows < 0) return NULL;
+
+  SUdfShmCol *pCols = udfShmRead(pCursor, sizeof(SUdfShmCol) * pHead->numOfCols);
+  if (pCols == NULL) return NULL;
+
+  for (int32_t i = 0; i < pHead->numOfCols; ++i) {
+    SUdfShmCol *pCol = &pCols[i];
+    if (pCol->metaLen < 0 || pCol->dataLen < 0 || pCol->metaOffset < 0 || pCol->dataOffset < 0 ||
+        pCol->metaOffset > pCursor->cap - pCol->metaLen || pCol->dataOffset > pCursor->cap - pCol->dataLen) {
+      return NULL;
+    }
+
+    // the readers index the offsets or the bitmap and the data by row without looking at the lengths again
+    if (IS_VAR_DATA_TYPE(pCol->type)) {
+      if (pCol->metaLen < (int64_t)sizeof(int32_t) * pHead->numOfRows) return NULL;
+    } else {
+      if (pCol->bytes < 0 || pCol->metaLen < BitmapLen(pHead->numOfRows) ||
+          (pCol->type != TSDB_DATA_TYPE_NULL && pCol->dataLen < (int64_t)pCol->bytes * pHead->numOfRows)) {
+        return NULL;
+      }
+    }
+    pCursor->pos = TMAX(pCursor->pos, pCol->dataOffset + pCol->dataLen);
+  }
+
+  *ppHead = pHead;
+  return pCols;
+}
+
+int32_t udfShmGetUdfDataBlock(SUdfShmCursor *pCursor, SUdfDataBlock *pBlock) {
+  SUdfShmBlock *pHead = NULL;
+  SUdfShmCol   *pCols = udfShmReadBlockHead(pCursor, &pHead);
+  if (pCols == NULL) return TSDB_CODE_UDF_INVALID_INPUT;
+
+  pBlock->numOfRows = pHead->numOfRows;
+  pBlock->numOfCols = pHead->numOfCols;
+  pBlock->udfCols = taosMemoryCalloc(pHead->numOfCols, sizeof(SUdfColumn *) + sizeof(SUdfColumn));
+  if (pBlock->udfCols == NULL) return TSDB_CODE_OUT_OF_MEMORY;
+
+  // the columns refer to the slot, only the column array is allocated
+  SUdfColumn *aUdfCol = (SUdfColumn *)(pBlock->udfCols + pHead->numOfCols);
+  for (int32_t i = 0; i < pHead->numOfCols; ++i) {
+    SUdfShmCol *pCol = &pCols[i];
+    SUdfColumn *pUdfCol = &aUdfCol[i];
+    pBlock->udfCols[i] = pUdfCol;
+
+    pUdfCol->colMeta.type = pCol->type;
+    pUdfCol->colMeta.bytes = pCol->bytes;
+    pUdfCol->colMeta.precision = pCol->precision;
+    pUdfCol->colMeta.scale = pCol->scale;
+    pUdfCol->hasNull = pCol->hasNull;
+    pUdfCol->colData.numOfRows = pHead->numOfRows;
+    pUdfCol->colData.rowsAlloc = pHead->numOfRows;
+    if (IS_VAR_DATA_TYPE(pCol->type)) {
+      pUdfCol->colData.varLenCol.varOffsetsLen = pCol->metaLen;
+      pUdfCol->colData.varLenCol.varOffsets = (int32_t *)(pCursor->buf + pCol->metaOffset);
+      pUdfCol->colData.varLenCol.payloadLen = pCol->dataLen;
+      pUdfCol->colData.varLenCol.payloadAllocLen = pCol->dataLen;
+      pUdfCol->colData.varLenCol.payload = pCursor->buf + pCol->dataOffset;
+    } else {
+      pUdfCol->colData.fixLenCol.nullBitmapLen = pCol->metaLen;
+      pUdfCol->colData.fixLenCol.nullBitmap = pCursor->buf + pCol->metaOffset;
+      pUdfCol->colData.fixLenCol.dataLen = pCol->dataLen;
+      pUdfCol->colData.fixLenCol.data = pCursor->buf + pCol->dataOffset;
+    }
+  }
+
+  return 0;
+}
+
+void udfShmFreeUdfDataBlock(SUdfDataBlock *pBlock) {
+  taosMemoryFree(pBlock->udfCols);
+  pBlock->udfCols = NULL;
+}
+
+int32_t udfShmGetDataBlock(SUdfShmCursor *pCursor, SSDataBlock *pBlock) {
+  SUdfShmBlock *pHead = NULL;
+  SUdfShmCol   *pCols = udfShmReadBlockHead(pCursor, &pHead);
+  if (pCols == NULL) return TSDB_CODE_UDF_INVALID_INPUT;
+
+  pBlock->info.rows = pHead->numOfRows;
+  pBlock->pDataBlock = taosArrayInit(pHead->numOfCols, sizeof(SColumnInfoData));
+  if (pBlock->pDataBlock == NULL) return TSDB_CODE_OUT_OF_MEMORY;
+
+  for (int32_t i = 0; i < pHead->numOfCols; ++i) {
+    SUdfShmCol     *pCol = &pCols[i];
+    SColumnInfoData colData = {0};
+    colData.info.type = pCol->type;
+    colData.info.bytes = pCol->bytes;
+    colData.info.precision = pCol->precision;
+    colData.info.scale = pCol->scale;
+    colData.hasNull = pCol->hasNull;
+
+    char *pMeta = taosMemoryMalloc(pCol->metaLen);
+    colData.pData = taosMemoryMalloc(pCol->dataLen);
+    if (IS_VAR_DATA_TYPE(pCol->type)) {
+      pBlock->info.hasVarCol = true;
+      colData.varmeta.offset = (int32_t *)pMeta;
+      colData.varmeta.length = pCol->dataLen;
+      colData.varmeta.allocLen = pCol->dataLen;
+    } else {
+      colData.nullbitmap = pMeta;
+    }
+
+    taosArrayPush(pBlock->pDataBlock, &colData);
+    if ((pMeta == NULL && pCol->metaLen > 0) || (colData.pData == NULL && pCol->dataLen > 0)) {
+      return TSDB_CODE_OUT_OF_MEMORY;
+    }
+    memcpy(pMeta, pCursor->buf + pCol->metaOffset, pCol->metaLen);
+    memcpy(colData.pData, pCursor->buf + pCol->dataOffset, pCol->dataLen);
+  }
+
+  return 0;
+}
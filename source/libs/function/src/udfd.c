@@ -103,7 +103,8 @@ typedef struct SUdf {
 
 // TODO: add private udf structure.
 typedef struct SUdfcFuncHandle {
-  SUdf *udf;
+  SUdf   *udf;
+  SUdfShm shm;  // shared memory of the session, base is NULL if not attached
 } SUdfcFuncHandle;
 
 typedef enum EUdfdRpcReqRspType {
@@ -229,8 +230,11 @@ void udfdProcessSetupRequest(SUvUdfWork *uvUdf, SUdfRequest *request) {
     }
     uv_mutex_unlock(&udf->lock);
   }
-  SUdfcFuncHandle *handle = taosMemoryMalloc(sizeof(SUdfcFuncHandle));
+  SUdfcFuncHandle *handle = taosMemoryCalloc(1, sizeof(SUdfcFuncHandle));
   handle->udf = udf;
+  if (code == TSDB_CODE_SUCCESS && setup->shmName[0] != 0) {
+    udfShmAttach(&handle->shm, setup->shmName, setup->shmSize);
+  }
 
   SUdfResponse rsp;
   rsp.seqNum = request->seqNum;
@@ -240,6 +244,7 @@ void udfdProcessSetupRequest(SUvUdfWork *uvUdf, SUdfRequest *request) {
   rsp.setupRsp.outputType = udf->outputType;
   rsp.setupRsp.outputLen = udf->outputLen;
   rsp.setupRsp.bufSize = udf->bufSize;
+  rsp.setupRsp.shmAttached = (handle->shm.base != NULL);
 
   int32_t len = encodeUdfResponse(NULL, &rsp);
   rsp.msgLen = len;
@@ -263,16 +268,42 @@ void udfdProcessCallRequest(SUvUdfWork *uvUdf, SUdfRequest *request) {
   SUdfResponse     *rsp = &response;
   SUdfCallResponse *subRsp = &rsp->callRsp;
 
-  int32_t code = TSDB_CODE_SUCCESS;
+  int32_t       code = TSDB_CODE_SUCCESS;
+  SUdfShmCursor cursor = {0};
+  if (call->shmSlot >= 0) {
+    if (handle->shm.base == NULL || call->shmSlot >= handle->shm.numOfSlots) {
+      fnError("invalid shared memory slot %d of call request, seq num %" PRId64, call->shmSlot, request->seqNum);
+      call->callType = -1;
+      code = TSDB_CODE_UDF_INVALID_INPUT;
+    } else {
+      udfShmInitCursor(&handle->shm, call->shmSlot, &cursor);
+    }
+  }
+
   switch (call->callType) {
     case TSDB_UDF_CALL_SCALA_PROC: {
       SUdfColumn output = {0};
 
       SUdfDataBlock input = {0};
-      convertDataBlockToUdfDataBlock(&call->block, &input);
-      code = udf->scalarProcFunc(&input, &output);
-      freeUdfDataDataBlock(&input);
-      convertUdfColumnToDataBlock(&output, &response.callRsp.resultData);
+      if (call->shmSlot >= 0) {
+        // the udf runs on the columns in the slot, and the result replaces them
+        code = udfShmGetUdfDataBlock(&cursor, &input);
+        if (code == TSDB_CODE_SUCCESS) {
+          code = udf->scalarProcFunc(&input, &output);
+        }
+        udfShmFreeUdfDataBlock(&input);
+        if (code == TSDB_CODE_SUCCESS) {
+          udfShmInitCursor(&handle->shm, call->shmSlot, &cursor);
+          subRsp->shmResult = (udfShmPutUdfColumn(&cursor, &output) == 0);
+        }
+      } else {
+        convertDataBlockToUdfDataBlock(&call->block, &input);
+        code = udf->scalarProcFunc(&input, &output);
+        freeUdfDataDataBlock(&input);
+      }
+      if (!subRsp->shmResult) {
+        convertUdfColumnToDataBlock(&output, &response.callRsp.resultData);
+      }
       freeUdfColumn(&output);
       break;
     }
@@ -284,11 +315,27 @@ void udfdProcessCallRequest(SUvUdfWork *uvUdf, SUdfRequest *request) {
     }
     case TSDB_UDF_CALL_AGG_PROC: {
       SUdfDataBlock input = {0};
-      convertDataBlockToUdfDataBlock(&call->block, &input);
-      SUdfInterBuf outBuf = {.buf = taosMemoryMalloc(udf->bufSize), .bufLen = udf->bufSize, .numOfResult = 0};
-      code = udf->aggProcFunc(&input, &call->interBuf, &outBuf);
-      freeUdfInterBuf(&call->interBuf);
-      freeUdfDataDataBlock(&input);
+      SUdfInterBuf  outBuf = {.buf = taosMemoryMalloc(udf->bufSize), .bufLen = udf->bufSize, .numOfResult = 0};
+      if (call->shmSlot >= 0) {
+        SUdfInterBuf state = {0};
+        code = udfShmGetUdfDataBlock(&cursor, &input);
+        if (code == TSDB_CODE_SUCCESS) {
+          code = udfShmGetInterBuf(&cursor, &state, false);
+        }
+        if (code == TSDB_CODE_SUCCESS) {
+          code = udf->aggProcFunc(&input, &state, &outBuf);
+        }
+        udfShmFreeUdfDataBlock(&input);
+        if (code == TSDB_CODE_SUCCESS) {
+          udfShmInitCursor(&handle->shm, call->shmSlot, &cursor);
+          subRsp->shmResult = (udfShmPutInterBuf(&cursor, &outBuf) == 0);
+        }
+      } else {
+        convertDataBlockToUdfDataBlock(&call->block, &input);
+        code = udf->aggProcFunc(&input, &call->interBuf, &outBuf);
+        freeUdfInterBuf(&call->interBuf);
+        freeUdfDataDataBlock(&input);
+      }
       subRsp->resultBuf = outBuf;
 
       break;
@@ -380,6 +427,7 @@ void udfdProcessTeardownRequest(SUvUdfWork *uvUdf, SUdfRequest *request) {
     uv_dlclose(&udf->lib);
     taosMemoryFree(udf);
   }
+  udfShmDetach(&handle->shm);
   taosMemoryFree(handle);
 
   SUdfResponse  response = {0};
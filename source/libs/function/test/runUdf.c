@@ -9,9 +9,13 @@
 #include "tglobal.h"
 #include "tudf.h"
 
+static bool runBench = false;
+
 static int32_t parseArgs(int32_t argc, char *argv[]) {
   for (int32_t i = 1; i < argc; ++i) {
-    if (strcmp(argv[i], "-c") == 0) {
+    if (strcmp(argv[i], "-b") == 0) {
+      runBench = true;
+    } else if (strcmp(argv[i], "-c") == 0) {
       if (i < argc - 1) {
         if (strlen(argv[++i]) >= PATH_MAX) {
           printf("config file path overflow");
@@ -124,6 +128,63 @@ int aggregateFuncTest() {
   return 0;
 }
 
+// throughput of scalar udf1 on blocks of int and binary columns, the data goes by shared memory if shmSize > 0
+int scalarFuncBench(int32_t shmSize, int32_t numOfBlocks, int32_t numOfRows) {
+  UdfcFuncHandle handle;
+
+  int32_t oldShmSize = tsUdfShmSize;
+  tsUdfShmSize = shmSize;
+  int32_t code = doSetupUdf("udf1", &handle);
+  tsUdfShmSize = oldShmSize;
+  if (code != 0) {
+    fnError("setup udf failure");
+    return -1;
+  }
+
+  SSDataBlock    *pBlock = createDataBlock();
+  SColumnInfoData intCol = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 1);
+  SColumnInfoData binCol = createColumnInfoData(TSDB_DATA_TYPE_VARCHAR, 32 + VARSTR_HEADER_SIZE, 2);
+  blockDataAppendColInfo(pBlock, &intCol);
+  blockDataAppendColInfo(pBlock, &binCol);
+  blockDataEnsureCapacity(pBlock, numOfRows);
+
+  char buf[32 + VARSTR_HEADER_SIZE] = {0};
+  for (int32_t j = 0; j < numOfRows; ++j) {
+    colDataSetInt32(taosArrayGet(pBlock->pDataBlock, 0), j, &j);
+    int32_t len = snprintf(varDataVal(buf), 32, "row_%d", j);
+    varDataSetLen(buf, len);
+    colDataSetVal(taosArrayGet(pBlock->pDataBlock, 1), j, buf, false);
+  }
+  pBlock->info.rows = numOfRows;
+
+  SScalarParam input[2] = {0};
+  for (int32_t i = 0; i < 2; ++i) {
+    input[i].numOfRows = numOfRows;
+    input[i].columnData = taosArrayGet(pBlock->pDataBlock, i);
+  }
+
+  int64_t bytes = blockGetEncodeSize(pBlock);
+  int64_t beg = taosGetTimestampUs();
+  for (int32_t k = 0; k < numOfBlocks; ++k) {
+    SScalarParam output = {0};
+    if (doCallUdfScalarFunc(handle, input, 2, &output) != 0) {
+      fprintf(stderr, "call udf failure at block %d\n", k);
+      break;
+    }
+    colDataDestroy(output.columnData);
+    taosMemoryFree(output.columnData);
+  }
+  int64_t elapsed = TMAX(taosGetTimestampUs() - beg, 1);
+
+  fprintf(stderr, "%s: %d blocks of %d rows in %.2f ms, %.0f rows/s, %.2f MB/s\n", shmSize > 0 ? "shm" : "pipe",
+          numOfBlocks, numOfRows, elapsed / 1000.0, (double)numOfBlocks * numOfRows * 1000000 / elapsed,
+          (double)numOfBlocks * bytes / elapsed);
+
+  blockDataDestroy(pBlock);
+  doTeardownUdf(handle);
+  return 0;
+}
+
 int main(int argc, char *argv[]) {
   parseArgs(argc, argv);
   initLog();
@@ -137,5 +198,13 @@ int main(int argc, char *argv[]) {
 
   scalarFuncTest();
   aggregateFuncTest();
+
+  // pipe vs shared memory throughput, only with -b
+  if (runBench) {
+    for (int32_t numOfRows = 1024; numOfRows <= 16384; numOfRows *= 4) {
+      scalarFuncBench(0, 200, numOfRows);
+      scalarFuncBench(16, 200, numOfRows);
+    }
+  }
   udfcClose();
 }
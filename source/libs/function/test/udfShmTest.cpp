@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "tdatablock.h"
+#include "tudf.h"
+#include "tudfInt.h"
+
+namespace {
+
+const int64_t udfShmTestSize = 1024 * 1024;
+
+class UdfShmTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(udfShmCreate(&shm_, udfShmTestSize), 0);
+    udfShmUnlink(&shm_);
+  }
+
+  void TearDown() override { udfShmDetach(&shm_); }
+
+  void initCursor(int32_t slot) { udfShmInitCursor(&shm_, slot, &cursor_); }
+
+  SUdfShm       shm_ = {0};
+  SUdfShmCursor cursor_ = {0};
+};
+
+// an int column with a null in the middle and a binary column
+SSDataBlock *udfShmTestCreateBlock(int32_t numOfRows) {
+  SSDataBlock    *pBlock = createDataBlock();
+  SColumnInfoData intCol = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 1);
+  SColumnInfoData binCol = createColumnInfoData(TSDB_DATA_TYPE_BINARY, 16 + VARSTR_HEADER_SIZE, 2);
+  blockDataAppendColInfo(pBlock, &intCol);
+  blockDataAppendColInfo(pBlock, &binCol);
+  blockDataEnsureCapacity(pBlock, numOfRows);
+
+  SColumnInfoData *pInt = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData *pBin = (SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 1);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    char str[16 + VARSTR_HEADER_SIZE] = {0};
+    int32_t len = snprintf(varDataVal(str), 16, "row%d", i);
+    varDataSetLen(str, len);
+    colDataAppend(pInt, i, (const char *)&i, i == 1);
+    colDataAppend(pBin, i, str, false);
+  }
+  pBlock->info.rows = numOfRows;
+  return pBlock;
+}
+
+}  // namespace
+
+TEST_F(UdfShmTest, blockRoundTrip) {
+  const int32_t numOfRows = 3;
+  SSDataBlock  *pBlock = udfShmTestCreateBlock(numOfRows);
+
+  int32_t slot = udfShmAcquireSlot(&shm_);
+  ASSERT_GE(slot, 0);
+  initCursor(slot);
+  ASSERT_EQ(udfShmPutDataBlock(&cursor_, pBlock), 0);
+
+  // udfd reads the columns in place
+  SUdfDataBlock udfBlock = {0};
+  initCursor(slot);
+  ASSERT_EQ(udfShmGetUdfDataBlock(&cursor_, &udfBlock), 0);
+  ASSERT_EQ(udfBlock.numOfRows, numOfRows);
+  ASSERT_EQ(udfBlock.numOfCols, 2);
+  EXPECT_FALSE(udfColDataIsNull(udfBlock.udfCols[0], 0));
+  EXPECT_TRUE(udfColDataIsNull(udfBlock.udfCols[0], 1));
+  EXPECT_EQ(*(int32_t *)udfColDataGetData(udfBlock.udfCols[0], 2), 2);
+  char *pStr = udfColDataGetData(udfBlock.udfCols[1], 2);
+  EXPECT_EQ(std::string(varDataVal(pStr), varDataLen(pStr)), "row2");
+  udfShmFreeUdfDataBlock(&udfBlock);
+
+  // udfc copies them out
+  SSDataBlock output = {0};
+  initCursor(slot);
+  ASSERT_EQ(udfShmGetDataBlock(&cursor_, &output), 0);
+  ASSERT_EQ(output.info.rows, numOfRows);
+  SColumnInfoData *pInt = (SColumnInfoData *)taosArrayGet(output.pDataBlock, 0);
+  SColumnInfoData *pBin = (SColumnInfoData *)taosArrayGet(output.pDataBlock, 1);
+  EXPECT_TRUE(colDataIsNull_s(pInt, 1));
+  EXPECT_EQ(*(int32_t *)colDataGetData(pInt, 2), 2);
+  pStr = colDataGetData(pBin, 0);
+  EXPECT_EQ(std::string(varDataVal(pStr), varDataLen(pStr)), "row0");
+  blockDataFreeRes(&output);
+
+  udfShmReleaseSlot(&shm_, slot);
+  blockDataDestroy(pBlock);
+}
+
+// udfd writes the result column, udfc must not index past what it claims to have written
+TEST_F(UdfShmTest, shortColumnRejected) {
+  const int32_t numOfRows = 100;
+  char          buf[1024] = {0};
+
+  auto check = [&](SUdfColumn *pCol, int32_t expectCode) {
+    int32_t slot = udfShmAcquireSlot(&shm_);
+    ASSERT_GE(slot, 0);
+    initCursor(slot);
+    ASSERT_EQ(udfShmPutUdfColumn(&cursor_, pCol), 0);
+
+    SSDataBlock output = {0};
+    initCursor(slot);
+    EXPECT_EQ(udfShmGetDataBlock(&cursor_, &output), expectCode);
+    blockDataFreeRes(&output);
+    udfShmReleaseSlot(&shm_, slot);
+  };
+
+  SUdfColumn varCol = {0};
+  varCol.colMeta.type = TSDB_DATA_TYPE_BINARY;
+  varCol.colMeta.bytes = 16;
+  varCol.colData.numOfRows = numOfRows;
+  varCol.colData.varLenCol.varOffsets = (int32_t *)buf;
+  varCol.colData.varLenCol.varOffsetsLen = sizeof(int32_t) * numOfRows;
+  varCol.colData.varLenCol.payload = buf;
+  varCol.colData.varLenCol.payloadLen = 0;
+  check(&varCol, 0);
+  varCol.colData.varLenCol.varOffsetsLen = sizeof(int32_t) * (numOfRows - 1);
+  check(&varCol, TSDB_CODE_UDF_INVALID_INPUT);
+
+  SUdfColumn fixCol = {0};
+  fixCol.colMeta.type = TSDB_DATA_TYPE_INT;
+  fixCol.colMeta.bytes = sizeof(int32_t);
+  fixCol.colData.numOfRows = numOfRows;
+  fixCol.colData.fixLenCol.nullBitmap = buf;
+  fixCol.colData.fixLenCol.nullBitmapLen = BitmapLen(numOfRows);
+  fixCol.colData.fixLenCol.data = buf;
+  fixCol.colData.fixLenCol.dataLen = sizeof(int32_t) * numOfRows;
+  check(&fixCol, 0);
+  fixCol.colData.fixLenCol.nullBitmapLen = BitmapLen(numOfRows) - 1;
+  check(&fixCol, TSDB_CODE_UDF_INVALID_INPUT);
+  fixCol.colData.fixLenCol.nullBitmapLen = BitmapLen(numOfRows);
+  fixCol.colData.fixLenCol.dataLen = sizeof(int32_t) * (numOfRows - 1);
+  check(&fixCol, TSDB_CODE_UDF_INVALID_INPUT);
+}
+
+// a slot whose call lost its response is never handed out again
+TEST_F(UdfShmTest, quarantinedSlotNotReused) {
+  int32_t lost = udfShmAcquireSlot(&shm_);
+  ASSERT_GE(lost, 0);
+  udfShmQuarantineSlot(&shm_, lost);
+  EXPECT_EQ(shm_.lostSlots, 1 << lost);
+
+  int32_t slots[UDF_SHM_MAX_SLOTS] = {0};
+  for (int32_t i = 0; i < UDF_SHM_MAX_SLOTS - 1; ++i) {
+    slots[i] = udfShmAcquireSlot(&shm_);
+    ASSERT_GE(slots[i], 0);
+    ASSERT_NE(slots[i], lost);
+  }
+  EXPECT_EQ(udfShmAcquireSlot(&shm_), -1);
+
+  for (int32_t i = 0; i < UDF_SHM_MAX_SLOTS - 1; ++i) {
+    udfShmReleaseSlot(&shm_, slots[i]);
+  }
+  for (int32_t i = 0; i < UDF_SHM_MAX_SLOTS - 1; ++i) {
+    ASSERT_NE(udfShmAcquireSlot(&shm_), lost);
+  }
+  EXPECT_EQ(udfShmAcquireSlot(&shm_), -1);
+}
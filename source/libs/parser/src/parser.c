@@ -16,8 +16,10 @@
 #include "parser.h"
 #include "os.h"
 
+#include "filter.h"
 #include "parInt.h"
 #include "parToken.h"
+#include "ttime.h"
 
 bool qIsInsertValuesSql(const char* pStr, size_t length) {
   if (NULL == pStr) {
@@ -48,6 +50,137 @@ bool qIsInsertValuesSql(const char* pStr, size_t length) {
   return false;
 }
 
+// Values of these are fixed when the statement is translated, so a plan built from them cannot be reused later.
+static bool isVolatileToken(uint32_t type, const char* z, uint32_t n) {
+  switch (type) {
+    case TK_NOW:
+    case TK_TODAY:
+    case TK_TIMEZONE:
+    case TK_CLIENT_VERSION:
+    case TK_SERVER_VERSION:
+    case TK_SERVER_STATUS:
+    case TK_QSTART:
+    case TK_QEND:
+    case TK_QDURATION:
+      return true;
+    case TK_NK_ID:
+      return 4 == n && 0 == strncasecmp(z, "rand", n);
+    default:
+      break;
+  }
+  return false;
+}
+
+static bool isCaseSensitiveToken(uint32_t type, const char* z) {
+  switch (type) {
+    case TK_NK_STRING:
+    case TK_NK_VARIABLE:
+    case TK_NK_INTEGER:
+    case TK_NK_FLOAT:
+    case TK_NK_HEX:
+    case TK_NK_BIN:
+      return true;
+    case TK_NK_ID:
+      return '`' == z[0];
+    default:
+      break;
+  }
+  return false;
+}
+
+static bool isCacheableParamToken(uint32_t type) {
+  switch (type) {
+    case TK_NK_STRING:
+    case TK_NK_INTEGER:
+    case TK_NK_FLOAT:
+    case TK_NK_HEX:
+    case TK_NK_BIN:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
+static int32_t appendCacheableParam(SArray* pParams, uint32_t type, const char* z, uint32_t n) {
+  SCacheableParam param = {.bound = false, .isNull = false, .type = type, .len = n, .pData = taosMemoryMalloc(n + 1)};
+  if (NULL == param.pData) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  memcpy(param.pData, z, n);
+  param.pData[n] = '\0';
+  if (NULL == taosArrayPush(pParams, &param)) {
+    taosMemoryFree(param.pData);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
+bool qNormalizeCacheableSql(const char* pStr, size_t length, bool withPlaceholder, char** pNormalized, int32_t* pLen,
+                            SArray* pParams) {
+  *pNormalized = NULL;
+  *pLen = 0;
+  if (NULL == pStr || 0 == length) {
+    return false;
+  }
+
+  char* pBuf = taosMemoryMalloc(length * 2 + 1);
+  if (NULL == pBuf) {
+    return false;
+  }
+
+  int32_t len = 0;
+  size_t  pos = 0;
+  bool    cacheable = true;
+  bool    end = false;
+  while (cacheable && pos < length && '\0' != pStr[pos]) {
+    uint32_t    type = 0;
+    const char* z = pStr + pos;
+    uint32_t    n = tGetToken(z, &type);
+    if (0 == n) {
+      cacheable = false;
+      break;
+    }
+    pos += n;
+
+    if (TK_NK_SPACE == type || TK_NK_COMMENT == type) {
+      continue;
+    }
+    if (TK_NK_SEMI == type) {
+      end = true;
+      continue;
+    }
+    if (end || TK_NK_ILLEGAL == type || (0 == len && TK_SELECT != type) || (TK_NK_QUESTION == type && !withPlaceholder) ||
+        isVolatileToken(type, z, n)) {
+      cacheable = false;
+      break;
+    }
+
+    if (len > 0) {
+      pBuf[len++] = ' ';
+    }
+    if (NULL != pParams && isCacheableParamToken(type)) {
+      cacheable = (TSDB_CODE_SUCCESS == appendCacheableParam(pParams, type, z, n));
+      pBuf[len++] = '?';
+      continue;
+    }
+    bool keepCase = isCaseSensitiveToken(type, z);
+    for (uint32_t i = 0; i < n; ++i) {
+      pBuf[len++] = keepCase ? z[i] : tolower(z[i]);
+    }
+  }
+
+  if (!cacheable || 0 == len) {
+    taosMemoryFree(pBuf);
+    return false;
+  }
+
+  pBuf[len] = '\0';
+  *pNormalized = pBuf;
+  *pLen = len;
+  return true;
+}
+
 static int32_t analyseSemantic(SParseContext* pCxt, SQuery* pQuery, SParseMetaCache* pMetaCache) {
   int32_t code = authenticate(pCxt, pQuery, pMetaCache);
 
@@ -285,3 +418,249 @@ int32_t qStmtParseQuerySql(SParseContext* pCxt, SQuery* pQuery) {
   }
   return code;
 }
+
+void qDestroyCacheableParams(SArray* pParams) {
+  int32_t num = taosArrayGetSize(pParams);
+  for (int32_t i = 0; i < num; ++i) {
+    taosMemoryFree(((SCacheableParam*)taosArrayGet(pParams, i))->pData);
+  }
+  taosArrayDestroy(pParams);
+}
+
+// The literal that createValueNode makes from the token of the param, NULL for a bound value.
+static int32_t getCacheableParamLiteral(const SCacheableParam* pParam, char** pLiteral) {
+  *pLiteral = NULL;
+  if (pParam->bound) {
+    return TSDB_CODE_SUCCESS;
+  }
+  *pLiteral = taosMemoryCalloc(1, pParam->len + 1);
+  if (NULL == *pLiteral) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  if (TK_NK_STRING == pParam->type) {
+    trimString(pParam->pData, pParam->len, *pLiteral, pParam->len);
+  } else {
+    memcpy(*pLiteral, pParam->pData, pParam->len);
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
+// Sets a primary key value of a translated statement from a param, the same way translateValue and
+// setValueByBindParam do. A literal is only accepted as a string or an integer.
+static int32_t setValueByCacheableParam(SValueNode* pVal, const SCacheableParam* pParam) {
+  if (pParam->bound) {
+    int32_t         len = pParam->len;
+    char            isNull = pParam->isNull ? 1 : 0;
+    TAOS_MULTI_BIND bind = {.buffer_type = pParam->type,
+                            .buffer = pParam->pData,
+                            .buffer_length = pParam->len,
+                            .length = &len,
+                            .is_null = &isNull,
+                            .num = 1};
+    return setValueByBindParam(pVal, &bind);
+  }
+
+  if (TK_NK_STRING != pParam->type && TK_NK_INTEGER != pParam->type) {
+    return TSDB_CODE_PAR_WRONG_VALUE_TYPE;
+  }
+  char*   pLiteral = NULL;
+  int32_t code = getCacheableParamLiteral(pParam, &pLiteral);
+  if (TSDB_CODE_SUCCESS != code) {
+    return code;
+  }
+
+  int64_t val = 0;
+  if (TK_NK_INTEGER == pParam->type) {
+    code = toInteger(pLiteral, strlen(pLiteral), 10, &val);
+  } else if (TSDB_CODE_SUCCESS !=
+             taosParseTime(pLiteral, &val, strlen(pLiteral), pVal->node.resType.precision, tsDaylight)) {
+    char* pEnd = NULL;
+    val = taosStr2Int64(pLiteral, &pEnd, 10);
+    code = (NULL != pEnd && '\0' == *pEnd) ? TSDB_CODE_SUCCESS : TSDB_CODE_PAR_WRONG_VALUE_TYPE;
+  }
+  if (TSDB_CODE_SUCCESS != code) {
+    taosMemoryFree(pLiteral);
+    return TSDB_CODE_PAR_WRONG_VALUE_TYPE;
+  }
+
+  taosMemoryFree(pVal->literal);
+  pVal->literal = pLiteral;
+  pVal->datum.i = val;
+  *(int64_t*)&pVal->typeData = val;
+  return TSDB_CODE_SUCCESS;
+}
+
+static bool isCacheableRangeValueType(int32_t type) {
+  return TSDB_DATA_TYPE_TIMESTAMP == type || IS_SIGNED_NUMERIC_TYPE(type);
+}
+
+typedef struct SCacheableRangeCxt {
+  const SArray* pParams;
+  char**        pLiterals;
+  bool*         pRebindable;
+  int32_t       code;
+} SCacheableRangeCxt;
+
+// A bound value is found by its placeholder number. A literal is found by its text, which must be written only once
+// in the statement, otherwise the value node cannot be told apart from another one made of the same text.
+static int32_t findCacheableParam(SCacheableRangeCxt* pCxt, const SValueNode* pVal) {
+  int32_t num = taosArrayGetSize(pCxt->pParams);
+  if (pVal->placeholderNo > 0) {
+    int32_t index = pVal->placeholderNo - 1;
+    return (index < num && ((SCacheableParam*)taosArrayGet(pCxt->pParams, index))->bound) ? index : -1;
+  }
+  if (NULL == pVal->literal || !isCacheableRangeValueType(pVal->node.resType.type)) {
+    return -1;
+  }
+  int32_t index = -1;
+  for (int32_t i = 0; i < num; ++i) {
+    if (NULL != pCxt->pLiterals[i] && 0 == strcmp(pCxt->pLiterals[i], pVal->literal)) {
+      if (index >= 0) {
+        return -1;
+      }
+      index = i;
+    }
+  }
+  return index;
+}
+
+static EDealRes markCacheableParam(SNode* pNode, void* pContext) {
+  if (QUERY_NODE_VALUE != nodeType(pNode)) {
+    return DEAL_RES_CONTINUE;
+  }
+
+  SCacheableRangeCxt* pCxt = (SCacheableRangeCxt*)pContext;
+  SValueNode*         pVal = (SValueNode*)pNode;
+  int32_t             index = findCacheableParam(pCxt, pVal);
+  pVal->placeholderNo = 0;
+  if (index < 0 || pVal->isNull || !isCacheableRangeValueType(pVal->node.resType.type)) {
+    return DEAL_RES_CONTINUE;
+  }
+
+  // the param is only rebound if setting it again reproduces the value the statement was translated to
+  SValueNode* pCopy = (SValueNode*)nodesCloneNode(pNode);
+  if (NULL == pCopy) {
+    pCxt->code = TSDB_CODE_OUT_OF_MEMORY;
+    return DEAL_RES_ERROR;
+  }
+  if (TSDB_CODE_SUCCESS == setValueByCacheableParam(pCopy, taosArrayGet(pCxt->pParams, index)) &&
+      pCopy->node.resType.type == pVal->node.resType.type && pCopy->datum.i == pVal->datum.i) {
+    pVal->placeholderNo = index + 1;
+    pCxt->pRebindable[index] = true;
+  }
+  nodesDestroyNode((SNode*)pCopy);
+  return DEAL_RES_CONTINUE;
+}
+
+static int32_t markCacheableParams(SNode* pCond, const SArray* pParams, bool* pRebindable) {
+  int32_t            num = taosArrayGetSize(pParams);
+  SCacheableRangeCxt cxt = {.pParams = pParams,
+                            .pLiterals = taosMemoryCalloc(TMAX(num, 1), POINTER_BYTES),
+                            .pRebindable = pRebindable,
+                            .code = TSDB_CODE_SUCCESS};
+  if (NULL == cxt.pLiterals) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  for (int32_t i = 0; TSDB_CODE_SUCCESS == cxt.code && i < num; ++i) {
+    cxt.code = getCacheableParamLiteral(taosArrayGet(pParams, i), cxt.pLiterals + i);
+  }
+  if (TSDB_CODE_SUCCESS == cxt.code) {
+    nodesWalkExpr(pCond, markCacheableParam, &cxt);
+  }
+  for (int32_t i = 0; i < num; ++i) {
+    taosMemoryFree(cxt.pLiterals[i]);
+  }
+  taosMemoryFree(cxt.pLiterals);
+  return cxt.code;
+}
+
+// The time range of a single table query goes only into the scan range of its table scans, as long as there is no
+// fill, interp or tsma rewrite that derives more plan state from it.
+static bool isTimeRangeRebindable(const SNode* pRoot) {
+  if (NULL == pRoot || QUERY_NODE_SELECT_STMT != nodeType(pRoot)) {
+    return false;
+  }
+  const SSelectStmt* pSelect = (const SSelectStmt*)pRoot;
+  if (NULL == pSelect->pWhere || NULL == pSelect->pFromTable ||
+      QUERY_NODE_REAL_TABLE != nodeType(pSelect->pFromTable) || NULL != pSelect->pFill || NULL != pSelect->pRange ||
+      NULL != pSelect->pEvery || pSelect->hasInterpFunc || pSelect->isEmptyResult) {
+    return false;
+  }
+  return 0 == taosArrayGetSize(((SRealTableNode*)pSelect->pFromTable)->pSmaIndexes);
+}
+
+int32_t qBuildCacheableTimeRange(const SQuery* pQuery, const SArray* pParams, bool* pRebindable, SNode** ppCond,
+                                 STimeWindow* pRange) {
+  *ppCond = NULL;
+  if (!isTimeRangeRebindable(pQuery->pRoot)) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SNode* pWhere = nodesCloneNode(((SSelectStmt*)pQuery->pRoot)->pWhere);
+  if (NULL == pWhere) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  SNode*  pPrimaryKeyCond = NULL;
+  SNode*  pTagIndexCond = NULL;
+  SNode*  pTagCond = NULL;
+  SNode*  pOtherCond = NULL;
+  int32_t code = filterPartitionCond(&pWhere, &pPrimaryKeyCond, &pTagIndexCond, &pTagCond, &pOtherCond);
+  nodesDestroyNode(pWhere);
+  nodesDestroyNode(pTagIndexCond);
+  nodesDestroyNode(pTagCond);
+  nodesDestroyNode(pOtherCond);
+
+  // a condition that is not strict stays in the scan conditions with the old values
+  bool isStrict = false;
+  if (TSDB_CODE_SUCCESS == code && NULL != pPrimaryKeyCond) {
+    code = filterGetTimeRange(pPrimaryKeyCond, pRange, &isStrict);
+  }
+  if (TSDB_CODE_SUCCESS == code && NULL != pPrimaryKeyCond && isStrict && pRange->skey <= pRange->ekey) {
+    code = markCacheableParams(pPrimaryKeyCond, pParams, pRebindable);
+    for (int32_t i = 0; TSDB_CODE_SUCCESS == code && i < taosArrayGetSize(pParams); ++i) {
+      if (pRebindable[i]) {
+        *ppCond = pPrimaryKeyCond;
+        pPrimaryKeyCond = NULL;
+        break;
+      }
+    }
+  }
+  nodesDestroyNode(pPrimaryKeyCond);
+  if (NULL == *ppCond) {
+    memset(pRebindable, 0, taosArrayGetSize(pParams) * sizeof(bool));
+  }
+  return code;
+}
+
+static EDealRes rebindCacheableParam(SNode* pNode, void* pContext) {
+  if (QUERY_NODE_VALUE != nodeType(pNode) || 0 == ((SValueNode*)pNode)->placeholderNo) {
+    return DEAL_RES_CONTINUE;
+  }
+  SCacheableRangeCxt* pCxt = (SCacheableRangeCxt*)pContext;
+  SValueNode*         pVal = (SValueNode*)pNode;
+  if (pVal->placeholderNo > taosArrayGetSize(pCxt->pParams)) {
+    pCxt->code = TSDB_CODE_PAR_WRONG_VALUE_TYPE;
+    return DEAL_RES_ERROR;
+  }
+  pCxt->code = setValueByCacheableParam(pVal, taosArrayGet(pCxt->pParams, pVal->placeholderNo - 1));
+  return TSDB_CODE_SUCCESS == pCxt->code ? DEAL_RES_CONTINUE : DEAL_RES_ERROR;
+}
+
+int32_t qRebindCacheableTimeRange(const SNode* pCond, const SArray* pParams, STimeWindow* pRange) {
+  SNode* pCopy = nodesCloneNode(pCond);
+  if (NULL == pCopy) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  SCacheableRangeCxt cxt = {.pParams = pParams, .code = TSDB_CODE_SUCCESS};
+  nodesWalkExpr(pCopy, rebindCacheableParam, &cxt);
+
+  bool isStrict = false;
+  if (TSDB_CODE_SUCCESS == cxt.code) {
+    cxt.code = filterGetTimeRange(pCopy, pRange, &isStrict);
+  }
+  if (TSDB_CODE_SUCCESS == cxt.code && (!isStrict || pRange->skey > pRange->ekey)) {
+    cxt.code = TSDB_CODE_FAILED;
+  }
+  nodesDestroyNode(pCopy);
+  return cxt.code;
+}
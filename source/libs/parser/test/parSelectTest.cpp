@@ -14,6 +14,7 @@
  */
 
 #include "parTestUtil.h"
+#include "parser.h"
 
 using namespace std;
 
@@ -461,4 +462,41 @@ TEST_F(ParserSelectTest, joinSemanticCheck) {
       TSDB_CODE_PAR_NOT_SUPPORT_JOIN);
 }
 
+TEST_F(ParserSelectTest, normalizeCacheableSql) {
+  auto normalize = [](const string& sql, bool withPlaceholder) {
+    char*   pNormalized = nullptr;
+    int32_t len = 0;
+    if (!qNormalizeCacheableSql(sql.c_str(), sql.length(), withPlaceholder, &pNormalized, &len, nullptr)) {
+      return string("<not cacheable>");
+    }
+    string res(pNormalized, len);
+    taosMemoryFree(pNormalized);
+    return res;
+  };
+
+  ASSERT_EQ(normalize("SELECT  C1,`Tag1`\n FROM St1 WHERE c2 = 'Ab' ;", false),
+            "select c1 , `Tag1` from st1 where c2 = 'Ab'");
+  ASSERT_EQ(normalize("select c1 from st1 where ts > 0x1F", false), "select c1 from st1 where ts > 0x1F");
+  ASSERT_EQ(normalize("SELECT * FROM t1 WHERE c1 = ?", true), "select * from t1 where c1 = ?");
+
+  ASSERT_EQ(normalize("SELECT * FROM t1 WHERE c1 = ?", false), "<not cacheable>");
+  ASSERT_EQ(normalize("SELECT * FROM t1 WHERE ts > NOW - 1d", false), "<not cacheable>");
+  ASSERT_EQ(normalize("SELECT RAND() FROM t1", false), "<not cacheable>");
+  ASSERT_EQ(normalize("SELECT SERVER_STATUS()", false), "<not cacheable>");
+  ASSERT_EQ(normalize("INSERT INTO t1 VALUES (NOW, 1)", false), "<not cacheable>");
+  ASSERT_EQ(normalize("SELECT * FROM t1; SELECT * FROM t2", false), "<not cacheable>");
+  ASSERT_EQ(normalize("SELECT _QSTART, COUNT(*) FROM t1 WHERE ts > 0", false), "<not cacheable>");
+
+  string  sql = "SELECT c1 FROM t1 WHERE ts > '2022-04-01 00:00:00' AND c2 = 'Ab' AND c1 < 0x1F";
+  SArray* pParams = taosArrayInit(TARRAY_MIN_SIZE, sizeof(SCacheableParam));
+  char*   pNormalized = nullptr;
+  int32_t len = 0;
+  ASSERT_TRUE(qNormalizeCacheableSql(sql.c_str(), sql.length(), false, &pNormalized, &len, pParams));
+  ASSERT_EQ(string(pNormalized, len), "select c1 from t1 where ts > ? and c2 = ? and c1 < ?");
+  ASSERT_EQ(taosArrayGetSize(pParams), 3);
+  ASSERT_FALSE(((SCacheableParam*)taosArrayGet(pParams, 0))->bound);
+  taosMemoryFree(pNormalized);
+  qDestroyCacheableParams(pParams);
+}
+
 }  // namespace ParserTest
@@ -0,0 +1,492 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "planInt.h"
+
+// Statistics that are not known to the client fall back to these defaults. They only need to be good enough to order
+// plan alternatives, not to predict exact cardinalities.
+#define COST_DEFAULT_TABLES_PER_VGROUP 1000.0
+#define COST_DEFAULT_ROWS_PER_TABLE    10000.0
+#define COST_DEFAULT_SYSTABLE_ROWS     1000.0
+#define COST_DEFAULT_GROUPS            200.0
+
+#define COST_SEL_DEFAULT    0.5
+#define COST_SEL_EQUAL      0.05
+#define COST_SEL_RANGE      (1.0 / 3.0)
+#define COST_SEL_LIKE       0.1
+#define COST_SEL_NULL       0.05
+#define COST_SEL_TIME_RANGE 0.1
+
+#define COST_OPEN_TABLE    10.0
+#define COST_SCAN_ROW      1.0
+#define COST_CPU_ROW       0.1
+#define COST_CPU_COMPARE   0.02
+#define COST_TRANSFER_ROW  0.5
+#define COST_SPILL_ROW     2.0   // written to disk and read back in order
+#define COST_SPILL_RAND    10.0  // aggregated into a result row that has been spilled to disk
+
+// The group by and sort operators of the executor keep this much of their buffers in memory and spill the rest, see
+// getBufferPgSize().
+#define COST_OPERATOR_BUFFER_BYTES (4096.0 * 2560)
+#define COST_RESULT_ROW_HEADER     64.0
+
+static double costClamp(double val, double min, double max) {
+  if (val < min) {
+    return min;
+  }
+  return val > max ? max : val;
+}
+
+static double costEstimateSelectivity(SNode* pCond);
+
+static double costEstimateLogicCondSelectivity(SLogicConditionNode* pCond) {
+  double sel = (LOGIC_COND_TYPE_AND == pCond->condType ? 1.0 : 0.0);
+  SNode* pParam = NULL;
+  FOREACH(pParam, pCond->pParameterList) {
+    double paramSel = costEstimateSelectivity(pParam);
+    switch (pCond->condType) {
+      case LOGIC_COND_TYPE_AND:
+        sel *= paramSel;
+        break;
+      case LOGIC_COND_TYPE_OR:
+        sel = sel + paramSel - sel * paramSel;
+        break;
+      case LOGIC_COND_TYPE_NOT:
+        sel = 1.0 - paramSel;
+        break;
+      default:
+        break;
+    }
+  }
+  return sel;
+}
+
+static double costEstimateOperatorSelectivity(SOperatorNode* pOper) {
+  switch (pOper->opType) {
+    case OP_TYPE_EQUAL:
+      return COST_SEL_EQUAL;
+    case OP_TYPE_NOT_EQUAL:
+      return 1.0 - COST_SEL_EQUAL;
+    case OP_TYPE_GREATER_THAN:
+    case OP_TYPE_GREATER_EQUAL:
+    case OP_TYPE_LOWER_THAN:
+    case OP_TYPE_LOWER_EQUAL:
+      return COST_SEL_RANGE;
+    case OP_TYPE_IN:
+    case OP_TYPE_NOT_IN: {
+      int32_t num = 1;
+      if (NULL != pOper->pRight && QUERY_NODE_NODE_LIST == nodeType(pOper->pRight)) {
+        num = LIST_LENGTH(((SNodeListNode*)pOper->pRight)->pNodeList);
+      }
+      double sel = costClamp(COST_SEL_EQUAL * num, COST_SEL_EQUAL, COST_SEL_DEFAULT);
+      return OP_TYPE_IN == pOper->opType ? sel : 1.0 - sel;
+    }
+    case OP_TYPE_LIKE:
+    case OP_TYPE_MATCH:
+      return COST_SEL_LIKE;
+    case OP_TYPE_NOT_LIKE:
+    case OP_TYPE_NMATCH:
+      return 1.0 - COST_SEL_LIKE;
+    case OP_TYPE_IS_NULL:
+      return COST_SEL_NULL;
+    case OP_TYPE_IS_NOT_NULL:
+      return 1.0 - COST_SEL_NULL;
+    default:
+      break;
+  }
+  return COST_SEL_DEFAULT;
+}
+
+static double costEstimateSelectivity(SNode* pCond) {
+  if (NULL == pCond) {
+    return 1.0;
+  }
+  switch (nodeType(pCond)) {
+    case QUERY_NODE_LOGIC_CONDITION:
+      return costEstimateLogicCondSelectivity((SLogicConditionNode*)pCond);
+    case QUERY_NODE_OPERATOR:
+      return costEstimateOperatorSelectivity((SOperatorNode*)pCond);
+    default:
+      break;
+  }
+  return COST_SEL_DEFAULT;
+}
+
+static double costApplyLimit(double rows, SNode* pLimit) {
+  if (NULL == pLimit) {
+    return rows;
+  }
+  SLimitNode* pLimitNode = (SLimitNode*)pLimit;
+  double      limit = (double)pLimitNode->limit + (pLimitNode->offset > 0 ? (double)pLimitNode->offset : 0);
+  return (pLimitNode->limit >= 0 && limit < rows) ? limit : rows;
+}
+
+static bool costIsTimeRangeBounded(const STimeWindow* pRange) {
+  return TSKEY_MIN != pRange->skey && TSKEY_MAX != pRange->ekey;
+}
+
+static double costEstimateTimeRangeSelectivity(const STimeWindow* pRange) {
+  if (pRange->skey > pRange->ekey) {
+    return 0;
+  }
+  if (costIsTimeRangeBounded(pRange)) {
+    return COST_SEL_TIME_RANGE;
+  }
+  if (TSKEY_MIN != pRange->skey || TSKEY_MAX != pRange->ekey) {
+    return COST_SEL_RANGE;
+  }
+  return 1.0;
+}
+
+static double costEstimateScanTables(SScanLogicNode* pScan) {
+  if (TSDB_SUPER_TABLE != pScan->tableType) {
+    return 1.0;
+  }
+
+  int32_t numOfVgroups = (NULL == pScan->pVgroupList ? 0 : pScan->pVgroupList->numOfVgroups);
+  double  tables = 0;
+  for (int32_t i = 0; i < numOfVgroups; ++i) {
+    tables += (double)pScan->pVgroupList->vgroups[i].numOfTable * TSDB_TABLE_NUM_UNIT;
+  }
+  if (tables <= 0) {
+    tables = TMAX(numOfVgroups, 1) * COST_DEFAULT_TABLES_PER_VGROUP;
+  }
+  return TMAX(tables * costEstimateSelectivity(pScan->pTagCond), 1.0);
+}
+
+static void costEstimateScan(SScanLogicNode* pScan) {
+  double tables = costEstimateScanTables(pScan);
+  double rows = 0;
+  double cost = 0;
+
+  switch (pScan->scanType) {
+    case SCAN_TYPE_TAG:
+    case SCAN_TYPE_LAST_ROW:
+      rows = tables;
+      cost = tables * COST_OPEN_TABLE;
+      break;
+    case SCAN_TYPE_TABLE_COUNT:
+    case SCAN_TYPE_BLOCK_INFO:
+      rows = (NULL == pScan->pVgroupList ? 1.0 : TMAX(pScan->pVgroupList->numOfVgroups, 1));
+      cost = rows * COST_OPEN_TABLE;
+      break;
+    case SCAN_TYPE_SYSTEM_TABLE:
+      rows = COST_DEFAULT_SYSTABLE_ROWS;
+      cost = rows * COST_CPU_ROW;
+      break;
+    default: {
+      double scanRows = tables * COST_DEFAULT_ROWS_PER_TABLE * costEstimateTimeRangeSelectivity(&pScan->scanRange);
+      if (pScan->ratio > 0 && pScan->ratio < 1) {
+        scanRows *= pScan->ratio;
+      }
+      rows = scanRows * costEstimateSelectivity(pScan->node.pConditions);
+      cost = tables * COST_OPEN_TABLE + scanRows * COST_SCAN_ROW;
+      if (NULL != pScan->node.pConditions) {
+        cost += scanRows * COST_CPU_ROW;
+      }
+      break;
+    }
+  }
+
+  pScan->node.estRows = rows;
+  pScan->node.estCost = cost;
+}
+
+static double costGetScanTables(SLogicNode* pNode) {
+  if (QUERY_NODE_LOGIC_PLAN_SCAN == nodeType(pNode)) {
+    return costEstimateScanTables((SScanLogicNode*)pNode);
+  }
+  double tables = 0;
+  SNode* pChild = NULL;
+  FOREACH(pChild, pNode->pChildren) { tables += costGetScanTables((SLogicNode*)pChild); }
+  return tables;
+}
+
+static EDealRes costHasNonTagColImpl(SNode* pNode, void* pContext) {
+  if (QUERY_NODE_COLUMN == nodeType(pNode) && COLUMN_TYPE_TAG != ((SColumnNode*)pNode)->colType &&
+      COLUMN_TYPE_TBNAME != ((SColumnNode*)pNode)->colType) {
+    *(bool*)pContext = true;
+    return DEAL_RES_END;
+  }
+  return DEAL_RES_CONTINUE;
+}
+
+static double costEstimateGroups(SLogicNode* pNode, SNodeList* pKeys, double inputRows) {
+  if (NULL == pKeys) {
+    return TMIN(inputRows, 1.0);
+  }
+  bool hasNonTagCol = false;
+  nodesWalkExprs(pKeys, costHasNonTagColImpl, &hasNonTagCol);
+  double groups = 0;
+  if (!hasNonTagCol) {
+    // grouping by tags or tbname can not produce more groups than there are child tables
+    groups = costGetScanTables(pNode);
+  } else {
+    groups = pow(COST_DEFAULT_GROUPS, LIST_LENGTH(pKeys));
+  }
+  return costClamp(groups, TMIN(inputRows, 1.0), inputRows);
+}
+
+static double costEstimateWindows(SWindowLogicNode* pWindow, double inputRows) {
+  if (WINDOW_TYPE_INTERVAL != pWindow->winType) {
+    return inputRows * COST_SEL_LIKE;
+  }
+  SLogicNode* pScan = (SLogicNode*)nodesListGetNode(pWindow->node.pChildren, 0);
+  while (NULL != pScan && QUERY_NODE_LOGIC_PLAN_SCAN != nodeType(pScan)) {
+    pScan = (SLogicNode*)nodesListGetNode(pScan->pChildren, 0);
+  }
+  int64_t sliding = (pWindow->sliding > 0 ? pWindow->sliding : pWindow->interval);
+  if (NULL == pScan || sliding <= 0 || 'n' == pWindow->slidingUnit || 'y' == pWindow->slidingUnit ||
+      !costIsTimeRangeBounded(&((SScanLogicNode*)pScan)->scanRange)) {
+    return inputRows * COST_SEL_LIKE;
+  }
+  STimeWindow* pRange = &((SScanLogicNode*)pScan)->scanRange;
+  double       windows = ((double)pRange->ekey - (double)pRange->skey) / sliding + 1;
+  return TMIN(windows * TMAX(costGetScanTables(pScan), 1.0), inputRows);
+}
+
+static double costLog2(double val) { return val > 1 ? log2(val) : 1; }
+
+static double costEstimateRowBytes(SNodeList* pExprs) {
+  double bytes = 0;
+  SNode* pExpr = NULL;
+  FOREACH(pExpr, pExprs) {
+    if (QUERY_NODE_GROUPING_SET == nodeType(pExpr)) {
+      pExpr = nodesListGetNode(((SGroupingSetNode*)pExpr)->pParameterList, 0);
+    }
+    bytes += ((SExprNode*)pExpr)->resType.bytes;
+  }
+  return bytes;
+}
+
+static bool costCanSortGroupKeys(SAggLogicNode* pAgg) {
+  if (NULL == pAgg->pGroupKeys || pAgg->hasGroupKeyOptimized || pAgg->hasTimeLineFunc ||
+      1 != LIST_LENGTH(pAgg->node.pChildren)) {
+    return false;
+  }
+
+  // a scan of more than one vgroup is aggregated per vgroup first, which a sort below the aggregation would prevent
+  SScanLogicNode* pScan = (SScanLogicNode*)nodesListGetNode(pAgg->node.pChildren, 0);
+  if (QUERY_NODE_LOGIC_PLAN_SCAN != nodeType(pScan) || SCAN_TYPE_TABLE != pScan->scanType ||
+      NULL != pScan->pGroupTags || (NULL != pScan->pVgroupList && pScan->pVgroupList->numOfVgroups > 1)) {
+    return false;
+  }
+
+  SNode* pKey = NULL;
+  FOREACH(pKey, pAgg->pGroupKeys) {
+    SNode* pExpr = nodesListGetNode(((SGroupingSetNode*)pKey)->pParameterList, 0);
+    if (QUERY_NODE_COLUMN != nodeType(pExpr) || TSDB_DATA_TYPE_JSON == ((SExprNode*)pExpr)->resType.type) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static int32_t costCreateGroupKeySort(SAggLogicNode* pAgg, SSortLogicNode** pOutput) {
+  SSortLogicNode* pSort = (SSortLogicNode*)nodesMakeNode(QUERY_NODE_LOGIC_PLAN_SORT);
+  if (NULL == pSort) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  SNode*  pKey = NULL;
+  FOREACH(pKey, pAgg->pGroupKeys) {
+    SOrderByExprNode* pOrder = (SOrderByExprNode*)nodesMakeNode(QUERY_NODE_ORDER_BY_EXPR);
+    if (NULL == pOrder) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      break;
+    }
+    pOrder->order = ORDER_ASC;
+    pOrder->nullOrder = NULL_ORDER_FIRST;
+    pOrder->pExpr = nodesCloneNode(nodesListGetNode(((SGroupingSetNode*)pKey)->pParameterList, 0));
+    if (NULL == pOrder->pExpr) {
+      nodesDestroyNode((SNode*)pOrder);
+      code = TSDB_CODE_OUT_OF_MEMORY;
+      break;
+    }
+    code = nodesListMakeStrictAppend(&pSort->pSortKeys, (SNode*)pOrder);
+    if (TSDB_CODE_SUCCESS != code) {
+      break;
+    }
+  }
+
+  SLogicNode* pChild = (SLogicNode*)nodesListGetNode(pAgg->node.pChildren, 0);
+  if (TSDB_CODE_SUCCESS == code) {
+    pSort->node.pTargets = nodesCloneList(pChild->pTargets);
+    if (NULL == pSort->node.pTargets) {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+    }
+  }
+
+  if (TSDB_CODE_SUCCESS == code) {
+    pSort->node.groupAction = GROUP_ACTION_CLEAR;
+    pSort->node.requireDataOrder = DATA_ORDER_LEVEL_NONE;
+    pSort->node.resultDataOrder = DATA_ORDER_LEVEL_NONE;
+    pSort->node.precision = pChild->precision;
+    TSWAP(pSort->node.pChildren, pAgg->node.pChildren);
+    pChild->pParent = (SLogicNode*)pSort;
+    code = nodesListMakeStrictAppend(&pAgg->node.pChildren, (SNode*)pSort);
+    if (TSDB_CODE_SUCCESS == code) {
+      pSort->node.pParent = (SLogicNode*)pAgg;
+      *pOutput = pSort;
+    }
+    return code;
+  }
+
+  nodesDestroyNode((SNode*)pSort);
+  return code;
+}
+
+// Hash grouping keeps one result row per group and goes to disk once they outgrow the operator buffer, at random for
+// each input row. Sort grouping sorts the input by the group keys first, which spills in sequence, and then needs only
+// the result row of the current group.
+static int32_t costChooseGroupAlgo(SAggLogicNode* pAgg, double inputRows, double groups, double* pCost) {
+  double groupBytes = groups * (COST_RESULT_ROW_HEADER + costEstimateRowBytes(pAgg->pAggFuncs) +
+                                costEstimateRowBytes(pAgg->pGroupKeys));
+  double hashCost = inputRows * COST_CPU_ROW;
+  if (groupBytes > COST_OPERATOR_BUFFER_BYTES) {
+    hashCost += inputRows * (1.0 - COST_OPERATOR_BUFFER_BYTES / groupBytes) * COST_SPILL_RAND;
+  }
+
+  if (!costCanSortGroupKeys(pAgg)) {
+    *pCost += hashCost;
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SLogicNode* pChild = (SLogicNode*)nodesListGetNode(pAgg->node.pChildren, 0);
+  double      sortCost = inputRows * costLog2(inputRows) * COST_CPU_COMPARE;
+  if (inputRows * costEstimateRowBytes(pChild->pTargets) > COST_OPERATOR_BUFFER_BYTES) {
+    sortCost += inputRows * COST_SPILL_ROW;
+  }
+  double sortGroupCost = sortCost + inputRows * COST_CPU_ROW;
+
+  planDebug("group algo cost estimate, rows:%.0f groups:%.0f hash:%.2f sort:%.2f", inputRows, groups, hashCost,
+            sortGroupCost);
+  if (hashCost <= sortGroupCost) {
+    *pCost += hashCost;
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SSortLogicNode* pSort = NULL;
+  int32_t         code = costCreateGroupKeySort(pAgg, &pSort);
+  if (TSDB_CODE_SUCCESS == code) {
+    pSort->node.estRows = pChild->estRows;
+    pSort->node.estCost = pChild->estCost + sortCost;
+    pAgg->groupKeySorted = true;
+    *pCost += sortGroupCost;
+  }
+  return code;
+}
+
+static int32_t costEstimateNode(SLogicNode* pNode) {
+  double childRows = 0;
+  double childCost = 0;
+  SNode* pChild = NULL;
+  FOREACH(pChild, pNode->pChildren) {
+    childRows += ((SLogicNode*)pChild)->estRows;
+    childCost += ((SLogicNode*)pChild)->estCost;
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  double  rows = childRows;
+  double  cost = childCost;
+  switch (nodeType(pNode)) {
+    case QUERY_NODE_LOGIC_PLAN_SCAN:
+      costEstimateScan((SScanLogicNode*)pNode);
+      rows = pNode->estRows;
+      cost = pNode->estCost;
+      break;
+    case QUERY_NODE_LOGIC_PLAN_JOIN: {
+      SJoinLogicNode* pJoin = (SJoinLogicNode*)pNode;
+      double          leftRows = ((SLogicNode*)nodesListGetNode(pNode->pChildren, 0))->estRows;
+      double          rightRows = ((SLogicNode*)nodesListGetNode(pNode->pChildren, 1))->estRows;
+      if (JOIN_ALGO_HASH == pJoin->joinAlgo) {
+        // typically a fact table joined with a dimension table, each probe row matches about one build row
+        pJoin->buildLeft = (JOIN_TYPE_INNER == pJoin->joinType && leftRows > 0 && leftRows < rightRows);
+        double buildRows = pJoin->buildLeft ? leftRows : rightRows;
+        double probeRows = pJoin->buildLeft ? rightRows : leftRows;
+        rows = (JOIN_TYPE_LEFT == pJoin->joinType ? leftRows
+                                                  : probeRows * costEstimateSelectivity(pJoin->pOnConditions));
+        cost += buildRows * COST_CPU_ROW * 2 + probeRows * COST_CPU_ROW;
+      } else {
+        // merge join is an equi-join on the primary timestamp, so each row matches at most one row of the other side
+        rows = TMIN(leftRows, rightRows) * costEstimateSelectivity(pJoin->pOnConditions);
+        cost += childRows * COST_CPU_ROW;
+      }
+      break;
+    }
+    case QUERY_NODE_LOGIC_PLAN_AGG:
+      rows = costEstimateGroups(pNode, ((SAggLogicNode*)pNode)->pGroupKeys, childRows);
+      code = costChooseGroupAlgo((SAggLogicNode*)pNode, childRows, rows, &cost);
+      break;
+    case QUERY_NODE_LOGIC_PLAN_PARTITION:
+      cost += childRows * COST_CPU_ROW;
+      break;
+    case QUERY_NODE_LOGIC_PLAN_WINDOW:
+      rows = costEstimateWindows((SWindowLogicNode*)pNode, childRows);
+      cost += childRows * COST_CPU_ROW;
+      break;
+    case QUERY_NODE_LOGIC_PLAN_SORT:
+      cost += childRows * costLog2(childRows) * COST_CPU_COMPARE;
+      break;
+    case QUERY_NODE_LOGIC_PLAN_EXCHANGE:
+    case QUERY_NODE_LOGIC_PLAN_MERGE:
+      cost += childRows * COST_TRANSFER_ROW;
+      break;
+    case QUERY_NODE_LOGIC_PLAN_INTERP_FUNC: {
+      SInterpFuncLogicNode* pInterp = (SInterpFuncLogicNode*)pNode;
+      if (pInterp->interval > 0 && costIsTimeRangeBounded(&pInterp->timeRange)) {
+        rows = ((double)pInterp->timeRange.ekey - (double)pInterp->timeRange.skey) / pInterp->interval + 1;
+      }
+      cost += childRows * COST_CPU_ROW;
+      break;
+    }
+    default:
+      cost += childRows * COST_CPU_ROW;
+      break;
+  }
+
+  if (QUERY_NODE_LOGIC_PLAN_SCAN != nodeType(pNode) && NULL != pNode->pConditions) {
+    rows *= costEstimateSelectivity(pNode->pConditions);
+  }
+  rows = costApplyLimit(rows, pNode->pLimit);
+
+  pNode->estRows = TMAX(rows, 1.0);
+  pNode->estCost = cost;
+  return code;
+}
+
+static int32_t costEstimateLogicNode(SLogicNode* pNode) {
+  SNode* pChild = NULL;
+  FOREACH(pChild, pNode->pChildren) {
+    int32_t code = costEstimateLogicNode((SLogicNode*)pChild);
+    if (TSDB_CODE_SUCCESS != code) {
+      return code;
+    }
+  }
+  return costEstimateNode(pNode);
+}
+
+int32_t estimateLogicPlanCost(SLogicSubplan* pLogicSubplan) {
+  if (NULL == pLogicSubplan->pNode) {
+    return TSDB_CODE_SUCCESS;
+  }
+  int32_t code = costEstimateLogicNode(pLogicSubplan->pNode);
+  if (TSDB_CODE_SUCCESS != code) {
+    return code;
+  }
+  planDebug("estimated plan rows:%.0f, cost:%.2f", pLogicSubplan->pNode->estRows, pLogicSubplan->pNode->estCost);
+  return TSDB_CODE_SUCCESS;
+}
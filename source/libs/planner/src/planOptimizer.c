@@ -665,14 +665,77 @@ static bool pushDownCondOptContainPriKeyEqualCond(SJoinLogicNode* pJoin, SNode*
   }
 }
 
+static bool pushDownCondOptIsHashJoinKeyCond(SJoinLogicNode* pJoin, SNode* pCond) {
+  if (QUERY_NODE_OPERATOR != nodeType(pCond)) {
+    return false;
+  }
+
+  SOperatorNode* pOper = (SOperatorNode*)pCond;
+  if (OP_TYPE_EQUAL != pOper->opType || QUERY_NODE_COLUMN != nodeType(pOper->pLeft) ||
+      QUERY_NODE_COLUMN != nodeType(pOper->pRight)) {
+    return false;
+  }
+  // the hash join compares the raw key bytes, so both sides must have the same data type and width
+  SDataType* pLeftType = &((SColumnNode*)pOper->pLeft)->node.resType;
+  SDataType* pRightType = &((SColumnNode*)pOper->pRight)->node.resType;
+  if (pLeftType->type != pRightType->type || pLeftType->bytes != pRightType->bytes) {
+    return false;
+  }
+
+  SNodeList* pLeftCols = ((SLogicNode*)nodesListGetNode(pJoin->node.pChildren, 0))->pTargets;
+  SNodeList* pRightCols = ((SLogicNode*)nodesListGetNode(pJoin->node.pChildren, 1))->pTargets;
+  if (pushDownCondOptBelongThisTable(pOper->pLeft, pLeftCols)) {
+    return pushDownCondOptBelongThisTable(pOper->pRight, pRightCols);
+  } else if (pushDownCondOptBelongThisTable(pOper->pLeft, pRightCols)) {
+    return pushDownCondOptBelongThisTable(pOper->pRight, pLeftCols);
+  }
+  return false;
+}
+
+static bool pushDownCondOptContainHashJoinKeyCond(SJoinLogicNode* pJoin, SNode* pCond) {
+  if (QUERY_NODE_LOGIC_CONDITION == nodeType(pCond)) {
+    SLogicConditionNode* pLogicCond = (SLogicConditionNode*)pCond;
+    if (LOGIC_COND_TYPE_AND != pLogicCond->condType) {
+      return false;
+    }
+    SNode* pSubCond = NULL;
+    FOREACH(pSubCond, pLogicCond->pParameterList) {
+      if (pushDownCondOptIsHashJoinKeyCond(pJoin, pSubCond)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  return pushDownCondOptIsHashJoinKeyCond(pJoin, pCond);
+}
+
+static bool pushDownCondOptCanHashJoin(SJoinLogicNode* pJoin) {
+  // the hash join operator only implements inner joins
+  if (JOIN_TYPE_INNER != pJoin->joinType) {
+    return false;
+  }
+  // the output of hash join is unordered
+  if (NULL != pJoin->node.pParent && pJoin->node.pParent->requireDataOrder > DATA_ORDER_LEVEL_NONE) {
+    return false;
+  }
+  return pushDownCondOptContainHashJoinKeyCond(pJoin, pJoin->pOnConditions);
+}
+
 static int32_t pushDownCondOptCheckJoinOnCond(SOptimizeContext* pCxt, SJoinLogicNode* pJoin) {
   if (NULL == pJoin->pOnConditions) {
     return generateUsageErrMsg(pCxt->pPlanCxt->pMsg, pCxt->pPlanCxt->msgLen, TSDB_CODE_PLAN_NOT_SUPPORT_CROSS_JOIN);
   }
-  if (!pushDownCondOptContainPriKeyEqualCond(pJoin, pJoin->pOnConditions)) {
-    return generateUsageErrMsg(pCxt->pPlanCxt->pMsg, pCxt->pPlanCxt->msgLen, TSDB_CODE_PLAN_EXPECTED_TS_EQUAL);
+  if (JOIN_TYPE_INNER == pJoin->joinType && pushDownCondOptContainPriKeyEqualCond(pJoin, pJoin->pOnConditions)) {
+    pJoin->joinAlgo = JOIN_ALGO_MERGE;
+    return TSDB_CODE_SUCCESS;
   }
-  return TSDB_CODE_SUCCESS;
+  if (pushDownCondOptCanHashJoin(pJoin)) {
+    pJoin->joinAlgo = JOIN_ALGO_HASH;
+    pJoin->node.requireDataOrder = DATA_ORDER_LEVEL_NONE;
+    pJoin->node.resultDataOrder = DATA_ORDER_LEVEL_NONE;
+    return TSDB_CODE_SUCCESS;
+  }
+  return generateUsageErrMsg(pCxt->pPlanCxt->pMsg, pCxt->pPlanCxt->msgLen, TSDB_CODE_PLAN_EXPECTED_TS_EQUAL);
 }
 
 static int32_t pushDownCondOptPartJoinOnCondLogicCond(SJoinLogicNode* pJoin, SNode** ppMergeCond, SNode** ppOnCond) {
@@ -723,12 +786,60 @@ static int32_t pushDownCondOptPartJoinOnCond(SJoinLogicNode* pJoin, SNode** ppMe
   }
 }
 
+static int32_t pushDownCondOptPartHashJoinOnCond(SJoinLogicNode* pJoin, SNode** ppKeyCond, SNode** ppOnCond) {
+  int32_t    code = TSDB_CODE_SUCCESS;
+  SNodeList* pKeyConds = NULL;
+  SNodeList* pOnConds = NULL;
+  if (QUERY_NODE_LOGIC_CONDITION == nodeType(pJoin->pOnConditions)) {
+    SNode* pCond = NULL;
+    FOREACH(pCond, ((SLogicConditionNode*)pJoin->pOnConditions)->pParameterList) {
+      if (pushDownCondOptIsHashJoinKeyCond(pJoin, pCond)) {
+        code = nodesListMakeAppend(&pKeyConds, nodesCloneNode(pCond));
+      } else {
+        code = nodesListMakeAppend(&pOnConds, nodesCloneNode(pCond));
+      }
+      if (TSDB_CODE_SUCCESS != code) {
+        break;
+      }
+    }
+  } else {
+    code = nodesListMakeAppend(&pKeyConds, nodesCloneNode(pJoin->pOnConditions));
+  }
+
+  SNode* pTempKeyCond = NULL;
+  SNode* pTempOnCond = NULL;
+  if (TSDB_CODE_SUCCESS == code) {
+    code = nodesMergeConds(&pTempKeyCond, &pKeyConds);
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    code = nodesMergeConds(&pTempOnCond, &pOnConds);
+  }
+
+  if (TSDB_CODE_SUCCESS == code && NULL != pTempKeyCond) {
+    *ppKeyCond = pTempKeyCond;
+    *ppOnCond = pTempOnCond;
+    nodesDestroyNode(pJoin->pOnConditions);
+    pJoin->pOnConditions = NULL;
+    return TSDB_CODE_SUCCESS;
+  } else {
+    nodesDestroyList(pKeyConds);
+    nodesDestroyList(pOnConds);
+    nodesDestroyNode(pTempKeyCond);
+    nodesDestroyNode(pTempOnCond);
+    return TSDB_CODE_SUCCESS == code ? TSDB_CODE_PLAN_INTERNAL_ERROR : code;
+  }
+}
+
 static int32_t pushDownCondOptJoinExtractMergeCond(SOptimizeContext* pCxt, SJoinLogicNode* pJoin) {
   int32_t code = pushDownCondOptCheckJoinOnCond(pCxt, pJoin);
   SNode*  pJoinMergeCond = NULL;
   SNode*  pJoinOnCond = NULL;
   if (TSDB_CODE_SUCCESS == code) {
-    code = pushDownCondOptPartJoinOnCond(pJoin, &pJoinMergeCond, &pJoinOnCond);
+    if (JOIN_ALGO_HASH == pJoin->joinAlgo) {
+      code = pushDownCondOptPartHashJoinOnCond(pJoin, &pJoinMergeCond, &pJoinOnCond);
+    } else {
+      code = pushDownCondOptPartJoinOnCond(pJoin, &pJoinMergeCond, &pJoinOnCond);
+    }
   }
   if (TSDB_CODE_SUCCESS == code) {
     pJoin->pMergeCondition = pJoinMergeCond;
@@ -1094,6 +1205,10 @@ static int32_t sortPriKeyOptGetSequencingNodesImpl(SLogicNode* pNode, bool group
       return nodesListMakeAppend(pSequencingNodes, (SNode*)pNode);
     }
     case QUERY_NODE_LOGIC_PLAN_JOIN: {
+      if (JOIN_ALGO_HASH == ((SJoinLogicNode*)pNode)->joinAlgo) {
+        *pNotOptimize = true;
+        return TSDB_CODE_SUCCESS;
+      }
       int32_t code = sortPriKeyOptGetSequencingNodesImpl((SLogicNode*)nodesListGetNode(pNode->pChildren, 0), groupSort,
                                                          pNotOptimize, pSequencingNodes);
       if (TSDB_CODE_SUCCESS == code) {
@@ -2767,5 +2882,9 @@ int32_t optimizeLogicPlan(SPlanContext* pCxt, SLogicSubplan* pLogicSubplan) {
   if (SUBPLAN_TYPE_MODIFY == pLogicSubplan->subplanType && NULL == pLogicSubplan->pNode->pChildren) {
     return TSDB_CODE_SUCCESS;
   }
-  return applyOptimizeRule(pCxt, pLogicSubplan);
+  int32_t code = applyOptimizeRule(pCxt, pLogicSubplan);
+  if (TSDB_CODE_SUCCESS == code) {
+    code = estimateLogicPlanCost(pLogicSubplan);
+  }
+  return code;
 }
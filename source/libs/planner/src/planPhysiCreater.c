@@ -373,6 +373,8 @@ static SPhysiNode* makePhysiNode(SPhysiPlanContext* pCxt, SLogicNode* pLogicNode
     return NULL;
   }
   pPhysiNode->pOutputDataBlockDesc->precision = pLogicNode->precision;
+  pPhysiNode->estRows = pLogicNode->estRows;
+  pPhysiNode->estCost = pLogicNode->estCost;
   return pPhysiNode;
 }
 
@@ -663,8 +665,104 @@ static int32_t createScanPhysiNode(SPhysiPlanContext* pCxt, SSubplan* pSubplan,
   return TSDB_CODE_FAILED;
 }
 
-static int32_t createJoinPhysiNode(SPhysiPlanContext* pCxt, SNodeList* pChildren, SJoinLogicNode* pJoinLogicNode,
-                                   SPhysiNode** pPhyNode) {
+static int32_t createJoinOnCondSlots(SPhysiPlanContext* pCxt, SNode* pOnConditions, SPhysiNode* pJoin,
+                                     SNode** pOutput) {
+  if (NULL == pOnConditions) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SNodeList* pCondCols = nodesMakeList();
+  int32_t    code = TSDB_CODE_SUCCESS;
+  if (NULL == pCondCols) {
+    code = TSDB_CODE_OUT_OF_MEMORY;
+  } else {
+    code = nodesCollectColumnsFromNode(pOnConditions, NULL, COLLECT_COL_TYPE_ALL, &pCondCols);
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    code = addDataBlockSlots(pCxt, pCondCols, pJoin->pOutputDataBlockDesc);
+  }
+  nodesDestroyList(pCondCols);
+
+  if (TSDB_CODE_SUCCESS == code) {
+    code = setNodeSlotId(pCxt, pJoin->pOutputDataBlockDesc->dataBlockId, -1, pOnConditions, pOutput);
+  }
+  return code;
+}
+
+static int32_t createHashJoinKey(SDataBlockDescNode* pLeftDesc, SNode* pCond, SHashJoinPhysiNode* pJoin) {
+  SOperatorNode* pOper = (SOperatorNode*)pCond;
+  SNode*         pLeftKey = pOper->pLeft;
+  SNode*         pRightKey = pOper->pRight;
+  if (((SColumnNode*)pLeftKey)->dataBlockId != pLeftDesc->dataBlockId) {
+    TSWAP(pLeftKey, pRightKey);
+  }
+  int32_t code = nodesListMakeStrictAppend(&pJoin->pLeftKeys, nodesCloneNode(pLeftKey));
+  if (TSDB_CODE_SUCCESS == code) {
+    code = nodesListMakeStrictAppend(&pJoin->pRightKeys, nodesCloneNode(pRightKey));
+  }
+  return code;
+}
+
+static int32_t createHashJoinKeys(SPhysiPlanContext* pCxt, SDataBlockDescNode* pLeftDesc,
+                                  SDataBlockDescNode* pRightDesc, SNode* pKeyCond, SHashJoinPhysiNode* pJoin) {
+  SNode*  pCond = NULL;
+  int32_t code = setNodeSlotId(pCxt, pLeftDesc->dataBlockId, pRightDesc->dataBlockId, pKeyCond, &pCond);
+  if (TSDB_CODE_SUCCESS == code) {
+    if (QUERY_NODE_LOGIC_CONDITION == nodeType(pCond)) {
+      SNode* pSubCond = NULL;
+      FOREACH(pSubCond, ((SLogicConditionNode*)pCond)->pParameterList) {
+        code = createHashJoinKey(pLeftDesc, pSubCond, pJoin);
+        if (TSDB_CODE_SUCCESS != code) {
+          break;
+        }
+      }
+    } else {
+      code = createHashJoinKey(pLeftDesc, pCond, pJoin);
+    }
+  }
+  nodesDestroyNode(pCond);
+  return code;
+}
+
+static int32_t createHashJoinPhysiNode(SPhysiPlanContext* pCxt, SNodeList* pChildren, SJoinLogicNode* pJoinLogicNode,
+                                       SPhysiNode** pPhyNode) {
+  SHashJoinPhysiNode* pJoin =
+      (SHashJoinPhysiNode*)makePhysiNode(pCxt, (SLogicNode*)pJoinLogicNode, QUERY_NODE_PHYSICAL_PLAN_HASH_JOIN);
+  if (NULL == pJoin) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  SDataBlockDescNode* pLeftDesc = ((SPhysiNode*)nodesListGetNode(pChildren, 0))->pOutputDataBlockDesc;
+  SDataBlockDescNode* pRightDesc = ((SPhysiNode*)nodesListGetNode(pChildren, 1))->pOutputDataBlockDesc;
+
+  pJoin->joinType = pJoinLogicNode->joinType;
+  pJoin->buildLeft = pJoinLogicNode->buildLeft;
+  int32_t code = createHashJoinKeys(pCxt, pLeftDesc, pRightDesc, pJoinLogicNode->pMergeCondition, pJoin);
+  if (TSDB_CODE_SUCCESS == code) {
+    code = setListSlotId(pCxt, pLeftDesc->dataBlockId, pRightDesc->dataBlockId, pJoinLogicNode->node.pTargets,
+                         &pJoin->pTargets);
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    code = addDataBlockSlots(pCxt, pJoin->pTargets, pJoin->node.pOutputDataBlockDesc);
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    code = createJoinOnCondSlots(pCxt, pJoinLogicNode->pOnConditions, (SPhysiNode*)pJoin, &pJoin->pOnConditions);
+  }
+  if (TSDB_CODE_SUCCESS == code) {
+    code = setConditionsSlotId(pCxt, (const SLogicNode*)pJoinLogicNode, (SPhysiNode*)pJoin);
+  }
+
+  if (TSDB_CODE_SUCCESS == code) {
+    *pPhyNode = (SPhysiNode*)pJoin;
+  } else {
+    nodesDestroyNode((SNode*)pJoin);
+  }
+
+  return code;
+}
+
+static int32_t createMergeJoinPhysiNode(SPhysiPlanContext* pCxt, SNodeList* pChildren, SJoinLogicNode* pJoinLogicNode,
+                                        SPhysiNode** pPhyNode) {
   SSortMergeJoinPhysiNode* pJoin =
       (SSortMergeJoinPhysiNode*)makePhysiNode(pCxt, (SLogicNode*)pJoinLogicNode, QUERY_NODE_PHYSICAL_PLAN_MERGE_JOIN);
   if (NULL == pJoin) {
@@ -687,22 +785,8 @@ static int32_t createJoinPhysiNode(SPhysiPlanContext* pCxt, SNodeList* pChildren
     code = addDataBlockSlots(pCxt, pJoin->pTargets, pJoin->node.pOutputDataBlockDesc);
   }
 
-  if (TSDB_CODE_SUCCESS == code && NULL != pJoinLogicNode->pOnConditions) {
-    SNodeList* pCondCols = nodesMakeList();
-    if (NULL == pCondCols) {
-      code = TSDB_CODE_OUT_OF_MEMORY;
-    } else {
-      code = nodesCollectColumnsFromNode(pJoinLogicNode->pOnConditions, NULL, COLLECT_COL_TYPE_ALL, &pCondCols);
-    }
-    if (TSDB_CODE_SUCCESS == code) {
-      code = addDataBlockSlots(pCxt, pCondCols, pJoin->node.pOutputDataBlockDesc);
-    }
-    nodesDestroyList(pCondCols);
-  }
-
-  if (TSDB_CODE_SUCCESS == code && NULL != pJoinLogicNode->pOnConditions) {
-    code = setNodeSlotId(pCxt, ((SPhysiNode*)pJoin)->pOutputDataBlockDesc->dataBlockId, -1,
-                         pJoinLogicNode->pOnConditions, &pJoin->pOnConditions);
+  if (TSDB_CODE_SUCCESS == code) {
+    code = createJoinOnCondSlots(pCxt, pJoinLogicNode->pOnConditions, (SPhysiNode*)pJoin, &pJoin->pOnConditions);
   }
 
   if (TSDB_CODE_SUCCESS == code) {
@@ -718,6 +802,14 @@ static int32_t createJoinPhysiNode(SPhysiPlanContext* pCxt, SNodeList* pChildren
   return code;
 }
 
+static int32_t createJoinPhysiNode(SPhysiPlanContext* pCxt, SNodeList* pChildren, SJoinLogicNode* pJoinLogicNode,
+                                   SPhysiNode** pPhyNode) {
+  if (JOIN_ALGO_HASH == pJoinLogicNode->joinAlgo) {
+    return createHashJoinPhysiNode(pCxt, pChildren, pJoinLogicNode, pPhyNode);
+  }
+  return createMergeJoinPhysiNode(pCxt, pChildren, pJoinLogicNode, pPhyNode);
+}
+
 typedef struct SRewritePrecalcExprsCxt {
   int32_t    errCode;
   int32_t    planNodeId;
@@ -875,6 +967,7 @@ static int32_t createAggPhysiNode(SPhysiPlanContext* pCxt, SNodeList* pChildren,
 
   pAgg->mergeDataBlock = (GROUP_ACTION_KEEP == pAggLogicNode->node.groupAction ? false : true);
   pAgg->groupKeyOptimized = pAggLogicNode->hasGroupKeyOptimized;
+  pAgg->groupKeySorted = pAggLogicNode->groupKeySorted;
 
   SNodeList* pPrecalcExprs = NULL;
   SNodeList* pGroupKeys = NULL;
@@ -99,6 +99,12 @@ static SLogicSubplan* splCreateSubplan(SSplitContext* pCxt, SLogicNode* pNode) {
   return pSubplan;
 }
 
+// the estimates are made before splitting, the node receiving the data of a split subplan reports what it receives
+static void splInheritEstimate(SLogicNode* pNode, SLogicNode* pSrc) {
+  pNode->estRows = pSrc->estRows;
+  pNode->estCost = pSrc->estCost;
+}
+
 static int32_t splCreateExchangeNode(SSplitContext* pCxt, SLogicNode* pChild, SExchangeLogicNode** pOutput) {
   SExchangeLogicNode* pExchange = (SExchangeLogicNode*)nodesMakeNode(QUERY_NODE_LOGIC_PLAN_EXCHANGE);
   if (NULL == pExchange) {
@@ -108,6 +114,7 @@ static int32_t splCreateExchangeNode(SSplitContext* pCxt, SLogicNode* pChild, SE
   pExchange->srcStartGroupId = pCxt->groupId;
   pExchange->srcEndGroupId = pCxt->groupId;
   pExchange->node.precision = pChild->precision;
+  splInheritEstimate((SLogicNode*)pExchange, pChild);
   pExchange->node.pTargets = nodesCloneList(pChild->pTargets);
   if (NULL == pExchange->node.pTargets) {
     return TSDB_CODE_OUT_OF_MEMORY;
@@ -541,6 +548,7 @@ static int32_t stbSplCreateMergeNode(SSplitContext* pCxt, SLogicSubplan* pSubpla
   pMerge->numOfChannels = stbSplGetNumOfVgroups(pPartChild);
   pMerge->srcGroupId = pCxt->groupId;
   pMerge->node.precision = pPartChild->precision;
+  splInheritEstimate((SLogicNode*)pMerge, pPartChild);
   pMerge->pMergeKeys = pMergeKeys;
   pMerge->groupSort = groupSort;
 
@@ -1364,6 +1372,7 @@ static int32_t unAllSplCreateExchangeNode(SSplitContext* pCxt, int32_t startGrou
   pExchange->srcStartGroupId = startGroupId;
   pExchange->srcEndGroupId = pCxt->groupId - 1;
   pExchange->node.precision = pProject->node.precision;
+  splInheritEstimate((SLogicNode*)pExchange, (SLogicNode*)pProject);
   pExchange->node.pTargets = nodesCloneList(pProject->node.pTargets);
   if (NULL == pExchange->node.pTargets) {
     return TSDB_CODE_OUT_OF_MEMORY;
@@ -1419,6 +1428,7 @@ static int32_t unDistSplCreateExchangeNode(SSplitContext* pCxt, int32_t startGro
   pExchange->srcStartGroupId = startGroupId;
   pExchange->srcEndGroupId = pCxt->groupId - 1;
   pExchange->node.precision = pAgg->node.precision;
+  splInheritEstimate((SLogicNode*)pExchange, (SLogicNode*)pAgg);
   pExchange->node.pTargets = nodesCloneList(pAgg->pGroupKeys);
   if (NULL == pExchange->node.pTargets) {
     return TSDB_CODE_OUT_OF_MEMORY;
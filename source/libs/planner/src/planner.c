@@ -150,4 +150,157 @@ SQueryPlan* qStringToQueryPlan(const char* pStr) {
   return pPlan;
 }
 
+static int32_t collectSubplans(const SQueryPlan* pPlan, SArray** pSubplans) {
+  *pSubplans = taosArrayInit(pPlan->numOfSubplans, POINTER_BYTES);
+  if (NULL == *pSubplans) {
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+  SNode* pGroup = NULL;
+  FOREACH(pGroup, pPlan->pSubplans) {
+    SNode* pSubplan = NULL;
+    FOREACH(pSubplan, ((SNodeListNode*)pGroup)->pNodeList) { taosArrayPush(*pSubplans, &pSubplan); }
+  }
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t findSubplan(SArray* pSubplans, SNode* pSubplan) {
+  int32_t num = taosArrayGetSize(pSubplans);
+  for (int32_t i = 0; i < num; ++i) {
+    if (pSubplan == taosArrayGetP(pSubplans, i)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static int32_t cloneSubplanLinks(SNodeList* pSrcLinks, SArray* pSrcSubplans, SArray* pDstSubplans,
+                                 SNodeList** pDstLinks) {
+  int32_t code = TSDB_CODE_SUCCESS;
+  SNode*  pLink = NULL;
+  FOREACH(pLink, pSrcLinks) {
+    int32_t index = findSubplan(pSrcSubplans, pLink);
+    if (index < 0) {
+      return TSDB_CODE_PLAN_INTERNAL_ERROR;
+    }
+    code = nodesListMakeAppend(pDstLinks, taosArrayGetP(pDstSubplans, index));
+    if (TSDB_CODE_SUCCESS != code) {
+      break;
+    }
+  }
+  return code;
+}
+
+// The message codec does not carry the links between subplans, so they are rebuilt by position after decoding.
+static int32_t cloneQueryPlanLinks(const SQueryPlan* pSrc, SQueryPlan* pDst) {
+  SArray* pSrcSubplans = NULL;
+  SArray* pDstSubplans = NULL;
+  int32_t code = collectSubplans(pSrc, &pSrcSubplans);
+  if (TSDB_CODE_SUCCESS == code) {
+    code = collectSubplans(pDst, &pDstSubplans);
+  }
+  if (TSDB_CODE_SUCCESS == code && taosArrayGetSize(pSrcSubplans) != taosArrayGetSize(pDstSubplans)) {
+    code = TSDB_CODE_PLAN_INTERNAL_ERROR;
+  }
+  int32_t num = taosArrayGetSize(pSrcSubplans);
+  for (int32_t i = 0; TSDB_CODE_SUCCESS == code && i < num; ++i) {
+    SSubplan* pSrcSubplan = taosArrayGetP(pSrcSubplans, i);
+    SSubplan* pDstSubplan = taosArrayGetP(pDstSubplans, i);
+    pDstSubplan->id.queryId = pDst->queryId;
+    pDstSubplan->execNodeStat = pSrcSubplan->execNodeStat;
+    code = cloneSubplanLinks(pSrcSubplan->pChildren, pSrcSubplans, pDstSubplans, &pDstSubplan->pChildren);
+    if (TSDB_CODE_SUCCESS == code) {
+      code = cloneSubplanLinks(pSrcSubplan->pParents, pSrcSubplans, pDstSubplans, &pDstSubplan->pParents);
+    }
+  }
+  taosArrayDestroy(pSrcSubplans);
+  taosArrayDestroy(pDstSubplans);
+  return code;
+}
+
+int32_t qCloneQueryPlan(const SQueryPlan* pSrc, uint64_t queryId, SQueryPlan** pDst) {
+  *pDst = NULL;
+  char*   pMsg = NULL;
+  int32_t len = 0;
+  int32_t code = nodesNodeToMsg((const SNode*)pSrc, &pMsg, &len);
+  if (TSDB_CODE_SUCCESS == code) {
+    code = nodesMsgToNode(pMsg, len, (SNode**)pDst);
+  }
+  taosMemoryFree(pMsg);
+  if (TSDB_CODE_SUCCESS == code) {
+    (*pDst)->queryId = queryId;
+    (*pDst)->explainInfo = pSrc->explainInfo;
+    code = cloneQueryPlanLinks(pSrc, *pDst);
+  }
+  if (TSDB_CODE_SUCCESS != code) {
+    nodesDestroyNode((SNode*)*pDst);
+    *pDst = NULL;
+  }
+  return code;
+}
+
+static bool isScanRangeRebindable(const SPhysiNode* pNode, const STimeWindow* pRange, int32_t* pNumOfScans) {
+  switch (nodeType(pNode)) {
+    case QUERY_NODE_PHYSICAL_PLAN_TABLE_SCAN:
+    case QUERY_NODE_PHYSICAL_PLAN_TABLE_MERGE_SCAN: {
+      const STimeWindow* pScanRange = &((const STableScanPhysiNode*)pNode)->scanRange;
+      if (pScanRange->skey != pRange->skey || pScanRange->ekey != pRange->ekey) {
+        return false;
+      }
+      ++(*pNumOfScans);
+      break;
+    }
+    case QUERY_NODE_PHYSICAL_PLAN_TAG_SCAN:
+    case QUERY_NODE_PHYSICAL_PLAN_TABLE_SEQ_SCAN:
+    case QUERY_NODE_PHYSICAL_PLAN_STREAM_SCAN:
+    case QUERY_NODE_PHYSICAL_PLAN_SYSTABLE_SCAN:
+    case QUERY_NODE_PHYSICAL_PLAN_BLOCK_DIST_SCAN:
+    case QUERY_NODE_PHYSICAL_PLAN_LAST_ROW_SCAN:
+    case QUERY_NODE_PHYSICAL_PLAN_TABLE_COUNT_SCAN:
+    case QUERY_NODE_PHYSICAL_PLAN_FILL:
+    case QUERY_NODE_PHYSICAL_PLAN_INTERP_FUNC:
+      return false;
+    default:
+      break;
+  }
+
+  SNode* pChild = NULL;
+  FOREACH(pChild, pNode->pChildren) {
+    if (!isScanRangeRebindable((const SPhysiNode*)pChild, pRange, pNumOfScans)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool qIsScanRangeRebindable(const SQueryPlan* pPlan, const STimeWindow* pRange) {
+  int32_t numOfScans = 0;
+  SNode*  pGroup = NULL;
+  FOREACH(pGroup, pPlan->pSubplans) {
+    SNode* pSubplan = NULL;
+    FOREACH(pSubplan, ((SNodeListNode*)pGroup)->pNodeList) {
+      if (!isScanRangeRebindable(((SSubplan*)pSubplan)->pNode, pRange, &numOfScans)) {
+        return false;
+      }
+    }
+  }
+  return numOfScans > 0;
+}
+
+static void setScanRange(SPhysiNode* pNode, const STimeWindow* pRange) {
+  if (QUERY_NODE_PHYSICAL_PLAN_TABLE_SCAN == nodeType(pNode) ||
+      QUERY_NODE_PHYSICAL_PLAN_TABLE_MERGE_SCAN == nodeType(pNode)) {
+    ((STableScanPhysiNode*)pNode)->scanRange = *pRange;
+  }
+  SNode* pChild = NULL;
+  FOREACH(pChild, pNode->pChildren) { setScanRange((SPhysiNode*)pChild, pRange); }
+}
+
+void qSetScanRange(SQueryPlan* pPlan, const STimeWindow* pRange) {
+  SNode* pGroup = NULL;
+  FOREACH(pGroup, pPlan->pSubplans) {
+    SNode* pSubplan = NULL;
+    FOREACH(pSubplan, ((SNodeListNode*)pGroup)->pNodeList) { setScanRange(((SSubplan*)pSubplan)->pNode, pRange); }
+  }
+}
+
 void qDestroyQueryPlan(SQueryPlan* pPlan) { nodesDestroyNode((SNode*)pPlan); }
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "planTestUtil.h"
+#include "parser.h"
+#include "planner.h"
+
+using namespace std;
+
+namespace {
+
+// The client plan cache keys a statement by its normalized text and rebinds the time range into a copy of the plan
+// built for an earlier statement of the same text. These cases check that the copy equals the plan of the new
+// statement as far as the time range goes.
+class PlanCacheTest : public testing::Test {
+ protected:
+  void TearDown() override {
+    for (auto pParams : params_) {
+      qDestroyCacheableParams(pParams);
+    }
+    for (auto pQuery : queries_) {
+      qDestroyQuery(pQuery);
+    }
+    for (auto pPlan : plans_) {
+      qDestroyQueryPlan(pPlan);
+    }
+    for (auto pNode : conds_) {
+      nodesDestroyNode(pNode);
+    }
+  }
+
+  string normalize(const string& sql, SArray** ppParams) {
+    *ppParams = taosArrayInit(TARRAY_MIN_SIZE, sizeof(SCacheableParam));
+    params_.push_back(*ppParams);
+    char*   pNormalized = nullptr;
+    int32_t len = 0;
+    if (!qNormalizeCacheableSql(sql.c_str(), sql.length(), false, &pNormalized, &len, *ppParams)) {
+      return "<not cacheable>";
+    }
+    string key(pNormalized, len);
+    taosMemoryFree(pNormalized);
+    return key;
+  }
+
+  SQuery* parse(const string& sql) {
+    SParseContext cxt = {0};
+    cxt.acctId = 0;
+    cxt.db = "test";
+    cxt.pSql = sql.c_str();
+    cxt.sqlLen = sql.length();
+    cxt.pMsg = msgBuf_;
+    cxt.msgLen = sizeof(msgBuf_);
+    cxt.svrVer = "3.0.0.0";
+    cxt.enableSysInfo = true;
+    SQuery* pQuery = nullptr;
+    int32_t code = qParseSql(&cxt, &pQuery);
+    EXPECT_EQ(code, TSDB_CODE_SUCCESS) << msgBuf_;
+    queries_.push_back(pQuery);
+    return pQuery;
+  }
+
+  SQueryPlan* createPlan(SQuery* pQuery) {
+    SPlanContext cxt = {0};
+    cxt.queryId = 1;
+    cxt.pAstRoot = pQuery->pRoot;
+    cxt.pUser = "root";
+    cxt.sysInfo = true;
+    cxt.pMsg = msgBuf_;
+    cxt.msgLen = sizeof(msgBuf_);
+    SArray*     pExecNodeList = taosArrayInit(TARRAY_MIN_SIZE, sizeof(SQueryNodeLoad));
+    SQueryPlan* pPlan = nullptr;
+    int32_t     code = qCreateQueryPlan(&cxt, &pPlan, pExecNodeList);
+    EXPECT_EQ(code, TSDB_CODE_SUCCESS) << msgBuf_;
+    taosArrayDestroy(pExecNodeList);
+    plans_.push_back(pPlan);
+    return pPlan;
+  }
+
+  SNode* buildTimeRange(SQuery* pQuery, const SArray* pParams, bool* pRebindable, STimeWindow* pRange) {
+    SNode*  pCond = nullptr;
+    int32_t code = qBuildCacheableTimeRange(pQuery, pParams, pRebindable, &pCond, pRange);
+    EXPECT_EQ(code, TSDB_CODE_SUCCESS);
+    conds_.push_back(pCond);
+    return pCond;
+  }
+
+  // Plans sql1, rebinds its plan with the params of sql2 and checks that against the plan of sql2.
+  void checkRebind(const string& sql1, const string& sql2) {
+    SArray* pParams1 = nullptr;
+    SArray* pParams2 = nullptr;
+    ASSERT_EQ(normalize(sql1, &pParams1), normalize(sql2, &pParams2));
+
+    SQuery*     pQuery1 = parse(sql1);
+    SQueryPlan* pPlan1 = createPlan(pQuery1);
+    bool        rebindable[8] = {0};
+    STimeWindow range1 = {0};
+    SNode*      pCond = buildTimeRange(pQuery1, pParams1, rebindable, &range1);
+    ASSERT_NE(pCond, nullptr);
+    ASSERT_TRUE(qIsScanRangeRebindable(pPlan1, &range1));
+
+    STimeWindow range2 = {0};
+    ASSERT_EQ(qRebindCacheableTimeRange(pCond, pParams2, &range2), TSDB_CODE_SUCCESS);
+    ASSERT_NE(range1.skey, range2.skey);
+
+    SQueryPlan* pCopy = nullptr;
+    ASSERT_EQ(qCloneQueryPlan(pPlan1, 2, &pCopy), TSDB_CODE_SUCCESS);
+    plans_.push_back(pCopy);
+    qSetScanRange(pCopy, &range2);
+
+    SQueryPlan* pPlan2 = createPlan(parse(sql2));
+    ASSERT_TRUE(qIsScanRangeRebindable(pPlan2, &range2));
+    ASSERT_TRUE(qIsScanRangeRebindable(pCopy, &range2));
+    ASSERT_EQ(pCopy->numOfSubplans, pPlan2->numOfSubplans);
+  }
+
+  char            msgBuf_[1024] = {0};
+  vector<SArray*> params_;
+  vector<SQuery*> queries_;
+  vector<SQueryPlan*> plans_;
+  vector<SNode*>  conds_;
+};
+
+}  // namespace
+
+TEST_F(PlanCacheTest, hitAcrossTimeRanges) {
+  checkRebind("select count(*) from t1 where ts >= '2022-04-01 00:00:00' and ts < '2022-04-02 00:00:00' and c1 > 10",
+              "select count(*) from t1 where ts >= '2022-05-01 00:00:00' and ts < '2022-05-03 00:00:00' and c1 > 10");
+
+  checkRebind("select _wstart, avg(c1) from st1 where ts between 1648742400000 and 1648828799999 interval(10m)",
+              "select _wstart, avg(c1) from st1 where ts between 1651334400000 and 1651507199999 interval(10m)");
+
+  checkRebind("select c1 from st1 where tag1 = 1 and ts > '2022-04-01 00:00:00' order by ts limit 10",
+              "select c1 from st1 where tag1 = 1 and ts > '2022-06-01 00:00:00' order by ts limit 10");
+}
+
+TEST_F(PlanCacheTest, onlyTimeRangeRebound) {
+  SArray*     pParams = nullptr;
+  string      sql = "select count(*) from t1 where ts >= '2022-04-01 00:00:00' and ts < '2022-04-02 00:00:00' and c1 > 10";
+  ASSERT_EQ(normalize(sql, &pParams), "select count ( * ) from t1 where ts >= ? and ts < ? and c1 > ?");
+  ASSERT_EQ(taosArrayGetSize(pParams), 3);
+
+  bool        rebindable[3] = {0};
+  STimeWindow range = {0};
+  ASSERT_NE(buildTimeRange(parse(sql), pParams, rebindable, &range), nullptr);
+  ASSERT_TRUE(rebindable[0]);
+  ASSERT_TRUE(rebindable[1]);
+  ASSERT_FALSE(rebindable[2]);
+  ASSERT_EQ(range.ekey - range.skey + 1, 86400000);
+}
+
+TEST_F(PlanCacheTest, emptyRangeNotRebound) {
+  SArray*     pParams1 = nullptr;
+  SArray*     pParams2 = nullptr;
+  string      sql1 = "select c1 from t1 where ts >= '2022-04-01 00:00:00' and ts < '2022-04-02 00:00:00'";
+  string      sql2 = "select c1 from t1 where ts >= '2022-04-02 00:00:00' and ts < '2022-04-01 00:00:00'";
+  ASSERT_EQ(normalize(sql1, &pParams1), normalize(sql2, &pParams2));
+
+  bool        rebindable[2] = {0};
+  STimeWindow range = {0};
+  SNode*      pCond = buildTimeRange(parse(sql1), pParams1, rebindable, &range);
+  ASSERT_NE(pCond, nullptr);
+  ASSERT_NE(qRebindCacheableTimeRange(pCond, pParams2, &range), TSDB_CODE_SUCCESS);
+}
+
+TEST_F(PlanCacheTest, timeRangeNotRebindable) {
+  auto check = [this](const string& sql) {
+    SArray*     pParams = nullptr;
+    normalize(sql, &pParams);
+    bool        rebindable[8] = {0};
+    STimeWindow range = {0};
+    ASSERT_EQ(buildTimeRange(parse(sql), pParams, rebindable, &range), nullptr) << sql;
+    for (int32_t i = 0; i < taosArrayGetSize(pParams); ++i) {
+      ASSERT_FALSE(rebindable[i]) << sql;
+    }
+  };
+
+  // fill derives its range from the where clause
+  check(
+      "select _wstart, count(*) from t1 where ts >= '2022-04-01 00:00:00' and ts < '2022-04-02 00:00:00' "
+      "interval(1h) fill(null)");
+  // the condition is not strict, it stays in the scan conditions
+  check("select c1 from t1 where ts >= '2022-04-01 00:00:00' or c1 > 10");
+  // the same text is written twice
+  check("select c1 from t1 where ts >= '2022-04-01 00:00:00' and c2 = '2022-04-01 00:00:00'");
+  check("select c1 from t1 where c1 > 10");
+}
@@ -83,3 +83,12 @@ TEST_F(PlanGroupByTest, selectFunc) {
   run("SELECT MAX(c1), c2 FROM t1 GROUP BY c3");
   run("SELECT MAX(c1), t1.* FROM t1 GROUP BY c3");
 }
+
+TEST_F(PlanGroupByTest, groupAlgo) {
+  useDb("root", "test");
+
+  // a single vgroup scan may be grouped by sorting on the group keys, depending on the estimated groups
+  run("SELECT c1, c2, COUNT(*) FROM st1s1 GROUP BY c1, c2");
+
+  run("SELECT c1, SUM(c3) FROM t1 GROUP BY c1 ORDER BY c1");
+}
@@ -74,6 +74,16 @@ TEST_F(PlanOtherTest, explain) {
   run("explain analyze verbose true ratio 0.01 SELECT * FROM t1");
 }
 
+TEST_F(PlanOtherTest, explainVerboseEstimate) {
+  useDb("root", "test");
+
+  run("explain verbose true SELECT * FROM st1 WHERE tag1 = 1 AND c1 > 10");
+
+  run("explain verbose true SELECT COUNT(*) FROM st1 WHERE ts > now - 1h PARTITION BY tbname");
+
+  run("explain verbose true SELECT * FROM st1s1 t1, st1s2 t2 WHERE t1.ts = t2.ts LIMIT 10");
+}
+
 TEST_F(PlanOtherTest, show) {
   useDb("root", "test");
 
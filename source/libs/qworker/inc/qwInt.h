@@ -124,14 +124,17 @@ typedef struct SQWTaskCtx {
   int32_t  level;
   uint64_t sId;
 
-  bool    queryGotData;
-  bool    queryRsped;
-  bool    queryEnd;
-  bool    queryContinue;
-  bool    queryExecDone;
-  bool    queryInQueue;
-  int32_t rspCode;
-  int64_t affectedRows;  // for insert ...select stmt
+  bool     queryGotData;
+  bool     queryRsped;
+  bool     queryEnd;
+  bool     queryContinue;
+  bool     queryExecDone;
+  bool     queryInQueue;
+  bool     queryYield;
+  int32_t  rspCode;
+  int64_t  affectedRows;  // for insert ...select stmt
+  int64_t  admitCost;     // memory reserved by admission control
+  uint64_t admitQId;      // query the reservation is charged to
 
   SRpcHandleInfo ctrlConnInfo;
   SRpcHandleInfo dataConnInfo;
@@ -144,6 +147,13 @@ typedef struct SQWTaskCtx {
   STbVerInfo tbInfo;
 } SQWTaskCtx;
 
+typedef struct SQWAdmitInfo {
+  int64_t memCost;
+  int32_t cpuCost;
+  bool    heavy;
+  char    user[TSDB_USER_LEN];
+} SQWAdmitInfo;
+
 typedef struct SQWSchStatus {
   int64_t        hbBrokenTs;  // timestamp in msecond
   SRWLatch       hbConnLock;
@@ -394,6 +404,13 @@ int64_t qwGetTimeInQueue(SQWorker *mgmt, EQueueType type);
 void    qwClearExpiredSch(SQWorker *mgmt, SArray *pExpiredSch);
 int32_t qwAcquireScheduler(SQWorker *mgmt, uint64_t sId, int32_t rwType, SQWSchStatus **sch);
 void    qwFreeTaskCtx(SQWTaskCtx *ctx);
+bool    qwAdmitNeeded(SQWTaskCtx *ctx);
+void    qwAdmitEstimate(SSubplan *plan, SQWAdmitInfo *info);
+bool    qwAdmitTryAcquire(SQWTaskCtx *ctx, uint64_t qId, SQWAdmitInfo *info);
+int32_t qwAdmitAddPending(QW_FPARAMS_DEF, SQWAdmitInfo *info);
+void    qwAdmitRelease(SQWTaskCtx *ctx);
+void    qwAdmitDispatch(void);
+void    qwAdmitGetStat(int64_t *usedMem, int32_t *runningNum, int32_t *pendingNum);
 
 void    qwDbgDumpMgmtInfo(SQWorker *mgmt);
 int32_t qwDbgValidateStatus(QW_FPARAMS_DEF, int8_t oriStatus, int8_t newStatus, bool *ignore);
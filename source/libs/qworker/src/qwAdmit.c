@@ -0,0 +1,412 @@
+#include "qwInt.h"
+#include "qwMsg.h"
+#include "qworker.h"
+#include "tglobal.h"
+#include "theap.h"
+#include "tmsg.h"
+
+/*
+ * Admission control of fetch-driven query tasks.
+ *
+ * Memory is reserved per query. The first task of a query on this node is admitted when its estimated memory fits
+ * into the node budget (queryAdmitMemory), later tasks of an admitted query are always admitted and add their
+ * estimate to the query, so a task is never parked while a task of the same query holds memory and waits for it.
+ * A query that does not fit waits in a pending heap, together with the tasks of it that arrive meanwhile, ordered
+ * by its weighted fair queueing finish tag. Tags are kept per user and task class, so a user flooding heavy scans
+ * can not starve others, and light queries (weight QW_ADMIT_LIGHT_WEIGHT) get ahead of heavy ones (weight
+ * QW_ADMIT_HEAVY_WEIGHT). The tasks of a pending query are resumed together through the query continue message,
+ * the same way a fetch resumes a suspended task.
+ */
+
+#define QW_ADMIT_BLOCK_ROWS      4096
+#define QW_ADMIT_MATERIAL_BLOCKS 64
+#define QW_ADMIT_LIGHT_WEIGHT    8
+#define QW_ADMIT_HEAVY_WEIGHT    1
+#define QW_ADMIT_SCAN_CPU        16
+#define QW_ADMIT_MATERIAL_CPU    4
+
+typedef struct SQWAdmitTask {
+  int64_t  refId;
+  uint64_t sId;
+  uint64_t qId;
+  uint64_t tId;
+  int64_t  rId;
+  int32_t  eId;
+  int64_t  memCost;
+} SQWAdmitTask;
+
+typedef struct SQWAdmitQuery {
+  HeapNode node;
+  uint64_t qId;
+  bool     admitted;
+  int32_t  taskNum;  // admitted tasks that still hold memory
+  int64_t  memCost;  // memory held by the admitted tasks, or wanted by the pending ones
+  int64_t  finish;
+  int64_t  seq;
+  SArray  *pending;  // SQWAdmitTask, waiting until the query is admitted
+} SQWAdmitQuery;
+
+typedef struct SQWAdmitMgmt {
+  TdThreadMutex lock;
+  int64_t       usedMem;
+  int32_t       runningNum;  // admitted queries
+  int32_t       pendingNum;  // pending queries
+  int64_t       vtime;
+  int64_t       seq;
+  Heap         *pending;
+  SHashObj     *queries;  // key: qId, value: SQWAdmitQuery*
+  SHashObj     *flows;    // key: user:class, value: finish tag of the last query of the flow
+} SQWAdmitMgmt;
+
+static SQWAdmitMgmt gQwAdmit = {0};
+static TdThreadOnce gQwAdmitInit = PTHREAD_ONCE_INIT;
+
+static int32_t qwAdmitQueryCompare(const HeapNode *a, const HeapNode *b) {
+  SQWAdmitQuery *qa = (SQWAdmitQuery *)a;
+  SQWAdmitQuery *qb = (SQWAdmitQuery *)b;
+  if (qa->finish != qb->finish) {
+    return qa->finish < qb->finish;
+  }
+
+  return qa->seq < qb->seq;
+}
+
+static void qwAdmitInitImpl(void) {
+  taosThreadMutexInit(&gQwAdmit.lock, NULL);
+  gQwAdmit.pending = heapCreate(qwAdmitQueryCompare);
+  gQwAdmit.queries = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_UBIGINT), true, HASH_NO_LOCK);
+  gQwAdmit.flows = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+}
+
+static bool qwAdmitInit(void) {
+  taosThreadOnce(&gQwAdmitInit, qwAdmitInitImpl);
+  return gQwAdmit.pending != NULL && gQwAdmit.queries != NULL && gQwAdmit.flows != NULL;
+}
+
+static SQWAdmitQuery *qwAdmitGetQuery(uint64_t qId) {
+  SQWAdmitQuery **ppQuery = taosHashGet(gQwAdmit.queries, &qId, sizeof(qId));
+  return ppQuery ? *ppQuery : NULL;
+}
+
+static void qwAdmitRemoveQuery(SQWAdmitQuery *pQuery) {
+  taosHashRemove(gQwAdmit.queries, &pQuery->qId, sizeof(pQuery->qId));
+  taosArrayDestroy(pQuery->pending);
+  taosMemoryFree(pQuery);
+}
+
+static bool qwAdmitFits(int64_t memCost) {
+  return 0 == gQwAdmit.runningNum || gQwAdmit.usedMem + memCost <= (int64_t)tsQueryAdmitMemory * 1048576;
+}
+
+static void qwAdmitFree(uint64_t qId, int64_t memCost);
+static bool qwAdmitResume(SQWAdmitTask *pTask);
+
+static bool qwAdmitIsMaterialNode(ENodeType type) {
+  switch (type) {
+    case QUERY_NODE_PHYSICAL_PLAN_SORT:
+    case QUERY_NODE_PHYSICAL_PLAN_GROUP_SORT:
+    case QUERY_NODE_PHYSICAL_PLAN_MERGE_JOIN:
+    case QUERY_NODE_PHYSICAL_PLAN_HASH_JOIN:
+    case QUERY_NODE_PHYSICAL_PLAN_PARTITION:
+    case QUERY_NODE_PHYSICAL_PLAN_FILL:
+    case QUERY_NODE_PHYSICAL_PLAN_INTERP_FUNC:
+      return true;
+    default:
+      break;
+  }
+
+  return false;
+}
+
+static bool qwAdmitIsFullScan(SPhysiNode *pNode) {
+  switch (nodeType(pNode)) {
+    case QUERY_NODE_PHYSICAL_PLAN_TABLE_SCAN:
+    case QUERY_NODE_PHYSICAL_PLAN_TABLE_SEQ_SCAN:
+    case QUERY_NODE_PHYSICAL_PLAN_TABLE_MERGE_SCAN: {
+      STableScanPhysiNode *pScan = (STableScanPhysiNode *)pNode;
+      return TSDB_SUPER_TABLE == pScan->scan.tableType && NULL == pNode->pLimit &&
+             INT64_MIN == pScan->scanRange.skey && INT64_MAX == pScan->scanRange.ekey;
+    }
+    default:
+      break;
+  }
+
+  return false;
+}
+
+static void qwAdmitEstimateNode(SPhysiNode *pNode, SQWAdmitInfo *info) {
+  int64_t rowSize = pNode->pOutputDataBlockDesc ? pNode->pOutputDataBlockDesc->totalRowSize : 0;
+  int64_t memCost = rowSize * QW_ADMIT_BLOCK_ROWS;
+
+  info->cpuCost += 1;
+  if (qwAdmitIsMaterialNode(nodeType(pNode))) {
+    memCost *= QW_ADMIT_MATERIAL_BLOCKS;
+    info->cpuCost += QW_ADMIT_MATERIAL_CPU;
+    info->heavy = true;
+  } else if (qwAdmitIsFullScan(pNode)) {
+    info->cpuCost += QW_ADMIT_SCAN_CPU;
+    info->heavy = true;
+  }
+
+  info->memCost += memCost;
+
+  SNode *pChild = NULL;
+  FOREACH(pChild, pNode->pChildren) { qwAdmitEstimateNode((SPhysiNode *)pChild, info); }
+}
+
+bool qwAdmitNeeded(SQWTaskCtx *ctx) { return tsQueryAdmitMemory > 0 && ctx->needFetch && !ctx->localExec; }
+
+void qwAdmitEstimate(SSubplan *plan, SQWAdmitInfo *info) {
+  memset(info, 0, sizeof(*info));
+  tstrncpy(info->user, plan->user, sizeof(info->user));
+  if (plan->pNode) {
+    qwAdmitEstimateNode(plan->pNode, info);
+  }
+}
+
+bool qwAdmitTryAcquire(SQWTaskCtx *ctx, uint64_t qId, SQWAdmitInfo *info) {
+  if (!qwAdmitInit()) {
+    return true;
+  }
+
+  bool admitted = false;
+
+  taosThreadMutexLock(&gQwAdmit.lock);
+  SQWAdmitQuery *pQuery = qwAdmitGetQuery(qId);
+  if (pQuery != NULL) {
+    // the query holds memory already, its tasks must not wait for each other
+    if (pQuery->admitted) {
+      pQuery->taskNum++;
+      pQuery->memCost += info->memCost;
+      gQwAdmit.usedMem += info->memCost;
+      admitted = true;
+    }
+  } else if (0 == gQwAdmit.pendingNum && qwAdmitFits(info->memCost)) {
+    // a newcomer never overtakes queries that are already waiting
+    pQuery = taosMemoryCalloc(1, sizeof(SQWAdmitQuery));
+    if (NULL == pQuery || taosHashPut(gQwAdmit.queries, &qId, sizeof(qId), &pQuery, POINTER_BYTES)) {
+      taosMemoryFree(pQuery);
+      taosThreadMutexUnlock(&gQwAdmit.lock);
+      return true;
+    }
+
+    pQuery->qId = qId;
+    pQuery->admitted = true;
+    pQuery->taskNum = 1;
+    pQuery->memCost = info->memCost;
+    gQwAdmit.usedMem += info->memCost;
+    gQwAdmit.runningNum++;
+    admitted = true;
+  }
+  taosThreadMutexUnlock(&gQwAdmit.lock);
+
+  if (admitted) {
+    ctx->admitQId = qId;
+    atomic_store_64(&ctx->admitCost, info->memCost);
+  }
+
+  return admitted;
+}
+
+int32_t qwAdmitAddPending(QW_FPARAMS_DEF, SQWAdmitInfo *info) {
+  SQWAdmitTask task = {.refId = mgmt->refId,
+                       .sId = sId,
+                       .qId = qId,
+                       .tId = tId,
+                       .rId = rId,
+                       .eId = eId,
+                       .memCost = info->memCost};
+  char    flow[TSDB_USER_LEN + 8] = {0};
+  int32_t flowLen = snprintf(flow, sizeof(flow), "%s:%d", info->user, info->heavy);
+  int32_t weight = info->heavy ? QW_ADMIT_HEAVY_WEIGHT : QW_ADMIT_LIGHT_WEIGHT;
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  taosThreadMutexLock(&gQwAdmit.lock);
+  SQWAdmitQuery *pQuery = qwAdmitGetQuery(qId);
+  if (NULL == pQuery) {
+    pQuery = taosMemoryCalloc(1, sizeof(SQWAdmitQuery));
+    if (NULL == pQuery) {
+      QW_TASK_ELOG("calloc %d SQWAdmitQuery failed", (int32_t)sizeof(SQWAdmitQuery));
+      QW_ERR_JRET(TSDB_CODE_OUT_OF_MEMORY);
+    }
+
+    pQuery->qId = qId;
+    pQuery->pending = taosArrayInit(4, sizeof(SQWAdmitTask));
+    if (NULL == pQuery->pending || taosHashPut(gQwAdmit.queries, &qId, sizeof(qId), &pQuery, POINTER_BYTES)) {
+      taosArrayDestroy(pQuery->pending);
+      taosMemoryFree(pQuery);
+      QW_ERR_JRET(TSDB_CODE_OUT_OF_MEMORY);
+    }
+
+    int64_t  start = gQwAdmit.vtime;
+    int64_t *pLast = taosHashGet(gQwAdmit.flows, flow, flowLen);
+    if (pLast && *pLast > start) {
+      start = *pLast;
+    }
+
+    pQuery->finish = start + (int64_t)info->cpuCost * QW_ADMIT_LIGHT_WEIGHT / weight;
+    pQuery->seq = gQwAdmit.seq++;
+    taosHashPut(gQwAdmit.flows, flow, flowLen, &pQuery->finish, sizeof(pQuery->finish));
+    heapInsert(gQwAdmit.pending, &pQuery->node);
+    gQwAdmit.pendingNum++;
+  } else if (pQuery->admitted) {
+    // admitted since the task tried, it joins the query like any later task of it
+    pQuery->taskNum++;
+    pQuery->memCost += info->memCost;
+    gQwAdmit.usedMem += info->memCost;
+    taosThreadMutexUnlock(&gQwAdmit.lock);
+
+    QW_TASK_DLOG("task admitted with its query, memCost:%" PRId64, info->memCost);
+    if (!qwAdmitResume(&task)) {
+      qwAdmitFree(qId, info->memCost);
+    }
+    return TSDB_CODE_SUCCESS;
+  }
+
+  if (NULL == taosArrayPush(pQuery->pending, &task)) {
+    QW_ERR_JRET(TSDB_CODE_OUT_OF_MEMORY);
+  }
+  pQuery->memCost += info->memCost;
+
+  QW_TASK_DLOG("task pending for admission, flow:%s, memCost:%" PRId64 ", finish:%" PRId64, flow, info->memCost,
+               pQuery->finish);
+
+_return:
+  taosThreadMutexUnlock(&gQwAdmit.lock);
+
+  if (TSDB_CODE_SUCCESS == code) {
+    qwAdmitDispatch();
+  }
+
+  QW_RET(code);
+}
+
+static void qwAdmitFree(uint64_t qId, int64_t memCost) {
+  taosThreadMutexLock(&gQwAdmit.lock);
+  gQwAdmit.usedMem -= memCost;
+
+  SQWAdmitQuery *pQuery = qwAdmitGetQuery(qId);
+  if (pQuery != NULL && pQuery->admitted) {
+    pQuery->memCost -= memCost;
+    if (--pQuery->taskNum <= 0) {
+      qwAdmitRemoveQuery(pQuery);
+      gQwAdmit.runningNum--;
+    }
+  }
+  taosThreadMutexUnlock(&gQwAdmit.lock);
+}
+
+void qwAdmitRelease(SQWTaskCtx *ctx) {
+  int64_t memCost = atomic_exchange_64(&ctx->admitCost, 0);
+  if (memCost > 0) {
+    qwAdmitFree(ctx->admitQId, memCost);
+  }
+}
+
+void qwAdmitGetStat(int64_t *usedMem, int32_t *runningNum, int32_t *pendingNum) {
+  if (!qwAdmitInit()) {
+    *usedMem = 0;
+    *runningNum = 0;
+    *pendingNum = 0;
+    return;
+  }
+
+  taosThreadMutexLock(&gQwAdmit.lock);
+  *usedMem = gQwAdmit.usedMem;
+  *runningNum = gQwAdmit.runningNum;
+  *pendingNum = gQwAdmit.pendingNum;
+  taosThreadMutexUnlock(&gQwAdmit.lock);
+}
+
+static bool qwAdmitResume(SQWAdmitTask *pTask) {
+  SQWorker *mgmt = qwAcquire(pTask->refId);
+  if (NULL == mgmt) {
+    return false;
+  }
+
+  uint64_t    sId = pTask->sId;
+  uint64_t    qId = pTask->qId;
+  uint64_t    tId = pTask->tId;
+  int64_t     rId = pTask->rId;
+  int32_t     eId = pTask->eId;
+  SQWTaskCtx *ctx = NULL;
+  bool        resumed = false;
+
+  if (qwAcquireTaskCtx(QW_FPARAMS(), &ctx)) {
+    qwRelease(pTask->refId);
+    return false;
+  }
+
+  QW_LOCK(QW_WRITE, &ctx->lock);
+  if (!QW_EVENT_RECEIVED(ctx, QW_EVENT_DROP) && !QW_EVENT_PROCESSED(ctx, QW_EVENT_DROP) &&
+      0 == atomic_load_32(&ctx->rspCode)) {
+    ctx->admitQId = qId;
+    atomic_store_64(&ctx->admitCost, pTask->memCost);
+    qwUpdateTaskStatus(QW_FPARAMS(), JOB_TASK_STATUS_EXEC);
+    if (qwBuildAndSendCQueryMsg(QW_FPARAMS(), &ctx->ctrlConnInfo)) {
+      atomic_store_64(&ctx->admitCost, 0);
+      atomic_store_8((int8_t *)&ctx->queryInQueue, 0);
+    } else {
+      resumed = true;
+      QW_TASK_DLOG("task admitted, memCost:%" PRId64, pTask->memCost);
+    }
+  }
+  QW_UNLOCK(QW_WRITE, &ctx->lock);
+
+  qwReleaseTaskCtx(mgmt, ctx);
+  qwRelease(pTask->refId);
+
+  return resumed;
+}
+
+void qwAdmitDispatch(void) {
+  if (tsQueryAdmitMemory <= 0 || 0 == atomic_load_32(&gQwAdmit.pendingNum)) {
+    return;
+  }
+
+  while (true) {
+    SArray *pTasks = NULL;
+
+    taosThreadMutexLock(&gQwAdmit.lock);
+    HeapNode *pNode = heapMin(gQwAdmit.pending);
+    if (pNode) {
+      SQWAdmitQuery *pMin = (SQWAdmitQuery *)pNode;
+      if (qwAdmitFits(pMin->memCost)) {
+        heapDequeue(gQwAdmit.pending);
+        gQwAdmit.pendingNum--;
+        gQwAdmit.usedMem += pMin->memCost;
+        gQwAdmit.runningNum++;
+        gQwAdmit.vtime = pMin->finish;
+
+        pMin->admitted = true;
+        pMin->taskNum = (int32_t)taosArrayGetSize(pMin->pending);
+        pTasks = pMin->pending;
+        pMin->pending = NULL;
+        if (0 == pMin->taskNum) {
+          gQwAdmit.usedMem -= pMin->memCost;
+          gQwAdmit.runningNum--;
+          qwAdmitRemoveQuery(pMin);
+        }
+      }
+    }
+
+    if (0 == gQwAdmit.pendingNum) {
+      taosHashClear(gQwAdmit.flows);
+    }
+    taosThreadMutexUnlock(&gQwAdmit.lock);
+
+    if (NULL == pTasks) {
+      break;
+    }
+
+    // a task may be dropped while waiting, give its reservation back
+    for (int32_t i = 0; i < taosArrayGetSize(pTasks); ++i) {
+      SQWAdmitTask *pTask = taosArrayGet(pTasks, i);
+      if (!qwAdmitResume(pTask)) {
+        qwAdmitFree(pTask->qId, pTask->memCost);
+      }
+    }
+
+    taosArrayDestroy(pTasks);
+  }
+}
@@ -306,6 +306,7 @@ void qwFreeTaskCtx(SQWTaskCtx *ctx) {
   // NO need to release dataConnInfo
 
   qwFreeTaskHandle(&ctx->taskHandle);
+  qwAdmitRelease(ctx);
 
   if (ctx->sinkHandle) {
     dsDestroyDataSinker(ctx->sinkHandle);
@@ -147,6 +147,35 @@ int32_t qwSendQueryRsp(QW_FPARAMS_DEF, int32_t msgType, SQWTaskCtx *ctx, int32_t
   return TSDB_CODE_SUCCESS;
 }
 
+static bool qwNeedYield(SQWTaskCtx *ctx, int64_t startTs) {
+  if (tsQueryTimeSlice <= 0 || ctx->localExec || !ctx->needFetch) {
+    return false;
+  }
+
+  return taosGetTimestampMs() - startTs >= tsQueryTimeSlice;
+}
+
+// put a task that used up its time slice back to the end of the query queue
+static void qwYieldTask(QW_FPARAMS_DEF) {
+  SQWTaskCtx *ctx = NULL;
+  if (qwAcquireTaskCtx(QW_FPARAMS(), &ctx)) {
+    return;
+  }
+
+  QW_LOCK(QW_WRITE, &ctx->lock);
+  if (!QW_QUERY_RUNNING(ctx) && !ctx->queryEnd && 0 == atomic_load_32(&ctx->rspCode) &&
+      !QW_EVENT_RECEIVED(ctx, QW_EVENT_DROP) && 0 == atomic_load_8((int8_t *)&ctx->queryInQueue)) {
+    qwUpdateTaskStatus(QW_FPARAMS(), JOB_TASK_STATUS_EXEC);
+    atomic_store_8((int8_t *)&ctx->queryInQueue, 1);
+    if (qwBuildAndSendCQueryMsg(QW_FPARAMS(), &ctx->ctrlConnInfo)) {
+      atomic_store_8((int8_t *)&ctx->queryInQueue, 0);
+    }
+  }
+  QW_UNLOCK(QW_WRITE, &ctx->lock);
+
+  qwReleaseTaskCtx(mgmt, ctx);
+}
+
 int32_t qwExecTask(QW_FPARAMS_DEF, SQWTaskCtx *ctx, bool *queryStop) {
   int32_t        code = 0;
   bool           qcontinue = true;
@@ -156,6 +185,9 @@ int32_t qwExecTask(QW_FPARAMS_DEF, SQWTaskCtx *ctx, bool *queryStop) {
   qTaskInfo_t    taskHandle = ctx->taskHandle;
   DataSinkHandle sinkHandle = ctx->sinkHandle;
   SLocalFetch    localFetch = {(void *)mgmt, ctx->localExec, qWorkerProcessLocalFetch, ctx->explainRes};
+  int64_t        startTs = taosGetTimestampMs();
+
+  ctx->queryYield = false;
 
   if (ctx->queryExecDone) {
     if (queryStop) {
@@ -211,6 +243,7 @@ int32_t qwExecTask(QW_FPARAMS_DEF, SQWTaskCtx *ctx, bool *queryStop) {
 
       dsEndPut(sinkHandle, useconds);
       QW_ERR_JRET(qwHandleTaskComplete(QW_FPARAMS(), ctx));
+      qwAdmitRelease(ctx);
 
       if (queryStop) {
         *queryStop = true;
@@ -238,6 +271,12 @@ int32_t qwExecTask(QW_FPARAMS_DEF, SQWTaskCtx *ctx, bool *queryStop) {
     if (atomic_load_32(&ctx->rspCode)) {
       break;
     }
+
+    if (qwNeedYield(ctx, startTs)) {
+      QW_TASK_DLOG("task yield after %" PRId64 "ms, loopIdx:%d", taosGetTimestampMs() - startTs, i);
+      ctx->queryYield = true;
+      break;
+    }
   }
 
 _return:
@@ -652,6 +691,9 @@ int32_t qwProcessQuery(QW_FPARAMS_DEF, SQWMsg *qwMsg, char *sql) {
   qTaskInfo_t    pTaskInfo = NULL;
   DataSinkHandle sinkHandle = NULL;
   SQWTaskCtx    *ctx = NULL;
+  SQWAdmitInfo   admit = {0};
+  bool           admitted = true;
+  bool           queryYield = false;
 
   QW_ERR_JRET(qwHandlePrePhaseEvents(QW_FPARAMS(), QW_PHASE_PRE_QUERY, &input, NULL));
 
@@ -691,16 +733,42 @@ int32_t qwProcessQuery(QW_FPARAMS_DEF, SQWMsg *qwMsg, char *sql) {
   atomic_store_ptr(&ctx->sinkHandle, sinkHandle);
 
   qwSaveTbVersionInfo(pTaskInfo, ctx);
-  QW_ERR_JRET(qwExecTask(QW_FPARAMS(), ctx, NULL));
+
+  if (qwAdmitNeeded(ctx)) {
+    qwAdmitEstimate(plan, &admit);
+    admitted = qwAdmitTryAcquire(ctx, qId, &admit);
+  }
+
+  if (admitted) {
+    QW_ERR_JRET(qwExecTask(QW_FPARAMS(), ctx, NULL));
+  } else {
+    // resumed by a query continue msg once admitted, fetch must not start it before
+    atomic_store_8((int8_t *)&ctx->queryInQueue, 1);
+  }
 
 _return:
 
   taosMemoryFree(sql);
 
+  queryYield = (ctx != NULL && ctx->queryYield);
+
   input.code = code;
   input.msgType = qwMsg->msgType;
   code = qwHandlePostPhaseEvents(QW_FPARAMS(), QW_PHASE_POST_QUERY, &input, NULL);
 
+  if (TSDB_CODE_SUCCESS == code && ctx != NULL) {
+    if (!admitted) {
+      if (qwAdmitAddPending(QW_FPARAMS(), &admit)) {
+        // let the next fetch start it unaccounted
+        atomic_store_8((int8_t *)&ctx->queryInQueue, 0);
+      }
+    } else if (queryYield) {
+      qwYieldTask(QW_FPARAMS());
+    }
+  }
+
+  qwAdmitDispatch();
+
   if (QUERY_RSP_POLICY_QUICK == tsQueryRspPolicy && ctx != NULL && QW_EVENT_RECEIVED(ctx, QW_EVENT_FETCH)) {
     void       *rsp = NULL;
     int32_t     dataLen = 0;
@@ -803,7 +871,7 @@ int32_t qwProcessCQuery(QW_FPARAMS_DEF, SQWMsg *qwMsg) {
 
     QW_LOCK(QW_WRITE, &ctx->lock);
     if (atomic_load_8((int8_t *)&ctx->queryEnd) || (queryStop && (0 == atomic_load_8((int8_t *)&ctx->queryContinue))) ||
-        code) {
+        ctx->queryYield || code) {
       // Note: query is not running anymore
       QW_SET_PHASE(ctx, QW_PHASE_POST_CQUERY);
       QW_UNLOCK(QW_WRITE, &ctx->lock);
@@ -812,8 +880,16 @@ int32_t qwProcessCQuery(QW_FPARAMS_DEF, SQWMsg *qwMsg) {
     QW_UNLOCK(QW_WRITE, &ctx->lock);
   } while (true);
 
+  bool queryYield = (ctx != NULL && ctx->queryYield);
+
   input.code = code;
-  qwHandlePostPhaseEvents(QW_FPARAMS(), QW_PHASE_POST_CQUERY, &input, NULL);
+  code = qwHandlePostPhaseEvents(QW_FPARAMS(), QW_PHASE_POST_CQUERY, &input, NULL);
+
+  if (TSDB_CODE_SUCCESS == code && queryYield) {
+    qwYieldTask(QW_FPARAMS());
+  }
+
+  qwAdmitDispatch();
 
   QW_RET(TSDB_CODE_SUCCESS);
 }
@@ -1019,6 +1095,7 @@ void qwProcessHbTimerEvent(void *param, void *tmrId) {
   int32_t       code = 0;
 
   qwDbgDumpMgmtInfo(mgmt);
+  qwAdmitDispatch();
 
   if (gQWDebug.forceStop) {
     (void)qwStopAllTasks(mgmt);
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include "qwInt.h"
+#include "tglobal.h"
+#include "trpc.h"
+
+namespace {
+
+int32_t qwAdmitTestCQueryNum = 0;
+
+// query continue msgs are how a parked task is resumed, count them instead of executing
+int32_t qwAdmitTestPutToQueue(void *node, EQueueType qtype, SRpcMsg *pMsg) {
+  if (TDMT_SCH_QUERY_CONTINUE == pMsg->msgType) {
+    qwAdmitTestCQueryNum++;
+  }
+  rpcFreeCont(pMsg->pCont);
+  return 0;
+}
+
+SQWTaskCtx *qwAdmitTestAddTask(SQWorker *mgmt, uint64_t qId, uint64_t tId) {
+  SQWTaskCtx *ctx = NULL;
+  EXPECT_EQ(qwAddAcquireTaskCtx(mgmt, 1, qId, tId, 0, 0, &ctx), 0);
+  ctx->needFetch = 1;
+  qwReleaseTaskCtx(mgmt, ctx);
+  return ctx;
+}
+
+// admitted or parked, the task is charged memCost
+bool qwAdmitTestAcquire(SQWorker *mgmt, SQWTaskCtx *ctx, uint64_t qId, uint64_t tId, int64_t memCost) {
+  SQWAdmitInfo info = {0};
+  info.memCost = memCost;
+  info.cpuCost = 1;
+  tstrncpy(info.user, "root", sizeof(info.user));
+
+  if (qwAdmitTryAcquire(ctx, qId, &info)) {
+    return true;
+  }
+
+  EXPECT_EQ(qwAdmitAddPending(mgmt, 1, qId, tId, 0, 0, &info), 0);
+  return false;
+}
+
+void qwAdmitTestCheckStat(int64_t usedMem, int32_t runningNum, int32_t pendingNum) {
+  int64_t used = 0;
+  int32_t running = 0, pending = 0;
+  qwAdmitGetStat(&used, &running, &pending);
+  EXPECT_EQ(used, usedMem);
+  EXPECT_EQ(running, runningNum);
+  EXPECT_EQ(pending, pendingNum);
+}
+
+}  // namespace
+
+TEST(qwAdmitTest, admitParkResumeRelease) {
+  void   *pMgmt = NULL;
+  SMsgCb  msgCb = {0};
+  int32_t oriAdmitMemory = tsQueryAdmitMemory;
+
+  msgCb.mgmt = (void *)0x1;
+  msgCb.putToQueueFp = (PutToQueueFp)qwAdmitTestPutToQueue;
+  ASSERT_EQ(qWorkerInit(NODE_TYPE_VNODE, 1, &pMgmt, &msgCb), 0);
+  SQWorker *mgmt = (SQWorker *)pMgmt;
+
+  const int64_t kb = 1024;
+  tsQueryAdmitMemory = 1;
+
+  // admit: the first task of a query fits, a later task of it joins even beyond the budget
+  SQWTaskCtx *a1 = qwAdmitTestAddTask(mgmt, 1, 1);
+  SQWTaskCtx *a2 = qwAdmitTestAddTask(mgmt, 1, 2);
+  ASSERT_TRUE(qwAdmitNeeded(a1));
+  ASSERT_TRUE(qwAdmitTestAcquire(mgmt, a1, 1, 1, 768 * kb));
+  ASSERT_TRUE(qwAdmitTestAcquire(mgmt, a2, 1, 2, 768 * kb));
+  qwAdmitTestCheckStat(1536 * kb, 1, 0);
+
+  // park: another query waits, and so do the tasks of it that arrive meanwhile
+  SQWTaskCtx *b1 = qwAdmitTestAddTask(mgmt, 2, 1);
+  SQWTaskCtx *b2 = qwAdmitTestAddTask(mgmt, 2, 2);
+  ASSERT_FALSE(qwAdmitTestAcquire(mgmt, b1, 2, 1, 512 * kb));
+  ASSERT_FALSE(qwAdmitTestAcquire(mgmt, b2, 2, 2, 256 * kb));
+  qwAdmitTestCheckStat(1536 * kb, 1, 1);
+  EXPECT_EQ(qwAdmitTestCQueryNum, 0);
+
+  // release: the pending query still does not fit next to what is left
+  qwAdmitRelease(a1);
+  qwAdmitDispatch();
+  qwAdmitTestCheckStat(768 * kb, 1, 1);
+  EXPECT_EQ(qwAdmitTestCQueryNum, 0);
+
+  // resume: all tasks of the pending query are admitted together
+  qwAdmitRelease(a2);
+  qwAdmitRelease(a2);
+  qwAdmitDispatch();
+  qwAdmitTestCheckStat(768 * kb, 1, 0);
+  EXPECT_EQ(qwAdmitTestCQueryNum, 2);
+  EXPECT_EQ(b1->admitCost, 512 * kb);
+  EXPECT_EQ(b2->admitCost, 256 * kb);
+
+  // a task dropped while parked gives its reservation back when its query is admitted
+  SQWTaskCtx *c1 = qwAdmitTestAddTask(mgmt, 3, 1);
+  ASSERT_FALSE(qwAdmitTestAcquire(mgmt, c1, 3, 1, 512 * kb));
+  QW_SET_EVENT_RECEIVED(c1, QW_EVENT_DROP);
+  qwAdmitRelease(b1);
+  qwAdmitRelease(b2);
+  qwAdmitDispatch();
+  qwAdmitTestCheckStat(0, 0, 0);
+  EXPECT_EQ(qwAdmitTestCQueryNum, 2);
+  EXPECT_EQ(c1->admitCost, 0);
+
+  // off by default, nothing is admitted or parked
+  tsQueryAdmitMemory = 0;
+  EXPECT_FALSE(qwAdmitNeeded(c1));
+
+  tsQueryAdmitMemory = oriAdmitMemory;
+  qWorkerDestroy(&pMgmt);
+}
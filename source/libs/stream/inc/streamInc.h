@@ -30,10 +30,30 @@ typedef struct {
 
 static SStreamGlobalEnv streamEnv;
 
+#define STREAM_DISPATCH_BLOCKED_WAIT_MS 100
+#define STREAM_DISPATCH_RETRY_WAIT_MS   100
+
+// the dispatch msgs taken from one upstream task, as kept in SStreamTask.pUpstreamSeq
+typedef struct {
+  int64_t session;
+  int64_t nextSeq;
+} SStreamUpstreamSeq;
+
+// flags of SStreamTask.execPaused
+#define STREAM_EXEC_PAUSED__INPUT   0x1  // resumed by a run req
+#define STREAM_EXEC_PAUSED__RECOVER 0x2  // resumed by a recover step 1 req
+
 int32_t streamDispatch(SStreamTask* pTask);
 int32_t streamDispatchReqToData(const SStreamDispatchReq* pReq, SStreamDataBlock* pData);
 int32_t streamRetrieveReqToData(const SStreamRetrieveReq* pReq, SStreamDataBlock* pData);
 int32_t streamDispatchAllBlocks(SStreamTask* pTask, const SStreamDataBlock* data);
+void    streamDispatchProcessRsp(SStreamTask* pTask, int32_t downstreamTaskId, int64_t seq, bool failed);
+int32_t streamDispatchResend(SStreamTask* pTask);
+void    streamDispatchRetryLater(SStreamTask* pTask);
+bool    streamDispatchBlocked(SStreamTask* pTask);
+bool    streamTaskOutputFull(SStreamTask* pTask);
+
+int32_t streamSchedRecoverStep1(SStreamTask* pTask);
 
 int32_t streamBroadcastToChildren(SStreamTask* pTask, const SSDataBlock* pBlock);
 
@@ -14,6 +14,7 @@
  */
 
 #include "streamInc.h"
+#include "tglobal.h"
 #include "ttimer.h"
 
 int32_t streamInit() {
@@ -79,6 +80,39 @@ void streamSchedByTimer(void* param, void* tmrId) {
   taosTmrReset(streamSchedByTimer, (int32_t)pTask->triggerParam, pTask, streamEnv.timer, &pTask->timer);
 }
 
+static void streamDispatchByTimer(void* param, void* tmrId) {
+  SStreamTask* pTask = (void*)param;
+
+  if (atomic_load_8(&pTask->taskStatus) == TASK_STATUS__DROPPING) {
+    streamMetaReleaseTask(NULL, pTask);
+    return;
+  }
+
+  // blocked again by the rsp received meanwhile
+  int64_t waitMs = atomic_load_64(&pTask->dispatchBlockedUntil) - taosGetTimestampMs();
+  if (waitMs > 0) {
+    taosTmrStart(streamDispatchByTimer, (int32_t)waitMs, pTask, streamEnv.timer);
+    return;
+  }
+
+  streamDispatch(pTask);
+  streamMetaReleaseTask(NULL, pTask);
+}
+
+static void streamDispatchRetryByTimer(void* param, void* tmrId) {
+  SStreamTask* pTask = (void*)param;
+
+  if (atomic_load_8(&pTask->taskStatus) != TASK_STATUS__DROPPING) {
+    streamDispatchResend(pTask);
+  }
+  streamMetaReleaseTask(NULL, pTask);
+}
+
+void streamDispatchRetryLater(SStreamTask* pTask) {
+  atomic_add_fetch_32(&pTask->refCnt, 1);
+  taosTmrStart(streamDispatchRetryByTimer, STREAM_DISPATCH_RETRY_WAIT_MS, pTask, streamEnv.timer);
+}
+
 int32_t streamSetupTrigger(SStreamTask* pTask) {
   if (pTask->triggerParam != 0) {
     int32_t ref = atomic_add_fetch_32(&pTask->refCnt, 1);
@@ -111,12 +145,69 @@ int32_t streamSchedExec(SStreamTask* pTask) {
   return 0;
 }
 
+enum {
+  STREAM_UPSTREAM_SEQ__NEXT = 0,  // taken
+  STREAM_UPSTREAM_SEQ__DUP,       // taken before, sent again by a retry
+  STREAM_UPSTREAM_SEQ__GAP,       // some msg before it is not taken yet
+};
+
+// a dispatch msg is taken once, and only after all msgs sent before it by the same upstream task
+static int32_t streamTaskCheckUpstreamSeq(SStreamTask* pTask, const SStreamDispatchReq* pReq) {
+  if (pReq->seq == 0) {
+    return STREAM_UPSTREAM_SEQ__NEXT;
+  }
+
+  if (pTask->pUpstreamSeq == NULL) {
+    pTask->pUpstreamSeq = taosHashInit(8, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), false, HASH_NO_LOCK);
+    if (pTask->pUpstreamSeq == NULL) {
+      return STREAM_UPSTREAM_SEQ__GAP;
+    }
+  }
+
+  SStreamUpstreamSeq* pSeq = taosHashGet(pTask->pUpstreamSeq, &pReq->upstreamTaskId, sizeof(int32_t));
+  if (pSeq == NULL) {
+    // this task starts with whatever the upstream task has in flight
+    return STREAM_UPSTREAM_SEQ__NEXT;
+  }
+  if (pSeq->session != pReq->session) {
+    // the upstream task is restarted and numbers its msgs from 1 again
+    return pReq->seq == 1 ? STREAM_UPSTREAM_SEQ__NEXT : STREAM_UPSTREAM_SEQ__GAP;
+  }
+  if (pReq->seq < pSeq->nextSeq) {
+    return STREAM_UPSTREAM_SEQ__DUP;
+  }
+  return pReq->seq == pSeq->nextSeq ? STREAM_UPSTREAM_SEQ__NEXT : STREAM_UPSTREAM_SEQ__GAP;
+}
+
+static void streamTaskTakeUpstreamSeq(SStreamTask* pTask, const SStreamDispatchReq* pReq) {
+  if (pReq->seq == 0) {
+    return;
+  }
+  SStreamUpstreamSeq seq = {.session = pReq->session, .nextSeq = pReq->seq + 1};
+  taosHashPut(pTask->pUpstreamSeq, &pReq->upstreamTaskId, sizeof(int32_t), &seq, sizeof(SStreamUpstreamSeq));
+}
+
+static int8_t streamTaskInputStatus(SStreamTask* pTask) {
+  // accepted, but the upstream task should hold on until the input queue is consumed
+  return taosQueueItemSize(pTask->inputQueue->queue) >= tsStreamQueueLimit ? TASK_INPUT_STATUS__BLOCKED
+                                                                           : TASK_INPUT_STATUS__NORMAL;
+}
+
 int32_t streamTaskEnqueue(SStreamTask* pTask, const SStreamDispatchReq* pReq, SRpcMsg* pRsp) {
-  SStreamDataBlock* pData = taosAllocateQitem(sizeof(SStreamDataBlock), DEF_QITEM, 0);
+  SStreamDataBlock* pData = NULL;
   int8_t            status;
 
-  // enqueue
-  if (pData != NULL) {
+  taosThreadMutexLock(&pTask->dispatchLock);
+  int32_t seqCheck = streamTaskCheckUpstreamSeq(pTask, pReq);
+  if (seqCheck == STREAM_UPSTREAM_SEQ__DUP) {
+    qDebug("task %d skip dispatch msg from task %d, seq %" PRId64 " since taken", pTask->taskId,
+           pReq->upstreamTaskId, pReq->seq);
+    status = streamTaskInputStatus(pTask);
+  } else if (seqCheck == STREAM_UPSTREAM_SEQ__GAP) {
+    qDebug("task %d refuse dispatch msg from task %d, seq %" PRId64 " since some msg before it is not taken",
+           pTask->taskId, pReq->upstreamTaskId, pReq->seq);
+    status = TASK_INPUT_STATUS__FAILED;
+  } else if ((pData = taosAllocateQitem(sizeof(SStreamDataBlock), DEF_QITEM, 0)) != NULL) {
     pData->type = STREAM_INPUT__DATA_BLOCK;
     pData->srcVgId = pReq->dataSrcVgId;
     // decode
@@ -124,7 +215,8 @@ int32_t streamTaskEnqueue(SStreamTask* pTask, const SStreamDispatchReq* pReq, SR
     /*pBlock->sourceVer = pReq->sourceVer;*/
     streamDispatchReqToData(pReq, pData);
     if (streamTaskInput(pTask, (SStreamQueueItem*)pData) == 0) {
-      status = TASK_INPUT_STATUS__NORMAL;
+      streamTaskTakeUpstreamSeq(pTask, pReq);
+      status = streamTaskInputStatus(pTask);
     } else {
       status = TASK_INPUT_STATUS__FAILED;
     }
@@ -132,6 +224,7 @@ int32_t streamTaskEnqueue(SStreamTask* pTask, const SStreamDispatchReq* pReq, SR
     streamTaskInputFail(pTask);
     status = TASK_INPUT_STATUS__FAILED;
   }
+  taosThreadMutexUnlock(&pTask->dispatchLock);
 
   // rsp by input status
   void* buf = rpcMallocCont(sizeof(SMsgHead) + sizeof(SStreamDispatchRsp));
@@ -143,10 +236,11 @@ int32_t streamTaskEnqueue(SStreamTask* pTask, const SStreamDispatchReq* pReq, SR
   pCont->upstreamTaskId = htonl(pReq->upstreamTaskId);
   pCont->downstreamNodeId = htonl(pTask->nodeId);
   pCont->downstreamTaskId = htonl(pTask->taskId);
+  pCont->seq = htobe64(pReq->seq);
   pRsp->pCont = buf;
   pRsp->contLen = sizeof(SMsgHead) + sizeof(SStreamDispatchRsp);
   tmsgSendRsp(pRsp);
-  return status == TASK_INPUT_STATUS__NORMAL ? 0 : -1;
+  return status == TASK_INPUT_STATUS__FAILED ? -1 : 0;
 }
 
 int32_t streamTaskEnqueueRetrieve(SStreamTask* pTask, SStreamRetrieveReq* pReq, SRpcMsg* pRsp) {
@@ -227,25 +321,25 @@ int32_t streamProcessDispatchReq(SStreamTask* pTask, SStreamDispatchReq* pReq, S
 }
 
 int32_t streamProcessDispatchRsp(SStreamTask* pTask, SStreamDispatchRsp* pRsp, int32_t code) {
-  ASSERT(pRsp->inputStatus == TASK_OUTPUT_STATUS__NORMAL || pRsp->inputStatus == TASK_OUTPUT_STATUS__BLOCKED);
+  int32_t downstreamTaskId = ntohl(pRsp->downstreamTaskId);
+  int64_t seq = be64toh(pRsp->seq);
+  qDebug("task %d receive dispatch rsp from task %d, seq %" PRId64 ", code: %x, input status: %d", pTask->taskId,
+         downstreamTaskId, seq, code, pRsp->inputStatus);
 
-  qDebug("task %d receive dispatch rsp, code: %x", pTask->taskId, code);
-
-  if (pTask->outputType == TASK_OUTPUT__SHUFFLE_DISPATCH) {
-    int32_t leftRsp = atomic_sub_fetch_32(&pTask->shuffleDispatcher.waitingRspCnt, 1);
-    qDebug("task %d is shuffle, left waiting rsp %d", pTask->taskId, leftRsp);
-    if (leftRsp > 0) return 0;
-  }
-
-  int8_t old = atomic_exchange_8(&pTask->outputStatus, pRsp->inputStatus);
-  ASSERT(old == TASK_OUTPUT_STATUS__WAIT);
   if (pRsp->inputStatus == TASK_INPUT_STATUS__BLOCKED) {
-    // TODO: init recover timer
-    ASSERT(0);
-    return 0;
+    // stop dispatching for a while, so the backlog is kept in the output queue and the exec of this task pauses then
+    int64_t until = taosGetTimestampMs() + STREAM_DISPATCH_BLOCKED_WAIT_MS;
+    int64_t old = atomic_exchange_64(&pTask->dispatchBlockedUntil, until);
+    if (old <= taosGetTimestampMs()) {
+      qDebug("task %d stop dispatching since input of task %d is blocked", pTask->taskId, downstreamTaskId);
+      atomic_add_fetch_32(&pTask->refCnt, 1);
+      taosTmrStart(streamDispatchByTimer, STREAM_DISPATCH_BLOCKED_WAIT_MS, pTask, streamEnv.timer);
+    }
   }
-  // continue dispatch
-  streamDispatch(pTask);
+
+  // a failed msg is sent again to the task with all msgs after it, and the task skips those it has taken
+  bool failed = code != 0 || pRsp->inputStatus == TASK_INPUT_STATUS__FAILED;
+  streamDispatchProcessRsp(pTask, downstreamTaskId, seq, failed);
   return 0;
 }
 
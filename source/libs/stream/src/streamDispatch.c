@@ -14,6 +14,7 @@
  */
 
 #include "streamInc.h"
+#include "tglobal.h"
 
 int32_t tEncodeStreamDispatchReq(SEncoder* pEncoder, const SStreamDispatchReq* pReq) {
   if (tStartEncode(pEncoder) < 0) return -1;
@@ -32,6 +33,8 @@ int32_t tEncodeStreamDispatchReq(SEncoder* pEncoder, const SStreamDispatchReq* p
     if (tEncodeI32(pEncoder, len) < 0) return -1;
     if (tEncodeBinary(pEncoder, data, len) < 0) return -1;
   }
+  if (tEncodeI64(pEncoder, pReq->session) < 0) return -1;
+  if (tEncodeI64(pEncoder, pReq->seq) < 0) return -1;
   tEndEncode(pEncoder);
   return pEncoder->pos;
 }
@@ -58,6 +61,10 @@ int32_t tDecodeStreamDispatchReq(SDecoder* pDecoder, SStreamDispatchReq* pReq) {
     taosArrayPush(pReq->dataLen, &len1);
     taosArrayPush(pReq->data, &data);
   }
+  if (!tDecodeIsEnd(pDecoder)) {
+    if (tDecodeI64(pDecoder, &pReq->session) < 0) return -1;
+    if (tDecodeI64(pDecoder, &pReq->seq) < 0) return -1;
+  }
   tEndDecode(pDecoder);
   return 0;
 }
@@ -290,19 +297,16 @@ FAIL:
   return code;
 }
 
-int32_t streamDispatchOneDataReq(SStreamTask* pTask, const SStreamDispatchReq* pReq, int32_t vgId, SEpSet* pEpSet) {
-  void*   buf = NULL;
-  int32_t code = -1;
-  SRpcMsg msg = {0};
-
-  // serialize
+static int32_t streamDispatchEncodeReq(const SStreamDispatchReq* pReq, int32_t vgId, SStreamDispatchMsg* pMsg) {
+  int32_t code;
   int32_t tlen;
   tEncodeSize(tEncodeStreamDispatchReq, pReq, tlen, code);
-  if (code < 0) goto FAIL;
-  code = -1;
-  buf = rpcMallocCont(sizeof(SMsgHead) + tlen);
+  if (code < 0) return -1;
+
+  void* buf = taosMemoryMalloc(sizeof(SMsgHead) + tlen);
   if (buf == NULL) {
-    goto FAIL;
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
   }
 
   ((SMsgHead*)buf)->vgId = htonl(vgId);
@@ -310,24 +314,50 @@ int32_t streamDispatchOneDataReq(SStreamTask* pTask, const SStreamDispatchReq* p
 
   SEncoder encoder;
   tEncoderInit(&encoder, abuf, tlen);
-  if ((code = tEncodeStreamDispatchReq(&encoder, pReq)) < 0) {
-    goto FAIL;
-  }
+  code = tEncodeStreamDispatchReq(&encoder, pReq);
   tEncoderClear(&encoder);
+  if (code < 0) {
+    taosMemoryFree(buf);
+    return -1;
+  }
 
-  msg.contLen = tlen + sizeof(SMsgHead);
-  msg.pCont = buf;
-  msg.msgType = pTask->dispatchMsgType;
+  pMsg->seq = pReq->seq;
+  pMsg->contLen = sizeof(SMsgHead) + tlen;
+  pMsg->pCont = buf;
+  return 0;
+}
+
+static int32_t streamDispatchSendMsg(SStreamTask* pTask, const SStreamDispatchMsg* pMsg, int32_t downstreamTaskId,
+                                     SEpSet* pEpSet) {
+  void* buf = rpcMallocCont(pMsg->contLen);
+  if (buf == NULL) {
+    return -1;
+  }
+  memcpy(buf, pMsg->pCont, pMsg->contLen);
 
-  qDebug("dispatch from task %d to task %d node %d: data msg", pTask->taskId, pReq->taskId, vgId);
+  SRpcMsg msg = {
+      .msgType = pTask->dispatchMsgType,
+      .pCont = buf,
+      .contLen = pMsg->contLen,
+  };
 
-  tmsgSendReq(pEpSet, &msg);
+  qDebug("dispatch from task %d to task %d node %d: data msg, seq %" PRId64, pTask->taskId, downstreamTaskId,
+         ntohl(((SMsgHead*)buf)->vgId), pMsg->seq);
 
-  code = 0;
+  tmsgSendReq(pEpSet, &msg);
   return 0;
-FAIL:
-  if (buf) rpcFreeCont(buf);
-  return code;
+}
+
+// the msgs after the first one not sent are left to the retry timer, so they still arrive in seq order
+static void streamDispatchWindowSend(SStreamTask* pTask, SStreamDispatchWindow* pWin, const SStreamDispatchMsg* pMsg,
+                                     int32_t downstreamTaskId, SEpSet* pEpSet) {
+  if (pWin->retry) {
+    return;
+  }
+  if (streamDispatchSendMsg(pTask, pMsg, downstreamTaskId, pEpSet) < 0) {
+    pWin->retry = 1;
+    streamDispatchRetryLater(pTask);
+  }
 }
 
 int32_t streamSearchAndAddBlock(SStreamTask* pTask, SStreamDispatchReq* pReqs, SSDataBlock* pDataBlock, int32_t vgSz,
@@ -363,9 +393,6 @@ int32_t streamSearchAndAddBlock(SStreamTask* pTask, SStreamDispatchReq* pReqs, S
       if (streamAddBlockToDispatchMsg(pDataBlock, &pReqs[j]) < 0) {
         return -1;
       }
-      if (pReqs[j].blockNum == 0) {
-        atomic_add_fetch_32(&pTask->shuffleDispatcher.waitingRspCnt, 1);
-      }
       pReqs[j].blockNum++;
       found = true;
       break;
@@ -375,12 +402,24 @@ int32_t streamSearchAndAddBlock(SStreamTask* pTask, SStreamDispatchReq* pReqs, S
   return 0;
 }
 
+static void streamDispatchFreeMsgs(SStreamDispatchMsg* pMsgs, int32_t num) {
+  for (int32_t i = 0; i < num; i++) {
+    taosMemoryFree(pMsgs[i].pCont);
+  }
+  taosMemoryFree(pMsgs);
+}
+
+// the batch is encoded for all its downstream tasks before any msg is put into the windows, so a failure leaves the
+// batch to be dispatched again as a whole
 int32_t streamDispatchAllBlocks(SStreamTask* pTask, const SStreamDataBlock* pData) {
   int32_t code = -1;
   int32_t blockNum = taosArrayGetSize(pData->blocks);
   ASSERT(blockNum != 0);
 
   if (pTask->outputType == TASK_OUTPUT__FIXED_DISPATCH) {
+    SStreamDispatchWindow* pWin = &pTask->fixedEpDispatcher.window;
+    SStreamDispatchMsg     msg = {0};
+
     SStreamDispatchReq req = {
         .streamId = pTask->streamId,
         .dataSrcVgId = pData->srcVgId,
@@ -388,6 +427,8 @@ int32_t streamDispatchAllBlocks(SStreamTask* pTask, const SStreamDataBlock* pDat
         .upstreamChildId = pTask->selfChildId,
         .upstreamNodeId = pTask->nodeId,
         .blockNum = blockNum,
+        .session = pTask->dispatchSession,
+        .seq = pWin->seq + 1,
     };
 
     req.data = taosArrayInit(blockNum, sizeof(void*));
@@ -411,9 +452,12 @@ int32_t streamDispatchAllBlocks(SStreamTask* pTask, const SStreamDataBlock* pDat
     qDebug("dispatch from task %d (child id %d) to down stream task %d in vnode %d", pTask->taskId, pTask->selfChildId,
            downstreamTaskId, vgId);
 
-    if (streamDispatchOneDataReq(pTask, &req, vgId, pEpSet) < 0) {
+    if (streamDispatchEncodeReq(&req, vgId, &msg) < 0 || taosArrayPush(pWin->pUnacked, &msg) == NULL) {
+      taosMemoryFree(msg.pCont);
       goto FAIL_FIXED_DISPATCH;
     }
+    pWin->seq = msg.seq;
+    streamDispatchWindowSend(pTask, pWin, &msg, downstreamTaskId, pEpSet);
     code = 0;
   FAIL_FIXED_DISPATCH:
     taosArrayDestroyP(req.data, taosMemoryFree);
@@ -421,11 +465,11 @@ int32_t streamDispatchAllBlocks(SStreamTask* pTask, const SStreamDataBlock* pDat
     return code;
 
   } else if (pTask->outputType == TASK_OUTPUT__SHUFFLE_DISPATCH) {
-    int32_t rspCnt = atomic_load_32(&pTask->shuffleDispatcher.waitingRspCnt);
-    ASSERT(rspCnt == 0);
+    SArray*                vgInfo = pTask->shuffleDispatcher.dbInfo.pVgroupInfos;
+    int32_t                vgSz = taosArrayGetSize(vgInfo);
+    SStreamDispatchWindow* pWindows = pTask->shuffleDispatcher.pWindows;
+    SStreamDispatchMsg*    pMsgs = NULL;
 
-    SArray*             vgInfo = pTask->shuffleDispatcher.dbInfo.pVgroupInfos;
-    int32_t             vgSz = taosArrayGetSize(vgInfo);
     SStreamDispatchReq* pReqs = taosMemoryCalloc(vgSz, sizeof(SStreamDispatchReq));
     if (pReqs == NULL) {
       return -1;
@@ -438,6 +482,8 @@ int32_t streamDispatchAllBlocks(SStreamTask* pTask, const SStreamDataBlock* pDat
       pReqs[i].upstreamChildId = pTask->selfChildId;
       pReqs[i].upstreamNodeId = pTask->nodeId;
       pReqs[i].blockNum = 0;
+      pReqs[i].session = pTask->dispatchSession;
+      pReqs[i].seq = pWindows[i].seq + 1;
       pReqs[i].data = taosArrayInit(0, sizeof(void*));
       pReqs[i].dataLen = taosArrayInit(0, sizeof(int32_t));
       if (pReqs[i].data == NULL || pReqs[i].dataLen == NULL) {
@@ -456,9 +502,6 @@ int32_t streamDispatchAllBlocks(SStreamTask* pTask, const SStreamDataBlock* pDat
           if (streamAddBlockToDispatchMsg(pDataBlock, &pReqs[j]) < 0) {
             goto FAIL_SHUFFLE_DISPATCH;
           }
-          if (pReqs[j].blockNum == 0) {
-            atomic_add_fetch_32(&pTask->shuffleDispatcher.waitingRspCnt, 1);
-          }
           pReqs[j].blockNum++;
         }
         continue;
@@ -469,17 +512,38 @@ int32_t streamDispatchAllBlocks(SStreamTask* pTask, const SStreamDataBlock* pDat
       }
     }
 
+    pMsgs = taosMemoryCalloc(vgSz, sizeof(SStreamDispatchMsg));
+    if (pMsgs == NULL) {
+      goto FAIL_SHUFFLE_DISPATCH;
+    }
+    for (int32_t i = 0; i < vgSz; i++) {
+      SVgroupInfo* pVgInfo = taosArrayGet(vgInfo, i);
+      if (pReqs[i].blockNum > 0 && streamDispatchEncodeReq(&pReqs[i], pVgInfo->vgId, &pMsgs[i]) < 0) {
+        goto FAIL_SHUFFLE_DISPATCH;
+      }
+    }
+
+    // the windows have room for one more msg, checked before the batch is taken
     for (int32_t i = 0; i < vgSz; i++) {
-      if (pReqs[i].blockNum > 0) {
-        // send
+      if (pMsgs[i].pCont != NULL) {
+        taosArrayPush(pWindows[i].pUnacked, &pMsgs[i]);
+        pWindows[i].seq = pMsgs[i].seq;
+      }
+    }
+    for (int32_t i = 0; i < vgSz; i++) {
+      if (pMsgs[i].pCont != NULL) {
         SVgroupInfo* pVgInfo = taosArrayGet(vgInfo, i);
-        if (streamDispatchOneDataReq(pTask, &pReqs[i], pVgInfo->vgId, &pVgInfo->epSet) < 0) {
-          goto FAIL_SHUFFLE_DISPATCH;
-        }
+        streamDispatchWindowSend(pTask, &pWindows[i], &pMsgs[i], pVgInfo->taskId, &pVgInfo->epSet);
       }
     }
+    taosMemoryFree(pMsgs);
+    pMsgs = NULL;
     code = 0;
+
   FAIL_SHUFFLE_DISPATCH:
+    if (pMsgs) {
+      streamDispatchFreeMsgs(pMsgs, vgSz);
+    }
     if (pReqs) {
       for (int32_t i = 0; i < vgSz; i++) {
         taosArrayDestroyP(pReqs[i].data, taosMemoryFree);
@@ -492,34 +556,268 @@ int32_t streamDispatchAllBlocks(SStreamTask* pTask, const SStreamDataBlock* pDat
   return 0;
 }
 
-int32_t streamDispatch(SStreamTask* pTask) {
-  ASSERT(pTask->outputType == TASK_OUTPUT__FIXED_DISPATCH || pTask->outputType == TASK_OUTPUT__SHUFFLE_DISPATCH);
+bool streamTaskOutputFull(SStreamTask* pTask) {
+  if (pTask->outputType != TASK_OUTPUT__FIXED_DISPATCH && pTask->outputType != TASK_OUTPUT__SHUFFLE_DISPATCH) {
+    return false;
+  }
+  return taosQueueItemSize(pTask->outputQueue->queue) >= tsStreamQueueLimit;
+}
 
-  int8_t old =
-      atomic_val_compare_exchange_8(&pTask->outputStatus, TASK_OUTPUT_STATUS__NORMAL, TASK_OUTPUT_STATUS__WAIT);
-  if (old != TASK_OUTPUT_STATUS__NORMAL) {
-    return 0;
+bool streamDispatchBlocked(SStreamTask* pTask) {
+  return taosGetTimestampMs() < atomic_load_64(&pTask->dispatchBlockedUntil);
+}
+
+static SStreamDispatchWindow* streamDispatchWindowOf(SStreamTask* pTask, int32_t downstreamTaskId) {
+  if (pTask->outputType == TASK_OUTPUT__FIXED_DISPATCH) {
+    return pTask->fixedEpDispatcher.taskId == downstreamTaskId ? &pTask->fixedEpDispatcher.window : NULL;
+  }
+
+  if (pTask->shuffleDispatcher.pWindows == NULL) {
+    return NULL;
+  }
+  SArray* vgInfo = pTask->shuffleDispatcher.dbInfo.pVgroupInfos;
+  int32_t vgSz = taosArrayGetSize(vgInfo);
+  for (int32_t i = 0; i < vgSz; i++) {
+    SVgroupInfo* pVgInfo = taosArrayGet(vgInfo, i);
+    if (pVgInfo->taskId == downstreamTaskId) {
+      return &pTask->shuffleDispatcher.pWindows[i];
+    }
+  }
+  return NULL;
+}
+
+static bool streamDispatchWindowFull(const SStreamDispatchWindow* pWin) {
+  return taosArrayGetSize(pWin->pUnacked) >= tsStreamDispatchWindow;
+}
+
+// a batch may go to any downstream task, so it is taken only when all windows have room for it
+static bool streamDispatchHasCredit(SStreamTask* pTask) {
+  if (pTask->outputType == TASK_OUTPUT__FIXED_DISPATCH) {
+    return !streamDispatchWindowFull(&pTask->fixedEpDispatcher.window);
   }
 
-  SStreamDataBlock* pBlock = streamQueueNextItem(pTask->outputQueue);
-  if (pBlock == NULL) {
-    qDebug("stream stop dispatching since no output: task %d", pTask->taskId);
-    atomic_store_8(&pTask->outputStatus, TASK_OUTPUT_STATUS__NORMAL);
+  int32_t vgSz = taosArrayGetSize(pTask->shuffleDispatcher.dbInfo.pVgroupInfos);
+  for (int32_t i = 0; i < vgSz; i++) {
+    if (streamDispatchWindowFull(&pTask->shuffleDispatcher.pWindows[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static int32_t streamDispatchInitWindows(SStreamTask* pTask) {
+  if (pTask->dispatchSession == 0) {
+    pTask->dispatchSession = tGenIdPI64();
+  }
+
+  if (pTask->outputType == TASK_OUTPUT__FIXED_DISPATCH) {
+    SStreamDispatchWindow* pWin = &pTask->fixedEpDispatcher.window;
+    if (pWin->pUnacked == NULL) {
+      pWin->pUnacked = taosArrayInit(tsStreamDispatchWindow, sizeof(SStreamDispatchMsg));
+    }
+    return pWin->pUnacked == NULL ? -1 : 0;
+  }
+
+  if (pTask->shuffleDispatcher.pWindows != NULL) {
     return 0;
   }
-  ASSERT(pBlock->type == STREAM_INPUT__DATA_BLOCK);
+  int32_t                vgSz = taosArrayGetSize(pTask->shuffleDispatcher.dbInfo.pVgroupInfos);
+  SStreamDispatchWindow* pWindows = taosMemoryCalloc(vgSz, sizeof(SStreamDispatchWindow));
+  if (pWindows == NULL) {
+    return -1;
+  }
+  for (int32_t i = 0; i < vgSz; i++) {
+    pWindows[i].pUnacked = taosArrayInit(tsStreamDispatchWindow, sizeof(SStreamDispatchMsg));
+    if (pWindows[i].pUnacked == NULL) {
+      for (int32_t j = 0; j < i; j++) {
+        taosArrayDestroy(pWindows[j].pUnacked);
+      }
+      taosMemoryFree(pWindows);
+      return -1;
+    }
+  }
+  pTask->shuffleDispatcher.pWindows = pWindows;
+  return 0;
+}
+
+// the downstream task took all msgs up to seq
+static void streamDispatchWindowAck(SStreamDispatchWindow* pWin, int64_t seq) {
+  int32_t num = (int32_t)(seq - pWin->ackSeq);
+  for (int32_t i = 0; i < num; i++) {
+    SStreamDispatchMsg* pMsg = taosArrayGet(pWin->pUnacked, i);
+    taosMemoryFree(pMsg->pCont);
+  }
+  taosArrayPopFrontBatch(pWin->pUnacked, num);
+  pWin->ackSeq = seq;
+}
+
+static void streamDispatchWindowResend(SStreamTask* pTask, SStreamDispatchWindow* pWin, int32_t downstreamTaskId,
+                                       SEpSet* pEpSet) {
+  if (!pWin->retry) {
+    return;
+  }
+
+  pWin->retry = 0;
+  int32_t num = taosArrayGetSize(pWin->pUnacked);
+  for (int32_t i = 0; i < num; i++) {
+    if (streamDispatchSendMsg(pTask, taosArrayGet(pWin->pUnacked, i), downstreamTaskId, pEpSet) < 0) {
+      pWin->retry = 1;
+      streamDispatchRetryLater(pTask);
+      return;
+    }
+  }
+}
+
+static int64_t streamDataBlockEncodeSize(const SStreamDataBlock* pData) {
+  int64_t size = 0;
+  int32_t blockNum = taosArrayGetSize(pData->blocks);
+  for (int32_t i = 0; i < blockNum; i++) {
+    size += blockGetEncodeSize(taosArrayGet(pData->blocks, i));
+  }
+  return size;
+}
+
+// take the output blocks of the same source vgroup from the queue, until they fill up one dispatch msg
+static SStreamDataBlock* streamDispatchNextBatch(SStreamTask* pTask) {
+  SStreamQueue*     pQueue = pTask->outputQueue;
+  SStreamDataBlock* pBatch = streamQueueNextItem(pQueue);
+  if (pBatch == NULL) {
+    return NULL;
+  }
+  ASSERT(pBatch->type == STREAM_INPUT__DATA_BLOCK);
+  streamQueueProcessSuccess(pQueue);
+
+  int64_t budget = (int64_t)tsStreamDispatchBatchSize * 1024;
+  int64_t size = streamDataBlockEncodeSize(pBatch);
+  while (size < budget) {
+    SStreamDataBlock* pData = streamQueueNextItem(pQueue);
+    if (pData == NULL) {
+      break;
+    }
+    ASSERT(pData->type == STREAM_INPUT__DATA_BLOCK);
+
+    int64_t dataSize = streamDataBlockEncodeSize(pData);
+    if (pData->srcVgId != pBatch->srcVgId || size + dataSize > budget) {
+      // left in the queue for the next batch
+      streamQueueProcessFail(pQueue);
+      break;
+    }
+
+    if (taosArrayAddAll(pBatch->blocks, pData->blocks) == NULL) {
+      streamQueueProcessFail(pQueue);
+      break;
+    }
+    taosArrayDestroy(pData->blocks);
+    taosFreeQitem(pData);
+    streamQueueProcessSuccess(pQueue);
+    size += dataSize;
+  }
+
+  return pBatch;
+}
+
+static void streamDispatchResumeExec(SStreamTask* pTask) {
+  if (atomic_load_8(&pTask->execPaused) == 0 || streamTaskOutputFull(pTask)) {
+    return;
+  }
 
-  qDebug("stream dispatching: task %d", pTask->taskId);
+  int8_t paused = atomic_exchange_8(&pTask->execPaused, 0);
+  if (paused & STREAM_EXEC_PAUSED__INPUT) {
+    qDebug("task %d resume exec since output queue is drained", pTask->taskId);
+    streamSchedExec(pTask);
+  }
+  if (paused & STREAM_EXEC_PAUSED__RECOVER) {
+    qDebug("task %d resume recover scan since output queue is drained", pTask->taskId);
+    streamSchedRecoverStep1(pTask);
+  }
+}
+
+// the windows failed to some downstream tasks are sent again, then the dispatch goes on
+int32_t streamDispatchResend(SStreamTask* pTask) {
+  taosThreadMutexLock(&pTask->dispatchLock);
+  if (pTask->outputType == TASK_OUTPUT__FIXED_DISPATCH) {
+    if (pTask->fixedEpDispatcher.window.pUnacked != NULL) {
+      streamDispatchWindowResend(pTask, &pTask->fixedEpDispatcher.window, pTask->fixedEpDispatcher.taskId,
+                                 &pTask->fixedEpDispatcher.epSet);
+    }
+  } else if (pTask->shuffleDispatcher.pWindows != NULL) {
+    SArray* vgInfo = pTask->shuffleDispatcher.dbInfo.pVgroupInfos;
+    int32_t vgSz = taosArrayGetSize(vgInfo);
+    for (int32_t i = 0; i < vgSz; i++) {
+      SVgroupInfo* pVgInfo = taosArrayGet(vgInfo, i);
+      streamDispatchWindowResend(pTask, &pTask->shuffleDispatcher.pWindows[i], pVgInfo->taskId, &pVgInfo->epSet);
+    }
+  }
+  taosThreadMutexUnlock(&pTask->dispatchLock);
+
+  return streamDispatch(pTask);
+}
+
+void streamDispatchProcessRsp(SStreamTask* pTask, int32_t downstreamTaskId, int64_t seq, bool failed) {
+  taosThreadMutexLock(&pTask->dispatchLock);
+  SStreamDispatchWindow* pWin = streamDispatchWindowOf(pTask, downstreamTaskId);
+  if (pWin == NULL || seq <= pWin->ackSeq || seq > pWin->seq) {
+    taosThreadMutexUnlock(&pTask->dispatchLock);
+    qWarn("task %d ignore dispatch rsp from task %d, seq %" PRId64 " since not waiting for it", pTask->taskId,
+          downstreamTaskId, seq);
+    return;
+  }
+
+  if (failed) {
+    // the downstream task takes no msg after the failed one, so all msgs not acked are sent again in order
+    if (!pWin->retry) {
+      qDebug("task %d dispatch to task %d failed at seq %" PRId64 ", retry later", pTask->taskId, downstreamTaskId,
+             seq);
+      pWin->retry = 1;
+      streamDispatchRetryLater(pTask);
+    }
+    taosThreadMutexUnlock(&pTask->dispatchLock);
+    return;
+  }
+
+  streamDispatchWindowAck(pWin, seq);
+  taosThreadMutexUnlock(&pTask->dispatchLock);
+
+  streamDispatchResumeExec(pTask);
+  // when blocked, the timer started by the rsp dispatches the next batch
+  streamDispatch(pTask);
+}
+
+// batches are taken from the output queue while all windows have room, a batch failed to be put into the windows is
+// taken again before the next one
+int32_t streamDispatch(SStreamTask* pTask) {
+  ASSERT(pTask->outputType == TASK_OUTPUT__FIXED_DISPATCH || pTask->outputType == TASK_OUTPUT__SHUFFLE_DISPATCH);
 
   int32_t code = 0;
-  if (streamDispatchAllBlocks(pTask, pBlock) < 0) {
+  taosThreadMutexLock(&pTask->dispatchLock);
+  if (streamDispatchInitWindows(pTask) < 0) {
+    qError("task %d failed to init dispatch windows, retry later", pTask->taskId);
+    streamDispatchRetryLater(pTask);
     code = -1;
-    streamQueueProcessFail(pTask->outputQueue);
-    atomic_store_8(&pTask->outputStatus, TASK_OUTPUT_STATUS__NORMAL);
-    goto FREE;
   }
-FREE:
-  taosArrayDestroyEx(pBlock->blocks, (FDelete)blockDataFreeRes);
-  taosFreeQitem(pBlock);
+
+  while (code == 0 && !streamDispatchBlocked(pTask) && streamDispatchHasCredit(pTask)) {
+    SStreamDataBlock* pBatch = pTask->pDispatchData;
+    pTask->pDispatchData = NULL;
+    if (pBatch == NULL) {
+      pBatch = streamDispatchNextBatch(pTask);
+    }
+    if (pBatch == NULL) {
+      break;
+    }
+
+    qDebug("stream dispatching: task %d, blocks %d", pTask->taskId, (int32_t)taosArrayGetSize(pBatch->blocks));
+
+    if (streamDispatchAllBlocks(pTask, pBatch) < 0) {
+      qError("task %d failed to dispatch since %s, retry later", pTask->taskId, terrstr());
+      pTask->pDispatchData = pBatch;
+      streamDispatchRetryLater(pTask);
+      code = -1;
+      break;
+    }
+    taosArrayDestroyEx(pBatch->blocks, (FDelete)blockDataFreeRes);
+    taosFreeQitem(pBatch);
+  }
+  taosThreadMutexUnlock(&pTask->dispatchLock);
   return code;
 }
@@ -96,7 +96,23 @@ static int32_t streamTaskExecImpl(SStreamTask* pTask, const void* data, SArray*
   return 0;
 }
 
-int32_t streamScanExec(SStreamTask* pTask, int32_t batchSz) {
+// resumed by the dispatch once the output queue is drained, in the way given by flag
+static bool streamTaskPauseExec(SStreamTask* pTask, int8_t flag) {
+  if (!streamTaskOutputFull(pTask)) {
+    return false;
+  }
+
+  atomic_or_fetch_8(&pTask->execPaused, flag);
+  // the output queue may be drained before the flag is seen by the dispatch
+  if (streamTaskOutputFull(pTask)) {
+    return true;
+  }
+  // go on, unless the dispatch has taken the flag and scheduled the exec again meanwhile
+  int8_t old = atomic_fetch_and_8(&pTask->execPaused, ~flag);
+  return (old & flag) == 0;
+}
+
+int32_t streamScanExec(SStreamTask* pTask, int32_t batchSz, bool* pPaused) {
   ASSERT(pTask->taskLevel == TASK_LEVEL__SOURCE);
 
   void* exec = pTask->exec.executor;
@@ -105,6 +121,14 @@ int32_t streamScanExec(SStreamTask* pTask, int32_t batchSz) {
   bool finished = false;
 
   while (1) {
+    // the history data is not consumed from a queue, so the scan gives up the thread and is scheduled again once
+    // the backlog is dispatched
+    if (pPaused != NULL && streamTaskPauseExec(pTask, STREAM_EXEC_PAUSED__RECOVER)) {
+      qDebug("task %d scan exec paused since output queue is full", pTask->taskId);
+      *pPaused = true;
+      return 0;
+    }
+
     SArray* pRes = taosArrayInit(0, sizeof(SSDataBlock));
     if (pRes == NULL) {
       terrno = TSDB_CODE_OUT_OF_MEMORY;
@@ -208,6 +232,11 @@ int32_t streamBatchExec(SStreamTask* pTask, int32_t batchLimit) {
 
 int32_t streamExecForAll(SStreamTask* pTask) {
   while (1) {
+    if (streamTaskPauseExec(pTask, STREAM_EXEC_PAUSED__INPUT)) {
+      qDebug("stream task %d exec paused since output queue is full", pTask->taskId);
+      break;
+    }
+
     int32_t batchCnt = 1;
     void*   input = NULL;
     while (1) {
@@ -304,7 +333,9 @@ int32_t streamTryExec(SStreamTask* pTask) {
     }
     atomic_store_8(&pTask->schedStatus, TASK_SCHED_STATUS__INACTIVE);
 
-    if (!taosQueueEmpty(pTask->inputQueue->queue)) {
+    // a paused task is scheduled again by the dispatch
+    bool paused = atomic_load_8(&pTask->execPaused) & STREAM_EXEC_PAUSED__INPUT;
+    if (!paused && streamQueueHasItem(pTask->inputQueue)) {
       streamSchedExec(pTask);
     }
   }
@@ -21,28 +21,10 @@ int32_t streamTaskLaunchRecover(SStreamTask* pTask, int64_t version) {
     atomic_store_8(&pTask->taskStatus, TASK_STATUS__RECOVER_PREPARE);
     streamSetParamForRecover(pTask);
     streamSourceRecoverPrepareStep1(pTask, version);
-
-    SStreamRecoverStep1Req req;
-    streamBuildSourceRecover1Req(pTask, &req);
-    int32_t len = sizeof(SStreamRecoverStep1Req);
-
-    void* serializedReq = rpcMallocCont(len);
-    if (serializedReq == NULL) {
+    if (streamSchedRecoverStep1(pTask) < 0) {
       return -1;
     }
 
-    memcpy(serializedReq, &req, len);
-
-    SRpcMsg rpcMsg = {
-        .contLen = len,
-        .pCont = serializedReq,
-        .msgType = TDMT_VND_STREAM_RECOVER_NONBLOCKING_STAGE,
-    };
-
-    if (tmsgPutToQueue(pTask->pMsgCb, STREAM_QUEUE, &rpcMsg) < 0) {
-      /*ASSERT(0);*/
-    }
-
   } else if (pTask->taskLevel == TASK_LEVEL__AGG) {
     atomic_store_8(&pTask->taskStatus, TASK_STATUS__NORMAL);
     streamSetParamForRecover(pTask);
@@ -53,6 +35,30 @@ int32_t streamTaskLaunchRecover(SStreamTask* pTask, int64_t version) {
   return 0;
 }
 
+int32_t streamSchedRecoverStep1(SStreamTask* pTask) {
+  SStreamRecoverStep1Req req;
+  streamBuildSourceRecover1Req(pTask, &req);
+  int32_t len = sizeof(SStreamRecoverStep1Req);
+
+  void* serializedReq = rpcMallocCont(len);
+  if (serializedReq == NULL) {
+    return -1;
+  }
+
+  memcpy(serializedReq, &req, len);
+
+  SRpcMsg rpcMsg = {
+      .contLen = len,
+      .pCont = serializedReq,
+      .msgType = TDMT_VND_STREAM_RECOVER_NONBLOCKING_STAGE,
+  };
+
+  if (tmsgPutToQueue(pTask->pMsgCb, STREAM_QUEUE, &rpcMsg) < 0) {
+    /*ASSERT(0);*/
+  }
+  return 0;
+}
+
 // checkstatus
 int32_t streamTaskCheckDownstream(SStreamTask* pTask, int64_t version) {
   SStreamTaskCheckReq req = {
@@ -185,9 +191,9 @@ int32_t streamBuildSourceRecover1Req(SStreamTask* pTask, SStreamRecoverStep1Req*
   return 0;
 }
 
-int32_t streamSourceRecoverScanStep1(SStreamTask* pTask) {
-  //
-  return streamScanExec(pTask, 100);
+int32_t streamSourceRecoverScanStep1(SStreamTask* pTask, bool* pPaused) {
+  *pPaused = false;
+  return streamScanExec(pTask, 100, pPaused);
 }
 
 int32_t streamBuildSourceRecover2Req(SStreamTask* pTask, SStreamRecoverStep2Req* pReq) {
@@ -201,7 +207,8 @@ int32_t streamSourceRecoverScanStep2(SStreamTask* pTask, int64_t ver) {
   void* exec = pTask->exec.executor;
   if (qStreamSourceRecoverStep2(exec, ver) < 0) {
   }
-  return streamScanExec(pTask, 100);
+  // only the data written during step 1 is left, and the write queue cannot be given up, so step 2 never pauses
+  return streamScanExec(pTask, 100, NULL);
 }
 
 int32_t streamDispatchRecoverFinishReq(SStreamTask* pTask) {
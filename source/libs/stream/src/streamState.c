@@ -17,6 +17,7 @@
 #include "streamInc.h"
 #include "tcommon.h"
 #include "tcompare.h"
+#include "tglobal.h"
 #include "ttimer.h"
 
 // todo refactor
@@ -148,7 +149,7 @@ SStreamState* streamStateOpen(char* path, SStreamTask* pTask, bool specPath, int
   }
   taosCloseFile(&pCfgFile);
 
-  if (tdbOpen(statePath, szPage, pages, &pState->pTdbState->db, 1) < 0) {
+  if (tdbOpenEx(statePath, szPage, pages, &pState->pTdbState->db, 1, tsTdbWalMode ? TDB_OPEN_WAL : 0) < 0) {
     goto _err;
   }
 
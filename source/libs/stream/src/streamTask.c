@@ -162,24 +162,46 @@ int32_t tDecodeSStreamTask(SDecoder* pDecoder, SStreamTask* pTask) {
   return 0;
 }
 
+static void tFreeStreamDispatchWindow(SStreamDispatchWindow* pWin) {
+  int32_t num = taosArrayGetSize(pWin->pUnacked);
+  for (int32_t i = 0; i < num; i++) {
+    SStreamDispatchMsg* pMsg = taosArrayGet(pWin->pUnacked, i);
+    taosMemoryFree(pMsg->pCont);
+  }
+  taosArrayDestroy(pWin->pUnacked);
+}
+
 void tFreeSStreamTask(SStreamTask* pTask) {
   qDebug("free stream task %d", pTask->taskId);
   if (pTask->inputQueue) streamQueueClose(pTask->inputQueue);
   if (pTask->outputQueue) streamQueueClose(pTask->outputQueue);
+  if (pTask->pDispatchData) streamFreeQitem((SStreamQueueItem*)pTask->pDispatchData);
   if (pTask->exec.qmsg) taosMemoryFree(pTask->exec.qmsg);
   if (pTask->exec.executor) qDestroyTask(pTask->exec.executor);
   taosArrayDestroyP(pTask->childEpInfo, taosMemoryFree);
+  taosHashCleanup(pTask->pUpstreamSeq);
+  if (pTask->outputType == TASK_OUTPUT__FIXED_DISPATCH) {
+    tFreeStreamDispatchWindow(&pTask->fixedEpDispatcher.window);
+  }
   if (pTask->outputType == TASK_OUTPUT__TABLE) {
     tDeleteSSchemaWrapper(pTask->tbSink.pSchemaWrapper);
     taosMemoryFree(pTask->tbSink.pTSchema);
   }
   if (pTask->outputType == TASK_OUTPUT__SHUFFLE_DISPATCH) {
     taosArrayDestroy(pTask->shuffleDispatcher.dbInfo.pVgroupInfos);
+    if (pTask->shuffleDispatcher.pWindows) {
+      int32_t vgSz = taosArrayGetSize(pTask->shuffleDispatcher.dbInfo.pVgroupInfos);
+      for (int32_t i = 0; i < vgSz; i++) {
+        tFreeStreamDispatchWindow(&pTask->shuffleDispatcher.pWindows[i]);
+      }
+      taosMemoryFree(pTask->shuffleDispatcher.pWindows);
+    }
     taosArrayDestroy(pTask->checkReqIds);
     pTask->checkReqIds = NULL;
   }
 
   if (pTask->pState) streamStateClose(pTask->pState);
+  taosThreadMutexDestroy(&pTask->dispatchLock);
 
   taosMemoryFree(pTask);
 }
@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "streamInc.h"
+#include "tdatablock.h"
+#include "tglobal.h"
+#include "tmsgcb.h"
+
+namespace {
+
+const int32_t streamDispatchTestUpTaskId = 1;
+const int32_t streamDispatchTestDownTaskId = 2;
+
+struct SDispatchTestSent {
+  int32_t     taskId;
+  int32_t     srcVgId;
+  int32_t     blockNum;
+  int64_t     seq;
+  std::string msg;  // the encoded req, delivered to a downstream task by the test
+};
+
+std::mutex                      streamDispatchTestMutex;
+std::vector<SDispatchTestSent>  streamDispatchTestSent;
+std::vector<SStreamDispatchRsp> streamDispatchTestRsp;
+int32_t                         streamDispatchTestRecoverNum = 0;
+
+// dispatch reqs are recorded instead of being sent, the rsp is given by the test
+int32_t streamDispatchTestSendReq(const SEpSet *pEpSet, SRpcMsg *pMsg) {
+  SStreamDispatchReq req = {0};
+  SDecoder           decoder;
+  tDecoderInit(&decoder, (uint8_t *)POINTER_SHIFT(pMsg->pCont, sizeof(SMsgHead)), pMsg->contLen - sizeof(SMsgHead));
+  EXPECT_EQ(tDecodeStreamDispatchReq(&decoder, &req), 0);
+  tDecoderClear(&decoder);
+
+  {
+    std::lock_guard<std::mutex> lock(streamDispatchTestMutex);
+    streamDispatchTestSent.push_back(
+        {req.taskId, req.dataSrcVgId, req.blockNum, req.seq, std::string((const char *)pMsg->pCont, pMsg->contLen)});
+  }
+  tDeleteStreamDispatchReq(&req);
+  rpcFreeCont(pMsg->pCont);
+  return 0;
+}
+
+void streamDispatchTestSendRsp(SRpcMsg *pMsg) {
+  SStreamDispatchRsp rsp = *(SStreamDispatchRsp *)POINTER_SHIFT(pMsg->pCont, sizeof(SMsgHead));
+  streamDispatchTestRsp.push_back(rsp);
+  rpcFreeCont(pMsg->pCont);
+}
+
+int32_t streamDispatchTestPutToQueue(void *pMgmt, EQueueType qtype, SRpcMsg *pMsg) {
+  if (pMsg->msgType == TDMT_VND_STREAM_RECOVER_NONBLOCKING_STAGE) {
+    streamDispatchTestRecoverNum++;
+  }
+  rpcFreeCont(pMsg->pCont);
+  return 0;
+}
+
+class StreamDispatchTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() { ASSERT_EQ(streamInit(), 0); }
+  static void TearDownTestSuite() { streamCleanUp(); }
+
+  void SetUp() override {
+    streamDispatchTestSent.clear();
+    streamDispatchTestRsp.clear();
+    streamDispatchTestRecoverNum = 0;
+    oriWindow_ = tsStreamDispatchWindow;
+
+    SMsgCb msgCb = {0};
+    msgCb.sendReqFp = streamDispatchTestSendReq;
+    msgCb.sendRspFp = streamDispatchTestSendRsp;
+    tmsgSetDefault(&msgCb);
+    msgCb_.mgmt = (void *)0x1;
+    msgCb_.putToQueueFp = streamDispatchTestPutToQueue;
+
+    pTask_ = (SStreamTask *)taosMemoryCalloc(1, sizeof(SStreamTask));
+    pTask_->taskId = streamDispatchTestUpTaskId;
+    pTask_->nodeId = 1;
+    pTask_->taskLevel = TASK_LEVEL__SOURCE;
+    pTask_->taskStatus = TASK_STATUS__NORMAL;
+    pTask_->outputType = TASK_OUTPUT__FIXED_DISPATCH;
+    pTask_->outputStatus = TASK_OUTPUT_STATUS__NORMAL;
+    pTask_->outputQueue = streamQueueOpen();
+    pTask_->dispatchMsgType = TDMT_STREAM_TASK_DISPATCH;
+    pTask_->fixedEpDispatcher.taskId = streamDispatchTestDownTaskId;
+    pTask_->fixedEpDispatcher.nodeId = 2;
+    pTask_->pMsgCb = &msgCb_;
+    pTask_->refCnt = 1;
+    taosThreadMutexInit(&pTask_->dispatchLock, NULL);
+  }
+
+  void TearDown() override {
+    // retry timers hold a ref of the task
+    for (int32_t i = 0; i < 100 && atomic_load_32(&pTask_->refCnt) > 1; ++i) {
+      taosMsleep(10);
+    }
+    tFreeSStreamTask(pTask_);
+    tsStreamDispatchWindow = oriWindow_;
+  }
+
+  // one block of one row, batches of different source vgroups are not coalesced
+  void output(int32_t srcVgId) {
+    SSDataBlock    *pBlock = createDataBlock();
+    SColumnInfoData col = createColumnInfoData(TSDB_DATA_TYPE_INT, sizeof(int32_t), 1);
+    blockDataAppendColInfo(pBlock, &col);
+    blockDataEnsureCapacity(pBlock, 1);
+    colDataAppend((SColumnInfoData *)taosArrayGet(pBlock->pDataBlock, 0), 0, (const char *)&srcVgId, false);
+    pBlock->info.rows = 1;
+
+    SStreamDataBlock *pData = (SStreamDataBlock *)taosAllocateQitem(sizeof(SStreamDataBlock), DEF_QITEM, 0);
+    pData->type = STREAM_INPUT__DATA_BLOCK;
+    pData->srcVgId = srcVgId;
+    pData->blocks = taosArrayInit(1, sizeof(SSDataBlock));
+    taosArrayPush(pData->blocks, pBlock);
+    taosMemoryFree(pBlock);
+    streamTaskOutput(pTask_, pData);
+  }
+
+  void rsp(int8_t inputStatus, int64_t seq, int32_t code = 0) {
+    SStreamDispatchRsp rsp = {0};
+    rsp.upstreamTaskId = htonl(streamDispatchTestUpTaskId);
+    rsp.downstreamTaskId = htonl(streamDispatchTestDownTaskId);
+    rsp.inputStatus = inputStatus;
+    rsp.seq = htobe64(seq);
+    streamProcessDispatchRsp(pTask_, &rsp, code);
+  }
+
+  size_t sentNum() {
+    std::lock_guard<std::mutex> lock(streamDispatchTestMutex);
+    return streamDispatchTestSent.size();
+  }
+
+  // the retry is sent by the timer
+  bool waitSentNum(size_t num) {
+    for (int32_t i = 0; i < 100 && sentNum() < num; ++i) {
+      taosMsleep(10);
+    }
+    return sentNum() == num;
+  }
+
+  SDispatchTestSent sent(size_t i) {
+    std::lock_guard<std::mutex> lock(streamDispatchTestMutex);
+    return streamDispatchTestSent[i];
+  }
+
+  SStreamDispatchWindow *window() { return &pTask_->fixedEpDispatcher.window; }
+
+  int32_t      oriWindow_ = 0;
+  SMsgCb       msgCb_ = {0};
+  SStreamTask *pTask_ = nullptr;
+};
+
+// a downstream task taking the recorded dispatch msgs in the order given by the test
+class StreamDispatchTestDownstream {
+ public:
+  explicit StreamDispatchTestDownstream(SMsgCb *pMsgCb) {
+    pTask_ = (SStreamTask *)taosMemoryCalloc(1, sizeof(SStreamTask));
+    pTask_->taskId = streamDispatchTestDownTaskId;
+    pTask_->nodeId = 2;
+    pTask_->taskLevel = TASK_LEVEL__AGG;
+    pTask_->outputType = TASK_OUTPUT__TABLE;
+    pTask_->schedStatus = TASK_SCHED_STATUS__WAITING;
+    pTask_->inputQueue = streamQueueOpen();
+    pTask_->pMsgCb = pMsgCb;
+    taosThreadMutexInit(&pTask_->dispatchLock, NULL);
+  }
+  ~StreamDispatchTestDownstream() { tFreeSStreamTask(pTask_); }
+
+  // rsp with the input status
+  int8_t deliver(const SDispatchTestSent &sent, int64_t session = 0) {
+    SStreamDispatchReq req = {0};
+    SDecoder           decoder;
+    tDecoderInit(&decoder, (uint8_t *)sent.msg.data() + sizeof(SMsgHead), sent.msg.size() - sizeof(SMsgHead));
+    EXPECT_EQ(tDecodeStreamDispatchReq(&decoder, &req), 0);
+    tDecoderClear(&decoder);
+    if (session != 0) {
+      req.session = session;
+    }
+
+    SRpcMsg msg = {0};
+    streamProcessDispatchReq(pTask_, &req, &msg, false);
+    SStreamDispatchRsp rsp = streamDispatchTestRsp.back();
+    EXPECT_EQ(be64toh(rsp.seq), sent.seq);
+    return rsp.inputStatus;
+  }
+
+  // the source vgroups of the data taken, in order
+  std::vector<int32_t> taken() {
+    std::vector<int32_t> srcVgIds;
+    while (1) {
+      SStreamDataBlock *pData = (SStreamDataBlock *)streamQueueNextItem(pTask_->inputQueue);
+      if (pData == nullptr) break;
+      streamQueueProcessSuccess(pTask_->inputQueue);
+      srcVgIds.push_back(pData->srcVgId);
+      streamFreeQitem((SStreamQueueItem *)pData);
+    }
+    return srcVgIds;
+  }
+
+ private:
+  SStreamTask *pTask_ = nullptr;
+};
+
+}  // namespace
+
+TEST_F(StreamDispatchTest, windowBounded) {
+  tsStreamDispatchWindow = 2;
+
+  output(1);
+  output(2);
+  output(3);
+  output(3);
+  ASSERT_EQ(sentNum(), 2);
+  EXPECT_EQ(sent(0).taskId, streamDispatchTestDownTaskId);
+  EXPECT_EQ(sent(0).srcVgId, 1);
+  EXPECT_EQ(sent(0).seq, 1);
+  EXPECT_EQ(sent(1).srcVgId, 2);
+  EXPECT_EQ(sent(1).seq, 2);
+
+  // the window is full, the next batch waits for a rsp and takes all output of the same source vgroup
+  rsp(TASK_INPUT_STATUS__NORMAL, 1);
+  ASSERT_EQ(sentNum(), 3);
+  EXPECT_EQ(sent(2).srcVgId, 3);
+  EXPECT_EQ(sent(2).blockNum, 2);
+  EXPECT_EQ(sent(2).seq, 3);
+
+  // acks are cumulative, since the downstream task takes the msgs in seq order
+  rsp(TASK_INPUT_STATUS__NORMAL, 3);
+  EXPECT_EQ(window()->ackSeq, 3);
+  EXPECT_EQ(taosArrayGetSize(window()->pUnacked), 0);
+
+  // a rsp not waited for is ignored
+  rsp(TASK_INPUT_STATUS__NORMAL, 2);
+  rsp(TASK_INPUT_STATUS__NORMAL, 4);
+  EXPECT_EQ(sentNum(), 3);
+  EXPECT_EQ(window()->ackSeq, 3);
+}
+
+TEST_F(StreamDispatchTest, failedMsgsResentInOrder) {
+  output(1);
+  output(2);
+  output(3);
+  ASSERT_EQ(sentNum(), 3);
+
+  // refused by the downstream task, all msgs not acked are sent again in seq order
+  rsp(TASK_INPUT_STATUS__FAILED, 2);
+  ASSERT_TRUE(waitSentNum(6));
+  for (size_t i = 3; i < 6; ++i) {
+    EXPECT_EQ(sent(i).seq, (int64_t)(i - 2));
+    EXPECT_EQ(sent(i).srcVgId, (int32_t)(i - 2));
+  }
+
+  rsp(TASK_INPUT_STATUS__NORMAL, 3);
+  EXPECT_EQ(taosArrayGetSize(window()->pUnacked), 0);
+
+  // lost on the way
+  output(4);
+  ASSERT_EQ(sentNum(), 7);
+  rsp(TASK_INPUT_STATUS__NORMAL, 4, TSDB_CODE_RPC_BROKEN_LINK);
+  ASSERT_TRUE(waitSentNum(8));
+  EXPECT_EQ(sent(7).seq, 4);
+  EXPECT_EQ(sent(7).srcVgId, 4);
+
+  rsp(TASK_INPUT_STATUS__NORMAL, 4);
+  EXPECT_EQ(window()->ackSeq, 4);
+  EXPECT_EQ(taosArrayGetSize(window()->pUnacked), 0);
+}
+
+TEST_F(StreamDispatchTest, downstreamTakesInSeqOrderOnce) {
+  output(1);
+  output(2);
+  output(3);
+  ASSERT_EQ(sentNum(), 3);
+
+  StreamDispatchTestDownstream down(&msgCb_);
+  EXPECT_EQ(down.deliver(sent(0)), TASK_INPUT_STATUS__NORMAL);
+  // msg 2 is lost, so msg 3 is refused
+  EXPECT_EQ(down.deliver(sent(2)), TASK_INPUT_STATUS__FAILED);
+  // sent again after the failure, msg 1 is acked but not taken twice
+  EXPECT_EQ(down.deliver(sent(0)), TASK_INPUT_STATUS__NORMAL);
+  EXPECT_EQ(down.deliver(sent(1)), TASK_INPUT_STATUS__NORMAL);
+  EXPECT_EQ(down.deliver(sent(2)), TASK_INPUT_STATUS__NORMAL);
+  EXPECT_EQ(down.taken(), std::vector<int32_t>({1, 2, 3}));
+
+  // a restarted upstream task numbers its msgs from 1 again
+  int64_t session = pTask_->dispatchSession + 1;
+  EXPECT_EQ(down.deliver(sent(1), session), TASK_INPUT_STATUS__FAILED);
+  EXPECT_EQ(down.deliver(sent(0), session), TASK_INPUT_STATUS__NORMAL);
+  EXPECT_EQ(down.taken(), std::vector<int32_t>({1}));
+}
+
+TEST_F(StreamDispatchTest, pausedRecoverRescheduled) {
+  int32_t oriQueueLimit = tsStreamQueueLimit;
+  tsStreamQueueLimit = 2;
+  tsStreamDispatchWindow = 1;
+
+  output(1);
+  output(2);
+  output(3);
+  ASSERT_TRUE(streamTaskOutputFull(pTask_));
+  // as left by the recover scan that found the output queue full
+  pTask_->execPaused = STREAM_EXEC_PAUSED__RECOVER;
+
+  rsp(TASK_INPUT_STATUS__NORMAL, 1);
+  EXPECT_EQ(streamDispatchTestRecoverNum, 0);
+
+  // the recover scan is posted again once the output queue is below the limit, not polled for
+  rsp(TASK_INPUT_STATUS__NORMAL, 2);
+  EXPECT_EQ(streamDispatchTestRecoverNum, 1);
+  EXPECT_EQ(pTask_->execPaused, 0);
+
+  rsp(TASK_INPUT_STATUS__NORMAL, 3);
+  EXPECT_EQ(sentNum(), 3);
+  EXPECT_EQ(streamDispatchTestRecoverNum, 1);
+
+  tsStreamQueueLimit = oriQueueLimit;
+}
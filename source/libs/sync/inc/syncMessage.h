@@ -219,7 +219,7 @@ typedef struct SyncSnapshotRsp {
   int32_t   ack;
   int32_t   code;
   SyncIndex snapBeginIndex;  // when ack = SYNC_SNAPSHOT_SEQ_BEGIN, it's valid
-  int16_t   reserved;
+  int16_t   caps;            // SYNC_SNAPSHOT_CAP_* of the receiver, valid in the rsp of the prep msg
 } SyncSnapshotRsp;
 
 typedef struct SyncLeaderTransfer {
@@ -594,6 +594,7 @@ _SEND_REPLY:
   pRspMsg->ack = pMsg->seq;  // receiver maybe already closed
   pRspMsg->code = code;
   pRspMsg->snapBeginIndex = syncNodeGetSnapBeginIndex(pSyncNode);
+  pRspMsg->caps = SYNC_SNAPSHOT_CAPS;
 
   // send msg
   syncLogSendSyncSnapshotRsp(pSyncNode, pRspMsg, "snapshot receiver pre-snapshot");
@@ -850,9 +851,11 @@ static int32_t syncNodeOnSnapshotPrepRsp(SSyncNode *pSyncNode, SSyncSnapshotSend
   // prepare <begin, end>
   pSender->snapshotParam.start = pMsg->snapBeginIndex;
   pSender->snapshotParam.end = snapshot.lastApplyIndex;
+  pSender->snapshotParam.caps = pMsg->caps & SYNC_SNAPSHOT_CAPS;
 
-  sSInfo(pSender, "prepare snapshot, recv-begin:%" PRId64 ", snapshot.last:%" PRId64 ", snapshot.term:%" PRId64,
-         pMsg->snapBeginIndex, snapshot.lastApplyIndex, snapshot.lastApplyTerm);
+  sSInfo(pSender,
+         "prepare snapshot, recv-begin:%" PRId64 ", snapshot.last:%" PRId64 ", snapshot.term:%" PRId64 ", caps:0x%x",
+         pMsg->snapBeginIndex, snapshot.lastApplyIndex, snapshot.lastApplyTerm, pSender->snapshotParam.caps);
 
   if (pMsg->snapBeginIndex > snapshot.lastApplyIndex) {
     sSError(pSender, "prepare snapshot failed since beginIndex:%" PRId64 " larger than applyIndex:%" PRId64,
@@ -32,7 +32,10 @@ typedef struct STBC TBC;
 typedef struct STxn TXN;
 
 // TDB
+#define TDB_OPEN_WAL 0x1  // commit through a write-ahead log instead of the rollback journal
+
 int32_t tdbOpen(const char *dbname, int szPage, int pages, TDB **ppDb, int8_t rollback);
+int32_t tdbOpenEx(const char *dbname, int szPage, int pages, TDB **ppDb, int8_t rollback, int32_t flags);
 int32_t tdbClose(TDB *pDb);
 int32_t tdbBegin(TDB *pDb, TXN **pTxn, void *(*xMalloc)(void *, size_t), void (*xFree)(void *, void *), void *xArg,
                  int flags);
@@ -16,6 +16,10 @@
 #include "tdbInt.h"
 
 int32_t tdbOpen(const char *dbname, int32_t szPage, int32_t pages, TDB **ppDb, int8_t rollback) {
+  return tdbOpenEx(dbname, szPage, pages, ppDb, rollback, 0);
+}
+
+int32_t tdbOpenEx(const char *dbname, int32_t szPage, int32_t pages, TDB **ppDb, int8_t rollback, int32_t flags) {
   TDB *pDb;
   int  dsize;
   int  zsize;
@@ -48,6 +52,7 @@ int32_t tdbOpen(const char *dbname, int32_t szPage, int32_t pages, TDB **ppDb, i
   pDb->jnName[dsize + 1 + strlen(TDB_JOURNAL_NAME)] = '\0';
 
   pDb->jfd = -1;
+  pDb->walMode = TDB_FLAG_HAS(flags, TDB_OPEN_WAL);
 
   ret = tdbPCacheOpen(szPage, pages, &(pDb->pCache));
   if (ret < 0) {
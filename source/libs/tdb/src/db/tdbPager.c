@@ -143,6 +143,7 @@ static int tdbPagerInitPage(SPager *pPager, SPage *pPage, int (*initPage)(SPage
                             u8 loadPage);
 static int tdbPagerWritePageToJournal(SPager *pPager, SPage *pPage);
 static int tdbPagerPWritePageToDB(SPager *pPager, SPage *pPage);
+static void tdbPagerDropDirtyPages(SPager *pPager, TXN *pTxn);
 
 static FORCE_INLINE int32_t pageCmpFn(const SRBTreeNode *lhs, const SRBTreeNode *rhs) {
   SPage *pPageL = (SPage *)(((uint8_t *)lhs) - offsetof(SPage, node));
@@ -160,7 +161,7 @@ static FORCE_INLINE int32_t pageCmpFn(const SRBTreeNode *lhs, const SRBTreeNode
   }
 }
 
-int tdbPagerOpen(SPCache *pCache, const char *fileName, SPager **ppPager) {
+int tdbPagerOpen(SPCache *pCache, const char *fileName, int8_t walMode, SPager **ppPager) {
   uint8_t *pPtr;
   SPager  *pPager;
   int      fsize;
@@ -206,6 +207,15 @@ int tdbPagerOpen(SPCache *pCache, const char *fileName, SPager **ppPager) {
 
   // pPager->jfd = -1;
   pPager->pageSize = tdbPCacheGetPageSize(pCache);
+
+  // replay the wal left over before the size of the db file is taken
+  ret = tdbWalOpen(pPager, walMode);
+  if (ret < 0) {
+    tdbOsClose(pPager->fd);
+    tdbOsFree(pPager);
+    return -1;
+  }
+
   // pPager->dbOrigSize
   ret = tdbGetFileSize(pPager->fd, pPager->pageSize, &(pPager->dbOrigSize));
   pPager->dbFileSize = pPager->dbOrigSize;
@@ -224,6 +234,7 @@ int tdbPagerClose(SPager *pPager) {
       tdbOsClose(pPager->jfd);
     }
     */
+    tdbWalClose(pPager);
     tdbOsClose(pPager->fd);
     tdbOsFree(pPager);
   }
@@ -246,8 +257,8 @@ int tdbPagerWrite(SPager *pPager, SPage *pPage) {
   tdbTrace("tdb/pager-write: put page: %p %d to dirty tree: %p", pPage, TDB_PAGE_PGNO(pPage), &pPager->rbt);
   tRBTreePut(&pPager->rbt, (SRBTreeNode *)pPage);
 
-  // Write page to journal if neccessary
-  if (TDB_PAGE_PGNO(pPage) <= pPager->dbOrigSize &&
+  // Write page to journal if neccessary, the wal keeps the committed pages by itself
+  if (pPager->pWal == NULL && TDB_PAGE_PGNO(pPage) <= pPager->dbOrigSize &&
       (pPager->pActiveTxn->jPageSet == NULL ||
        !hashset_contains(pPager->pActiveTxn->jPageSet, (void *)((long)TDB_PAGE_PGNO(pPage))))) {
     ret = tdbPagerWritePageToJournal(pPager, pPage);
@@ -270,6 +281,13 @@ int tdbPagerBegin(SPager *pPager, TXN *pTxn) {
     return 0;
   }
   */
+  if (pPager->pWal) {
+    pPager->pActiveTxn = pTxn;
+    tdbDebug("pager/begin: %p, %d/%d, txnId:%" PRId64 " in wal mode", pPager, pPager->dbOrigSize, pPager->dbFileSize,
+             pTxn->txnId);
+    return 0;
+  }
+
   // Open the journal
   char jTxnFileName[TDB_FILENAME_LEN];
   sprintf(jTxnFileName, "%s.%" PRId64, pPager->jFileName, pTxn->txnId);
@@ -294,15 +312,19 @@ int tdbPagerBegin(SPager *pPager, TXN *pTxn) {
 }
 
 int tdbPagerCommit(SPager *pPager, TXN *pTxn) {
-  SPage *pPage;
-  int    ret;
+  SPage  *pPage;
+  int     ret;
+  int64_t startTime = taosGetTimestampUs();
 
-  // sync the journal file
-  ret = tdbOsFSync(pTxn->jfd);
-  if (ret < 0) {
-    tdbError("failed to fsync: %s. jFileName:%s, %" PRId64, strerror(errno), pPager->jFileName, pTxn->txnId);
-    terrno = TAOS_SYSTEM_ERROR(errno);
-    return -1;
+  if (pPager->pWal == NULL) {
+    // sync the journal file
+    ret = tdbOsFSync(pTxn->jfd);
+    if (ret < 0) {
+      tdbError("failed to fsync: %s. jFileName:%s, %" PRId64, strerror(errno), pPager->jFileName, pTxn->txnId);
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      return -1;
+    }
+    atomic_add_fetch_64(&pPager->stat.nSync, 1);
   }
 
   // loop to write the dirty pages to file
@@ -323,6 +345,12 @@ int tdbPagerCommit(SPager *pPager, TXN *pTxn) {
     }
   }
 
+  // the commit record makes the txn durable in wal mode
+  if (pPager->pWal && tdbWalCommit(pPager, pTxn) < 0) {
+    tdbError("failed to commit wal since %s. txnId:%" PRId64, tstrerror(terrno), pTxn->txnId);
+    return -1;
+  }
+
   tdbDebug("pager/commit: %p, %d/%d, txnId:%" PRId64, pPager, pPager->dbOrigSize, pPager->dbFileSize, pTxn->txnId);
 
   pPager->dbOrigSize = pPager->dbFileSize;
@@ -345,16 +373,27 @@ int tdbPagerCommit(SPager *pPager, TXN *pTxn) {
   tRBTreeCreate(&pPager->rbt, pageCmpFn);
 
   // sync the db file
-  if (tdbOsFSync(pPager->fd) < 0) {
-    tdbError("failed to fsync fd due to %s. file:%s", strerror(errno), pPager->dbFileName);
-    terrno = TAOS_SYSTEM_ERROR(errno);
-    return -1;
+  if (pPager->pWal == NULL) {
+    if (tdbOsFSync(pPager->fd) < 0) {
+      tdbError("failed to fsync fd due to %s. file:%s", strerror(errno), pPager->dbFileName);
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      return -1;
+    }
+    atomic_add_fetch_64(&pPager->stat.nSync, 1);
   }
 
+  pPager->stat.nCommit++;
+  pPager->stat.commitTime += taosGetTimestampUs() - startTime;
+
   return 0;
 }
 
 int tdbPagerPostCommit(SPager *pPager, TXN *pTxn) {
+  if (pPager->pWal) {
+    tdbDebug("pager/post-commit:%p, %d/%d", pPager, pPager->dbOrigSize, pPager->dbFileSize);
+    return 0;
+  }
+
   char jTxnFileName[TDB_FILENAME_LEN];
   sprintf(jTxnFileName, "%s.%" PRId64, pPager->jFileName, pTxn->txnId);
 
@@ -384,11 +423,14 @@ int tdbPagerPrepareAsyncCommit(SPager *pPager, TXN *pTxn) {
   int    ret;
 
   // sync the journal file
-  ret = tdbOsFSync(pTxn->jfd);
-  if (ret < 0) {
-    tdbError("failed to fsync jfd: %s. jfile:%s, %" PRId64, strerror(errno), pPager->jFileName, pTxn->txnId);
-    terrno = TAOS_SYSTEM_ERROR(errno);
-    return -1;
+  if (pPager->pWal == NULL) {
+    ret = tdbOsFSync(pTxn->jfd);
+    if (ret < 0) {
+      tdbError("failed to fsync jfd: %s. jfile:%s, %" PRId64, strerror(errno), pPager->jFileName, pTxn->txnId);
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      return -1;
+    }
+    atomic_add_fetch_64(&pPager->stat.nSync, 1);
   }
 
   // loop to write the dirty pages to file
@@ -438,13 +480,46 @@ int tdbPagerPrepareAsyncCommit(SPager *pPager, TXN *pTxn) {
   return 0;
 }
 
+static void tdbPagerDropDirtyPages(SPager *pPager, TXN *pTxn) {
+  SPage *pPage;
+
+  SRBTreeIter  iter = tRBTreeIterCreate(&pPager->rbt, 1);
+  SRBTreeNode *pNode = NULL;
+  while ((pNode = tRBTreeIterNext(&iter)) != NULL) {
+    pPage = (SPage *)pNode;
+    SPgno pgno = TDB_PAGE_PGNO(pPage);
+
+    tdbTrace("pager/abort: drop dirty pgno:%d,", pgno);
+
+    pPage->isDirty = 0;
+
+    tRBTreeDrop(&pPager->rbt, (SRBTreeNode *)pPage);
+    if (pTxn->jPageSet) {
+      hashset_remove(pTxn->jPageSet, (void *)((long)TDB_PAGE_PGNO(pPage)));
+    }
+    tdbPCacheMarkFree(pPager->pCache, pPage);
+    tdbPCacheRelease(pPager->pCache, pPage, pTxn);
+  }
+
+  tdbTrace("pager/abort: reset dirty tree: %p", &pPager->rbt);
+  tRBTreeCreate(&pPager->rbt, pageCmpFn);
+}
+
 // recovery dirty pages
 int tdbPagerAbort(SPager *pPager, TXN *pTxn) {
-  SPage *pPage;
   int    pgIdx;
   SPgno  journalSize = 0;
   int    ret;
 
+  if (pPager->pWal) {
+    tdbDebug("pager/abort: %p, %d/%d, txnId:%" PRId64 " in wal mode", pPager, pPager->dbOrigSize, pPager->dbFileSize,
+             pTxn->txnId);
+    // nothing is written into the db file by the txn, forget the frames and the dirty pages
+    tdbWalAbort(pPager, pTxn);
+    tdbPagerDropDirtyPages(pPager, pTxn);
+    return 0;
+  }
+
   if (pTxn->jfd == 0) {
     // txn is commited
     return 0;
@@ -526,24 +601,7 @@ int tdbPagerAbort(SPager *pPager, TXN *pTxn) {
   tdbOsFree(pageBuf);
 
   // 3, release the dirty pages
-  SRBTreeIter  iter = tRBTreeIterCreate(&pPager->rbt, 1);
-  SRBTreeNode *pNode = NULL;
-  while ((pNode = tRBTreeIterNext(&iter)) != NULL) {
-    pPage = (SPage *)pNode;
-    SPgno pgno = TDB_PAGE_PGNO(pPage);
-
-    tdbTrace("pager/abort: drop dirty pgno:%d,", pgno);
-
-    pPage->isDirty = 0;
-
-    tRBTreeDrop(&pPager->rbt, (SRBTreeNode *)pPage);
-    hashset_remove(pTxn->jPageSet, (void *)((long)TDB_PAGE_PGNO(pPage)));
-    tdbPCacheMarkFree(pPager->pCache, pPage);
-    tdbPCacheRelease(pPager->pCache, pPage, pTxn);
-  }
-
-  tdbTrace("pager/abort: reset dirty tree: %p", &pPager->rbt);
-  tRBTreeCreate(&pPager->rbt, pageCmpFn);
+  tdbPagerDropDirtyPages(pPager, pTxn);
 
   // 4, remove the journal file
   if (tdbOsClose(pTxn->jfd) < 0) {
@@ -753,7 +811,16 @@ static int tdbPagerInitPage(SPager *pPager, SPage *pPage, int (*initPage)(SPage
     if (loadPage && pgno <= pPager->dbOrigSize) {
       init = 1;
 
-      nRead = tdbOsPRead(pPager->fd, pPage->pData, pPage->pageSize, ((i64)pPage->pageSize) * (pgno - 1));
+      // the latest image of the page may be still in the wal
+      ret = pPager->pWal ? tdbWalReadPage(pPager, pgno, pPage->pData) : 0;
+      if (ret < 0) {
+        TDB_UNLOCK_PAGE(pPage);
+        return -1;
+      } else if (ret > 0) {
+        nRead = pPage->pageSize;
+      } else {
+        nRead = tdbOsPRead(pPager->fd, pPage->pData, pPage->pageSize, ((i64)pPage->pageSize) * (pgno - 1));
+      }
       tdbTrace("tdb/pager:%p, pgno:%d, nRead:%" PRId64, pPager, pgno, nRead);
       if (nRead < pPage->pageSize) {
         tdbError("tdb/pager:%p, pgno:%d, nRead:%" PRId64 "pgSize:%" PRId32, pPager, pgno, nRead, pPage->pageSize);
@@ -816,6 +883,7 @@ static int tdbPagerWritePageToJournal(SPager *pPager, SPage *pPage) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
   }
+  atomic_add_fetch_64(&pPager->stat.nWriteBytes, sizeof(pgno) + pPage->pageSize);
 
   return 0;
 }
@@ -846,6 +914,11 @@ static int tdbPagerPWritePageToDB(SPager *pPager, SPage *pPage) {
   i64 offset;
   int ret;
 
+  // the pages go to the wal in wal mode, they are copied into the db file by the checkpoint
+  if (pPager->pWal) {
+    return tdbWalAppendPage(pPager, pPage, pPager->pActiveTxn);
+  }
+
   offset = (i64)pPage->pageSize * (TDB_PAGE_PGNO(pPage) - 1);
 
   ret = tdbOsPWrite(pPager->fd, pPage->pData, pPage->pageSize, offset);
@@ -855,6 +928,7 @@ static int tdbPagerPWritePageToDB(SPager *pPager, SPage *pPage) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     return -1;
   }
+  atomic_add_fetch_64(&pPager->stat.nWriteBytes, pPage->pageSize);
 
   return 0;
 }
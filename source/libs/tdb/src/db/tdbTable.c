@@ -71,7 +71,7 @@ int tdbTbOpen(const char *tbname, int keyLen, int valLen, tdb_cmpr_fn_t keyCmprF
   } else {
     pPager = tdbEnvGetPager(pEnv, fFullName);
     if (pPager == NULL) {
-      ret = tdbPagerOpen(pEnv->pCache, fFullName, &pPager);
+      ret = tdbPagerOpen(pEnv->pCache, fFullName, pEnv->walMode, &pPager);
       if (ret < 0) {
         tdbOsFree(pTb);
         return -1;
@@ -94,7 +94,7 @@ int tdbTbOpen(const char *tbname, int keyLen, int valLen, tdb_cmpr_fn_t keyCmprF
   pPager = tdbEnvGetPager(pEnv, tbname);
   if (pPager == NULL) {
     snprintf(fFullName, TDB_FILENAME_LEN, "%s/%s", pEnv->dbName, tbname);
-    ret = tdbPagerOpen(pEnv->pCache, fFullName, &pPager);
+    ret = tdbPagerOpen(pEnv->pCache, fFullName, pEnv->walMode, &pPager);
     if (ret < 0) {
       tdbOsFree(pTb);
       return -1;
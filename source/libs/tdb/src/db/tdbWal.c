@@ -0,0 +1,670 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Write-ahead log of a pager.
+ *
+ * Instead of journaling the original pages and writing the dirty pages into the db file in place, a txn appends the
+ * images of its dirty pages to the wal and ends with a commit record, so a commit costs one sequential write and one
+ * fsync. The pages are looked up in the wal index first, then in the db file. The committed frames are copied back into
+ * the db file by a background checkpointer; the index keeps pointing into the wal until the copies are synced, so the
+ * readers never see a half checkpointed page. Once everything is copied and no txn is running, the wal restarts from
+ * the beginning with a new salt.
+ */
+
+#include "tdbInt.h"
+
+#include "tarray.h"
+#include "tchecksum.h"
+#include "thash.h"
+
+#define TDB_WAL_SUFFIX          "-wal"
+#define TDB_WAL_CKPT_THRESHOLD  (4 * 1024 * 1024)  // bytes of committed frames to trigger a checkpoint
+
+#define TDB_WAL_CKPT_IDLE    0
+#define TDB_WAL_CKPT_QUEUED  1
+#define TDB_WAL_CKPT_RUNNING 2
+
+typedef struct {
+  SPgno pgno;    // 0 for a commit record, which carries no page image
+  SPgno dbSize;  // size of the db in pages, only set in a commit record
+  i64   txnId;
+  u32   salt;    // frames left over from an earlier round of the wal have a different salt
+  u32   cksum;   // of the fields above and the page image
+} SWalFrameHdr;
+
+typedef struct {
+  SPgno pgno;
+  i64   offset;  // the page image is at offset + sizeof(SWalFrameHdr)
+} SWalFrame;
+
+typedef struct {
+  SPgno pgno;
+  i64   prevOffset;  // where the index pointed to before the frame was appended, -1 if nowhere
+} SWalUndo;
+
+struct STdbWal {
+  char        *fname;
+  tdb_fd_t     fd;
+  SPager      *pPager;
+  u8          *pFrame;  // frame buffer of the writer
+  tdb_rwlock_t lock;    // protects the index and the offsets below
+  SHashObj    *pIndex;  // pgno -> offset of the latest frame of the page
+  i64          size;    // end of the appended frames
+  i64          commitSize;
+  i64          ckptSize;  // the frames before it are copied into the db file
+  u32          salt;
+  SArray      *aUndo;  // SWalUndo of the running txn
+  int8_t       ckptState;
+  STdbWal     *pCkptNext;
+};
+
+// the checkpointer thread shared by all the pagers in wal mode
+static struct {
+  TdThreadMutex mutex;  // protects the queue and the ckptState of the wals
+  TdThreadCond  cond;
+  TdThreadMutex refMutex;
+  TdThread      thread;
+  int32_t       nRef;
+  int8_t        stop;
+  STdbWal      *pQueue;
+} tdbWalCkpt;
+
+static TdThreadOnce tdbWalCkptInit = PTHREAD_ONCE_INIT;
+
+static int tdbWalCheckpointImpl(STdbWal *pWal);
+
+static u32 tdbWalFrameCksum(const SWalFrameHdr *pHdr, const u8 *pData, int pageSize) {
+  u32 cksum = taosCalcChecksum(0, (const uint8_t *)pHdr, offsetof(SWalFrameHdr, cksum));
+  if (pHdr->pgno) {
+    cksum = taosCalcChecksum(cksum, pData, pageSize);
+  }
+  return cksum;
+}
+
+static FORCE_INLINE i64 tdbWalFrameSize(SPgno pgno, int pageSize) {
+  return sizeof(SWalFrameHdr) + (pgno ? pageSize : 0);
+}
+
+static int tdbWalFrameCmpr(const void *p1, const void *p2) {
+  const SWalFrame *pFrame1 = p1;
+  const SWalFrame *pFrame2 = p2;
+
+  if (pFrame1->pgno < pFrame2->pgno) {
+    return -1;
+  } else if (pFrame1->pgno > pFrame2->pgno) {
+    return 1;
+  }
+  return 0;
+}
+
+// ---------------------------- checkpointer
+static void tdbWalCkptInitOnce(void) {
+  taosThreadMutexInit(&tdbWalCkpt.mutex, NULL);
+  taosThreadCondInit(&tdbWalCkpt.cond, NULL);
+  taosThreadMutexInit(&tdbWalCkpt.refMutex, NULL);
+}
+
+static bool tdbWalNeedCheckpoint(STdbWal *pWal) {
+  bool need;
+
+  tdbRwlockRdlock(&pWal->lock);
+  need = pWal->commitSize - pWal->ckptSize >= TDB_WAL_CKPT_THRESHOLD;
+  tdbRwlockUnlock(&pWal->lock);
+
+  return need;
+}
+
+// must be called with the checkpointer mutex held
+static void tdbWalEnqueue(STdbWal *pWal) {
+  STdbWal **ppWal = &tdbWalCkpt.pQueue;
+
+  while (*ppWal) {
+    ppWal = &(*ppWal)->pCkptNext;
+  }
+  pWal->pCkptNext = NULL;
+  pWal->ckptState = TDB_WAL_CKPT_QUEUED;
+  *ppWal = pWal;
+
+  taosThreadCondBroadcast(&tdbWalCkpt.cond);
+}
+
+static void *tdbWalCkptThreadFp(void *arg) {
+  setThreadName("tdb-ckpt");
+
+  taosThreadMutexLock(&tdbWalCkpt.mutex);
+  for (;;) {
+    while (!tdbWalCkpt.stop && tdbWalCkpt.pQueue == NULL) {
+      taosThreadCondWait(&tdbWalCkpt.cond, &tdbWalCkpt.mutex);
+    }
+
+    STdbWal *pWal = tdbWalCkpt.pQueue;
+    if (pWal == NULL) break;
+
+    tdbWalCkpt.pQueue = pWal->pCkptNext;
+    pWal->pCkptNext = NULL;
+    pWal->ckptState = TDB_WAL_CKPT_RUNNING;
+    taosThreadMutexUnlock(&tdbWalCkpt.mutex);
+
+    if (tdbWalCheckpointImpl(pWal) < 0) {
+      tdbError("failed to checkpoint wal since %s. file:%s", tstrerror(terrno), pWal->fname);
+    }
+
+    taosThreadMutexLock(&tdbWalCkpt.mutex);
+    pWal->ckptState = TDB_WAL_CKPT_IDLE;
+    // commits went on while copying, catch up at once
+    if (tdbWalNeedCheckpoint(pWal)) {
+      tdbWalEnqueue(pWal);
+    }
+    // wake up the closer waiting for this wal
+    taosThreadCondBroadcast(&tdbWalCkpt.cond);
+  }
+  taosThreadMutexUnlock(&tdbWalCkpt.mutex);
+
+  return NULL;
+}
+
+static int tdbWalCkptRef(void) {
+  int ret = 0;
+
+  taosThreadOnce(&tdbWalCkptInit, tdbWalCkptInitOnce);
+
+  taosThreadMutexLock(&tdbWalCkpt.refMutex);
+  if (tdbWalCkpt.nRef == 0) {
+    tdbWalCkpt.stop = 0;
+    if (taosThreadCreate(&tdbWalCkpt.thread, NULL, tdbWalCkptThreadFp, NULL) != 0) {
+      tdbError("failed to create wal checkpoint thread since %s", strerror(errno));
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      ret = -1;
+    }
+  }
+  if (ret == 0) {
+    tdbWalCkpt.nRef++;
+  }
+  taosThreadMutexUnlock(&tdbWalCkpt.refMutex);
+
+  return ret;
+}
+
+static void tdbWalCkptUnref(void) {
+  taosThreadMutexLock(&tdbWalCkpt.refMutex);
+  if (--tdbWalCkpt.nRef == 0) {
+    taosThreadMutexLock(&tdbWalCkpt.mutex);
+    tdbWalCkpt.stop = 1;
+    taosThreadCondBroadcast(&tdbWalCkpt.cond);
+    taosThreadMutexUnlock(&tdbWalCkpt.mutex);
+
+    taosThreadJoin(tdbWalCkpt.thread, NULL);
+  }
+  taosThreadMutexUnlock(&tdbWalCkpt.refMutex);
+}
+
+static void tdbWalScheduleCheckpoint(STdbWal *pWal) {
+  taosThreadMutexLock(&tdbWalCkpt.mutex);
+  // a running checkpoint requeues the wal by itself if it falls behind again
+  if (pWal->ckptState == TDB_WAL_CKPT_IDLE) {
+    tdbWalEnqueue(pWal);
+  }
+  taosThreadMutexUnlock(&tdbWalCkpt.mutex);
+}
+
+// take the wal out of the checkpointer, wait for the running checkpoint of it to finish
+static void tdbWalDetach(STdbWal *pWal) {
+  taosThreadMutexLock(&tdbWalCkpt.mutex);
+  for (;;) {
+    if (pWal->ckptState == TDB_WAL_CKPT_QUEUED) {
+      STdbWal **ppWal = &tdbWalCkpt.pQueue;
+      while (*ppWal != pWal) {
+        ppWal = &(*ppWal)->pCkptNext;
+      }
+      *ppWal = pWal->pCkptNext;
+      pWal->pCkptNext = NULL;
+      break;
+    } else if (pWal->ckptState == TDB_WAL_CKPT_RUNNING) {
+      // the wal may be queued again when the checkpoint ends
+      taosThreadCondWait(&tdbWalCkpt.cond, &tdbWalCkpt.mutex);
+    } else {
+      break;
+    }
+  }
+  pWal->ckptState = TDB_WAL_CKPT_IDLE;
+  taosThreadMutexUnlock(&tdbWalCkpt.mutex);
+}
+
+// ---------------------------- checkpoint
+static int tdbWalCopyFrames(STdbWal *pWal, SArray *aFrame) {
+  SPager *pPager = pWal->pPager;
+  int     pageSize = pPager->pageSize;
+  u8     *pageBuf;
+
+  if (taosArrayGetSize(aFrame) == 0) {
+    return 0;
+  }
+
+  pageBuf = tdbOsMalloc(pageSize);
+  if (pageBuf == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  // in the order of the pages so the db file is written forward
+  taosArraySort(aFrame, tdbWalFrameCmpr);
+
+  for (int32_t i = 0; i < taosArrayGetSize(aFrame); i++) {
+    SWalFrame *pFrame = taosArrayGet(aFrame, i);
+
+    i64 nRead = tdbOsPRead(pWal->fd, pageBuf, pageSize, pFrame->offset + sizeof(SWalFrameHdr));
+    if (nRead < pageSize) {
+      tdbError("failed to read wal frame, pgno:%u offset:%" PRId64 " nRead:%" PRId64 ". file:%s", pFrame->pgno,
+               pFrame->offset, nRead, pWal->fname);
+      terrno = nRead < 0 ? TAOS_SYSTEM_ERROR(errno) : TSDB_CODE_FILE_CORRUPTED;
+      tdbOsFree(pageBuf);
+      return -1;
+    }
+
+    if (tdbOsPWrite(pPager->fd, pageBuf, pageSize, (i64)pageSize * (pFrame->pgno - 1)) < 0) {
+      tdbError("failed to pwrite page due to %s. file:%s, pgno:%u", strerror(errno), pPager->dbFileName,
+               pFrame->pgno);
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      tdbOsFree(pageBuf);
+      return -1;
+    }
+    atomic_add_fetch_64(&pPager->stat.nWriteBytes, pageSize);
+  }
+
+  tdbOsFree(pageBuf);
+
+  if (tdbOsFSync(pPager->fd) < 0) {
+    tdbError("failed to fsync fd due to %s. file:%s", strerror(errno), pPager->dbFileName);
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+  atomic_add_fetch_64(&pPager->stat.nSync, 1);
+
+  return 0;
+}
+
+// must be called with the wal write-locked
+static void tdbWalRestart(STdbWal *pWal) {
+  taosHashClear(pWal->pIndex);
+  pWal->size = 0;
+  pWal->commitSize = 0;
+  pWal->ckptSize = 0;
+  pWal->salt++;
+}
+
+static int tdbWalCheckpointImpl(STdbWal *pWal) {
+  SArray *aFrame = NULL;
+  i64     ckptSize, end;
+  u32     salt;
+
+  // collect the latest committed frame of each page not copied yet
+  tdbRwlockRdlock(&pWal->lock);
+  ckptSize = pWal->ckptSize;
+  end = pWal->commitSize;
+  salt = pWal->salt;
+  if (ckptSize >= end) {
+    tdbRwlockUnlock(&pWal->lock);
+    return 0;
+  }
+
+  aFrame = taosArrayInit(taosHashGetSize(pWal->pIndex) + 1, sizeof(SWalFrame));
+  if (aFrame == NULL) {
+    tdbRwlockUnlock(&pWal->lock);
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  void *pIter = taosHashIterate(pWal->pIndex, NULL);
+  while (pIter) {
+    i64 offset = *(i64 *)pIter;
+    if (offset >= ckptSize && offset < end) {
+      SWalFrame frame = {.pgno = *(SPgno *)taosHashGetKey(pIter, NULL), .offset = offset};
+      taosArrayPush(aFrame, &frame);
+    }
+    pIter = taosHashIterate(pWal->pIndex, pIter);
+  }
+
+  // the pages modified by the running txn, the first undo record of such a page tells its committed frame
+  for (int32_t i = 0; i < taosArrayGetSize(pWal->aUndo); i++) {
+    SWalUndo *pUndo = taosArrayGet(pWal->aUndo, i);
+    if (pUndo->prevOffset >= ckptSize && pUndo->prevOffset < end) {
+      SWalFrame frame = {.pgno = pUndo->pgno, .offset = pUndo->prevOffset};
+      taosArrayPush(aFrame, &frame);
+    }
+  }
+  tdbRwlockUnlock(&pWal->lock);
+
+  // the frames below commitSize are never overwritten before they are checkpointed, copy them without the lock
+  if (tdbWalCopyFrames(pWal, aFrame) < 0) {
+    taosArrayDestroy(aFrame);
+    return -1;
+  }
+
+  tdbDebug("tdb/wal: checkpoint %p, %d pages, %" PRId64 "-%" PRId64 ". file:%s", pWal,
+           (int)taosArrayGetSize(aFrame), ckptSize, end, pWal->fname);
+  taosArrayDestroy(aFrame);
+
+  tdbRwlockWrlock(&pWal->lock);
+  if (pWal->salt == salt) {
+    pWal->ckptSize = end;
+    if (pWal->size == end) {
+      // nothing after the checkpoint, start over from the beginning of the file
+      tdbWalRestart(pWal);
+    }
+  }
+  tdbRwlockUnlock(&pWal->lock);
+
+  return 0;
+}
+
+// ---------------------------- open & close
+static void tdbWalFree(STdbWal *pWal) {
+  if (pWal) {
+    if (!TDB_FD_INVALID(pWal->fd)) {
+      tdbOsClose(pWal->fd);
+    }
+    taosHashCleanup(pWal->pIndex);
+    taosArrayDestroy(pWal->aUndo);
+    tdbRwlockDestroy(&pWal->lock);
+    tdbOsFree(pWal->pFrame);
+    tdbOsFree(pWal);
+  }
+}
+
+// rebuild the index from the frames of the committed txns, the frames after the last commit record are dropped
+static int tdbWalRecover(STdbWal *pWal) {
+  int     pageSize = pWal->pPager->pageSize;
+  SArray *aPending = NULL;
+  i64     offset = 0;
+  int     nTxn = 0;
+
+  aPending = taosArrayInit(64, sizeof(SWalFrame));
+  if (aPending == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  for (;;) {
+    SWalFrameHdr *pHdr = (SWalFrameHdr *)pWal->pFrame;
+    u8           *pData = pWal->pFrame + sizeof(SWalFrameHdr);
+
+    if (tdbOsPRead(pWal->fd, pHdr, sizeof(*pHdr), offset) < (i64)sizeof(*pHdr)) break;
+    if (offset == 0) {
+      pWal->salt = pHdr->salt;
+    } else if (pHdr->salt != pWal->salt) {
+      break;
+    }
+    if (pHdr->pgno && tdbOsPRead(pWal->fd, pData, pageSize, offset + sizeof(*pHdr)) < pageSize) break;
+    if (tdbWalFrameCksum(pHdr, pData, pageSize) != pHdr->cksum) break;
+
+    if (pHdr->pgno) {
+      SWalFrame frame = {.pgno = pHdr->pgno, .offset = offset};
+      taosArrayPush(aPending, &frame);
+    } else {
+      for (int32_t i = 0; i < taosArrayGetSize(aPending); i++) {
+        SWalFrame *pFrame = taosArrayGet(aPending, i);
+        taosHashPut(pWal->pIndex, &pFrame->pgno, sizeof(pFrame->pgno), &pFrame->offset, sizeof(pFrame->offset));
+      }
+      taosArrayClear(aPending);
+      nTxn++;
+    }
+
+    offset += tdbWalFrameSize(pHdr->pgno, pageSize);
+    if (pHdr->pgno == 0) {
+      pWal->commitSize = offset;
+    }
+  }
+
+  taosArrayDestroy(aPending);
+
+  tdbInfo("tdb/wal: recover %d txns, %d pages, %" PRId64 " of %" PRId64 " bytes. file:%s", nTxn,
+          (int)taosHashGetSize(pWal->pIndex), pWal->commitSize, offset, pWal->fname);
+
+  pWal->size = pWal->commitSize;
+  return tdbWalCheckpointImpl(pWal);
+}
+
+int tdbWalOpen(SPager *pPager, int8_t walMode) {
+  STdbWal *pWal;
+  int      nameLen = strlen(pPager->dbFileName) + strlen(TDB_WAL_SUFFIX);
+
+  pWal = tdbOsCalloc(1, sizeof(*pWal) + nameLen + 1);
+  if (pWal == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  pWal->fname = (char *)&pWal[1];
+  snprintf(pWal->fname, nameLen + 1, "%s%s", pPager->dbFileName, TDB_WAL_SUFFIX);
+  pWal->pPager = pPager;
+  tdbRwlockInit(&pWal->lock, NULL);
+  pWal->pFrame = tdbOsCalloc(1, sizeof(SWalFrameHdr) + pPager->pageSize);
+  pWal->pIndex = taosHashInit(1024, taosIntHash_32, true, HASH_NO_LOCK);
+  pWal->aUndo = taosArrayInit(64, sizeof(SWalUndo));
+  if (pWal->pFrame == NULL || pWal->pIndex == NULL || pWal->aUndo == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    tdbWalFree(pWal);
+    return -1;
+  }
+
+  // a wal left over by a crash, copy the committed txns into the db file whatever the mode is now
+  pWal->fd = tdbOsOpen(pWal->fname, TDB_O_RDWR, 0755);
+  if (!TDB_FD_INVALID(pWal->fd)) {
+    if (tdbWalRecover(pWal) < 0) {
+      tdbError("failed to recover wal since %s. file:%s", tstrerror(terrno), pWal->fname);
+      tdbWalFree(pWal);
+      return -1;
+    }
+
+    tdbOsClose(pWal->fd);
+    if (tdbOsRemove(pWal->fname) < 0 && errno != ENOENT) {
+      tdbError("failed to remove file due to %s. file:%s", strerror(errno), pWal->fname);
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      tdbWalFree(pWal);
+      return -1;
+    }
+  }
+
+  if (!walMode) {
+    tdbWalFree(pWal);
+    return 0;
+  }
+
+  tdbWalRestart(pWal);
+  pWal->salt = taosRand();
+  pWal->fd = tdbOsOpen(pWal->fname, TDB_O_CREAT | TDB_O_RDWR | TDB_O_TRUNC, 0755);
+  if (TDB_FD_INVALID(pWal->fd)) {
+    tdbError("failed to open file due to %s. file:%s", strerror(errno), pWal->fname);
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tdbWalFree(pWal);
+    return -1;
+  }
+
+  if (tdbWalCkptRef() < 0) {
+    tdbWalFree(pWal);
+    return -1;
+  }
+
+  pPager->pWal = pWal;
+  return 0;
+}
+
+int tdbWalClose(SPager *pPager) {
+  STdbWal *pWal = pPager->pWal;
+  int      ret = 0;
+
+  if (pWal == NULL) {
+    return 0;
+  }
+
+  tdbWalDetach(pWal);
+  tdbWalCkptUnref();
+
+  // leave a db file complete by itself, the frames of an unfinished txn are dropped
+  ret = tdbWalCheckpointImpl(pWal);
+  if (ret < 0) {
+    tdbError("failed to checkpoint wal since %s, keep it for recovery. file:%s", tstrerror(terrno), pWal->fname);
+  } else {
+    tdbOsClose(pWal->fd);
+    if (tdbOsRemove(pWal->fname) < 0 && errno != ENOENT) {
+      tdbError("failed to remove file due to %s. file:%s", strerror(errno), pWal->fname);
+    }
+  }
+
+  tdbWalFree(pWal);
+  pPager->pWal = NULL;
+  return ret;
+}
+
+// ---------------------------- txn
+static int tdbWalAppend(STdbWal *pWal, SPgno pgno, const u8 *pData, SPgno dbSize, i64 txnId) {
+  SPager       *pPager = pWal->pPager;
+  SWalFrameHdr *pHdr = (SWalFrameHdr *)pWal->pFrame;
+  i64           frameSize = tdbWalFrameSize(pgno, pPager->pageSize);
+  i64           offset;
+
+  // reserve the room of the frame
+  tdbRwlockWrlock(&pWal->lock);
+  if (pWal->size > 0 && pWal->size == pWal->commitSize && pWal->ckptSize == pWal->commitSize) {
+    // the first frame of a txn and the wal is all checkpointed, reuse it from the beginning
+    tdbWalRestart(pWal);
+  }
+  offset = pWal->size;
+  pWal->size += frameSize;
+  pHdr->salt = pWal->salt;
+  tdbRwlockUnlock(&pWal->lock);
+
+  pHdr->pgno = pgno;
+  pHdr->dbSize = dbSize;
+  pHdr->txnId = txnId;
+  if (pgno) {
+    memcpy(pWal->pFrame + sizeof(*pHdr), pData, pPager->pageSize);
+  }
+  pHdr->cksum = tdbWalFrameCksum(pHdr, pData, pPager->pageSize);
+
+  if (tdbOsPWrite(pWal->fd, pWal->pFrame, frameSize, offset) < 0) {
+    tdbError("failed to pwrite wal frame due to %s. file:%s, pgno:%u, txnId:%" PRId64, strerror(errno), pWal->fname,
+             pgno, txnId);
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+  atomic_add_fetch_64(&pPager->stat.nWriteBytes, frameSize);
+
+  if (pgno == 0) {
+    return 0;
+  }
+
+  // publish the frame
+  SWalUndo undo = {.pgno = pgno, .prevOffset = -1};
+
+  tdbRwlockWrlock(&pWal->lock);
+  i64 *pOffset = taosHashGet(pWal->pIndex, &pgno, sizeof(pgno));
+  if (pOffset) {
+    undo.prevOffset = *pOffset;
+  }
+  if (taosHashPut(pWal->pIndex, &pgno, sizeof(pgno), &offset, sizeof(offset)) < 0 ||
+      taosArrayPush(pWal->aUndo, &undo) == NULL) {
+    tdbRwlockUnlock(&pWal->lock);
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+  tdbRwlockUnlock(&pWal->lock);
+
+  return 0;
+}
+
+int tdbWalAppendPage(SPager *pPager, SPage *pPage, TXN *pTxn) {
+  return tdbWalAppend(pPager->pWal, TDB_PAGE_PGNO(pPage), pPage->pData, 0, pTxn->txnId);
+}
+
+int tdbWalCommit(SPager *pPager, TXN *pTxn) {
+  STdbWal *pWal = pPager->pWal;
+  bool     needCkpt;
+
+  if (tdbWalAppend(pWal, 0, NULL, pPager->dbFileSize, pTxn->txnId) < 0) {
+    return -1;
+  }
+
+  if (tdbOsFSync(pWal->fd) < 0) {
+    tdbError("failed to fsync wal due to %s. file:%s, txnId:%" PRId64, strerror(errno), pWal->fname, pTxn->txnId);
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+  atomic_add_fetch_64(&pPager->stat.nSync, 1);
+
+  tdbRwlockWrlock(&pWal->lock);
+  pWal->commitSize = pWal->size;
+  taosArrayClear(pWal->aUndo);
+  needCkpt = pWal->commitSize - pWal->ckptSize >= TDB_WAL_CKPT_THRESHOLD;
+  tdbRwlockUnlock(&pWal->lock);
+
+  if (needCkpt) {
+    tdbWalScheduleCheckpoint(pWal);
+  }
+
+  return 0;
+}
+
+int tdbWalAbort(SPager *pPager, TXN *pTxn) {
+  STdbWal *pWal = pPager->pWal;
+  int32_t  nUndo;
+
+  // point the index back to the committed frames and drop the frames of the txn
+  tdbRwlockWrlock(&pWal->lock);
+  nUndo = taosArrayGetSize(pWal->aUndo);
+  for (int32_t i = nUndo - 1; i >= 0; i--) {
+    SWalUndo *pUndo = taosArrayGet(pWal->aUndo, i);
+    if (pUndo->prevOffset < 0) {
+      taosHashRemove(pWal->pIndex, &pUndo->pgno, sizeof(pUndo->pgno));
+    } else {
+      taosHashPut(pWal->pIndex, &pUndo->pgno, sizeof(pUndo->pgno), &pUndo->prevOffset, sizeof(pUndo->prevOffset));
+    }
+    // the page may still be cached after it was flushed to the wal by the txn
+    tdbPCacheInvalidatePage(pPager->pCache, pPager, pUndo->pgno);
+  }
+  taosArrayClear(pWal->aUndo);
+  pWal->size = pWal->commitSize;
+  tdbRwlockUnlock(&pWal->lock);
+
+  tdbDebug("tdb/wal: abort %p, %d frames, txnId:%" PRId64, pWal, nUndo, pTxn->txnId);
+
+  return 0;
+}
+
+// return 1 if the page is read from the wal, 0 if the page is not in the wal
+int tdbWalReadPage(SPager *pPager, SPgno pgno, u8 *pData) {
+  STdbWal *pWal = pPager->pWal;
+  i64      nRead;
+
+  // hold the lock over the read, the frame can not be reused until the lock is released
+  tdbRwlockRdlock(&pWal->lock);
+  i64 *pOffset = taosHashGet(pWal->pIndex, &pgno, sizeof(pgno));
+  if (pOffset == NULL) {
+    tdbRwlockUnlock(&pWal->lock);
+    return 0;
+  }
+  nRead = tdbOsPRead(pWal->fd, pData, pPager->pageSize, *pOffset + sizeof(SWalFrameHdr));
+  tdbRwlockUnlock(&pWal->lock);
+
+  if (nRead < pPager->pageSize) {
+    tdbError("tdb/wal: %p, pgno:%u, nRead:%" PRId64 " pgSize:%d. file:%s", pWal, pgno, nRead, pPager->pageSize,
+             pWal->fname);
+    terrno = nRead < 0 ? TAOS_SYSTEM_ERROR(errno) : TSDB_CODE_FILE_CORRUPTED;
+    return -1;
+  }
+
+  return 1;
+}
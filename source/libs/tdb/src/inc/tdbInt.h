@@ -186,7 +186,7 @@ int tdbBtcUpsert(SBTC *pBtc, const void *pKey, int kLen, const void *pData, int
 
 // tdbPager.c ====================================
 
-int  tdbPagerOpen(SPCache *pCache, const char *fileName, SPager **ppPager);
+int  tdbPagerOpen(SPCache *pCache, const char *fileName, int8_t walMode, SPager **ppPager);
 int  tdbPagerClose(SPager *pPager);
 int  tdbPagerOpenDB(SPager *pPager, SPgno *ppgno, bool toCreate, SBTree *pBt);
 int  tdbPagerWrite(SPager *pPager, SPage *pPage);
@@ -202,6 +202,16 @@ int  tdbPagerAllocPage(SPager *pPager, SPgno *ppgno);
 int  tdbPagerRestoreJournals(SPager *pPager);
 int  tdbPagerRollback(SPager *pPager);
 
+// tdbWal.c ====================================
+typedef struct STdbWal STdbWal;
+
+int tdbWalOpen(SPager *pPager, int8_t walMode);
+int tdbWalClose(SPager *pPager);
+int tdbWalAppendPage(SPager *pPager, SPage *pPage, TXN *pTxn);
+int tdbWalCommit(SPager *pPager, TXN *pTxn);
+int tdbWalAbort(SPager *pPager, TXN *pTxn);
+int tdbWalReadPage(SPager *pPager, SPgno pgno, u8 *pData);
+
 // tdbPCache.c ====================================
 #define TDB_PCACHE_PAGE    \
   u8           isAnchor;   \
@@ -379,6 +389,7 @@ struct STDB {
   char    *dbName;
   char    *jnName;
   int      jfd;
+  int8_t   walMode;
   SPCache *pCache;
   SPager  *pgrList;
   int      nPager;
@@ -408,6 +419,13 @@ struct SPager {
 #ifdef USE_MAINDB
   TDB *pEnv;
 #endif
+  STdbWal *pWal;  // not NULL if the pager commits through the write-ahead log
+  struct {
+    int64_t nCommit;
+    int64_t commitTime;   // us spent in commits
+    int64_t nWriteBytes;  // bytes written to the journal, the wal and the db file
+    int64_t nSync;
+  } stat;
 };
 
 #ifdef __cplusplus
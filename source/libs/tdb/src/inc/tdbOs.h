@@ -85,6 +85,16 @@ typedef TdThreadMutex tdb_mutex_t;
 #define tdbMutexLock    taosThreadMutexLock
 #define tdbMutexUnlock  taosThreadMutexUnlock
 
+/* rw lock */
+typedef TdThreadRwlock tdb_rwlock_t;
+
+#define tdbRwlockInit      taosThreadRwlockInit
+#define tdbRwlockDestroy   taosThreadRwlockDestroy
+#define tdbRwlockRdlock    taosThreadRwlockRdlock
+#define tdbRwlockWrlock    taosThreadRwlockWrlock
+#define tdbRwlockTryWrlock taosThreadRwlockTryWrlock
+#define tdbRwlockUnlock    taosThreadRwlockUnlock
+
 #else
 
 // For memory -----------------
@@ -143,6 +153,16 @@ typedef pthread_mutex_t tdb_mutex_t;
 #define tdbMutexLock    pthread_mutex_lock
 #define tdbMutexUnlock  pthread_mutex_unlock
 
+/* rw lock */
+typedef pthread_rwlock_t tdb_rwlock_t;
+
+#define tdbRwlockInit      pthread_rwlock_init
+#define tdbRwlockDestroy   pthread_rwlock_destroy
+#define tdbRwlockRdlock    pthread_rwlock_rdlock
+#define tdbRwlockWrlock    pthread_rwlock_wrlock
+#define tdbRwlockTryWrlock pthread_rwlock_trywrlock
+#define tdbRwlockUnlock    pthread_rwlock_unlock
+
 #endif
 
 #ifdef __cplusplus
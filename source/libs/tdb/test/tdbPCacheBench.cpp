@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Point lookups per second through the sharded page cache from 1 to 8 threads, once with all pages resident and once
+// with a cache holding a fraction of them. Built with -DBUILD_TEST=ON -DBUILD_BENCHMARK=ON, run as
+//   tdbPCacheBench [gets per thread]
+
+#define ALLOW_FORBID_FUNC
+#include "os.h"
+#include "tdb.h"
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int benchData = 200000;
+
+int benchKeyCmpr(const void *pKey1, int kLen1, const void *pKey2, int kLen2) {
+  int k1 = atoi((const char *)pKey1 + 3);
+  int k2 = atoi((const char *)pKey2 + 3);
+
+  if (k1 < k2) {
+    return -1;
+  } else if (k1 > k2) {
+    return 1;
+  } else {
+    return 0;
+  }
+}
+
+void *benchMalloc(void *arg, size_t size) { return taosMemoryMalloc(size); }
+void  benchFree(void *arg, void *ptr) { taosMemoryFree(ptr); }
+
+int benchOpen(int cacheSize, TDB **ppEnv, TTB **ppTb) {
+  TXN *txn;
+
+  taosRemoveDir("tdb");
+  if (tdbOpen("tdb", 4096, cacheSize, ppEnv, 0) < 0) return -1;
+  if (tdbTbOpen("db.db", -1, -1, benchKeyCmpr, *ppEnv, ppTb, 0) < 0) return -1;
+
+  tdbBegin(*ppEnv, &txn, benchMalloc, benchFree, NULL, TDB_TXN_WRITE | TDB_TXN_READ_UNCOMMITTED);
+  for (int iData = 0; iData < benchData; iData++) {
+    char key[64];
+    char val[64];
+    sprintf(key, "key%d", iData);
+    sprintf(val, "value%d", iData);
+    if (tdbTbInsert(*ppTb, key, strlen(key), val, strlen(val), txn) < 0) return -1;
+  }
+  tdbCommit(*ppEnv, txn);
+  tdbPostCommit(*ppEnv, txn);
+  return 0;
+}
+
+void benchGet(TTB *pTb, int nGets, int seed) {
+  void    *pVal = NULL;
+  int      vLen;
+  uint32_t r = seed;
+
+  for (int i = 0; i < nGets; i++) {
+    char key[64];
+    r = r * 1103515245 + 12345;
+    sprintf(key, "key%d", (int)(r % benchData));
+    tdbTbGet(pTb, key, strlen(key), &pVal, &vLen);
+  }
+  tdbFree(pVal);
+}
+
+// gets per second of nThreads readers
+double benchRun(TTB *pTb, int nThreads, int nGets) {
+  std::vector<std::thread> threads;
+
+  int64_t start = taosGetTimestampUs();
+  for (int i = 0; i < nThreads; i++) {
+    threads.push_back(std::thread(benchGet, pTb, nGets, i + 1));
+  }
+  for (auto &th : threads) {
+    th.join();
+  }
+  int64_t elapsed = taosGetTimestampUs() - start;
+
+  return (double)nGets * nThreads * 1000000 / (elapsed > 0 ? elapsed : 1);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int nGets = (argc > 1) ? atoi(argv[1]) : 400000;
+
+  struct {
+    const char *name;
+    int         cacheSize;
+  } caches[] = {{"resident", 16384}, {"recycle", 256}};
+
+  printf("%10s %8s %16s %8s\n", "cache", "threads", "gets/s", "scaling");
+  for (auto &cache : caches) {
+    TDB *pEnv;
+    TTB *pTb;
+    if (benchOpen(cache.cacheSize, &pEnv, &pTb) < 0) {
+      printf("failed to open tdb\n");
+      return -1;
+    }
+
+    double base = 0;
+    for (int nThreads = 1; nThreads <= 8; nThreads *= 2) {
+      double rate = benchRun(pTb, nThreads, nGets);
+      if (nThreads == 1) base = rate;
+      printf("%10s %8d %16.0f %7.2fx\n", cache.name, nThreads, rate, rate / base);
+    }
+
+    tdbTbClose(pTb);
+    tdbClose(pEnv);
+  }
+
+  taosRemoveDir("tdb");
+  return 0;
+}
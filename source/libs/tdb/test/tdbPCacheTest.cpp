@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#define ALLOW_FORBID_FUNC
+#include "os.h"
+#include "tdb.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static int tKeyCmpr(const void *pKey1, int kLen1, const void *pKey2, int kLen2) {
+  int k1 = atoi((const char *)pKey1 + 3);
+  int k2 = atoi((const char *)pKey2 + 3);
+
+  if (k1 < k2) {
+    return -1;
+  } else if (k1 > k2) {
+    return 1;
+  } else {
+    return 0;
+  }
+}
+
+static void *tMalloc(void *arg, size_t size) { return taosMemoryMalloc(size); }
+static void  tFree(void *arg, void *ptr) { taosMemoryFree(ptr); }
+
+// point lookups from several threads, each of them must find the value of its key
+static void tdbPCacheTestMultiThreadRead(int cacheSize, int nData, int nThreads, int nGets) {
+  int  ret;
+  TDB *pEnv;
+  TTB *pTb;
+  TXN *txn;
+
+  taosRemoveDir("tdb");
+
+  ret = tdbOpen("tdb", 4096, cacheSize, &pEnv, 0);
+  GTEST_ASSERT_EQ(ret, 0);
+
+  ret = tdbTbOpen("db.db", -1, -1, tKeyCmpr, pEnv, &pTb, 0);
+  GTEST_ASSERT_EQ(ret, 0);
+
+  tdbBegin(pEnv, &txn, tMalloc, tFree, NULL, TDB_TXN_WRITE | TDB_TXN_READ_UNCOMMITTED);
+  for (int iData = 0; iData < nData; iData++) {
+    char key[64];
+    char val[64];
+    sprintf(key, "key%d", iData);
+    sprintf(val, "value%d", iData);
+    ret = tdbTbInsert(pTb, key, strlen(key), val, strlen(val), txn);
+    GTEST_ASSERT_EQ(ret, 0);
+  }
+  tdbCommit(pEnv, txn);
+  tdbPostCommit(pEnv, txn);
+
+  auto get = [](TTB *pTb, int nData, int nGets, int seed, std::atomic<int> *nMatched) {
+    void    *pVal = NULL;
+    int      vLen;
+    uint32_t r = seed;
+    int      matched = 0;
+
+    for (int i = 0; i < nGets; i++) {
+      char key[64];
+      char val[64];
+      int  iData;
+      r = r * 1103515245 + 12345;
+      iData = (int)(r % nData);
+      sprintf(key, "key%d", iData);
+      sprintf(val, "value%d", iData);
+      if (tdbTbGet(pTb, key, strlen(key), &pVal, &vLen) == 0 && vLen == (int)strlen(val) &&
+          memcmp(pVal, val, vLen) == 0) {
+        matched++;
+      }
+    }
+
+    tdbFree(pVal);
+    *nMatched += matched;
+  };
+
+  std::atomic<int>         nMatched(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < nThreads; i++) {
+    threads.push_back(std::thread(get, pTb, nData, nGets, i + 1, &nMatched));
+  }
+  for (auto &th : threads) {
+    th.join();
+  }
+  GTEST_ASSERT_EQ(nMatched.load(), nGets * nThreads);
+
+  tdbTbClose(pTb);
+  ret = tdbClose(pEnv);
+  GTEST_ASSERT_EQ(ret, 0);
+  taosRemoveDir("tdb");
+}
+
+// all pages are kept in the cache, so concurrent lookups only share resident pages across the shards
+TEST(tdb_pcache_test, multi_thread_read_resident) { tdbPCacheTestMultiThreadRead(4096, 50000, 8, 20000); }
+
+// the cache holds a fraction of the pages, so the lookups also recycle pages and take them from other shards
+TEST(tdb_pcache_test, multi_thread_read_recycle) { tdbPCacheTestMultiThreadRead(256, 50000, 8, 20000); }
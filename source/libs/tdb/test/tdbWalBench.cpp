@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Commit latency, fsyncs per commit and write amplification of the journal and the wal modes, for small txns
+// committed one after another. Built with -DBUILD_TEST=ON -DBUILD_BENCHMARK=ON, run as
+//   tdbWalBench [txns] [rows per txn]
+
+#define ALLOW_FORBID_FUNC
+#include "os.h"
+#include "tdbInt.h"
+
+namespace {
+
+int benchKeyCmpr(const void *pKey1, int kLen1, const void *pKey2, int kLen2) {
+  int k1 = atoi((const char *)pKey1 + 3);
+  int k2 = atoi((const char *)pKey2 + 3);
+
+  if (k1 < k2) {
+    return -1;
+  } else if (k1 > k2) {
+    return 1;
+  } else {
+    return 0;
+  }
+}
+
+void *benchMalloc(void *arg, size_t size) { return taosMemoryMalloc(size); }
+void  benchFree(void *arg, void *ptr) { taosMemoryFree(ptr); }
+
+struct SBenchResult {
+  int64_t nCommit;
+  int64_t commitTime;
+  int64_t nSync;
+  int64_t nWriteBytes;
+  int64_t nBytes;  // of the rows inserted
+};
+
+int benchRun(int8_t walMode, int nTxn, int nDataPerTxn, SBenchResult *pRes) {
+  TDB *pEnv;
+  TTB *pTb;
+
+  taosRemoveDir("tdb");
+  if (tdbOpenEx("tdb", 4096, 256, &pEnv, 0, walMode ? TDB_OPEN_WAL : 0) < 0) return -1;
+  if (tdbTbOpen("db.db", -1, -1, benchKeyCmpr, pEnv, &pTb, 0) < 0) return -1;
+
+  SPager *pPager = pEnv->pgrList;
+  memset(&pPager->stat, 0, sizeof(pPager->stat));
+
+  pRes->nBytes = 0;
+  for (int iTxn = 0; iTxn < nTxn; iTxn++) {
+    TXN *txn;
+    tdbBegin(pEnv, &txn, benchMalloc, benchFree, NULL, TDB_TXN_WRITE | TDB_TXN_READ_UNCOMMITTED);
+    for (int iData = iTxn * nDataPerTxn; iData < (iTxn + 1) * nDataPerTxn; iData++) {
+      char key[64];
+      char val[64];
+      int  kLen = sprintf(key, "key%d", iData);
+      int  vLen = sprintf(val, "value%d", iData);
+      if (tdbTbInsert(pTb, key, kLen, val, vLen, txn) < 0) return -1;
+      pRes->nBytes += kLen + vLen;
+    }
+    if (tdbCommit(pEnv, txn) < 0 || tdbPostCommit(pEnv, txn) < 0) return -1;
+  }
+
+  pRes->nCommit = pPager->stat.nCommit;
+  pRes->commitTime = pPager->stat.commitTime;
+  pRes->nSync = atomic_load_64(&pPager->stat.nSync);
+  pRes->nWriteBytes = pPager->stat.nWriteBytes;
+  tdbTbClose(pTb);
+  return tdbClose(pEnv);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int nTxn = (argc > 1) ? atoi(argv[1]) : 1000;
+  int nDataPerTxn = (argc > 2) ? atoi(argv[2]) : 100;
+
+  printf("%8s %8s %16s %16s %10s\n", "mode", "commits", "us per commit", "fsyncs/commit", "write amp");
+  for (int8_t walMode = 0; walMode <= 1; walMode++) {
+    SBenchResult res = {0};
+    if (benchRun(walMode, nTxn, nDataPerTxn, &res) < 0) {
+      printf("failed to run the %s mode\n", walMode ? "wal" : "journal");
+      return -1;
+    }
+
+    int64_t nCommit = TMAX(res.nCommit, 1);
+    printf("%8s %8" PRId64 " %16.1f %16.2f %10.2f\n", walMode ? "wal" : "journal", res.nCommit,
+           (double)res.commitTime / nCommit, (double)res.nSync / nCommit,
+           (double)res.nWriteBytes / TMAX(res.nBytes, 1));
+  }
+
+  taosRemoveDir("tdb");
+  return 0;
+}
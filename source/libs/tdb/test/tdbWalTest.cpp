@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#define ALLOW_FORBID_FUNC
+#include "os.h"
+#include "tdbInt.h"
+
+static int tKeyCmpr(const void *pKey1, int kLen1, const void *pKey2, int kLen2) {
+  int k1 = atoi((const char *)pKey1 + 3);
+  int k2 = atoi((const char *)pKey2 + 3);
+
+  if (k1 < k2) {
+    return -1;
+  } else if (k1 > k2) {
+    return 1;
+  } else {
+    return 0;
+  }
+}
+
+static void *tMalloc(void *arg, size_t size) { return taosMemoryMalloc(size); }
+static void  tFree(void *arg, void *ptr) { taosMemoryFree(ptr); }
+
+static void insertData(TDB *pEnv, TTB *pTb, int from, int to, bool commit) {
+  TXN *txn;
+  char key[64];
+  char val[64];
+
+  tdbBegin(pEnv, &txn, tMalloc, tFree, NULL, TDB_TXN_WRITE | TDB_TXN_READ_UNCOMMITTED);
+  for (int iData = from; iData < to; iData++) {
+    sprintf(key, "key%d", iData);
+    sprintf(val, "value%d", iData);
+    GTEST_ASSERT_EQ(tdbTbInsert(pTb, key, strlen(key), val, strlen(val), txn), 0);
+  }
+
+  if (commit) {
+    GTEST_ASSERT_EQ(tdbCommit(pEnv, txn), 0);
+    GTEST_ASSERT_EQ(tdbPostCommit(pEnv, txn), 0);
+  } else {
+    GTEST_ASSERT_EQ(tdbAbort(pEnv, txn), 0);
+  }
+}
+
+static void checkData(const char *dbname, int nData, int nAborted) {
+  TDB  *pEnv;
+  TTB  *pTb;
+  void *pVal = NULL;
+  int   vLen;
+  char  key[64];
+  char  val[64];
+
+  GTEST_ASSERT_EQ(tdbOpen(dbname, 4096, 64, &pEnv, 0), 0);
+  GTEST_ASSERT_EQ(tdbTbOpen("db.db", -1, -1, tKeyCmpr, pEnv, &pTb, 0), 0);
+
+  for (int iData = 0; iData < nData; iData++) {
+    sprintf(key, "key%d", iData);
+    sprintf(val, "value%d", iData);
+    GTEST_ASSERT_EQ(tdbTbGet(pTb, key, strlen(key), &pVal, &vLen), 0);
+    GTEST_ASSERT_EQ(vLen, (int)strlen(val));
+    GTEST_ASSERT_EQ(memcmp(val, pVal, vLen), 0);
+  }
+
+  for (int iData = nData; iData < nData + nAborted; iData++) {
+    sprintf(key, "key%d", iData);
+    GTEST_ASSERT_NE(tdbTbGet(pTb, key, strlen(key), &pVal, &vLen), 0);
+  }
+
+  tdbFree(pVal);
+  tdbTbClose(pTb);
+  GTEST_ASSERT_EQ(tdbClose(pEnv), 0);
+}
+
+TEST(tdb_wal_test, commit_abort_recover) {
+  TDB *pEnv;
+  TTB *pTb;
+  int  nData = 20000;
+
+  taosRemoveDir("tdb");
+  taosRemoveDir("tdb_crash");
+
+  // a small cache so the pages are flushed to the wal before the commit
+  GTEST_ASSERT_EQ(tdbOpenEx("tdb", 4096, 64, &pEnv, 0, TDB_OPEN_WAL), 0);
+  GTEST_ASSERT_EQ(tdbTbOpen("db.db", -1, -1, tKeyCmpr, pEnv, &pTb, 0), 0);
+
+  insertData(pEnv, pTb, 0, nData / 2, true);
+  insertData(pEnv, pTb, nData / 2, nData, true);
+  insertData(pEnv, pTb, nData, nData + 1000, false);
+
+  // what a crash leaves behind: the db file partly checkpointed and the wal
+  taosMulMkDir("tdb_crash");
+  GTEST_ASSERT_GE(taosCopyFile("tdb/main.tdb", "tdb_crash/main.tdb"), 0);
+  GTEST_ASSERT_GE(taosCopyFile("tdb/main.tdb-wal", "tdb_crash/main.tdb-wal"), 0);
+
+  tdbTbClose(pTb);
+  GTEST_ASSERT_EQ(tdbClose(pEnv), 0);
+
+  // the wal is checkpointed on close, the db file is complete by itself
+  ASSERT_FALSE(taosCheckExistFile("tdb/main.tdb-wal"));
+  checkData("tdb", nData, 1000);
+
+  // the committed txns are replayed from the wal, the aborted one is dropped
+  checkData("tdb_crash", nData, 1000);
+  ASSERT_FALSE(taosCheckExistFile("tdb_crash/main.tdb-wal"));
+}
+
+// a commit syncs the journal and the db file in the journal mode, and only the wal in the wal mode
+TEST(tdb_wal_test, commit_sync) {
+  int     nTxn = 200;
+  int     nDataPerTxn = 100;
+  int64_t nSync[2] = {0};
+
+  for (int walMode = 0; walMode <= 1; walMode++) {
+    TDB *pEnv;
+    TTB *pTb;
+
+    taosRemoveDir("tdb");
+
+    GTEST_ASSERT_EQ(tdbOpenEx("tdb", 4096, 256, &pEnv, 0, walMode ? TDB_OPEN_WAL : 0), 0);
+    GTEST_ASSERT_EQ(tdbTbOpen("db.db", -1, -1, tKeyCmpr, pEnv, &pTb, 0), 0);
+
+    SPager *pPager = pEnv->pgrList;
+    memset(&pPager->stat, 0, sizeof(pPager->stat));
+
+    for (int iTxn = 0; iTxn < nTxn; iTxn++) {
+      insertData(pEnv, pTb, iTxn * nDataPerTxn, (iTxn + 1) * nDataPerTxn, true);
+    }
+
+    GTEST_ASSERT_EQ(pPager->stat.nCommit, nTxn);
+    nSync[walMode] = atomic_load_64(&pPager->stat.nSync);
+    tdbInfo("%s mode: %" PRId64 " commits, %" PRId64 " fsyncs, %" PRId64 " bytes written",
+            walMode ? "wal" : "journal", pPager->stat.nCommit, nSync[walMode], pPager->stat.nWriteBytes);
+
+    tdbTbClose(pTb);
+    GTEST_ASSERT_EQ(tdbClose(pEnv), 0);
+    checkData("tdb", nTxn * nDataPerTxn, 0);
+  }
+
+  GTEST_ASSERT_EQ(nSync[0], 2 * nTxn);
+  // one fsync per commit, and a few more by the checkpoints done meanwhile
+  GTEST_ASSERT_GE(nSync[1], nTxn);
+  GTEST_ASSERT_LT(nSync[1], nSync[0]);
+}
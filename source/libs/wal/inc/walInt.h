@@ -166,6 +166,33 @@ int64_t walGetSeq();
 int     walSeekWriteVer(SWal* pWal, int64_t ver);
 int32_t walRollImpl(SWal* pWal);
 
+// segment section
+// A sealed file is one the writer has rolled over and whose entries are all committed, so it can not be rolled back
+// any more. It is mapped once and shared by all the readers, which decode the entries from the mapping instead of
+// reading the files by themselves.
+typedef struct SWalSegment {
+  int64_t firstVer;
+  int64_t lastVer;
+  int64_t logSize;
+  int64_t idxSize;
+  char*   pLog;
+  char*   pIdx;
+  int32_t ref;
+  int8_t  dropped;
+} SWalSegment;
+
+static inline bool walIsSealedFile(SWal* pWal, const SWalFileInfo* pInfo) {
+  return pInfo != taosArrayGetLast(pWal->fileInfoSet) && pInfo->lastVer >= pInfo->firstVer &&
+         pInfo->lastVer <= pWal->vers.commitVer;
+}
+
+int32_t      walInitSegments(SWal* pWal);
+void         walCloseSegments(SWal* pWal);
+SWalSegment* walAcquireSegment(SWal* pWal, const SWalFileInfo* pInfo);
+void         walReleaseSegment(SWal* pWal, SWalSegment* pSeg);
+void         walDropSegment(SWal* pWal, int64_t fileFirstVer);
+// segment section end
+
 #ifdef __cplusplus
 }
 #endif
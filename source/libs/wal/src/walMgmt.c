@@ -114,6 +114,12 @@ SWal *walOpen(const char *path, SWalCfg *pCfg) {
     goto _err;
   }
 
+  // init segments
+  if (walInitSegments(pWal) < 0) {
+    wError("vgId:%d, failed to init wal segments since %s", pWal->cfg.vgId, terrstr());
+    goto _err;
+  }
+
   // open meta
   walResetVer(&pWal->vers);
   pWal->pLogFile = NULL;
@@ -170,6 +176,7 @@ SWal *walOpen(const char *path, SWalCfg *pCfg) {
 _err:
   taosArrayDestroy(pWal->fileInfoSet);
   taosHashCleanup(pWal->pRefHash);
+  walCloseSegments(pWal);
   taosThreadMutexDestroy(&pWal->mutex);
   taosMemoryFree(pWal);
   pWal = NULL;
@@ -214,6 +221,7 @@ void walClose(SWal *pWal) {
   pWal->fileInfoSet = NULL;
   taosArrayDestroy(pWal->toDeleteFiles);
   pWal->toDeleteFiles = NULL;
+  walCloseSegments(pWal);
 
   void *pIter = NULL;
   while (1) {
@@ -63,6 +63,8 @@ SWalReader *walOpenReader(SWal *pWal, SWalFilterCond *cond) {
 void walCloseReader(SWalReader *pReader) {
   taosCloseFile(&pReader->pIdxFile);
   taosCloseFile(&pReader->pLogFile);
+  walReleaseSegment(pReader->pWal, pReader->pSeg);
+  pReader->pSeg = NULL;
   /*if (pReader->cond.enableRef) {*/
   /*taosHashRemove(pReader->pWal->pRefHash, &pReader->readerId, sizeof(int64_t));*/
   /*}*/
@@ -70,6 +72,38 @@ void walCloseReader(SWalReader *pReader) {
   taosMemoryFree(pReader);
 }
 
+// read from the mapped segment if the current file is sealed, otherwise from the log file
+static int64_t walReadLog(SWalReader *pReader, void *buf, int64_t count) {
+  SWalSegment *pSeg = pReader->pSeg;
+  if (pSeg == NULL) {
+    return taosReadFile(pReader->pLogFile, buf, count);
+  }
+
+  if (count < 0) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  count = TMIN(count, pSeg->logSize - pReader->segOffset);
+  memcpy(buf, pSeg->pLog + pReader->segOffset, count);
+  pReader->segOffset += count;
+  return count;
+}
+
+static int64_t walSkipLog(SWalReader *pReader, int64_t count) {
+  if (pReader->pSeg == NULL) {
+    return taosLSeekFile(pReader->pLogFile, count, SEEK_CUR);
+  }
+
+  if (count < 0) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  pReader->segOffset = TMIN(pReader->segOffset + count, pReader->pSeg->logSize);
+  return pReader->segOffset;
+}
+
 int32_t walNextValidMsg(SWalReader *pReader) {
   int64_t fetchVer = pReader->curVersion;
   int64_t lastVer = walGetLastVer(pReader->pWal);
@@ -103,9 +137,37 @@ int32_t walNextValidMsg(SWalReader *pReader) {
   return -1;
 }
 
+static int64_t walReadSeekSegmentPos(SWalReader *pReader, int64_t fileFirstVer, int64_t ver) {
+  SWalSegment *pSeg = pReader->pSeg;
+  SWalIdxEntry entry = {0};
+
+  int64_t offset = (ver - fileFirstVer) * sizeof(SWalIdxEntry);
+  if (offset < 0 || offset + (int64_t)sizeof(SWalIdxEntry) > pSeg->idxSize) {
+    terrno = TSDB_CODE_WAL_FILE_CORRUPTED;
+    wError("vgId:%d, failed to find index:%" PRId64 " in wal segment %" PRId64, pReader->pWal->cfg.vgId, ver,
+           fileFirstVer);
+    return -1;
+  }
+
+  memcpy(&entry, pSeg->pIdx + offset, sizeof(SWalIdxEntry));
+  if (entry.offset < 0 || entry.offset > pSeg->logSize) {
+    terrno = TSDB_CODE_WAL_FILE_CORRUPTED;
+    wError("vgId:%d, invalid pos:%" PRId64 " of index:%" PRId64 " in wal segment %" PRId64, pReader->pWal->cfg.vgId,
+           entry.offset, ver, fileFirstVer);
+    return -1;
+  }
+
+  pReader->segOffset = entry.offset;
+  return entry.offset;
+}
+
 static int64_t walReadSeekFilePos(SWalReader *pReader, int64_t fileFirstVer, int64_t ver) {
   int64_t ret = 0;
 
+  if (pReader->pSeg != NULL) {
+    return walReadSeekSegmentPos(pReader, fileFirstVer, ver);
+  }
+
   TdFilePtr pIdxTFile = pReader->pIdxFile;
   TdFilePtr pLogTFile = pReader->pLogFile;
 
@@ -141,11 +203,24 @@ static int64_t walReadSeekFilePos(SWalReader *pReader, int64_t fileFirstVer, int
   return ret;
 }
 
-static int32_t walReadChangeFile(SWalReader *pReader, int64_t fileFirstVer) {
-  char fnameStr[WAL_FILE_LEN] = {0};
+static int32_t walReadChangeFile(SWalReader *pReader, const SWalFileInfo *pInfo) {
+  char    fnameStr[WAL_FILE_LEN] = {0};
+  int64_t fileFirstVer = pInfo->firstVer;
 
   taosCloseFile(&pReader->pIdxFile);
   taosCloseFile(&pReader->pLogFile);
+  walReleaseSegment(pReader->pWal, pReader->pSeg);
+  pReader->pSeg = NULL;
+
+  // sealed files are read from the mapping shared with the other readers
+  if (walIsSealedFile(pReader->pWal, pInfo)) {
+    pReader->pSeg = walAcquireSegment(pReader->pWal, pInfo);
+    if (pReader->pSeg != NULL) {
+      pReader->segOffset = 0;
+      pReader->curFileFirstVer = fileFirstVer;
+      return 0;
+    }
+  }
 
   walBuildLogName(pReader->pWal, fileFirstVer, fnameStr);
   TdFilePtr pLogFile = taosOpenFile(fnameStr, TD_FILE_READ);
@@ -186,7 +261,7 @@ int32_t walReadSeekVerImpl(SWalReader *pReader, int64_t ver) {
   }
   if (pReader->curFileFirstVer != pRet->firstVer) {
     // error code was set inner
-    if (walReadChangeFile(pReader, pRet->firstVer) < 0) {
+    if (walReadChangeFile(pReader, pRet) < 0) {
       return -1;
     }
   }
@@ -247,7 +322,7 @@ static int32_t walFetchHeadNew(SWalReader *pRead, int64_t fetchVer) {
     seeked = true;
   }
   while (1) {
-    contLen = taosReadFile(pRead->pLogFile, pRead->pHead, sizeof(SWalCkHead));
+    contLen = walReadLog(pRead, pRead->pHead, sizeof(SWalCkHead));
     if (contLen == sizeof(SWalCkHead)) {
       break;
     } else if (contLen == 0 && !seeked) {
@@ -286,7 +361,7 @@ static int32_t walFetchBodyNew(SWalReader *pReader) {
     pReader->capacity = pReadHead->bodyLen;
   }
 
-  if (pReadHead->bodyLen != taosReadFile(pReader->pLogFile, pReadHead->body, pReadHead->bodyLen)) {
+  if (pReadHead->bodyLen != walReadLog(pReader, pReadHead->body, pReadHead->bodyLen)) {
     if (pReadHead->bodyLen < 0) {
       terrno = TAOS_SYSTEM_ERROR(errno);
       wError("vgId:%d, wal fetch body error:%" PRId64 ", read request index:%" PRId64 ", since %s",
@@ -316,7 +391,7 @@ static int32_t walFetchBodyNew(SWalReader *pReader) {
 static int32_t walSkipFetchBodyNew(SWalReader *pRead) {
   int64_t code;
 
-  code = taosLSeekFile(pRead->pLogFile, pRead->pHead->head.bodyLen, SEEK_CUR);
+  code = walSkipLog(pRead, pRead->pHead->head.bodyLen);
   if (code < 0) {
     terrno = TAOS_SYSTEM_ERROR(errno);
 //    pRead->curInvalid = 1;
@@ -355,7 +430,7 @@ int32_t walFetchHead(SWalReader *pRead, int64_t ver, SWalCkHead *pHead) {
   }
 
   while (1) {
-    contLen = taosReadFile(pRead->pLogFile, pHead, sizeof(SWalCkHead));
+    contLen = walReadLog(pRead, pHead, sizeof(SWalCkHead));
     if (contLen == sizeof(SWalCkHead)) {
       break;
     } else if (contLen == 0 && !seeked) {
@@ -393,7 +468,7 @@ int32_t walSkipFetchBody(SWalReader *pRead, const SWalCkHead *pHead) {
          pRead->pWal->cfg.vgId, pHead->head.version, pRead->pWal->vers.firstVer, pRead->pWal->vers.commitVer,
          pRead->pWal->vers.lastVer, pRead->pWal->vers.appliedVer);
 
-  code = taosLSeekFile(pRead->pLogFile, pHead->head.bodyLen, SEEK_CUR);
+  code = walSkipLog(pRead, pHead->head.bodyLen);
   if (code < 0) {
     terrno = TAOS_SYSTEM_ERROR(errno);
 //    pRead->curInvalid = 1;
@@ -425,7 +500,7 @@ int32_t walFetchBody(SWalReader *pRead, SWalCkHead **ppHead) {
     pRead->capacity = pReadHead->bodyLen;
   }
 
-  if (pReadHead->bodyLen != taosReadFile(pRead->pLogFile, pReadHead->body, pReadHead->bodyLen)) {
+  if (pReadHead->bodyLen != walReadLog(pRead, pReadHead->body, pReadHead->bodyLen)) {
     if (pReadHead->bodyLen < 0) {
       terrno = TAOS_SYSTEM_ERROR(errno);
       wError("vgId:%d, wal fetch body error:%" PRId64 ", read request index:%" PRId64 ", since %s",
@@ -489,7 +564,7 @@ int32_t walReadVer(SWalReader *pReader, int64_t ver) {
   }
 
   while (1) {
-    contLen = taosReadFile(pReader->pLogFile, pReader->pHead, sizeof(SWalCkHead));
+    contLen = walReadLog(pReader, pReader->pHead, sizeof(SWalCkHead));
     if (contLen == sizeof(SWalCkHead)) {
       break;
     } else if (contLen == 0 && !seeked) {
@@ -530,7 +605,7 @@ int32_t walReadVer(SWalReader *pReader, int64_t ver) {
     pReader->capacity = pReader->pHead->head.bodyLen;
   }
 
-  if ((contLen = taosReadFile(pReader->pLogFile, pReader->pHead->head.body, pReader->pHead->head.bodyLen)) !=
+  if ((contLen = walReadLog(pReader, pReader->pHead->head.body, pReader->pHead->head.bodyLen)) !=
       pReader->pHead->head.bodyLen) {
     if (contLen < 0)
       terrno = TAOS_SYSTEM_ERROR(errno);
@@ -575,6 +650,8 @@ void walReadReset(SWalReader *pReader) {
   taosThreadMutexLock(&pReader->mutex);
   taosCloseFile(&pReader->pIdxFile);
   taosCloseFile(&pReader->pLogFile);
+  walReleaseSegment(pReader->pWal, pReader->pSeg);
+  pReader->pSeg = NULL;
   pReader->curInvalid = 1;
   pReader->curFileFirstVer = -1;
   pReader->curVersion = -1;
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "taoserror.h"
+#include "walInt.h"
+
+// segments no reader is using are kept mapped up to this number
+#define WAL_MAX_CACHED_SEGMENTS 8
+
+int32_t walInitSegments(SWal *pWal) {
+  pWal->pSegments = taosArrayInit(8, POINTER_BYTES);
+  if (pWal->pSegments == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  if (taosThreadMutexInit(&pWal->segMutex, NULL) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    taosArrayDestroy(pWal->pSegments);
+    pWal->pSegments = NULL;
+    return -1;
+  }
+
+  return 0;
+}
+
+static void walUnmapSegment(SWalSegment *pSeg) {
+  wDebug("wal segment %" PRId64 " is unmapped, log size:%" PRId64, pSeg->firstVer, pSeg->logSize);
+  taosMunmapFile(pSeg->pLog, pSeg->logSize);
+  taosMunmapFile(pSeg->pIdx, pSeg->idxSize);
+  taosMemoryFree(pSeg);
+}
+
+void walCloseSegments(SWal *pWal) {
+  if (pWal->pSegments == NULL) {
+    return;
+  }
+
+  // all the readers are supposed to be closed before the wal
+  int32_t size = taosArrayGetSize(pWal->pSegments);
+  for (int32_t i = 0; i < size; ++i) {
+    SWalSegment *pSeg = taosArrayGetP(pWal->pSegments, i);
+    if (pSeg->ref > 0) {
+      wWarn("vgId:%d, wal segment %" PRId64 " is still used by %d readers", pWal->cfg.vgId, pSeg->firstVer, pSeg->ref);
+    }
+    walUnmapSegment(pSeg);
+  }
+
+  taosArrayDestroy(pWal->pSegments);
+  pWal->pSegments = NULL;
+  taosThreadMutexDestroy(&pWal->segMutex);
+}
+
+static SWalSegment *walMapSegment(SWal *pWal, const SWalFileInfo *pInfo) {
+  char         fnameStr[WAL_FILE_LEN];
+  TdFilePtr    pLogFile = NULL;
+  TdFilePtr    pIdxFile = NULL;
+  int64_t      fileSize = 0;
+  SWalSegment *pSeg = taosMemoryCalloc(1, sizeof(SWalSegment));
+  if (pSeg == NULL) {
+    return NULL;
+  }
+
+  pSeg->firstVer = pInfo->firstVer;
+  pSeg->lastVer = pInfo->lastVer;
+  pSeg->logSize = pInfo->fileSize;
+  pSeg->idxSize = (pInfo->lastVer - pInfo->firstVer + 1) * sizeof(SWalIdxEntry);
+
+  // the files are never appended to or truncated once sealed, a short file means the meta is out of date
+  walBuildLogName(pWal, pInfo->firstVer, fnameStr);
+  pLogFile = taosOpenFile(fnameStr, TD_FILE_READ);
+  if (pLogFile == NULL || taosFStatFile(pLogFile, &fileSize, NULL) < 0 || fileSize < pSeg->logSize) {
+    goto _err;
+  }
+
+  walBuildIdxName(pWal, pInfo->firstVer, fnameStr);
+  pIdxFile = taosOpenFile(fnameStr, TD_FILE_READ);
+  if (pIdxFile == NULL || taosFStatFile(pIdxFile, &fileSize, NULL) < 0 || fileSize < pSeg->idxSize) {
+    goto _err;
+  }
+
+  pSeg->pLog = taosMmapReadOnlyFile(pLogFile, pSeg->logSize);
+  pSeg->pIdx = taosMmapReadOnlyFile(pIdxFile, pSeg->idxSize);
+  if (pSeg->pLog == NULL || pSeg->pIdx == NULL) {
+    goto _err;
+  }
+
+  // the mappings stay valid after the files are closed, or even removed
+  taosCloseFile(&pLogFile);
+  taosCloseFile(&pIdxFile);
+
+  wDebug("vgId:%d, wal segment %" PRId64 " is mapped, log size:%" PRId64, pWal->cfg.vgId, pSeg->firstVer,
+         pSeg->logSize);
+  return pSeg;
+
+_err:
+  wDebug("vgId:%d, wal segment %" PRId64 " can not be mapped, read it from the files", pWal->cfg.vgId,
+         pInfo->firstVer);
+  taosCloseFile(&pLogFile);
+  taosCloseFile(&pIdxFile);
+  taosMunmapFile(pSeg->pLog, pSeg->logSize);
+  taosMunmapFile(pSeg->pIdx, pSeg->idxSize);
+  taosMemoryFree(pSeg);
+  return NULL;
+}
+
+// NULL is returned if the file can not be mapped, the reader should fall back to read the files then
+SWalSegment *walAcquireSegment(SWal *pWal, const SWalFileInfo *pInfo) {
+  SWalSegment *pSeg = NULL;
+
+  taosThreadMutexLock(&pWal->segMutex);
+  int32_t size = taosArrayGetSize(pWal->pSegments);
+  for (int32_t i = 0; i < size; ++i) {
+    SWalSegment *p = taosArrayGetP(pWal->pSegments, i);
+    if (p->firstVer == pInfo->firstVer && !p->dropped) {
+      pSeg = p;
+      break;
+    }
+  }
+
+  if (pSeg == NULL) {
+    pSeg = walMapSegment(pWal, pInfo);
+    if (pSeg != NULL && taosArrayPush(pWal->pSegments, &pSeg) == NULL) {
+      walUnmapSegment(pSeg);
+      pSeg = NULL;
+    }
+  }
+
+  if (pSeg != NULL) {
+    pSeg->ref++;
+  }
+  taosThreadMutexUnlock(&pWal->segMutex);
+
+  return pSeg;
+}
+
+static void walRemoveSegment(SWal *pWal, int32_t index) {
+  SWalSegment *pSeg = taosArrayGetP(pWal->pSegments, index);
+  taosArrayRemove(pWal->pSegments, index);
+  walUnmapSegment(pSeg);
+}
+
+void walReleaseSegment(SWal *pWal, SWalSegment *pSeg) {
+  if (pSeg == NULL) {
+    return;
+  }
+
+  taosThreadMutexLock(&pWal->segMutex);
+  pSeg->ref--;
+
+  // unmap the dropped one once the last reader leaves it, and the least recently mapped ones beyond the limit
+  int32_t size = taosArrayGetSize(pWal->pSegments);
+  if (pSeg->ref == 0 && pSeg->dropped) {
+    for (int32_t i = 0; i < size; ++i) {
+      if (taosArrayGetP(pWal->pSegments, i) == pSeg) {
+        walRemoveSegment(pWal, i);
+        size--;
+        break;
+      }
+    }
+  }
+
+  for (int32_t i = 0; i < size && size > WAL_MAX_CACHED_SEGMENTS;) {
+    SWalSegment *p = taosArrayGetP(pWal->pSegments, i);
+    if (p->ref == 0) {
+      walRemoveSegment(pWal, i);
+      size--;
+    } else {
+      i++;
+    }
+  }
+  taosThreadMutexUnlock(&pWal->segMutex);
+}
+
+// the file is removed, or going to be rewritten, so new readers should not get the segment mapped before
+void walDropSegment(SWal *pWal, int64_t fileFirstVer) {
+  taosThreadMutexLock(&pWal->segMutex);
+  int32_t size = taosArrayGetSize(pWal->pSegments);
+  for (int32_t i = 0; i < size; ++i) {
+    SWalSegment *pSeg = taosArrayGetP(pWal->pSegments, i);
+    if (pSeg->firstVer != fileFirstVer || pSeg->dropped) {
+      continue;
+    }
+
+    if (pSeg->ref == 0) {
+      walRemoveSegment(pWal, i);
+    } else {
+      pSeg->dropped = 1;
+    }
+    break;
+  }
+  taosThreadMutexUnlock(&pWal->segMutex);
+}
@@ -44,6 +44,7 @@ int32_t walRestoreFromSnapshot(SWal *pWal, int64_t ver) {
     for (int32_t i = 0; i < fileSetSize; i++) {
       SWalFileInfo *pFileInfo = taosArrayGet(pWal->fileInfoSet, i);
       char          fnameStr[WAL_FILE_LEN];
+      walDropSegment(pWal, pFileInfo->firstVer);
       walBuildLogName(pWal, pFileInfo->firstVer, fnameStr);
       if (taosRemoveFile(fnameStr) < 0) {
         terrno = TAOS_SYSTEM_ERROR(errno);
@@ -123,6 +124,7 @@ int32_t walRollback(SWal *pWal, int64_t ver) {
     for (int i = pWal->writeCur + 1; i < fileSetSize; i++) {
       SWalFileInfo *pInfo = taosArrayPop(pWal->fileInfoSet);
 
+      walDropSegment(pWal, pInfo->firstVer);
       walBuildLogName(pWal, pInfo->firstVer, fnameStr);
       wDebug("vgId:%d, wal remove file %s for rollback", pWal->cfg.vgId, fnameStr);
       taosRemoveFile(fnameStr);
@@ -365,6 +367,7 @@ int32_t walEndSnapshot(SWal *pWal) {
   char fnameStr[WAL_FILE_LEN];
   for (int i = 0; i < deleteCnt; i++) {
     pInfo = taosArrayGet(pWal->toDeleteFiles, i);
+    walDropSegment(pWal, pInfo->firstVer);
     walBuildLogName(pWal, pInfo->firstVer, fnameStr);
     wDebug("vgId:%d, wal remove file %s", pWal->cfg.vgId, fnameStr);
     if (taosRemoveFile(fnameStr) < 0 && errno != ENOENT) {
@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
+#include <atomic>
 #include <cstring>
 #include <iostream>
 #include <queue>
+#include <thread>
+#include <vector>
 
 #include "walInt.h"
 
@@ -442,3 +445,137 @@ TEST_F(WalRetentionEnv, repairMeta1) {
     }
   }
 }
+
+class WalSegmentEnv : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() {
+    int code = walInit();
+    ASSERT(code == 0);
+  }
+
+  static void TearDownTestCase() { walCleanUp(); }
+
+  void SetUp() override {
+    taosRemoveDir(pathName);
+    SWalCfg cfg;
+    memset(&cfg, 0, sizeof(SWalCfg));
+    cfg.rollPeriod = -1;
+    cfg.segSize = 64;
+    cfg.retentionPeriod = 0;
+    cfg.retentionSize = 0;
+    cfg.level = TAOS_WAL_WRITE;
+    pWal = walOpen(pathName, &cfg);
+    ASSERT(pWal != NULL);
+  }
+
+  void TearDown() override {
+    walClose(pWal);
+    pWal = NULL;
+  }
+
+  // the body of each entry carries its version, the files roll every 64KB
+  void writeEntries(int num) {
+    char body[256];
+    for (int i = 0; i < num; i++) {
+      memset(body, 'a' + i % 26, sizeof(body));
+      sprintf(body, "%s-%d", ranStr, i);
+      ASSERT_EQ(walWrite(pWal, i, 0, body, sizeof(body)), 0);
+      ASSERT_EQ(walCommit(pWal, i), 0);
+    }
+  }
+
+  static bool checkEntry(SWalReader* pRead, int64_t ver) {
+    char body[256];
+    memset(body, 'a' + ver % 26, sizeof(body));
+    sprintf(body, "%s-%d", ranStr, (int)ver);
+    return pRead->pHead->head.version == ver && pRead->pHead->head.bodyLen == sizeof(body) &&
+           memcmp(pRead->pHead->head.body, body, sizeof(body)) == 0;
+  }
+
+  SWal*       pWal = NULL;
+  const char* pathName = TD_TMP_DIR_PATH "wal_test";
+};
+
+TEST_F(WalSegmentEnv, readSealedSegment) {
+  int num = 2000;
+  writeEntries(num);
+  ASSERT_GT(taosArrayGetSize(pWal->fileInfoSet), 2);
+
+  SWalReader* pRead = walOpenReader(pWal, NULL);
+  ASSERT(pRead != NULL);
+
+  SWalFileInfo* pLastInfo = (SWalFileInfo*)taosArrayGetLast(pWal->fileInfoSet);
+  for (int64_t ver = 0; ver < num; ver++) {
+    ASSERT_EQ(walReadVer(pRead, ver), 0);
+    ASSERT_TRUE(checkEntry(pRead, ver));
+    // the sealed files are read from the mapping, the last one from the file
+    ASSERT_EQ(pRead->pSeg != NULL, ver < pLastInfo->firstVer);
+  }
+
+  // remove the first file by a snapshot while the reader is still on it
+  SWalFileInfo* pFirstInfo = (SWalFileInfo*)taosArrayGet(pWal->fileInfoSet, 0);
+  int64_t       lastVer = pFirstInfo->lastVer;
+  ASSERT_EQ(walReadVer(pRead, 0), 0);
+  ASSERT_EQ(walBeginSnapshot(pWal, lastVer, 0), 0);
+  ASSERT_EQ(walEndSnapshot(pWal), 0);
+  ASSERT_EQ(pWal->vers.firstVer, lastVer + 1);
+  for (int64_t ver = 1; ver <= lastVer; ver++) {
+    ASSERT_EQ(walReadVer(pRead, ver), -1);
+  }
+
+  walCloseReader(pRead);
+
+  // it is unmapped once the reader leaves it
+  for (int i = 0; i < taosArrayGetSize(pWal->pSegments); i++) {
+    ASSERT_NE(((SWalSegment*)taosArrayGetP(pWal->pSegments, i))->firstVer, 0);
+  }
+
+  pRead = walOpenReader(pWal, NULL);
+  ASSERT(pRead != NULL);
+  ASSERT_EQ(walReadVer(pRead, lastVer), -1);
+  for (int64_t ver = lastVer + 1; ver < num; ver++) {
+    ASSERT_EQ(walReadVer(pRead, ver), 0);
+    ASSERT_TRUE(checkEntry(pRead, ver));
+  }
+  walCloseReader(pRead);
+}
+
+// subscriptions and replicas catching up read the same sealed files at the same time
+TEST_F(WalSegmentEnv, concurrentRead) {
+  int num = 20000;
+  int nReaders = 8;
+  writeEntries(num);
+
+  auto read = [](SWal* pWal, int num, std::atomic<int64_t>* nRead) {
+    SWalReader* pRead = walOpenReader(pWal, NULL);
+    int64_t     n = 0;
+    for (int64_t ver = 0; ver < num; ver++) {
+      if (walReadVer(pRead, ver) == 0 && checkEntry(pRead, ver)) {
+        n++;
+      }
+    }
+    walCloseReader(pRead);
+    *nRead += n;
+  };
+
+  std::atomic<int64_t>     nRead(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < nReaders; i++) {
+    threads.push_back(std::thread(read, pWal, num, &nRead));
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+  ASSERT_EQ(nRead.load(), (int64_t)num * nReaders);
+
+  // each sealed file is mapped once for all the readers, and none of them holds it any more
+  int32_t size = taosArrayGetSize(pWal->pSegments);
+  ASSERT_GT(size, 0);
+  for (int32_t i = 0; i < size; i++) {
+    SWalSegment* pSeg = (SWalSegment*)taosArrayGetP(pWal->pSegments, i);
+    ASSERT_EQ(pSeg->ref, 0);
+    for (int32_t j = i + 1; j < size; j++) {
+      ASSERT_NE(pSeg->firstVer, ((SWalSegment*)taosArrayGetP(pWal->pSegments, j))->firstVer);
+    }
+  }
+}
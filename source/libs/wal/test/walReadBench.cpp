@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Entries read per second from the sealed files of one wal by 1, 8 and 64 readers at the same time, as subscriptions
+// and replicas catching up do. Built with -DBUILD_TEST=ON -DBUILD_BENCHMARK=ON, run as
+//   walReadBench [entries]
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "walInt.h"
+
+namespace {
+
+const char* benchPath = TD_TMP_DIR_PATH "wal_bench";
+
+SWal* benchOpen(int num) {
+  SWalCfg cfg;
+  memset(&cfg, 0, sizeof(SWalCfg));
+  cfg.rollPeriod = -1;
+  cfg.segSize = 64;
+  cfg.retentionPeriod = 0;
+  cfg.retentionSize = 0;
+  cfg.level = TAOS_WAL_WRITE;
+
+  taosRemoveDir(benchPath);
+  SWal* pWal = walOpen(benchPath, &cfg);
+  if (pWal == NULL) return NULL;
+
+  char body[256];
+  for (int i = 0; i < num; i++) {
+    memset(body, 'a' + i % 26, sizeof(body));
+    if (walWrite(pWal, i, 0, body, sizeof(body)) < 0 || walCommit(pWal, i) < 0) {
+      walClose(pWal);
+      return NULL;
+    }
+  }
+  return pWal;
+}
+
+void benchRead(SWal* pWal, int num, std::atomic<int64_t>* nRead) {
+  SWalReader* pRead = walOpenReader(pWal, NULL);
+  int64_t     n = 0;
+  for (int64_t ver = 0; ver < num; ver++) {
+    if (walReadVer(pRead, ver) == 0) {
+      n++;
+    }
+  }
+  walCloseReader(pRead);
+  *nRead += n;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int num = (argc > 1) ? atoi(argv[1]) : 20000;
+
+  if (walInit() < 0) {
+    printf("failed to init wal\n");
+    return -1;
+  }
+  SWal* pWal = benchOpen(num);
+  if (pWal == NULL) {
+    printf("failed to write wal\n");
+    return -1;
+  }
+
+  printf("%8s %12s %16s\n", "readers", "entries", "entries/s");
+  int readerNums[] = {1, 8, 64};
+  for (int nReaders : readerNums) {
+    std::atomic<int64_t>     nRead(0);
+    std::vector<std::thread> threads;
+
+    int64_t start = taosGetTimestampUs();
+    for (int i = 0; i < nReaders; i++) {
+      threads.push_back(std::thread(benchRead, pWal, num, &nRead));
+    }
+    for (auto& th : threads) {
+      th.join();
+    }
+    int64_t elapsed = taosGetTimestampUs() - start;
+
+    printf("%8d %12" PRId64 " %16.0f\n", nReaders, nRead.load(), (double)nRead.load() * 1000000 / TMAX(elapsed, 1));
+  }
+
+  walClose(pWal);
+  walCleanUp();
+  taosRemoveDir(benchPath);
+  return 0;
+}
@@ -28,6 +28,7 @@
 #else
 #include <fcntl.h>
 #include <sys/file.h>
+#include <sys/mman.h>
 
 #if !defined(_TD_DARWIN_64)
 #include <sys/sendfile.h>
@@ -793,6 +794,29 @@ void taosFprintfFile(TdFilePtr pFile, const char *format, ...) {
 
 bool taosValidFile(TdFilePtr pFile) { return pFile != NULL && pFile->fd > 0; }
 
+void *taosMmapReadOnlyFile(TdFilePtr pFile, int64_t length) {
+#ifdef WINDOWS
+  return NULL;
+#else
+  if (pFile == NULL || pFile->fd < 0 || length <= 0) {
+    return NULL;
+  }
+  void *ptr = mmap(NULL, length, PROT_READ, MAP_SHARED, pFile->fd, 0);
+  if (ptr == MAP_FAILED) {
+    return NULL;
+  }
+  return ptr;
+#endif
+}
+
+void taosMunmapFile(void *ptr, int64_t length) {
+#ifndef WINDOWS
+  if (ptr != NULL) {
+    munmap(ptr, length);
+  }
+#endif
+}
+
 int32_t taosUmaskFile(int32_t maskVal) {
 #ifdef WINDOWS
   return 0;
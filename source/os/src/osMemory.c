@@ -392,3 +392,49 @@ void* taosMemoryMallocAlign(uint32_t alignment, int64_t size) {
 #endif
 #endif
 }
+
+void *taosMapShm(const char *name, int64_t size, bool create) {
+#ifdef WINDOWS
+  errno = ENOTSUP;
+  return NULL;
+#else
+  int32_t fd = shm_open(name, create ? (O_CREAT | O_EXCL | O_RDWR) : O_RDWR, 0600);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  if (create && ftruncate(fd, size) != 0) {
+    int32_t err = errno;
+    close(fd);
+    shm_unlink(name);
+    errno = err;
+    return NULL;
+  }
+
+  void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  int32_t err = errno;
+  close(fd);
+  if (ptr == MAP_FAILED) {
+    if (create) shm_unlink(name);
+    errno = err;
+    return NULL;
+  }
+  return ptr;
+#endif
+}
+
+void taosUnmapShm(void *ptr, int64_t size) {
+#ifndef WINDOWS
+  if (ptr != NULL) {
+    munmap(ptr, size);
+  }
+#endif
+}
+
+int32_t taosUnlinkShm(const char *name) {
+#ifdef WINDOWS
+  return 0;
+#else
+  return shm_unlink(name);
+#endif
+}
@@ -130,6 +130,11 @@ int tsem_wait(tsem_t *psem) {
   return 0;
 }
 
+int tsem_trywait(tsem_t *psem) {
+  if (psem == NULL || *psem == NULL) return -1;
+  return dispatch_semaphore_wait(*psem, DISPATCH_TIME_NOW) == 0 ? 0 : -1;
+}
+
 int tsem_timewait(tsem_t *psem, int64_t milis) {
   if (psem == NULL || *psem == NULL) return -1;
   dispatch_time_t time = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(milis * USEC_PER_SEC));
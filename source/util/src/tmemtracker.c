@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "tmemtracker.h"
+#include "taoserror.h"
+#include "tlog.h"
+#include "tutil.h"
+
+static threadlocal SMemTracker* tsCurrentMemTracker = NULL;
+
+SMemTracker* taosMemTrackerCreate(const char* label, int64_t limit, SMemTracker* parent) {
+  SMemTracker* pTracker = taosMemoryCalloc(1, sizeof(SMemTracker));
+  if (pTracker == NULL) {
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  pTracker->limit = (limit > 0) ? limit : 0;
+  pTracker->ref = 1;
+  pTracker->parent = (parent != NULL) ? taosMemTrackerRef(parent) : NULL;
+  if (label != NULL) {
+    tstrncpy(pTracker->label, label, sizeof(pTracker->label));
+  }
+
+  return pTracker;
+}
+
+SMemTracker* taosMemTrackerRef(SMemTracker* pTracker) {
+  atomic_add_fetch_32(&pTracker->ref, 1);
+  return pTracker;
+}
+
+void taosMemTrackerUnref(SMemTracker* pTracker) {
+  if (pTracker == NULL || atomic_sub_fetch_32(&pTracker->ref, 1) > 0) {
+    return;
+  }
+
+  int64_t used = atomic_load_64(&pTracker->used);
+  if (used != 0) {
+    uWarn("mem tracker %s freed with %" PRId64 " bytes in use, peak:%" PRId64, pTracker->label, used, pTracker->peak);
+    taosMemTrackerRelease(pTracker, used);
+  }
+
+  taosMemTrackerUnref(pTracker->parent);
+  taosMemoryFree(pTracker);
+}
+
+static void memTrackerUpdatePeak(SMemTracker* pTracker, int64_t used) {
+  int64_t peak = atomic_load_64(&pTracker->peak);
+  while (used > peak) {
+    int64_t old = atomic_val_compare_exchange_64(&pTracker->peak, peak, used);
+    if (old == peak) {
+      break;
+    }
+    peak = old;
+  }
+}
+
+bool taosMemTrackerTryConsume(SMemTracker* pTracker, int64_t size) {
+  if (pTracker == NULL || size <= 0) {
+    return true;
+  }
+
+  SMemTracker* p = pTracker;
+  for (; p != NULL; p = p->parent) {
+    int64_t used = atomic_add_fetch_64(&p->used, size);
+    if (p->limit > 0 && used > p->limit) {
+      break;
+    }
+    memTrackerUpdatePeak(p, used);
+  }
+
+  if (p == NULL) {
+    return true;
+  }
+
+  // roll back every tracker charged so far, including the one over its limit
+  SMemTracker* pEnd = p->parent;
+  for (p = pTracker; p != pEnd; p = p->parent) {
+    atomic_sub_fetch_64(&p->used, size);
+  }
+
+  return false;
+}
+
+void taosMemTrackerConsume(SMemTracker* pTracker, int64_t size) {
+  for (SMemTracker* p = pTracker; p != NULL; p = p->parent) {
+    memTrackerUpdatePeak(p, atomic_add_fetch_64(&p->used, size));
+  }
+}
+
+void taosMemTrackerRelease(SMemTracker* pTracker, int64_t size) {
+  for (SMemTracker* p = pTracker; p != NULL; p = p->parent) {
+    atomic_sub_fetch_64(&p->used, size);
+  }
+}
+
+int64_t taosMemTrackerUsed(const SMemTracker* pTracker) { return atomic_load_64((int64_t*)&pTracker->used); }
+
+int64_t taosMemTrackerPeak(const SMemTracker* pTracker) { return atomic_load_64((int64_t*)&pTracker->peak); }
+
+SMemTracker* taosMemTrackerSwitch(SMemTracker* pTracker) {
+  SMemTracker* prev = tsCurrentMemTracker;
+  tsCurrentMemTracker = pTracker;
+  return prev;
+}
+
+SMemTracker* taosMemTrackerCurrent() { return tsCurrentMemTracker; }
@@ -2,6 +2,7 @@
 #include "tpagedbuf.h"
 #include "taoserror.h"
 #include "tcompression.h"
+#include "tmemtracker.h"
 #include "tsimplehash.h"
 #include "tlog.h"
 
@@ -11,6 +12,10 @@
 #define HAS_DATA_IN_DISK(_p)           ((_p)->offset >= 0)
 #define NO_IN_MEM_AVAILABLE_PAGES(_b)  (listNEles((_b)->lruList) >= (_b)->inMemPages)
 
+#define SPILL_MAX_PENDING_WRITES 16  // the owner blocks when more evicted pages are waiting to be written
+#define SPILL_MAX_PREFETCH_PAGES 8
+#define SPILL_MAX_WORKERS        4
+
 typedef struct SPageDiskInfo {
   int64_t offset;
   int32_t length;
@@ -49,8 +54,233 @@ struct SDiskbasedBuf {
   char*               id;           // for debug purpose
   bool                printStatis;  // Print statistics info when closing this buffer.
   SDiskbasedBufStatis statis;
+  SMemTracker*        pMemTracker;  // charged with the in-memory pages, NULL if not tracked
+  int32_t             memPages;     // number of in-memory pages charged to pMemTracker
+
+  bool                 async;         // evicted pages are written behind, and pages are read ahead, by pWorker
+  struct SSpillWorker* pWorker;       // the spill thread this buffer is bound to
+  TdThreadMutex        spillLock;     // protects the fields below and the statis updated by the spill thread
+  TdThreadCond         spillCond;
+  SSHashObj*           pSpilling;     // pageId -> SSpillReq*, pages being written and pages read ahead
+  int32_t              numOfWrites;   // writes not finished yet
+  int32_t              numOfReading;  // reads not finished yet
+  int32_t              numOfReads;    // pages read ahead, not consumed yet
+  int32_t              spillCode;     // the first error of the spill thread
 };
 
+typedef enum {
+  SPILL_REQ_WRITE = 1,
+  SPILL_REQ_READ,
+} ESpillReqType;
+
+typedef struct SSpillReq {
+  struct SSpillReq* next;
+  SDiskbasedBuf*    pBuf;
+  ESpillReqType     type;
+  bool              done;  // only for reads
+  int32_t           code;
+  int32_t           pageId;
+  int32_t           length;
+  int64_t           offset;
+  int64_t           elapsed;  // us, only for reads
+  char*             data;
+} SSpillReq;
+
+/*
+ * A few spill threads are shared by all paged buffers of the process, and each buffer is bound to one of them when
+ * created. The requests of a thread are served in FIFO order, so a read or a rewrite of a file area always happens
+ * after the earlier write to the same area, while buffers bound to different threads spill in parallel.
+ */
+typedef struct SSpillWorker {
+  TdThreadMutex lock;
+  TdThreadCond  cond;
+  SSpillReq*    head;
+  SSpillReq*    tail;
+} SSpillWorker;
+
+typedef struct SSpillWorkerPool {
+  int32_t      num;   // started threads
+  int32_t      next;  // the thread the next buffer is bound to
+  SSpillWorker workers[SPILL_MAX_WORKERS];
+} SSpillWorkerPool;
+
+static SSpillWorkerPool gSpillPool = {0};
+static TdThreadOnce     gSpillPoolInit = PTHREAD_ONCE_INIT;
+
+static void spillDoReq(SSpillReq* pReq) {
+  SDiskbasedBuf* pBuf = pReq->pBuf;
+  int32_t        code = TSDB_CODE_SUCCESS;
+  int64_t        st = taosGetTimestampUs();
+
+  if (pReq->type == SPILL_REQ_WRITE) {
+    if (taosPWriteFile(pBuf->pFile, pReq->data, pReq->length, pReq->offset) != pReq->length) {
+      code = TAOS_SYSTEM_ERROR(errno);
+    }
+  } else {
+    if (taosPReadFile(pBuf->pFile, pReq->data, pReq->length, pReq->offset) != pReq->length) {
+      code = TAOS_SYSTEM_ERROR(errno);
+    }
+  }
+
+  int64_t el = taosGetTimestampUs() - st;
+
+  taosThreadMutexLock(&pBuf->spillLock);
+  if (pReq->type == SPILL_REQ_WRITE) {
+    // the page may have been flushed again since, keep the newer request
+    SSpillReq** p = tSimpleHashGet(pBuf->pSpilling, &pReq->pageId, sizeof(int32_t));
+    if (p != NULL && *p == pReq) {
+      tSimpleHashRemove(pBuf->pSpilling, &pReq->pageId, sizeof(int32_t));
+    }
+
+    if (code != TSDB_CODE_SUCCESS) {
+      uError("failed to write buf page:%d to disk, offset:%" PRId64 ", length:%d, %s, %s", pReq->pageId, pReq->offset,
+             pReq->length, tstrerror(code), pBuf->id);
+      if (pBuf->spillCode == TSDB_CODE_SUCCESS) {
+        pBuf->spillCode = code;
+      }
+    } else {
+      pBuf->statis.flushBytes += pReq->length;
+      pBuf->statis.flushPages += 1;
+    }
+
+    pBuf->statis.flushUs += el;
+    pBuf->numOfWrites -= 1;
+    taosMemTrackerRelease(pBuf->pMemTracker, pReq->length);
+  } else {
+    pReq->code = code;
+    pReq->elapsed = el;
+    pReq->done = true;
+    pBuf->numOfReading -= 1;
+  }
+
+  taosThreadCondBroadcast(&pBuf->spillCond);
+  taosThreadMutexUnlock(&pBuf->spillLock);
+
+  // the buffer may be destroyed now, do not touch it any more
+  if (pReq->type == SPILL_REQ_WRITE) {
+    taosMemoryFree(pReq->data);
+    taosMemoryFree(pReq);
+  }
+}
+
+static void* spillWorkerThreadFp(void* param) {
+  SSpillWorker* pWorker = param;
+  setThreadName("paged-buf-spill");
+
+  while (1) {
+    taosThreadMutexLock(&pWorker->lock);
+    while (pWorker->head == NULL) {
+      taosThreadCondWait(&pWorker->cond, &pWorker->lock);
+    }
+
+    SSpillReq* pReq = pWorker->head;
+    pWorker->head = pReq->next;
+    if (pWorker->head == NULL) {
+      pWorker->tail = NULL;
+    }
+    taosThreadMutexUnlock(&pWorker->lock);
+
+    pReq->next = NULL;
+    spillDoReq(pReq);
+  }
+
+  return NULL;
+}
+
+static void spillPoolInitImpl(void) {
+  int32_t num = TMIN(TMAX((int32_t)(tsNumOfCores / 4), 1), SPILL_MAX_WORKERS);
+
+  TdThreadAttr thAttr;
+  taosThreadAttrInit(&thAttr);
+  taosThreadAttrSetDetachState(&thAttr, PTHREAD_CREATE_DETACHED);
+
+  for (int32_t i = 0; i < num; ++i) {
+    SSpillWorker* pWorker = &gSpillPool.workers[i];
+    taosThreadMutexInit(&pWorker->lock, NULL);
+    taosThreadCondInit(&pWorker->cond, NULL);
+
+    TdThread thread;
+    if (taosThreadCreate(&thread, &thAttr, spillWorkerThreadFp, pWorker) != 0) {
+      uError("failed to create paged buffer spill thread since %s, %d started", strerror(errno), gSpillPool.num);
+      taosThreadCondDestroy(&pWorker->cond);
+      taosThreadMutexDestroy(&pWorker->lock);
+      break;
+    }
+    gSpillPool.num += 1;
+  }
+
+  if (gSpillPool.num == 0) {
+    uError("no paged buffer spill thread, flush pages synchronously");
+  }
+
+  taosThreadAttrDestroy(&thAttr);
+}
+
+// bind a new buffer to a spill thread, NULL if the pages are flushed synchronously
+static SSpillWorker* spillPoolAssign() {
+  taosThreadOnce(&gSpillPoolInit, spillPoolInitImpl);
+  if (gSpillPool.num == 0) {
+    return NULL;
+  }
+
+  int32_t idx = atomic_fetch_add_32(&gSpillPool.next, 1) & 0x7FFFFFFF;
+  return &gSpillPool.workers[idx % gSpillPool.num];
+}
+
+static void spillWorkerPut(SSpillReq* pReq) {
+  SSpillWorker* pWorker = pReq->pBuf->pWorker;
+
+  taosThreadMutexLock(&pWorker->lock);
+  if (pWorker->tail == NULL) {
+    pWorker->head = pReq;
+  } else {
+    pWorker->tail->next = pReq;
+  }
+  pWorker->tail = pReq;
+  taosThreadCondSignal(&pWorker->cond);
+  taosThreadMutexUnlock(&pWorker->lock);
+}
+
+// free a request of a read ahead page, and give back the memory of its copy
+static void spillFreeRead(SDiskbasedBuf* pBuf, SSpillReq* pReq) {
+  taosMemTrackerRelease(pBuf->pMemTracker, pReq->length);
+  taosMemoryFree(pReq->data);
+  taosMemoryFree(pReq);
+}
+
+// wait for all requests of this buffer to finish, and drop the pages read ahead. The spillLock must be held.
+static void spillWaitAll(SDiskbasedBuf* pBuf) {
+  while (pBuf->numOfWrites > 0 || pBuf->numOfReading > 0) {
+    taosThreadCondWait(&pBuf->spillCond, &pBuf->spillLock);
+  }
+
+  int32_t iter = 0;
+  void*   p = NULL;
+  while ((p = tSimpleHashIterate(pBuf->pSpilling, p, &iter)) != NULL) {
+    spillFreeRead(pBuf, *(SSpillReq**)p);
+  }
+
+  tSimpleHashClear(pBuf->pSpilling);
+  pBuf->numOfReads = 0;
+}
+
+// drop the page read ahead, if the page is recycled before being loaded. The spillLock must be held.
+static void spillDropRead(SDiskbasedBuf* pBuf, int32_t pageId) {
+  SSpillReq** p = tSimpleHashGet(pBuf->pSpilling, &pageId, sizeof(int32_t));
+  if (p == NULL || (*p)->type != SPILL_REQ_READ) {
+    return;
+  }
+
+  SSpillReq* pReq = *p;
+  while (!pReq->done) {
+    taosThreadCondWait(&pBuf->spillCond, &pBuf->spillLock);
+  }
+
+  tSimpleHashRemove(pBuf->pSpilling, &pageId, sizeof(int32_t));
+  pBuf->numOfReads -= 1;
+  spillFreeRead(pBuf, pReq);
+}
+
 static int32_t createDiskFile(SDiskbasedBuf* pBuf) {
   if (pBuf->path == NULL) {  // prepare the file name when needed it
     char path[PATH_MAX] = {0};
@@ -70,7 +300,7 @@ static int32_t createDiskFile(SDiskbasedBuf* pBuf) {
   return TSDB_CODE_SUCCESS;
 }
 
-static char* doCompressData(void* data, int32_t srcSize, int32_t* dst, SDiskbasedBuf* pBuf) {  // do nothing
+static char* doCompressData(void* data, int32_t srcSize, int32_t* dst, SDiskbasedBuf* pBuf) {
   if (!pBuf->comp) {
     *dst = srcSize;
     return data;
@@ -82,7 +312,7 @@ static char* doCompressData(void* data, int32_t srcSize, int32_t* dst, SDiskbase
   return data;
 }
 
-static char* doDecompressData(void* data, int32_t srcSize, int32_t* dst, SDiskbasedBuf* pBuf) {  // do nothing
+static char* doDecompressData(void* data, int32_t srcSize, int32_t* dst, SDiskbasedBuf* pBuf) {
   if (!pBuf->comp) {
     *dst = srcSize;
     return data;
@@ -129,17 +359,76 @@ static uint64_t allocateNewPositionInFile(SDiskbasedBuf* pBuf, size_t size) {
 
 static FORCE_INLINE size_t getAllocPageSize(int32_t pageSize) { return pageSize + POINTER_BYTES + sizeof(SFilePage); }
 
-static int32_t doFlushBufPageImpl(SDiskbasedBuf* pBuf, int64_t offset, const char* pData, int32_t size) {
-  int32_t ret = taosLSeekFile(pBuf->pFile, offset, SEEK_SET);
-  if (ret == -1) {
-    terrno = TAOS_SYSTEM_ERROR(errno);
+static int32_t doFlushBufPageAsync(SDiskbasedBuf* pBuf, int32_t pageId, int64_t offset, const char* pData,
+                                   int32_t size) {
+  SSpillReq* pReq = taosMemoryCalloc(1, sizeof(SSpillReq));
+  char*      data = taosMemoryMalloc(size);
+  if (pReq == NULL || data == NULL) {
+    taosMemoryFree(pReq);
+    taosMemoryFree(data);
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
     return terrno;
   }
 
-  ret = (int32_t)taosWriteFile(pBuf->pFile, pData, size);
-  if (ret != size) {
-    terrno = TAOS_SYSTEM_ERROR(errno);
-    return terrno;
+  // the copy lives until the page reaches the disk. It can not be backed off, but at most SPILL_MAX_PENDING_WRITES
+  // of them are alive for a buffer
+  taosMemTrackerConsume(pBuf->pMemTracker, size);
+
+  memcpy(data, pData, size);
+  pReq->pBuf = pBuf;
+  pReq->type = SPILL_REQ_WRITE;
+  pReq->pageId = pageId;
+  pReq->offset = offset;
+  pReq->length = size;
+  pReq->data = data;
+
+  taosThreadMutexLock(&pBuf->spillLock);
+  while (pBuf->numOfWrites >= SPILL_MAX_PENDING_WRITES && pBuf->spillCode == TSDB_CODE_SUCCESS) {
+    taosThreadCondWait(&pBuf->spillCond, &pBuf->spillLock);
+  }
+
+  int32_t code = pBuf->spillCode;
+  if (code == TSDB_CODE_SUCCESS) {
+    // the page is loaded from this request until it reaches the disk
+    code = tSimpleHashPut(pBuf->pSpilling, &pageId, sizeof(int32_t), &pReq, POINTER_BYTES);
+    if (code == TSDB_CODE_SUCCESS) {
+      pBuf->numOfWrites += 1;
+    } else {
+      code = TSDB_CODE_OUT_OF_MEMORY;
+    }
+  }
+  taosThreadMutexUnlock(&pBuf->spillLock);
+
+  if (code != TSDB_CODE_SUCCESS) {
+    taosMemTrackerRelease(pBuf->pMemTracker, size);
+    taosMemoryFree(data);
+    taosMemoryFree(pReq);
+    terrno = code;
+    return code;
+  }
+
+  spillWorkerPut(pReq);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t doFlushBufPageImpl(SDiskbasedBuf* pBuf, int32_t pageId, int64_t offset, const char* pData,
+                                  int32_t size) {
+  if (pBuf->async) {
+    int32_t code = doFlushBufPageAsync(pBuf, pageId, offset, pData, size);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  } else {
+    int64_t st = taosGetTimestampUs();
+    int64_t ret = taosPWriteFile(pBuf->pFile, pData, size, offset);
+    if (ret != size) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      return terrno;
+    }
+
+    pBuf->statis.flushUs += taosGetTimestampUs() - st;
+    pBuf->statis.flushBytes += size;
+    pBuf->statis.flushPages += 1;
   }
 
   // extend the file
@@ -147,9 +436,6 @@ static int32_t doFlushBufPageImpl(SDiskbasedBuf* pBuf, int64_t offset, const cha
     pBuf->fileSize = offset + size;
   }
 
-  pBuf->statis.flushBytes += size;
-  pBuf->statis.flushPages += 1;
-
   return TSDB_CODE_SUCCESS;
 }
 
@@ -180,7 +466,7 @@ static char* doFlushBufPage(SDiskbasedBuf* pBuf, SPageInfo* pg) {
       offset = allocateNewPositionInFile(pBuf, size);
       pBuf->nextPos += size;
 
-      int32_t code = doFlushBufPageImpl(pBuf, offset, t, size);
+      int32_t code = doFlushBufPageImpl(pBuf, pg->pageId, offset, t, size);
       if (code != TSDB_CODE_SUCCESS) {
         return NULL;
       }
@@ -196,11 +482,13 @@ static char* doFlushBufPage(SDiskbasedBuf* pBuf, SPageInfo* pg) {
         pBuf->nextPos += size;
       }
 
-      int32_t code = doFlushBufPageImpl(pBuf, offset, t, size);
+      int32_t code = doFlushBufPageImpl(pBuf, pg->pageId, offset, t, size);
       if (code != TSDB_CODE_SUCCESS) {
         return NULL;
       }
     }
+
+    pBuf->statis.rawFlushBytes += pBuf->pageSize;
   } else {  // NOTE: the size may be -1, the this recycle page has not been flushed to disk yet.
     size = pg->length;
   }
@@ -241,17 +529,56 @@ static int32_t loadPageFromDisk(SDiskbasedBuf* pBuf, SPageInfo* pg) {
     return TSDB_CODE_INVALID_PARA;
   }
 
-  int32_t ret = taosLSeekFile(pBuf->pFile, pg->offset, SEEK_SET);
-  if (ret == -1) {
-    ret = TAOS_SYSTEM_ERROR(errno);
-    return ret;
+  void*   pPage = (void*)GET_PAYLOAD_DATA(pg);
+  bool    loaded = false;
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  if (pBuf->async) {
+    taosThreadMutexLock(&pBuf->spillLock);
+    code = pBuf->spillCode;
+
+    SSpillReq** p = tSimpleHashGet(pBuf->pSpilling, &pg->pageId, sizeof(int32_t));
+    if (code == TSDB_CODE_SUCCESS && p != NULL) {
+      SSpillReq* pReq = *p;
+      if (pReq->type == SPILL_REQ_WRITE) {
+        // not on disk yet, take it from the pending write
+        memcpy(pPage, pReq->data, pg->length);
+        pBuf->statis.pendingHitPages += 1;
+        loaded = true;
+      } else {
+        while (!pReq->done) {
+          taosThreadCondWait(&pBuf->spillCond, &pBuf->spillLock);
+        }
+
+        tSimpleHashRemove(pBuf->pSpilling, &pg->pageId, sizeof(int32_t));
+        pBuf->numOfReads -= 1;
+
+        code = pReq->code;
+        if (code == TSDB_CODE_SUCCESS) {
+          memcpy(pPage, pReq->data, pg->length);
+          pBuf->statis.prefetchHitPages += 1;
+          pBuf->statis.loadUs += pReq->elapsed;
+          loaded = true;
+        }
+
+        spillFreeRead(pBuf, pReq);
+      }
+    }
+    taosThreadMutexUnlock(&pBuf->spillLock);
+
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
   }
 
-  void* pPage = (void*)GET_PAYLOAD_DATA(pg);
-  ret = (int32_t)taosReadFile(pBuf->pFile, pPage, pg->length);
-  if (ret != pg->length) {
-    ret = TAOS_SYSTEM_ERROR(errno);
-    return ret;
+  if (!loaded) {
+    int64_t st = taosGetTimestampUs();
+    int64_t ret = taosPReadFile(pBuf->pFile, pPage, pg->length, pg->offset);
+    if (ret != pg->length) {
+      return TAOS_SYSTEM_ERROR(errno);
+    }
+
+    pBuf->statis.loadUs += taosGetTimestampUs() - st;
   }
 
   pBuf->statis.loadBytes += pg->length;
@@ -259,7 +586,13 @@ static int32_t loadPageFromDisk(SDiskbasedBuf* pBuf, SPageInfo* pg) {
 
   int32_t fullSize = 0;
   doDecompressData(pPage, pg->length, &fullSize, pBuf);
-  return 0;
+  if (fullSize < 0) {
+    uError("failed to decompress buf page:%d, offset:%" PRId64 ", length:%d, %s", pg->pageId, pg->offset, pg->length,
+           pBuf->id);
+    return TSDB_CODE_INVALID_PARA;
+  }
+
+  return TSDB_CODE_SUCCESS;
 }
 
 static SPageInfo* registerNewPageInfo(SDiskbasedBuf* pBuf, int32_t pageId) {
@@ -382,6 +715,29 @@ int32_t createDiskbasedBuf(SDiskbasedBuf** pBuf, int32_t pagesize, int32_t inMem
   pPBuf->prefix = (char*)dir;
   pPBuf->emptyDummyIdList = taosArrayInit(1, sizeof(int32_t));
 
+  // pages are compressed before being spilled to disk, unless the owner turns it off
+  setBufPageCompressOnDisk(pPBuf, true);
+  if (pPBuf->assistBuf == NULL) {
+    goto _error;
+  }
+
+  pPBuf->pSpilling = tSimpleHashInit(16, fn);
+  if (pPBuf->pSpilling == NULL) {
+    goto _error;
+  }
+
+  taosThreadMutexInit(&pPBuf->spillLock, NULL);
+  taosThreadCondInit(&pPBuf->spillCond, NULL);
+  pPBuf->pWorker = spillPoolAssign();
+  pPBuf->async = (pPBuf->pWorker != NULL);
+
+  // the in-memory pages, and the copies of pages being written or read ahead, are charged to the tracker of the query
+  // running in this thread, with the in-memory buffer size as the limit of this buffer
+  SMemTracker* pParent = taosMemTrackerCurrent();
+  if (pParent != NULL) {
+    pPBuf->pMemTracker = taosMemTrackerCreate(id, (int64_t)pPBuf->inMemPages * getAllocPageSize(pagesize), pParent);
+  }
+
   //  qDebug("QInfo:0x%"PRIx64" create resBuf for output, page size:%d, inmem buf pages:%d, file:%s", qId,
   //  pPBuf->pageSize, pPBuf->inMemPages, pPBuf->path);
 
@@ -391,6 +747,31 @@ _error:
   return TSDB_CODE_OUT_OF_MEMORY;
 }
 
+static bool tryConsumeMemPage(SDiskbasedBuf* pBuf) {
+  if (pBuf->pMemTracker == NULL) {
+    return true;
+  }
+
+  // at least 2 pages must be in memory, even if the budget of the query is used up
+  if (listNEles(pBuf->lruList) < 2) {
+    taosMemTrackerConsume(pBuf->pMemTracker, getAllocPageSize(pBuf->pageSize));
+  } else if (!taosMemTrackerTryConsume(pBuf->pMemTracker, getAllocPageSize(pBuf->pageSize))) {
+    return false;
+  }
+
+  pBuf->memPages += 1;
+  return true;
+}
+
+static void releaseMemPages(SDiskbasedBuf* pBuf, int32_t numOfPages) {
+  if (pBuf->pMemTracker == NULL || numOfPages <= 0) {
+    return;
+  }
+
+  taosMemTrackerRelease(pBuf->pMemTracker, (int64_t)numOfPages * getAllocPageSize(pBuf->pageSize));
+  pBuf->memPages -= numOfPages;
+}
+
 static char* doExtractPage(SDiskbasedBuf* pBuf, bool* newPage) {
   char* availablePage = NULL;
   if (NO_IN_MEM_AVAILABLE_PAGES(pBuf)) {
@@ -399,15 +780,32 @@ static char* doExtractPage(SDiskbasedBuf* pBuf, bool* newPage) {
       uWarn("no available buf pages, current:%d, max:%d, reason: %s, %s", listNEles(pBuf->lruList), pBuf->inMemPages,
             terrstr(), pBuf->id)
     }
-  } else {
-    availablePage =
-        taosMemoryCalloc(1, getAllocPageSize(pBuf->pageSize));  // add extract bytes in case of zipped buffer increased.
-    if (availablePage == NULL) {
-      terrno = TSDB_CODE_OUT_OF_MEMORY;
+
+    return availablePage;
+  }
+
+  if (!tryConsumeMemPage(pBuf)) {
+    // the memory budget is used up, spill the eldest page to disk and reuse its buffer
+    availablePage = evictBufPage(pBuf);
+    if (availablePage != NULL) {
+      pBuf->statis.budgetEvictPages += 1;
+      return availablePage;
     }
-    *newPage = true;
+
+    // all in-memory pages are referenced, no way to back off
+    terrno = 0;
+    taosMemTrackerConsume(pBuf->pMemTracker, getAllocPageSize(pBuf->pageSize));
+    pBuf->memPages += 1;
   }
 
+  availablePage =
+      taosMemoryCalloc(1, getAllocPageSize(pBuf->pageSize));  // add extract bytes in case of zipped buffer increased.
+  if (availablePage == NULL) {
+    releaseMemPages(pBuf, 1);
+    terrno = TSDB_CODE_OUT_OF_MEMORY;
+  }
+  *newPage = true;
+
   return availablePage;
 }
 
@@ -436,6 +834,7 @@ void* getNewBufPage(SDiskbasedBuf* pBuf, int32_t* pageId) {
     if (pi == NULL) {
       if (newPage) {
         taosMemoryFree(availablePage);
+        releaseMemPages(pBuf, 1);
       }
       return NULL;
     }
@@ -517,6 +916,7 @@ void* getBufPage(SDiskbasedBuf* pBuf, int32_t id) {
       if (code != 0) {
         if (newPage) {
           taosMemoryFree((*pi)->pData);
+          releaseMemPages(pBuf, 1);
         }
 
         terrno = code;
@@ -566,6 +966,12 @@ void destroyDiskbasedBuf(SDiskbasedBuf* pBuf) {
     return;
   }
 
+  if (pBuf->pSpilling != NULL) {
+    taosThreadMutexLock(&pBuf->spillLock);
+    spillWaitAll(pBuf);
+    taosThreadMutexUnlock(&pBuf->spillLock);
+  }
+
   dBufPrintStatis(pBuf);
 
   bool needRemoveFile = false;
@@ -585,6 +991,15 @@ void destroyDiskbasedBuf(SDiskbasedBuf* pBuf) {
   // print the statistics information
   {
     SDiskbasedBufStatis* ps = &pBuf->statis;
+    if (ps->flushPages > 0) {
+      uDebug("flushToDisk raw:%.2f Kb, compressed:%.2f Kb, %.2f Mb/s, loadFromDisk:%.2f Mb/s, prefetch hit/pending "
+             "hit pages:%d/%d, %s",
+             ps->rawFlushBytes / 1024.0f, ps->flushBytes / 1024.0f,
+             ps->flushUs > 0 ? ps->flushBytes / (1.048576 * ps->flushUs) : 0.0,
+             ps->loadUs > 0 ? ps->loadBytes / (1.048576 * ps->loadUs) : 0.0, ps->prefetchHitPages,
+             ps->pendingHitPages, pBuf->id);
+    }
+
     if (ps->loadPages == 0) {
       uDebug("Get/Release pages:%d/%d, flushToDisk:%.2f Kb (%d Pages), loadFromDisk:%.2f Kb (%d Pages)", ps->getPages,
              ps->releasePages, ps->flushBytes / 1024.0f, ps->flushPages, ps->loadBytes / 1024.0f, ps->loadPages);
@@ -614,6 +1029,9 @@ void destroyDiskbasedBuf(SDiskbasedBuf* pBuf) {
 
   taosArrayDestroy(pBuf->pIdList);
 
+  releaseMemPages(pBuf, pBuf->memPages);
+  taosMemTrackerUnref(pBuf->pMemTracker);
+
   tdListFree(pBuf->lruList);
   tdListFree(pBuf->freePgList);
 
@@ -622,6 +1040,12 @@ void destroyDiskbasedBuf(SDiskbasedBuf* pBuf) {
 
   tSimpleHashCleanup(pBuf->all);
 
+  if (pBuf->pSpilling != NULL) {
+    tSimpleHashCleanup(pBuf->pSpilling);
+    taosThreadMutexDestroy(&pBuf->spillLock);
+    taosThreadCondDestroy(&pBuf->spillCond);
+  }
+
   taosMemoryFreeClear(pBuf->id);
   taosMemoryFreeClear(pBuf->assistBuf);
   taosMemoryFreeClear(pBuf);
@@ -656,6 +1080,12 @@ void setBufPageCompressOnDisk(SDiskbasedBuf* pBuf, bool comp) {
 void dBufSetBufPageRecycled(SDiskbasedBuf* pBuf, void* pPage) {
   SPageInfo* ppi = getPageInfoFromPayload(pPage);
 
+  if (pBuf->async) {
+    taosThreadMutexLock(&pBuf->spillLock);
+    spillDropRead(pBuf, ppi->pageId);
+    taosThreadMutexUnlock(&pBuf->spillLock);
+  }
+
   ppi->used = false;
   ppi->dirty = false;
 
@@ -664,13 +1094,98 @@ void dBufSetBufPageRecycled(SDiskbasedBuf* pBuf, void* pPage) {
   taosMemoryFreeClear(ppi->pData);
   taosMemoryFreeClear(pNode);
   ppi->pn = NULL;
+  releaseMemPages(pBuf, 1);
 
   tdListAppend(pBuf->freePgList, &ppi);
 }
 
 void dBufSetPrintInfo(SDiskbasedBuf* pBuf) { pBuf->printStatis = true; }
 
-SDiskbasedBufStatis getDBufStatis(const SDiskbasedBuf* pBuf) { return pBuf->statis; }
+SDiskbasedBufStatis getDBufStatis(const SDiskbasedBuf* pBuf) {
+  if (!pBuf->async) {
+    return pBuf->statis;
+  }
+
+  // the flush statistics are updated by the spill thread
+  taosThreadMutexLock((TdThreadMutex*)&pBuf->spillLock);
+  SDiskbasedBufStatis statis = pBuf->statis;
+  taosThreadMutexUnlock((TdThreadMutex*)&pBuf->spillLock);
+  return statis;
+}
+
+void dBufSetBufPageEvictFirst(SDiskbasedBuf* pBuf, void* pPage) {
+  SPageInfo* ppi = getPageInfoFromPayload(pPage);
+  if (ppi->pn == NULL) {
+    return;
+  }
+
+  // the eviction scans the lru list from the tail
+  tdListPopNode(pBuf->lruList, ppi->pn);
+  tdListAppendNode(pBuf->lruList, ppi->pn);
+}
+
+int32_t dBufPrefetchPage(SDiskbasedBuf* pBuf, int32_t pageId) {
+  if (!pBuf->async) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SPageInfo** pi = tSimpleHashGet(pBuf->all, &pageId, sizeof(int32_t));
+  if (pi == NULL || *pi == NULL) {
+    uError("failed to locate the buffer page:%d, %s", pageId, pBuf->id);
+    return TSDB_CODE_INVALID_PARA;
+  }
+
+  // in memory, or never flushed to disk
+  if (BUF_PAGE_IN_MEM(*pi) || !HAS_DATA_IN_DISK(*pi) || (*pi)->length <= 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  taosThreadMutexLock(&pBuf->spillLock);
+  bool skip = pBuf->numOfReads >= SPILL_MAX_PREFETCH_PAGES || pBuf->spillCode != TSDB_CODE_SUCCESS ||
+              tSimpleHashGet(pBuf->pSpilling, &pageId, sizeof(int32_t)) != NULL;
+  taosThreadMutexUnlock(&pBuf->spillLock);
+  if (skip) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  // reading ahead is only a hint, skip it if the memory budget is used up
+  if (!taosMemTrackerTryConsume(pBuf->pMemTracker, (*pi)->length)) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SSpillReq* pReq = taosMemoryCalloc(1, sizeof(SSpillReq));
+  char*      data = taosMemoryMalloc((*pi)->length);
+  if (pReq == NULL || data == NULL) {
+    taosMemTrackerRelease(pBuf->pMemTracker, (*pi)->length);
+    taosMemoryFree(pReq);
+    taosMemoryFree(data);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  pReq->pBuf = pBuf;
+  pReq->type = SPILL_REQ_READ;
+  pReq->pageId = pageId;
+  pReq->offset = (*pi)->offset;
+  pReq->length = (*pi)->length;
+  pReq->data = data;
+
+  taosThreadMutexLock(&pBuf->spillLock);
+  int32_t code = tSimpleHashPut(pBuf->pSpilling, &pageId, sizeof(int32_t), &pReq, POINTER_BYTES);
+  if (code == TSDB_CODE_SUCCESS) {
+    pBuf->numOfReads += 1;
+    pBuf->numOfReading += 1;
+    pBuf->statis.prefetchPages += 1;
+  }
+  taosThreadMutexUnlock(&pBuf->spillLock);
+
+  if (code != TSDB_CODE_SUCCESS) {
+    spillFreeRead(pBuf, pReq);
+    return TSDB_CODE_OUT_OF_MEMORY;
+  }
+
+  spillWorkerPut(pReq);
+  return TSDB_CODE_SUCCESS;
+}
 
 void dBufPrintStatis(const SDiskbasedBuf* pBuf) {
   if (!pBuf->printStatis) {
@@ -699,6 +1214,13 @@ void dBufPrintStatis(const SDiskbasedBuf* pBuf) {
 }
 
 void clearDiskbasedBuf(SDiskbasedBuf* pBuf) {
+  if (pBuf->pSpilling != NULL) {
+    taosThreadMutexLock(&pBuf->spillLock);
+    spillWaitAll(pBuf);
+    pBuf->spillCode = TSDB_CODE_SUCCESS;
+    taosThreadMutexUnlock(&pBuf->spillLock);
+  }
+
   size_t n = taosArrayGetSize(pBuf->pIdList);
   for (int32_t i = 0; i < n; ++i) {
     SPageInfo* pi = taosArrayGetP(pBuf->pIdList, i);
@@ -707,6 +1229,7 @@ void clearDiskbasedBuf(SDiskbasedBuf* pBuf) {
   }
 
   taosArrayClear(pBuf->pIdList);
+  releaseMemPages(pBuf, pBuf->memPages);
 
   tdListEmpty(pBuf->lruList);
   tdListEmpty(pBuf->freePgList);
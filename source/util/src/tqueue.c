@@ -18,9 +18,31 @@
 #include "taoserror.h"
 #include "tlog.h"
 
+// let the sibling hyper-thread run while spinning
+#ifdef WINDOWS
+#define QUEUE_CPU_PAUSE() YieldProcessor()
+#elif defined(__x86_64__) || defined(__i386__)
+#define QUEUE_CPU_PAUSE() __asm__ __volatile__("pause")
+#elif defined(__aarch64__)
+#define QUEUE_CPU_PAUSE() __asm__ __volatile__("yield")
+#else
+#define QUEUE_CPU_PAUSE()
+#endif
+
 int64_t tsRpcQueueMemoryAllowed = 0;
 int64_t tsRpcQueueMemoryUsed = 0;
 
+// a qset that opted in tries the semaphore qset->spin times before parking on it. The budget is fixed, so
+// the readers share nothing while spinning.
+static void taosWaitQset(STaosQset *qset) {
+  for (int32_t i = 0; i < qset->spin; ++i) {
+    if (tsem_trywait(&qset->sem) == 0) return;
+    QUEUE_CPU_PAUSE();
+  }
+
+  tsem_wait(&qset->sem);
+}
+
 STaosQueue *taosOpenQueue() {
   STaosQueue *queue = taosMemoryCalloc(1, sizeof(STaosQueue));
   if (queue == NULL) {
@@ -223,6 +245,7 @@ int32_t taosReadAllQitems(STaosQueue *queue, STaosQall *qall) {
     qall->current = queue->head;
     qall->start = queue->head;
     qall->numOfItems = queue->numOfItems;
+    qall->unAccessedNumOfItems = queue->numOfItems;
     numOfItems = qall->numOfItems;
 
     queue->head = NULL;
@@ -241,6 +264,7 @@ int32_t taosReadAllQitems(STaosQueue *queue, STaosQall *qall) {
     qall->current = NULL;
     qall->start = NULL;
     qall->numOfItems = 0;
+    qall->unAccessedNumOfItems = 0;
   }
   return numOfItems;
 }
@@ -250,9 +274,9 @@ int32_t taosGetQitem(STaosQall *qall, void **ppItem) {
   int32_t     num = 0;
 
   pNode = qall->current;
-  if (pNode) qall->current = pNode->next;
-
   if (pNode) {
+    qall->current = pNode->next;
+    qall->unAccessedNumOfItems--;
     *ppItem = pNode->item;
     num = 1;
     uTrace("item:%p is fetched", *ppItem);
@@ -305,6 +329,8 @@ void taosQsetThreadResume(STaosQset *qset) {
   tsem_post(&qset->sem);
 }
 
+void taosSetQsetSpin(STaosQset *qset, int32_t spin) { qset->spin = TMAX(spin, 0); }
+
 int32_t taosAddIntoQset(STaosQset *qset, STaosQueue *queue, void *ahandle) {
   if (queue->qset) return -1;
 
@@ -370,7 +396,7 @@ int32_t taosReadQitemFromQset(STaosQset *qset, void **ppItem, SQueueInfo *qinfo)
   STaosQnode *pNode = NULL;
   int32_t     code = 0;
 
-  tsem_wait(&qset->sem);
+  taosWaitQset(qset);
 
   taosThreadMutexLock(&qset->mutex);
 
@@ -414,7 +440,7 @@ int32_t taosReadAllQitemsFromQset(STaosQset *qset, STaosQall *qall, SQueueInfo *
   STaosQueue *queue;
   int32_t     code = 0;
 
-  tsem_wait(&qset->sem);
+  taosWaitQset(qset);
   taosThreadMutexLock(&qset->mutex);
 
   for (int32_t i = 0; i < qset->numOfQueues; ++i) {
@@ -430,6 +456,7 @@ int32_t taosReadAllQitemsFromQset(STaosQset *qset, STaosQall *qall, SQueueInfo *
       qall->current = queue->head;
       qall->start = queue->head;
       qall->numOfItems = queue->numOfItems;
+      qall->unAccessedNumOfItems = queue->numOfItems;
       code = qall->numOfItems;
       qinfo->ahandle = queue->ahandle;
       qinfo->fp = queue->itemsFp;
@@ -457,7 +484,11 @@ int32_t taosReadAllQitemsFromQset(STaosQset *qset, STaosQall *qall, SQueueInfo *
 }
 
 int32_t taosQallItemSize(STaosQall *qall) { return qall->numOfItems; }
-void    taosResetQitems(STaosQall *qall) { qall->current = qall->start; }
+int32_t taosQallUnAccessedItemSize(STaosQall *qall) { return qall->unAccessedNumOfItems; }
+void    taosResetQitems(STaosQall *qall) {
+  qall->current = qall->start;
+  qall->unAccessedNumOfItems = qall->numOfItems;
+}
 int32_t taosGetQueueNumber(STaosQset *qset) { return qset->numOfQueues; }
 
 #if 0
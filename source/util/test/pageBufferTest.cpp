@@ -1,8 +1,10 @@
 #include <gtest/gtest.h>
 #include <cassert>
 #include <iostream>
+#include <thread>
 
 #include "taos.h"
+#include "tmemtracker.h"
 #include "tpagedbuf.h"
 
 #pragma GCC diagnostic push
@@ -157,6 +159,228 @@ void recyclePageTest() {
 
   destroyDiskbasedBuf(pBuf);
 }
+
+// the pages evicted are written behind by a spill thread
+void waitForFlush(SDiskbasedBuf* pBuf, int32_t numOfPages) {
+  for (int32_t i = 0; i < 10000 && getDBufStatis(pBuf).flushPages < numOfPages; ++i) {
+    taosMsleep(1);
+  }
+  ASSERT_EQ(getDBufStatis(pBuf).flushPages, numOfPages);
+}
+
+// the query budget allows 3 pages, while the buffer itself could keep 8 pages in memory
+void memBudgetTest() {
+  const int32_t pageSize = 1024;
+  const int64_t allocSize = pageSize + sizeof(void*) + sizeof(SFilePage);
+
+  SMemTracker* pQuery = taosMemTrackerCreate("query", allocSize * 3, NULL);
+  SMemTracker* pTask = taosMemTrackerCreate("task", 0, pQuery);
+  SMemTracker* prev = taosMemTrackerSwitch(pTask);
+
+  SDiskbasedBuf* pBuf = NULL;
+  int32_t        ret = createDiskbasedBuf(&pBuf, pageSize, pageSize * 8, "budget", TD_TMP_DIR_PATH);
+  ASSERT_EQ(ret, 0);
+  taosMemTrackerSwitch(prev);
+
+  for (int32_t i = 0; i < 6; ++i) {
+    int32_t    pageId = 0;
+    SFilePage* pPage = static_cast<SFilePage*>(getNewBufPage(pBuf, &pageId));
+    ASSERT_TRUE(pPage != NULL);
+    ASSERT_EQ(pageId, i);
+
+    pPage->num = i * 10;
+    setBufPageDirty(pPage, true);
+    releaseBufPage(pBuf, pPage);
+
+    // the copies of the evicted pages are charged too, until they are written
+    ASSERT_LE(taosMemTrackerUsed(pQuery), allocSize * 3 + TMAX(i - 2, 0) * allocSize);
+  }
+
+  waitForFlush(pBuf, 3);
+  ASSERT_EQ(taosMemTrackerUsed(pTask), allocSize * 3);
+  ASSERT_EQ(taosMemTrackerPeak(pQuery), allocSize * 3);
+  ASSERT_EQ(getDBufStatis(pBuf).budgetEvictPages, 3);
+  ASSERT_FALSE(isAllDataInMemBuf(pBuf));
+
+  // spilled pages are loaded back with the same content
+  for (int32_t i = 0; i < 6; ++i) {
+    SFilePage* pPage = static_cast<SFilePage*>(getBufPage(pBuf, i));
+    ASSERT_TRUE(pPage != NULL);
+    ASSERT_EQ(pPage->num, i * 10);
+    releaseBufPage(pBuf, pPage);
+  }
+
+  destroyDiskbasedBuf(pBuf);
+  ASSERT_EQ(taosMemTrackerUsed(pQuery), 0);
+
+  taosMemTrackerUnref(pTask);
+  taosMemTrackerUnref(pQuery);
+}
+
+// pages are compressed and written behind, then read back in order with read ahead, as the sort merge does
+void spillTest() {
+  const int32_t pageSize = 4096;
+  const int32_t numOfPages = 32;
+
+  SDiskbasedBuf* pBuf = NULL;
+  int32_t        ret = createDiskbasedBuf(&pBuf, pageSize, pageSize * 4, "spill", TD_TMP_DIR_PATH);
+  ASSERT_EQ(ret, 0);
+
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    int32_t    pageId = 0;
+    SFilePage* pPage = static_cast<SFilePage*>(getNewBufPage(pBuf, &pageId));
+    ASSERT_TRUE(pPage != NULL);
+    ASSERT_EQ(pageId, i);
+
+    pPage->num = i;
+    memset(pPage->data, 'a' + i % 26, pageSize / 2);
+    setBufPageDirty(pPage, true);
+    releaseBufPage(pBuf, pPage);
+    dBufSetBufPageEvictFirst(pBuf, pPage);
+  }
+
+  ASSERT_FALSE(isAllDataInMemBuf(pBuf));
+
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    if (i + 1 < numOfPages) {
+      ASSERT_EQ(dBufPrefetchPage(pBuf, i + 1), 0);
+    }
+
+    SFilePage* pPage = static_cast<SFilePage*>(getBufPage(pBuf, i));
+    ASSERT_TRUE(pPage != NULL);
+    ASSERT_EQ(pPage->num, i);
+    ASSERT_EQ(pPage->data[0], 'a' + i % 26);
+    ASSERT_EQ(pPage->data[pageSize / 2 - 1], 'a' + i % 26);
+    dBufSetBufPageRecycled(pBuf, pPage);
+  }
+
+  // the pages are filled with runs of the same byte, they are much smaller on disk
+  SDiskbasedBufStatis statis = getDBufStatis(pBuf);
+  ASSERT_EQ(statis.loadPages, numOfPages - getNumOfInMemBufPages(pBuf));
+  ASSERT_LT(statis.loadBytes, (int64_t)statis.loadPages * pageSize / 4);
+  ASSERT_LE(statis.prefetchHitPages, statis.prefetchPages);
+
+  destroyDiskbasedBuf(pBuf);
+}
+
+// write and read back pages evicted first, the content of page i is derived from seed
+void spillPages(SDiskbasedBuf* pBuf, int32_t pageSize, int32_t numOfPages, int32_t seed) {
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    int32_t    pageId = 0;
+    SFilePage* pPage = static_cast<SFilePage*>(getNewBufPage(pBuf, &pageId));
+    ASSERT_TRUE(pPage != NULL);
+
+    pPage->num = seed + i;
+    memset(pPage->data, 'a' + (seed + i) % 26, pageSize / 2);
+    setBufPageDirty(pPage, true);
+    releaseBufPage(pBuf, pPage);
+    dBufSetBufPageEvictFirst(pBuf, pPage);
+  }
+
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    if (i + 1 < numOfPages) {
+      ASSERT_EQ(dBufPrefetchPage(pBuf, i + 1), 0);
+    }
+
+    SFilePage* pPage = static_cast<SFilePage*>(getBufPage(pBuf, i));
+    ASSERT_TRUE(pPage != NULL);
+    ASSERT_EQ(pPage->num, seed + i);
+    ASSERT_EQ(pPage->data[pageSize / 2 - 1], 'a' + (seed + i) % 26);
+    dBufSetBufPageRecycled(pBuf, pPage);
+  }
+}
+
+// buffers of different queries spill at the same time, and the copies being written or read ahead are charged
+void spillMemTest() {
+  const int32_t pageSize = 4096;
+  const int32_t numOfPages = 64;
+  const int32_t numOfThreads = 4;
+
+  SMemTracker* pQuery = taosMemTrackerCreate("query", 0, NULL);
+  SMemTracker* prev = taosMemTrackerSwitch(pQuery);
+
+  SDiskbasedBuf* pBufs[numOfThreads] = {0};
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    ASSERT_EQ(createDiskbasedBuf(&pBufs[i], pageSize, pageSize * 4, "spill-mem", TD_TMP_DIR_PATH), 0);
+  }
+  taosMemTrackerSwitch(prev);
+
+  std::thread threads[numOfThreads];
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    threads[i] = std::thread(spillPages, pBufs[i], pageSize, numOfPages, i * 1000);
+  }
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    threads[i].join();
+  }
+
+  // all pages are recycled, only the pages read ahead but not consumed may be left, and they go with the buffers
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    ASSERT_EQ(getDBufStatis(pBufs[i]).loadPages, numOfPages - getNumOfInMemBufPages(pBufs[i]));
+    destroyDiskbasedBuf(pBufs[i]);
+  }
+  ASSERT_EQ(taosMemTrackerUsed(pQuery), 0);
+  ASSERT_GT(taosMemTrackerPeak(pQuery), 0);
+
+  // no room left in the budget, the read ahead is skipped instead of overcommitting
+  const int64_t allocSize = pageSize + sizeof(void*) + sizeof(SFilePage);
+  SMemTracker*  pSmall = taosMemTrackerCreate("small", allocSize * 2, NULL);
+  prev = taosMemTrackerSwitch(pSmall);
+
+  SDiskbasedBuf* pBuf = NULL;
+  ASSERT_EQ(createDiskbasedBuf(&pBuf, pageSize, pageSize * 2, "spill-mem", TD_TMP_DIR_PATH), 0);
+  taosMemTrackerSwitch(prev);
+
+  for (int32_t i = 0; i < 8; ++i) {
+    int32_t    pageId = 0;
+    SFilePage* pPage = static_cast<SFilePage*>(getNewBufPage(pBuf, &pageId));
+    ASSERT_TRUE(pPage != NULL);
+    pPage->num = i;
+    setBufPageDirty(pPage, true);
+    releaseBufPage(pBuf, pPage);
+  }
+
+  ASSERT_EQ(dBufPrefetchPage(pBuf, 0), 0);
+  ASSERT_EQ(getDBufStatis(pBuf).prefetchPages, 0);
+
+  for (int32_t i = 0; i < 8; ++i) {
+    SFilePage* pPage = static_cast<SFilePage*>(getBufPage(pBuf, i));
+    ASSERT_TRUE(pPage != NULL);
+    ASSERT_EQ(pPage->num, i);
+    releaseBufPage(pBuf, pPage);
+  }
+
+  destroyDiskbasedBuf(pBuf);
+  ASSERT_EQ(taosMemTrackerUsed(pSmall), 0);
+  taosMemTrackerUnref(pSmall);
+  taosMemTrackerUnref(pQuery);
+}
+
+void memTrackerTest() {
+  SMemTracker* pNode = taosMemTrackerCreate("node", 100, NULL);
+  SMemTracker* pQuery = taosMemTrackerCreate("query", 60, pNode);
+  SMemTracker* pOther = taosMemTrackerCreate("other", 0, pNode);
+
+  ASSERT_TRUE(taosMemTrackerTryConsume(pQuery, 50));
+  ASSERT_FALSE(taosMemTrackerTryConsume(pQuery, 20));  // over the query limit
+  ASSERT_EQ(taosMemTrackerUsed(pQuery), 50);
+  ASSERT_EQ(taosMemTrackerUsed(pNode), 50);
+
+  ASSERT_TRUE(taosMemTrackerTryConsume(pOther, 40));
+  ASSERT_FALSE(taosMemTrackerTryConsume(pOther, 20));  // over the node limit
+  ASSERT_EQ(taosMemTrackerUsed(pOther), 40);
+  ASSERT_EQ(taosMemTrackerUsed(pNode), 90);
+
+  taosMemTrackerRelease(pQuery, 50);
+  ASSERT_TRUE(taosMemTrackerTryConsume(pOther, 20));
+  ASSERT_EQ(taosMemTrackerPeak(pNode), 90);
+
+  // the bytes left in a freed tracker are given back to its ancestors
+  taosMemTrackerUnref(pOther);
+  ASSERT_EQ(taosMemTrackerUsed(pNode), 0);
+
+  taosMemTrackerUnref(pQuery);
+  taosMemTrackerUnref(pNode);
+}
 }  // namespace
 
 TEST(testCase, resultBufferTest) {
@@ -166,4 +390,14 @@ TEST(testCase, resultBufferTest) {
   recyclePageTest();
 }
 
+TEST(testCase, spillTest) {
+  spillTest();
+  spillMemTest();
+}
+
+TEST(testCase, memTrackerTest) {
+  memTrackerTest();
+  memBudgetTest();
+}
+
 #pragma GCC diagnostic pop
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "taoserror.h"
+#include "tqueue.h"
+
+namespace {
+
+const int32_t kProducers = 4;
+const int32_t kItemsPerProducer = 20000;
+
+typedef struct {
+  int32_t producer;
+  int32_t seq;
+} SQueueTestItem;
+
+}  // namespace
+
+// write workers read a queue set from several producers, items of one queue keep their order
+TEST(TD_UTIL_QUEUE_TEST, qsetMultiProducer) {
+  STaosQset               *qset = taosOpenQset();
+  std::vector<STaosQueue *> queues;
+  for (int32_t p = 0; p < kProducers; ++p) {
+    queues.push_back(taosOpenQueue());
+    ASSERT_EQ(taosAddIntoQset(qset, queues[p], NULL), 0);
+  }
+
+  std::vector<std::thread> producers;
+  for (int32_t p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&queues, p]() {
+      for (int32_t i = 0; i < kItemsPerProducer; ++i) {
+        SQueueTestItem *pItem = (SQueueTestItem *)taosAllocateQitem(sizeof(SQueueTestItem), DEF_QITEM, 0);
+        pItem->producer = p;
+        pItem->seq = i;
+        taosWriteQitem(queues[p], pItem);
+      }
+    });
+  }
+
+  std::vector<int32_t> next(kProducers, 0);
+  int64_t              total = 0;
+  STaosQall           *qall = taosAllocateQall();
+  SQueueInfo           qinfo = {0};
+  while (total < (int64_t)kProducers * kItemsPerProducer) {
+    int32_t num = taosReadAllQitemsFromQset(qset, qall, &qinfo);
+    void   *pItem = NULL;
+    for (int32_t i = 0; i < num; ++i) {
+      taosGetQitem(qall, &pItem);
+      SQueueTestItem *pTestItem = (SQueueTestItem *)pItem;
+      ASSERT_EQ(pTestItem->seq, next[pTestItem->producer]);
+      next[pTestItem->producer]++;
+      taosFreeQitem(pItem);
+    }
+    if (num > 0) taosUpdateItemSize((STaosQueue *)qinfo.queue, num);
+    total += num;
+  }
+
+  for (auto &t : producers) t.join();
+  for (int32_t p = 0; p < kProducers; ++p) {
+    ASSERT_EQ(next[p], kItemsPerProducer);
+    taosCloseQueue(queues[p]);
+  }
+  taosFreeQall(qall);
+  taosCloseQset(qset);
+}
+
+// a reader parks at once by default, or after its spin budget when the qset opted in; a later item or a resume
+// still wakes it
+TEST(TD_UTIL_QUEUE_TEST, qsetWakeup) {
+  for (int32_t spin : {0, 1000}) {
+    STaosQset  *qset = taosOpenQset();
+    STaosQueue *queue = taosOpenQueue();
+    ASSERT_EQ(qset->spin, 0);
+    taosSetQsetSpin(qset, spin);
+    ASSERT_EQ(taosAddIntoQset(qset, queue, NULL), 0);
+
+    std::thread producer([queue, qset]() {
+      for (int32_t i = 0; i < 100; ++i) {
+        taosUsleep(100);
+        taosWriteQitem(queue, taosAllocateQitem(sizeof(int32_t), DEF_QITEM, 0));
+      }
+      taosMsleep(10);
+      taosQsetThreadResume(qset);
+    });
+
+    int32_t    total = 0;
+    SQueueInfo qinfo = {0};
+    for (;;) {
+      void *pItem = NULL;
+      if (taosReadQitemFromQset(qset, &pItem, &qinfo) == 0) break;
+      taosFreeQitem(pItem);
+      total++;
+    }
+
+    producer.join();
+    ASSERT_EQ(total, 100) << "spin:" << spin;
+    ASSERT_EQ(qset->spin, spin);
+    taosCloseQueue(queue);
+    taosCloseQset(qset);
+  }
+}
+
+TEST(TD_UTIL_QUEUE_TEST, qallPartialRead) {
+  STaosQueue *queue = taosOpenQueue();
+  STaosQall  *qall = taosAllocateQall();
+  ASSERT_NE(queue, nullptr);
+  ASSERT_NE(qall, nullptr);
+
+  for (int32_t i = 0; i < 5; ++i) {
+    int32_t *pItem = (int32_t *)taosAllocateQitem(sizeof(int32_t), DEF_QITEM, 0);
+    *pItem = i;
+    taosWriteQitem(queue, pItem);
+  }
+
+  ASSERT_EQ(taosReadAllQitems(queue, qall), 5);
+  ASSERT_EQ(taosQallUnAccessedItemSize(qall), 5);
+
+  // items left in qall are taken before the queue is read again
+  void *pItem = NULL;
+  for (int32_t i = 0; i < 2; ++i) {
+    ASSERT_EQ(taosGetQitem(qall, &pItem), 1);
+    ASSERT_EQ(*(int32_t *)pItem, i);
+  }
+  ASSERT_EQ(taosQallItemSize(qall), 5);
+  ASSERT_EQ(taosQallUnAccessedItemSize(qall), 3);
+
+  taosResetQitems(qall);
+  ASSERT_EQ(taosQallUnAccessedItemSize(qall), 5);
+
+  for (int32_t i = 0; i < 5; ++i) {
+    ASSERT_EQ(taosGetQitem(qall, &pItem), 1);
+    ASSERT_EQ(*(int32_t *)pItem, i);
+    taosFreeQitem(pItem);
+  }
+  ASSERT_EQ(taosGetQitem(qall, &pItem), 0);
+  ASSERT_EQ(taosQallUnAccessedItemSize(qall), 0);
+
+  // an empty queue empties qall
+  ASSERT_EQ(taosReadAllQitems(queue, qall), 0);
+  ASSERT_EQ(taosQallItemSize(qall), 0);
+  ASSERT_EQ(taosQallUnAccessedItemSize(qall), 0);
+
+  taosFreeQall(qall);
+  taosCloseQueue(queue);
+}